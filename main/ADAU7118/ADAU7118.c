@@ -5,6 +5,12 @@
 static const char *TAG = "ADAU7118";
 static i2c_master_bus_handle_t i2c_bus_handle = NULL;
 static i2c_master_dev_handle_t adau7118_dev_handle = NULL;
+static uint8_t channel_mask = ADAU7118_CHANNEL_MASK_ALL;
+static uint8_t dec_ratio = 32;      // 抽取比
+static uint8_t slot_width = 16;     // TDM槽位宽度
+
+// PDM数据线到时钟的映射：DAT0/DAT1用CLK0，DAT2/DAT3用CLK1
+#define CLK_MAP_CONFIG  (PDM_DAT3_CLK1 | PDM_DAT2_CLK1 | PDM_DAT1_CLK0 | PDM_DAT0_CLK0)
 
 // 初始化I2C总线和设备句柄
 esp_err_t adau7118_init_i2c() {
@@ -75,6 +81,106 @@ esp_err_t adau7118_read_reg(uint8_t reg_addr, uint8_t *reg_data) {
     return i2c_master_receive(adau7118_dev_handle, reg_data, 1, -1);
 }
 
+// 由通道掩码计算ENABLES寄存器：每条PDM数据线承载一对通道，只能按对使能，
+// 并且只打开被使用的数据线所对应的PDM时钟
+static uint8_t enables_for_mask(uint8_t mask) {
+    uint8_t enables = 0;
+    for (int pair = 0; pair < 4; pair++) {
+        if (mask & (0x03 << (2 * pair))) {
+            enables |= CHAN_01_ENABLE << pair;
+            enables |= (CLK_MAP_CONFIG & (PDM_DAT0_CLK1 << pair)) ? PDM_CLK1_ENABLE : PDM_CLK0_ENABLE;
+        }
+    }
+    return enables;
+}
+
+// 写入通道掩码对应的ENABLES和SPT_CX寄存器
+static esp_err_t adau7118_apply_channel_mask(void) {
+    uint8_t enables = enables_for_mask(channel_mask);
+    esp_err_t ret = adau7118_write_reg(ADAU7118_REG_ENABLES, enables);
+    if (ret != ESP_OK) return ret;
+    
+    // 每个通道固定输出到与自身编号相同的槽位，未使用的通道不驱动槽位（三态）
+    for (int ch = 0; ch < 8; ch++) {
+        uint8_t spt = ch & SPT_CX_SLOT_MASK;
+        if (channel_mask & (1 << ch)) {
+            spt |= SPT_CX_ENABLE;
+        }
+        ret = adau7118_write_reg(ADAU7118_REG_SPT_CX(ch), spt);
+        if (ret != ESP_OK) return ret;
+    }
+    
+    uint8_t read_data;
+    ret = adau7118_read_reg(ADAU7118_REG_ENABLES, &read_data);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "通道掩码 0x%02x, Reg 0x04 写入: 0x%02x, 读回: 0x%02x, %s",
+                 channel_mask, enables, read_data, (read_data == enables) ? "成功" : "失败");
+    } else {
+        ESP_LOGW(TAG, "Reg 0x04 验证读取失败: %s", esp_err_to_name(ret));
+    }
+    return ESP_OK;
+}
+
+// 设置通道掩码
+esp_err_t adau7118_set_channel_mask(uint8_t mask) {
+    if (mask == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    channel_mask = mask;
+    if (adau7118_dev_handle == NULL) {
+        return ESP_OK;
+    }
+    return adau7118_apply_channel_mask();
+}
+
+uint8_t adau7118_get_channel_mask(void) {
+    return channel_mask;
+}
+
+// 写入并读回验证一个寄存器
+static esp_err_t adau7118_write_verify(uint8_t reg, uint8_t value) {
+    esp_err_t ret = adau7118_write_reg(reg, value);
+    if (ret != ESP_OK) return ret;
+    vTaskDelay(5 / portTICK_PERIOD_MS);
+    
+    uint8_t read_data;
+    ret = adau7118_read_reg(reg, &read_data);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Reg 0x%02x 写入: 0x%02x, 读回: 0x%02x, %s",
+                 reg, value, read_data, (read_data == value) ? "成功" : "失败");
+    } else {
+        ESP_LOGW(TAG, "Reg 0x%02x 验证读取失败: %s", reg, esp_err_to_name(ret));
+    }
+    return ESP_OK;
+}
+
+// 写入抽取比（DEC_RATIO_CLK_MAP）和串行口槽位宽度（SPT_CTRL1）
+static esp_err_t adau7118_apply_format(void) {
+    uint8_t dec_bits = (dec_ratio == 64) ? DEC_RATIO_64 : (dec_ratio == 16) ? DEC_RATIO_16 : DEC_RATIO_32;
+    esp_err_t ret = adau7118_write_verify(ADAU7118_REG_DEC_RATIO_CLK_MAP, CLK_MAP_CONFIG | dec_bits);
+    if (ret != ESP_OK) return ret;
+    
+    // 三态未用槽位，左对齐，TDM模式
+    uint8_t width_bits = (slot_width == 32) ? SPT_SLOT_WIDTH_32 :
+                         (slot_width == 24) ? SPT_SLOT_WIDTH_24 : SPT_SLOT_WIDTH_16;
+    return adau7118_write_verify(ADAU7118_REG_SPT_CTRL1,
+                                 TRI_STATE_Enable | width_bits | SPT_DATA_Left | SPT_SAI_TDM);
+}
+
+// 设置抽取比和槽位宽度
+esp_err_t adau7118_set_format(uint8_t decimation, uint8_t slot_bits) {
+    if ((decimation != 16 && decimation != 32 && decimation != 64) ||
+        (slot_bits != 16 && slot_bits != 24 && slot_bits != 32)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    dec_ratio = decimation;
+    slot_width = slot_bits;
+    if (adau7118_dev_handle == NULL) {
+        return ESP_OK;
+    }
+    return adau7118_apply_format();
+}
+
 // 初始化ADAU7118
 esp_err_t Init_ADAU7118() {
     esp_err_t ret;
@@ -122,29 +228,13 @@ esp_err_t Init_ADAU7118() {
     ret = adau7118_write_reg(0x12, 0x01); // 软复位，不包括寄存器设置
     if (ret != ESP_OK) return ret;
    
-    // 3. 启用所有通道和时钟
-    ret = adau7118_write_reg(0x04, 0x3F); // 启用所有通道和PDM时钟输出
+    // 3. 按通道掩码启用通道和时钟（默认全部启用: 0x3F）
+    ret = adau7118_apply_channel_mask();
     if (ret != ESP_OK) return ret;
-    vTaskDelay(5 / portTICK_PERIOD_MS);
-    ret = adau7118_read_reg(0x04, &read_data);
-    if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "Reg 0x04 写入: 0x3F, 读回: 0x%02x, %s", 
-                 read_data, (read_data == 0x3F) ? "成功" : "失败");
-    } else {
-        ESP_LOGW(TAG, "Reg 0x04 验证读取失败: %s", esp_err_to_name(ret));
-    }
     
-    // 4. 设置抽取比率和PDM时钟映射
-    ret = adau7118_write_reg(0x05, 0b11000001);
+    // 4. 按采集格式设置抽取比率、PDM时钟映射和串行口槽位宽度（默认: 0xC1, 0x53）
+    ret = adau7118_apply_format();
     if (ret != ESP_OK) return ret;
-    vTaskDelay(5 / portTICK_PERIOD_MS);
-    ret = adau7118_read_reg(0x05, &read_data);
-    if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "Reg 0x05 写入: 0xC0, 读回: 0x%02x, %s", 
-                 read_data, (read_data == 0xC0) ? "成功" : "失败");
-    } else {
-        ESP_LOGW(TAG, "Reg 0x05 验证读取失败: %s", esp_err_to_name(ret));
-    }
     
     // 5. 配置高通滤波器
     ret = adau7118_write_reg(0x06, 0xD0);
@@ -158,18 +248,6 @@ esp_err_t Init_ADAU7118() {
         ESP_LOGW(TAG, "Reg 0x06 验证读取失败: %s", esp_err_to_name(ret));
     }
     
-    // 6. 配置串行音频接口
-    ret = adau7118_write_reg(0x07, 0b01010011);
-    if (ret != ESP_OK) return ret;
-    vTaskDelay(5 / portTICK_PERIOD_MS);
-    ret = adau7118_read_reg(0x07, &read_data);
-    if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "Reg 0x07 写入: 0x53, 读回: 0x%02x, %s", 
-                 read_data, (read_data == 0x53) ? "成功" : "失败");
-    } else {
-        ESP_LOGW(TAG, "Reg 0x07 验证读取失败: %s", esp_err_to_name(ret));
-    }
-    
     // 7. 配置时钟极性
     ret = adau7118_write_reg(0x08, 0x00);
     if (ret != ESP_OK) return ret;
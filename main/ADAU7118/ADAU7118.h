@@ -90,6 +90,10 @@
 #define SPT_SAI_Stereo 			 0x00
 #define SPT_SAI_TDM 			 	 0x01
 
+/* SPT_CX rigister config */
+#define SPT_CX_ENABLE			 0x40    // 通道输出使能
+#define SPT_CX_SLOT_MASK		 0x1F    // 输出槽位号
+
 /* SPT_CTRL2 rigister config */
 #define LRCLK_POL_Normal		 0x00 
 #define LRCLK_POL_Invert		 0x02 
@@ -109,6 +113,9 @@
 #define I2C_MASTER_TX_BUF_DISABLE   0
 #define I2C_MASTER_RX_BUF_DISABLE   0
 
+// 通道掩码：bit n对应第n路麦克风（TDM槽位n）
+#define ADAU7118_CHANNEL_MASK_ALL    0xFF
+
 // 函数声明
 // 初始化ADAU7118，需要提供SCL和SDA引脚编号
 esp_err_t Init_ADAU7118();
@@ -116,6 +123,13 @@ esp_err_t Init_ADAU7118();
 esp_err_t adau7118_write_reg(uint8_t reg_addr, uint8_t reg_data);
 // 读取寄存器
 esp_err_t adau7118_read_reg(uint8_t reg_addr, uint8_t *reg_data);
+// 设置通道掩码（按通道对使能PDM输入，未使用的通道不输出到TDM槽位）。
+// 设备尚未初始化时只保存掩码，由Init_ADAU7118写入。
+esp_err_t adau7118_set_channel_mask(uint8_t mask);
+uint8_t adau7118_get_channel_mask(void);
+// 设置抽取比（16/32/64）和TDM槽位宽度（16/24/32），需与I2S的时钟和槽位配置一致。
+// 设备尚未初始化时只保存设置，由Init_ADAU7118写入。
+esp_err_t adau7118_set_format(uint8_t decimation, uint8_t slot_bits);
 // 释放资源
 void adau7118_deinit(void);
 #endif // ADAU7118_H
@@ -2,346 +2,330 @@
 
 static const char *TAG = "AudioCapture";
 
-// 任务句柄
-static TaskHandle_t audioTaskHandle = NULL;
-static TaskHandle_t fileTaskHandle = NULL;
-
-// 音频数据的N缓冲区系统（替代双缓冲区）
-#define NUM_BUFFERS 6  // 缓冲区数量(N) - 可调整
-
-typedef struct {
-    SemaphoreHandle_t mutex[NUM_BUFFERS];
-    uint8_t *buffer[NUM_BUFFERS];
-    size_t size;        // 每个缓冲区的大小
-    int activeBuffer;   // 当前用于写入的活动缓冲区
-    bool bufferReady[NUM_BUFFERS]; // 跟踪哪些缓冲区准备好保存
-} AudioMultiBuffer;
-
-static AudioMultiBuffer audioBuffer = {
-    .mutex = {NULL},
-    .buffer = {NULL},
-    .size = AUDIO_BUFFER_SIZE,
-    .activeBuffer = 0,
-    .bufferReady = {false}
+// 采集链路（任务、块环、文件写出）；静态分配在内部RAM，文件头可被SDMMC直接DMA
+static CapturePipeline pipeline;
+
+// 下一次初始化链路时使用的配置；任务创建之后不能再修改
+static audio_capture_mode_t captureMode = AUDIO_CAPTURE_MODE_COPY;
+static audio_codec_t audioCodec = AUDIO_CODEC_PCM;
+static audio_layout_t audioLayout = AUDIO_LAYOUT_INTERLEAVED;
+static uint32_t channelMask = AUDIO_CHANNEL_MASK_ALL;
+
+// 事件录音：预录/后录时长和触发条件
+static bool eventCapture = false;
+static uint32_t eventPreRollMs = AUDIO_EVENT_PRE_ROLL_MS;
+static uint32_t eventPostRollMs = AUDIO_EVENT_POST_ROLL_MS;
+static EventDetectorConfig eventTrigger = EVENT_DETECTOR_DEFAULT;
+
+// 文件轮转：每个文件的时长和大小上限（0: 不限）
+static uint32_t rotateMs = 0;
+static uint64_t rotateBytes = 0;
+
+// 多板同步：参考脉冲的周期；syncClock由I2S的on_recv和脉冲输入的GPIO中断写入
+static bool syncEnabled = false;
+static uint32_t syncPeriodMs = AUDIO_SYNC_PERIOD_MS;
+static SyncClock syncClock;
+static bool syncPulseReady = false;
+
+// 波束形成：输出方式、指向和麦克风位置（第一次取用时填入默认的圆阵）
+static audio_beam_output_t beamOutput = AUDIO_BEAM_OFF;
+static BeamformerConfig beamConfig;
+static bool beamConfigReady = false;
+
+// 声源方位估计：帧长、重叠、输出速率和麦克风对（默认为圆阵的对径槽位），几何与波束形成共用
+static bool doaEnabled = false;
+static uint32_t doaFrameSize = AUDIO_DOA_FRAME_SIZE;
+static uint32_t doaOverlapPct = AUDIO_DOA_OVERLAP_PCT;
+static uint32_t doaRateHz = AUDIO_DOA_RATE_HZ;
+static uint8_t doaPairs[DOA_MAX_PAIRS][2] = {
+    { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 },
 };
+static uint32_t doaPairCount = 4;
+
+// 多采样率输出：各路采样率和文件扩展名（".R" + kHz）
+static uint32_t rateHz[DECIMATOR_MAX_OUTPUTS];
+static uint32_t rateCount = 0;
+static char rateExt[DECIMATOR_MAX_OUTPUTS][12];
 
-// 用于任务间通信的队列
-static QueueHandle_t dataQueue = NULL;
+// 声学特征：记录周期和频带数
+static bool featuresEnabled = false;
+static uint32_t featurePeriodMs = AUDIO_FEATURE_PERIOD_MS;
+static uint32_t featureBands = AUDIO_FEATURE_BANDS;
+
+// 采集配置（采样率、位深、抽取比）；块大小不超过AUDIO_BUFFER_SIZE
+static CaptureProfile captureProfile = {
+    .sampleRate = TDM_SAMPLE_RATE,
+    .bitsPerSample = TDM_BIT_WIDTH,
+    .decimation = TDM_DEC_RATIO,
+};
 
-// 文件句柄
-static FILE *audioFile = NULL;
-static char currentFilePath[128] = {0}; // 存储当前文件路径的缓冲区
+// 电平/频谱抽头：显示任务可能在采集开始之前就读取，第一次取用时初始化
+static LevelTap levelTap;
+static bool levelTapReady = false;
 
 // 任务状态
 static bool tasksRunning = false;
 
-// 为每个录制会话生成唯一文件名的函数
-static esp_err_t generate_audio_filename(char *file_path, size_t max_len) {
-    DIR *dir;
-    struct dirent *entry;
-    int max_index = 0;
-    char pattern[32];
-    int file_index;
-    
-    // 确保输出缓冲区有效
-    if (file_path == NULL || max_len < 16) {
-        return ESP_ERR_INVALID_ARG;
+// 任务已创建（配置不能再修改）
+static bool tasks_created(void) {
+    return pipeline.captureTask != NULL || pipeline.fileTask != NULL;
+}
+
+// 复制模式的数据源：从I2S通道读取
+static bool i2s_reader_read(CaptureReader *reader, void *buf, size_t len, size_t *bytesRead) {
+    esp_err_t result = i2s_channel_read(rx_chan, buf, len, bytesRead, portMAX_DELAY);
+    if (result != ESP_OK) {
+        ESP_LOGW(TAG, "I2S read error: %s", esp_err_to_name(result));
+        return false;
     }
-    
-    // 打开目录
-    dir = opendir(AUDIO_FILE_DIR);
-    if (dir == NULL) {
-        ESP_LOGE(TAG, "Failed to open directory: %s", AUDIO_FILE_DIR);
-        // 如果目录无法打开，默认使用Audio1.bin
-        snprintf(file_path, max_len, "%s/%s1%s", AUDIO_FILE_DIR, AUDIO_FILE_PREFIX, AUDIO_FILE_EXT);
-        return ESP_ERR_NOT_FOUND;
+    return true;
+}
+
+// 同步：读空驱动中已完成的缓冲区，再阻塞读取下一个完成的缓冲区并丢弃
+static bool i2s_reader_flush(CaptureReader *reader) {
+    static uint8_t flushBuf[CAPTURE_DMA_MAX_BUFFER_BYTES];
+    size_t bytes;
+    while (i2s_channel_read(rx_chan, flushBuf, sizeof(flushBuf), &bytes, 0) == ESP_OK) {
     }
-    
-    // 创建匹配模式（例如，"Audio"）
-    snprintf(pattern, sizeof(pattern), "%s", AUDIO_FILE_PREFIX);
-    size_t pattern_len = strlen(pattern);
-    
-    // 扫描目录中的所有文件
-    while ((entry = readdir(dir)) != NULL) {
-        // 检查文件名是否匹配我们的模式
-        if (strncmp(entry->d_name, pattern, pattern_len) == 0) {
-            // 尝试提取前缀后的索引号
-            if (sscanf(entry->d_name + pattern_len, "%d", &file_index) == 1) {
-                // 如果这个索引比我们当前的最大值高，则更新最大值
-                if (file_index > max_index) {
-                    max_index = file_index;
-                }
-            }
-        }
+    CaptureTiming timing;
+    if (capture_profile_resolve(&captureProfile, AUDIO_BUFFER_SIZE, &timing) != CAPTURE_PROFILE_OK) {
+        return false;
     }
-    
-    // 关闭目录
-    closedir(dir);
-    
-    // 创建比找到的最大索引高一的新文件名
-    snprintf(file_path, max_len, "%s/%s%d%s", 
-             AUDIO_FILE_DIR, AUDIO_FILE_PREFIX, max_index + 1, AUDIO_FILE_EXT);
-    
-    ESP_LOGI(TAG, "Generated filename: %s", file_path);
-    return ESP_OK;
+    esp_err_t result = i2s_channel_read(rx_chan, flushBuf, timing.dmaFrameNum * timing.frameBytes, &bytes,
+                                        portMAX_DELAY);
+    if (result != ESP_OK) {
+        ESP_LOGW(TAG, "I2S flush error: %s", esp_err_to_name(result));
+        return false;
+    }
+    return true;
 }
 
-// 音频数据捕获任务
-static void audio_capture_task(void *pvParameters) {
-    size_t bytes_read;
-    esp_err_t result;
-    size_t writePos = 0;  // 当前缓冲区的本地写入位置
-    
-    ESP_LOGI(TAG, "Audio capture task started");
-    
-    while (1) {
-        // 检查任务是否应该暂停
-        if (ulTaskNotifyTake(pdTRUE, 0)) {
-            // 收到通知，暂停任务
-            ESP_LOGI(TAG, "Audio capture task going to suspend");
-            vTaskSuspend(NULL);
-            ESP_LOGI(TAG, "Audio capture task resumed");
-            continue;
-        }
-        
-        // 尝试找到一个空闲缓冲区
-        bool bufferFound = false;
-        int startBuffer = audioBuffer.activeBuffer;  // 记住我们开始搜索的位置
-        
-        // 从当前activeBuffer开始，以循环方式尝试所有缓冲区
-        for (int i = 0; i < NUM_BUFFERS; i++) {
-            int bufferIndex = (startBuffer + i) % NUM_BUFFERS;
-            
-            // 尝试锁定缓冲区以进行写入（非阻塞）
-            if (xSemaphoreTake(audioBuffer.mutex[bufferIndex], 0) == pdTRUE) {
-                // 检查缓冲区是否未标记为就绪（不等待保存）
-                if (!audioBuffer.bufferReady[bufferIndex]) {
-                    // 我们找到了一个可用的缓冲区
-                    audioBuffer.activeBuffer = bufferIndex;
-                    bufferFound = true;
-                    
-                    // 计算此缓冲区中的剩余空间
-                    uint8_t* bufPtr = audioBuffer.buffer[bufferIndex] + writePos;
-                    size_t bytesToRead = audioBuffer.size - writePos;
-                    
-                    // 从I2S直接读取数据到缓冲区
-                    result = i2s_channel_read(rx_chan, bufPtr, bytesToRead, &bytes_read, portMAX_DELAY);
-                    
-                    // 检查读取是否成功且接收到数据
-                    if (result == ESP_OK && bytes_read > 0) {
-                        // 更新写入位置
-                        writePos += bytes_read;
-                        
-                        // 检查缓冲区是否已满
-                        if (writePos >= audioBuffer.size) {
-                            // 为下一个缓冲区重置写入位置
-                            writePos = 0;
-                            
-                            // 标记此缓冲区为就绪
-                            audioBuffer.bufferReady[bufferIndex] = true;
-                            
-                            // 发送缓冲区索引到文件任务
-                            xQueueSend(dataQueue, &bufferIndex, portMAX_DELAY);
-                        }
-                    } else if (result != ESP_OK) {
-                        ESP_LOGW(TAG, "I2S read error: %s", esp_err_to_name(result));
-                    }
-                    
-                    // 释放缓冲区互斥锁
-                    xSemaphoreGive(audioBuffer.mutex[bufferIndex]);
-                    break;  // 既然已处理数据，退出for循环
-                } else {
-                    // 缓冲区标记为就绪但我们获得了互斥锁 - 释放它并尝试另一个
-                    xSemaphoreGive(audioBuffer.mutex[bufferIndex]);
-                }
-            }
-            // 如果我们无法获取互斥锁或缓冲区已就绪，尝试下一个
-        }
-        
-        // 如果未找到缓冲区，短暂让出CPU再试
-        // if (!bufferFound) {
-        //     taskYIELD();  // 让其他任务有机会运行
-        // }
+static CaptureReader i2sReader = {
+    .read = i2s_reader_read,
+    .flush = i2s_reader_flush,
+};
+
+// 同步：每个DMA缓冲区完成时记下时间（复制模式，与队列溢出回调一起注册）
+static IRAM_ATTR bool i2s_on_recv_sync(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx) {
+    sync_clock_dma_done(&syncClock, esp_timer_get_time());
+    return false;
+}
+
+// 同步：参考脉冲的上升沿
+static IRAM_ATTR void sync_pulse_isr(void *arg) {
+    sync_clock_pulse(&syncClock, esp_timer_get_time());
+}
+
+// 配置参考脉冲输入和它的GPIO中断（GPIO中断服务可能已被其他模块安装）
+static esp_err_t sync_pulse_init(void) {
+    if (syncPulseReady) {
+        return ESP_OK;
+    }
+    gpio_config_t io = {
+        .pin_bit_mask = 1ULL << SYNC_PULSE_IO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_down_en = GPIO_PULLDOWN_ENABLE,
+        .intr_type = GPIO_INTR_POSEDGE,
+    };
+    esp_err_t ret = gpio_config(&io);
+    if (ret == ESP_OK) {
+        ret = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+        ret = (ret == ESP_ERR_INVALID_STATE) ? ESP_OK : ret;
+    }
+    if (ret == ESP_OK) {
+        ret = gpio_isr_handler_add(SYNC_PULSE_IO, sync_pulse_isr, NULL);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up the sync pulse input: %s", esp_err_to_name(ret));
+        return ret;
     }
+    syncPulseReady = true;
+    return ESP_OK;
+}
+
+// I2S DMA帧源：on_recv回调把刚完成的DMA缓冲区交给组装器
+static dma_frame_cb_t i2sFrameCb = NULL;
+static void *i2sFrameCtx = NULL;
+
+// 复制模式：驱动的消息队列溢出说明采集任务没有及时读取，DMA数据已丢失
+static IRAM_ATTR bool i2s_on_recv_q_ovf(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx) {
+    capture_stats_overrun(&pipeline.stats);
+    return false;
 }
 
-// 文件保存任务
-static void file_save_task(void *pvParameters) {
-    ESP_LOGI(TAG, "File save task started");
+static IRAM_ATTR bool i2s_on_recv(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx) {
+    // ESP-IDF 5.2中event->data指向刚完成的DMA缓冲区的指针
+    const uint8_t *frame = *(const uint8_t **)event->data;
+    return i2sFrameCb(i2sFrameCtx, frame, event->size);
+}
+
+static bool i2s_frame_source_start(DmaFrameSource *src, dma_frame_cb_t cb, void *ctx) {
+    i2sFrameCb = cb;
+    i2sFrameCtx = ctx;
     
-    // 生成唯一文件名
-    memset(currentFilePath, 0, sizeof(currentFilePath));
-    if (generate_audio_filename(currentFilePath, sizeof(currentFilePath)) != ESP_OK) {
-        ESP_LOGW(TAG, "Error generating filename, using fallback");
+    // 注册回调要求通道处于禁用状态
+    i2s_event_callbacks_t cbs = { .on_recv = i2s_on_recv };
+    i2s_channel_disable(rx_chan);
+    esp_err_t ret = i2s_channel_register_event_callback(rx_chan, &cbs, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register I2S on_recv callback: %s", esp_err_to_name(ret));
     }
-    
-    // 创建文件
-    audioFile = fopen(currentFilePath, "wb");
-    setvbuf(audioFile, NULL, _IOFBF, 8192);  // 使用完全缓冲模式
-    if (audioFile == NULL) {
-        ESP_LOGE(TAG, "Failed to open file for writing: %s", currentFilePath);
-        vTaskDelete(NULL);
-        fileTaskHandle = NULL;
-        return;
+    i2s_channel_enable(rx_chan);
+    return ret == ESP_OK;
+}
+
+static void i2s_frame_source_stop(DmaFrameSource *src) {
+    i2s_event_callbacks_t cbs = { 0 };
+    i2s_channel_disable(rx_chan);
+    i2s_channel_register_event_callback(rx_chan, &cbs, NULL);
+    i2s_channel_enable(rx_chan);
+}
+
+static DmaFrameSource i2sFrameSource = {
+    .start = i2s_frame_source_start,
+    .stop = i2s_frame_source_stop,
+};
+
+LevelTap *audio_capture_get_level_tap(void) {
+    if (!levelTapReady) {
+        level_tap_init(&levelTap);
+        levelTapReady = true;
     }
-    
-    ESP_LOGI(TAG, "File opened: %s", currentFilePath);
-    
-    while (1) {
-        // 检查任务是否应该暂停
-        if (ulTaskNotifyTake(pdTRUE, 0)) {
-            // 刷新任何待处理的缓冲区
-            for (int i = 0; i < NUM_BUFFERS; i++) {
-                if (audioBuffer.bufferReady[i]) {
-                    if (xSemaphoreTake(audioBuffer.mutex[i], portMAX_DELAY) == pdTRUE) {
-                        // 将缓冲区写入文件
-                        size_t written = fwrite(audioBuffer.buffer[i], 1, audioBuffer.size, audioFile);
-                        if (written != audioBuffer.size) {
-                            ESP_LOGW(TAG, "Failed to write all data to file: %d/%d", written, audioBuffer.size);
-                        }
-                        
-                        // 标记缓冲区为可用
-                        audioBuffer.bufferReady[i] = false;
-                        xSemaphoreGive(audioBuffer.mutex[i]);
-                    }
-                }
-            }
-            
-            // 刷新并关闭文件
-            if (audioFile != NULL) {
-                fflush(audioFile);
-                fclose(audioFile);
-                audioFile = NULL;
-                ESP_LOGI(TAG, "File closed");
-            }
-            
-            // 暂停任务
-            ESP_LOGI(TAG, "File save task going to suspend");
-            vTaskSuspend(NULL);
-            
-            // 恢复时创建新文件
-            ESP_LOGI(TAG, "File save task resumed");
-            
-            // 生成新的唯一文件名
-            memset(currentFilePath, 0, sizeof(currentFilePath));
-            if (generate_audio_filename(currentFilePath, sizeof(currentFilePath)) != ESP_OK) {
-                ESP_LOGW(TAG, "Error generating filename, using fallback");
-            }
-            
-            audioFile = fopen(currentFilePath, "wb");
-            if (audioFile == NULL) {
-                ESP_LOGE(TAG, "Failed to open file for writing after resume: %s", currentFilePath);
-                vTaskDelete(NULL);
-                fileTaskHandle = NULL;
-                return;
-            }
-            ESP_LOGI(TAG, "New file opened: %s", currentFilePath);
-            continue;
-        }
-        
-        // 从队列接收缓冲区索引
-        uint8_t bufferIndex;
-        if (xQueueReceive(dataQueue, &bufferIndex, portMAX_DELAY) == pdTRUE) {
-            if (bufferIndex < NUM_BUFFERS && audioBuffer.bufferReady[bufferIndex]) {
-                if (xSemaphoreTake(audioBuffer.mutex[bufferIndex], portMAX_DELAY) == pdTRUE) {
-                    // 将缓冲区写入文件
-                    size_t written = fwrite(audioBuffer.buffer[bufferIndex], 1, audioBuffer.size, audioFile);
-                    if (written != audioBuffer.size) {
-                        ESP_LOGW(TAG, "Failed to write all data to file: %d/%d", written, audioBuffer.size);
-                    }
-                    
-                    // 将缓冲区重新标记为可用
-                    audioBuffer.bufferReady[bufferIndex] = false;
-                    xSemaphoreGive(audioBuffer.mutex[bufferIndex]);
-                }
-            } else {
-                ESP_LOGW(TAG, "Received invalid buffer index: %d", bufferIndex);
-            }
-        }
+    return &levelTap;
+}
+
+static BeamformerConfig *beam_config(void) {
+    if (!beamConfigReady) {
+        beamformer_circular_array(&beamConfig, TDM_CHANNELS, AUDIO_BEAM_ARRAY_RADIUS_MM / 1000.0f);
+        beamConfig.beams = 1;
+        beamConfigReady = true;
     }
+    return &beamConfig;
 }
 
-// 初始化音频捕获系统
+// 方位估计的配置：麦克风位置取波束形成的几何
+static DoaConfig doa_config(void) {
+    DoaConfig config = {
+        .frameSize = doaFrameSize,
+        .hopFrames = doaFrameSize - doaFrameSize * doaOverlapPct / 100,
+        .reportFrames = captureProfile.sampleRate / doaRateHz,
+        .pairs = doaPairCount,
+        .minHz = AUDIO_DOA_MIN_HZ,
+        .maxHz = AUDIO_DOA_MAX_HZ,
+    };
+    memcpy(config.pair, doaPairs, sizeof(config.pair));
+    memcpy(config.mic, beam_config()->mic, sizeof(config.mic));
+    return config;
+}
+
+// 初始化音频捕获系统：准备I2S，再按当前配置初始化采集链路
 static esp_err_t audio_capture_init(void) {
-    // 创建数据队列 - 增加大小以容纳更多缓冲区
-    dataQueue = xQueueCreate(NUM_BUFFERS * 2, sizeof(uint8_t));
-    if (dataQueue == NULL) {
-        ESP_LOGE(TAG, "Failed to create data queue");
-        return ESP_FAIL;
+    // 检查DSP内核的PIE路径（不一致时退回可移植的C实现）
+    if (!dsp_init()) {
+        ESP_LOGW(TAG, "PIE DSP kernels failed the golden vectors, using the portable C kernels");
     }
+
+    CapturePipelineConfig config = {
+        .mode = captureMode,
+        .codec = audioCodec,
+        .layout = audioLayout,
+        .slots = TDM_CHANNELS,
+        .channelMask = channelMask,
+        .profile = captureProfile,
+        .maxBlockBytes = AUDIO_BUFFER_SIZE,
+        .spillStallMs = AUDIO_SPILL_STALL_MS,
+        .spillMaxBytes = AUDIO_SPILL_MAX_MB * 1024 * 1024,
+        .eventCapture = eventCapture,
+        .detector = eventTrigger,
+        .preRollMs = eventPreRollMs,
+        .postRollMs = eventPostRollMs,
+        .levelTap = audio_capture_get_level_tap(),
+        .syncClock = syncEnabled ? &syncClock : NULL,
+        .syncPeriodMs = syncPeriodMs,
+        .beamOutput = beamOutput,
+        .beam = *beam_config(),
+        .doaEstimate = doaEnabled,
+        .doa = doa_config(),
+        .features = featuresEnabled,
+        .feature = {
+            .reportFrames = (uint32_t)((uint64_t)captureProfile.sampleRate * featurePeriodMs / 1000),
+            .bands = featureBands,
+        },
+        .rates = { .outputs = rateCount, .rateHz = { rateHz[0], rateHz[1], rateHz[2] } },
+        .reader = &i2sReader,
+        .frameSource = &i2sFrameSource,
+        .zcDmaDescNum = AUDIO_ZC_DMA_DESC_NUM,
+        .zcFramesPerBlock = AUDIO_ZC_FRAMES_PER_BLOCK,
+        .zcDmaFrameNum = AUDIO_ZC_DMA_FRAME_NUM,
+        .backend = NULL,
+        .fileDir = AUDIO_FILE_DIR,
+        .filePrefix = AUDIO_FILE_PREFIX,
+        .pcmExt = AUDIO_FILE_EXT,
+        .flacExt = AUDIO_FLAC_FILE_EXT,
+        .planarExt = AUDIO_PLANAR_FILE_EXT,
+        .bfpExt = AUDIO_BFP_FILE_EXT,
+        .indexExt = AUDIO_INDEX_FILE_EXT,
+        .eventExt = AUDIO_EVENT_FILE_EXT,
+        .syncExt = AUDIO_SYNC_FILE_EXT,
+        .beamExt = AUDIO_BEAM_FILE_EXT,
+        .doaExt = AUDIO_DOA_FILE_EXT,
+        .rateExt = { rateExt[0], rateExt[1], rateExt[2] },
+        .featureExt = AUDIO_FEATURE_FILE_EXT,
+        .preallocBytes = (uint64_t)AUDIO_PREALLOC_MB * 1024 * 1024,
+        .checkpointMs = AUDIO_CHECKPOINT_MS,
+        .journalPath = RECOVERY_JOURNAL_PATH,
+        .seqPath = FILE_SEQUENCE_PATH,
+        .rotateMs = rotateMs,
+        .rotateBytes = rotateBytes,
+        .captureTask = { AUDIO_TASK_STACK_SIZE, AUDIO_TASK_PRIORITY, 1 },
+        .processTask = { PROCESS_TASK_STACK_SIZE, PROCESS_TASK_PRIORITY, 1 },
+        .fileTask = { FILE_TASK_STACK_SIZE, FILE_TASK_PRIORITY, 0 },
+        .prepTask = { PREP_TASK_STACK_SIZE, PREP_TASK_PRIORITY, 0 },
+    };
     
-    // 为缓冲区分配DMA可用内存
-    for (int i = 0; i < NUM_BUFFERS; i++) {
-        audioBuffer.buffer[i] = heap_caps_malloc(AUDIO_BUFFER_SIZE, MALLOC_CAP_DMA);
-        if (audioBuffer.buffer[i] == NULL) {
-            ESP_LOGE(TAG, "Failed to allocate DMA buffer %d", i);
-            // 释放先前分配的缓冲区
-            for (int j = 0; j < i; j++) {
-                heap_caps_free(audioBuffer.buffer[j]);
-                audioBuffer.buffer[j] = NULL;
-            }
-            vQueueDelete(dataQueue);
-            dataQueue = NULL;
-            return ESP_ERR_NO_MEM;
+    if (captureMode == AUDIO_CAPTURE_MODE_ZERO_COPY) {
+        // 零拷贝模式不需要块缓冲区，改为加深I2S DMA描述符环
+        CaptureTiming timing;
+        if (capture_profile_resolve(&captureProfile, AUDIO_BUFFER_SIZE, &timing) != CAPTURE_PROFILE_OK ||
+            AUDIO_ZC_DMA_FRAME_NUM * timing.frameBytes > CAPTURE_DMA_MAX_BUFFER_BYTES) {
+            ESP_LOGE(TAG, "Zero-copy DMA frames do not fit a DMA descriptor at %u bits",
+                     (unsigned)captureProfile.bitsPerSample);
+            return ESP_ERR_INVALID_STATE;
         }
-        
-        // 清空缓冲区
-        memset(audioBuffer.buffer[i], 0, AUDIO_BUFFER_SIZE);
-        
-        // 为此缓冲区创建互斥锁
-        audioBuffer.mutex[i] = xSemaphoreCreateMutex();
-        if (audioBuffer.mutex[i] == NULL) {
-            ESP_LOGE(TAG, "Failed to create mutex for buffer %d", i);
-            // 释放资源
-            for (int j = 0; j <= i; j++) {
-                heap_caps_free(audioBuffer.buffer[j]);
-                audioBuffer.buffer[j] = NULL;
-                if (j < i) {
-                    vSemaphoreDelete(audioBuffer.mutex[j]);
-                    audioBuffer.mutex[j] = NULL;
-                }
-            }
-            vQueueDelete(dataQueue);
-            dataQueue = NULL;
-            return ESP_ERR_NO_MEM;
+        tdm_deinit();
+        esp_err_t ret = tdm_init_dma(AUDIO_ZC_DMA_DESC_NUM, AUDIO_ZC_DMA_FRAME_NUM);
+        if (ret != ESP_OK) {
+            return ret;
         }
-        
-        // 初始化缓冲区状态
-        audioBuffer.bufferReady[i] = false;
     }
     
-    // 重置缓冲区状态
-    audioBuffer.activeBuffer = 0;
-    
-    return ESP_OK;
-}
-
-// 释放所有资源
-static void audio_capture_deinit(void) {
-    // 释放缓冲区资源
-    for (int i = 0; i < NUM_BUFFERS; i++) {
-        if (audioBuffer.buffer[i] != NULL) {
-            heap_caps_free(audioBuffer.buffer[i]);
-            audioBuffer.buffer[i] = NULL;
-        }
-        
-        if (audioBuffer.mutex[i] != NULL) {
-            vSemaphoreDelete(audioBuffer.mutex[i]);
-            audioBuffer.mutex[i] = NULL;
-        }
+    if (!capture_pipeline_init(&pipeline, &config)) {
+        return ESP_FAIL;
     }
     
-    // 删除队列
-    if (dataQueue != NULL) {
-        vQueueDelete(dataQueue);
-        dataQueue = NULL;
+    if (captureMode == AUDIO_CAPTURE_MODE_COPY) {
+        // 复制模式下统计I2S驱动的消息队列溢出，同步时还要记下每个DMA缓冲区的完成时间
+        // （注册回调要求通道处于禁用状态）
+        i2s_event_callbacks_t cbs = {
+            .on_recv = syncEnabled ? i2s_on_recv_sync : NULL,
+            .on_recv_q_ovf = i2s_on_recv_q_ovf,
+        };
+        i2s_channel_disable(rx_chan);
+        esp_err_t ret = i2s_channel_register_event_callback(rx_chan, &cbs, NULL);
+        i2s_channel_enable(rx_chan);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to register I2S overflow callback: %s", esp_err_to_name(ret));
+        }
     }
-    
-    // 关闭文件（如果打开）
-    if (audioFile != NULL) {
-        fclose(audioFile);
-        audioFile = NULL;
+    if (syncEnabled) {
+        // syncClock已由capture_pipeline_init初始化，之后才能打开脉冲中断
+        esp_err_t ret = sync_pulse_init();
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        ESP_LOGI(TAG, "Sync pulse on GPIO%d, nominal period %u ms", SYNC_PULSE_IO, (unsigned)syncPeriodMs);
     }
+    return ESP_OK;
 }
 
 // 开始音频捕获
@@ -352,10 +336,9 @@ esp_err_t audio_capture_start(void) {
     // 检查任务是否已经运行
     if (tasksRunning) {
         // 检查任务是否已暂停
-        if (audioTaskHandle != NULL && eTaskGetState(audioTaskHandle) == eSuspended) {
+        if (capture_pipeline_is_paused(&pipeline)) {
             // 恢复任务
-            vTaskResume(audioTaskHandle);
-            vTaskResume(fileTaskHandle);
+            capture_pipeline_resume(&pipeline);
             ESP_LOGI(TAG, "Audio capture tasks resumed");
             return ESP_OK;
         } else {
@@ -366,17 +349,9 @@ esp_err_t audio_capture_start(void) {
     }
     
     // 检查任务句柄存在但未标记为运行的异常状态
-    if (audioTaskHandle != NULL || fileTaskHandle != NULL) {
+    if (tasks_created()) {
         ESP_LOGW(TAG, "Task handles exist but not marked as running - cleaning up");
-        // 删除任何现有任务
-        if (audioTaskHandle != NULL) {
-            vTaskDelete(audioTaskHandle);
-            audioTaskHandle = NULL;
-        }
-        if (fileTaskHandle != NULL) {
-            vTaskDelete(fileTaskHandle);
-            fileTaskHandle = NULL;
-        }
+        capture_pipeline_delete_tasks(&pipeline);
     }
     
     // 仅在尚未完成的情况下初始化资源
@@ -385,46 +360,13 @@ esp_err_t audio_capture_start(void) {
         ret = audio_capture_init();
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "Failed to initialize audio capture: %s", esp_err_to_name(ret));
-            audio_capture_deinit();
+            capture_pipeline_deinit(&pipeline);
             return ret;
         }
         
-        // 创建音频捕获任务
-        BaseType_t xReturned = xTaskCreatePinnedToCore(
-            audio_capture_task,
-            "audio_capture_task",
-            AUDIO_TASK_STACK_SIZE,
-            NULL,
-            AUDIO_TASK_PRIORITY,
-            &audioTaskHandle,
-            1  // 核心0
-        );
-        
-        if (xReturned != pdPASS) {
-            ESP_LOGE(TAG, "Failed to create audio capture task");
-            audio_capture_deinit();
-            resources_initialized = false;
-            return ESP_ERR_NO_MEM;
-        }
-        
-        // 创建文件保存任务
-        xReturned = xTaskCreatePinnedToCore(
-            file_save_task,
-            "file_save_task",
-            FILE_TASK_STACK_SIZE,
-            NULL,
-            FILE_TASK_PRIORITY,
-            &fileTaskHandle,
-            0  // 核心1
-        );
-        
-        if (xReturned != pdPASS) {
-            ESP_LOGE(TAG, "Failed to create file save task");
-            if (audioTaskHandle != NULL) {
-                vTaskDelete(audioTaskHandle);
-                audioTaskHandle = NULL;
-            }
-            audio_capture_deinit();
+        // 创建采集、处理和文件保存任务
+        if (!capture_pipeline_start_tasks(&pipeline)) {
+            capture_pipeline_deinit(&pipeline);
             resources_initialized = false;
             return ESP_ERR_NO_MEM;
         }
@@ -446,22 +388,14 @@ esp_err_t audio_capture_stop(void) {
     }
     
     // 检查任务是否存在
-    if (audioTaskHandle == NULL || fileTaskHandle == NULL) {
+    if (pipeline.captureTask == NULL || pipeline.fileTask == NULL) {
         ESP_LOGW(TAG, "Audio capture tasks not found");
         tasksRunning = false;
         return ESP_OK;
     }
     
-    // 通知任务暂停
-    xTaskNotifyGive(audioTaskHandle);
-    xTaskNotifyGive(fileTaskHandle);
-    
-    // 等待任务暂停
-    vTaskDelay(pdMS_TO_TICKS(1000));
-    
-    // 确认任务已暂停
-    if (eTaskGetState(audioTaskHandle) != eSuspended || 
-        eTaskGetState(fileTaskHandle) != eSuspended) {
+    // 通知任务暂停并等待任务挂起（等待时间按环中的块数和写卡延迟推算）
+    if (!capture_pipeline_pause(&pipeline)) {
         ESP_LOGW(TAG, "Failed to suspend tasks");
         return ESP_FAIL;
     }
@@ -473,7 +407,427 @@ esp_err_t audio_capture_stop(void) {
 // 检查音频捕获是否正在运行
 bool audio_capture_is_running(void) {
     return tasksRunning && 
-           audioTaskHandle != NULL && 
-           fileTaskHandle != NULL && 
-           eTaskGetState(audioTaskHandle) != eSuspended;
-}
\ No newline at end of file
+           pipeline.captureTask != NULL && 
+           pipeline.fileTask != NULL && 
+           !capture_pipeline_is_paused(&pipeline);
+}
+
+// 选择采集模式（任务创建之后不能再切换）
+esp_err_t audio_capture_set_mode(audio_capture_mode_t mode) {
+    if (mode != AUDIO_CAPTURE_MODE_COPY && mode != AUDIO_CAPTURE_MODE_ZERO_COPY) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (tasks_created()) {
+        ESP_LOGW(TAG, "Capture mode can only be changed before the first start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    captureMode = mode;
+    return ESP_OK;
+}
+
+audio_capture_mode_t audio_capture_get_mode(void) {
+    return captureMode;
+}
+
+// 选择录音编码（任务创建之后不能再切换）
+esp_err_t audio_capture_set_codec(audio_codec_t codec) {
+    if (codec != AUDIO_CODEC_PCM && codec != AUDIO_CODEC_FLAC && codec != AUDIO_CODEC_BFP) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (tasks_created()) {
+        ESP_LOGW(TAG, "Codec can only be changed before the first start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    audioCodec = codec;
+    return ESP_OK;
+}
+
+audio_codec_t audio_capture_get_codec(void) {
+    return audioCodec;
+}
+
+// 选择文件中的通道布局（任务创建之后不能再切换）
+esp_err_t audio_capture_set_layout(audio_layout_t layout) {
+    if (layout != AUDIO_LAYOUT_INTERLEAVED && layout != AUDIO_LAYOUT_PLANAR) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (tasks_created()) {
+        ESP_LOGW(TAG, "Layout can only be changed before the first start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    audioLayout = layout;
+    return ESP_OK;
+}
+
+audio_layout_t audio_capture_get_layout(void) {
+    return audioLayout;
+}
+
+// 选择录制的麦克风（任务创建之后不能再切换）
+esp_err_t audio_capture_set_channel_mask(uint32_t mask) {
+    if (mask == 0 || (mask & ~AUDIO_CHANNEL_MASK_ALL) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (tasks_created()) {
+        ESP_LOGW(TAG, "Channel mask can only be changed before the first start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // 关闭未使用的PDM输入和TDM槽位输出
+    esp_err_t ret = adau7118_set_channel_mask((uint8_t)mask);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to program ADAU7118 channel mask: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    channelMask = mask;
+    return ESP_OK;
+}
+
+uint32_t audio_capture_get_channel_mask(void) {
+    return channelMask;
+}
+
+// 切换采集配置（任务创建之后不能再切换）：停止I2S，写入ADAU7118，再按新的时钟和槽位重建I2S通道
+esp_err_t audio_capture_set_profile(const CaptureProfile *profile) {
+    if (profile == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    CaptureTiming timing;
+    CaptureProfileError err = capture_profile_resolve(profile, AUDIO_BUFFER_SIZE, &timing);
+    if (err != CAPTURE_PROFILE_OK) {
+        ESP_LOGW(TAG, "Invalid capture profile: %s", capture_profile_error_str(err));
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (tasks_created()) {
+        ESP_LOGW(TAG, "Capture profile can only be changed before the first start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    tdm_deinit();
+    esp_err_t ret = adau7118_set_format(timing.decimation, timing.slotBits);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to program ADAU7118 format: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    tdm_set_format(profile->sampleRate, profile->bitsPerSample, timing.slotBits, timing.mclkMultiple);
+    ret = tdm_init_dma(timing.dmaDescNum, timing.dmaFrameNum);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to reinitialize TDM interface: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    captureProfile = *profile;
+    captureProfile.decimation = timing.decimation;
+    ESP_LOGI(TAG, "Capture profile: %u Hz, %u-bit, decimation %u, %u frames per block",
+             (unsigned)captureProfile.sampleRate, (unsigned)captureProfile.bitsPerSample,
+             (unsigned)captureProfile.decimation, (unsigned)timing.blockFrames);
+    return ESP_OK;
+}
+
+void audio_capture_get_profile(CaptureProfile *profile) {
+    *profile = captureProfile;
+}
+
+// 开关事件录音（任务创建之后不能再切换）
+esp_err_t audio_capture_set_event_capture(bool enable, uint32_t preRollMs, uint32_t postRollMs) {
+    if (enable && captureMode != AUDIO_CAPTURE_MODE_COPY) {
+        ESP_LOGW(TAG, "Event capture requires the copy capture mode");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (tasks_created()) {
+        ESP_LOGW(TAG, "Event capture can only be changed before the first start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    eventCapture = enable;
+    eventPreRollMs = preRollMs;
+    eventPostRollMs = postRollMs;
+    return ESP_OK;
+}
+
+bool audio_capture_get_event_capture(uint32_t *preRollMs, uint32_t *postRollMs) {
+    *preRollMs = eventPreRollMs;
+    *postRollMs = eventPostRollMs;
+    return eventCapture;
+}
+
+// 设置事件触发条件（任务创建之后不能再修改）
+esp_err_t audio_capture_set_event_trigger(const EventDetectorConfig *trigger) {
+    if (trigger == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (tasks_created()) {
+        ESP_LOGW(TAG, "Event trigger can only be changed before the first start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    eventTrigger = *trigger;
+    return ESP_OK;
+}
+
+void audio_capture_get_event_trigger(EventDetectorConfig *trigger) {
+    *trigger = eventTrigger;
+}
+
+// 设置文件轮转（任务创建之后不能再修改）
+esp_err_t audio_capture_set_rotation(uint32_t ms, uint64_t bytes) {
+    if (tasks_created()) {
+        ESP_LOGW(TAG, "File rotation can only be changed before the first start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    rotateMs = ms;
+    rotateBytes = bytes;
+    return ESP_OK;
+}
+
+void audio_capture_get_rotation(uint32_t *ms, uint64_t *bytes) {
+    *ms = rotateMs;
+    *bytes = rotateBytes;
+}
+
+// 开关多板同步（任务创建之后不能再切换）
+esp_err_t audio_capture_set_sync(bool enable, uint32_t periodMs) {
+    if (enable && captureMode != AUDIO_CAPTURE_MODE_COPY) {
+        ESP_LOGW(TAG, "Sync requires the copy capture mode");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (enable && (periodMs < SYNC_CLOCK_MIN_PERIOD_MS || periodMs > SYNC_CLOCK_MAX_PERIOD_MS)) {
+        ESP_LOGW(TAG, "Sync pulse period must be %u..%u ms", SYNC_CLOCK_MIN_PERIOD_MS, SYNC_CLOCK_MAX_PERIOD_MS);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (tasks_created()) {
+        ESP_LOGW(TAG, "Sync can only be changed before the first start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    syncEnabled = enable;
+    if (enable) {
+        syncPeriodMs = periodMs;
+    }
+    return ESP_OK;
+}
+
+bool audio_capture_get_sync(uint32_t *periodMs) {
+    *periodMs = syncPeriodMs;
+    return syncEnabled;
+}
+
+// 读取同步状态（任意任务，无锁）；未启用同步时返回false
+bool audio_capture_get_sync_status(SyncClockStatus *status) {
+    if (!syncEnabled || !tasks_created()) {
+        return false;
+    }
+    sync_clock_get_status(&syncClock, status);
+    return true;
+}
+
+// 设置波束形成（任务创建之后不能再修改）；关闭时保留原来的指向
+esp_err_t audio_capture_set_beams(audio_beam_output_t output, const float *azimuthDeg, uint32_t count) {
+    if (output != AUDIO_BEAM_OFF && captureMode != AUDIO_CAPTURE_MODE_COPY) {
+        ESP_LOGW(TAG, "Beamforming requires the copy capture mode");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (output != AUDIO_BEAM_OFF && (azimuthDeg == NULL || count == 0 || count > BEAMFORMER_MAX_BEAMS)) {
+        ESP_LOGW(TAG, "Beamforming needs 1..%d beams", BEAMFORMER_MAX_BEAMS);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (tasks_created()) {
+        ESP_LOGW(TAG, "Beams can only be changed before the first start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    BeamformerConfig *config = beam_config();
+    beamOutput = output;
+    if (output != AUDIO_BEAM_OFF) {
+        config->beams = count;
+        for (uint32_t b = 0; b < count; b++) {
+            config->azimuthDeg[b] = azimuthDeg[b];
+            config->elevationDeg[b] = 0.0f;
+        }
+    }
+    return ESP_OK;
+}
+
+audio_beam_output_t audio_capture_get_beams(float *azimuthDeg, uint32_t *count) {
+    const BeamformerConfig *config = beam_config();
+    *count = config->beams;
+    memcpy(azimuthDeg, config->azimuthDeg, config->beams * sizeof(float));
+    return beamOutput;
+}
+
+// 设置麦克风位置（任务创建之后不能再修改）
+esp_err_t audio_capture_set_beam_array(const BeamformerPoint *mics) {
+    if (mics == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (tasks_created()) {
+        ESP_LOGW(TAG, "Beam geometry can only be changed before the first start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    memcpy(beam_config()->mic, mics, TDM_CHANNELS * sizeof(BeamformerPoint));
+    return ESP_OK;
+}
+
+void audio_capture_get_beam_array(BeamformerPoint *mics) {
+    memcpy(mics, beam_config()->mic, TDM_CHANNELS * sizeof(BeamformerPoint));
+}
+
+// 设置声源方位估计（任务创建之后不能再修改）；关闭时保留原来的参数
+esp_err_t audio_capture_set_doa(bool enable, uint32_t frameSize, uint32_t overlapPct, uint32_t rateHz) {
+    if (enable && captureMode != AUDIO_CAPTURE_MODE_COPY) {
+        ESP_LOGW(TAG, "DOA estimation requires the copy capture mode");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (enable && (frameSize < DOA_MIN_FRAME || frameSize > DOA_MAX_FRAME || (frameSize & (frameSize - 1)) != 0 ||
+                   overlapPct > 90 || rateHz == 0 || rateHz > AUDIO_DOA_MAX_RATE_HZ)) {
+        ESP_LOGW(TAG, "DOA needs a power-of-two window of %d..%d frames, 0..90%% overlap and 1..%d estimates/s",
+                 DOA_MIN_FRAME, DOA_MAX_FRAME, AUDIO_DOA_MAX_RATE_HZ);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (tasks_created()) {
+        ESP_LOGW(TAG, "DOA can only be changed before the first start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    doaEnabled = enable;
+    if (enable) {
+        doaFrameSize = frameSize;
+        doaOverlapPct = overlapPct;
+        doaRateHz = rateHz;
+    }
+    return ESP_OK;
+}
+
+bool audio_capture_get_doa(uint32_t *frameSize, uint32_t *overlapPct, uint32_t *rateHz) {
+    *frameSize = doaFrameSize;
+    *overlapPct = doaOverlapPct;
+    *rateHz = doaRateHz;
+    return doaEnabled;
+}
+
+// 设置方位估计的麦克风对（任务创建之后不能再修改）
+esp_err_t audio_capture_set_doa_pairs(const uint8_t (*pairs)[2], uint32_t count) {
+    if (count > DOA_MAX_PAIRS || (count > 0 && pairs == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (pairs[i][0] >= TDM_CHANNELS || pairs[i][1] >= TDM_CHANNELS || pairs[i][0] == pairs[i][1]) {
+            ESP_LOGW(TAG, "Invalid DOA pair %u-%u", (unsigned)pairs[i][0], (unsigned)pairs[i][1]);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    if (tasks_created()) {
+        ESP_LOGW(TAG, "DOA pairs can only be changed before the first start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    memcpy(doaPairs, pairs, count * sizeof(doaPairs[0]));
+    doaPairCount = count;
+    return ESP_OK;
+}
+
+uint32_t audio_capture_get_doa_pairs(uint8_t (*pairs)[2]) {
+    memcpy(pairs, doaPairs, doaPairCount * sizeof(doaPairs[0]));
+    return doaPairCount;
+}
+
+// 读取最新的方位估计（任意任务，无锁）；未启用或还没有结果时返回false
+bool audio_capture_get_doa_status(DoaEstimate *estimate, uint32_t *count) {
+    *count = 0;
+    if (!doaEnabled || !tasks_created()) {
+        return false;
+    }
+    return doa_estimator_latest(&pipeline.doaEstimator, estimate, count);
+}
+
+// 设置声学特征（任务创建之后不能再修改）；关闭时保留原来的参数
+esp_err_t audio_capture_set_features(bool enable, uint32_t periodMs, uint32_t bands) {
+    if (enable && captureMode != AUDIO_CAPTURE_MODE_COPY) {
+        ESP_LOGW(TAG, "Features require the copy capture mode");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (enable && (periodMs < AUDIO_FEATURE_MIN_PERIOD_MS || periodMs > AUDIO_FEATURE_MAX_PERIOD_MS || bands == 0 ||
+                   bands > FEATURE_MAX_BANDS)) {
+        ESP_LOGW(TAG, "Features need a period of %d..%d ms and 1..%d bands", AUDIO_FEATURE_MIN_PERIOD_MS,
+                 AUDIO_FEATURE_MAX_PERIOD_MS, FEATURE_MAX_BANDS);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (tasks_created()) {
+        ESP_LOGW(TAG, "Features can only be changed before the first start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    featuresEnabled = enable;
+    if (enable) {
+        featurePeriodMs = periodMs;
+        featureBands = bands;
+    }
+    return ESP_OK;
+}
+
+bool audio_capture_get_features(uint32_t *periodMs, uint32_t *bands) {
+    *periodMs = featurePeriodMs;
+    *bands = featureBands;
+    return featuresEnabled;
+}
+
+uint32_t audio_capture_get_feature_count(void) {
+    if (!featuresEnabled || !tasks_created()) {
+        return 0;
+    }
+    return atomic_load(&pipeline.features.count);
+}
+
+// 设置多采样率输出（任务创建之后不能再修改）；扩展名取整kHz，必须各不相同
+esp_err_t audio_capture_set_rates(const uint32_t *rates, uint32_t count) {
+    if (count > DECIMATOR_MAX_OUTPUTS || (count > 0 && rates == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (count > 0 && captureMode != AUDIO_CAPTURE_MODE_COPY) {
+        ESP_LOGW(TAG, "Rate outputs require the copy capture mode");
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (rates[i] < AUDIO_RATE_MIN_HZ || rates[i] >= captureProfile.sampleRate ||
+            captureProfile.sampleRate % rates[i] != 0) {
+            ESP_LOGW(TAG, "Rate output %u Hz must be a fraction of %u Hz and at least %d Hz", (unsigned)rates[i],
+                     (unsigned)captureProfile.sampleRate, AUDIO_RATE_MIN_HZ);
+            return ESP_ERR_INVALID_ARG;
+        }
+        for (uint32_t k = 0; k < i; k++) {
+            if (rates[k] / 1000 == rates[i] / 1000) {
+                ESP_LOGW(TAG, "Rate outputs %u and %u Hz would share a file extension", (unsigned)rates[k],
+                         (unsigned)rates[i]);
+                return ESP_ERR_INVALID_ARG;
+            }
+        }
+    }
+    if (tasks_created()) {
+        ESP_LOGW(TAG, "Rate outputs can only be changed before the first start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        rateHz[i] = rates[i];
+        snprintf(rateExt[i], sizeof(rateExt[i]), "%s%u", AUDIO_RATE_FILE_EXT, (unsigned)(rates[i] / 1000));
+    }
+    rateCount = count;
+    return ESP_OK;
+}
+
+uint32_t audio_capture_get_rates(uint32_t *rates) {
+    memcpy(rates, rateHz, rateCount * sizeof(rateHz[0]));
+    return rateCount;
+}
+
+// 读取一路多采样率输出的抽取比、运算量和群延迟（init时确定，之后不变）
+bool audio_capture_get_rate_cost(uint32_t output, uint32_t *factor, float *macsPerFrame, float *latencyFrames) {
+    if (!tasks_created() || output >= pipeline.decimator.outputs) {
+        return false;
+    }
+    *factor = pipeline.decimator.outputFactor[output];
+    *macsPerFrame = pipeline.decimator.macsPerFrame[output];
+    *latencyFrames = pipeline.decimator.latencyFrames[output];
+    return true;
+}
+
+// 读取运行统计（任意任务，无锁）
+void audio_capture_get_stats(audio_capture_stats_t *stats) {
+    capture_pipeline_get_stats(&pipeline, stats);
+}
+
+void audio_capture_reset_stats(void) {
+    capture_stats_reset(&pipeline.stats);
+}
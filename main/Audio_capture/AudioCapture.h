@@ -13,16 +13,69 @@
 #include <dirent.h>    // For directory operations
 #include <sys/stat.h>  // For file status checks
 #include <errno.h>
+#include "hardwareInit.h"
+#include "CapturePipeline.h"
+#include "ChannelCompact.h"
+#include "DspBlock.h"
+#include "ADAU7118.h"
+#include "esp_timer.h"
 
 // Configuration constants
-#define AUDIO_BUFFER_SIZE      (32*1024)  // 32KB per buffer - can be adjusted
+#define AUDIO_BUFFER_SIZE      (32*1024)  // 32KB per buffer (upper bound, the capture profile rounds it to whole frames/sectors)
 #define AUDIO_TASK_STACK_SIZE  (8*1024)   // Stack size for audio task
 #define FILE_TASK_STACK_SIZE   (8*1024)   // Stack size for file task
+#define PROCESS_TASK_STACK_SIZE (4*1024)  // Stack size for processing (compression/deinterleave) task
+#define PREP_TASK_STACK_SIZE   (4*1024)   // Stack size for the file prep task (file rotation)
+// Task placement, acquire (core 1) -> process (core 1) -> persist (core 0). Core 0 also runs the Wi-Fi/BT
+// stacks started by Wireless_Init: Wi-Fi and BT controller tasks at 23, esp_timer at 22, Bluedroid BTU/BTC
+// at 20/19 and lwIP at 18. The file task sits above the host stacks and below the timer/radio tasks, so
+// BLE/Wi-Fi traffic cannot hold back SD writes; it mostly blocks on SDMMC transfers and costs little CPU.
 #define AUDIO_TASK_PRIORITY    10         // Audio task priority
-#define FILE_TASK_PRIORITY     5          // File task priority
+#define FILE_TASK_PRIORITY     21         // File task priority (core 0, see above)
+#define PROCESS_TASK_PRIORITY  6          // Processing task priority (same core as capture, below it)
+#define PREP_TASK_PRIORITY     4          // File prep task priority (same core as the file task, below it)
 #define AUDIO_FILE_DIR          "/sdcard"         // Directory for audio files
 #define AUDIO_FILE_PREFIX      "AUDIO"           // Prefix for audio files
-#define AUDIO_FILE_EXT         ".bin"            // File extension
+#define AUDIO_FILE_EXT         ".WAV"            // File extension (8.3 names, LFN disabled)
+#define AUDIO_FLAC_FILE_EXT    ".FLA"            // File extension for compressed recordings
+#define AUDIO_PLANAR_FILE_EXT  ".PLN"            // File extension for planar (per-channel chunked) recordings
+#define AUDIO_BFP_FILE_EXT     ".BFP"            // File extension for block floating point recordings
+#define AUDIO_INDEX_FILE_EXT   ".IDX"            // Per-block index written next to each recording
+#define AUDIO_EVENT_FILE_EXT   ".EVT"            // Event index written next to each event-mode recording
+#define AUDIO_SYNC_FILE_EXT    ".SYN"            // Sync index (reference pulse positions) next to each recording
+#define AUDIO_SYNC_PERIOD_MS   1000              // Default nominal period of the shared reference pulse
+#define AUDIO_BEAM_FILE_EXT    ".BMF"            // Beams (16-bit WAV) written next to the microphone recording
+#define AUDIO_BEAM_ARRAY_RADIUS_MM 40            // Default beam geometry: slots on a circle, slot 0 on +x, counter-clockwise
+#define AUDIO_DOA_FILE_EXT     ".DOA"            // Bearing estimates (GCC-PHAT) written next to each recording
+#define AUDIO_DOA_FRAME_SIZE   1024              // Default DOA analysis window (frames)
+#define AUDIO_DOA_OVERLAP_PCT  50                // Default overlap between DOA windows
+#define AUDIO_DOA_RATE_HZ      20                // Default bearing estimates per second
+#define AUDIO_DOA_MAX_RATE_HZ  50                // Upper bound: at most AUDIO_BLOCK_MAX_DOA estimates per block
+#define AUDIO_DOA_MIN_HZ       300               // PHAT band lower edge: keeps out wind and handling rumble
+#define AUDIO_DOA_MAX_HZ       8000              // PHAT band upper edge: most source energy lies below it
+#define AUDIO_RATE_FILE_EXT    ".R"              // Rate outputs: ".R" + kHz (".R48", ".R16"), 16-bit WAV next to each recording
+#define AUDIO_RATE_MIN_HZ      1000              // Lowest rate output (the extension holds whole kHz)
+#define AUDIO_FEATURE_FILE_EXT ".FEA"            // Acoustic features (levels, ZCR, band energies) next to each recording
+#define AUDIO_FEATURE_PERIOD_MS 100              // Default feature record period
+#define AUDIO_FEATURE_MIN_PERIOD_MS 20
+#define AUDIO_FEATURE_MAX_PERIOD_MS 10000
+#define AUDIO_FEATURE_BANDS    32                // Default number of mel bands per channel
+#define AUDIO_PREALLOC_MB      1024              // Contiguous space reserved per file (MB)
+#define AUDIO_CHECKPOINT_MS    5000              // Checkpoint interval: header, FAT/dir entry and journal
+#define AUDIO_SPILL_STALL_MS   2000              // SD write stall the PSRAM spill ring should absorb (copy mode)
+#define AUDIO_SPILL_MAX_MB     6                 // Upper bound for the spill ring in PSRAM (MB)
+#define AUDIO_EVENT_PRE_ROLL_MS  2000            // Event capture: audio kept before a trigger
+#define AUDIO_EVENT_POST_ROLL_MS 1000            // Event capture: audio kept after the last trigger
+
+#define AUDIO_CHANNEL_MASK_ALL ((1u << TDM_CHANNELS) - 1)  // All TDM slots recorded
+
+// Zero-copy mode: DMA frames are handed to the file task in place
+#define AUDIO_ZC_DMA_DESC_NUM      96   // DMA descriptors
+#define AUDIO_ZC_DMA_FRAME_NUM     128  // Frames per descriptor: 2048 bytes, a whole number of sectors
+#define AUDIO_ZC_FRAMES_PER_BLOCK  16   // DMA frames per block handed to the file task
+
+// Capture pipeline telemetry
+typedef CapturePipelineStats audio_capture_stats_t;
 
 // I2S RX channel - should be defined elsewhere
 extern i2s_chan_handle_t rx_chan;
@@ -32,4 +85,108 @@ esp_err_t audio_capture_start(void);
 esp_err_t audio_capture_stop(void);
 bool audio_capture_is_running(void);
 
+// Select the capture mode; only allowed before the capture tasks are created
+esp_err_t audio_capture_set_mode(audio_capture_mode_t mode);
+audio_capture_mode_t audio_capture_get_mode(void);
+
+// Select the recording codec; only allowed before the capture tasks are created.
+// FLAC compresses blocks in place and therefore requires the copy capture mode.
+esp_err_t audio_capture_set_codec(audio_codec_t codec);
+audio_codec_t audio_capture_get_codec(void);
+
+// Select the channel layout; only allowed before the capture tasks are created.
+// Planar output requires the copy capture mode and the PCM codec.
+esp_err_t audio_capture_set_layout(audio_layout_t layout);
+audio_layout_t audio_capture_get_layout(void);
+
+// Select which microphones are recorded (bit n = TDM slot n); only allowed before the capture
+// tasks are created. Also programs the ADAU7118. Masked slots are dropped before storage,
+// which requires the copy capture mode.
+esp_err_t audio_capture_set_channel_mask(uint32_t mask);
+uint32_t audio_capture_get_channel_mask(void);
+
+// Select the sample rate, bit depth and ADAU7118 decimation ratio; only allowed before the capture
+// tasks are created. Reprograms the ADAU7118 and rebuilds the I2S TDM channel immediately;
+// block and DMA sizes follow the profile. FLAC needs 16-bit samples, planar output 16 or 32.
+esp_err_t audio_capture_set_profile(const CaptureProfile *profile);
+void audio_capture_get_profile(CaptureProfile *profile);
+
+// Event capture: keep a pre-roll in the PSRAM spill ring and only write events (plus pre-roll
+// and post-roll) to the card, with an event index next to the recording. Only allowed before the
+// capture tasks are created; requires the copy capture mode.
+esp_err_t audio_capture_set_event_capture(bool enable, uint32_t preRollMs, uint32_t postRollMs);
+bool audio_capture_get_event_capture(uint32_t *preRollMs, uint32_t *postRollMs);
+
+// Event trigger thresholds (per-channel RMS/peak in dBFS, VAD margin over the noise floor in dB);
+// only allowed before the capture tasks are created
+esp_err_t audio_capture_set_event_trigger(const EventDetectorConfig *trigger);
+void audio_capture_get_event_trigger(EventDetectorConfig *trigger);
+
+// File rotation: switch to a pre-opened file every rotateMs milliseconds and/or once the file
+// exceeds rotateBytes (0 disables each limit) without stopping capture. Only allowed before the
+// capture tasks are created.
+esp_err_t audio_capture_set_rotation(uint32_t rotateMs, uint64_t rotateBytes);
+void audio_capture_get_rotation(uint32_t *rotateMs, uint64_t *rotateBytes);
+
+// Multi-board sync: timestamp a shared reference pulse on SYNC_PULSE_IO and every I2S DMA buffer,
+// place each pulse on the recording's sample timeline, estimate the sample-clock drift and write the
+// records to a sync index next to each recording. Only allowed before the capture tasks are created;
+// requires the copy capture mode. periodMs is the nominal pulse period (ignored when disabling).
+esp_err_t audio_capture_set_sync(bool enable, uint32_t periodMs);
+bool audio_capture_get_sync(uint32_t *periodMs);
+// Sync estimator state; lock-free, returns false when sync is not running
+bool audio_capture_get_sync_status(SyncClockStatus *status);
+
+// Beamforming: steer `count` delay-and-sum beams at the given azimuths (degrees, horizontal plane,
+// 0 = +x towards +y) from the recorded microphones, and record them instead of the microphones
+// (AUDIO_BEAM_ONLY) or in a WAV next to the recording (AUDIO_BEAM_WITH_RAW). Only allowed before the
+// capture tasks are created; requires the copy capture mode and a 16-bit profile.
+esp_err_t audio_capture_set_beams(audio_beam_output_t output, const float *azimuthDeg, uint32_t count);
+// azimuthDeg receives up to BEAMFORMER_MAX_BEAMS angles
+audio_beam_output_t audio_capture_get_beams(float *azimuthDeg, uint32_t *count);
+// Microphone position per TDM slot in metres (TDM_CHANNELS entries); only allowed before the capture
+// tasks are created. Defaults to a circle of AUDIO_BEAM_ARRAY_RADIUS_MM.
+esp_err_t audio_capture_set_beam_array(const BeamformerPoint *mics);
+void audio_capture_get_beam_array(BeamformerPoint *mics);
+
+// Direction of arrival: estimate the horizontal bearing of the dominant source by GCC-PHAT over
+// frameSize-frame windows overlapping by overlapPct percent, rateHz times per second, and write the
+// estimates to a DOA index next to each recording. Uses the beamforming microphone positions. Only
+// allowed before the capture tasks are created; requires the copy capture mode and a 16-bit profile.
+esp_err_t audio_capture_set_doa(bool enable, uint32_t frameSize, uint32_t overlapPct, uint32_t rateHz);
+bool audio_capture_get_doa(uint32_t *frameSize, uint32_t *overlapPct, uint32_t *rateHz);
+// Microphone pairs as TDM slot pairs (count 0: every pair of recorded microphones); only allowed
+// before the capture tasks are created. Defaults to the opposite slots of the default circle.
+esp_err_t audio_capture_set_doa_pairs(const uint8_t (*pairs)[2], uint32_t count);
+// pairs receives up to DOA_MAX_PAIRS pairs; returns the count
+uint32_t audio_capture_get_doa_pairs(uint8_t (*pairs)[2]);
+// Latest estimate and the number of estimates since start; lock-free, returns false before the first one
+bool audio_capture_get_doa_status(DoaEstimate *estimate, uint32_t *count);
+
+// Rate outputs: decimate the recorded channels to count extra sample rates (capture rate / 2^a x 3^b,
+// AUDIO_RATE_MIN_HZ or more) in the same pass and write each as a 16-bit WAV next to the recording
+// (count 0: off). Only allowed before the capture tasks are created; requires the copy capture mode.
+esp_err_t audio_capture_set_rates(const uint32_t *rateHz, uint32_t count);
+// rateHz receives up to DECIMATOR_MAX_OUTPUTS rates; returns the count
+uint32_t audio_capture_get_rates(uint32_t *rateHz);
+// Decimation factor, multiplies per input frame and channel and group delay (input frames) of one
+// rate output; returns false before the capture tasks are created
+bool audio_capture_get_rate_cost(uint32_t output, uint32_t *factor, float *macsPerFrame, float *latencyFrames);
+
+// Acoustic features: every periodMs, RMS, peak, zero-crossing rate and bands mel band energies of each
+// recorded channel, written to a feature index next to each recording so regions can be found without
+// reading the audio back. Only allowed before the capture tasks are created; requires the copy capture mode.
+esp_err_t audio_capture_set_features(bool enable, uint32_t periodMs, uint32_t bands);
+bool audio_capture_get_features(uint32_t *periodMs, uint32_t *bands);
+// Feature records since start (lock-free)
+uint32_t audio_capture_get_feature_count(void);
+
+// Level/spectrum tap fed by the capture pipeline; the display reads lock-free snapshots from it
+// and can select the spectrum slot with level_tap_select_channel at any time
+LevelTap *audio_capture_get_level_tap(void);
+
+// Read the telemetry counters; lock-free, callable from any task
+void audio_capture_get_stats(audio_capture_stats_t *stats);
+void audio_capture_reset_stats(void);
+
 #endif /* AUDIO_CAPTURE_H */
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "BfpCodec.h"
+#include <string.h>
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+static bool format_valid(const BfpFormat *format) {
+    return format->channels > 0 && format->channels <= BFP_MAX_CHANNELS && format->blockFrames > 0 &&
+           format->groupFrames >= BFP_MIN_GROUP && format->groupFrames <= BFP_MAX_GROUP &&
+           (format->sourceBits == 24 || format->sourceBits == 32);
+}
+
+bool bfp_build_header(uint8_t *out, const BfpFormat *format) {
+    if (!format_valid(format)) {
+        return false;
+    }
+
+    memset(out, 0, BFP_HEADER_BYTES);
+    memcpy(out, "BFPK", 4);
+    put_u16(out + 4, BFP_VERSION);
+    put_u16(out + 6, BFP_HEADER_BYTES);
+    put_u32(out + 8, format->sampleRate);
+    put_u16(out + 12, format->channels);
+    put_u16(out + 14, format->sourceBits);
+    put_u32(out + 16, format->blockFrames);
+    put_u16(out + 20, (uint16_t)format->groupFrames);
+    put_u32(out + 24, format->channelMask);
+    put_u32(out + 28, bfp_block_bytes(format));
+    return true;
+}
+
+bool bfp_parse_header(const uint8_t *buf, size_t len, BfpFormat *format) {
+    if (len < 32 || memcmp(buf, "BFPK", 4) != 0 || get_u16(buf + 4) != BFP_VERSION ||
+        get_u16(buf + 6) != BFP_HEADER_BYTES) {
+        return false;
+    }
+
+    format->sampleRate = get_u32(buf + 8);
+    format->channels = get_u16(buf + 12);
+    format->sourceBits = get_u16(buf + 14);
+    format->blockFrames = get_u32(buf + 16);
+    format->groupFrames = get_u16(buf + 20);
+    format->channelMask = get_u32(buf + 24);
+    return format_valid(format) && get_u32(buf + 28) == bfp_block_bytes(format);
+}
+
+// 读一个样本的高24位（右对齐、有符号）
+static inline int32_t load_s24(const uint8_t *s, uint32_t sampleBytes) {
+    s += sampleBytes - 3;
+    return (int32_t)(((uint32_t)s[0] << 8) | ((uint32_t)s[1] << 16) | ((uint32_t)s[2] << 24)) >> 8;
+}
+
+// 一组中一个通道的指数：先按绝对值的位数取能放进int16的最小移位，
+// 四舍五入可能让最大的正值进位到32768，这时再多移一位
+static uint32_t group_exponent(const uint8_t *src, size_t step, uint32_t sampleBytes, uint32_t frames) {
+    uint32_t bits = 0;
+    int32_t peak = 0;
+    for (uint32_t i = 0; i < frames; i++, src += step) {
+        int32_t x = load_s24(src, sampleBytes);
+        bits |= (uint32_t)(x ^ (x >> 31));     // 负数取 -x-1，与正数的位数一致
+        peak = (x > peak) ? x : peak;
+    }
+    uint32_t width = 0;
+    while ((bits >> width) != 0) {
+        width++;
+    }
+    uint32_t e = (width > 15) ? width - 15 : 0;
+    if (e > 0 && ((peak + (1 << (e - 1))) >> e) > 32767) {
+        e++;
+    }
+    return e;
+}
+
+size_t bfp_pack(const void *in, uint32_t sampleBytes, uint32_t channels, uint32_t frames, uint32_t groupFrames,
+                uint8_t *out) {
+    const uint8_t *src = in;
+    const size_t step = (size_t)channels * sampleBytes;
+    const uint32_t expBytes = bfp_exponent_bytes(channels);
+    uint8_t *dst = out;
+
+    for (uint32_t pos = 0; pos < frames; pos += groupFrames) {
+        uint32_t n = (frames - pos < groupFrames) ? frames - pos : groupFrames;
+        int16_t *mantissa = (int16_t *)(dst + expBytes);
+        memset(dst, 0, expBytes);
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            const uint8_t *s = src + (size_t)ch * sampleBytes;
+            uint32_t e = group_exponent(s, step, sampleBytes, n);
+            dst[ch] = (uint8_t)e;
+            int16_t *m = mantissa + ch;
+            if (e == 0) {
+                for (uint32_t i = 0; i < n; i++, s += step, m += channels) {
+                    *m = (int16_t)load_s24(s, sampleBytes);
+                }
+            } else {
+                const int32_t half = 1 << (e - 1);
+                for (uint32_t i = 0; i < n; i++, s += step, m += channels) {
+                    *m = (int16_t)((load_s24(s, sampleBytes) + half) >> e);
+                }
+            }
+        }
+        src += (size_t)n * step;
+        dst += expBytes + (size_t)n * channels * sizeof(int16_t);
+    }
+    return (size_t)(dst - out);
+}
+
+size_t bfp_unpack(const uint8_t *in, uint32_t channels, uint32_t frames, uint32_t groupFrames, int32_t *out,
+                  uint8_t *exponents) {
+    const uint32_t expBytes = bfp_exponent_bytes(channels);
+    const uint8_t *src = in;
+
+    for (uint32_t pos = 0; pos < frames; pos += groupFrames) {
+        uint32_t n = (frames - pos < groupFrames) ? frames - pos : groupFrames;
+        const int16_t *mantissa = (const int16_t *)(src + expBytes);
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            uint32_t e = (src[ch] <= BFP_MAX_EXPONENT) ? src[ch] : BFP_MAX_EXPONENT;
+            const int16_t *m = mantissa + ch;
+            int32_t *x = out + (size_t)pos * channels + ch;
+            for (uint32_t i = 0; i < n; i++, m += channels, x += channels) {
+                *x = (int32_t)((uint32_t)(int32_t)*m << e);
+            }
+            // 最大的指数只在满量程附近出现，进位后可能比24位正满量程大1
+            if (e == BFP_MAX_EXPONENT) {
+                x = out + (size_t)pos * channels + ch;
+                for (uint32_t i = 0; i < n; i++, x += channels) {
+                    *x = (*x > 0x7FFFFF) ? 0x7FFFFF : *x;
+                }
+            }
+            if (exponents != NULL) {
+                *exponents++ = (uint8_t)e;
+            }
+        }
+        src += expBytes + (size_t)n * channels * sizeof(int16_t);
+    }
+    return (size_t)(src - in);
+}
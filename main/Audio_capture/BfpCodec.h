@@ -0,0 +1,80 @@
+#ifndef BFP_CODEC_H
+#define BFP_CODEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 块浮点录音文件（.BFP）：24位采集按16位的带宽存储
+//
+// 每个块按groupFrames帧分组，组内每个通道共用一个指数e（0..BFP_MAX_EXPONENT），样本存为
+// 16位尾数 m = round(x / 2^e)，还原为 m x 2^e。e取使组内全部尾数都在int16范围内的最小值，
+// 因此安静的组（峰值低于-48dBFS）无损保留24位，其余的组误差比组内峰值低90dB以上：
+//   |x - m x 2^e| <= 2^(e-1)（e = 0时无损），x为24位样本
+// 24位输入每样本2 + 1/groupFrames字节（默认64帧一组时为原来的68%），32位容器取高24位。
+//
+// 头部固定为BFP_HEADER_BYTES(512)字节，之后是连续的定长块（每块blockBytes字节，块数由文件长度得出，
+// 末尾不完整的块应丢弃）。块内依次是各组，组g（最后一组可能不足groupFrames帧）：
+//   exponent[channels]（u8，补齐到偶数字节） mantissa[frames][channels]（int16小端，与采集同样交织）
+//
+// 头部布局（小端）：
+//   0   "BFPK"
+//   4   version(u16) headerBytes(u16)
+//   8   sampleRate(u32)
+//   12  channels(u16) sourceBits(u16)    采集的位深（24或32，还原后均为24位有效位）
+//   16  blockFrames(u32)
+//   20  groupFrames(u16) 保留(u16)
+//   24  channelMask(u32)                 文件中各通道对应的TDM槽位（0表示槽位0..channels-1）
+//   28  blockBytes(u32)
+//   32  保留，全0
+//
+// 不依赖ESP-IDF，可在主机上编译。
+
+#define BFP_HEADER_BYTES        512
+#define BFP_VERSION             1
+#define BFP_MAX_CHANNELS        32
+#define BFP_DEFAULT_GROUP       64
+#define BFP_MIN_GROUP           8
+#define BFP_MAX_GROUP           1024
+#define BFP_MAX_EXPONENT        9       // 24位满量程附近四舍五入后超出int16时多移一位
+
+typedef struct {
+    uint32_t sampleRate;
+    uint16_t channels;
+    uint16_t sourceBits;        // 24或32
+    uint32_t blockFrames;
+    uint32_t groupFrames;       // BFP_MIN_GROUP..BFP_MAX_GROUP
+    uint32_t channelMask;
+} BfpFormat;
+
+// 一组的指数字节数（补齐到偶数，使尾数2字节对齐）
+static inline uint32_t bfp_exponent_bytes(uint32_t channels) {
+    return (channels + 1) & ~1u;
+}
+
+// frames帧打包后的字节数
+static inline size_t bfp_packed_bytes(uint32_t channels, uint32_t frames, uint32_t groupFrames) {
+    uint32_t groups = (frames + groupFrames - 1) / groupFrames;
+    return (size_t)groups * bfp_exponent_bytes(channels) + (size_t)frames * channels * sizeof(int16_t);
+}
+
+// 每块的字节数
+static inline uint32_t bfp_block_bytes(const BfpFormat *format) {
+    return (uint32_t)bfp_packed_bytes(format->channels, format->blockFrames, format->groupFrames);
+}
+
+// 生成BFP_HEADER_BYTES字节的头部
+bool bfp_build_header(uint8_t *out, const BfpFormat *format);
+// 解析文件开头的头部
+bool bfp_parse_header(const uint8_t *buf, size_t len, BfpFormat *format);
+
+// 打包frames帧交织样本（sampleBytes为3: 小端24位打包；4: 32位容器，取高24位），返回写入out的字节数
+// （bfp_packed_bytes）。输出不能和输入重叠
+size_t bfp_pack(const void *in, uint32_t sampleBytes, uint32_t channels, uint32_t frames, uint32_t groupFrames,
+                uint8_t *out);
+// 还原为右对齐的24位样本（int32，交织），exponents非NULL时按组依次写出每个通道的指数
+// （组数 x channels个）；返回读取的字节数
+size_t bfp_unpack(const uint8_t *in, uint32_t channels, uint32_t frames, uint32_t groupFrames, int32_t *out,
+                  uint8_t *exponents);
+
+#endif /* BFP_CODEC_H */
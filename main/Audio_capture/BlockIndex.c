@@ -0,0 +1,84 @@
+#include "BlockIndex.h"
+#include <string.h>
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+static bool info_valid(const BlockIndexInfo *info) {
+    return info->sampleRate > 0 && info->channels > 0 && info->blockFrames > 0 &&
+           (info->bitsPerSample == 16 || info->bitsPerSample == 24 || info->bitsPerSample == 32);
+}
+
+bool block_index_build_header(uint8_t *out, const BlockIndexInfo *info) {
+    if (!info_valid(info)) {
+        return false;
+    }
+
+    memset(out, 0, BLOCK_INDEX_HEADER_BYTES);
+    memcpy(out, "BIDX", 4);
+    put_u16(out + 4, BLOCK_INDEX_VERSION);
+    put_u16(out + 6, BLOCK_INDEX_HEADER_BYTES);
+    put_u16(out + 8, BLOCK_INDEX_RECORD_BYTES);
+    put_u16(out + 10, info->channels);
+    put_u32(out + 12, info->sampleRate);
+    put_u32(out + 16, info->blockFrames);
+    put_u16(out + 20, info->bitsPerSample);
+    put_u64(out + 24, info->startUs);
+    return true;
+}
+
+bool block_index_parse_header(const uint8_t *buf, size_t len, BlockIndexInfo *info) {
+    if (len < 32 || memcmp(buf, "BIDX", 4) != 0 || get_u16(buf + 4) == 0 || get_u16(buf + 4) > BLOCK_INDEX_VERSION ||
+        get_u16(buf + 6) != BLOCK_INDEX_HEADER_BYTES || get_u16(buf + 8) != BLOCK_INDEX_RECORD_BYTES) {
+        return false;
+    }
+
+    info->channels = get_u16(buf + 10);
+    info->sampleRate = get_u32(buf + 12);
+    info->blockFrames = get_u32(buf + 16);
+    info->bitsPerSample = get_u16(buf + 20);
+    info->startUs = get_u64(buf + 24);
+    return info_valid(info);
+}
+
+void block_index_encode(uint8_t *out, const BlockIndexRecord *record) {
+    put_u32(out, (record->seq & ~BLOCK_INDEX_SEQ_CORRUPT) | (record->corrupt ? BLOCK_INDEX_SEQ_CORRUPT : 0));
+    put_u32(out + 4, record->droppedFrames);
+    put_u64(out + 8, record->firstSample);
+    put_u64(out + 16, record->captureUs);
+    put_u64(out + 24, record->offset);
+}
+
+void block_index_decode(const uint8_t *buf, BlockIndexRecord *record) {
+    uint32_t seq = get_u32(buf);
+    record->seq = seq & ~BLOCK_INDEX_SEQ_CORRUPT;
+    record->corrupt = (seq & BLOCK_INDEX_SEQ_CORRUPT) != 0;
+    record->droppedFrames = get_u32(buf + 4);
+    record->firstSample = get_u64(buf + 8);
+    record->captureUs = get_u64(buf + 16);
+    record->offset = get_u64(buf + 24);
+}
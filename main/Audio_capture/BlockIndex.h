@@ -0,0 +1,72 @@
+#ifndef BLOCK_INDEX_H
+#define BLOCK_INDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 块索引文件（.IDX）：与录音文件同名，逐块记录序号、首样本序号、采集时间和文件偏移
+//
+// 录音文件本身保持标准WAV/FLAC格式，不在数据中插入块头；每写出一个块，
+// 文件任务在索引文件中追加一条定长记录。首样本序号由采集侧按读出的帧数加上
+// 溢出丢失的帧数推导（零拷贝模式按DMA帧序号），因此两块首样本序号之差大于块长时
+// 中间就是丢失的样本：读取端按记录号直接定位（O(1)），把缺口补零即可与其他传感器对齐。
+// 事件录音模式下事件之间没有写出的样本同样表现为缺口，可以对照.EVT区分（见EventIndex.h）。
+//
+// 头部固定为BLOCK_INDEX_HEADER_BYTES(512)字节，之后是连续的记录（小端）：
+//   头部:
+//   0   "BIDX"
+//   4   version(u16) headerBytes(u16)
+//   8   recordBytes(u16) channels(u16)
+//   12  sampleRate(u32)
+//   16  blockFrames(u32)    每块的采样帧数
+//   20  bitsPerSample(u16) 保留(u16)
+//   24  startUs(u64)        打开文件时的esp_timer时间
+//   32  保留，全0
+//   记录k（32字节）:
+//   0   seq(u32)            低31位为文件中的块序号，从0连续递增；最高位(BLOCK_INDEX_SEQ_CORRUPT)表示
+//                           本块数据不可信（零拷贝模式下写出过程中被DMA覆盖），偏移和长度仍然有效
+//   4   droppedFrames(u32)  紧挨本块之前丢失的帧数（饱和到0xFFFFFFFF）
+//   8   firstSample(u64)    本块第一帧在本次录音中的序号（含丢失的帧；文件轮转时接着上一个文件继续计数）
+//   16  captureUs(u64)      本块最后一次读取完成的esp_timer时间
+//   24  offset(u64)         本块在录音文件中的偏移；长度为到下一条记录偏移（或文件末尾）的距离
+//
+// 版本1没有损坏标记，按版本2读取结果相同。
+//
+// 断电后索引文件可能比录音文件长，末尾还可能是预分配区域中的旧数据：
+// 读取端在序号不连续或偏移超出录音文件长度处停止。
+//
+// 不依赖ESP-IDF，可在主机上编译。
+
+#define BLOCK_INDEX_HEADER_BYTES    512
+#define BLOCK_INDEX_RECORD_BYTES    32
+#define BLOCK_INDEX_VERSION         2
+#define BLOCK_INDEX_SEQ_CORRUPT     0x80000000u
+
+typedef struct {
+    uint32_t sampleRate;
+    uint16_t channels;          // 录音文件中的通道数
+    uint16_t bitsPerSample;
+    uint32_t blockFrames;
+    uint64_t startUs;
+} BlockIndexInfo;
+
+typedef struct {
+    uint32_t seq;               // 不含BLOCK_INDEX_SEQ_CORRUPT
+    bool corrupt;
+    uint32_t droppedFrames;
+    uint64_t firstSample;
+    uint64_t captureUs;
+    uint64_t offset;
+} BlockIndexRecord;
+
+// 生成BLOCK_INDEX_HEADER_BYTES字节的头部
+bool block_index_build_header(uint8_t *out, const BlockIndexInfo *info);
+// 解析文件开头的头部
+bool block_index_parse_header(const uint8_t *buf, size_t len, BlockIndexInfo *info);
+
+// 编码/解码一条BLOCK_INDEX_RECORD_BYTES字节的记录
+void block_index_encode(uint8_t *out, const BlockIndexRecord *record);
+void block_index_decode(const uint8_t *buf, BlockIndexRecord *record);
+
+#endif /* BLOCK_INDEX_H */
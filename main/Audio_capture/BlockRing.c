@@ -0,0 +1,26 @@
+#include "BlockRing.h"
+
+// 初始化环
+void block_ring_init(BlockRing *ring, uint32_t capacity) {
+    ring->capacity = capacity;
+    ring->hasStage = false;
+    block_ring_reset(ring);
+}
+
+// 初始化带处理阶段的环
+void block_ring_init_staged(BlockRing *ring, uint32_t capacity) {
+    ring->capacity = capacity;
+    ring->hasStage = true;
+    block_ring_reset(ring);
+}
+
+// 清空环
+void block_ring_reset(BlockRing *ring) {
+    atomic_store_explicit(&ring->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->staged, 0, memory_order_relaxed);
+    ring->cachedTail = 0;
+    ring->cachedHead = 0;
+    ring->stageCachedHead = 0;
+    atomic_thread_fence(memory_order_seq_cst);
+}
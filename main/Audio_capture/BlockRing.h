@@ -0,0 +1,157 @@
+#ifndef BLOCK_RING_H
+#define BLOCK_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// 单生产者/单消费者(SPSC)无锁块环形队列
+//
+// 环本身只管理槽位索引，不持有数据：调用者自行维护一个长度为capacity的
+// 块数组，用返回的槽位号进行索引。head/tail在[0, 2*capacity)范围内循环
+// （镜像索引），因此满/空可以区分，且capacity不必是2的幂。
+//
+// 生产者: block_ring_acquire -> 填充数据 -> block_ring_commit
+// 消费者: block_ring_peek    -> 使用数据 -> block_ring_release
+//
+// 用block_ring_init_staged初始化时，生产者和消费者之间多一个原地处理阶段（如压缩），
+// 消费者只能看到已经处理完的块：
+// 处理阶段: block_ring_stage_peek -> 原地处理 -> block_ring_stage_commit
+//
+// 生产者和消费者字段分别放在独立的缓存行中，避免两个核心之间的伪共享。
+// 热路径函数为static inline，因此也可以在ISR中使用，且不依赖FreeRTOS，可在主机上编译。
+
+#define BLOCK_RING_CACHE_LINE  64
+
+typedef struct {
+    // 生产者写、消费者读
+    _Alignas(BLOCK_RING_CACHE_LINE) atomic_uint head;
+    uint32_t cachedTail;    // 生产者对tail的本地缓存，减少跨核读取
+
+    // 消费者写、生产者读
+    _Alignas(BLOCK_RING_CACHE_LINE) atomic_uint tail;
+    uint32_t cachedHead;    // 消费者对head（有处理阶段时为staged）的本地缓存
+
+    // 处理阶段写、消费者读（仅在启用处理阶段时使用）
+    _Alignas(BLOCK_RING_CACHE_LINE) atomic_uint staged;
+    uint32_t stageCachedHead;   // 处理阶段对head的本地缓存
+
+    // 初始化后只读
+    _Alignas(BLOCK_RING_CACHE_LINE) uint32_t capacity;
+    bool hasStage;
+} BlockRing;
+
+// 初始化环（capacity为槽位数量，必须 > 0）
+void block_ring_init(BlockRing *ring, uint32_t capacity);
+// 初始化带原地处理阶段的环
+void block_ring_init_staged(BlockRing *ring, uint32_t capacity);
+// 清空环（仅在生产者和消费者都停止时调用）
+void block_ring_reset(BlockRing *ring);
+
+// 镜像索引之间的距离
+static inline uint32_t block_ring_distance(const BlockRing *ring, uint32_t head, uint32_t tail) {
+    return (head >= tail) ? head - tail : head + 2 * ring->capacity - tail;
+}
+
+// 镜像索引前进一步
+static inline uint32_t block_ring_next(const BlockRing *ring, uint32_t index) {
+    return (index + 1 == 2 * ring->capacity) ? 0 : index + 1;
+}
+
+// 镜像索引对应的槽位号
+static inline uint32_t block_ring_slot(const BlockRing *ring, uint32_t index) {
+    return (index >= ring->capacity) ? index - ring->capacity : index;
+}
+
+// 当前已提交但尚未释放的块数量，含尚未处理的块（任意线程可调用，结果为近似值）
+static inline uint32_t block_ring_count(const BlockRing *ring) {
+    uint32_t head = atomic_load_explicit(&((BlockRing *)ring)->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&((BlockRing *)ring)->tail, memory_order_acquire);
+    return block_ring_distance(ring, head, tail);
+}
+
+// 已提交但尚未处理的块数量，没有处理阶段时为0（任意线程可调用，结果为近似值）
+static inline uint32_t block_ring_unstaged_count(const BlockRing *ring) {
+    if (!ring->hasStage) {
+        return 0;
+    }
+    uint32_t head = atomic_load_explicit(&((BlockRing *)ring)->head, memory_order_acquire);
+    uint32_t staged = atomic_load_explicit(&((BlockRing *)ring)->staged, memory_order_acquire);
+    return block_ring_distance(ring, head, staged);
+}
+
+// 生产者: 获取下一个可写槽位。环满时返回false。
+// 在commit之前重复调用会返回同一个槽位。
+static inline bool block_ring_acquire(BlockRing *ring, uint32_t *slot) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (block_ring_distance(ring, head, ring->cachedTail) >= ring->capacity) {
+        ring->cachedTail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (block_ring_distance(ring, head, ring->cachedTail) >= ring->capacity) {
+            return false;
+        }
+    }
+    *slot = block_ring_slot(ring, head);
+    return true;
+}
+
+// 生产者: 发布已填充的槽位
+static inline void block_ring_commit(BlockRing *ring) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    atomic_store_explicit(&ring->head, block_ring_next(ring, head), memory_order_release);
+}
+
+// 处理阶段: 获取最早提交但尚未处理的槽位。没有待处理的块时返回false。
+static inline bool block_ring_stage_peek(BlockRing *ring, uint32_t *slot) {
+    uint32_t staged = atomic_load_explicit(&ring->staged, memory_order_relaxed);
+    if (staged == ring->stageCachedHead) {
+        ring->stageCachedHead = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (staged == ring->stageCachedHead) {
+            return false;
+        }
+    }
+    *slot = block_ring_slot(ring, staged);
+    return true;
+}
+
+// 处理阶段: 把处理完的槽位交给消费者
+static inline void block_ring_stage_commit(BlockRing *ring) {
+    uint32_t staged = atomic_load_explicit(&ring->staged, memory_order_relaxed);
+    atomic_store_explicit(&ring->staged, block_ring_next(ring, staged), memory_order_release);
+}
+
+// 消费者: 获取最早提交（有处理阶段时为最早处理完）的槽位。环空时返回false。
+static inline bool block_ring_peek(BlockRing *ring, uint32_t *slot) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (tail == ring->cachedHead) {
+        ring->cachedHead = atomic_load_explicit(ring->hasStage ? &ring->staged : &ring->head,
+                                                memory_order_acquire);
+        if (tail == ring->cachedHead) {
+            return false;
+        }
+    }
+    *slot = block_ring_slot(ring, tail);
+    return true;
+}
+
+// 消费者: 获取从最早的块往后第n个已提交的槽位（n = 0时与block_ring_peek相同）
+static inline bool block_ring_peek_nth(BlockRing *ring, uint32_t n, uint32_t *slot) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(ring->hasStage ? &ring->staged : &ring->head, memory_order_acquire);
+    if (n >= block_ring_distance(ring, head, tail)) {
+        return false;
+    }
+    uint32_t index = tail + n;
+    if (index >= 2 * ring->capacity) {
+        index -= 2 * ring->capacity;
+    }
+    *slot = block_ring_slot(ring, index);
+    return true;
+}
+
+// 消费者: 归还已处理完的槽位
+static inline void block_ring_release(BlockRing *ring) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, block_ring_next(ring, tail), memory_order_release);
+}
+
+#endif /* BLOCK_RING_H */
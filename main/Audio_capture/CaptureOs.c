@@ -0,0 +1,366 @@
+#if !defined(ESP_PLATFORM) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // 主机: pthread_attr_setaffinity_np
+#endif
+#include "CaptureOs.h"
+
+#ifdef ESP_PLATFORM
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+
+static TickType_t ticks_for(uint32_t timeoutMs) {
+    return (timeoutMs == CAPTURE_OS_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+}
+
+capture_sem_t capture_os_sem_create(void) {
+    return (capture_sem_t)xSemaphoreCreateBinary();
+}
+
+void capture_os_sem_delete(capture_sem_t sem) {
+    vSemaphoreDelete((SemaphoreHandle_t)sem);
+}
+
+void capture_os_sem_give(capture_sem_t sem) {
+    xSemaphoreGive((SemaphoreHandle_t)sem);
+}
+
+IRAM_ATTR bool capture_os_sem_give_from_isr(capture_sem_t sem) {
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR((SemaphoreHandle_t)sem, &woken);
+    return woken == pdTRUE;
+}
+
+bool capture_os_sem_take(capture_sem_t sem, uint32_t timeoutMs) {
+    return xSemaphoreTake((SemaphoreHandle_t)sem, ticks_for(timeoutMs)) == pdTRUE;
+}
+
+bool capture_os_task_create(capture_task_fn_t fn, const char *name, uint32_t stackBytes, void *arg,
+                            uint32_t priority, int core, capture_task_t *task) {
+    TaskHandle_t handle = NULL;
+    if (xTaskCreatePinnedToCore(fn, name, stackBytes, arg, priority, &handle, core) != pdPASS) {
+        return false;
+    }
+    *task = (capture_task_t)handle;
+    return true;
+}
+
+void capture_os_task_delete(capture_task_t task) {
+    vTaskDelete((TaskHandle_t)task);
+}
+
+void capture_os_notify_give(capture_task_t task) {
+    xTaskNotifyGive((TaskHandle_t)task);
+}
+
+bool capture_os_notify_take(uint32_t timeoutMs) {
+    return ulTaskNotifyTake(pdTRUE, ticks_for(timeoutMs)) != 0;
+}
+
+void capture_os_suspend_self(void) {
+    vTaskSuspend(NULL);
+}
+
+void capture_os_task_resume(capture_task_t task) {
+    vTaskResume((TaskHandle_t)task);
+}
+
+bool capture_os_task_is_suspended(capture_task_t task) {
+    return eTaskGetState((TaskHandle_t)task) == eSuspended;
+}
+
+int64_t capture_os_now_us(void) {
+    return esp_timer_get_time();
+}
+
+void capture_os_delay_ms(uint32_t ms) {
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+void *capture_os_alloc(size_t size, capture_mem_t type) {
+    if (type == CAPTURE_MEM_FAST) {
+        return heap_caps_malloc_prefer(size, 2, MALLOC_CAP_INTERNAL, MALLOC_CAP_SPIRAM);
+    }
+    if (type == CAPTURE_MEM_SPIRAM) {
+        return heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    }
+    return heap_caps_malloc(size, MALLOC_CAP_DMA);
+}
+
+void capture_os_free(void *ptr) {
+    heap_caps_free(ptr);
+}
+
+size_t capture_os_spiram_largest_free(void) {
+    return heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+}
+
+#else  // 主机: POSIX线程
+
+#include <pthread.h>
+#include <unistd.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+
+bool capture_os_verbose = false;
+
+struct capture_sem {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool given;
+};
+
+struct capture_task {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notifications;
+    bool suspended;
+    atomic_bool deleted;
+    capture_task_fn_t fn;
+    void *arg;
+};
+
+static __thread struct capture_task *currentTask = NULL;
+
+// 截止时间（CLOCK_MONOTONIC，条件变量按此时钟初始化）
+static struct timespec deadline_after(uint32_t timeoutMs) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += timeoutMs / 1000;
+    ts.tv_nsec += (long)(timeoutMs % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+static void cond_init_monotonic(pthread_cond_t *cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+// 在条件变量上等待，直到pred为真、超时或当前任务被删除；返回pred
+static bool wait_until(pthread_mutex_t *lock, pthread_cond_t *cond, bool (*pred)(void *), void *ctx,
+                       uint32_t timeoutMs) {
+    struct timespec deadline = deadline_after(timeoutMs);
+    while (!pred(ctx)) {
+        if (currentTask != NULL && currentTask->deleted) {
+            return false;
+        }
+        if (timeoutMs == CAPTURE_OS_WAIT_FOREVER) {
+            // 周期性醒来检查删除标志
+            struct timespec tick = deadline_after(50);
+            pthread_cond_timedwait(cond, lock, &tick);
+        } else if (pthread_cond_timedwait(cond, lock, &deadline) == ETIMEDOUT) {
+            return pred(ctx);
+        }
+    }
+    return true;
+}
+
+// 当前任务已被删除时退出线程
+static void exit_if_deleted(void) {
+    if (currentTask != NULL && currentTask->deleted) {
+        pthread_exit(NULL);
+    }
+}
+
+capture_sem_t capture_os_sem_create(void) {
+    struct capture_sem *sem = calloc(1, sizeof(*sem));
+    if (sem == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&sem->lock, NULL);
+    cond_init_monotonic(&sem->cond);
+    return sem;
+}
+
+void capture_os_sem_delete(capture_sem_t sem) {
+    pthread_mutex_destroy(&sem->lock);
+    pthread_cond_destroy(&sem->cond);
+    free(sem);
+}
+
+void capture_os_sem_give(capture_sem_t sem) {
+    pthread_mutex_lock(&sem->lock);
+    sem->given = true;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->lock);
+}
+
+bool capture_os_sem_give_from_isr(capture_sem_t sem) {
+    capture_os_sem_give(sem);
+    return false;
+}
+
+static bool sem_given(void *ctx) {
+    return ((struct capture_sem *)ctx)->given;
+}
+
+bool capture_os_sem_take(capture_sem_t sem, uint32_t timeoutMs) {
+    pthread_mutex_lock(&sem->lock);
+    bool taken = wait_until(&sem->lock, &sem->cond, sem_given, sem, timeoutMs);
+    if (taken) {
+        sem->given = false;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    exit_if_deleted();
+    return taken;
+}
+
+static void *task_entry(void *arg) {
+    currentTask = arg;
+    currentTask->fn(currentTask->arg);
+    return NULL;
+}
+
+bool capture_os_task_create(capture_task_fn_t fn, const char *name, uint32_t stackBytes, void *arg,
+                            uint32_t priority, int core, capture_task_t *task) {
+    struct capture_task *t = calloc(1, sizeof(*t));
+    if (t == NULL) {
+        return false;
+    }
+    pthread_mutex_init(&t->lock, NULL);
+    cond_init_monotonic(&t->cond);
+    t->fn = fn;
+    t->arg = arg;
+
+    // 有权限时按FreeRTOS优先级使用实时调度，使采集任务能抢占文件任务；否则退回普通调度
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    struct sched_param param = { .sched_priority = sched_get_priority_min(SCHED_FIFO) + (int)priority };
+    pthread_attr_setschedparam(&attr, &param);
+    // 主机至少有两个CPU时按设备的核心绑定，同一核心上的任务按优先级互相抢占
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (core >= 0 && cpus >= 2) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core % cpus, &set);
+        pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+    }
+    int err = pthread_create(&t->thread, &attr, task_entry, t);
+    pthread_attr_destroy(&attr);
+    if (err == EPERM) {
+        err = pthread_create(&t->thread, NULL, task_entry, t);
+    }
+    if (err != 0) {
+        free(t);
+        return false;
+    }
+    *task = t;
+    return true;
+}
+
+void capture_os_task_delete(capture_task_t task) {
+    if (task == NULL) {
+        // 删除自身：没有其他人会再引用这个句柄，分离线程后退出
+        currentTask->deleted = true;
+        pthread_detach(pthread_self());
+        pthread_exit(NULL);
+    }
+
+    pthread_mutex_lock(&task->lock);
+    task->deleted = true;
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    if (!pthread_equal(task->thread, pthread_self())) {
+        pthread_join(task->thread, NULL);
+    }
+    pthread_mutex_destroy(&task->lock);
+    pthread_cond_destroy(&task->cond);
+    free(task);
+}
+
+void capture_os_notify_give(capture_task_t task) {
+    pthread_mutex_lock(&task->lock);
+    task->notifications++;
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+}
+
+static bool has_notification(void *ctx) {
+    return ((struct capture_task *)ctx)->notifications > 0;
+}
+
+bool capture_os_notify_take(uint32_t timeoutMs) {
+    struct capture_task *t = currentTask;
+    pthread_mutex_lock(&t->lock);
+    bool got = wait_until(&t->lock, &t->cond, has_notification, t, timeoutMs);
+    t->notifications = 0;
+    pthread_mutex_unlock(&t->lock);
+    exit_if_deleted();
+    return got;
+}
+
+static bool not_suspended(void *ctx) {
+    return !((struct capture_task *)ctx)->suspended;
+}
+
+void capture_os_suspend_self(void) {
+    struct capture_task *t = currentTask;
+    pthread_mutex_lock(&t->lock);
+    t->suspended = true;
+    pthread_cond_broadcast(&t->cond);
+    wait_until(&t->lock, &t->cond, not_suspended, t, CAPTURE_OS_WAIT_FOREVER);
+    pthread_mutex_unlock(&t->lock);
+    exit_if_deleted();
+}
+
+void capture_os_task_resume(capture_task_t task) {
+    pthread_mutex_lock(&task->lock);
+    task->suspended = false;
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+}
+
+bool capture_os_task_is_suspended(capture_task_t task) {
+    pthread_mutex_lock(&task->lock);
+    bool suspended = task->suspended;
+    pthread_mutex_unlock(&task->lock);
+    return suspended;
+}
+
+int64_t capture_os_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void capture_os_delay_ms(uint32_t ms) {
+    struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+    exit_if_deleted();
+}
+
+void *capture_os_alloc(size_t size, capture_mem_t type) {
+    // 与DMA缓冲区一样按缓存行对齐
+    void *ptr = NULL;
+    if (posix_memalign(&ptr, 64, size) != 0) {
+        return NULL;
+    }
+    return ptr;
+}
+
+void capture_os_free(void *ptr) {
+    free(ptr);
+}
+
+size_t capture_os_host_spiram_bytes = 8 * 1024 * 1024;
+
+size_t capture_os_spiram_largest_free(void) {
+    return capture_os_host_spiram_bytes;
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef CAPTURE_OS_H
+#define CAPTURE_OS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 采集链路使用的操作系统抽象：任务、二值信号量、任务通知、时间、内存和日志
+//
+// ESP32上直接映射到FreeRTOS/heap_caps/esp_timer/esp_log；主机上用POSIX线程实现，
+// 因此CapturePipeline可以在Linux上以真实的任务结构运行。
+//
+// 主机实现的约定：
+//  - 任务通知是计数的，capture_os_notify_take()取走全部通知（与ulTaskNotifyTake(pdTRUE, ...)相同）
+//  - capture_os_task_delete()只能删除阻塞在本模块原语（信号量、通知、挂起、延时）中的任务，
+//    被删除的任务在下一次进入这些原语时退出线程
+//  - 核心号和栈大小被忽略；有权限时优先级映射为SCHED_FIFO实时优先级，否则所有任务同等调度
+
+#define CAPTURE_OS_WAIT_FOREVER  UINT32_MAX
+
+typedef struct capture_sem *capture_sem_t;
+typedef struct capture_task *capture_task_t;
+
+typedef void (*capture_task_fn_t)(void *arg);
+
+// 内存类型
+typedef enum {
+    CAPTURE_MEM_DMA = 0,        // 外设DMA可访问（内部RAM）
+    CAPTURE_MEM_FAST,           // 优先内部RAM，不足时使用PSRAM
+    CAPTURE_MEM_SPIRAM,         // PSRAM（大容量，不能直接用于SD卡DMA）
+} capture_mem_t;
+
+// 二值信号量
+capture_sem_t capture_os_sem_create(void);
+void capture_os_sem_delete(capture_sem_t sem);
+void capture_os_sem_give(capture_sem_t sem);
+// ISR中释放，返回是否唤醒了更高优先级的任务
+bool capture_os_sem_give_from_isr(capture_sem_t sem);
+// 等待信号量，超时返回false
+bool capture_os_sem_take(capture_sem_t sem, uint32_t timeoutMs);
+
+// 任务
+bool capture_os_task_create(capture_task_fn_t fn, const char *name, uint32_t stackBytes, void *arg,
+                            uint32_t priority, int core, capture_task_t *task);
+// 删除任务，task为NULL时删除当前任务（不返回）
+void capture_os_task_delete(capture_task_t task);
+void capture_os_notify_give(capture_task_t task);
+// 当前任务等待通知，返回是否收到（并清零通知计数）
+bool capture_os_notify_take(uint32_t timeoutMs);
+// 挂起当前任务，直到capture_os_task_resume
+void capture_os_suspend_self(void);
+void capture_os_task_resume(capture_task_t task);
+bool capture_os_task_is_suspended(capture_task_t task);
+
+// 时间
+int64_t capture_os_now_us(void);
+void capture_os_delay_ms(uint32_t ms);
+
+// 内存
+void *capture_os_alloc(size_t size, capture_mem_t type);
+void capture_os_free(void *ptr);
+// PSRAM中最大的连续空闲块（没有PSRAM时为0）
+size_t capture_os_spiram_largest_free(void);
+#ifndef ESP_PLATFORM
+extern size_t capture_os_host_spiram_bytes;     // 主机上模拟的PSRAM大小，默认8MB
+#endif
+
+// 日志和ISR属性
+#ifdef ESP_PLATFORM
+#include "esp_log.h"
+#include "esp_attr.h"
+#define CAPTURE_LOGE(tag, fmt, ...)  ESP_LOGE(tag, fmt, ##__VA_ARGS__)
+#define CAPTURE_LOGW(tag, fmt, ...)  ESP_LOGW(tag, fmt, ##__VA_ARGS__)
+#define CAPTURE_LOGI(tag, fmt, ...)  ESP_LOGI(tag, fmt, ##__VA_ARGS__)
+#define CAPTURE_ISR_ATTR             IRAM_ATTR
+#else
+#include <stdio.h>
+extern bool capture_os_verbose;     // 主机上默认只输出警告和错误
+#define CAPTURE_LOGE(tag, fmt, ...)  fprintf(stderr, "E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define CAPTURE_LOGW(tag, fmt, ...)  fprintf(stderr, "W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define CAPTURE_LOGI(tag, fmt, ...) \
+    do { if (capture_os_verbose) fprintf(stderr, "I %s: " fmt "\n", tag, ##__VA_ARGS__); } while (0)
+#define CAPTURE_ISR_ATTR
+#endif
+
+#endif /* CAPTURE_OS_H */
@@ -0,0 +1,2235 @@
+#include "CapturePipeline.h"
+#include "Deinterleave.h"
+#include "ChannelCompact.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "CapturePipeline";
+
+#define FLAC_BLOCK_CAPACITY(p, channels) \
+    FLAC_MAX_FRAME_BYTES((channels), (p)->timing.blockFrames, (p)->config.profile.bitsPerSample)
+
+_Static_assert(FLAC_HEADER_BYTES == WAV_HEADER_BYTES && PLANAR_HEADER_BYTES == WAV_HEADER_BYTES &&
+               BFP_HEADER_BYTES == WAV_HEADER_BYTES && BLOCK_INDEX_HEADER_BYTES == WAV_HEADER_BYTES &&
+               EVENT_INDEX_HEADER_BYTES == WAV_HEADER_BYTES,
+               "file headers share one sector-sized buffer");
+_Static_assert(DOA_INDEX_MAX_PAIRS == DOA_MAX_PAIRS, "the DOA index header lists every estimator pair");
+_Static_assert(FEATURE_INDEX_MAX_CHANNELS == FEATURE_MAX_CHANNELS && FEATURE_INDEX_MAX_BANDS == FEATURE_MAX_BANDS,
+               "a feature index record holds every extractor channel and band");
+
+static uint32_t mask_all(const CapturePipelineConfig *config) {
+    return (config->slots >= 32) ? UINT32_MAX : ((1u << config->slots) - 1);
+}
+
+bool capture_pipeline_stage_enabled(const CapturePipelineConfig *config) {
+    return config->codec != AUDIO_CODEC_PCM || config->layout == AUDIO_LAYOUT_PLANAR ||
+           config->channelMask != mask_all(config) || config->processHook != NULL ||
+           config->beamOutput != AUDIO_BEAM_OFF || config->doaEstimate || config->rates.outputs != 0 ||
+           config->features;
+}
+
+// 当前编码和布局对应的文件扩展名
+static const char *audio_file_ext(const CapturePipeline *p) {
+    if (p->config.codec == AUDIO_CODEC_FLAC) {
+        return p->config.flacExt;
+    }
+    if (p->config.codec == AUDIO_CODEC_BFP) {
+        return p->config.bfpExt;
+    }
+    return (p->config.layout == AUDIO_LAYOUT_PLANAR) ? p->config.planarExt : p->config.pcmExt;
+}
+
+// 轮转标记：时长到期或文件任务请求（文件超过大小上限）时，这一块作为新文件的第一块。
+// 在采集一侧标记，FLAC编码器才能在同一块上重新开始（新文件的帧序号从0开始）
+static void mark_file_start(CapturePipeline *p, AudioBlock *block) {
+    block->fileStart = false;
+    if (block->streamStart) {
+        p->rotateStartUs = block->readDoneUs;
+        return;
+    }
+    // 请求针对的是采集一侧的当前文件时才有效（上一次标记的块还没写到时，旧文件仍在超过上限）
+    bool due = p->config.rotateBytes != 0 &&
+               atomic_load_explicit(&p->rotateRequest, memory_order_acquire) == p->rotateMarks + 1;
+    if (p->config.rotateMs != 0 && block->readDoneUs - p->rotateStartUs >= (int64_t)p->config.rotateMs * 1000) {
+        due = true;
+    }
+    if (due) {
+        block->fileStart = true;
+        p->rotateMarks++;
+        p->rotateStartUs = block->readDoneUs;
+    }
+}
+
+// 把一个填满的块发布给文件任务（启用处理阶段时先交给处理任务）
+static void publish_block(CapturePipeline *p, AudioBlock *block, capture_sem_t readySem) {
+    mark_file_start(p, block);
+    // 没有处理阶段时，块提交后立即对文件任务可见
+    if (readySem == p->dataReadySem) {
+        block->stagedUs = capture_os_now_us();
+        capture_stats_block_committed(&p->stats, (uint32_t)(block->stagedUs - block->readDoneUs));
+    }
+    block_ring_commit(&p->ring);
+    capture_os_sem_give(readySem);
+}
+
+// 溢出环中的块按顺序搬回内部环，直到溢出环空或内部环满（事件模式下只搬属于事件的块）
+static void refill_from_spill(CapturePipeline *p, capture_sem_t readySem) {
+    uint32_t spillSlot, slot;
+    while ((!p->config.eventCapture || p->spillKeep > 0) && block_ring_peek(&p->spillRing, &spillSlot) &&
+           block_ring_acquire(&p->ring, &slot)) {
+        const AudioBlock *spilled = &p->spillBlocks[spillSlot];
+        AudioBlock *block = &p->blocks[slot];
+        memcpy(block->data, spilled->data, spilled->length);
+        block->length = spilled->length;
+        block->streamStart = spilled->streamStart;
+        block->readDoneUs = spilled->readDoneUs;
+        block->firstSample = spilled->firstSample;
+        block->eventMark = spilled->eventMark;
+        block->event = spilled->event;
+        block->hasSync = spilled->hasSync;
+        block->sync = spilled->sync;
+        block_ring_release(&p->spillRing);
+        if (p->spillKeep > 0) {
+            p->spillKeep--;
+        }
+        publish_block(p, block, readySem);
+    }
+}
+
+// 事件模式未触发时：丢弃最早的预录块，使预录不超过preRollBlocks（属于事件的块还没搬走时不丢弃）
+static void trim_pre_roll(CapturePipeline *p) {
+    while (p->spillKeep == 0 && block_ring_count(&p->spillRing) > p->preRollBlocks) {
+        block_ring_release(&p->spillRing);
+    }
+}
+
+// 内部环满：按当时持有多数块的阶段（处理或写出）记一次背压，环一直满着时只记一次
+static void note_backpressure(CapturePipeline *p) {
+    if (p->ringFull) {
+        return;
+    }
+    p->ringFull = true;
+    uint32_t toProcess = block_ring_unstaged_count(&p->ring);
+    uint32_t queued = block_ring_count(&p->ring);
+    capture_stats_backpressure(&p->stats, toProcess, (queued > toProcess) ? queued - toProcess : 0);
+}
+
+// 选择下一个要填充的块：溢出环非空时必须继续写溢出环，保证块的顺序；
+// 事件模式未触发时所有块都先进入溢出环作为预录
+static AudioBlock *next_capture_block(CapturePipeline *p, bool preRoll, bool *spilled) {
+    uint32_t slot;
+    if (!preRoll && block_ring_count(&p->spillRing) == 0) {
+        if (block_ring_acquire(&p->ring, &slot)) {
+            p->ringFull = false;
+            *spilled = false;
+            return &p->blocks[slot];
+        }
+        note_backpressure(p);
+    }
+    if (p->spillCapacity > 0 && block_ring_acquire(&p->spillRing, &slot)) {
+        *spilled = true;
+        return &p->spillBlocks[slot];
+    }
+    return NULL;
+}
+
+// 事件触发：刚提交到溢出环的块和它之前的预录都属于事件，在最早的预录块上记录触发信息
+static void start_event(CapturePipeline *p, const AudioBlock *block, const EventTrigger *trigger,
+                        bool *streamStart) {
+    uint32_t slot;
+    if (!block_ring_peek_nth(&p->spillRing, p->spillKeep, &slot)) {
+        return;
+    }
+    AudioBlock *first = &p->spillBlocks[slot];
+    first->eventMark |= AUDIO_BLOCK_EVENT_START;
+    first->streamStart = *streamStart;
+    first->event = (EventIndexRecord){
+        .reasons = (uint8_t)trigger->reasons,
+        .channel = (uint8_t)trigger->channel,
+        .levelCentiDb = (int16_t)(trigger->levelDbfs * 100.0f),
+        .triggerSample = block->firstSample,
+        .triggerUs = (uint64_t)block->readDoneUs,
+    };
+    *streamStart = false;
+    p->spillKeep = block_ring_count(&p->spillRing);
+    p->events++;
+    CAPTURE_LOGI(TAG, "Event %u: reasons 0x%x, channel %u at %.1f dBFS", (unsigned)p->events,
+                 (unsigned)trigger->reasons, (unsigned)trigger->channel, (double)trigger->levelDbfs);
+}
+
+// 同步：丢弃驱动中积压的数据并等到下一个DMA缓冲区完成，录音的第一帧就是此时DMA计数之后的
+// 下一个缓冲区的第一帧（采集任务的优先级只低于中断，取计数之前不会再完成一个缓冲区）
+static void start_sync(CapturePipeline *p) {
+    CaptureReader *reader = p->config.reader;
+    if (!reader->flush(reader)) {
+        CAPTURE_LOGW(TAG, "Failed to flush the reader, no sync records for this recording");
+        return;
+    }
+    sync_clock_start(p->config.syncClock, sync_clock_dma_count(p->config.syncClock));
+}
+
+// 复制模式的采集任务
+static void capture_task(void *arg) {
+    CapturePipeline *p = arg;
+    CaptureReader *reader = p->config.reader;
+    size_t bytes_read;
+    size_t writePos = 0;  // 当前块的本地写入位置
+    bool streamStart = true;
+    AudioBlock *block = NULL;   // 正在填充的块（内部环或溢出环的槽位）
+    bool spilled = false;
+    // 样本计数：下一个读出的帧在本次录音中的序号，溢出丢失的DMA缓冲区也计入
+    uint64_t sampleIndex = 0;
+    uint64_t blockFirst = 0;
+    uint32_t overrunsSeen = atomic_load_explicit(&p->stats.overruns, memory_order_relaxed);
+    // 事件模式：是否在事件中，以及剩余的后录块数
+    bool eventActive = false;
+    uint32_t postRoll = 0;
+    SyncClock *syncClock = p->config.syncClock;
+    bool syncPending = syncClock != NULL;
+    capture_sem_t readySem = capture_pipeline_stage_enabled(&p->config) ? p->processReadySem : p->dataReadySem;
+
+    CAPTURE_LOGI(TAG, "Audio capture task started");
+
+    while (1) {
+        // 检查任务是否应该暂停
+        if (capture_os_notify_take(0)) {
+            // 溢出环中待写的块全部交给文件任务（文件任务此时正在清空内部环），
+            // 未填满的块和预录被丢弃
+            refill_from_spill(p, readySem);
+            while (block_ring_count(&p->spillRing) > 0 && (!p->config.eventCapture || p->spillKeep > 0)) {
+                capture_os_sem_take(p->spaceFreeSem, 100);
+                refill_from_spill(p, readySem);
+            }
+            while (block_ring_count(&p->spillRing) > 0) {
+                block_ring_release(&p->spillRing);
+            }
+            p->spillKeep = 0;
+            if (syncClock != NULL) {
+                sync_clock_stop(syncClock);
+                syncPending = true;
+            }
+            CAPTURE_LOGI(TAG, "Audio capture task going to suspend");
+            capture_os_suspend_self();
+            CAPTURE_LOGI(TAG, "Audio capture task resumed");
+            block = NULL;
+            writePos = 0;
+            streamStart = true;
+            p->ringFull = false;
+            sampleIndex = 0;
+            overrunsSeen = atomic_load_explicit(&p->stats.overruns, memory_order_relaxed);
+            eventActive = false;
+            if (p->config.eventCapture) {
+                event_detector_reset(&p->detector);
+            }
+            continue;
+        }
+
+        // 开始或恢复录音：样本序号从下一个DMA缓冲区开始（清空时丢弃的数据不计入溢出）
+        if (syncPending) {
+            start_sync(p);
+            syncPending = false;
+            overrunsSeen = atomic_load_explicit(&p->stats.overruns, memory_order_relaxed);
+        }
+
+        // 文件任务释放了内部块：先把溢出的块按顺序搬回去
+        if (p->spillCapacity > 0) {
+            refill_from_spill(p, readySem);
+        }
+
+        // 获取下一个空闲块；两个环都满时等待消费者释放，而不是轮询
+        if (block == NULL) {
+            bool preRoll = p->config.eventCapture && !eventActive;
+            if (preRoll) {
+                trim_pre_roll(p);
+            }
+            block = next_capture_block(p, preRoll, &spilled);
+            if (block == NULL) {
+                capture_os_sem_take(p->spaceFreeSem, 100);
+                continue;
+            }
+        }
+
+        // 直接读取到块的剩余空间
+        if (!reader->read(reader, block->data + writePos, block->size - writePos, &bytes_read)) {
+            CAPTURE_LOGW(TAG, "Capture read error");
+            continue;
+        }
+
+        // 读取期间或之前发生了溢出：丢失的是比本次读出的数据更早的DMA缓冲区，计入样本序号。
+        // 块中已有的数据在缺口之前，丢弃它们并把本次数据移到块首，使每个块内部的样本连续，
+        // 缺口只出现在块之间（统计被清零时重新同步，不计丢失）
+        uint32_t overruns = atomic_load_explicit(&p->stats.overruns, memory_order_relaxed);
+        if (overruns != overrunsSeen) {
+            if (overruns > overrunsSeen) {
+                sampleIndex += (uint64_t)(overruns - overrunsSeen) * p->timing.dmaFrameNum;
+                if (writePos > 0) {
+                    capture_stats_frames_discarded(&p->stats, writePos / p->timing.frameBytes);
+                    memmove(block->data, block->data + writePos, bytes_read);
+                    writePos = 0;
+                }
+            }
+            overrunsSeen = overruns;
+        }
+        if (writePos == 0) {
+            blockFirst = sampleIndex;
+        }
+        writePos += bytes_read;
+        sampleIndex += bytes_read / p->timing.frameBytes;
+
+        if (writePos < block->size) {
+            continue;
+        }
+
+        // 块已满：发布给文件任务（启用处理阶段时先交给处理任务），溢出块留在溢出环中等待搬回
+        writePos = 0;
+        block->length = block->size;
+        block->readDoneUs = capture_os_now_us();
+        if (p->config.levelTap != NULL) {
+            level_tap_feed(p->config.levelTap, block->data, p->timing.blockFrames, block->readDoneUs);
+        }
+        block->firstSample = blockFirst;
+        block->eventMark = 0;
+        block->hasSync = syncClock != NULL && sync_clock_poll(syncClock, &block->sync);
+        bool written = true;        // 这一块最终会写入文件（事件模式下未触发的预录可能被丢弃）
+        bool newEvent = false;
+        EventTrigger trigger;
+        if (!p->config.eventCapture) {
+            block->streamStart = streamStart;
+            streamStart = false;
+        } else {
+            // 事件模式：文件中的第一块是第一个事件的预录开始，由start_event标记
+            block->streamStart = false;
+            bool hit = event_detector_process(&p->detector, block->data, p->timing.blockFrames, &trigger);
+            if (eventActive) {
+                postRoll = hit ? p->postRollBlocks : postRoll - 1;
+                if (postRoll == 0) {
+                    block->eventMark |= AUDIO_BLOCK_EVENT_END;
+                    eventActive = false;
+                }
+            } else if (hit) {
+                eventActive = true;
+                newEvent = true;
+                postRoll = p->postRollBlocks;
+            } else {
+                written = false;
+            }
+        }
+
+        if (spilled) {
+            block_ring_commit(&p->spillRing);
+            if (newEvent) {
+                start_event(p, block, &trigger, &streamStart);
+            } else if (p->config.eventCapture && written) {
+                p->spillKeep++;
+            }
+            if (written) {
+                capture_stats_block_spilled(&p->stats, block_ring_count(&p->spillRing));
+            }
+        } else {
+            publish_block(p, block, readySem);
+        }
+        block = NULL;
+    }
+}
+
+// 原地去掉未选中的通道
+static void compact_block(CapturePipeline *p, AudioBlock *block) {
+    uint32_t sampleBytes = p->timing.sampleBytes;
+    uint32_t kept;
+    if (sampleBytes == 2) {
+        kept = channel_compact_s16((const int16_t *)block->data, (int16_t *)block->data,
+                                   p->config.slots, p->config.channelMask, p->timing.blockFrames);
+    } else {
+        kept = channel_compact_bytes(block->data, block->data, sampleBytes,
+                                     p->config.slots, p->config.channelMask, p->timing.blockFrames);
+    }
+    block->length = (size_t)p->timing.blockFrames * kept * sampleBytes;
+}
+
+// 波束形成：AUDIO_BEAM_ONLY时原地替换块中的通道，AUDIO_BEAM_WITH_RAW时写入块的波束缓冲区
+static void beamform_block(CapturePipeline *p, AudioBlock *block) {
+    // 开始或恢复录音时样本不连续，丢弃上一段的历史样本（轮转时录音是连续的）
+    if (block->streamStart) {
+        beamformer_reset(&p->beamformer);
+    }
+
+    uint32_t frames = p->timing.blockFrames;
+    size_t beamBytes = (size_t)frames * p->beamformer.beams * sizeof(int16_t);
+    if (p->config.beamOutput == AUDIO_BEAM_ONLY) {
+        beamformer_process(&p->beamformer, (const int16_t *)block->data, frames, (int16_t *)block->data);
+        block->length = beamBytes;
+    } else {
+        beamformer_process(&p->beamformer, (const int16_t *)block->data, frames, (int16_t *)block->beamData);
+        block->beamLength = beamBytes;
+    }
+}
+
+// 方位估计：块中是选中的通道（未经波束形成），完成的结果随块交给文件任务写入方位索引
+static void estimate_doa(CapturePipeline *p, AudioBlock *block) {
+    if (block->streamStart) {
+        doa_estimator_reset(&p->doaEstimator);
+    }
+
+    DoaEstimate estimates[AUDIO_BLOCK_MAX_DOA];
+    uint32_t count = doa_estimator_feed(&p->doaEstimator, (const int16_t *)block->data, p->timing.blockFrames,
+                                        block->firstSample, estimates, AUDIO_BLOCK_MAX_DOA);
+    for (uint32_t i = 0; i < count; i++) {
+        const DoaEstimate *e = &estimates[i];
+        block->doa[i] = (DoaIndexRecord){
+            .samplePos = e->samplePos,
+            .azimuth = (uint16_t)(lroundf(e->azimuthDeg * 100.0f) % 36000),
+            .confidence = (uint16_t)lroundf(e->confidence * 65535.0f),
+            .windows = (uint16_t)((e->windows > UINT16_MAX) ? UINT16_MAX : e->windows),
+        };
+    }
+    block->doaCount = count;
+}
+
+// 声学特征：块中是选中的通道（未经波束形成），完成的结果编码为特征索引记录随块交给文件任务写入
+static void extract_features(CapturePipeline *p, AudioBlock *block) {
+    FeatureExtractor *fx = &p->features;
+    FeatureIndexRecord *rec = &p->featureRecord;
+    if (block->streamStart) {
+        feature_extractor_reset(fx);
+    }
+
+    const uint8_t *data = block->data;
+    size_t frameBytes = (size_t)fx->channels * p->timing.sampleBytes;
+    uint32_t done = 0;
+    block->featureLength = 0;
+    while (done < p->timing.blockFrames) {
+        bool ready;
+        done += feature_extractor_feed(fx, data + done * frameBytes, p->timing.sampleBytes,
+                                       p->timing.blockFrames - done, block->firstSample + done, &ready);
+        if (!ready) {
+            continue;
+        }
+        const FeatureResult *r = &fx->result;
+        rec->samplePos = r->samplePos;
+        rec->windows = (uint16_t)((r->windows > UINT16_MAX) ? UINT16_MAX : r->windows);
+        for (uint32_t ch = 0; ch < fx->channels; ch++) {
+            rec->rms[ch] = feature_index_power_code(r->rms[ch] * r->rms[ch]);
+            rec->peak[ch] = feature_index_amplitude_code(r->peak[ch]);
+            rec->zcrHz[ch] = (uint16_t)lroundf(r->zcrHz[ch]);
+            for (uint32_t b = 0; b < fx->bands; b++) {
+                rec->band[ch][b] = feature_index_power_code(r->band[ch][b]);
+            }
+        }
+        feature_index_encode(block->featureData + block->featureLength, rec, fx->channels, fx->bands);
+        block->featureLength += p->featureRecordBytes;
+    }
+}
+
+// 多采样率输出：块中是选中的通道（未经波束形成），抽取出的各路样本写入块的输出缓冲区
+static void decimate_block(CapturePipeline *p, AudioBlock *block) {
+    if (block->streamStart) {
+        decimator_reset(&p->decimator);
+    }
+
+    int16_t *out[DECIMATOR_MAX_OUTPUTS];
+    uint32_t frames[DECIMATOR_MAX_OUTPUTS];
+    for (uint32_t i = 0; i < p->decimator.outputs; i++) {
+        out[i] = (int16_t *)block->rateData[i];
+    }
+    decimator_process(&p->decimator, block->data, p->timing.sampleBytes, p->timing.blockFrames, out, frames);
+    for (uint32_t i = 0; i < p->decimator.outputs; i++) {
+        block->rateLength[i] = (size_t)frames[i] * p->decimator.channels * sizeof(int16_t);
+    }
+}
+
+// 把一个PCM块原地压缩为一个FLAC帧
+static void compress_block(CapturePipeline *p, AudioBlock *block) {
+    // 每次开始录音或轮转都是一个新文件，帧序号从0开始
+    if (block->streamStart || block->fileStart) {
+        flac_encoder_reset(&p->flacEncoder);
+    }
+
+    memcpy(p->processScratch, block->data, block->length);
+    uint32_t frames = block->length / wav_block_align(&p->wavFormat);
+    size_t frameBytes = flac_encode_frame(&p->flacEncoder, (const int16_t *)p->processScratch, frames,
+                                          block->data, block->capacity);
+    if (frameBytes == 0) {
+        // 退回为不压缩的VERBATIM帧：块仍然写入文件，帧序号保持连续
+        capture_stats_flac_fallback(&p->stats);
+        frameBytes = flac_encode_verbatim_frame(&p->flacEncoder, (const int16_t *)p->processScratch, frames,
+                                                block->data, block->capacity);
+        CAPTURE_LOGW(TAG, "FLAC encoding failed, block %s", (frameBytes != 0) ? "stored verbatim" : "dropped");
+    }
+    block->length = frameBytes;
+}
+
+// 把一个24/32位块打包为块浮点：写入工作缓冲区后与块缓冲区交换（打包后的块总是比原来短）
+static void pack_block(CapturePipeline *p, AudioBlock *block) {
+    uint32_t frames = block->length / wav_block_align(&p->wavFormat);
+    uint8_t *packed = p->processScratch;
+    size_t length = bfp_pack(block->data, p->timing.sampleBytes, p->bfpFormat.channels, frames,
+                             p->bfpFormat.groupFrames, packed);
+    p->processScratch = block->data;
+    block->data = packed;
+    block->length = length;
+}
+
+// 把一个交织块解交织为按通道的平面：写入工作缓冲区后与块缓冲区交换，不需要再拷贝回去
+static void deinterleave_block(CapturePipeline *p, AudioBlock *block) {
+    uint32_t frames = block->length / wav_block_align(&p->wavFormat);
+
+    if (p->wavFormat.containerBits == 32) {
+        deinterleave_s32((const int32_t *)block->data, (int32_t *)p->processScratch, p->wavFormat.channels, frames);
+    } else {
+        deinterleave_s16((const int16_t *)block->data, (int16_t *)p->processScratch, p->wavFormat.channels, frames);
+    }
+
+    uint8_t *planar = p->processScratch;
+    p->processScratch = block->data;
+    block->data = planar;
+}
+
+// 处理任务：在采集核心上原地处理已提交的块（去掉未用通道、方位估计、声学特征、多采样率输出、波束形成、
+// 压缩、块浮点打包或解交织），再交给文件任务
+static void process_task(void *arg) {
+    CapturePipeline *p = arg;
+    uint32_t slot;
+
+    CAPTURE_LOGI(TAG, "Processing task started");
+
+    while (1) {
+        if (!block_ring_stage_peek(&p->ring, &slot)) {
+            capture_os_sem_take(p->processReadySem, 100);
+            continue;
+        }
+        AudioBlock *block = &p->blocks[slot];
+        uint32_t depth = block_ring_unstaged_count(&p->ring);
+        int64_t start = capture_os_now_us();
+        if (p->config.channelMask != mask_all(&p->config)) {
+            compact_block(p, block);
+        }
+        if (p->config.processHook != NULL) {
+            p->config.processHook(p->config.processCtx, block->data, block->length, p->timing.blockFrames);
+        }
+        if (p->config.doaEstimate) {
+            estimate_doa(p, block);
+        }
+        if (p->config.features) {
+            extract_features(p, block);
+        }
+        if (p->config.rates.outputs != 0) {
+            decimate_block(p, block);
+        }
+        if (p->config.beamOutput != AUDIO_BEAM_OFF) {
+            beamform_block(p, block);
+        }
+        if (p->config.codec == AUDIO_CODEC_FLAC) {
+            compress_block(p, block);
+        } else if (p->config.codec == AUDIO_CODEC_BFP) {
+            pack_block(p, block);
+        } else if (p->config.layout == AUDIO_LAYOUT_PLANAR) {
+            deinterleave_block(p, block);
+        }
+        // 提交之后块可能马上被释放并重新填充，先记录延迟
+        block->stagedUs = capture_os_now_us();
+        capture_stats_block_processed(&p->stats, (uint32_t)(start - block->readDoneUs),
+                                      (uint32_t)(block->stagedUs - start), depth);
+        capture_stats_block_committed(&p->stats, (uint32_t)(block->stagedUs - block->readDoneUs));
+        block_ring_stage_commit(&p->ring);
+        capture_os_sem_give(p->dataReadySem);
+    }
+}
+
+// 零拷贝模式的帧回调（ISR上下文）
+static CAPTURE_ISR_ATTR bool zero_copy_on_frame(void *ctx, const uint8_t *frame, size_t len) {
+    CapturePipeline *p = ctx;
+    if (!atomic_load_explicit(&p->dmaCaptureEnabled, memory_order_relaxed)) {
+        return false;
+    }
+
+    if (dma_block_assembler_push(&p->dmaAssembler, frame, len)) {
+        return capture_os_sem_give_from_isr(p->dataReadySem);
+    }
+    return false;
+}
+
+// 零拷贝模式下的采集任务：数据由ISR直接入环，任务只负责暂停/恢复
+static void zero_copy_capture_task(void *arg) {
+    CapturePipeline *p = arg;
+    CAPTURE_LOGI(TAG, "Zero-copy capture task started");
+    atomic_store(&p->dmaCaptureEnabled, true);
+
+    while (1) {
+        capture_os_notify_take(CAPTURE_OS_WAIT_FOREVER);
+
+        // 停止入环，等待正在执行的回调结束后丢弃未凑满的块
+        atomic_store(&p->dmaCaptureEnabled, false);
+        capture_os_delay_ms(10);
+        dma_block_assembler_abort_partial(&p->dmaAssembler);
+
+        CAPTURE_LOGI(TAG, "Audio capture task going to suspend");
+        capture_os_suspend_self();
+        CAPTURE_LOGI(TAG, "Audio capture task resumed");
+        atomic_store(&p->dmaCaptureEnabled, true);
+    }
+}
+
+// 当前模式使用的块环
+static BlockRing *capture_ring(CapturePipeline *p) {
+    return (p->config.mode == AUDIO_CAPTURE_MODE_ZERO_COPY) ? &p->dmaAssembler.ring : &p->ring;
+}
+
+// 原地写出一个零拷贝块，返回写入的字节数（写卡失败时ok为false，写出过程中被DMA覆盖时corrupt为true）
+static size_t write_dma_block(CapturePipeline *p, const DmaBlock *block, bool *ok, bool *corrupt) {
+    // 暂停期间滞留在环中的块可能已被DMA覆盖，直接丢弃
+    *ok = true;
+    *corrupt = false;
+    if (dma_block_assembler_is_stale(&p->dmaAssembler, block)) {
+        p->staleBlocks++;
+        CAPTURE_LOGW(TAG, "Dropped zero-copy block overwritten by DMA (%u total)", (unsigned)p->staleBlocks);
+        return 0;
+    }
+
+    // 内存中相邻的DMA帧合并为一次写入
+    uint32_t i = 0;
+    while (i < block->numFrames) {
+        const uint8_t *run = block->frames[i];
+        size_t runLen = block->frameBytes;
+        for (i++; i < block->numFrames && block->frames[i] == run + runLen; i++) {
+            runLen += block->frameBytes;
+        }
+        if (!record_writer_write(&p->file->writer, run, runLen)) {
+            CAPTURE_LOGW(TAG, "Failed to write %d bytes to file", (int)runLen);
+            *ok = false;
+        }
+    }
+
+    // 写出过程中DMA绕回：文件中的这一块数据不可信，在索引中标记为损坏
+    if (dma_block_assembler_is_stale(&p->dmaAssembler, block)) {
+        p->staleBlocks++;
+        *corrupt = true;
+        CAPTURE_LOGW(TAG, "Zero-copy block overwritten by DMA during write (%u total)", (unsigned)p->staleBlocks);
+    }
+    return dma_block_bytes(block);
+}
+
+// 将一个块写入当前文件，返回写入的字节数（写卡失败时ok为false）
+static size_t write_block(CapturePipeline *p, const AudioBlock *block, bool *ok) {
+    *ok = true;
+    if (block->length == 0) {
+        return 0;
+    }
+    if (!record_writer_write(&p->file->writer, block->data, block->length)) {
+        CAPTURE_LOGW(TAG, "Failed to write %d bytes to file", (int)block->length);
+        *ok = false;
+        return block->length;
+    }
+
+    if (p->config.codec == AUDIO_CODEC_FLAC) {
+        FlacStreamInfo *stream = &p->file->flacStream;
+        stream->totalSamples += p->timing.blockFrames;
+        if (stream->minFrameBytes == 0 || block->length < stream->minFrameBytes) {
+            stream->minFrameBytes = block->length;
+        }
+        if (block->length > stream->maxFrameBytes) {
+            stream->maxFrameBytes = block->length;
+        }
+    }
+    return block->length;
+}
+
+// 波束文件：失败时关闭，录音照常进行
+static void write_beam_block(CapturePipeline *p, const AudioBlock *block) {
+    CaptureFile *f = p->file;
+    if (!record_writer_is_open(&f->beamWriter)) {
+        return;
+    }
+    if (!record_writer_write(&f->beamWriter, block->beamData, block->beamLength)) {
+        CAPTURE_LOGW(TAG, "Failed to write beams, beam file closed: %s", f->beamPath);
+        record_writer_close(&f->beamWriter);
+    }
+}
+
+// 多采样率输出文件：失败时只关闭这一路，录音照常进行
+static void write_rate_blocks(CapturePipeline *p, const AudioBlock *block) {
+    CaptureFile *f = p->file;
+    for (uint32_t i = 0; i < p->decimator.outputs; i++) {
+        if (!record_writer_is_open(&f->rateWriter[i]) || block->rateLength[i] == 0) {
+            continue;
+        }
+        if (!record_writer_write(&f->rateWriter[i], block->rateData[i], block->rateLength[i])) {
+            CAPTURE_LOGW(TAG, "Failed to write rate output, file closed: %s", f->ratePath[i]);
+            record_writer_close(&f->rateWriter[i]);
+        }
+    }
+}
+
+// 附属文件的写入器、扩展名和路径，恢复日志按这个顺序登记
+#define CAPTURE_SIDECARS    (6 + DECIMATOR_MAX_OUTPUTS)
+_Static_assert(CAPTURE_SIDECARS <= RECOVERY_SIDECARS_MAX, "recovery journal cannot hold every sidecar");
+
+static void capture_file_sidecars(CapturePipeline *p, CaptureFile *f, RecordWriter **writer, const char **ext,
+                                  const char **path) {
+    uint32_t n = 0;
+    writer[n] = &f->indexWriter;
+    path[n] = f->indexPath;
+    ext[n++] = p->config.indexExt;
+    writer[n] = &f->eventWriter;
+    path[n] = f->eventPath;
+    ext[n++] = p->config.eventExt;
+    writer[n] = &f->syncWriter;
+    path[n] = f->syncPath;
+    ext[n++] = p->config.syncExt;
+    writer[n] = &f->beamWriter;
+    path[n] = f->beamPath;
+    ext[n++] = p->config.beamExt;
+    writer[n] = &f->doaWriter;
+    path[n] = f->doaPath;
+    ext[n++] = p->config.doaExt;
+    writer[n] = &f->featureWriter;
+    path[n] = f->featurePath;
+    ext[n++] = p->config.featureExt;
+    for (uint32_t i = 0; i < DECIMATOR_MAX_OUTPUTS; i++) {
+        writer[n] = &f->rateWriter[i];
+        path[n] = f->ratePath[i];
+        ext[n++] = p->config.rateExt[i];
+    }
+}
+
+// 把当前文件和它打开的附属文件登记到恢复日志
+static void begin_journal(CapturePipeline *p) {
+    RecordWriter *writer[CAPTURE_SIDECARS];
+    const char *ext[CAPTURE_SIDECARS];
+    const char *path[CAPTURE_SIDECARS];
+    capture_file_sidecars(p, p->file, writer, ext, path);
+    for (uint32_t i = 0; i < CAPTURE_SIDECARS; i++) {
+        if (!record_writer_is_open(writer[i])) {
+            ext[i] = NULL;
+        }
+    }
+    if (!recovery_journal_begin(&p->journal, p->file->path, ext, CAPTURE_SIDECARS)) {
+        CAPTURE_LOGW(TAG, "Failed to update recovery journal");
+    }
+}
+
+// 检查点：回写文件头、更新FAT/目录项，然后把录音文件和附属文件的长度提交到恢复日志
+// （轮转后新文件登记到日志之前不提交，日志里还是上一个文件；写入失败已关闭的附属文件提交为0）
+static void checkpoint_audio_file(CapturePipeline *p) {
+    CaptureFile *f = p->file;
+    p->lastCheckpointUs = capture_os_now_us();
+    if (record_writer_is_open(&f->indexWriter) && !record_writer_checkpoint(&f->indexWriter)) {
+        CAPTURE_LOGW(TAG, "Checkpoint failed: %s", f->indexPath);
+    }
+    if (record_writer_is_open(&f->eventWriter) && !record_writer_checkpoint(&f->eventWriter)) {
+        CAPTURE_LOGW(TAG, "Checkpoint failed: %s", f->eventPath);
+    }
+    if (record_writer_is_open(&f->syncWriter) && !record_writer_checkpoint(&f->syncWriter)) {
+        CAPTURE_LOGW(TAG, "Checkpoint failed: %s", f->syncPath);
+    }
+    if (record_writer_is_open(&f->beamWriter) && !record_writer_checkpoint(&f->beamWriter)) {
+        CAPTURE_LOGW(TAG, "Checkpoint failed: %s", f->beamPath);
+    }
+    if (record_writer_is_open(&f->doaWriter) && !record_writer_checkpoint(&f->doaWriter)) {
+        CAPTURE_LOGW(TAG, "Checkpoint failed: %s", f->doaPath);
+    }
+    if (record_writer_is_open(&f->featureWriter) && !record_writer_checkpoint(&f->featureWriter)) {
+        CAPTURE_LOGW(TAG, "Checkpoint failed: %s", f->featurePath);
+    }
+    for (uint32_t i = 0; i < DECIMATOR_MAX_OUTPUTS; i++) {
+        if (record_writer_is_open(&f->rateWriter[i]) && !record_writer_checkpoint(&f->rateWriter[i])) {
+            CAPTURE_LOGW(TAG, "Checkpoint failed: %s", f->ratePath[i]);
+        }
+    }
+    if (!record_writer_checkpoint(&f->writer)) {
+        CAPTURE_LOGW(TAG, "Checkpoint failed: %s", f->path);
+        return;
+    }
+    if (p->config.journalPath == NULL || p->journalPending) {
+        return;
+    }
+    RecordWriter *writer[CAPTURE_SIDECARS];
+    const char *ext[CAPTURE_SIDECARS];
+    const char *path[CAPTURE_SIDECARS];
+    uint64_t sidecarBytes[CAPTURE_SIDECARS];
+    capture_file_sidecars(p, f, writer, ext, path);
+    for (uint32_t i = 0; i < CAPTURE_SIDECARS; i++) {
+        sidecarBytes[i] = record_writer_is_open(writer[i]) ? record_writer_flushed_bytes(writer[i]) : 0;
+    }
+    if (!recovery_journal_commit(&p->journal, p->blockSeq, record_writer_flushed_bytes(&f->writer), sidecarBytes)) {
+        CAPTURE_LOGW(TAG, "Failed to update recovery journal");
+    }
+}
+
+// 在块索引中追加一条记录；丢失的帧数由首样本序号与上一块的结束位置之差得出
+static void index_block(CapturePipeline *p, uint64_t firstSample, int64_t captureUs, uint64_t offset,
+                        bool corrupt) {
+    CaptureFile *f = p->file;
+    if (!record_writer_is_open(&f->indexWriter)) {
+        return;
+    }
+    uint64_t dropped = (firstSample > p->nextSample) ? firstSample - p->nextSample : 0;
+    BlockIndexRecord record = {
+        .seq = p->blockSeq,
+        .corrupt = corrupt,
+        .droppedFrames = (dropped > UINT32_MAX) ? UINT32_MAX : (uint32_t)dropped,
+        .firstSample = firstSample,
+        .captureUs = (uint64_t)captureUs,
+        .offset = offset,
+    };
+
+    uint8_t buf[BLOCK_INDEX_RECORD_BYTES];
+    block_index_encode(buf, &record);
+    if (!record_writer_write(&f->indexWriter, buf, sizeof(buf))) {
+        CAPTURE_LOGW(TAG, "Failed to write block index, index disabled for %s", f->path);
+        record_writer_close(&f->indexWriter);
+    }
+}
+
+// 结束正在写出的事件，在事件索引中追加一条记录
+static void close_event(CapturePipeline *p) {
+    if (!p->eventOpen) {
+        return;
+    }
+    p->eventOpen = false;
+    p->openEvent.seq = p->eventSeq++;
+    p->openEvent.endSample = p->nextSample;
+    CaptureFile *f = p->file;
+    if (!record_writer_is_open(&f->eventWriter)) {
+        return;
+    }
+
+    uint8_t buf[EVENT_INDEX_RECORD_BYTES];
+    event_index_encode(buf, &p->openEvent);
+    if (!record_writer_write(&f->eventWriter, buf, sizeof(buf))) {
+        CAPTURE_LOGW(TAG, "Failed to write event index, index disabled for %s", f->path);
+        record_writer_close(&f->eventWriter);
+    }
+}
+
+// 在同步索引中追加一条参考脉冲记录
+static void write_sync_record(CapturePipeline *p, const SyncIndexRecord *record) {
+    CaptureFile *f = p->file;
+    if (!record_writer_is_open(&f->syncWriter)) {
+        return;
+    }
+
+    uint8_t buf[SYNC_INDEX_RECORD_BYTES];
+    sync_index_encode(buf, record);
+    if (!record_writer_write(&f->syncWriter, buf, sizeof(buf))) {
+        CAPTURE_LOGW(TAG, "Failed to write sync index, index disabled for %s", f->path);
+        record_writer_close(&f->syncWriter);
+    }
+}
+
+// 在方位索引中追加一条估计结果
+static void write_doa_record(CapturePipeline *p, const DoaIndexRecord *record) {
+    CaptureFile *f = p->file;
+    if (!record_writer_is_open(&f->doaWriter)) {
+        return;
+    }
+
+    uint8_t buf[DOA_INDEX_RECORD_BYTES];
+    doa_index_encode(buf, record);
+    if (!record_writer_write(&f->doaWriter, buf, sizeof(buf))) {
+        CAPTURE_LOGW(TAG, "Failed to write DOA index, index disabled for %s", f->path);
+        record_writer_close(&f->doaWriter);
+    }
+}
+
+// 在特征索引中追加一块的记录
+static void write_feature_records(CapturePipeline *p, const AudioBlock *block) {
+    CaptureFile *f = p->file;
+    if (!record_writer_is_open(&f->featureWriter)) {
+        return;
+    }
+    if (!record_writer_write(&f->featureWriter, block->featureData, block->featureLength)) {
+        CAPTURE_LOGW(TAG, "Failed to write feature index, index disabled for %s", f->path);
+        record_writer_close(&f->featureWriter);
+    }
+}
+
+// 零拷贝块的首样本序号：DMA帧序号相对录音第一块的偏移（轮转时不变）
+static uint64_t dma_block_first_sample(CapturePipeline *p, const DmaBlock *block) {
+    if (!p->zcBaseValid) {
+        p->zcBaseFrame = block->firstFrame;
+        p->zcBaseValid = true;
+    }
+    return (uint64_t)(block->firstFrame - p->zcBaseFrame) * p->config.zcDmaFrameNum;
+}
+
+// 检查点回调：用当前已落盘的数据长度重写WAV头
+static bool update_wav_header(RecordWriter *writer, void *ctx) {
+    CaptureFile *f = ctx;
+    const WavFormat *format = &f->pipeline->wavFormat;
+    uint64_t dataBytes = record_writer_flushed_bytes(writer) - WAV_HEADER_BYTES;
+    dataBytes -= dataBytes % wav_block_align(format);
+
+    if (!wav_build_header(f->header, format, dataBytes)) {
+        return false;
+    }
+    return record_writer_write_at(writer, 0, f->header, WAV_HEADER_BYTES);
+}
+
+// 波束文件的检查点回调：同update_wav_header，格式为beamFormat
+static bool update_beam_header(RecordWriter *writer, void *ctx) {
+    CaptureFile *f = ctx;
+    const WavFormat *format = &f->pipeline->beamFormat;
+    uint64_t dataBytes = record_writer_flushed_bytes(writer) - WAV_HEADER_BYTES;
+    dataBytes -= dataBytes % wav_block_align(format);
+
+    if (!wav_build_header(f->header, format, dataBytes)) {
+        return false;
+    }
+    return record_writer_write_at(writer, 0, f->header, WAV_HEADER_BYTES);
+}
+
+// 多采样率输出文件的检查点回调：同update_wav_header，格式为这一路的rateFormat
+static bool update_rate_header(RecordWriter *writer, void *ctx) {
+    CaptureFile *f = ctx;
+    const WavFormat *format = &f->pipeline->rateFormat[writer - f->rateWriter];
+    uint64_t dataBytes = record_writer_flushed_bytes(writer) - WAV_HEADER_BYTES;
+    dataBytes -= dataBytes % wav_block_align(format);
+
+    if (!wav_build_header(f->header, format, dataBytes)) {
+        return false;
+    }
+    return record_writer_write_at(writer, 0, f->header, WAV_HEADER_BYTES);
+}
+
+// 检查点回调：重写STREAMINFO。最后一帧还有一部分在暂存区时，
+// 已落盘的部分不是整数帧，总样本数写0（未知），由解码器读到文件末尾。
+static bool update_flac_header(RecordWriter *writer, void *ctx) {
+    CaptureFile *f = ctx;
+    FlacStreamInfo info = f->flacStream;
+    if (record_writer_flushed_bytes(writer) != writer->bytesWritten) {
+        info.totalSamples = 0;
+    }
+
+    if (!flac_build_header(f->header, &f->pipeline->flacConfig, &info)) {
+        return false;
+    }
+    return record_writer_write_at(writer, 0, f->header, FLAC_HEADER_BYTES);
+}
+
+// 打开与录音文件同名、扩展名为ext的附属文件，并写入f->header中的头部；
+// 失败时只记录日志，录音照常进行
+static void open_sidecar_file(CapturePipeline *p, CaptureFile *f, RecordWriter *writer, char *path,
+                              const char *ext, uint64_t preallocBytes, const char *what) {
+    snprintf(path, CAPTURE_PIPELINE_PATH_MAX, "%s", f->path);
+    char *dot = strrchr(path, '.');
+    if (dot == NULL || (size_t)(dot - path) + strlen(ext) >= CAPTURE_PIPELINE_PATH_MAX) {
+        return;
+    }
+    strcpy(dot, ext);
+
+    if (!record_writer_open(writer, p->config.backend, path, preallocBytes, 0)) {
+        CAPTURE_LOGW(TAG, "Failed to open %s: %s", what, path);
+        return;
+    }
+    if (!record_writer_write(writer, f->header, WAV_HEADER_BYTES)) {
+        CAPTURE_LOGW(TAG, "Failed to write %s header: %s", what, path);
+        record_writer_close(writer);
+    }
+}
+
+// 块索引头部，startUs为文件开始录音的时间
+static bool build_index_header(CapturePipeline *p, CaptureFile *f, int64_t startUs) {
+    BlockIndexInfo info = {
+        .sampleRate = p->config.profile.sampleRate,
+        .channels = p->wavFormat.channels,
+        .bitsPerSample = p->config.profile.bitsPerSample,
+        .blockFrames = (p->config.mode == AUDIO_CAPTURE_MODE_ZERO_COPY)
+                           ? p->config.zcFramesPerBlock * p->config.zcDmaFrameNum
+                           : p->timing.blockFrames,
+        .startUs = (uint64_t)startUs,
+    };
+    return block_index_build_header(f->header, &info);
+}
+
+// 块索引：每个块一条记录，预分配录音文件的1/256（32KB的块对应32字节，压缩后的块更小，留出余量）
+static void open_index_file(CapturePipeline *p, CaptureFile *f) {
+    if (!build_index_header(p, f, capture_os_now_us())) {
+        return;
+    }
+    open_sidecar_file(p, f, &f->indexWriter, f->indexPath, p->config.indexExt, p->config.preallocBytes / 256,
+                      "block index");
+}
+
+// 阈值换算为事件索引头部的0.01dB，未启用的条件记为EVENT_INDEX_LEVEL_OFF
+static int16_t event_threshold_centi_db(float db, bool enabled) {
+    return enabled ? (int16_t)(db * 100.0f) : EVENT_INDEX_LEVEL_OFF;
+}
+
+// 事件索引头部，startUs为文件开始录音的时间
+static void build_event_header(CapturePipeline *p, CaptureFile *f, int64_t startUs) {
+    const EventDetectorConfig *d = &p->config.detector;
+    EventIndexInfo info = {
+        .sampleRate = p->config.profile.sampleRate,
+        .channels = p->wavFormat.channels,
+        .preRollMs = p->config.preRollMs,
+        .postRollMs = p->config.postRollMs,
+        .rmsCentiDb = event_threshold_centi_db(d->rmsDbfs, d->rmsDbfs < 0.0f),
+        .peakCentiDb = event_threshold_centi_db(d->peakDbfs, d->peakDbfs <= 0.0f),
+        .vadCentiDb = event_threshold_centi_db(d->vadMarginDb, d->vadMarginDb > 0.0f),
+        .startUs = (uint64_t)startUs,
+    };
+    event_index_build_header(f->header, &info);
+}
+
+// 事件索引：事件很少，预分配一个簇即可（文件按需增长）
+static void open_event_file(CapturePipeline *p, CaptureFile *f) {
+    build_event_header(p, f, capture_os_now_us());
+    open_sidecar_file(p, f, &f->eventWriter, f->eventPath, p->config.eventExt, 32 * 1024, "event index");
+}
+
+// 同步索引头部，startUs为文件开始录音的时间
+static void build_sync_header(CapturePipeline *p, CaptureFile *f, int64_t startUs) {
+    SyncIndexInfo info = {
+        .sampleRate = p->config.profile.sampleRate,
+        .periodMs = p->config.syncPeriodMs,
+        .startUs = (uint64_t)startUs,
+    };
+    sync_index_build_header(f->header, &info);
+}
+
+// 同步索引：每个参考脉冲32字节，预分配一个簇即可（文件按需增长）
+static void open_sync_file(CapturePipeline *p, CaptureFile *f) {
+    build_sync_header(p, f, capture_os_now_us());
+    open_sidecar_file(p, f, &f->syncWriter, f->syncPath, p->config.syncExt, 32 * 1024, "sync index");
+}
+
+// 方位索引头部，startUs为文件开始录音的时间
+static void build_doa_header(CapturePipeline *p, CaptureFile *f, int64_t startUs) {
+    const DoaEstimator *est = &p->doaEstimator;
+    const DoaConfig *doa = &p->config.doa;
+    DoaIndexInfo info = {
+        .sampleRate = p->config.profile.sampleRate,
+        .frameSize = est->frameSize,
+        .hopFrames = est->hopFrames,
+        .reportFrames = est->windowsPerReport * est->hopFrames,
+        .minHz = (uint16_t)((doa->minHz > 0.0f) ? doa->minHz : 0.0f),
+        .maxHz = (uint16_t)((doa->maxHz > 0.0f && doa->maxHz < UINT16_MAX) ? doa->maxHz : 0.0f),
+        .pairs = est->pairs,
+        .startUs = (uint64_t)startUs,
+    };
+    memcpy(info.pair, est->pairSlot, sizeof(info.pair));
+    doa_index_build_header(f->header, &info);
+}
+
+// 方位索引：每个结果16字节（50次/秒约2.9MB/小时），预分配一个簇，文件按需增长
+static void open_doa_file(CapturePipeline *p, CaptureFile *f) {
+    build_doa_header(p, f, capture_os_now_us());
+    open_sidecar_file(p, f, &f->doaWriter, f->doaPath, p->config.doaExt, 32 * 1024, "DOA index");
+}
+
+// 特征索引头部，startUs为文件开始录音的时间
+static void build_feature_header(CapturePipeline *p, CaptureFile *f, int64_t startUs) {
+    const FeatureExtractor *fx = &p->features;
+    FeatureIndexInfo info = {
+        .sampleRate = p->config.profile.sampleRate,
+        .reportFrames = fx->reportFrames,
+        .frameSize = fx->frameSize,
+        .channels = fx->channels,
+        .channelMask = p->config.channelMask,
+        .bands = fx->bands,
+        .startUs = (uint64_t)startUs,
+    };
+    for (uint32_t b = 0; b < fx->bands; b++) {
+        float low, high;
+        feature_extractor_band_hz(fx, b, &low, &high);
+        info.bandEdgeHz[b] = (uint16_t)lroundf(low);
+        info.bandEdgeHz[b + 1] = (uint16_t)lroundf(high);
+    }
+    feature_index_build_header(f->header, &info);
+}
+
+// 特征索引：按记录与录音的字节率之比预分配（8通道、32个频带、100ms一条时约为96kHz/16位录音的0.2%）
+static void open_feature_file(CapturePipeline *p, CaptureFile *f) {
+    uint64_t rawRate = (uint64_t)p->wavFormat.sampleRate * wav_block_align(&p->wavFormat);
+    uint64_t prealloc = p->config.preallocBytes * p->featureRecordBytes * p->wavFormat.sampleRate /
+                        p->features.reportFrames / rawRate;
+    prealloc = (prealloc + RECORD_SECTOR_SIZE - 1) / RECORD_SECTOR_SIZE * RECORD_SECTOR_SIZE;
+    build_feature_header(p, f, capture_os_now_us());
+    open_sidecar_file(p, f, &f->featureWriter, f->featurePath, p->config.featureExt, prealloc, "feature index");
+}
+
+// 波束文件：WAV格式，按波束数与录音通道数之比预分配
+static void open_beam_file(CapturePipeline *p, CaptureFile *f) {
+    wav_build_header(f->header, &p->beamFormat, 0);
+    uint64_t prealloc = p->config.preallocBytes * p->beamFormat.channels / p->wavFormat.channels;
+    prealloc = (prealloc + RECORD_SECTOR_SIZE - 1) / RECORD_SECTOR_SIZE * RECORD_SECTOR_SIZE;
+    open_sidecar_file(p, f, &f->beamWriter, f->beamPath, p->config.beamExt, prealloc, "beam file");
+    if (record_writer_is_open(&f->beamWriter)) {
+        record_writer_set_checkpoint_hook(&f->beamWriter, update_beam_header, f);
+    }
+}
+
+// 多采样率输出文件：16位WAV，按与录音文件的字节率之比预分配
+static void open_rate_files(CapturePipeline *p, CaptureFile *f) {
+    uint64_t rawRate = (uint64_t)p->wavFormat.sampleRate * wav_block_align(&p->wavFormat);
+    for (uint32_t i = 0; i < p->decimator.outputs; i++) {
+        const WavFormat *format = &p->rateFormat[i];
+        wav_build_header(f->header, format, 0);
+        uint64_t prealloc = p->config.preallocBytes * format->sampleRate * wav_block_align(format) / rawRate;
+        prealloc = (prealloc + RECORD_SECTOR_SIZE - 1) / RECORD_SECTOR_SIZE * RECORD_SECTOR_SIZE;
+        open_sidecar_file(p, f, &f->rateWriter[i], f->ratePath[i], p->config.rateExt[i], prealloc, "rate output");
+        if (record_writer_is_open(&f->rateWriter[i])) {
+            record_writer_set_checkpoint_hook(&f->rateWriter[i], update_rate_header, f);
+        }
+    }
+}
+
+// 关闭一个文件和它的索引文件（截断预分配的剩余空间），返回录音文件是否正常关闭
+static bool close_capture_file(CaptureFile *f) {
+    for (uint32_t i = 0; i < DECIMATOR_MAX_OUTPUTS; i++) {
+        if (record_writer_is_open(&f->rateWriter[i]) && !record_writer_close(&f->rateWriter[i])) {
+            CAPTURE_LOGW(TAG, "Error while closing %s", f->ratePath[i]);
+        }
+    }
+    if (record_writer_is_open(&f->doaWriter) && !record_writer_close(&f->doaWriter)) {
+        CAPTURE_LOGW(TAG, "Error while closing %s", f->doaPath);
+    }
+    if (record_writer_is_open(&f->featureWriter) && !record_writer_close(&f->featureWriter)) {
+        CAPTURE_LOGW(TAG, "Error while closing %s", f->featurePath);
+    }
+    if (record_writer_is_open(&f->beamWriter) && !record_writer_close(&f->beamWriter)) {
+        CAPTURE_LOGW(TAG, "Error while closing %s", f->beamPath);
+    }
+    if (record_writer_is_open(&f->syncWriter) && !record_writer_close(&f->syncWriter)) {
+        CAPTURE_LOGW(TAG, "Error while closing %s", f->syncPath);
+    }
+    if (record_writer_is_open(&f->eventWriter) && !record_writer_close(&f->eventWriter)) {
+        CAPTURE_LOGW(TAG, "Error while closing %s", f->eventPath);
+    }
+    if (record_writer_is_open(&f->indexWriter) && !record_writer_close(&f->indexWriter)) {
+        CAPTURE_LOGW(TAG, "Error while closing %s", f->indexPath);
+    }
+    if (!record_writer_is_open(&f->writer)) {
+        return false;
+    }
+    uint64_t size = f->writer.bytesWritten;
+    bool ok = record_writer_close(&f->writer);
+    if (!ok) {
+        CAPTURE_LOGW(TAG, "Error while closing %s", f->path);
+    }
+    CAPTURE_LOGI(TAG, "File closed: %s (%llu bytes)", f->path, (unsigned long long)size);
+    return ok;
+}
+
+static void remove_capture_path(CapturePipeline *p, const char *path) {
+    if (!p->config.backend->remove(path)) {
+        CAPTURE_LOGW(TAG, "Failed to delete %s", path);
+    }
+}
+
+// 关闭并删除预先打开但没有用到的文件和它的附属文件，释放文件序号。
+// 预备任务也会调用（写文件头失败时），因此不访问恢复日志
+static void delete_capture_file(CaptureFile *f) {
+    CapturePipeline *p = f->pipeline;
+    RecordWriter *writer[CAPTURE_SIDECARS];
+    const char *ext[CAPTURE_SIDECARS];
+    const char *path[CAPTURE_SIDECARS];
+    bool open[CAPTURE_SIDECARS];
+    capture_file_sidecars(p, f, writer, ext, path);
+    for (uint32_t i = 0; i < CAPTURE_SIDECARS; i++) {
+        open[i] = record_writer_is_open(writer[i]);
+    }
+    close_capture_file(f);
+    remove_capture_path(p, f->path);
+    for (uint32_t i = 0; i < CAPTURE_SIDECARS; i++) {
+        if (open[i]) {
+            remove_capture_path(p, path[i]);
+        }
+    }
+    file_sequence_release(&p->fileSeq, f->seq);
+}
+
+// 文件任务: 删除没有用到的文件，恢复日志中登记的是这个文件时一并清空登记
+static void discard_capture_file(CapturePipeline *p, CaptureFile *f) {
+    if (p->config.journalPath != NULL && !recovery_journal_forget(&p->journal, f->path)) {
+        CAPTURE_LOGW(TAG, "Failed to update recovery journal");
+    }
+    delete_capture_file(f);
+}
+
+// 分配新文件名，打开录音文件（预分配连续空间）和索引文件并写入文件头。
+// 只访问f和初始化后不再改变的字段，可以在预备任务中与文件任务并行执行
+static bool prepare_capture_file(CapturePipeline *p, CaptureFile *f) {
+    memset(f->path, 0, sizeof(f->path));
+    if (!file_sequence_next(&p->fileSeq, audio_file_ext(p), f->path, sizeof(f->path), &f->seq)) {
+        CAPTURE_LOGE(TAG, "Failed to allocate a file name in %s", p->config.fileDir);
+        return false;
+    }
+    CAPTURE_LOGI(TAG, "Generated filename: %s", f->path);
+
+    // 检查点由本模块按时间触发
+    if (!record_writer_open(&f->writer, p->config.backend, f->path, p->config.preallocBytes, 0)) {
+        CAPTURE_LOGE(TAG, "Failed to open file for writing: %s", f->path);
+        return false;
+    }
+
+    // 块索引、事件索引、同步索引、波束文件、方位索引、特征索引和多采样率输出（先于录音文件头写入，
+    // 文件头缓冲区随后被重新生成）
+    if (p->config.indexExt != NULL) {
+        open_index_file(p, f);
+    }
+    if (p->config.eventCapture && p->config.eventExt != NULL) {
+        open_event_file(p, f);
+    }
+    if (p->config.syncClock != NULL && p->config.syncExt != NULL) {
+        open_sync_file(p, f);
+    }
+    if (p->config.beamOutput == AUDIO_BEAM_WITH_RAW) {
+        open_beam_file(p, f);
+    }
+    if (p->config.doaEstimate && p->config.doaExt != NULL) {
+        open_doa_file(p, f);
+    }
+    if (p->config.features && p->config.featureExt != NULL) {
+        open_feature_file(p, f);
+    }
+    if (p->config.rates.outputs != 0) {
+        open_rate_files(p, f);
+    }
+
+    // 先写入长度为0的文件头，检查点和关闭时再更新长度
+    // （平面文件和块浮点文件的头部不含长度，不需要回写）
+    record_checkpoint_hook_t hook = NULL;
+    memset(&f->flacStream, 0, sizeof(f->flacStream));
+    if (p->config.codec == AUDIO_CODEC_FLAC) {
+        flac_build_header(f->header, &p->flacConfig, &f->flacStream);
+        hook = update_flac_header;
+    } else if (p->config.codec == AUDIO_CODEC_BFP) {
+        bfp_build_header(f->header, &p->bfpFormat);
+    } else if (p->config.layout == AUDIO_LAYOUT_PLANAR) {
+        planar_build_header(f->header, &p->planarFormat);
+    } else {
+        wav_build_header(f->header, &p->wavFormat, 0);
+        hook = update_wav_header;
+    }
+    if (!record_writer_write(&f->writer, f->header, sizeof(f->header))) {
+        CAPTURE_LOGE(TAG, "Failed to write file header: %s", f->path);
+        delete_capture_file(f);
+        return false;
+    }
+    record_writer_set_checkpoint_hook(&f->writer, hook, f);
+    return true;
+}
+
+// 开始写p->file：索引文件头中的开始时间改为现在（文件可能是提前打开的），块序号和事件序号从0开始
+static void activate_file(CapturePipeline *p) {
+    CaptureFile *f = p->file;
+    int64_t now = capture_os_now_us();
+    if (record_writer_is_open(&f->indexWriter) && build_index_header(p, f, now)) {
+        record_writer_write_at(&f->indexWriter, 0, f->header, BLOCK_INDEX_HEADER_BYTES);
+    }
+    if (record_writer_is_open(&f->eventWriter)) {
+        build_event_header(p, f, now);
+        record_writer_write_at(&f->eventWriter, 0, f->header, EVENT_INDEX_HEADER_BYTES);
+    }
+    if (record_writer_is_open(&f->syncWriter)) {
+        build_sync_header(p, f, now);
+        record_writer_write_at(&f->syncWriter, 0, f->header, SYNC_INDEX_HEADER_BYTES);
+    }
+    if (record_writer_is_open(&f->doaWriter)) {
+        build_doa_header(p, f, now);
+        record_writer_write_at(&f->doaWriter, 0, f->header, DOA_INDEX_HEADER_BYTES);
+    }
+    if (record_writer_is_open(&f->featureWriter)) {
+        build_feature_header(p, f, now);
+        record_writer_write_at(&f->featureWriter, 0, f->header, FEATURE_INDEX_HEADER_BYTES);
+    }
+    p->blockSeq = 0;
+    p->eventSeq = 0;
+    p->lastCheckpointUs = now;
+    p->fileStartUs = now;
+    p->rotateHold = false;
+    CAPTURE_LOGI(TAG, "File opened: %s", f->path);
+}
+
+// 既不是当前文件也不在关闭中的槽位
+static CaptureFile *spare_file(CapturePipeline *p) {
+    for (int i = 0; i < 3; i++) {
+        if (&p->files[i] != p->file && &p->files[i] != p->retiredFile) {
+            return &p->files[i];
+        }
+    }
+    return NULL;
+}
+
+static bool rotation_enabled(const CapturePipelineConfig *config) {
+    return config->rotateMs != 0 || config->rotateBytes != 0;
+}
+
+// 文件任务等待预备任务完成一个请求的上限；超时计入prepTimeouts
+#define PREP_WAIT_MS    2000
+
+// 请求预备任务在后台打开下一个文件
+static void request_next_file(CapturePipeline *p) {
+    if (!rotation_enabled(&p->config)) {
+        return;
+    }
+    atomic_store(&p->prepRequest, true);
+    capture_os_sem_give(p->prepSem);
+}
+
+// 等待预备任务处理完所有请求（关闭上一个文件、打开下一个文件），预备任务每处理完一轮给出prepDoneSem。
+// 最多等待waitMs，返回预备任务是否已空闲
+static bool wait_prep_idle(CapturePipeline *p, uint32_t waitMs) {
+    int64_t deadline = capture_os_now_us() + (int64_t)waitMs * 1000;
+    while (atomic_load(&p->retirePending) || atomic_load(&p->prepRequest)) {
+        int64_t left = deadline - capture_os_now_us();
+        if (left <= 0 || !capture_os_sem_take(p->prepDoneSem, (uint32_t)((left + 999) / 1000))) {
+            return !atomic_load(&p->retirePending) && !atomic_load(&p->prepRequest);
+        }
+    }
+    return true;
+}
+
+// 预备任务：在文件任务之外完成轮转中耗时的文件操作（生成文件名、创建并预分配下一个文件、
+// 关闭上一个文件时的回写和截断），文件任务在块边界只需要切换指针
+static void file_prep_task(void *arg) {
+    CapturePipeline *p = arg;
+    CAPTURE_LOGI(TAG, "File prep task started");
+
+    while (1) {
+        capture_os_sem_take(p->prepSem, CAPTURE_OS_WAIT_FOREVER);
+        // 先关闭上一个文件：文件任务看到nextReady时，上一个文件一定已经关闭，它的槽位可以复用
+        if (atomic_load(&p->retirePending)) {
+            close_capture_file(p->retiredFile);
+            atomic_store(&p->retirePending, false);
+        }
+        if (atomic_load(&p->prepRequest)) {
+            if (prepare_capture_file(p, p->nextFile)) {
+                atomic_store(&p->nextReady, true);
+            }
+            atomic_store(&p->prepRequest, false);
+        }
+        capture_os_sem_give(p->prepDoneSem);
+    }
+}
+
+// 轮转是否在这一块之前进行：复制模式由采集任务标记新文件的第一块，
+// 零拷贝模式没有编码器状态，由文件任务按时长和大小判断
+static bool rotation_due(CapturePipeline *p, uint32_t slot) {
+    if (p->config.mode != AUDIO_CAPTURE_MODE_ZERO_COPY) {
+        return p->blocks[slot].fileStart;
+    }
+    if (!rotation_enabled(&p->config) || p->rotateHold) {
+        return false;
+    }
+    if (p->config.rotateBytes != 0 && p->file->writer.bytesWritten >= p->config.rotateBytes) {
+        return true;
+    }
+    return p->config.rotateMs != 0 && capture_os_now_us() - p->fileStartUs >= (int64_t)p->config.rotateMs * 1000;
+}
+
+// 在块边界切换到预先打开的下一个文件：旧文件先做一次检查点，剩余的关闭工作交给预备任务。
+// 样本序号（块索引的firstSample）和零拷贝的帧基准延续，所有文件共用一条时间线；
+// 跨越边界的事件在旧文件中结束、在新文件中从第一块继续（EVENT_INDEX_CONTINUED）
+static void rotate_file(CapturePipeline *p) {
+    p->fileSwitches++;
+    // 预备任务还在打开下一个文件时等它完成，失败时在文件任务中再试一次。
+    // 存储卡长时间阻塞时不等下去：本次不轮转，继续写当前文件，下一个轮转点再试
+    if (!wait_prep_idle(p, PREP_WAIT_MS)) {
+        p->prepTimeouts++;
+        CAPTURE_LOGW(TAG, "File prep task busy for %d ms, continuing %s", PREP_WAIT_MS, p->file->path);
+        return;
+    }
+    if (!atomic_load(&p->nextReady) && !prepare_capture_file(p, p->nextFile)) {
+        CAPTURE_LOGE(TAG, "Cannot open the next file, continuing %s", p->file->path);
+        p->rotateHold = true;
+        return;
+    }
+    atomic_store(&p->nextReady, false);
+
+    checkpoint_audio_file(p);
+    bool eventOpen = p->eventOpen;
+    EventIndexRecord event = p->openEvent;
+    close_event(p);
+
+    p->retiredFile = p->file;
+    p->file = p->nextFile;
+    p->nextFile = spare_file(p);
+    activate_file(p);
+    if (eventOpen) {
+        p->openEvent = event;
+        p->openEvent.reasons |= EVENT_INDEX_CONTINUED;
+        p->openEvent.startSample = p->nextSample;
+        p->openEvent.offset = p->file->writer.bytesWritten;
+        p->eventOpen = true;
+    }
+    p->rotations++;
+
+    // 恢复日志只记录一个文件：旧文件关闭完成后再登记新文件
+    p->journalPending = p->config.journalPath != NULL;
+    atomic_store(&p->retirePending, true);
+    request_next_file(p);
+}
+
+// 轮转后旧文件已关闭：把新文件登记到恢复日志
+static void update_journal(CapturePipeline *p) {
+    if (!p->journalPending || atomic_load(&p->retirePending)) {
+        return;
+    }
+    p->journalPending = false;
+    begin_journal(p);
+}
+
+// 写出环中的一个槽位，到期时轮转或做检查点
+static void write_slot(CapturePipeline *p, uint32_t slot) {
+    capture_stats_ring_depth(&p->stats, block_ring_count(capture_ring(p)));
+    if (rotation_due(p, slot)) {
+        rotate_file(p);
+    }
+    update_journal(p);
+
+    uint64_t offset = p->file->writer.bytesWritten;
+    int64_t start = capture_os_now_us();
+    bool ok;
+    bool corrupt = false;
+    size_t bytes;
+    uint64_t firstSample;
+    int64_t captureUs;
+    uint32_t frames;
+    uint8_t eventMark = 0;
+    if (p->config.mode == AUDIO_CAPTURE_MODE_ZERO_COPY) {
+        const DmaBlock *block = &p->dmaBlocks[slot];
+        firstSample = dma_block_first_sample(p, block);
+        frames = block->numFrames * p->config.zcDmaFrameNum;
+        captureUs = start;      // 零拷贝块没有读取时间，用取出的时间
+        if (p->config.levelTap != NULL) {
+            for (uint32_t i = 0; i < block->numFrames; i++) {
+                level_tap_feed(p->config.levelTap, block->frames[i], p->config.zcDmaFrameNum, start);
+            }
+        }
+        bytes = write_dma_block(p, block, &ok, &corrupt);
+    } else {
+        const AudioBlock *block = &p->blocks[slot];
+        firstSample = block->firstSample;
+        frames = p->timing.blockFrames;
+        captureUs = block->readDoneUs;
+        eventMark = block->eventMark;
+        capture_stats_write_wait(&p->stats, (uint32_t)(start - block->stagedUs));
+        if (block->hasSync) {
+            write_sync_record(p, &block->sync);
+        }
+        for (uint32_t i = 0; i < block->doaCount; i++) {
+            write_doa_record(p, &block->doa[i]);
+        }
+        if (block->featureLength > 0) {
+            write_feature_records(p, block);
+        }
+        if (eventMark & AUDIO_BLOCK_EVENT_START) {
+            close_event(p);     // 上一个事件因暂停而没有结束块
+            p->openEvent = block->event;
+            p->openEvent.startSample = firstSample;
+            p->openEvent.offset = offset;
+            p->eventOpen = true;
+        }
+        bytes = write_block(p, block, &ok);
+        if (block->beamLength > 0) {
+            write_beam_block(p, block);
+        }
+        if (p->config.rates.outputs != 0) {
+            write_rate_blocks(p, block);
+        }
+    }
+    int64_t end = capture_os_now_us();
+    if (bytes > 0) {
+        capture_stats_block_written(&p->stats, bytes, (uint32_t)(end - start), end, ok);
+        if (ok && corrupt) {
+            capture_stats_block_corrupt(&p->stats);
+        }
+        if (ok) {
+            index_block(p, firstSample, captureUs, offset, corrupt);
+            p->nextSample = firstSample + frames;
+        }
+    }
+    // 没有写出的块（写卡失败、过期丢弃、编码输出为空）不推进nextSample，
+    // 它的样本计入下一条索引记录的丢失帧数；块序号照常递增，索引中同样可以看到跳过的序号
+    p->blockSeq++;
+    if (eventMark & AUDIO_BLOCK_EVENT_END) {
+        close_event(p);
+    }
+
+    // 复制模式按大小轮转：请求采集任务把下一块标记为新文件的第一块（在途的块仍写入当前文件）
+    if (p->config.mode != AUDIO_CAPTURE_MODE_ZERO_COPY && p->config.rotateBytes != 0 && !p->rotateHold &&
+        p->file->writer.bytesWritten >= p->config.rotateBytes) {
+        atomic_store_explicit(&p->rotateRequest, p->fileSwitches + 1, memory_order_release);
+    }
+
+    if (capture_os_now_us() - p->lastCheckpointUs >= (int64_t)p->config.checkpointMs * 1000) {
+        checkpoint_audio_file(p);
+    }
+}
+
+// drain_ring连续等不到块的次数上限和每次等待的时间
+#define DRAIN_IDLE_WAITS    10
+#define DRAIN_IDLE_WAIT_MS  100
+
+// 将环中所有已提交的块写入文件（启用处理阶段时等待处理任务处理完剩余的块，
+// 有溢出环时等待采集任务把溢出的块搬回内部环）
+static void drain_ring(CapturePipeline *p) {
+    BlockRing *ring = capture_ring(p);
+    uint32_t slot;
+    int idle = 0;
+    while ((block_ring_count(ring) > 0 || block_ring_count(&p->spillRing) > 0) && idle < DRAIN_IDLE_WAITS) {
+        if (block_ring_peek(ring, &slot)) {
+            write_slot(p, slot);
+            block_ring_release(ring);
+            capture_os_sem_give(p->spaceFreeSem);
+            idle = 0;
+        } else {
+            capture_os_sem_take(p->dataReadySem, DRAIN_IDLE_WAIT_MS);
+            idle++;
+        }
+    }
+}
+
+// 开始录音时打开第一个文件（轮转时预先打开的文件在暂停期间保留，直接使用），
+// 然后请求预备任务打开下一个文件
+static bool open_audio_file(CapturePipeline *p) {
+    if (!atomic_load(&p->nextReady) && !prepare_capture_file(p, p->nextFile)) {
+        return false;
+    }
+    atomic_store(&p->nextReady, false);
+    p->file = p->nextFile;
+    p->nextFile = spare_file(p);
+
+    p->nextSample = 0;
+    p->zcBaseValid = false;
+    p->eventOpen = false;
+    activate_file(p);
+    capture_stats_restart_rate(&p->stats);
+    p->journalPending = false;
+    if (p->config.journalPath != NULL) {
+        begin_journal(p);
+    }
+    request_next_file(p);
+    return true;
+}
+
+// 关闭录音文件和索引文件（截断预分配的剩余空间）；未结束的事件在此结束。
+// 轮转换下的文件先由预备任务关闭完，恢复日志最后标记为已关闭
+static void close_audio_file(CapturePipeline *p) {
+    // 预备任务还在使用文件槽位，必须等它完成；每次超时计数一次
+    while (p->prepTask != NULL && !wait_prep_idle(p, PREP_WAIT_MS)) {
+        p->prepTimeouts++;
+        CAPTURE_LOGW(TAG, "Still waiting for the file prep task after %d ms", PREP_WAIT_MS);
+    }
+    atomic_store(&p->rotateRequest, 0);
+    p->journalPending = false;
+    if (p->file == NULL) {
+        return;
+    }
+    close_event(p);
+    if (close_capture_file(p->file) && p->config.journalPath != NULL && !recovery_journal_end(&p->journal)) {
+        CAPTURE_LOGW(TAG, "Failed to update recovery journal");
+    }
+}
+
+// 文件保存任务
+static void file_save_task(void *arg) {
+    CapturePipeline *p = arg;
+    CAPTURE_LOGI(TAG, "File save task started");
+
+    if (!open_audio_file(p)) {
+        p->fileTask = NULL;
+        capture_os_task_delete(NULL);
+        return;
+    }
+
+    while (1) {
+        // 检查任务是否应该暂停
+        if (capture_os_notify_take(0)) {
+            // 刷新任何待处理的块，写出剩余数据并关闭文件
+            drain_ring(p);
+            close_audio_file(p);
+
+            // 暂停任务
+            CAPTURE_LOGI(TAG, "File save task going to suspend");
+            capture_os_suspend_self();
+
+            // 恢复时创建新文件
+            CAPTURE_LOGI(TAG, "File save task resumed");
+            if (!open_audio_file(p)) {
+                p->fileTask = NULL;
+                capture_os_task_delete(NULL);
+                return;
+            }
+            continue;
+        }
+
+        // 写出所有就绪的块，环空时等待生产者通知
+        BlockRing *ring = capture_ring(p);
+        uint32_t slot;
+        if (block_ring_peek(ring, &slot)) {
+            write_slot(p, slot);
+            block_ring_release(ring);
+            capture_os_sem_give(p->spaceFreeSem);
+        } else {
+            capture_os_sem_take(p->dataReadySem, 100);
+        }
+    }
+}
+
+// 检查模式、编码、布局和采样宽度的组合
+static bool check_config(const CapturePipelineConfig *config) {
+    // 零拷贝模式下块就是DMA缓冲区，不能原地处理
+    if (capture_pipeline_stage_enabled(config) && config->mode == AUDIO_CAPTURE_MODE_ZERO_COPY) {
+        CAPTURE_LOGE(TAG, "FLAC and block floating point, planar layout, channel masks, beams, DOA, features and "
+                          "rate outputs require the copy capture mode");
+        return false;
+    }
+    // FLAC帧内各通道已分别编码，块浮点按组交织，都不再解交织
+    if (config->codec != AUDIO_CODEC_PCM && config->layout == AUDIO_LAYOUT_PLANAR) {
+        CAPTURE_LOGE(TAG, "Planar layout cannot be combined with FLAC or block floating point");
+        return false;
+    }
+    // 编码器和解交织内核只支持部分样本宽度
+    if (config->codec == AUDIO_CODEC_FLAC && config->profile.bitsPerSample != 16) {
+        CAPTURE_LOGE(TAG, "FLAC compression requires a 16-bit capture profile");
+        return false;
+    }
+    if (config->codec == AUDIO_CODEC_BFP && config->profile.bitsPerSample == 16) {
+        CAPTURE_LOGE(TAG, "Block floating point requires a 24-bit or 32-bit capture profile");
+        return false;
+    }
+    if (config->layout == AUDIO_LAYOUT_PLANAR && config->profile.bitsPerSample == 24) {
+        CAPTURE_LOGE(TAG, "Planar layout requires a 16-bit or 32-bit capture profile");
+        return false;
+    }
+    if (config->channelMask == 0 || (config->channelMask & ~mask_all(config)) != 0) {
+        CAPTURE_LOGE(TAG, "Invalid channel mask 0x%02x", (unsigned)config->channelMask);
+        return false;
+    }
+    // 波束形成的内核只支持16位样本
+    if (config->beamOutput != AUDIO_BEAM_OFF &&
+        (config->profile.bitsPerSample != 16 || config->beam.beams == 0 || config->beam.beams > BEAMFORMER_MAX_BEAMS ||
+         (config->beamOutput == AUDIO_BEAM_WITH_RAW && config->beamExt == NULL))) {
+        CAPTURE_LOGE(TAG, "Beams require a 16-bit capture profile, 1..%d beams and a beam file extension",
+                     BEAMFORMER_MAX_BEAMS);
+        return false;
+    }
+    // 方位估计同样只支持16位样本
+    if (config->doaEstimate && config->profile.bitsPerSample != 16) {
+        CAPTURE_LOGE(TAG, "DOA estimation requires a 16-bit capture profile");
+        return false;
+    }
+    if (config->rates.outputs > DECIMATOR_MAX_OUTPUTS) {
+        CAPTURE_LOGE(TAG, "At most %d rate outputs", DECIMATOR_MAX_OUTPUTS);
+        return false;
+    }
+    for (uint32_t i = 0; i < config->rates.outputs; i++) {
+        uint32_t rate = config->rates.rateHz[i];
+        if (rate == 0 || rate >= config->profile.sampleRate || config->profile.sampleRate % rate != 0 ||
+            config->rateExt[i] == NULL) {
+            CAPTURE_LOGE(TAG, "Rate output %u Hz is not a fraction of %u Hz or has no file extension", (unsigned)rate,
+                         (unsigned)config->profile.sampleRate);
+            return false;
+        }
+    }
+    // 预录保存在溢出环中，零拷贝的DMA缓冲区不能长时间占用
+    if (config->eventCapture && config->mode == AUDIO_CAPTURE_MODE_ZERO_COPY) {
+        CAPTURE_LOGE(TAG, "Event capture requires the copy capture mode");
+        return false;
+    }
+    // 同步要在开始录音时清空I2S驱动，把样本序号对应到DMA缓冲区计数
+    if (config->syncClock != NULL && (config->mode != AUDIO_CAPTURE_MODE_COPY || config->reader == NULL ||
+                                      config->reader->flush == NULL)) {
+        CAPTURE_LOGE(TAG, "Multi-device sync requires the copy capture mode and a flushable reader");
+        return false;
+    }
+    if ((config->mode == AUDIO_CAPTURE_MODE_COPY && config->reader == NULL) ||
+        (config->mode == AUDIO_CAPTURE_MODE_ZERO_COPY && config->frameSource == NULL)) {
+        CAPTURE_LOGE(TAG, "No data source for the capture mode");
+        return false;
+    }
+    return true;
+}
+
+// 初始化零拷贝模式：组装器和帧源
+static bool init_zero_copy(CapturePipeline *p) {
+    const CapturePipelineConfig *config = &p->config;
+    if (config->zcFramesPerBlock == 0 || config->zcDmaDescNum <= config->zcFramesPerBlock * 2) {
+        CAPTURE_LOGE(TAG, "Invalid zero-copy block geometry");
+        return false;
+    }
+    p->zcNumBlocks = (config->zcDmaDescNum - 1) / config->zcFramesPerBlock - 1;
+    if (p->zcNumBlocks > CAPTURE_PIPELINE_MAX_ZC_BLOCKS) {
+        p->zcNumBlocks = CAPTURE_PIPELINE_MAX_ZC_BLOCKS;
+    }
+    if (!dma_block_assembler_init(&p->dmaAssembler, p->dmaBlocks, p->zcNumBlocks,
+                                  config->zcFramesPerBlock, config->zcDmaDescNum)) {
+        CAPTURE_LOGE(TAG, "Invalid zero-copy block geometry");
+        return false;
+    }
+    p->staleBlocks = 0;
+    return config->frameSource->start(config->frameSource, zero_copy_on_frame, p);
+}
+
+// 按目标停顿时间和空闲PSRAM确定溢出环的块数。PSRAM不足时只记录警告，退化为只用内部环。
+// 事件录音时溢出环还要放下预录和正在填充的一块，PSRAM不足时缩短预录
+static void init_spill(CapturePipeline *p) {
+    const CapturePipelineConfig *config = &p->config;
+    uint32_t blockBytes = p->timing.blockBytes;
+    uint64_t bytesPerSec = (uint64_t)p->timing.frameBytes * config->profile.sampleRate;
+
+    // 停顿期间采集的数据量，扣除内部环已经能缓冲的部分
+    uint64_t stallBytes = bytesPerSec * config->spillStallMs / 1000;
+    uint64_t internalBytes = (uint64_t)CAPTURE_PIPELINE_NUM_BUFFERS * blockBytes;
+    uint64_t wanted = (stallBytes > internalBytes) ? (stallBytes - internalBytes + blockBytes - 1) / blockBytes : 0;
+    if (config->eventCapture) {
+        wanted += p->preRollBlocks + 1;
+    }
+    if (wanted == 0) {
+        return;
+    }
+
+    // 溢出环占用一整块连续PSRAM，留出1/4给LVGL等其他使用者
+    uint64_t budget = capture_os_spiram_largest_free() / 4 * 3;
+    if (config->spillMaxBytes != 0 && budget > config->spillMaxBytes) {
+        budget = config->spillMaxBytes;
+    }
+    uint64_t depth = budget / blockBytes;
+    if (depth > wanted) {
+        depth = wanted;
+    }
+    if (depth == 0) {
+        CAPTURE_LOGW(TAG, "No PSRAM for the spill ring, write stalls over %u ms will drop samples",
+                     (unsigned)(internalBytes * 1000 / bytesPerSec));
+        return;
+    }
+
+    p->spillMemory = capture_os_alloc((size_t)depth * blockBytes, CAPTURE_MEM_SPIRAM);
+    p->spillBlocks = capture_os_alloc((size_t)depth * sizeof(AudioBlock), CAPTURE_MEM_FAST);
+    if (p->spillMemory == NULL || p->spillBlocks == NULL) {
+        CAPTURE_LOGW(TAG, "Failed to allocate %u KB PSRAM spill ring", (unsigned)(depth * blockBytes / 1024));
+        if (p->spillMemory != NULL) {
+            capture_os_free(p->spillMemory);
+            p->spillMemory = NULL;
+        }
+        if (p->spillBlocks != NULL) {
+            capture_os_free(p->spillBlocks);
+            p->spillBlocks = NULL;
+        }
+        return;
+    }
+    for (uint32_t i = 0; i < depth; i++) {
+        p->spillBlocks[i] = (AudioBlock){
+            .data = p->spillMemory + (size_t)i * blockBytes,
+            .size = blockBytes,
+            .capacity = blockBytes,
+        };
+    }
+    block_ring_init(&p->spillRing, (uint32_t)depth);
+    p->spillCapacity = (uint32_t)depth;
+
+    if (config->eventCapture && depth <= p->preRollBlocks) {
+        p->preRollBlocks = (uint32_t)depth - 1;
+        CAPTURE_LOGW(TAG, "Pre-roll limited by free PSRAM to %u ms",
+                     (unsigned)((uint64_t)p->preRollBlocks * blockBytes * 1000 / bytesPerSec));
+    }
+    // 事件录音时预录占用的部分不能用来承受写卡停顿
+    uint64_t stallDepth = config->eventCapture ? depth - p->preRollBlocks - 1 : depth;
+    uint32_t toleranceMs = (uint32_t)((internalBytes + stallDepth * blockBytes) * 1000 / bytesPerSec);
+    if (depth < wanted) {
+        CAPTURE_LOGW(TAG, "Spill ring limited by free PSRAM: tolerates %u of %u ms write stalls",
+                     (unsigned)toleranceMs, (unsigned)config->spillStallMs);
+    } else {
+        CAPTURE_LOGI(TAG, "PSRAM spill ring: %u blocks (%u KB), tolerates %u ms write stalls", (unsigned)depth,
+                     (unsigned)(depth * blockBytes / 1024), (unsigned)toleranceMs);
+    }
+}
+
+// 轮转时最多同时打开三个文件：每个文件只预分配轮转上限对应的空间
+// （时长上限按未压缩的数据率估计，另加在途的块）
+static void limit_prealloc(CapturePipeline *p) {
+    CapturePipelineConfig *config = &p->config;
+    if (!rotation_enabled(config) || config->preallocBytes == 0) {
+        return;
+    }
+    uint64_t margin = (uint64_t)(CAPTURE_PIPELINE_NUM_BUFFERS + 2) * p->timing.blockBytes;
+    uint64_t limit = UINT64_MAX;
+    if (config->rotateBytes != 0) {
+        limit = config->rotateBytes + margin;
+    }
+    if (config->rotateMs != 0) {
+        uint64_t bytes = (uint64_t)p->timing.frameBytes * config->profile.sampleRate * config->rotateMs / 1000 + margin;
+        limit = (bytes < limit) ? bytes : limit;
+    }
+    limit = (limit + RECORD_SECTOR_SIZE - 1) / RECORD_SECTOR_SIZE * RECORD_SECTOR_SIZE;
+    if (limit < config->preallocBytes) {
+        config->preallocBytes = limit;
+        CAPTURE_LOGI(TAG, "Rotating files: preallocating %u KB per file", (unsigned)(limit / 1024));
+    }
+}
+
+bool capture_pipeline_init(CapturePipeline *p, const CapturePipelineConfig *config) {
+    memset(p, 0, sizeof(*p));
+    p->config = *config;
+    p->initialized = true;
+    if (p->config.backend == NULL) {
+        p->config.backend = record_backend_default();
+    }
+    if (!check_config(&p->config)) {
+        return false;
+    }
+
+    // 按采集配置推导块和DMA参数
+    CaptureProfileError profileErr = capture_profile_resolve(&p->config.profile, p->config.maxBlockBytes, &p->timing);
+    if (profileErr != CAPTURE_PROFILE_OK) {
+        CAPTURE_LOGE(TAG, "Invalid capture profile: %s", capture_profile_error_str(profileErr));
+        return false;
+    }
+    p->config.profile.decimation = p->timing.decimation;
+    limit_prealloc(p);
+    if (p->config.levelTap != NULL &&
+        !level_tap_configure(p->config.levelTap, p->config.slots, p->timing.sampleBytes, p->config.channelMask,
+                             p->config.profile.sampleRate)) {
+        CAPTURE_LOGW(TAG, "Level tap does not support %u slots, meter disabled", (unsigned)p->config.slots);
+        p->config.levelTap = NULL;
+    }
+    if (p->config.syncClock != NULL &&
+        !sync_clock_init(p->config.syncClock, p->config.profile.sampleRate, p->timing.dmaFrameNum,
+                         p->config.syncPeriodMs)) {
+        CAPTURE_LOGE(TAG, "Invalid sync pulse period %u ms", (unsigned)p->config.syncPeriodMs);
+        return false;
+    }
+
+    // 读取下一个文件序号（状态文件无效时才扫描目录）
+    if (!file_sequence_open(&p->fileSeq, p->config.fileDir, p->config.filePrefix, p->config.seqPath)) {
+        CAPTURE_LOGW(TAG, "Failed to open file sequence state: %s", p->config.seqPath);
+    }
+    if (p->fileSeq.scans != 0) {
+        CAPTURE_LOGI(TAG, "Scanned %u directory entries, next file number %u", (unsigned)p->fileSeq.scannedEntries,
+                     (unsigned)p->fileSeq.next);
+    }
+
+    // 打开恢复日志（失败不影响录音，只是断电后无法自动修复）
+    if (p->config.journalPath != NULL && !recovery_journal_open(&p->journal, p->config.journalPath)) {
+        CAPTURE_LOGW(TAG, "Failed to open recovery journal: %s", p->config.journalPath);
+    }
+
+    // 创建生产者/消费者之间的通知信号量
+    p->dataReadySem = capture_os_sem_create();
+    p->spaceFreeSem = capture_os_sem_create();
+    if (p->dataReadySem == NULL || p->spaceFreeSem == NULL) {
+        CAPTURE_LOGE(TAG, "Failed to create ring semaphores");
+        return false;
+    }
+
+    // 录音文件槽位；轮转时预备任务由信号量唤醒
+    for (int i = 0; i < 3; i++) {
+        p->files[i].pipeline = p;
+    }
+    p->nextFile = &p->files[0];
+    p->retiredFile = &p->files[2];
+    if (rotation_enabled(&p->config)) {
+        p->prepSem = capture_os_sem_create();
+        p->prepDoneSem = capture_os_sem_create();
+        if (p->prepSem == NULL || p->prepDoneSem == NULL) {
+            CAPTURE_LOGE(TAG, "Failed to create file prep semaphore");
+            return false;
+        }
+    }
+
+    // 录音格式跟随采集配置，文件中只包含选中的通道（或波束）
+    const CaptureProfile *profile = &p->config.profile;
+    uint32_t channels = channel_mask_count(p->config.channelMask, p->config.slots);
+    uint32_t fileChannels = (p->config.beamOutput == AUDIO_BEAM_ONLY) ? p->config.beam.beams : channels;
+    p->wavFormat = (WavFormat){
+        .sampleRate = profile->sampleRate,
+        .channels = fileChannels,
+        .containerBits = p->timing.sampleBytes * 8,
+        .validBits = profile->bitsPerSample,
+        .channelMask = 0,   // 麦克风阵列，无扬声器位置映射
+    };
+    p->beamFormat = (WavFormat){
+        .sampleRate = profile->sampleRate,
+        .channels = p->config.beam.beams,
+        .containerBits = 16,
+        .validBits = 16,
+        .channelMask = 0,
+    };
+    for (uint32_t i = 0; i < p->config.rates.outputs; i++) {
+        p->rateFormat[i] = (WavFormat){
+            .sampleRate = p->config.rates.rateHz[i],
+            .channels = channels,
+            .containerBits = 16,
+            .validBits = 16,
+            .channelMask = 0,
+        };
+    }
+    p->flacConfig = (FlacConfig){
+        .sampleRate = profile->sampleRate,
+        .channels = fileChannels,
+        .bitsPerSample = profile->bitsPerSample,
+        .blockSize = p->timing.blockFrames,
+        .maxOrder = FLAC_MAX_FIXED_ORDER,
+        .maxPartitionOrder = FLAC_MAX_PARTITION_ORDER,
+    };
+    p->planarFormat = (PlanarFormat){
+        .sampleRate = profile->sampleRate,
+        .channels = fileChannels,
+        .bitsPerSample = profile->bitsPerSample,
+        .chunkSamples = p->timing.blockFrames,
+        .channelMask = (p->config.beamOutput == AUDIO_BEAM_ONLY) ? 0 : p->config.channelMask,  // 波束不对应槽位
+    };
+    p->bfpFormat = (BfpFormat){
+        .sampleRate = profile->sampleRate,
+        .channels = fileChannels,
+        .sourceBits = profile->bitsPerSample,
+        .blockFrames = p->timing.blockFrames,
+        .groupFrames = BFP_DEFAULT_GROUP,
+        .channelMask = p->config.channelMask,
+    };
+
+    if (p->config.mode == AUDIO_CAPTURE_MODE_ZERO_COPY) {
+        return init_zero_copy(p);
+    }
+
+    // 为每个块分配DMA可用内存（压缩时留出最坏情况下一帧的余量，只录波束时波束可能比采集的PCM多）
+    size_t pcmBytes = p->timing.blockBytes;
+    size_t beamBytes = (size_t)p->timing.blockFrames * p->config.beam.beams * sizeof(int16_t);
+    uint32_t flacChannels = p->config.slots;
+    if (p->config.beamOutput == AUDIO_BEAM_ONLY) {
+        pcmBytes = (beamBytes > pcmBytes) ? beamBytes : pcmBytes;
+        flacChannels = (fileChannels > flacChannels) ? fileChannels : flacChannels;
+    }
+    size_t capacity = (p->config.codec == AUDIO_CODEC_FLAC) ? FLAC_BLOCK_CAPACITY(p, flacChannels) : pcmBytes;
+    for (int i = 0; i < CAPTURE_PIPELINE_NUM_BUFFERS; i++) {
+        AudioBlock *block = &p->blocks[i];
+        block->data = capture_os_alloc(capacity, CAPTURE_MEM_DMA);
+        if (block->data == NULL) {
+            CAPTURE_LOGE(TAG, "Failed to allocate DMA buffer %d", i);
+            return false;
+        }
+        memset(block->data, 0, capacity);
+        block->size = p->timing.blockBytes;
+        block->capacity = capacity;
+        if (p->config.beamOutput == AUDIO_BEAM_WITH_RAW) {
+            block->beamData = capture_os_alloc(beamBytes, CAPTURE_MEM_DMA);
+            if (block->beamData == NULL) {
+                CAPTURE_LOGE(TAG, "Failed to allocate beam buffer %d", i);
+                return false;
+            }
+        }
+        // 多采样率输出：每块最多 块帧数/抽取比（向上取整）帧
+        for (uint32_t r = 0; r < p->config.rates.outputs; r++) {
+            uint32_t factor = profile->sampleRate / p->config.rates.rateHz[r];
+            size_t rateBytes = (size_t)(p->timing.blockFrames + factor - 1) / factor * channels * sizeof(int16_t);
+            block->rateData[r] = capture_os_alloc(rateBytes, CAPTURE_MEM_DMA);
+            if (block->rateData[r] == NULL) {
+                CAPTURE_LOGE(TAG, "Failed to allocate rate output buffer %d", i);
+                return false;
+            }
+        }
+    }
+    // 事件录音：预录/后录换算为块数，检测器看到的是去掉未选通道之前的完整TDM帧
+    if (p->config.eventCapture) {
+        uint64_t blockRate = (uint64_t)p->timing.blockFrames * 1000;
+        p->preRollBlocks = (uint32_t)(((uint64_t)p->config.preRollMs * profile->sampleRate + blockRate - 1) / blockRate);
+        p->postRollBlocks =
+            (uint32_t)(((uint64_t)p->config.postRollMs * profile->sampleRate + blockRate - 1) / blockRate);
+        if (p->postRollBlocks == 0) {
+            p->postRollBlocks = 1;
+        }
+        uint32_t eventMask = (p->config.eventChannelMask != 0) ? p->config.eventChannelMask : p->config.channelMask;
+        if (!event_detector_init(&p->detector, &p->config.detector, p->config.slots, p->timing.sampleBytes,
+                                 eventMask)) {
+            CAPTURE_LOGE(TAG, "Event detector does not support %u slots of %u bytes with mask 0x%02x",
+                         (unsigned)p->config.slots, (unsigned)p->timing.sampleBytes, (unsigned)eventMask);
+            return false;
+        }
+    }
+    init_spill(p);
+    if (p->config.eventCapture && p->spillCapacity == 0) {
+        CAPTURE_LOGE(TAG, "Event capture needs a PSRAM pre-roll ring");
+        return false;
+    }
+
+    if (!capture_pipeline_stage_enabled(&p->config)) {
+        block_ring_init(&p->ring, CAPTURE_PIPELINE_NUM_BUFFERS);
+        return true;
+    }
+
+    p->processReadySem = capture_os_sem_create();
+    if (p->processReadySem == NULL) {
+        CAPTURE_LOGE(TAG, "Failed to create processing semaphore");
+        return false;
+    }
+    if (p->config.beamOutput != AUDIO_BEAM_OFF &&
+        !beamformer_init(&p->beamformer, &p->config.beam, (float)profile->sampleRate, p->config.channelMask,
+                         p->timing.blockFrames)) {
+        CAPTURE_LOGE(TAG, "Failed to set up %u beams (array geometry or memory)", (unsigned)p->config.beam.beams);
+        return false;
+    }
+    if (p->config.beamOutput != AUDIO_BEAM_OFF) {
+        CAPTURE_LOGI(TAG, "%u beams from %u microphones, latency %.1f frames", (unsigned)p->beamformer.beams,
+                     (unsigned)p->beamformer.mics, (double)p->beamformer.latencyFrames);
+    }
+    if (p->config.doaEstimate &&
+        !doa_estimator_init(&p->doaEstimator, &p->config.doa, (float)profile->sampleRate, p->config.channelMask)) {
+        CAPTURE_LOGE(TAG, "Failed to set up DOA estimation (frame size, mic pairs, array geometry or memory)");
+        return false;
+    }
+    if (p->config.doaEstimate) {
+        // 每块最多带AUDIO_BLOCK_MAX_DOA个结果
+        uint32_t reportFrames = p->doaEstimator.windowsPerReport * p->doaEstimator.hopFrames;
+        if (p->timing.blockFrames > reportFrames * (AUDIO_BLOCK_MAX_DOA - 1)) {
+            CAPTURE_LOGE(TAG, "DOA reports every %u frames, more than %d per %u-frame block", (unsigned)reportFrames,
+                         AUDIO_BLOCK_MAX_DOA - 1, (unsigned)p->timing.blockFrames);
+            return false;
+        }
+        CAPTURE_LOGI(TAG, "DOA from %u pairs of %u microphones, %u-frame windows every %u frames, %u per report",
+                     (unsigned)p->doaEstimator.pairs, (unsigned)p->doaEstimator.mics,
+                     (unsigned)p->doaEstimator.frameSize, (unsigned)p->doaEstimator.hopFrames,
+                     (unsigned)p->doaEstimator.windowsPerReport);
+    }
+    if (p->config.features) {
+        if (!feature_extractor_init(&p->features, &p->config.feature, (float)profile->sampleRate, channels)) {
+            CAPTURE_LOGE(TAG, "Failed to set up the features (report period, FFT size, bands or memory)");
+            return false;
+        }
+        // 每块最多 块帧数/reportFrames + 1 条记录
+        p->featureRecordBytes = FEATURE_INDEX_RECORD_BYTES(channels, p->features.bands);
+        size_t featureBytes = (p->timing.blockFrames / p->features.reportFrames + 1) * p->featureRecordBytes;
+        for (int i = 0; i < CAPTURE_PIPELINE_NUM_BUFFERS; i++) {
+            p->blocks[i].featureData = capture_os_alloc(featureBytes, CAPTURE_MEM_FAST);
+            if (p->blocks[i].featureData == NULL) {
+                CAPTURE_LOGE(TAG, "Failed to allocate feature buffer %d", i);
+                return false;
+            }
+        }
+        CAPTURE_LOGI(TAG, "Features of %u channels every %u frames, %u bands from %u-frame FFTs, %u bytes per record",
+                     (unsigned)channels, (unsigned)p->features.reportFrames, (unsigned)p->features.bands,
+                     (unsigned)p->features.frameSize, (unsigned)p->featureRecordBytes);
+    }
+    if (p->config.rates.outputs != 0 &&
+        !decimator_init(&p->decimator, &p->config.rates, profile->sampleRate, channels, p->timing.blockFrames)) {
+        CAPTURE_LOGE(TAG, "Failed to set up the rate outputs (capture rate / 2^a x 3^b up to 1/%d, or memory)",
+                     DECIMATOR_MAX_FACTOR);
+        return false;
+    }
+    for (uint32_t i = 0; i < p->decimator.outputs; i++) {
+        CAPTURE_LOGI(TAG, "Rate output %u Hz: 1/%u, %.1f multiplies per frame and channel, latency %.1f frames",
+                     (unsigned)p->decimator.outputRate[i], (unsigned)p->decimator.outputFactor[i],
+                     (double)p->decimator.macsPerFrame[i], (double)p->decimator.latencyFrames[i]);
+    }
+    if (p->config.codec == AUDIO_CODEC_FLAC) {
+        // 压缩：编码器工作区和PCM副本优先放在内部RAM
+        if (!flac_encoder_init(&p->flacEncoder, &p->flacConfig)) {
+            CAPTURE_LOGE(TAG, "Failed to initialize FLAC encoder");
+            return false;
+        }
+        p->processScratch = capture_os_alloc(pcmBytes, CAPTURE_MEM_FAST);
+    } else {
+        if (p->config.codec == AUDIO_CODEC_BFP) {
+            CAPTURE_LOGI(TAG, "Block floating point: %u-frame groups, %u of %u bytes per block",
+                         (unsigned)p->bfpFormat.groupFrames, (unsigned)bfp_block_bytes(&p->bfpFormat),
+                         (unsigned)(p->timing.blockFrames * wav_block_align(&p->wavFormat)));
+        }
+        // 块浮点打包和解交织：工作缓冲区会换入块数组，必须和块一样是DMA可用内存
+        p->processScratch = capture_os_alloc(capacity, CAPTURE_MEM_DMA);
+    }
+    if (p->processScratch == NULL) {
+        CAPTURE_LOGE(TAG, "Failed to allocate processing buffer");
+        return false;
+    }
+    block_ring_init_staged(&p->ring, CAPTURE_PIPELINE_NUM_BUFFERS);
+    return true;
+}
+
+void capture_pipeline_deinit(CapturePipeline *p) {
+    if (!p->initialized) {
+        return;
+    }
+    if (p->config.mode == AUDIO_CAPTURE_MODE_ZERO_COPY && p->config.frameSource != NULL) {
+        atomic_store(&p->dmaCaptureEnabled, false);
+        p->config.frameSource->stop(p->config.frameSource);
+    }
+
+    // 释放块内存
+    for (int i = 0; i < CAPTURE_PIPELINE_NUM_BUFFERS; i++) {
+        if (p->blocks[i].data != NULL) {
+            capture_os_free(p->blocks[i].data);
+            p->blocks[i].data = NULL;
+        }
+        if (p->blocks[i].beamData != NULL) {
+            capture_os_free(p->blocks[i].beamData);
+            p->blocks[i].beamData = NULL;
+        }
+        if (p->blocks[i].featureData != NULL) {
+            capture_os_free(p->blocks[i].featureData);
+            p->blocks[i].featureData = NULL;
+        }
+        for (uint32_t r = 0; r < DECIMATOR_MAX_OUTPUTS; r++) {
+            if (p->blocks[i].rateData[r] != NULL) {
+                capture_os_free(p->blocks[i].rateData[r]);
+                p->blocks[i].rateData[r] = NULL;
+            }
+        }
+    }
+
+    // 释放溢出环
+    if (p->spillMemory != NULL) {
+        capture_os_free(p->spillMemory);
+        p->spillMemory = NULL;
+    }
+    if (p->spillBlocks != NULL) {
+        capture_os_free(p->spillBlocks);
+        p->spillBlocks = NULL;
+    }
+    p->spillCapacity = 0;
+
+    // 释放处理阶段的资源
+    flac_encoder_deinit(&p->flacEncoder);
+    beamformer_deinit(&p->beamformer);
+    doa_estimator_deinit(&p->doaEstimator);
+    decimator_deinit(&p->decimator);
+    feature_extractor_deinit(&p->features);
+    if (p->processScratch != NULL) {
+        capture_os_free(p->processScratch);
+        p->processScratch = NULL;
+    }
+
+    // 删除信号量
+    capture_sem_t *sems[] = { &p->processReadySem, &p->dataReadySem, &p->spaceFreeSem, &p->prepSem,
+                              &p->prepDoneSem };
+    for (size_t i = 0; i < sizeof(sems) / sizeof(sems[0]); i++) {
+        if (*sems[i] != NULL) {
+            capture_os_sem_delete(*sems[i]);
+            *sems[i] = NULL;
+        }
+    }
+
+    // 关闭文件（如果打开），删除轮转时预先打开但没有用到的文件
+    close_audio_file(p);
+    if (atomic_load(&p->retirePending)) {
+        close_capture_file(p->retiredFile);
+        atomic_store(&p->retirePending, false);
+    }
+    if (atomic_load(&p->nextReady)) {
+        discard_capture_file(p, p->nextFile);
+        atomic_store(&p->nextReady, false);
+    }
+    if (p->config.journalPath != NULL) {
+        recovery_journal_close(&p->journal);
+    }
+    file_sequence_close(&p->fileSeq);
+    p->initialized = false;
+}
+
+bool capture_pipeline_start_tasks(CapturePipeline *p) {
+    const CapturePipelineConfig *config = &p->config;
+
+    // 创建音频捕获任务
+    if (!capture_os_task_create(
+            (config->mode == AUDIO_CAPTURE_MODE_ZERO_COPY) ? zero_copy_capture_task : capture_task,
+            "audio_capture_task", config->captureTask.stackBytes, p, config->captureTask.priority,
+            config->captureTask.core, &p->captureTask)) {
+        CAPTURE_LOGE(TAG, "Failed to create audio capture task");
+        p->captureTask = NULL;
+        return false;
+    }
+
+    // 创建处理任务：与采集任务同核，采集任务大部分时间阻塞在读取上
+    if (capture_pipeline_stage_enabled(config) &&
+        !capture_os_task_create(process_task, "process_task", config->processTask.stackBytes, p,
+                                config->processTask.priority, config->processTask.core, &p->processTask)) {
+        CAPTURE_LOGE(TAG, "Failed to create processing task");
+        p->processTask = NULL;
+        capture_pipeline_delete_tasks(p);
+        return false;
+    }
+
+    // 创建预备任务：与文件任务同核，优先级更低，只在轮转前后短暂运行
+    if (rotation_enabled(config) &&
+        !capture_os_task_create(file_prep_task, "file_prep_task", config->prepTask.stackBytes, p,
+                                config->prepTask.priority, config->prepTask.core, &p->prepTask)) {
+        CAPTURE_LOGE(TAG, "Failed to create file prep task");
+        p->prepTask = NULL;
+        capture_pipeline_delete_tasks(p);
+        return false;
+    }
+
+    // 创建文件保存任务
+    if (!capture_os_task_create(file_save_task, "file_save_task", config->fileTask.stackBytes, p,
+                                config->fileTask.priority, config->fileTask.core, &p->fileTask)) {
+        CAPTURE_LOGE(TAG, "Failed to create file save task");
+        p->fileTask = NULL;
+        capture_pipeline_delete_tasks(p);
+        return false;
+    }
+    return true;
+}
+
+void capture_pipeline_delete_tasks(CapturePipeline *p) {
+    capture_task_t *tasks[] = { &p->captureTask, &p->processTask, &p->fileTask, &p->prepTask };
+    for (size_t i = 0; i < sizeof(tasks) / sizeof(tasks[0]); i++) {
+        if (*tasks[i] != NULL) {
+            capture_os_task_delete(*tasks[i]);
+            *tasks[i] = NULL;
+        }
+    }
+}
+
+bool capture_pipeline_is_paused(const CapturePipeline *p) {
+    return p->captureTask != NULL && capture_os_task_is_suspended(p->captureTask);
+}
+
+uint32_t capture_pipeline_pause_timeout_ms(const CapturePipeline *p) {
+    // drain_ring的空闲上限，加上写完内部环和溢出环中所有块的时间（按观察到的最慢一次写出，
+    // 不低于一块的时长）、溢出环按配置要承受的一次写卡停顿（可能正在进行），再加上关闭文件前
+    // 等待预备任务的时间
+    uint32_t blocks = (p->config.mode == AUDIO_CAPTURE_MODE_ZERO_COPY ? p->zcNumBlocks : CAPTURE_PIPELINE_NUM_BUFFERS) +
+                      p->spillCapacity;
+    uint32_t blockMs = (uint32_t)((uint64_t)p->timing.blockFrames * 1000 / p->config.profile.sampleRate) + 1;
+    uint32_t writeMs = (atomic_load_explicit(&p->stats.writeLatency.maxUs, memory_order_relaxed) + 999) / 1000;
+    if (writeMs < blockMs) {
+        writeMs = blockMs;
+    }
+    uint32_t stallMs = p->spillCapacity > 0 ? p->config.spillStallMs : 0;
+    return DRAIN_IDLE_WAITS * DRAIN_IDLE_WAIT_MS + blocks * writeMs + stallMs + PREP_WAIT_MS;
+}
+
+bool capture_pipeline_pause(CapturePipeline *p) {
+    if (p->captureTask == NULL || p->fileTask == NULL) {
+        return false;
+    }
+
+    // 通知任务暂停，等待两个任务都挂起（文件任务要先写完环中的块并关闭文件）。
+    // 等待上限每次重新推算：排空过程中观察到更慢的写卡时上限随之增长
+    capture_os_notify_give(p->captureTask);
+    capture_os_notify_give(p->fileTask);
+    for (uint32_t waited = 0; waited < capture_pipeline_pause_timeout_ms(p); waited += 10) {
+        if (p->fileTask == NULL) {
+            return false;
+        }
+        if (capture_os_task_is_suspended(p->captureTask) && capture_os_task_is_suspended(p->fileTask)) {
+            return true;
+        }
+        capture_os_delay_ms(10);
+    }
+    return false;
+}
+
+void capture_pipeline_resume(CapturePipeline *p) {
+    capture_os_task_resume(p->captureTask);
+    capture_os_task_resume(p->fileTask);
+}
+
+void capture_pipeline_get_stats(CapturePipeline *p, CapturePipelineStats *stats) {
+    capture_stats_snapshot(&p->stats, &stats->pipeline);
+    if (p->config.mode == AUDIO_CAPTURE_MODE_ZERO_COPY) {
+        stats->ringCapacity = p->zcNumBlocks;
+        stats->droppedFrames = atomic_load_explicit(&p->dmaAssembler.droppedFrames, memory_order_relaxed);
+    } else {
+        stats->ringCapacity = CAPTURE_PIPELINE_NUM_BUFFERS;
+        stats->droppedFrames = 0;
+    }
+    stats->spillCapacity = p->spillCapacity;
+    stats->preRollBlocks = p->preRollBlocks;
+    stats->events = p->events;
+    stats->staleBlocks = p->staleBlocks;
+    stats->rotations = p->rotations;
+    stats->prepTimeouts = p->prepTimeouts;
+}
@@ -0,0 +1,389 @@
+#ifndef CAPTURE_PIPELINE_H
+#define CAPTURE_PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "CaptureOs.h"
+#include "BlockRing.h"
+#include "DmaBlockSource.h"
+#include "RecordWriter.h"
+#include "RecoveryJournal.h"
+#include "FileSequence.h"
+#include "WavFormat.h"
+#include "FlacEncoder.h"
+#include "PlanarFormat.h"
+#include "BfpCodec.h"
+#include "CaptureProfile.h"
+#include "CaptureStats.h"
+#include "BlockIndex.h"
+#include "EventDetector.h"
+#include "EventIndex.h"
+#include "LevelTap.h"
+#include "SyncClock.h"
+#include "Beamformer.h"
+#include "DoaEstimator.h"
+#include "DoaIndex.h"
+#include "Decimator.h"
+#include "FeatureExtractor.h"
+#include "FeatureIndex.h"
+
+// 采集到存储的完整链路：采集任务 -> (处理任务) -> 文件任务
+//
+// 三个阶段各自一个任务，核心和优先级由CaptureTaskConfig指定（设备上的分配见AudioCapture.h）。
+// 阶段之间的队列是同一个N块环上的三个索引（BlockRing的处理阶段），每个边界最多N块；
+// 内部环满时采集任务溢出到PSRAM或等待，并按当时持有多数块的阶段记一次背压。
+// 每个边界都有延迟直方图：读完->开始处理、处理耗时、读完->对文件任务可见、可见->开始写出、写出耗时。
+//
+// 只通过CaptureOs（任务、信号量、时间、内存）、CaptureReader/DmaFrameSource（数据源）
+// 和RecordBackend（存储）访问平台，不依赖ESP-IDF。ESP32上由AudioCapture提供I2S数据源和
+// FATFS后端；主机上由CaptureSimSource和POSIX后端驱动同一份代码（见tools/capture_bench）。
+
+#define CAPTURE_PIPELINE_NUM_BUFFERS    6   // 复制模式的块数(N) - 可调整
+#define CAPTURE_PIPELINE_MAX_ZC_BLOCKS  16  // 零拷贝模式的最大块数
+#define CAPTURE_PIPELINE_PATH_MAX       128
+
+// Capture modes
+typedef enum {
+    AUDIO_CAPTURE_MODE_COPY = 0,    // the reader copies into block buffers (default)
+    AUDIO_CAPTURE_MODE_ZERO_COPY,   // the DMA frame source queues DMA frames, written in place
+} audio_capture_mode_t;
+
+// Recording codecs
+typedef enum {
+    AUDIO_CODEC_PCM = 0,            // uncompressed WAV (default)
+    AUDIO_CODEC_FLAC,               // lossless FLAC stream, compressed on the capture core
+    AUDIO_CODEC_BFP,                // 24-bit samples as per-group exponents and 16-bit mantissas (BfpCodec.h)
+} audio_codec_t;
+
+// Channel layout of the recorded samples
+typedef enum {
+    AUDIO_LAYOUT_INTERLEAVED = 0,   // TDM frame order, slot0..slot7 per sample (default)
+    AUDIO_LAYOUT_PLANAR,            // each block split into one contiguous run per channel
+} audio_layout_t;
+
+// Beamformer output
+typedef enum {
+    AUDIO_BEAM_OFF = 0,             // no beamforming (default)
+    AUDIO_BEAM_ONLY,                // the recording holds the steered beams instead of the microphones
+    AUDIO_BEAM_WITH_RAW,            // the beams go to a WAV sidecar next to the microphone recording
+} audio_beam_output_t;
+
+// 复制模式的数据源：ESP32上包装i2s_channel_read，主机上是合成TDM源
+typedef struct CaptureReader {
+    // 阻塞读取len字节到buf（可以少于len），失败返回false
+    bool (*read)(struct CaptureReader *reader, void *buf, size_t len, size_t *bytesRead);
+    // 丢弃已缓存的数据并等到下一个DMA缓冲区完成（也丢弃），之后的读取从再下一个缓冲区的第一帧开始。
+    // 同步（syncClock）需要，NULL: 不支持
+    bool (*flush)(struct CaptureReader *reader);
+} CaptureReader;
+
+// 处理阶段对每个块的原地处理：data为frames帧交织样本（已去掉未选中的通道），不能改变长度
+typedef void (*CaptureBlockHook)(void *ctx, uint8_t *data, size_t length, uint32_t frames);
+
+// 任务参数
+typedef struct {
+    uint32_t stackBytes;
+    uint32_t priority;
+    int core;
+} CaptureTaskConfig;
+
+typedef struct {
+    audio_capture_mode_t mode;
+    audio_codec_t codec;
+    audio_layout_t layout;
+    uint32_t slots;                 // TDM槽位数
+    uint32_t channelMask;           // 录制的槽位（bit n = 槽位n）
+    CaptureProfile profile;
+    uint32_t maxBlockBytes;         // 块大小上限，按采集配置取整
+    uint32_t spillStallMs;          // 复制模式: PSRAM溢出环要承受的写卡停顿，0: 不使用溢出环
+    uint32_t spillMaxBytes;         // 溢出环最多占用的PSRAM，0: 不限（仍只用最大空闲块的3/4）
+
+    // 事件录音（复制模式）：预录保存在PSRAM溢出环中，只有检测到事件时才写卡
+    bool eventCapture;
+    EventDetectorConfig detector;
+    uint32_t eventChannelMask;      // 参与检测的槽位，0: 与channelMask相同
+    uint32_t preRollMs;             // 触发前保留的时长
+    uint32_t postRollMs;            // 最后一次触发后继续录制的时长（至少一块）
+
+    // 电平/频谱抽头（显示用）：复制模式由采集任务、零拷贝模式由文件任务送入每个块，NULL: 不使用
+    LevelTap *levelTap;
+
+    // 处理阶段的块处理（复制模式）：在方位估计、声学特征、多采样率输出、波束形成和压缩/解交织之前调用，
+    // 设置后总是启用处理阶段，NULL: 不使用
+    CaptureBlockHook processHook;
+    void *processCtx;
+
+    // 波束形成（复制模式，16位）：处理阶段按beam中的几何和指向把选中的通道合成为beam.beams路波束，
+    // beam.mic按槽位给出麦克风位置（只用channelMask选中的槽位）。AUDIO_BEAM_ONLY时录音文件（任意编码和
+    // 布局）的通道就是波束；AUDIO_BEAM_WITH_RAW时波束写入与录音文件同名、扩展名为beamExt的WAV文件
+    audio_beam_output_t beamOutput;
+    BeamformerConfig beam;
+
+    // 声源方位估计（复制模式，16位）：处理阶段在波束形成之前按doa对选中的通道做GCC-PHAT，
+    // doa.pair中的槽位必须在channelMask中。结果写入与录音文件同名、扩展名为doaExt的方位索引
+    bool doaEstimate;
+    DoaConfig doa;
+
+    // 多采样率输出（复制模式）：处理阶段在波束形成之前把选中的通道抽取到rates中的每个采样率
+    // （采样率的2^a x 3^b分之一），第i路写入与录音文件同名、扩展名为rateExt[i]的16位WAV文件。
+    // rates.outputs为0: 不输出
+    DecimatorConfig rates;
+
+    // 声学特征（复制模式）：处理阶段在波束形成之前为每个选中的通道按feature计算RMS、峰值、过零率和
+    // 频带能量，写入与录音文件同名、扩展名为featureExt的特征索引
+    bool features;
+    FeatureConfig feature;
+
+    // 多板同步（复制模式）：DMA完成和参考脉冲的中断送入syncClock，采集任务按块轮询出脉冲记录，
+    // 写入与录音文件同名的同步索引；要求reader支持flush。NULL: 不使用
+    SyncClock *syncClock;
+    uint32_t syncPeriodMs;          // 参考脉冲的标称周期
+
+    // 数据源（按模式二选一）
+    CaptureReader *reader;
+    DmaFrameSource *frameSource;
+    uint32_t zcDmaDescNum;          // 零拷贝: DMA描述符数量
+    uint32_t zcFramesPerBlock;      // 零拷贝: 每块包含的DMA帧数
+    uint32_t zcDmaFrameNum;         // 零拷贝: 每个DMA帧包含的采样帧数
+
+    // 存储
+    const RecordBackend *backend;   // NULL: 平台默认后端
+    const char *fileDir;
+    const char *filePrefix;
+    const char *pcmExt;
+    const char *flacExt;
+    const char *planarExt;
+    const char *bfpExt;
+    const char *indexExt;           // 块索引文件的扩展名，NULL: 不写块索引
+    const char *eventExt;           // 事件索引文件的扩展名，NULL: 不写事件索引
+    const char *syncExt;            // 同步索引文件的扩展名，NULL: 不写同步索引
+    const char *beamExt;            // AUDIO_BEAM_WITH_RAW: 波束文件的扩展名
+    const char *doaExt;             // 方位索引文件的扩展名，NULL: 只更新最新结果，不写方位索引
+    const char *rateExt[DECIMATOR_MAX_OUTPUTS];     // 每路多采样率输出的文件扩展名
+    const char *featureExt;         // 特征索引文件的扩展名，NULL: 只计数，不写特征索引
+    uint64_t preallocBytes;
+    uint32_t checkpointMs;
+    const char *journalPath;        // NULL: 不使用恢复日志
+    const char *seqPath;            // 文件序号状态文件，NULL: 启动时扫描目录，序号只保存在内存中
+
+    // 文件轮转：录音不停，在块边界切换到预先打开的下一个文件（两者都为0: 不轮转）
+    uint32_t rotateMs;              // 每个文件的时长上限，0: 不按时间轮转
+    uint64_t rotateBytes;           // 文件超过这个大小后轮转，0: 不按大小轮转
+
+    CaptureTaskConfig captureTask;
+    CaptureTaskConfig processTask;
+    CaptureTaskConfig fileTask;
+    CaptureTaskConfig prepTask;     // 启用轮转时：预先打开下一个文件、关闭上一个文件
+} CapturePipelineConfig;
+
+#define AUDIO_BLOCK_MAX_DOA     4   // 每块最多的方位估计数（限制估计的输出速率）
+
+typedef struct {
+    uint8_t *data;      // 块数据（DMA可用内存）
+    size_t size;        // 每块采集的PCM字节数
+    size_t capacity;    // 分配的字节数（压缩时留有余量，一帧可以原地写回）
+    size_t length;      // 待写出的字节数（压缩后为帧长度）
+    bool streamStart;   // 开始或恢复录音后的第一块
+    bool fileStart;     // 轮转后新文件的第一块（由采集任务标记）
+    int64_t readDoneUs; // 最后一次读取完成的时间（统计提交延迟，写入块索引）
+    int64_t stagedUs;   // 对文件任务可见的时间（统计写出前的排队时间）
+    uint64_t firstSample; // 第一帧在本次录音中的序号（含溢出丢失的帧）
+    uint8_t eventMark;  // 事件模式: AUDIO_BLOCK_EVENT_*
+    EventIndexRecord event; // 事件的第一块: 触发信息（原因、通道、电平、触发样本和时间）
+    bool hasSync;       // 读完这一块时换算出了一个参考脉冲
+    SyncIndexRecord sync;
+    uint8_t *beamData;  // AUDIO_BEAM_WITH_RAW: 这一块的波束（交织int16，DMA可用内存）
+    size_t beamLength;  // 待写出的波束字节数
+    uint32_t doaCount;  // 处理这一块时完成的方位估计
+    DoaIndexRecord doa[AUDIO_BLOCK_MAX_DOA];
+    uint8_t *rateData[DECIMATOR_MAX_OUTPUTS];   // 多采样率输出: 这一块抽取出的样本（交织int16，DMA可用内存）
+    size_t rateLength[DECIMATOR_MAX_OUTPUTS];   // 待写出的字节数（每块的帧数随抽取相位变化）
+    uint8_t *featureData;   // 声学特征: 处理这一块时完成的特征索引记录（已编码）
+    size_t featureLength;
+} AudioBlock;
+
+#define AUDIO_BLOCK_EVENT_START  (1u << 0)  // 事件的第一块（预录开始）
+#define AUDIO_BLOCK_EVENT_END    (1u << 1)  // 事件的最后一块（后录结束）
+
+// Capture pipeline telemetry
+typedef struct {
+    CaptureStatsSnapshot pipeline;  // overruns, commit/write latency histograms, ring high-water, bytes/s
+    uint32_t ringCapacity;          // blocks in the ring used by the current capture mode
+    uint32_t spillCapacity;         // copy mode: blocks in the PSRAM spill ring (0: no spill ring)
+    uint32_t preRollBlocks;         // event capture: blocks kept before a trigger
+    uint32_t events;                // event capture: events detected since start
+    uint32_t droppedFrames;         // zero-copy: DMA frames dropped because the ring was full
+    uint32_t staleBlocks;           // zero-copy: blocks overwritten by DMA before or while being written
+    uint32_t rotations;             // files started by rotation since init
+    uint32_t prepTimeouts;          // rotation: waits for the file prep task that hit the time limit
+} CapturePipelineStats;
+
+struct CapturePipeline;
+
+// 一个录音文件和它的附属索引文件。轮转时文件任务写当前文件，预备任务同时打开下一个文件
+// 或关闭上一个文件，所以每个文件有自己的文件头缓冲区（检查点回调使用）和码流统计
+typedef struct {
+    struct CapturePipeline *pipeline;
+    RecordWriter writer;
+    RecordWriter indexWriter;
+    RecordWriter eventWriter;
+    RecordWriter syncWriter;
+    RecordWriter beamWriter;
+    RecordWriter doaWriter;
+    RecordWriter rateWriter[DECIMATOR_MAX_OUTPUTS];
+    RecordWriter featureWriter;
+    FlacStreamInfo flacStream;      // 码流统计（写这个文件的任务维护）
+    _Alignas(4) uint8_t header[WAV_HEADER_BYTES];
+    char path[CAPTURE_PIPELINE_PATH_MAX];
+    char indexPath[CAPTURE_PIPELINE_PATH_MAX];
+    char eventPath[CAPTURE_PIPELINE_PATH_MAX];
+    char syncPath[CAPTURE_PIPELINE_PATH_MAX];
+    char beamPath[CAPTURE_PIPELINE_PATH_MAX];
+    char doaPath[CAPTURE_PIPELINE_PATH_MAX];
+    char ratePath[DECIMATOR_MAX_OUTPUTS][CAPTURE_PIPELINE_PATH_MAX];
+    char featurePath[CAPTURE_PIPELINE_PATH_MAX];
+    uint32_t seq;                   // 文件序号（FileSequence）
+} CaptureFile;
+
+typedef struct CapturePipeline {
+    CapturePipelineConfig config;
+    CaptureTiming timing;
+    bool initialized;
+
+    // 任务句柄
+    capture_task_t captureTask;
+    capture_task_t processTask;
+    capture_task_t fileTask;
+    capture_task_t prepTask;
+
+    // 复制模式：N块无锁环形缓冲区（单生产者/单消费者）
+    AudioBlock blocks[CAPTURE_PIPELINE_NUM_BUFFERS];
+    BlockRing ring;
+
+    // 复制模式：PSRAM溢出环。内部环满（写卡停顿）时采集任务直接读入溢出块，
+    // 内部环腾出空间后再按顺序搬回内部环，下游的处理和文件任务只看到内部环
+    AudioBlock *spillBlocks;
+    uint8_t *spillMemory;
+    uint32_t spillCapacity;
+    BlockRing spillRing;
+    bool ringFull;                  // 采集任务: 内部环满，正在溢出或等待（背压只在变满时记一次）
+
+    // 事件录音：检测器和预录/后录长度由采集任务使用；溢出环最早的spillKeep块属于事件，
+    // 必须搬回内部环写出，其余为预录，未触发时从最早的开始丢弃
+    EventDetector detector;
+    uint32_t preRollBlocks;
+    uint32_t postRollBlocks;
+    uint32_t spillKeep;
+    uint32_t events;
+
+    // 生产者提交块后通知消费者；消费者释放块后通知生产者（仅在环满时等待）
+    capture_sem_t dataReadySem;
+    capture_sem_t spaceFreeSem;
+    // 启用处理阶段时，生产者改为通知处理任务，由处理任务处理完后再通知消费者
+    capture_sem_t processReadySem;
+
+    // 零拷贝模式：块由DMA帧指针组成，环容量受DMA描述符数量限制
+    DmaBlock dmaBlocks[CAPTURE_PIPELINE_MAX_ZC_BLOCKS];
+    uint32_t zcNumBlocks;
+    DmaBlockAssembler dmaAssembler;
+    atomic_bool dmaCaptureEnabled;
+    uint32_t staleBlocks;           // 写出前后被DMA覆盖的块数
+
+    // 录音文件：当前文件、预先打开的下一个文件和正在关闭的上一个文件轮流使用三个槽位
+    CaptureFile files[3];
+    CaptureFile *file;              // 正在写的文件（文件任务）
+    CaptureFile *nextFile;          // 下一个文件，nextReady时已打开
+    CaptureFile *retiredFile;       // 轮转换下的文件，retirePending时由预备任务关闭
+    WavFormat wavFormat;
+    PlanarFormat planarFormat;
+    BfpFormat bfpFormat;
+    FlacConfig flacConfig;
+    FlacEncoder flacEncoder;
+
+    // 波束形成（处理任务），beamFormat为波束文件的格式
+    Beamformer beamformer;
+    WavFormat beamFormat;
+
+    // 声源方位估计（处理任务），最新结果任意任务可无锁读取
+    DoaEstimator doaEstimator;
+
+    // 多采样率输出（处理任务），rateFormat为每路输出文件的格式
+    Decimator decimator;
+    WavFormat rateFormat[DECIMATOR_MAX_OUTPUTS];
+
+    // 声学特征（处理任务），featureRecord为编码前的记录（不放在处理任务的栈上）
+    FeatureExtractor features;
+    FeatureIndexRecord featureRecord;
+    uint32_t featureRecordBytes;
+
+    // 处理阶段的工作缓冲区：压缩时存放编码前的PCM副本，解交织和块浮点打包时与块缓冲区交换
+    uint8_t *processScratch;
+
+    // 文件序号分配（由准备文件的任务访问，同一时刻只有一个）
+    FileSequence fileSeq;
+
+    // 恢复日志：每个检查点之后记录已落盘的长度和块序号
+    RecoveryJournal journal;
+    uint32_t blockSeq;              // 当前文件中的块序号（没有写出的块也占一个序号）
+    int64_t lastCheckpointUs;
+    bool journalPending;            // 轮转后新文件还没有登记到恢复日志（等旧文件关闭完成）
+
+    // 块索引：每写出一个块追加一条记录（文件任务维护）
+    uint64_t nextSample;            // 最后写出的块之后的样本序号，用于计算丢失的帧数（轮转时延续）
+    uint32_t zcBaseFrame;           // 零拷贝: 录音第一块的DMA帧序号
+    bool zcBaseValid;
+
+    // 事件索引：每个事件结束时追加一条记录（文件任务维护）
+    EventIndexRecord openEvent;     // 正在写出的事件
+    bool eventOpen;
+    uint32_t eventSeq;
+
+    // 文件轮转：预备任务由prepSem唤醒，处理retirePending和prepRequest后清除它们并给出prepDoneSem
+    capture_sem_t prepSem;
+    capture_sem_t prepDoneSem;
+    atomic_bool prepRequest;        // 文件任务请求打开下一个文件
+    atomic_bool nextReady;          // 下一个文件已打开
+    atomic_bool retirePending;      // 上一个文件等待关闭
+    int64_t fileStartUs;            // 零拷贝: 当前文件的开始时间（文件任务）
+    bool rotateHold;                // 打不开下一个文件，当前文件不再轮转
+    uint32_t fileSwitches;          // 文件任务处理过的轮转标记数
+    uint32_t rotateMarks;           // 采集任务标记过的轮转数
+    int64_t rotateStartUs;          // 复制模式: 当前文件第一块的读取时间（采集任务）
+    atomic_uint rotateRequest;      // 复制模式: 文件超过大小上限时为fileSwitches + 1，由采集任务在下一块上标记
+    uint32_t rotations;             // 已完成的轮转次数
+    uint32_t prepTimeouts;          // 文件任务等待预备任务超时的次数
+
+    // 运行统计：任意任务可无锁读取
+    CaptureStats stats;
+} CapturePipeline;
+
+// 是否在采集和写卡之间启用处理阶段（压缩、解交织、去掉未选中的通道、波束形成、方位估计、声学特征、
+// 多采样率输出或processHook）
+bool capture_pipeline_stage_enabled(const CapturePipelineConfig *config);
+
+// 检查配置并分配资源；零拷贝模式下同时启动帧源。失败时已分配的资源由deinit释放
+bool capture_pipeline_init(CapturePipeline *pipeline, const CapturePipelineConfig *config);
+// 释放所有资源（任务须已删除）
+void capture_pipeline_deinit(CapturePipeline *pipeline);
+
+// 创建采集、处理、文件任务和预备任务（文件任务随即打开第一个录音文件）
+bool capture_pipeline_start_tasks(CapturePipeline *pipeline);
+// 删除所有任务
+void capture_pipeline_delete_tasks(CapturePipeline *pipeline);
+
+// 通知任务暂停：采集任务丢弃未填满的块，文件任务写完环中的块并关闭文件。
+// 最多等待capture_pipeline_pause_timeout_ms，返回两个任务是否都已挂起
+bool capture_pipeline_pause(CapturePipeline *pipeline);
+// 暂停时文件任务写完环中的块并关闭文件所需时间的上限（毫秒）：drain_ring的空闲上限加上按观察到的
+// 写卡延迟推算的写出时间，随写卡延迟增长
+uint32_t capture_pipeline_pause_timeout_ms(const CapturePipeline *pipeline);
+// 恢复暂停的任务（文件任务开始一个新文件；轮转时预先打开的文件在暂停期间保留，恢复时直接使用）
+void capture_pipeline_resume(CapturePipeline *pipeline);
+bool capture_pipeline_is_paused(const CapturePipeline *pipeline);
+
+// 读取运行统计（任意任务，无锁）
+void capture_pipeline_get_stats(CapturePipeline *pipeline, CapturePipelineStats *stats);
+
+#endif /* CAPTURE_PIPELINE_H */
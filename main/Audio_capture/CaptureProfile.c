@@ -0,0 +1,120 @@
+#include "CaptureProfile.h"
+#include <stddef.h>
+
+// ESP-IDF支持的MCLK倍频，从小到大
+static const uint32_t mclkMultiples[] = { 256, 384, 512, 576, 768, 1024, 1152 };
+
+// 自动选择抽取比时的尝试顺序：抽取比越高，相同采样率下的PDM时钟越高
+static const uint8_t decimations[] = { 64, 32, 16 };
+
+static bool pdm_clock_valid(uint32_t pdmClockHz) {
+    return pdmClockHz >= CAPTURE_PDM_CLK_MIN_HZ && pdmClockHz <= CAPTURE_PDM_CLK_MAX_HZ;
+}
+
+static uint32_t gcd_u32(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+CaptureProfileError capture_profile_resolve(const CaptureProfile *profile, uint32_t maxBlockBytes,
+                                            CaptureTiming *timing) {
+    uint32_t rate = profile->sampleRate;
+    if (rate < CAPTURE_MIN_SAMPLE_RATE || rate > CAPTURE_MAX_SAMPLE_RATE) {
+        return CAPTURE_PROFILE_BAD_SAMPLE_RATE;
+    }
+    if (profile->bitsPerSample != 16 && profile->bitsPerSample != 24 && profile->bitsPerSample != 32) {
+        return CAPTURE_PROFILE_BAD_BITS;
+    }
+
+    // 抽取比：指定时只检查，未指定时取PDM时钟在范围内的最高抽取比
+    uint8_t decimation = profile->decimation;
+    if (decimation == 0) {
+        for (size_t i = 0; i < sizeof(decimations) / sizeof(decimations[0]); i++) {
+            if (pdm_clock_valid(rate * decimations[i])) {
+                decimation = decimations[i];
+                break;
+            }
+        }
+        if (decimation == 0) {
+            return CAPTURE_PROFILE_PDM_CLOCK_RANGE;
+        }
+    } else if (decimation != 16 && decimation != 32 && decimation != 64) {
+        return CAPTURE_PROFILE_BAD_DECIMATION;
+    } else if (!pdm_clock_valid(rate * decimation)) {
+        return CAPTURE_PROFILE_PDM_CLOCK_RANGE;
+    }
+
+    uint32_t slotBits = profile->bitsPerSample;
+    uint32_t frameBits = CAPTURE_TDM_SLOTS * slotBits;
+    uint64_t bclkHz = (uint64_t)rate * frameBits;
+    if (bclkHz > CAPTURE_BCLK_MAX_HZ) {
+        return CAPTURE_PROFILE_BCLK_RANGE;
+    }
+
+    // MCLK倍频：BCLK分频系数为整数且足够大，MCLK尽量低
+    uint32_t mclkMultiple = 0;
+    for (size_t i = 0; i < sizeof(mclkMultiples) / sizeof(mclkMultiples[0]); i++) {
+        uint32_t m = mclkMultiples[i];
+        if (m % frameBits == 0 && m / frameBits >= CAPTURE_MIN_BCLK_DIV) {
+            mclkMultiple = m;
+            break;
+        }
+    }
+    if (mclkMultiple == 0 || (uint64_t)rate * mclkMultiple > CAPTURE_MCLK_MAX_HZ) {
+        return CAPTURE_PROFILE_MCLK_RANGE;
+    }
+
+    // 块大小：不超过上限的、帧和扇区的最大公倍数
+    uint32_t sampleBytes = slotBits / 8;
+    uint32_t frameBytes = CAPTURE_TDM_SLOTS * sampleBytes;
+    uint32_t unit = frameBytes / gcd_u32(frameBytes, CAPTURE_SECTOR_BYTES) * CAPTURE_SECTOR_BYTES;
+    uint32_t blockBytes = maxBlockBytes / unit * unit;
+    if (blockBytes == 0) {
+        return CAPTURE_PROFILE_BLOCK_SIZE;
+    }
+
+    // DMA：每个描述符不超过4092字节，描述符环的总帧数不少于默认配置
+    uint32_t dmaFrameNum = CAPTURE_DMA_MAX_BUFFER_BYTES / frameBytes;
+    if (dmaFrameNum > CAPTURE_DMA_MAX_FRAMES) {
+        dmaFrameNum = CAPTURE_DMA_MAX_FRAMES;
+    }
+
+    timing->decimation = decimation;
+    timing->slotBits = (uint8_t)slotBits;
+    timing->sampleBytes = (uint8_t)sampleBytes;
+    timing->frameBytes = frameBytes;
+    timing->pdmClockHz = rate * decimation;
+    timing->bclkHz = (uint32_t)bclkHz;
+    timing->mclkMultiple = mclkMultiple;
+    timing->dmaFrameNum = dmaFrameNum;
+    timing->dmaDescNum = (CAPTURE_DMA_MIN_TOTAL_FRAMES + dmaFrameNum - 1) / dmaFrameNum;
+    timing->blockBytes = blockBytes;
+    timing->blockFrames = blockBytes / frameBytes;
+    return CAPTURE_PROFILE_OK;
+}
+
+const char *capture_profile_error_str(CaptureProfileError err) {
+    switch (err) {
+    case CAPTURE_PROFILE_OK:
+        return "ok";
+    case CAPTURE_PROFILE_BAD_SAMPLE_RATE:
+        return "sample rate out of range";
+    case CAPTURE_PROFILE_BAD_BITS:
+        return "bits per sample must be 16, 24 or 32";
+    case CAPTURE_PROFILE_BAD_DECIMATION:
+        return "decimation ratio must be 16, 32 or 64";
+    case CAPTURE_PROFILE_PDM_CLOCK_RANGE:
+        return "PDM clock out of the microphone range";
+    case CAPTURE_PROFILE_BCLK_RANGE:
+        return "TDM bit clock too high";
+    case CAPTURE_PROFILE_MCLK_RANGE:
+        return "no valid I2S MCLK multiple";
+    case CAPTURE_PROFILE_BLOCK_SIZE:
+        return "block buffer too small";
+    }
+    return "unknown error";
+}
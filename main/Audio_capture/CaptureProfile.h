@@ -0,0 +1,76 @@
+#ifndef CAPTURE_PROFILE_H
+#define CAPTURE_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 采集配置：采样率、位深和ADAU7118抽取比
+//
+// 三者必须一起切换：ADAU7118的DEC_RATIO和SPT槽位宽度、I2S TDM的时钟和槽位，
+// 以及按帧大小计算的块和DMA缓冲区。capture_profile_resolve()检查配置是否可行，
+// 并推导出这些参数。约束：
+//   PDM时钟 = 采样率 x 抽取比，在PDM麦克风的工作范围内
+//   BCLK = 采样率 x 8槽位 x 槽位宽度，不超过ADAU7118的上限
+//   MCLK = 采样率 x MCLK倍频，BCLK分频系数至少为4，MCLK不超过时钟源的一半
+//   每个DMA描述符不超过4092字节，DMA描述符环至少容纳默认的帧数
+//   块大小是帧字节数和扇区大小的公倍数
+//
+// ESP32-S3的I2S按数据位宽紧凑存放样本（24位占3字节），槽位宽度与位深相同。
+//
+// 不依赖ESP-IDF，可在主机上编译。
+
+#define CAPTURE_TDM_SLOTS               8
+#define CAPTURE_MIN_SAMPLE_RATE         8000
+#define CAPTURE_MAX_SAMPLE_RATE         192000
+#define CAPTURE_PDM_CLK_MIN_HZ          1000000     // PDM麦克风标准模式的时钟范围
+#define CAPTURE_PDM_CLK_MAX_HZ          3250000
+#define CAPTURE_BCLK_MAX_HZ             24576000    // ADAU7118串行口BCLK上限
+#define CAPTURE_MCLK_MAX_HZ             80000000    // I2S时钟源160MHz，MCLK至少2分频
+#define CAPTURE_MIN_BCLK_DIV            4
+#define CAPTURE_DMA_MAX_BUFFER_BYTES    4092        // 单个DMA描述符的上限
+#define CAPTURE_DMA_MAX_FRAMES          240         // 每个DMA描述符的最大帧数
+#define CAPTURE_DMA_MIN_TOTAL_FRAMES    1440        // DMA描述符环至少容纳的帧数（默认6 x 240）
+#define CAPTURE_SECTOR_BYTES            512
+
+typedef struct {
+    uint32_t sampleRate;        // 输出采样率（Hz）
+    uint8_t bitsPerSample;      // 16、24或32
+    uint8_t decimation;         // ADAU7118抽取比：16、32或64；0表示自动选择
+} CaptureProfile;
+
+// 常用配置：长时间低码率录音和短时间高精度录音
+#define CAPTURE_PROFILE_LONG    { .sampleRate = 16000, .bitsPerSample = 16, .decimation = 64 }
+#define CAPTURE_PROFILE_BURST   { .sampleRate = 96000, .bitsPerSample = 24, .decimation = 32 }
+
+// 由采集配置推导出的硬件和缓冲区参数
+typedef struct {
+    uint8_t decimation;         // 实际使用的抽取比
+    uint8_t slotBits;           // TDM槽位宽度
+    uint8_t sampleBytes;        // 内存中每个样本的字节数
+    uint32_t frameBytes;        // 每个TDM帧（全部槽位）的字节数
+    uint32_t pdmClockHz;
+    uint32_t bclkHz;
+    uint32_t mclkMultiple;      // MCLK = 采样率 x mclkMultiple
+    uint32_t dmaFrameNum;       // 每个DMA描述符的帧数
+    uint32_t dmaDescNum;        // DMA描述符数量
+    uint32_t blockBytes;        // 每块字节数（不超过给定的上限）
+    uint32_t blockFrames;       // 每块帧数
+} CaptureTiming;
+
+typedef enum {
+    CAPTURE_PROFILE_OK = 0,
+    CAPTURE_PROFILE_BAD_SAMPLE_RATE,
+    CAPTURE_PROFILE_BAD_BITS,
+    CAPTURE_PROFILE_BAD_DECIMATION,
+    CAPTURE_PROFILE_PDM_CLOCK_RANGE,
+    CAPTURE_PROFILE_BCLK_RANGE,
+    CAPTURE_PROFILE_MCLK_RANGE,
+    CAPTURE_PROFILE_BLOCK_SIZE,
+} CaptureProfileError;
+
+// 检查配置并推导参数，maxBlockBytes为块缓冲区的大小上限
+CaptureProfileError capture_profile_resolve(const CaptureProfile *profile, uint32_t maxBlockBytes,
+                                            CaptureTiming *timing);
+const char *capture_profile_error_str(CaptureProfileError err);
+
+#endif /* CAPTURE_PROFILE_H */
@@ -0,0 +1,171 @@
+#include "CaptureSimSource.h"
+#include <string.h>
+#include <math.h>
+
+// 从起点到现在DMA已经产生的帧数
+static uint64_t frames_available(const CaptureSimSource *sim, int64_t nowUs) {
+    if (sim->ppm != 0) {
+        return (uint64_t)((double)(nowUs - sim->startUs) * sim->sampleRate * sim->speed * (1 + sim->ppm * 1e-6) / 1e6);
+    }
+    return (uint64_t)(nowUs - sim->startUs) * sim->sampleRate * sim->speed / 1000000;
+}
+
+// 送入SyncClock的时间戳是模拟的设备时间：从起点起按倍速展开，与实时运行时相同
+
+// 第count个DMA缓冲区完成（产生到第count x dmaBufferFrames帧）的设备时间
+static int64_t dma_done_us(const CaptureSimSource *sim, uint64_t count) {
+    double frames = (double)count * sim->dmaBufferFrames;
+    return sim->startUs + llround(frames * 1e6 / ((double)sim->sampleRate * (1 + sim->ppm * 1e-6)));
+}
+
+// 第k个参考脉冲（从1开始）的设备时间
+static int64_t pulse_us(const CaptureSimSource *sim, uint64_t k) {
+    return sim->startUs + (int64_t)(k * sim->pulsePeriodMs * 1000);
+}
+
+// 把前done个DMA缓冲区的完成和此前的参考脉冲送入SyncClock（设备上由两个中断实时送入）
+static void report_sync(CaptureSimSource *sim, uint64_t done) {
+    if (sim->sync == NULL) {
+        return;
+    }
+    int64_t limitUs = dma_done_us(sim, done);
+    while (pulse_us(sim, sim->pulsesReported + 1) <= limitUs) {
+        sim->pulsesReported++;
+        sync_clock_pulse(sim->sync, pulse_us(sim, sim->pulsesReported));
+    }
+    while (sim->dmaReported < done) {
+        sim->dmaReported++;
+        sync_clock_dma_done(sim->sync, dma_done_us(sim, sim->dmaReported));
+    }
+}
+
+// 等到DMA至少产生了frames帧，返回已产生的帧数
+static uint64_t wait_frames(const CaptureSimSource *sim, uint64_t frames) {
+    uint64_t available = frames_available(sim, capture_os_now_us());
+    while (available < frames) {
+        uint64_t waitUs = (frames - available) * 1000000 / ((uint64_t)sim->sampleRate * sim->speed);
+        capture_os_delay_ms((uint32_t)(waitUs / 1000) + 1);
+        available = frames_available(sim, capture_os_now_us());
+    }
+    return available;
+}
+
+// 读取者落后超过DMA缓冲区容量时，按整个缓冲区丢弃最早的帧
+static void drop_overrun(CaptureSimSource *sim, uint64_t available) {
+    if (available - sim->nextFrame <= sim->dmaFrames) {
+        return;
+    }
+    uint64_t behind = available - sim->dmaFrames - sim->nextFrame;
+    uint64_t buffers = (behind + sim->dmaBufferFrames - 1) / sim->dmaBufferFrames;
+    sim->nextFrame += buffers * sim->dmaBufferFrames;
+    sim->lostFrames += buffers * sim->dmaBufferFrames;
+    if (sim->stats != NULL) {
+        for (uint64_t i = 0; i < buffers; i++) {
+            capture_stats_overrun(sim->stats);
+        }
+    }
+}
+
+// 写入一帧：各槽位按小端、样本宽度紧凑存放
+static void fill_frame(const CaptureSimSource *sim, uint8_t *out, uint64_t frame) {
+    // 突发模式下槽位2以上在突发之外为静音
+    bool bursts = sim->burstPeriod != 0;
+    bool inBurst = bursts && capture_sim_in_burst(sim, frame);
+    uint32_t other = !bursts ? capture_sim_sample(frame, 0, sim->sampleBytes)
+                   : inBurst ? capture_sim_burst_sample(frame, sim->sampleBytes) : 0;
+    if (sim->sampleBytes == 2) {
+        // 常用的16位样本：按16位直接写入（主机为小端）
+        uint16_t *samples = (uint16_t *)out;
+        samples[0] = (uint16_t)frame;
+        samples[1] = (uint16_t)(frame >> 16);
+        for (uint32_t slot = 2; slot < sim->slots; slot++) {
+            samples[slot] = (uint16_t)other;
+        }
+        return;
+    }
+    for (uint32_t slot = 0; slot < sim->slots; slot++) {
+        uint32_t value = (slot < 2) ? capture_sim_sample(frame, slot, sim->sampleBytes) : other;
+        for (uint32_t b = 0; b < sim->sampleBytes; b++) {
+            *out++ = (uint8_t)(value >> (8 * b));
+        }
+    }
+}
+
+static bool sim_read(CaptureReader *reader, void *buf, size_t len, size_t *bytesRead) {
+    CaptureSimSource *sim = (CaptureSimSource *)reader;
+    uint64_t want = len / sim->frameBytes;
+    *bytesRead = 0;
+    if (want == 0) {
+        return false;
+    }
+
+    int64_t now = capture_os_now_us();
+    if (sim->startUs == 0) {
+        sim->startUs = now;
+    }
+
+    // 像i2s_channel_read一样以DMA缓冲区为单位交付：至少等到一个缓冲区（或请求的帧数）就绪
+    uint64_t need = (want < sim->dmaBufferFrames) ? want : sim->dmaBufferFrames;
+    uint64_t available = wait_frames(sim, sim->nextFrame + need);
+    report_sync(sim, available / sim->dmaBufferFrames);
+    drop_overrun(sim, available);
+
+    uint64_t frames = available - sim->nextFrame;
+    if (frames > want) {
+        frames = want;
+    }
+    uint8_t *out = buf;
+    for (uint64_t f = 0; f < frames; f++) {
+        fill_frame(sim, out, sim->nextFrame + f);
+        out += sim->frameBytes;
+    }
+    sim->nextFrame += frames;
+    *bytesRead = (size_t)(frames * sim->frameBytes);
+    return true;
+}
+
+// 丢弃已产生的帧，等下一个DMA缓冲区完成后也丢弃它，之后从再下一个缓冲区开始交付。
+// 只送入到这个缓冲区为止的DMA完成，与设备上清空之后立即读取DMA计数一致
+static bool sim_flush(CaptureReader *reader) {
+    CaptureSimSource *sim = (CaptureSimSource *)reader;
+    if (sim->startUs == 0) {
+        sim->startUs = capture_os_now_us();
+    }
+    uint64_t next = frames_available(sim, capture_os_now_us()) / sim->dmaBufferFrames + 1;
+    wait_frames(sim, next * sim->dmaBufferFrames);
+    report_sync(sim, next);
+    sim->nextFrame = next * sim->dmaBufferFrames;
+    sim->firstFrame = sim->nextFrame;
+    return true;
+}
+
+bool capture_sim_source_init(CaptureSimSource *sim, const CaptureProfile *profile, const CaptureTiming *timing,
+                             uint32_t slots, uint32_t speed, CaptureStats *stats) {
+    if (sim == NULL || profile == NULL || timing == NULL || slots == 0 ||
+        speed == 0 || speed > CAPTURE_SIM_MAX_SPEED) {
+        return false;
+    }
+    memset(sim, 0, sizeof(*sim));
+    sim->base.read = sim_read;
+    sim->base.flush = sim_flush;
+    sim->sampleRate = profile->sampleRate;
+    sim->speed = speed;
+    sim->slots = slots;
+    sim->sampleBytes = timing->sampleBytes;
+    sim->frameBytes = timing->frameBytes;
+    sim->dmaBufferFrames = timing->dmaFrameNum;
+    sim->dmaFrames = timing->dmaFrameNum * timing->dmaDescNum;
+    sim->stats = stats;
+    return true;
+}
+
+void capture_sim_source_set_bursts(CaptureSimSource *sim, uint64_t periodFrames, uint64_t burstFrames) {
+    sim->burstPeriod = periodFrames;
+    sim->burstFrames = (burstFrames < periodFrames) ? burstFrames : periodFrames;
+}
+
+void capture_sim_source_set_sync(CaptureSimSource *sim, SyncClock *sync, double ppm, uint32_t periodMs) {
+    sim->sync = sync;
+    sim->ppm = ppm;
+    sim->pulsePeriodMs = periodMs;
+}
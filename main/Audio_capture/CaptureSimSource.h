@@ -0,0 +1,83 @@
+#ifndef CAPTURE_SIM_SOURCE_H
+#define CAPTURE_SIM_SOURCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "CapturePipeline.h"
+#include "SyncClock.h"
+
+// 合成TDM源：在主机上代替i2s_channel_read驱动CapturePipeline的复制模式
+//
+// 按 采样率 x 倍速 的节奏产生帧（以第一次读取为时间零点），每帧各槽位写入带时间戳的样本计数：
+//   槽位0 = 帧序号的低位，槽位1 = 帧序号的高位（样本宽度为16位时各16位），其余槽位 = 槽位0的值
+// 帧序号除以采样率就是该帧的采集时间，读回文件即可检查是否丢帧以及丢在哪里。
+//
+// 设置了突发（capture_sim_source_set_bursts）时，其余槽位平时为静音，只在每个周期的最后
+// burstFrames帧输出-12dBFS的方波，用来驱动事件录音；槽位0/1不变，仍可逐帧校验。
+//
+// 同时模拟I2S驱动的DMA缓冲区：读取者落后超过 descNum x frameNum 帧时，最早的DMA缓冲区被丢弃
+// （与驱动消息队列溢出相同），按缓冲区计入CaptureStats的overruns。
+//
+// 设置了同步（capture_sim_source_set_sync）时，采样时钟按ppm偏离标称值，每个DMA缓冲区完成和
+// 每个参考脉冲（从第一次读取起每periodMs一个，脉冲源的时钟就是主机时钟）按模拟的时刻送入SyncClock，
+// 相当于设备上的两个中断（时间戳按倍速换算为设备时间）；脉冲k在帧流中的准确位置是
+// k x 每周期标称帧数 x (1 + ppm/1e6)。
+//
+// 只依赖CaptureOs的时间函数，不依赖ESP-IDF。
+
+#define CAPTURE_SIM_MAX_SPEED   50
+
+typedef struct {
+    CaptureReader base;         // 必须是第一个成员
+    uint32_t sampleRate;
+    uint32_t speed;             // 实时倍数
+    uint32_t slots;
+    uint32_t sampleBytes;
+    uint32_t frameBytes;
+    uint32_t dmaBufferFrames;   // 每个DMA缓冲区的帧数
+    uint32_t dmaFrames;         // DMA缓冲区总共可以缓存的帧数
+    CaptureStats *stats;        // 溢出计数，可为NULL
+    int64_t startUs;            // 0表示尚未开始
+    uint64_t nextFrame;         // 下一个交付的帧序号
+    uint64_t lostFrames;        // 因溢出丢弃的帧数
+    uint64_t burstPeriod;       // 突发周期（帧），0表示不使用突发
+    uint64_t burstFrames;       // 每个周期末尾的突发长度（帧）
+    uint64_t firstFrame;        // 最近一次flush之后交付的第一帧
+    SyncClock *sync;            // NULL表示不模拟同步
+    double ppm;                 // 采样时钟相对标称值的偏差
+    uint32_t pulsePeriodMs;
+    uint64_t dmaReported;       // 已送入SyncClock的DMA缓冲区完成数
+    uint64_t pulsesReported;    // 已送入SyncClock的参考脉冲数
+} CaptureSimSource;
+
+// 按采集配置推导出的帧格式和DMA参数初始化，speed为1..CAPTURE_SIM_MAX_SPEED
+bool capture_sim_source_init(CaptureSimSource *sim, const CaptureProfile *profile, const CaptureTiming *timing,
+                             uint32_t slots, uint32_t speed, CaptureStats *stats);
+
+// 设置突发（帧数），period为0时恢复为所有槽位都带帧序号
+void capture_sim_source_set_bursts(CaptureSimSource *sim, uint64_t periodFrames, uint64_t burstFrames);
+
+// 模拟多板同步：采样时钟偏差ppm，参考脉冲周期periodMs（在第一次读取之前调用）
+void capture_sim_source_set_sync(CaptureSimSource *sim, SyncClock *sync, double ppm, uint32_t periodMs);
+
+// 帧是否在突发中
+static inline bool capture_sim_in_burst(const CaptureSimSource *sim, uint64_t frame) {
+    return frame % sim->burstPeriod >= sim->burstPeriod - sim->burstFrames;
+}
+
+// 突发中槽位2以上的样本值：每8帧翻转一次的±1/4满量程方波（按样本宽度截断）
+static inline uint32_t capture_sim_burst_sample(uint64_t frame, uint32_t sampleBytes) {
+    uint32_t bits = sampleBytes * 8;
+    uint32_t mask = (bits >= 32) ? 0xFFFFFFFFu : ((1u << bits) - 1);
+    int32_t amplitude = (int32_t)(1u << (bits - 3));
+    return (uint32_t)(((frame >> 3) & 1) ? amplitude : -amplitude) & mask;
+}
+
+// 帧序号对应的槽位样本值（供校验使用，按样本宽度截断）
+static inline uint32_t capture_sim_sample(uint64_t frame, uint32_t slot, uint32_t sampleBytes) {
+    uint32_t bits = sampleBytes * 8;
+    uint64_t mask = (bits >= 32) ? 0xFFFFFFFFull : ((1ull << bits) - 1);
+    return (uint32_t)(((slot == 1) ? (frame >> bits) : frame) & mask);
+}
+
+#endif /* CAPTURE_SIM_SOURCE_H */
@@ -0,0 +1,112 @@
+#include "CaptureStats.h"
+
+static void hist_reset(CaptureLatencyHist *hist) {
+    for (uint32_t i = 0; i < CAPTURE_STATS_BUCKETS; i++) {
+        atomic_store_explicit(&hist->bucket[i], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&hist->maxUs, 0, memory_order_relaxed);
+    atomic_store_explicit(&hist->lastUs, 0, memory_order_relaxed);
+}
+
+static void hist_snapshot(const CaptureLatencyHist *hist, uint32_t *buckets, uint32_t *maxUs, uint32_t *lastUs) {
+    CaptureLatencyHist *h = (CaptureLatencyHist *)hist;
+    for (uint32_t i = 0; i < CAPTURE_STATS_BUCKETS; i++) {
+        buckets[i] = atomic_load_explicit(&h->bucket[i], memory_order_relaxed);
+    }
+    *maxUs = atomic_load_explicit(&h->maxUs, memory_order_relaxed);
+    *lastUs = atomic_load_explicit(&h->lastUs, memory_order_relaxed);
+}
+
+void capture_stats_reset(CaptureStats *stats) {
+    atomic_store_explicit(&stats->overruns, 0, memory_order_relaxed);
+    atomic_store_explicit(&stats->blocksCommitted, 0, memory_order_relaxed);
+    atomic_store_explicit(&stats->blocksSpilled, 0, memory_order_relaxed);
+    atomic_store_explicit(&stats->spillHighWater, 0, memory_order_relaxed);
+    atomic_store_explicit(&stats->discardedFrames, 0, memory_order_relaxed);
+    atomic_store_explicit(&stats->backpressureProcess, 0, memory_order_relaxed);
+    atomic_store_explicit(&stats->backpressurePersist, 0, memory_order_relaxed);
+    atomic_store_explicit(&stats->processHighWater, 0, memory_order_relaxed);
+    atomic_store_explicit(&stats->flacFallbacks, 0, memory_order_relaxed);
+    atomic_store_explicit(&stats->blocksWritten, 0, memory_order_relaxed);
+    atomic_store_explicit(&stats->writeErrors, 0, memory_order_relaxed);
+    atomic_store_explicit(&stats->corruptBlocks, 0, memory_order_relaxed);
+    atomic_store_explicit(&stats->ringHighWater, 0, memory_order_relaxed);
+    atomic_store_explicit(&stats->bytesPerSec, 0, memory_order_relaxed);
+    hist_reset(&stats->commitLatency);
+    hist_reset(&stats->processWaitLatency);
+    hist_reset(&stats->processLatency);
+    hist_reset(&stats->writeWaitLatency);
+    hist_reset(&stats->writeLatency);
+}
+
+void capture_stats_snapshot(const CaptureStats *stats, CaptureStatsSnapshot *out) {
+    CaptureStats *s = (CaptureStats *)stats;
+    out->overruns = atomic_load_explicit(&s->overruns, memory_order_relaxed);
+    out->blocksCommitted = atomic_load_explicit(&s->blocksCommitted, memory_order_relaxed);
+    out->blocksSpilled = atomic_load_explicit(&s->blocksSpilled, memory_order_relaxed);
+    out->spillHighWater = atomic_load_explicit(&s->spillHighWater, memory_order_relaxed);
+    out->discardedFrames = atomic_load_explicit(&s->discardedFrames, memory_order_relaxed);
+    out->backpressureProcess = atomic_load_explicit(&s->backpressureProcess, memory_order_relaxed);
+    out->backpressurePersist = atomic_load_explicit(&s->backpressurePersist, memory_order_relaxed);
+    out->processHighWater = atomic_load_explicit(&s->processHighWater, memory_order_relaxed);
+    out->flacFallbacks = atomic_load_explicit(&s->flacFallbacks, memory_order_relaxed);
+    out->blocksWritten = atomic_load_explicit(&s->blocksWritten, memory_order_relaxed);
+    out->writeErrors = atomic_load_explicit(&s->writeErrors, memory_order_relaxed);
+    out->corruptBlocks = atomic_load_explicit(&s->corruptBlocks, memory_order_relaxed);
+    out->ringHighWater = atomic_load_explicit(&s->ringHighWater, memory_order_relaxed);
+    out->bytesPerSec = atomic_load_explicit(&s->bytesPerSec, memory_order_relaxed);
+    hist_snapshot(&s->commitLatency, out->commitHist, &out->commitMaxUs, &out->commitLastUs);
+    hist_snapshot(&s->processWaitLatency, out->processWaitHist, &out->processWaitMaxUs, &out->processWaitLastUs);
+    hist_snapshot(&s->processLatency, out->processHist, &out->processMaxUs, &out->processLastUs);
+    hist_snapshot(&s->writeWaitLatency, out->writeWaitHist, &out->writeWaitMaxUs, &out->writeWaitLastUs);
+    hist_snapshot(&s->writeLatency, out->writeHist, &out->writeMaxUs, &out->writeLastUs);
+}
+
+uint32_t capture_stats_percentile_us(const uint32_t *hist, uint32_t percent) {
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < CAPTURE_STATS_BUCKETS; i++) {
+        total += hist[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    // 第一个累计数量达到目标的桶
+    uint64_t target = (total * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < CAPTURE_STATS_BUCKETS; i++) {
+        seen += hist[i];
+        if (seen >= target) {
+            return (i + 1 < CAPTURE_STATS_BUCKETS) ? (2u << i) : UINT32_MAX;
+        }
+    }
+    return UINT32_MAX;
+}
+
+void capture_stats_restart_rate(CaptureStats *stats) {
+    stats->rateWindowStartUs = 0;
+    stats->rateWindowBytes = 0;
+}
+
+void capture_stats_block_written(CaptureStats *stats, uint32_t bytes, uint32_t latencyUs, uint64_t nowUs,
+                                 bool ok) {
+    if (!ok) {
+        atomic_fetch_add_explicit(&stats->writeErrors, 1, memory_order_relaxed);
+        return;
+    }
+    atomic_fetch_add_explicit(&stats->blocksWritten, 1, memory_order_relaxed);
+    capture_latency_record(&stats->writeLatency, latencyUs);
+
+    // 每个统计窗口结束时更新写卡速率
+    if (stats->rateWindowStartUs == 0) {
+        stats->rateWindowStartUs = nowUs;
+    }
+    stats->rateWindowBytes += bytes;
+    uint64_t elapsed = nowUs - stats->rateWindowStartUs;
+    if (elapsed >= CAPTURE_STATS_RATE_WINDOW_US) {
+        uint32_t rate = (uint32_t)((uint64_t)stats->rateWindowBytes * 1000000 / elapsed);
+        atomic_store_explicit(&stats->bytesPerSec, rate, memory_order_relaxed);
+        stats->rateWindowStartUs = nowUs;
+        stats->rateWindowBytes = 0;
+    }
+}
@@ -0,0 +1,186 @@
+#ifndef CAPTURE_STATS_H
+#define CAPTURE_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// 采集链路的运行统计
+//
+// 每组计数器只有一个写入者（I2S回调、采集/处理任务或文件任务），均为32位原子变量，
+// 写入用relaxed原子操作，任意任务都可以无锁读取快照（各计数器分别一致，互相之间不保证同一时刻）。
+// 延迟直方图按log2分桶（单位微秒）：桶k统计[2^k, 2^(k+1))，桶0包含<2us，最后一个桶不设上限。
+//
+// 热路径函数为static inline，可以在ISR中使用；时间由调用者传入，不依赖ESP-IDF，可在主机上编译，
+// 配合DmaSimSource验证。
+
+#define CAPTURE_STATS_BUCKETS       20      // 最后一个桶: >= 2^19us (约0.5秒)
+#define CAPTURE_STATS_RATE_WINDOW_US 1000000
+
+typedef struct {
+    atomic_uint bucket[CAPTURE_STATS_BUCKETS];
+    atomic_uint maxUs;
+    atomic_uint lastUs;
+} CaptureLatencyHist;
+
+typedef struct {
+    // I2S回调写入
+    atomic_uint overruns;           // 驱动消息队列溢出（on_recv_q_ovf），即采集任务没有及时读取
+
+    // 采集任务（启用处理阶段时为处理任务）写入：块从读完到对文件任务可见
+    atomic_uint blocksCommitted;
+    CaptureLatencyHist commitLatency;
+
+    // 采集任务写入：内部环满时溢出到PSRAM的块
+    atomic_uint blocksSpilled;
+    atomic_uint spillHighWater;     // 溢出环中最多块数
+
+    // 采集任务写入：溢出后丢弃的块内已读数据（帧），使块内样本保持连续
+    atomic_uint discardedFrames;
+
+    // 采集任务写入：内部环满（下游跟不上）的次数，按当时持有多数块的阶段归因
+    atomic_uint backpressureProcess;
+    atomic_uint backpressurePersist;
+
+    // 处理任务写入（仅在启用处理阶段时）：块在处理队列中等待的时间、处理耗时和处理队列的最大深度
+    atomic_uint processHighWater;
+    atomic_uint flacFallbacks;      // FLAC编码失败、改写为VERBATIM帧的块
+    CaptureLatencyHist processWaitLatency;
+    CaptureLatencyHist processLatency;
+
+    // 文件任务写入
+    atomic_uint blocksWritten;
+    atomic_uint writeErrors;
+    atomic_uint corruptBlocks;      // 零拷贝：写出过程中被DMA覆盖、在索引中标记为损坏的块
+    atomic_uint ringHighWater;      // 文件任务看到的环中最多块数
+    atomic_uint bytesPerSec;        // 最近一个完整统计窗口的写卡速率
+    CaptureLatencyHist writeWaitLatency;    // 复制模式：块对文件任务可见到开始写出
+    CaptureLatencyHist writeLatency;
+    uint64_t rateWindowStartUs;     // 以下两项只由文件任务访问
+    uint32_t rateWindowBytes;
+} CaptureStats;
+
+// 快照：普通整数，便于打印和比较
+typedef struct {
+    uint32_t overruns;
+    uint32_t blocksCommitted;
+    uint32_t blocksSpilled;
+    uint32_t spillHighWater;
+    uint32_t discardedFrames;
+    uint32_t backpressureProcess;
+    uint32_t backpressurePersist;
+    uint32_t processHighWater;
+    uint32_t flacFallbacks;
+    uint32_t blocksWritten;
+    uint32_t writeErrors;
+    uint32_t corruptBlocks;
+    uint32_t ringHighWater;
+    uint32_t bytesPerSec;
+    uint32_t commitHist[CAPTURE_STATS_BUCKETS];
+    uint32_t commitMaxUs;
+    uint32_t commitLastUs;
+    uint32_t processWaitHist[CAPTURE_STATS_BUCKETS];
+    uint32_t processWaitMaxUs;
+    uint32_t processWaitLastUs;
+    uint32_t processHist[CAPTURE_STATS_BUCKETS];
+    uint32_t processMaxUs;
+    uint32_t processLastUs;
+    uint32_t writeWaitHist[CAPTURE_STATS_BUCKETS];
+    uint32_t writeWaitMaxUs;
+    uint32_t writeWaitLastUs;
+    uint32_t writeHist[CAPTURE_STATS_BUCKETS];
+    uint32_t writeMaxUs;
+    uint32_t writeLastUs;
+} CaptureStatsSnapshot;
+
+// 清零所有计数器（写入者运行时调用也安全，只是正在进行的更新可能丢失）
+void capture_stats_reset(CaptureStats *stats);
+// 读取快照（任意任务）
+void capture_stats_snapshot(const CaptureStats *stats, CaptureStatsSnapshot *out);
+// 直方图的百分位数（返回所在桶的上界，单位微秒），没有样本时返回0
+uint32_t capture_stats_percentile_us(const uint32_t *hist, uint32_t percent);
+
+// 延迟对应的桶号
+static inline uint32_t capture_stats_bucket(uint32_t us) {
+    uint32_t k = 31 - (uint32_t)__builtin_clz(us | 1);
+    return (k < CAPTURE_STATS_BUCKETS) ? k : CAPTURE_STATS_BUCKETS - 1;
+}
+
+// 记录一个延迟样本（每个直方图只有一个写入者，最大值可以直接load/store）
+static inline void capture_latency_record(CaptureLatencyHist *hist, uint32_t us) {
+    atomic_fetch_add_explicit(&hist->bucket[capture_stats_bucket(us)], 1, memory_order_relaxed);
+    atomic_store_explicit(&hist->lastUs, us, memory_order_relaxed);
+    if (us > atomic_load_explicit(&hist->maxUs, memory_order_relaxed)) {
+        atomic_store_explicit(&hist->maxUs, us, memory_order_relaxed);
+    }
+}
+
+// I2S回调: 驱动消息队列溢出
+static inline void capture_stats_overrun(CaptureStats *stats) {
+    atomic_fetch_add_explicit(&stats->overruns, 1, memory_order_relaxed);
+}
+
+// 采集/处理任务: 一个块对文件任务可见，latencyUs为从最后一次读取完成到提交的时间
+static inline void capture_stats_block_committed(CaptureStats *stats, uint32_t latencyUs) {
+    atomic_fetch_add_explicit(&stats->blocksCommitted, 1, memory_order_relaxed);
+    capture_latency_record(&stats->commitLatency, latencyUs);
+}
+
+// 采集任务: 一个块读入了PSRAM溢出环，depth为此时溢出环中的块数（含这一块）
+static inline void capture_stats_block_spilled(CaptureStats *stats, uint32_t depth) {
+    atomic_fetch_add_explicit(&stats->blocksSpilled, 1, memory_order_relaxed);
+    if (depth > atomic_load_explicit(&stats->spillHighWater, memory_order_relaxed)) {
+        atomic_store_explicit(&stats->spillHighWater, depth, memory_order_relaxed);
+    }
+}
+
+// 采集任务: 溢出后丢弃了当前块中已读的frames帧
+static inline void capture_stats_frames_discarded(CaptureStats *stats, uint32_t frames) {
+    atomic_fetch_add_explicit(&stats->discardedFrames, frames, memory_order_relaxed);
+}
+
+// 采集任务: 内部环满，toProcess为等待处理的块数，toPersist为等待写出的块数
+static inline void capture_stats_backpressure(CaptureStats *stats, uint32_t toProcess, uint32_t toPersist) {
+    atomic_fetch_add_explicit(toProcess > toPersist ? &stats->backpressureProcess : &stats->backpressurePersist, 1,
+                              memory_order_relaxed);
+}
+
+// 处理任务: 处理完一个块。waitUs为从读完到开始处理，depth为开始处理时等待处理的块数（含这一块）
+static inline void capture_stats_block_processed(CaptureStats *stats, uint32_t waitUs, uint32_t processUs,
+                                                 uint32_t depth) {
+    capture_latency_record(&stats->processWaitLatency, waitUs);
+    capture_latency_record(&stats->processLatency, processUs);
+    if (depth > atomic_load_explicit(&stats->processHighWater, memory_order_relaxed)) {
+        atomic_store_explicit(&stats->processHighWater, depth, memory_order_relaxed);
+    }
+}
+
+// 处理任务: 一个块的FLAC编码失败，退回为VERBATIM帧
+static inline void capture_stats_flac_fallback(CaptureStats *stats) {
+    atomic_fetch_add_explicit(&stats->flacFallbacks, 1, memory_order_relaxed);
+}
+
+// 文件任务: 一个块从对文件任务可见到开始写出的时间
+static inline void capture_stats_write_wait(CaptureStats *stats, uint32_t waitUs) {
+    capture_latency_record(&stats->writeWaitLatency, waitUs);
+}
+
+// 文件任务: 准备写出一个块时环中的块数
+static inline void capture_stats_ring_depth(CaptureStats *stats, uint32_t depth) {
+    if (depth > atomic_load_explicit(&stats->ringHighWater, memory_order_relaxed)) {
+        atomic_store_explicit(&stats->ringHighWater, depth, memory_order_relaxed);
+    }
+}
+
+// 文件任务: 写出的块在写出过程中被覆盖（仍计入blocksWritten）
+static inline void capture_stats_block_corrupt(CaptureStats *stats) {
+    atomic_fetch_add_explicit(&stats->corruptBlocks, 1, memory_order_relaxed);
+}
+
+// 文件任务: 重新开始写卡速率的统计窗口（开始新文件时调用，不把暂停的时间算进去）
+void capture_stats_restart_rate(CaptureStats *stats);
+// 文件任务: 写出一个块（bytes为写入的字节数，nowUs为写完的时间）
+void capture_stats_block_written(CaptureStats *stats, uint32_t bytes, uint32_t latencyUs, uint64_t nowUs,
+                                 bool ok);
+
+#endif /* CAPTURE_STATS_H */
@@ -0,0 +1,87 @@
+#include "ChannelCompact.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+// 按字访问int16缓冲区，避免严格别名优化出错
+typedef uint32_t __attribute__((may_alias)) word_t;
+
+// 掩码是否只包含完整的通道对
+static bool pair_aligned(uint32_t mask, uint32_t channels) {
+    if (channels & 1) {
+        return false;
+    }
+    for (uint32_t c = 0; c < channels; c += 2) {
+        if (((mask >> c) & 1) != ((mask >> (c + 1)) & 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t channel_compact_s16(const int16_t *in, int16_t *out, uint32_t channels, uint32_t mask,
+                             uint32_t frames) {
+    uint8_t keep[CHANNEL_COMPACT_MAX_CHANNELS];
+    uint32_t kept = 0;
+
+    if (channels > CHANNEL_COMPACT_MAX_CHANNELS) {
+        return 0;
+    }
+    for (uint32_t c = 0; c < channels; c++) {
+        if (mask & (1u << c)) {
+            keep[kept++] = (uint8_t)c;
+        }
+    }
+
+    if (pair_aligned(mask, channels) && ((uintptr_t)in & 3) == 0 && ((uintptr_t)out & 3) == 0) {
+        // 以字为单位：keep[]中每两个通道对应输入帧中的一个字
+        const word_t *src = (const word_t *)in;
+        word_t *dst = (word_t *)out;
+        uint32_t frameWords = channels / 2;
+        uint32_t keptWords = kept / 2;
+        uint8_t words[CHANNEL_COMPACT_MAX_CHANNELS / 2];
+        for (uint32_t k = 0; k < keptWords; k++) {
+            words[k] = keep[2 * k] / 2;
+        }
+
+        for (uint32_t f = 0; f < frames; f++, src += frameWords, dst += keptWords) {
+            for (uint32_t k = 0; k < keptWords; k++) {
+                dst[k] = src[words[k]];
+            }
+        }
+        return kept;
+    }
+
+    for (uint32_t f = 0; f < frames; f++, in += channels, out += kept) {
+        for (uint32_t k = 0; k < kept; k++) {
+            out[k] = in[keep[k]];
+        }
+    }
+    return kept;
+}
+
+uint32_t channel_compact_bytes(const uint8_t *in, uint8_t *out, uint32_t sampleBytes, uint32_t channels,
+                               uint32_t mask, uint32_t frames) {
+    uint8_t keep[CHANNEL_COMPACT_MAX_CHANNELS];
+    uint32_t kept = 0;
+
+    if (channels > CHANNEL_COMPACT_MAX_CHANNELS) {
+        return 0;
+    }
+    for (uint32_t c = 0; c < channels; c++) {
+        if (mask & (1u << c)) {
+            keep[kept++] = (uint8_t)c;
+        }
+    }
+
+    // 目标位置不超过源位置，按字节从前往后拷贝，原地压缩时也不会覆盖未读的数据
+    uint32_t frameBytes = channels * sampleBytes;
+    for (uint32_t f = 0; f < frames; f++, in += frameBytes) {
+        for (uint32_t k = 0; k < kept; k++) {
+            const uint8_t *src = in + keep[k] * sampleBytes;
+            for (uint32_t b = 0; b < sampleBytes; b++) {
+                *out++ = src[b];
+            }
+        }
+    }
+    return kept;
+}
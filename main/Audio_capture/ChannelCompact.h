@@ -0,0 +1,33 @@
+#ifndef CHANNEL_COMPACT_H
+#define CHANNEL_COMPACT_H
+
+#include <stdint.h>
+
+// 通道压缩内核：按通道掩码去掉不用的TDM槽位
+//
+// 输入为frames个交织帧（每帧channels个样本），输出只保留mask中置位的通道，
+// 仍然交织，顺序不变。输出不会超过输入的位置，因此out可以等于in（原地压缩）。
+//
+// 掩码按通道对（0/1、2/3…）整对选择且缓冲区4字节对齐时，每对按一个32位字拷贝；
+// 否则逐样本拷贝。其他样本宽度（24/32位）用channel_compact_bytes逐样本按字节拷贝。
+//
+// 不依赖ESP-IDF，可在主机上编译。
+
+#define CHANNEL_COMPACT_MAX_CHANNELS  16
+
+// 掩码中有效的通道数
+static inline uint32_t channel_mask_count(uint32_t mask, uint32_t channels) {
+    if (channels < 32) {
+        mask &= (1u << channels) - 1;
+    }
+    return (uint32_t)__builtin_popcount(mask);
+}
+
+// 压缩一段交织数据，返回每帧保留的通道数
+uint32_t channel_compact_s16(const int16_t *in, int16_t *out, uint32_t channels, uint32_t mask,
+                             uint32_t frames);
+// 任意样本宽度（sampleBytes字节）的同一操作
+uint32_t channel_compact_bytes(const uint8_t *in, uint8_t *out, uint32_t sampleBytes, uint32_t channels,
+                               uint32_t mask, uint32_t frames);
+
+#endif /* CHANNEL_COMPACT_H */
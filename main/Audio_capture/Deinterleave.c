@@ -0,0 +1,99 @@
+#include "Deinterleave.h"
+#include <stddef.h>
+
+// 按字访问int16缓冲区，避免严格别名优化出错
+typedef uint32_t __attribute__((may_alias)) word_t;
+
+static void deinterleave_s16_scalar(const int16_t *in, int16_t *out, uint32_t channels, uint32_t frames) {
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint32_t c = 0; c < channels; c++) {
+            out[c * frames + f] = in[f * channels + c];
+        }
+    }
+}
+
+// 8通道：每次处理两帧（8个字），每个平面写一个字
+static void deinterleave_s16_8ch(const word_t *src, word_t *dst, uint32_t planeWords) {
+    word_t *d0 = dst;
+    word_t *d1 = d0 + planeWords;
+    word_t *d2 = d1 + planeWords;
+    word_t *d3 = d2 + planeWords;
+    word_t *d4 = d3 + planeWords;
+    word_t *d5 = d4 + planeWords;
+    word_t *d6 = d5 + planeWords;
+    word_t *d7 = d6 + planeWords;
+
+    for (uint32_t i = 0; i < planeWords; i++, src += 8) {
+        // a: 第2i帧的4个字（每字两个通道），b: 第2i+1帧
+        uint32_t a0 = src[0], a1 = src[1], a2 = src[2], a3 = src[3];
+        uint32_t b0 = src[4], b1 = src[5], b2 = src[6], b3 = src[7];
+
+        // 小端：低16位是偶数通道，高16位是奇数通道；输出字的低16位是前一帧
+        d0[i] = (a0 & 0xFFFFu) | (b0 << 16);
+        d1[i] = (a0 >> 16) | (b0 & 0xFFFF0000u);
+        d2[i] = (a1 & 0xFFFFu) | (b1 << 16);
+        d3[i] = (a1 >> 16) | (b1 & 0xFFFF0000u);
+        d4[i] = (a2 & 0xFFFFu) | (b2 << 16);
+        d5[i] = (a2 >> 16) | (b2 & 0xFFFF0000u);
+        d6[i] = (a3 & 0xFFFFu) | (b3 << 16);
+        d7[i] = (a3 >> 16) | (b3 & 0xFFFF0000u);
+    }
+}
+
+void deinterleave_s16(const int16_t *in, int16_t *out, uint32_t channels, uint32_t frames) {
+    if ((channels & 1) || (frames & 1) || ((uintptr_t)in & 3) || ((uintptr_t)out & 3)) {
+        deinterleave_s16_scalar(in, out, channels, frames);
+        return;
+    }
+
+    const word_t *src = (const word_t *)in;
+    word_t *dst = (word_t *)out;
+    uint32_t frameWords = channels / 2;
+    uint32_t planeWords = frames / 2;
+
+    if (channels == 8) {
+        deinterleave_s16_8ch(src, dst, planeWords);
+        return;
+    }
+
+    // 任意偶数通道数：同样的字拼接，按通道对循环
+    for (uint32_t i = 0; i < planeWords; i++, src += 2 * frameWords) {
+        for (uint32_t k = 0; k < frameWords; k++) {
+            uint32_t a = src[k];
+            uint32_t b = src[frameWords + k];
+            dst[(2 * k) * planeWords + i] = (a & 0xFFFFu) | (b << 16);
+            dst[(2 * k + 1) * planeWords + i] = (a >> 16) | (b & 0xFFFF0000u);
+        }
+    }
+}
+
+void deinterleave_s32(const int32_t *in, int32_t *out, uint32_t channels, uint32_t frames) {
+    if (channels == 8) {
+        int32_t *d0 = out;
+        int32_t *d1 = d0 + frames;
+        int32_t *d2 = d1 + frames;
+        int32_t *d3 = d2 + frames;
+        int32_t *d4 = d3 + frames;
+        int32_t *d5 = d4 + frames;
+        int32_t *d6 = d5 + frames;
+        int32_t *d7 = d6 + frames;
+
+        for (uint32_t f = 0; f < frames; f++, in += 8) {
+            d0[f] = in[0];
+            d1[f] = in[1];
+            d2[f] = in[2];
+            d3[f] = in[3];
+            d4[f] = in[4];
+            d5[f] = in[5];
+            d6[f] = in[6];
+            d7[f] = in[7];
+        }
+        return;
+    }
+
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint32_t c = 0; c < channels; c++) {
+            out[c * frames + f] = in[f * channels + c];
+        }
+    }
+}
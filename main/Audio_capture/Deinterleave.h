@@ -0,0 +1,21 @@
+#ifndef DEINTERLEAVE_H
+#define DEINTERLEAVE_H
+
+#include <stdint.h>
+
+// 通道解交织（转置）内核
+//
+// 把frames个交织的采样帧（slot0..slotN-1为一帧）拆分为channels个平面，
+// 平面c从out + c * frames开始。输入和输出不能重叠。
+//
+// 16位样本按32位字处理：每次取相邻两帧中同一位置的字，用移位/掩码拼出
+// 两个通道各自的一对样本，整字写入平面，不逐样本读写。8通道有展开的专用路径。
+// 要求in/out按4字节对齐；通道数或帧数为奇数时退回逐样本循环。
+// 32位样本本身就是一个字，8通道同样展开。
+//
+// 不依赖ESP-IDF，可在主机上编译。
+
+void deinterleave_s16(const int16_t *in, int16_t *out, uint32_t channels, uint32_t frames);
+void deinterleave_s32(const int32_t *in, int32_t *out, uint32_t channels, uint32_t frames);
+
+#endif /* DEINTERLEAVE_H */
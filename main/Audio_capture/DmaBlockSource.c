@@ -0,0 +1,149 @@
+#include "DmaBlockSource.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 初始化组装器
+bool dma_block_assembler_init(DmaBlockAssembler *assembler, DmaBlock *blocks, uint32_t capacity,
+                              uint32_t framesPerBlock, uint32_t dmaDescNum) {
+    if (assembler == NULL || blocks == NULL || capacity == 0 ||
+        framesPerBlock == 0 || framesPerBlock > DMA_BLOCK_MAX_FRAMES) {
+        return false;
+    }
+    // 环中所有块加上正在组装的块都必须能同时留在DMA缓冲区中
+    if ((capacity + 1) * framesPerBlock >= dmaDescNum) {
+        return false;
+    }
+
+    memset(blocks, 0, sizeof(DmaBlock) * capacity);
+    block_ring_init(&assembler->ring, capacity);
+    assembler->blocks = blocks;
+    assembler->framesPerBlock = framesPerBlock;
+    assembler->dmaDescNum = dmaDescNum;
+    assembler->frameBytes = 0;
+    assembler->fill = 0;
+    assembler->assembling = false;
+    assembler->curSlot = 0;
+    atomic_store(&assembler->frameCounter, 0);
+    atomic_store(&assembler->droppedFrames, 0);
+    return true;
+}
+
+// 丢弃正在组装的半块
+void dma_block_assembler_abort_partial(DmaBlockAssembler *assembler) {
+    assembler->fill = 0;
+    assembler->assembling = false;
+}
+
+// 推入一个已完成的DMA帧
+bool dma_block_assembler_push(DmaBlockAssembler *assembler, const uint8_t *frame, size_t len) {
+    uint32_t index = atomic_fetch_add_explicit(&assembler->frameCounter, 1, memory_order_relaxed);
+
+    if (assembler->frameBytes == 0) {
+        assembler->frameBytes = len;
+    }
+    if (len != assembler->frameBytes) {
+        atomic_fetch_add_explicit(&assembler->droppedFrames, 1, memory_order_relaxed);
+        return false;
+    }
+
+    // 在块边界处申请新槽位；环满则丢弃该帧，下一帧再试
+    if (!assembler->assembling) {
+        if (!block_ring_acquire(&assembler->ring, &assembler->curSlot)) {
+            atomic_fetch_add_explicit(&assembler->droppedFrames, 1, memory_order_relaxed);
+            return false;
+        }
+        DmaBlock *block = &assembler->blocks[assembler->curSlot];
+        block->firstFrame = index;
+        block->frameBytes = len;
+        block->numFrames = 0;
+        assembler->assembling = true;
+        assembler->fill = 0;
+    }
+
+    DmaBlock *block = &assembler->blocks[assembler->curSlot];
+    block->frames[assembler->fill++] = frame;
+    block->numFrames = assembler->fill;
+
+    if (assembler->fill < assembler->framesPerBlock) {
+        return false;
+    }
+
+    assembler->assembling = false;
+    assembler->fill = 0;
+    block_ring_commit(&assembler->ring);
+    return true;
+}
+
+// 块中的帧是否可能已被DMA覆盖
+bool dma_block_assembler_is_stale(const DmaBlockAssembler *assembler, const DmaBlock *block) {
+    // 收到第n帧时DMA开始写第n+1帧，它复用的是第n+1-D帧的缓冲区
+    uint32_t received = atomic_load_explicit(&((DmaBlockAssembler *)assembler)->frameCounter,
+                                             memory_order_acquire);
+    return (uint32_t)(received - block->firstFrame) >= assembler->dmaDescNum;
+}
+
+// 模拟源的start实现
+static bool dma_sim_source_start(DmaFrameSource *src, dma_frame_cb_t cb, void *ctx) {
+    DmaSimSource *sim = (DmaSimSource *)src;
+    sim->cb = cb;
+    sim->cbCtx = ctx;
+    return true;
+}
+
+// 模拟源的stop实现
+static void dma_sim_source_stop(DmaFrameSource *src) {
+    DmaSimSource *sim = (DmaSimSource *)src;
+    sim->cb = NULL;
+    sim->cbCtx = NULL;
+}
+
+bool dma_sim_source_init(DmaSimSource *sim, uint32_t descNum, size_t frameBytes, uint32_t channels) {
+    if (sim == NULL || descNum == 0 || channels == 0 ||
+        frameBytes == 0 || frameBytes % (channels * sizeof(uint16_t)) != 0) {
+        return false;
+    }
+    memset(sim, 0, sizeof(*sim));
+    sim->dmaRing = malloc(descNum * frameBytes);
+    if (sim->dmaRing == NULL) {
+        return false;
+    }
+    sim->base.start = dma_sim_source_start;
+    sim->base.stop = dma_sim_source_stop;
+    sim->descNum = descNum;
+    sim->frameBytes = frameBytes;
+    sim->channels = channels;
+    return true;
+}
+
+void dma_sim_source_deinit(DmaSimSource *sim) {
+    free(sim->dmaRing);
+    sim->dmaRing = NULL;
+    sim->cb = NULL;
+}
+
+// 生成frames个DMA帧
+uint32_t dma_sim_source_run(DmaSimSource *sim, uint32_t frames) {
+    uint32_t completed = 0;
+    size_t samplesPerFrame = sim->frameBytes / (sim->channels * sizeof(uint16_t));
+
+    for (uint32_t f = 0; f < frames; f++) {
+        // 像DMA一样写入循环缓冲区中的下一个描述符
+        uint16_t *buf = (uint16_t *)(sim->dmaRing + (size_t)(sim->frameIndex % sim->descNum) * sim->frameBytes);
+        for (size_t s = 0; s < samplesPerFrame; s++) {
+            for (uint32_t ch = 0; ch < sim->channels; ch++) {
+                *buf++ = sim->sampleCounter;
+            }
+            sim->sampleCounter++;
+        }
+
+        const uint8_t *frame = sim->dmaRing + (size_t)(sim->frameIndex % sim->descNum) * sim->frameBytes;
+        sim->frameIndex++;
+        if (sim->cb != NULL) {
+            // 回调返回值表示“需要让出CPU”，在模拟中用来统计块完成次数
+            if (sim->cb(sim->cbCtx, frame, sim->frameBytes)) {
+                completed++;
+            }
+        }
+    }
+    return completed;
+}
@@ -0,0 +1,90 @@
+#ifndef DMA_BLOCK_SOURCE_H
+#define DMA_BLOCK_SOURCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "BlockRing.h"
+
+// 零拷贝采集：把I2S DMA完成的帧直接组装成块，文件任务原地写出DMA缓冲区，
+// 不再经过i2s_channel_read的中间拷贝。
+//
+// DMA缓冲区是驱动内部的循环描述符链，第f帧所在的缓冲区会在收到第f+D帧时
+// （D为描述符数量）被重新写入。因此块必须在DMA绕回之前被消费，
+// 消费者写完后用dma_block_assembler_is_stale()检查该块是否已被覆盖。
+//
+// 本模块不依赖ESP-IDF，可在主机上配合DmaSimSource编译和验证。
+
+#define DMA_BLOCK_MAX_FRAMES  16    // 每块最多包含的DMA帧数
+
+// 一个块：若干个DMA帧的指针（各帧内存不保证连续）
+typedef struct {
+    const uint8_t *frames[DMA_BLOCK_MAX_FRAMES];
+    uint32_t numFrames;
+    size_t frameBytes;
+    uint32_t firstFrame;    // 第一帧的全局帧序号
+} DmaBlock;
+
+// 帧到块的组装器：帧回调(ISR)为生产者，文件任务为消费者
+typedef struct {
+    BlockRing ring;
+    DmaBlock *blocks;           // 长度为ring.capacity的块数组
+    uint32_t framesPerBlock;
+    uint32_t dmaDescNum;        // DMA描述符数量，用于判断绕回
+    size_t frameBytes;          // 第一帧确定的帧大小，之后所有帧必须一致
+
+    // 以下仅由生产者修改
+    uint32_t fill;              // 当前块已组装的帧数
+    bool assembling;            // 当前是否持有一个未提交的槽位
+    uint32_t curSlot;
+
+    // 任意线程可读
+    atomic_uint frameCounter;   // 已收到的帧总数
+    atomic_uint droppedFrames;  // 因环满或帧大小不符而丢弃的帧数
+} DmaBlockAssembler;
+
+// 初始化组装器。blocks数组由调用者提供，长度为capacity。
+// 要求 (capacity + 1) * framesPerBlock < dmaDescNum，否则返回false。
+bool dma_block_assembler_init(DmaBlockAssembler *assembler, DmaBlock *blocks, uint32_t capacity,
+                              uint32_t framesPerBlock, uint32_t dmaDescNum);
+// 丢弃正在组装的半块（仅在帧回调已停止时调用）
+void dma_block_assembler_abort_partial(DmaBlockAssembler *assembler);
+// 生产者: 推入一个已完成的DMA帧。凑满一块并提交时返回true。
+bool dma_block_assembler_push(DmaBlockAssembler *assembler, const uint8_t *frame, size_t len);
+// 消费者: 块中的帧是否可能已被DMA覆盖（应在写出之后调用）
+bool dma_block_assembler_is_stale(const DmaBlockAssembler *assembler, const DmaBlock *block);
+// 块的有效字节数
+static inline size_t dma_block_bytes(const DmaBlock *block) {
+    return block->frameBytes * block->numFrames;
+}
+
+// 帧源接口：硬件实现注册I2S on_recv回调，模拟实现在主机上生成帧。
+// 回调返回true表示唤醒了更高优先级的任务（ISR中需要让出CPU）。
+typedef bool (*dma_frame_cb_t)(void *ctx, const uint8_t *frame, size_t len);
+
+typedef struct DmaFrameSource {
+    bool (*start)(struct DmaFrameSource *src, dma_frame_cb_t cb, void *ctx);
+    void (*stop)(struct DmaFrameSource *src);
+} DmaFrameSource;
+
+// 模拟DMA源：D个循环缓冲区，每帧按TDM交织写入16位递增样本计数，
+// 可用于验证块组装、丢帧和DMA绕回检测。
+typedef struct {
+    DmaFrameSource base;        // 必须是第一个成员
+    uint8_t *dmaRing;           // descNum * frameBytes
+    uint32_t descNum;
+    size_t frameBytes;
+    uint32_t channels;
+    uint32_t frameIndex;        // 下一帧序号
+    uint16_t sampleCounter;     // 下一个样本帧的计数值
+    dma_frame_cb_t cb;
+    void *cbCtx;
+} DmaSimSource;
+
+bool dma_sim_source_init(DmaSimSource *sim, uint32_t descNum, size_t frameBytes, uint32_t channels);
+void dma_sim_source_deinit(DmaSimSource *sim);
+// 生成frames个DMA帧并依次调用回调，返回回调报告块完成的次数
+uint32_t dma_sim_source_run(DmaSimSource *sim, uint32_t frames);
+
+#endif /* DMA_BLOCK_SOURCE_H */
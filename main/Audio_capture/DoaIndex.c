@@ -0,0 +1,84 @@
+#include "DoaIndex.h"
+#include <string.h>
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+void doa_index_build_header(uint8_t *out, const DoaIndexInfo *info) {
+    uint32_t pairs = (info->pairs > DOA_INDEX_MAX_PAIRS) ? DOA_INDEX_MAX_PAIRS : info->pairs;
+    memset(out, 0, DOA_INDEX_HEADER_BYTES);
+    memcpy(out, "DIDX", 4);
+    put_u16(out + 4, DOA_INDEX_VERSION);
+    put_u16(out + 6, DOA_INDEX_HEADER_BYTES);
+    put_u16(out + 8, DOA_INDEX_RECORD_BYTES);
+    put_u16(out + 10, (uint16_t)pairs);
+    put_u32(out + 12, info->sampleRate);
+    put_u32(out + 16, info->frameSize);
+    put_u32(out + 20, info->hopFrames);
+    put_u64(out + 24, info->startUs);
+    put_u32(out + 32, info->reportFrames);
+    put_u16(out + 36, info->minHz);
+    put_u16(out + 38, info->maxHz);
+    memcpy(out + 40, info->pair, pairs * 2);
+}
+
+bool doa_index_parse_header(const uint8_t *buf, size_t len, DoaIndexInfo *info) {
+    if (len < 40 || memcmp(buf, "DIDX", 4) != 0 || get_u16(buf + 4) != DOA_INDEX_VERSION ||
+        get_u16(buf + 6) != DOA_INDEX_HEADER_BYTES || get_u16(buf + 8) != DOA_INDEX_RECORD_BYTES) {
+        return false;
+    }
+
+    memset(info, 0, sizeof(*info));
+    info->pairs = get_u16(buf + 10);
+    info->sampleRate = get_u32(buf + 12);
+    info->frameSize = get_u32(buf + 16);
+    info->hopFrames = get_u32(buf + 20);
+    info->startUs = get_u64(buf + 24);
+    info->reportFrames = get_u32(buf + 32);
+    info->minHz = get_u16(buf + 36);
+    info->maxHz = get_u16(buf + 38);
+    if (info->pairs > DOA_INDEX_MAX_PAIRS || len < 40 + info->pairs * 2) {
+        return false;
+    }
+    memcpy(info->pair, buf + 40, info->pairs * 2);
+    return info->sampleRate > 0 && info->frameSize > 0 && info->hopFrames > 0;
+}
+
+void doa_index_encode(uint8_t *out, const DoaIndexRecord *record) {
+    put_u64(out, record->samplePos);
+    put_u16(out + 8, record->azimuth);
+    put_u16(out + 10, record->confidence);
+    put_u16(out + 12, record->windows);
+    put_u16(out + 14, 0);
+}
+
+void doa_index_decode(const uint8_t *buf, DoaIndexRecord *record) {
+    record->samplePos = get_u64(buf);
+    record->azimuth = get_u16(buf + 8);
+    record->confidence = get_u16(buf + 10);
+    record->windows = get_u16(buf + 12);
+}
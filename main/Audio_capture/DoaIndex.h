@@ -0,0 +1,70 @@
+#ifndef DOA_INDEX_H
+#define DOA_INDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 方位索引文件（.DOA）：启用声源方位估计时与录音文件同名，每个估计结果（每秒10..50个）一条定长记录
+//
+// samplePos是结果覆盖的帧的中点，与块索引的firstSample在同一样本时间轴上（开始录音后的第几帧，
+// 含溢出丢失的帧，文件轮转时延续）；换算为时间时以块索引中相邻块的captureUs为准，或近似为
+// startUs + (samplePos - 文件第一块的firstSample) / sampleRate。
+// 记录随处理完的块写入，轮转后新文件中的第一条记录可能有一部分帧属于上一个文件。
+//
+// 头部固定为DOA_INDEX_HEADER_BYTES(512)字节，之后是连续的记录（小端）：
+//   头部:
+//   0   "DIDX"
+//   4   version(u16) headerBytes(u16)
+//   8   recordBytes(u16) pairs(u16)
+//   12  sampleRate(u32)
+//   16  frameSize(u32)        分析帧长
+//   20  hopFrames(u32)        分析帧的间隔
+//   24  startUs(u64)          打开文件时的esp_timer时间
+//   32  reportFrames(u32)     每个结果覆盖的帧数
+//   36  minHz(u16) maxHz(u16) PHAT加权的频带
+//   40  pair[pairs][2](u8)    每个麦克风对的两个槽位
+//   之后保留，全0
+//   记录k（16字节）:
+//   0   samplePos(u64)
+//   8   azimuth(u16)          0.01°，0..35999：0为+x方向，逆时针转向+y
+//   10  confidence(u16)       0..65535对应0..1
+//   12  windows(u16)          合并的分析帧数
+//   14  保留(u16)
+//
+// 不依赖ESP-IDF，可在主机上编译。
+
+#define DOA_INDEX_HEADER_BYTES      512
+#define DOA_INDEX_RECORD_BYTES      16
+#define DOA_INDEX_VERSION           1
+#define DOA_INDEX_MAX_PAIRS         28
+
+typedef struct {
+    uint32_t sampleRate;
+    uint32_t frameSize;
+    uint32_t hopFrames;
+    uint32_t reportFrames;
+    uint16_t minHz;
+    uint16_t maxHz;
+    uint32_t pairs;
+    uint8_t pair[DOA_INDEX_MAX_PAIRS][2];
+    uint64_t startUs;
+} DoaIndexInfo;
+
+typedef struct {
+    uint64_t samplePos;
+    uint16_t azimuth;
+    uint16_t confidence;
+    uint16_t windows;
+} DoaIndexRecord;
+
+// 生成DOA_INDEX_HEADER_BYTES字节的头部
+void doa_index_build_header(uint8_t *out, const DoaIndexInfo *info);
+// 解析文件开头的头部
+bool doa_index_parse_header(const uint8_t *buf, size_t len, DoaIndexInfo *info);
+
+// 编码/解码一条DOA_INDEX_RECORD_BYTES字节的记录
+void doa_index_encode(uint8_t *out, const DoaIndexRecord *record);
+void doa_index_decode(const uint8_t *buf, DoaIndexRecord *record);
+
+#endif /* DOA_INDEX_H */
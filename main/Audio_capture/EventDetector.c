@@ -0,0 +1,140 @@
+#include "EventDetector.h"
+#include "DspBlock.h"
+#include <math.h>
+#include <string.h>
+
+#define VAD_WARMUP_BLOCKS   8
+#define VAD_FLOOR_RISE      0.01f   // 每块向上跟踪1%（约100块）
+#define VAD_FLOOR_FALL      0.5f
+#define VAD_MIN_ENERGY      1e-9f   // -90dBFS以下视为静音，不触发VAD
+
+static float db_to_power(float db) {
+    return powf(10.0f, db / 10.0f);
+}
+
+static float db_to_amplitude(float db) {
+    return powf(10.0f, db / 20.0f);
+}
+
+bool event_detector_init(EventDetector *d, const EventDetectorConfig *config, uint32_t channels,
+                         uint32_t sampleBytes, uint32_t mask) {
+    if (channels == 0 || channels > EVENT_DETECTOR_MAX_CHANNELS || sampleBytes < 2 || sampleBytes > 4) {
+        return false;
+    }
+    memset(d, 0, sizeof(*d));
+    d->channels = channels;
+    d->sampleBytes = sampleBytes;
+    d->mask = mask & ((1u << channels) - 1);
+    d->rmsSquare = (config->rmsDbfs < 0.0f) ? db_to_power(config->rmsDbfs) : 0.0f;
+    d->peak = (config->peakDbfs <= 0.0f) ? db_to_amplitude(config->peakDbfs) : 0.0f;
+    d->vadRatio = (config->vadMarginDb > 0.0f) ? db_to_power(config->vadMarginDb) : 0.0f;
+    event_detector_reset(d);
+    return d->mask != 0;
+}
+
+void event_detector_reset(EventDetector *d) {
+    d->noiseFloor = 0.0f;
+    d->warmup = VAD_WARMUP_BLOCKS;
+}
+
+void event_levels_s16x8(const int16_t *pcm, uint32_t frames, EventLevels *levels) {
+    // 平方和与峰值由DSP块内核计算（整数累加，ESP32-S3上峰值走PIE向量路径）
+    uint64_t sums[8];
+    uint16_t peak[8];
+    dsp_sum_squares_s16(pcm, 8, frames, sums);
+    dsp_peak_s16x8(pcm, frames, peak);
+
+    const float scale = 1.0f / (32768.0f * 32768.0f);
+    for (uint32_t c = 0; c < 8; c++) {
+        levels->meanSquare[c] = (frames > 0) ? (float)sums[c] * scale / (float)frames : 0.0f;
+        levels->peak[c] = (float)peak[c] / 32768.0f;
+    }
+}
+
+// 读取一个小端有符号样本，归一化到[-1, 1)
+static float load_sample(const uint8_t *p, uint32_t sampleBytes) {
+    switch (sampleBytes) {
+    case 2:
+        return (float)(int16_t)(p[0] | (p[1] << 8)) / 32768.0f;
+    case 3:
+        return (float)((int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24) >> 8) /
+               8388608.0f;
+    default:
+        return (float)(int32_t)((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+                                (uint32_t)p[3] << 24) / 2147483648.0f;
+    }
+}
+
+void event_levels_generic(const void *data, uint32_t sampleBytes, uint32_t channels, uint32_t frames,
+                          EventLevels *levels) {
+    const uint8_t *p = data;
+    memset(levels, 0, sizeof(*levels));
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint32_t c = 0; c < channels; c++, p += sampleBytes) {
+            float x = load_sample(p, sampleBytes);
+            float a = fabsf(x);
+            levels->meanSquare[c] += x * x;
+            if (a > levels->peak[c]) {
+                levels->peak[c] = a;
+            }
+        }
+    }
+    if (frames > 0) {
+        for (uint32_t c = 0; c < channels; c++) {
+            levels->meanSquare[c] /= (float)frames;
+        }
+    }
+}
+
+bool event_detector_process(EventDetector *d, const void *data, uint32_t frames, EventTrigger *trigger) {
+    EventLevels levels;
+    if (d->sampleBytes == 2 && d->channels == 8) {
+        event_levels_s16x8(data, frames, &levels);
+    } else {
+        event_levels_generic(data, d->sampleBytes, d->channels, frames, &levels);
+    }
+
+    uint32_t reasons = 0;
+    uint32_t loudest = 0;
+    float maxSquare = -1.0f;
+    float energy = 0.0f;
+    uint32_t used = 0;
+    for (uint32_t c = 0; c < d->channels; c++) {
+        if (!(d->mask & (1u << c))) {
+            continue;
+        }
+        float ms = levels.meanSquare[c];
+        if (d->rmsSquare > 0.0f && ms > d->rmsSquare) {
+            reasons |= EVENT_TRIGGER_RMS;
+        }
+        if (d->peak > 0.0f && levels.peak[c] >= d->peak) {
+            reasons |= EVENT_TRIGGER_PEAK;
+        }
+        if (ms > maxSquare) {
+            maxSquare = ms;
+            loudest = c;
+        }
+        energy += ms;
+        used++;
+    }
+    energy /= (float)used;
+
+    // 能量VAD：噪声底只在不含事件的块上更新，事件本身不会抬高噪声底
+    if (d->vadRatio > 0.0f) {
+        if (d->warmup > 0) {
+            d->noiseFloor = (d->warmup == VAD_WARMUP_BLOCKS || energy < d->noiseFloor) ? energy : d->noiseFloor;
+            d->warmup--;
+        } else if (energy > d->noiseFloor * d->vadRatio && energy > VAD_MIN_ENERGY) {
+            reasons |= EVENT_TRIGGER_VAD;
+        }
+        if (reasons == 0 && d->warmup == 0) {
+            float rate = (energy < d->noiseFloor) ? VAD_FLOOR_FALL : VAD_FLOOR_RISE;
+            d->noiseFloor += (energy - d->noiseFloor) * rate;
+        }
+    }
+
+    trigger->reasons = reasons;
+    trigger->channel = loudest;
+    trigger->levelDbfs = (maxSquare > 0.0f) ? 10.0f * log10f(maxSquare) : -200.0f;
+    return reasons != 0;
+}
@@ -0,0 +1,76 @@
+#ifndef EVENT_DETECTOR_H
+#define EVENT_DETECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 事件检测：逐块计算各通道的均方值和峰值，按电平阈值或能量VAD判断是否触发
+//
+// 8个槽位的16位块交给DSP块内核（DspBlock）计算平方和与峰值：lane就是槽位，内层循环次数固定，
+// ESP32-S3上峰值走PIE向量路径；其他通道数和样本宽度走逐样本的通用路径。
+// 结果按满量程归一化（1.0 = 0dBFS），与样本宽度无关。
+//
+// 触发条件（任一成立即触发，只看mask中的通道）：
+//  - 任一通道的块RMS超过rmsDbfs
+//  - 任一通道的块峰值超过peakDbfs
+//  - 能量VAD：各通道均方值的平均比噪声底高出vadMarginDb。噪声底在未触发的块上跟踪，
+//    下降快、上升慢（约2秒），开始的几块只用来建立噪声底
+//
+// 不依赖ESP-IDF，可在主机上编译（需要main/DSP）。
+
+#define EVENT_DETECTOR_MAX_CHANNELS  16
+#define EVENT_LEVEL_OFF              1.0f   // 高于0dBFS的阈值永远达不到，即不启用该条件
+
+// 触发原因（可以同时成立）
+#define EVENT_TRIGGER_RMS   (1u << 0)
+#define EVENT_TRIGGER_PEAK  (1u << 1)
+#define EVENT_TRIGGER_VAD   (1u << 2)
+
+typedef struct {
+    float rmsDbfs;          // 块RMS阈值（dBFS），EVENT_LEVEL_OFF不启用
+    float peakDbfs;         // 峰值阈值（dBFS），EVENT_LEVEL_OFF不启用
+    float vadMarginDb;      // 高出噪声底的分贝数，<= 0不启用
+} EventDetectorConfig;
+
+// 默认：RMS -30dBFS，峰值 -6dBFS，VAD高出噪声底12dB
+#define EVENT_DETECTOR_DEFAULT  { .rmsDbfs = -30.0f, .peakDbfs = -6.0f, .vadMarginDb = 12.0f }
+
+// 一个块中各通道的电平（满量程归一化）
+typedef struct {
+    float meanSquare[EVENT_DETECTOR_MAX_CHANNELS];
+    float peak[EVENT_DETECTOR_MAX_CHANNELS];
+} EventLevels;
+
+// 一次检测的结果
+typedef struct {
+    uint32_t reasons;       // EVENT_TRIGGER_*，0表示未触发
+    uint32_t channel;       // 电平最高的通道（槽位号）
+    float levelDbfs;        // 该通道的块RMS（dBFS）
+} EventTrigger;
+
+typedef struct {
+    uint32_t channels;      // 每帧样本数（TDM槽位数）
+    uint32_t sampleBytes;   // 2、3或4
+    uint32_t mask;          // 参与检测的通道
+    float rmsSquare;        // 阈值换算为均方值/峰值，0表示不启用
+    float peak;
+    float vadRatio;         // VAD的能量比，0表示不启用
+    float noiseFloor;       // 未触发块的平均均方值
+    uint32_t warmup;        // 剩余的噪声底建立块数
+} EventDetector;
+
+// 初始化检测器（channels不超过EVENT_DETECTOR_MAX_CHANNELS，sampleBytes为2、3或4）
+bool event_detector_init(EventDetector *detector, const EventDetectorConfig *config, uint32_t channels,
+                         uint32_t sampleBytes, uint32_t mask);
+// 清除噪声底（开始新的录音时调用）
+void event_detector_reset(EventDetector *detector);
+// 检测一个交织块，返回是否触发
+bool event_detector_process(EventDetector *detector, const void *data, uint32_t frames, EventTrigger *trigger);
+
+// 电平内核：8路交织int16（固定lane数的快速路径）
+void event_levels_s16x8(const int16_t *pcm, uint32_t frames, EventLevels *levels);
+// 电平内核：任意通道数和样本宽度（逐样本）
+void event_levels_generic(const void *data, uint32_t sampleBytes, uint32_t channels, uint32_t frames,
+                          EventLevels *levels);
+
+#endif /* EVENT_DETECTOR_H */
@@ -0,0 +1,86 @@
+#include "EventIndex.h"
+#include <string.h>
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+void event_index_build_header(uint8_t *out, const EventIndexInfo *info) {
+    memset(out, 0, EVENT_INDEX_HEADER_BYTES);
+    memcpy(out, "EIDX", 4);
+    put_u16(out + 4, EVENT_INDEX_VERSION);
+    put_u16(out + 6, EVENT_INDEX_HEADER_BYTES);
+    put_u16(out + 8, EVENT_INDEX_RECORD_BYTES);
+    put_u16(out + 10, info->channels);
+    put_u32(out + 12, info->sampleRate);
+    put_u32(out + 16, info->preRollMs);
+    put_u32(out + 20, info->postRollMs);
+    put_u16(out + 24, (uint16_t)info->rmsCentiDb);
+    put_u16(out + 26, (uint16_t)info->peakCentiDb);
+    put_u16(out + 28, (uint16_t)info->vadCentiDb);
+    put_u64(out + 32, info->startUs);
+}
+
+bool event_index_parse_header(const uint8_t *buf, size_t len, EventIndexInfo *info) {
+    if (len < 40 || memcmp(buf, "EIDX", 4) != 0 || get_u16(buf + 4) != EVENT_INDEX_VERSION ||
+        get_u16(buf + 6) != EVENT_INDEX_HEADER_BYTES || get_u16(buf + 8) != EVENT_INDEX_RECORD_BYTES) {
+        return false;
+    }
+
+    info->channels = get_u16(buf + 10);
+    info->sampleRate = get_u32(buf + 12);
+    info->preRollMs = get_u32(buf + 16);
+    info->postRollMs = get_u32(buf + 20);
+    info->rmsCentiDb = (int16_t)get_u16(buf + 24);
+    info->peakCentiDb = (int16_t)get_u16(buf + 26);
+    info->vadCentiDb = (int16_t)get_u16(buf + 28);
+    info->startUs = get_u64(buf + 32);
+    return info->sampleRate > 0 && info->channels > 0;
+}
+
+void event_index_encode(uint8_t *out, const EventIndexRecord *record) {
+    put_u32(out, record->seq);
+    out[4] = record->reasons;
+    out[5] = record->channel;
+    put_u16(out + 6, (uint16_t)record->levelCentiDb);
+    put_u64(out + 8, record->startSample);
+    put_u64(out + 16, record->triggerSample);
+    put_u64(out + 24, record->endSample);
+    put_u64(out + 32, record->offset);
+    put_u64(out + 40, record->triggerUs);
+}
+
+void event_index_decode(const uint8_t *buf, EventIndexRecord *record) {
+    record->seq = get_u32(buf);
+    record->reasons = buf[4];
+    record->channel = buf[5];
+    record->levelCentiDb = (int16_t)get_u16(buf + 6);
+    record->startSample = get_u64(buf + 8);
+    record->triggerSample = get_u64(buf + 16);
+    record->endSample = get_u64(buf + 24);
+    record->offset = get_u64(buf + 32);
+    record->triggerUs = get_u64(buf + 40);
+}
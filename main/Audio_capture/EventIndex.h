@@ -0,0 +1,79 @@
+#ifndef EVENT_INDEX_H
+#define EVENT_INDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 事件索引文件（.EVT）：事件录音模式下与录音文件同名，每个事件一条定长记录
+//
+// 事件模式只把事件（含预录和后录）写入录音文件，事件之间的样本不写出；
+// 样本序号沿用块索引的时间轴（开始录音后的第几帧），事件之间的跳过在块索引中表现为缺口。
+// 事件结束（后录期满或停止录音）时由文件任务追加记录。
+// 文件轮转时跨越边界的事件拆成两条记录：前一个文件中的记录在边界结束，后一个文件中的记录
+// 从第一块开始并带EVENT_INDEX_CONTINUED，触发信息与前一条相同。
+//
+// 头部固定为EVENT_INDEX_HEADER_BYTES(512)字节，之后是连续的记录（小端）：
+//   头部:
+//   0   "EIDX"
+//   4   version(u16) headerBytes(u16)
+//   8   recordBytes(u16) channels(u16)
+//   12  sampleRate(u32)
+//   16  preRollMs(u32)
+//   20  postRollMs(u32)
+//   24  rmsDbfs(i16) peakDbfs(i16) vadMarginDb(i16)   单位0.01dB，0x7FFF表示未启用
+//   30  保留(u16)
+//   32  startUs(u64)          打开文件时的esp_timer时间
+//   40  保留，全0
+//   记录k（48字节）:
+//   0   seq(u32)              事件序号，从0连续递增
+//   4   reasons(u8)           EVENT_TRIGGER_*，另加EVENT_INDEX_CONTINUED
+//   5   channel(u8)           触发时电平最高的通道（槽位号）
+//   6   levelCentiDb(i16)     该通道触发块的RMS，单位0.01dBFS
+//   8   startSample(u64)      事件第一帧（预录开始）的样本序号
+//   16  triggerSample(u64)    触发块第一帧的样本序号
+//   24  endSample(u64)        事件结束后的第一帧（不含）
+//   32  offset(u64)           事件在录音文件中的起始偏移
+//   40  triggerUs(u64)        触发块读完的esp_timer时间
+//
+// 不依赖ESP-IDF，可在主机上编译。
+
+#define EVENT_INDEX_HEADER_BYTES    512
+#define EVENT_INDEX_RECORD_BYTES    48
+#define EVENT_INDEX_VERSION         1
+#define EVENT_INDEX_LEVEL_OFF       INT16_MAX
+#define EVENT_INDEX_CONTINUED       (1u << 7)   // reasons: 事件从上一个文件继续（文件轮转）
+
+typedef struct {
+    uint32_t sampleRate;
+    uint16_t channels;          // 录音文件中的通道数
+    uint32_t preRollMs;
+    uint32_t postRollMs;
+    int16_t rmsCentiDb;         // 触发阈值，EVENT_INDEX_LEVEL_OFF表示未启用
+    int16_t peakCentiDb;
+    int16_t vadCentiDb;
+    uint64_t startUs;
+} EventIndexInfo;
+
+typedef struct {
+    uint32_t seq;
+    uint8_t reasons;
+    uint8_t channel;
+    int16_t levelCentiDb;
+    uint64_t startSample;
+    uint64_t triggerSample;
+    uint64_t endSample;
+    uint64_t offset;
+    uint64_t triggerUs;
+} EventIndexRecord;
+
+// 生成EVENT_INDEX_HEADER_BYTES字节的头部
+void event_index_build_header(uint8_t *out, const EventIndexInfo *info);
+// 解析文件开头的头部
+bool event_index_parse_header(const uint8_t *buf, size_t len, EventIndexInfo *info);
+
+// 编码/解码一条EVENT_INDEX_RECORD_BYTES字节的记录
+void event_index_encode(uint8_t *out, const EventIndexRecord *record);
+void event_index_decode(const uint8_t *buf, EventIndexRecord *record);
+
+#endif /* EVENT_INDEX_H */
@@ -0,0 +1,118 @@
+#include "FeatureIndex.h"
+#include <math.h>
+#include <string.h>
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+// dB按0.5dB取整并限制在编码范围内
+static uint8_t db_code(float db) {
+    float code = 2.0f * (db - FEATURE_INDEX_FLOOR_DB);
+    return (code <= 0.0f || isnan(code)) ? 0 : (code >= 255.0f) ? 255 : (uint8_t)lroundf(code);
+}
+
+uint8_t feature_index_amplitude_code(float amplitude) {
+    return (amplitude > 0.0f) ? db_code(20.0f * log10f(amplitude)) : 0;
+}
+
+uint8_t feature_index_power_code(float power) {
+    return (power > 0.0f) ? db_code(10.0f * log10f(power)) : 0;
+}
+
+float feature_index_code_db(uint8_t code) {
+    return FEATURE_INDEX_FLOOR_DB + code * 0.5f;
+}
+
+void feature_index_build_header(uint8_t *out, const FeatureIndexInfo *info) {
+    uint32_t channels = (info->channels > FEATURE_INDEX_MAX_CHANNELS) ? FEATURE_INDEX_MAX_CHANNELS : info->channels;
+    uint32_t bands = (info->bands > FEATURE_INDEX_MAX_BANDS) ? FEATURE_INDEX_MAX_BANDS : info->bands;
+    memset(out, 0, FEATURE_INDEX_HEADER_BYTES);
+    memcpy(out, "FIDX", 4);
+    put_u16(out + 4, FEATURE_INDEX_VERSION);
+    put_u16(out + 6, FEATURE_INDEX_HEADER_BYTES);
+    put_u16(out + 8, (uint16_t)FEATURE_INDEX_RECORD_BYTES(channels, bands));
+    put_u16(out + 10, (uint16_t)channels);
+    put_u32(out + 12, info->sampleRate);
+    put_u32(out + 16, info->reportFrames);
+    put_u32(out + 20, info->frameSize);
+    put_u64(out + 24, info->startUs);
+    put_u16(out + 32, (uint16_t)bands);
+    put_u32(out + 36, info->channelMask);
+    for (uint32_t b = 0; b <= bands; b++) {
+        put_u16(out + 40 + 2 * b, info->bandEdgeHz[b]);
+    }
+}
+
+bool feature_index_parse_header(const uint8_t *buf, size_t len, FeatureIndexInfo *info) {
+    if (len < 40 || memcmp(buf, "FIDX", 4) != 0 || get_u16(buf + 4) != FEATURE_INDEX_VERSION ||
+        get_u16(buf + 6) != FEATURE_INDEX_HEADER_BYTES) {
+        return false;
+    }
+
+    memset(info, 0, sizeof(*info));
+    info->channels = get_u16(buf + 10);
+    info->sampleRate = get_u32(buf + 12);
+    info->reportFrames = get_u32(buf + 16);
+    info->frameSize = get_u32(buf + 20);
+    info->startUs = get_u64(buf + 24);
+    info->bands = get_u16(buf + 32);
+    info->channelMask = get_u32(buf + 36);
+    if (info->channels == 0 || info->channels > FEATURE_INDEX_MAX_CHANNELS || info->bands > FEATURE_INDEX_MAX_BANDS ||
+        get_u16(buf + 8) != FEATURE_INDEX_RECORD_BYTES(info->channels, info->bands) ||
+        len < 40 + 2 * (info->bands + 1)) {
+        return false;
+    }
+    for (uint32_t b = 0; b <= info->bands; b++) {
+        info->bandEdgeHz[b] = get_u16(buf + 40 + 2 * b);
+    }
+    return info->sampleRate > 0 && info->reportFrames > 0;
+}
+
+void feature_index_encode(uint8_t *out, const FeatureIndexRecord *record, uint32_t channels, uint32_t bands) {
+    put_u64(out, record->samplePos);
+    put_u16(out + 8, record->windows);
+    put_u16(out + 10, 0);
+    uint8_t *p = out + 12;
+    for (uint32_t ch = 0; ch < channels; ch++, p += FEATURE_INDEX_CHANNEL_BYTES(bands)) {
+        p[0] = record->rms[ch];
+        p[1] = record->peak[ch];
+        put_u16(p + 2, record->zcrHz[ch]);
+        memcpy(p + 4, record->band[ch], bands);
+    }
+}
+
+void feature_index_decode(const uint8_t *buf, FeatureIndexRecord *record, uint32_t channels, uint32_t bands) {
+    record->samplePos = get_u64(buf);
+    record->windows = get_u16(buf + 8);
+    const uint8_t *p = buf + 12;
+    for (uint32_t ch = 0; ch < channels; ch++, p += FEATURE_INDEX_CHANNEL_BYTES(bands)) {
+        record->rms[ch] = p[0];
+        record->peak[ch] = p[1];
+        record->zcrHz[ch] = get_u16(p + 2);
+        memcpy(record->band[ch], p + 4, bands);
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef FEATURE_INDEX_H
+#define FEATURE_INDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 特征索引文件（.FEA）：启用声学特征时与录音文件同名，每reportFrames帧（默认100ms）一条记录，
+// 每个录制的通道一组RMS、峰值、过零率和频带能量，用于不读回录音就能按电平/频谱查找片段
+//
+// samplePos是记录覆盖的第一帧，与块索引的firstSample在同一样本时间轴上（开始录音后的第几帧，
+// 含溢出丢失的帧，文件轮转时延续），用块索引即可换算为录音文件中的字节位置。
+// 记录随处理完的块写入，轮转后新文件中的第一条记录可能有一部分帧属于上一个文件。
+//
+// 电平按0.5dB量化为一个字节：code = 2 x (dBFS + 127.5)，0..255对应-127.5..0dBFS（0也表示更低），
+// RMS和频带能量为均方值的dB（满量程正弦波的RMS为-3dBFS），峰值为峰值绝对值的dB。
+//
+// 头部固定为FEATURE_INDEX_HEADER_BYTES(512)字节，之后是连续的定长记录（小端）：
+//   头部:
+//   0   "FIDX"
+//   4   version(u16) headerBytes(u16)
+//   8   recordBytes(u16) channels(u16)
+//   12  sampleRate(u32)
+//   16  reportFrames(u32)     每条记录覆盖的帧数
+//   20  frameSize(u32)        频带能量的FFT长度
+//   24  startUs(u64)          打开文件时的esp_timer时间
+//   32  bands(u16) 保留(u16)
+//   36  channelMask(u32)      记录中的通道依次为这些槽位
+//   40  bandEdgeHz[bands + 1](u16)   频带b为[edge[b], edge[b + 1])
+//   之后保留，全0
+//   记录（FEATURE_INDEX_RECORD_BYTES(channels, bands)字节）:
+//   0   samplePos(u64)
+//   8   windows(u16)          参与频带能量平均的FFT窗口数
+//   10  保留(u16)
+//   12  每个通道 FEATURE_INDEX_CHANNEL_BYTES(bands) 字节:
+//       0 rms(u8) 1 peak(u8) 2 zcrHz(u16) 4 band[bands](u8)
+//
+// 不依赖ESP-IDF，可在主机上编译。
+
+#define FEATURE_INDEX_HEADER_BYTES      512
+#define FEATURE_INDEX_VERSION           1
+#define FEATURE_INDEX_MAX_CHANNELS      16
+#define FEATURE_INDEX_MAX_BANDS         32
+#define FEATURE_INDEX_FLOOR_DB          (-127.5f)
+#define FEATURE_INDEX_CHANNEL_BYTES(bands)          (4 + (bands))
+#define FEATURE_INDEX_RECORD_BYTES(channels, bands) (12 + (channels) * FEATURE_INDEX_CHANNEL_BYTES(bands))
+
+typedef struct {
+    uint32_t sampleRate;
+    uint32_t reportFrames;
+    uint32_t frameSize;
+    uint32_t channels;
+    uint32_t channelMask;
+    uint32_t bands;
+    uint16_t bandEdgeHz[FEATURE_INDEX_MAX_BANDS + 1];
+    uint64_t startUs;
+} FeatureIndexInfo;
+
+typedef struct {
+    uint64_t samplePos;
+    uint16_t windows;
+    uint8_t rms[FEATURE_INDEX_MAX_CHANNELS];
+    uint8_t peak[FEATURE_INDEX_MAX_CHANNELS];
+    uint16_t zcrHz[FEATURE_INDEX_MAX_CHANNELS];
+    uint8_t band[FEATURE_INDEX_MAX_CHANNELS][FEATURE_INDEX_MAX_BANDS];
+} FeatureIndexRecord;
+
+// 电平（线性幅度）与字节编码的换算；power为均方值
+uint8_t feature_index_amplitude_code(float amplitude);
+uint8_t feature_index_power_code(float power);
+float feature_index_code_db(uint8_t code);
+
+// 生成FEATURE_INDEX_HEADER_BYTES字节的头部
+void feature_index_build_header(uint8_t *out, const FeatureIndexInfo *info);
+// 解析文件开头的头部
+bool feature_index_parse_header(const uint8_t *buf, size_t len, FeatureIndexInfo *info);
+
+// 编码/解码一条FEATURE_INDEX_RECORD_BYTES(channels, bands)字节的记录
+void feature_index_encode(uint8_t *out, const FeatureIndexRecord *record, uint32_t channels, uint32_t bands);
+void feature_index_decode(const uint8_t *buf, FeatureIndexRecord *record, uint32_t channels, uint32_t bands);
+
+#endif /* FEATURE_INDEX_H */
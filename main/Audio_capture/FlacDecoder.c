@@ -0,0 +1,380 @@
+#include "FlacDecoder.h"
+#include <string.h>
+
+#define FLAC_STREAMINFO_BYTES   34
+#define FLAC_MAX_LPC_ORDER      32
+
+// 大端位读取器：读过末尾时补0，由br_overrun判断
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;         // 下一个装入缓存的字节
+    uint64_t cache;     // 左对齐的未读位
+    uint32_t bits;
+} BitReader;
+
+static inline void br_fill(BitReader *br) {
+    while (br->bits <= 56) {
+        uint64_t byte = (br->pos < br->len) ? br->buf[br->pos] : 0;
+        br->pos++;
+        br->cache |= byte << (56 - br->bits);
+        br->bits += 8;
+    }
+}
+
+// 读n位（0~32）无符号数
+static inline uint32_t br_get(BitReader *br, uint32_t n) {
+    if (n == 0) {
+        return 0;
+    }
+    br_fill(br);
+    uint32_t v = (uint32_t)(br->cache >> (64 - n));
+    br->cache <<= n;
+    br->bits -= n;
+    return v;
+}
+
+// 读n位（0~32）补码有符号数
+static inline int32_t br_get_signed(BitReader *br, uint32_t n) {
+    if (n == 0) {
+        return 0;
+    }
+    uint32_t v = br_get(br, n);
+    return (n == 32) ? (int32_t)v : (int32_t)(v << (32 - n)) >> (32 - n);
+}
+
+// 已读的位数
+static inline uint64_t br_consumed(const BitReader *br) {
+    return (uint64_t)br->pos * 8 - br->bits;
+}
+
+static inline bool br_overrun(const BitReader *br) {
+    return br_consumed(br) > (uint64_t)br->len * 8;
+}
+
+// 一元码：1之前0的个数（读过末尾时停止，由br_overrun报告）
+static inline uint32_t br_get_unary(BitReader *br) {
+    uint32_t q = 0;
+    for (;;) {
+        br_fill(br);
+        if (br->cache != 0) {
+            uint32_t z = (uint32_t)__builtin_clzll(br->cache);
+            br->cache <<= z;
+            br->cache <<= 1;
+            br->bits -= z + 1;
+            return q + z;
+        }
+        q += br->bits;
+        br->cache = 0;
+        br->bits = 0;
+        if (br->pos > br->len + 8) {
+            return q;
+        }
+    }
+}
+
+static inline void br_align(BitReader *br) {
+    uint32_t n = (uint32_t)(br_consumed(br) % 8);
+    if (n != 0) {
+        br_get(br, 8 - n);
+    }
+}
+
+// CRC-8 (多项式0x07)，帧头
+static uint8_t crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// CRC-16 (多项式0x8005)，整帧
+static uint16_t crc16Table[256];
+
+static uint16_t crc16(const uint8_t *data, size_t len) {
+    if (crc16Table[1] == 0) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint16_t crc = (uint16_t)(i << 8);
+            for (int b = 0; b < 8; b++) {
+                crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x8005) : (uint16_t)(crc << 1);
+            }
+            crc16Table[i] = crc;
+        }
+    }
+    uint16_t crc = 0;
+    while (len--) {
+        crc = (uint16_t)((crc << 8) ^ crc16Table[(crc >> 8) ^ *data++]);
+    }
+    return crc;
+}
+
+bool flac_parse_stream_header(const uint8_t *buf, size_t len, FlacStreamHeader *header) {
+    if (len < 8 + FLAC_STREAMINFO_BYTES || memcmp(buf, "fLaC", 4) != 0) {
+        return false;
+    }
+    memset(header, 0, sizeof(*header));
+
+    // 元数据块：last(1) type(7) length(24)，第一个必须是STREAMINFO
+    size_t pos = 4;
+    bool last = false;
+    for (uint32_t n = 0; !last; n++) {
+        if (pos + 4 > len) {
+            return false;
+        }
+        last = (buf[pos] & 0x80) != 0;
+        uint32_t type = buf[pos] & 0x7F;
+        size_t blockLen = ((size_t)buf[pos + 1] << 16) | ((size_t)buf[pos + 2] << 8) | buf[pos + 3];
+        pos += 4;
+        if (pos + blockLen > len || (n == 0) != (type == 0)) {
+            return false;
+        }
+        if (type == 0) {
+            if (blockLen != FLAC_STREAMINFO_BYTES) {
+                return false;
+            }
+            BitReader br = { .buf = buf + pos, .len = blockLen };
+            header->minBlockSize = br_get(&br, 16);
+            header->maxBlockSize = br_get(&br, 16);
+            header->stream.minFrameBytes = br_get(&br, 24);
+            header->stream.maxFrameBytes = br_get(&br, 24);
+            header->sampleRate = br_get(&br, 20);
+            header->channels = br_get(&br, 3) + 1;
+            header->bitsPerSample = br_get(&br, 5) + 1;
+            header->stream.totalSamples = ((uint64_t)br_get(&br, 4) << 32) | br_get(&br, 32);
+        }
+        pos += blockLen;
+    }
+    header->audioOffset = pos;
+    return header->maxBlockSize >= FLAC_MIN_BLOCK_SIZE && header->minBlockSize <= header->maxBlockSize &&
+           header->sampleRate != 0;
+}
+
+// 帧头中UTF-8编码的帧序号（最多7字节、36位）
+static bool read_utf8(BitReader *br, uint64_t *value) {
+    uint32_t first = br_get(br, 8);
+    uint32_t ones = 0;
+    while (ones < 8 && (first & (0x80u >> ones))) {
+        ones++;
+    }
+    if (ones == 0) {
+        *value = first;
+        return true;
+    }
+    if (ones == 1 || ones > 7) {
+        return false;
+    }
+    uint64_t v = first & (0x7Fu >> ones);
+    for (uint32_t i = 1; i < ones; i++) {
+        uint32_t b = br_get(br, 8);
+        if ((b & 0xC0) != 0x80) {
+            return false;
+        }
+        v = (v << 6) | (b & 0x3F);
+    }
+    *value = v;
+    return true;
+}
+
+static uint32_t block_size_from_code(BitReader *br, uint32_t code) {
+    if (code == 1) {
+        return 192;
+    } else if (code >= 2 && code <= 5) {
+        return 576u << (code - 2);
+    } else if (code == 6) {
+        return br_get(br, 8) + 1;
+    } else if (code == 7) {
+        return br_get(br, 16) + 1;
+    } else if (code >= 8) {
+        return 256u << (code - 8);
+    }
+    return 0;
+}
+
+static uint32_t sample_rate_from_code(BitReader *br, uint32_t code, uint32_t streamRate) {
+    static const uint32_t rates[] = { 0, 88200, 176400, 192000, 8000, 16000, 22050, 24000, 32000, 44100, 48000,
+                                      96000 };
+    if (code == 0) {
+        return streamRate;
+    } else if (code < 12) {
+        return rates[code];
+    } else if (code == 12) {
+        return br_get(br, 8) * 1000;
+    } else if (code == 13) {
+        return br_get(br, 16);
+    } else if (code == 14) {
+        return br_get(br, 16) * 10;
+    }
+    return 0;
+}
+
+static uint32_t sample_size_from_code(uint32_t code, uint32_t streamBits) {
+    static const uint32_t sizes[] = { 0, 8, 12, 0, 16, 20, 24, 32 };
+    return (code == 0) ? streamBits : sizes[code];
+}
+
+// 读残差并按预测系数逐个还原样本（x为交织输出中的一个通道，步长stride）。
+// 固定预测也用系数表示，shift为0
+static bool decode_residual(BitReader *br, int16_t *x, uint32_t stride, uint32_t samples, uint32_t order,
+                            const int32_t *coefs, uint32_t shift, uint32_t bits) {
+    uint32_t method = br_get(br, 2);
+    if (method > 1) {
+        return false;
+    }
+    uint32_t paramBits = (method == 0) ? 4 : 5;
+    uint32_t escape = (1u << paramBits) - 1;
+    uint32_t partOrder = br_get(br, 4);
+    uint32_t partLen = samples >> partOrder;
+    if ((partLen << partOrder) != samples || partLen < order) {
+        return false;
+    }
+
+    int32_t lo = -(1 << (bits - 1)), hi = (1 << (bits - 1)) - 1;
+    uint32_t i = order;
+    for (uint32_t p = 0; p < (1u << partOrder); p++) {
+        uint32_t end = (p + 1) * partLen;
+        uint32_t k = br_get(br, paramBits);
+        uint32_t rawBits = (k == escape) ? br_get(br, 5) : 0;
+        for (; i < end; i++) {
+            int32_t residual;
+            if (k == escape) {
+                residual = br_get_signed(br, rawBits);
+            } else {
+                uint32_t u = (br_get_unary(br) << k) | br_get(br, k);
+                residual = (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+            }
+            int64_t prediction = 0;
+            for (uint32_t j = 0; j < order; j++) {
+                prediction += (int64_t)coefs[j] * x[(size_t)(i - 1 - j) * stride];
+            }
+            int64_t value = residual + (prediction >> shift);
+            if (value < lo || value > hi) {
+                return false;
+            }
+            x[(size_t)i * stride] = (int16_t)value;
+        }
+        if (br_overrun(br)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 解码一个通道的子帧
+static bool decode_subframe(BitReader *br, int16_t *x, uint32_t stride, uint32_t samples, uint32_t bitsPerSample,
+                            FlacFrameInfo *frame) {
+    static const int32_t fixedCoefs[FLAC_MAX_FIXED_ORDER + 1][FLAC_MAX_FIXED_ORDER] = {
+        { 0 }, { 1 }, { 2, -1 }, { 3, -3, 1 }, { 4, -6, 4, -1 },
+    };
+    if (br_get(br, 1) != 0) {
+        return false;
+    }
+    uint32_t type = br_get(br, 6);
+    uint32_t wasted = br_get(br, 1) ? br_get_unary(br) + 1 : 0;
+    if (wasted >= bitsPerSample) {
+        return false;
+    }
+    uint32_t bits = bitsPerSample - wasted;
+
+    if (type == 0) {
+        int16_t v = (int16_t)br_get_signed(br, bits);
+        for (uint32_t i = 0; i < samples; i++) {
+            x[(size_t)i * stride] = v;
+        }
+        frame->subframes[0]++;
+    } else if (type == 1) {
+        for (uint32_t i = 0; i < samples; i++) {
+            x[(size_t)i * stride] = (int16_t)br_get_signed(br, bits);
+        }
+        frame->subframes[1]++;
+    } else if ((type & 0x38) == 0x08 || (type & 0x20) != 0) {
+        bool lpc = (type & 0x20) != 0;
+        uint32_t order = lpc ? (type & 0x1F) + 1 : (type & 0x07);
+        if ((!lpc && order > FLAC_MAX_FIXED_ORDER) || order > samples) {
+            return false;
+        }
+        for (uint32_t i = 0; i < order; i++) {
+            x[(size_t)i * stride] = (int16_t)br_get_signed(br, bits);
+        }
+        int32_t coefs[FLAC_MAX_LPC_ORDER];
+        uint32_t shift = 0;
+        if (lpc) {
+            uint32_t precision = br_get(br, 4) + 1;
+            int32_t lpcShift = br_get_signed(br, 5);
+            if (precision == 16 || lpcShift < 0) {
+                return false;
+            }
+            shift = (uint32_t)lpcShift;
+            for (uint32_t j = 0; j < order; j++) {
+                coefs[j] = br_get_signed(br, precision);
+            }
+        } else {
+            memcpy(coefs, fixedCoefs[order], sizeof(fixedCoefs[order]));
+        }
+        if (!decode_residual(br, x, stride, samples, order, coefs, shift, bits)) {
+            return false;
+        }
+        frame->subframes[lpc ? 3 : 2]++;
+    } else {
+        return false;
+    }
+
+    if (wasted > 0) {
+        for (uint32_t i = 0; i < samples; i++) {
+            x[(size_t)i * stride] = (int16_t)((uint16_t)x[(size_t)i * stride] << wasted);
+        }
+    }
+    return !br_overrun(br);
+}
+
+size_t flac_decode_frame(const FlacStreamHeader *header, const uint8_t *buf, size_t len, int16_t *out,
+                         size_t outSamples, FlacFrameInfo *frame) {
+    BitReader br = { .buf = buf, .len = len };
+    memset(frame, 0, sizeof(*frame));
+
+    // 帧头：同步码(14) 保留(1) 块策略(1) 块大小(4) 采样率(4) 通道(4) 位数(3) 保留(1) 帧序号 附加字段 CRC-8
+    if (br_get(&br, 15) != 0x7FFC) {
+        return 0;
+    }
+    br_get(&br, 1);
+    uint32_t bsCode = br_get(&br, 4);
+    uint32_t srCode = br_get(&br, 4);
+    uint32_t assignment = br_get(&br, 4);
+    uint32_t ssCode = br_get(&br, 3);
+    if (br_get(&br, 1) != 0 || bsCode == 0 || srCode == 15 || ssCode == 3 || !read_utf8(&br, &frame->number)) {
+        return 0;
+    }
+    uint32_t samples = block_size_from_code(&br, bsCode);
+    uint32_t rate = sample_rate_from_code(&br, srCode, header->sampleRate);
+    size_t headerBytes = (size_t)(br_consumed(&br) / 8);
+    if (br_overrun(&br) || br_get(&br, 8) != crc8(buf, headerBytes)) {
+        return 0;
+    }
+
+    // 只支持各通道独立编码、不超过16位，且必须与STREAMINFO一致
+    uint32_t channels = assignment + 1;
+    uint32_t bits = sample_size_from_code(ssCode, header->bitsPerSample);
+    if (assignment > 7 || channels != header->channels || bits != header->bitsPerSample || bits > 16 ||
+        bits < 4 || rate != header->sampleRate || samples > header->maxBlockSize ||
+        (size_t)samples * channels > outSamples) {
+        return 0;
+    }
+    frame->samples = samples;
+
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        if (!decode_subframe(&br, out + ch, channels, samples, bits, frame)) {
+            return 0;
+        }
+    }
+
+    // 补齐到字节边界后是整帧的CRC-16
+    br_align(&br);
+    size_t frameBytes = (size_t)(br_consumed(&br) / 8);
+    if (br_get(&br, 16) != crc16(buf, frameBytes) || br_overrun(&br)) {
+        return 0;
+    }
+    return frameBytes + 2;
+}
@@ -0,0 +1,43 @@
+#ifndef FLAC_DECODER_H
+#define FLAC_DECODER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "FlacEncoder.h"
+
+// FLAC码流解码器：在主机上读回FlacEncoder生成的录音，逐样本校验
+//
+// 支持FLAC规范中最多16位、各通道独立编码（channel assignment 0~7）的码流：
+//  - 子帧: CONSTANT / VERBATIM / FIXED(0~4阶) / LPC(1~32阶)，含wasted bits
+//  - 残差: 4位或5位Rice参数的分区编码，含escape分区
+//  - 帧头CRC-8和整帧CRC-16都会检查，任何不符都按码流错误处理
+// 不支持左右/中侧立体声去相关（编码器不生成）。无状态，不分配内存。
+//
+// 只在主机工具中使用，不编入固件；不依赖ESP-IDF。
+
+typedef struct {
+    uint32_t sampleRate;
+    uint32_t channels;
+    uint32_t bitsPerSample;
+    uint32_t minBlockSize;
+    uint32_t maxBlockSize;
+    FlacStreamInfo stream;      // 总样本数和帧长度范围（未知时为0）
+    size_t audioOffset;         // 第一个音频帧在文件中的偏移
+} FlacStreamHeader;
+
+typedef struct {
+    uint64_t number;            // 帧序号（固定块大小的码流）
+    uint32_t samples;           // 每通道的样本数
+    uint32_t subframes[4];      // 各类型的子帧数：CONSTANT / VERBATIM / FIXED / LPC
+} FlacFrameInfo;
+
+// 解析文件开头的"fLaC"和元数据块（需要包含全部元数据块），得到STREAMINFO和第一个音频帧的偏移
+bool flac_parse_stream_header(const uint8_t *buf, size_t len, FlacStreamHeader *header);
+
+// 解码buf开头的一帧，交织的样本写入out（容量outSamples个int16，至少为 样本数 x 通道数）；
+// 返回帧的字节数，码流错误、CRC不符或格式与STREAMINFO不一致时返回0
+size_t flac_decode_frame(const FlacStreamHeader *header, const uint8_t *buf, size_t len, int16_t *out,
+                         size_t outSamples, FlacFrameInfo *frame);
+
+#endif /* FLAC_DECODER_H */
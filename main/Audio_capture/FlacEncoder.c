@@ -0,0 +1,485 @@
+#include "FlacEncoder.h"
+#include <string.h>
+#include <stdlib.h>
+
+#define FLAC_STREAMINFO_BYTES   34
+#define FLAC_MAX_RICE_PARAM     14      // 4位Rice参数，15保留为escape
+
+#define FLAC_SUBFRAME_CONSTANT  0x00
+#define FLAC_SUBFRAME_VERBATIM  0x01
+#define FLAC_SUBFRAME_FIXED     0x08    // 低3位为阶数
+
+// 大端位写入器，超出容量时只置溢出标志（可回退到之前保存的位置重写）
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t pos;         // 已写完的整字节数
+    uint64_t acc;       // 尚未凑满一个字节的位（低bits位有效）
+    uint32_t bits;
+    bool overflow;
+} BitWriter;
+
+static inline void bw_put(BitWriter *bw, uint32_t value, uint32_t n) {
+    bw->acc = (bw->acc << n) | (value & (uint32_t)((1ull << n) - 1));
+    bw->bits += n;
+    while (bw->bits >= 8) {
+        bw->bits -= 8;
+        if (bw->pos < bw->cap) {
+            bw->buf[bw->pos++] = (uint8_t)(bw->acc >> bw->bits);
+        } else {
+            bw->overflow = true;
+        }
+    }
+}
+
+// 补0到字节边界
+static void bw_align(BitWriter *bw) {
+    if (bw->bits > 0) {
+        bw_put(bw, 0, 8 - bw->bits);
+    }
+}
+
+// Rice码：q个0、一个1、k位余数
+static inline void bw_put_rice(BitWriter *bw, uint32_t u, uint32_t k) {
+    uint32_t q = u >> k;
+    if (q + 1 + k <= 32) {
+        bw_put(bw, (1u << k) | (u & ((1u << k) - 1)), q + 1 + k);
+        return;
+    }
+    for (; q >= 32; q -= 32) {
+        bw_put(bw, 0, 32);
+    }
+    bw_put(bw, 1, q + 1);
+    if (k > 0) {
+        bw_put(bw, u, k);
+    }
+}
+
+// CRC-8 (多项式0x07)，用于帧头
+static uint8_t crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// CRC-16 (多项式0x8005)，覆盖整帧，查表计算
+static uint16_t crc16Table[256];
+
+static void crc16_init_table(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint16_t crc = (uint16_t)(i << 8);
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x8005) : (uint16_t)(crc << 1);
+        }
+        crc16Table[i] = crc;
+    }
+}
+
+static uint16_t crc16(const uint8_t *data, size_t len) {
+    uint16_t crc = 0;
+    while (len--) {
+        crc = (uint16_t)((crc << 8) ^ crc16Table[(crc >> 8) ^ *data++]);
+    }
+    return crc;
+}
+
+// 帧头中的块大小编码，0x6/0x7表示在帧头末尾附加8/16位的(blockSize-1)
+static uint32_t block_size_code(uint32_t blockSize) {
+    switch (blockSize) {
+    case 192:   return 0x1;
+    case 576:   return 0x2;
+    case 1152:  return 0x3;
+    case 2304:  return 0x4;
+    case 4608:  return 0x5;
+    case 256:   return 0x8;
+    case 512:   return 0x9;
+    case 1024:  return 0xA;
+    case 2048:  return 0xB;
+    case 4096:  return 0xC;
+    case 8192:  return 0xD;
+    case 16384: return 0xE;
+    case 32768: return 0xF;
+    default:    return (blockSize <= 256) ? 0x6 : 0x7;
+    }
+}
+
+// 帧头中的采样率编码，0xC/0xD/0xE表示在帧头末尾附加kHz/Hz/10Hz，0表示取STREAMINFO中的值
+static uint32_t sample_rate_code(uint32_t rate) {
+    switch (rate) {
+    case 88200:  return 0x1;
+    case 176400: return 0x2;
+    case 192000: return 0x3;
+    case 8000:   return 0x4;
+    case 16000:  return 0x5;
+    case 22050:  return 0x6;
+    case 24000:  return 0x7;
+    case 32000:  return 0x8;
+    case 44100:  return 0x9;
+    case 48000:  return 0xA;
+    case 96000:  return 0xB;
+    default:
+        if (rate % 1000 == 0 && rate <= 255000) {
+            return 0xC;
+        } else if (rate <= 65535) {
+            return 0xD;
+        } else if (rate % 10 == 0 && rate <= 655350) {
+            return 0xE;
+        }
+        return 0x0;
+    }
+}
+
+// 帧头中的样本位数编码，0表示取STREAMINFO中的值
+static uint32_t sample_size_code(uint32_t bits) {
+    switch (bits) {
+    case 8:  return 0x1;
+    case 12: return 0x2;
+    case 16: return 0x4;
+    default: return 0x0;
+    }
+}
+
+// 帧头：同步码、块参数、UTF-8编码的帧序号、附加字段、CRC-8
+static void write_frame_header(BitWriter *bw, const FlacConfig *config, uint32_t frameNumber,
+                               uint32_t samples) {
+    size_t start = bw->pos;
+    uint32_t bsCode = block_size_code(samples);
+    uint32_t srCode = sample_rate_code(config->sampleRate);
+
+    bw_put(bw, 0xFFF8, 16);     // 同步码 + 固定块大小
+    bw_put(bw, bsCode, 4);
+    bw_put(bw, srCode, 4);
+    bw_put(bw, config->channels - 1, 4);    // 各通道独立编码
+    bw_put(bw, sample_size_code(config->bitsPerSample), 3);
+    bw_put(bw, 0, 1);
+
+    if (frameNumber < 0x80) {
+        bw_put(bw, frameNumber, 8);
+    } else {
+        // 扩展UTF-8：首字节的前导1个数等于总字节数
+        uint32_t n = 2;
+        while (n < 6 && frameNumber >= (1u << (5 * n + 1))) {
+            n++;
+        }
+        bw_put(bw, (0xFF00u >> n) | (frameNumber >> (6 * (n - 1))), 8);
+        for (uint32_t i = n - 1; i > 0; i--) {
+            bw_put(bw, 0x80 | ((frameNumber >> (6 * (i - 1))) & 0x3F), 8);
+        }
+    }
+
+    if (bsCode == 0x6) {
+        bw_put(bw, samples - 1, 8);
+    } else if (bsCode == 0x7) {
+        bw_put(bw, samples - 1, 16);
+    }
+    if (srCode == 0xC) {
+        bw_put(bw, config->sampleRate / 1000, 8);
+    } else if (srCode == 0xD) {
+        bw_put(bw, config->sampleRate, 16);
+    } else if (srCode == 0xE) {
+        bw_put(bw, config->sampleRate / 10, 16);
+    }
+
+    if (!bw->overflow) {
+        bw_put(bw, crc8(bw->buf + start, bw->pos - start), 8);
+    }
+}
+
+// 用差分级联求各阶固定预测残差的绝对值之和，返回和最小的阶数
+static uint32_t best_fixed_order(const int32_t *x, uint32_t n, uint32_t maxOrder) {
+    uint64_t sum[FLAC_MAX_FIXED_ORDER + 1] = {0};
+
+    if (n <= FLAC_MAX_FIXED_ORDER) {
+        return 0;
+    }
+
+    int32_t e1 = x[3] - x[2];
+    int32_t e2 = e1 - (x[2] - x[1]);
+    int32_t e3 = e2 - ((x[2] - x[1]) - (x[1] - x[0]));
+    for (uint32_t i = FLAC_MAX_FIXED_ORDER; i < n; i++) {
+        int32_t d0 = x[i];
+        int32_t d1 = d0 - x[i - 1];
+        int32_t d2 = d1 - e1;
+        int32_t d3 = d2 - e2;
+        int32_t d4 = d3 - e3;
+        sum[0] += (uint32_t)abs(d0);
+        sum[1] += (uint32_t)abs(d1);
+        sum[2] += (uint32_t)abs(d2);
+        sum[3] += (uint32_t)abs(d3);
+        sum[4] += (uint32_t)abs(d4);
+        e1 = d1;
+        e2 = d2;
+        e3 = d3;
+    }
+
+    uint32_t best = 0;
+    for (uint32_t order = 1; order <= maxOrder; order++) {
+        if (sum[order] < sum[best]) {
+            best = order;
+        }
+    }
+    return best;
+}
+
+// 原地把样本变为order阶固定预测残差（从后往前，前order个样本保留为预热样本）
+static void fixed_residual(int32_t *x, uint32_t n, uint32_t order) {
+    switch (order) {
+    case 1:
+        for (uint32_t i = n - 1; i >= 1; i--) {
+            x[i] = x[i] - x[i - 1];
+        }
+        break;
+    case 2:
+        for (uint32_t i = n - 1; i >= 2; i--) {
+            x[i] = x[i] - 2 * x[i - 1] + x[i - 2];
+        }
+        break;
+    case 3:
+        for (uint32_t i = n - 1; i >= 3; i--) {
+            x[i] = x[i] - 3 * x[i - 1] + 3 * x[i - 2] - x[i - 3];
+        }
+        break;
+    case 4:
+        for (uint32_t i = n - 1; i >= 4; i--) {
+            x[i] = x[i] - 4 * x[i - 1] + 6 * x[i - 2] - 4 * x[i - 3] + x[i - 4];
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static inline uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+// 按残差之和估计分区的最佳Rice参数和位数
+static uint32_t rice_param(uint64_t sum, uint32_t count, uint64_t *bits) {
+    uint32_t k = 0;
+    uint64_t best = UINT64_MAX;
+    for (uint32_t p = 0; p <= FLAC_MAX_RICE_PARAM; p++) {
+        uint64_t b = (uint64_t)count * (p + 1) + (sum >> p);
+        if (b < best) {
+            best = b;
+            k = p;
+        }
+    }
+    *bits = best + 4;
+    return k;
+}
+
+// 分区Rice编码的残差：先按最细的分区求和，再逐级合并，选估计位数最少的分区阶数
+static void write_residual(FlacEncoder *encoder, BitWriter *bw, const int32_t *res, uint32_t n,
+                           uint32_t order) {
+    uint64_t *sums = encoder->partitionSums;
+    uint32_t maxPart = encoder->config.maxPartitionOrder;
+
+    while (maxPart > 0 && ((n & ((1u << maxPart) - 1)) != 0 || (n >> maxPart) <= order)) {
+        maxPart--;
+    }
+
+    uint32_t parts = 1u << maxPart;
+    uint32_t partLen = n >> maxPart;
+    for (uint32_t p = 0; p < parts; p++) {
+        uint64_t sum = 0;
+        for (uint32_t i = (p == 0) ? order : p * partLen; i < (p + 1) * partLen; i++) {
+            sum += zigzag(res[i]);
+        }
+        sums[p] = sum;
+    }
+
+    uint32_t bestOrder = maxPart;
+    uint64_t bestBits = UINT64_MAX;
+    for (int32_t po = (int32_t)maxPart; po >= 0; po--) {
+        uint32_t count = 1u << po;
+        uint64_t bits = 0;
+        for (uint32_t p = 0; p < count; p++) {
+            uint32_t len = (n >> po) - ((p == 0) ? order : 0);
+            uint64_t b;
+            rice_param(sums[p], len, &b);
+            bits += b;
+        }
+        if (bits < bestBits) {
+            bestBits = bits;
+            bestOrder = (uint32_t)po;
+        }
+        // 相邻分区合并到上一级
+        for (uint32_t p = 0; p < count / 2; p++) {
+            sums[p] = sums[2 * p] + sums[2 * p + 1];
+        }
+    }
+
+    // 合并后sums[]已被覆盖，按选中的分区阶数重新求和
+    bw_put(bw, 0, 2);           // 4位Rice参数
+    bw_put(bw, bestOrder, 4);
+    partLen = n >> bestOrder;
+    for (uint32_t p = 0; p < (1u << bestOrder); p++) {
+        uint32_t start = (p == 0) ? order : p * partLen;
+        uint32_t end = (p + 1) * partLen;
+        uint64_t sum = 0;
+        for (uint32_t i = start; i < end; i++) {
+            sum += zigzag(res[i]);
+        }
+        uint64_t bits;
+        uint32_t k = rice_param(sum, end - start, &bits);
+        bw_put(bw, k, 4);
+        for (uint32_t i = start; i < end; i++) {
+            bw_put_rice(bw, zigzag(res[i]), k);
+        }
+    }
+}
+
+static void write_verbatim(BitWriter *bw, const int16_t *interleaved, uint32_t channels,
+                           uint32_t samples, uint32_t bitsPerSample) {
+    bw_put(bw, FLAC_SUBFRAME_VERBATIM << 1, 8);
+    for (uint32_t i = 0; i < samples; i++) {
+        bw_put(bw, (uint32_t)interleaved[i * channels], bitsPerSample);
+    }
+}
+
+// 编码一个通道的子帧
+static void write_subframe(FlacEncoder *encoder, BitWriter *bw, const int16_t *interleaved,
+                           uint32_t samples) {
+    const FlacConfig *config = &encoder->config;
+    int32_t *x = encoder->work;
+    bool constant = true;
+
+    for (uint32_t i = 0; i < samples; i++) {
+        x[i] = interleaved[i * config->channels];
+        constant = constant && x[i] == x[0];
+    }
+
+    if (constant) {
+        bw_put(bw, FLAC_SUBFRAME_CONSTANT << 1, 8);
+        bw_put(bw, (uint32_t)x[0], config->bitsPerSample);
+        return;
+    }
+
+    // 先尝试固定预测，比原始样本更长时回退重写为VERBATIM
+    BitWriter saved = *bw;
+    uint32_t order = best_fixed_order(x, samples, config->maxOrder);
+
+    bw_put(bw, (FLAC_SUBFRAME_FIXED | order) << 1, 8);
+    for (uint32_t i = 0; i < order; i++) {
+        bw_put(bw, (uint32_t)x[i], config->bitsPerSample);
+    }
+    fixed_residual(x, samples, order);
+    write_residual(encoder, bw, x, samples, order);
+
+    uint64_t used = (uint64_t)(bw->pos - saved.pos) * 8 + bw->bits - saved.bits;
+    uint64_t verbatim = 8 + (uint64_t)samples * config->bitsPerSample;
+    if (bw->overflow || used >= verbatim) {
+        *bw = saved;
+        write_verbatim(bw, interleaved, config->channels, samples, config->bitsPerSample);
+    }
+}
+
+bool flac_encoder_init(FlacEncoder *encoder, const FlacConfig *config) {
+    memset(encoder, 0, sizeof(*encoder));
+    if (config->channels == 0 || config->channels > FLAC_MAX_CHANNELS ||
+        config->bitsPerSample < 4 || config->bitsPerSample > 16 ||
+        config->blockSize < FLAC_MIN_BLOCK_SIZE || config->blockSize > FLAC_MAX_BLOCK_SIZE ||
+        config->sampleRate == 0 || config->sampleRate > 655350 ||
+        config->maxOrder > FLAC_MAX_FIXED_ORDER ||
+        config->maxPartitionOrder > FLAC_MAX_PARTITION_ORDER) {
+        return false;
+    }
+
+    encoder->work = malloc(config->blockSize * sizeof(int32_t));
+    if (encoder->work == NULL) {
+        return false;
+    }
+    encoder->config = *config;
+    if (crc16Table[1] == 0) {
+        crc16_init_table();
+    }
+    return true;
+}
+
+void flac_encoder_deinit(FlacEncoder *encoder) {
+    free(encoder->work);
+    encoder->work = NULL;
+}
+
+void flac_encoder_reset(FlacEncoder *encoder) {
+    encoder->frameNumber = 0;
+}
+
+// 编码一帧，verbatim为true时所有通道都写VERBATIM子帧
+static size_t encode_frame(FlacEncoder *encoder, const int16_t *interleaved, uint32_t samples,
+                           uint8_t *out, size_t outCap, bool verbatim) {
+    const FlacConfig *config = &encoder->config;
+    BitWriter bw = { .buf = out, .cap = outCap };
+
+    if (encoder->work == NULL || samples == 0 || samples > config->blockSize) {
+        return 0;
+    }
+
+    write_frame_header(&bw, config, encoder->frameNumber, samples);
+    for (uint32_t ch = 0; ch < config->channels; ch++) {
+        if (verbatim) {
+            write_verbatim(&bw, interleaved + ch, config->channels, samples, config->bitsPerSample);
+        } else {
+            write_subframe(encoder, &bw, interleaved + ch, samples);
+        }
+    }
+    bw_align(&bw);
+    if (bw.overflow || bw.pos + 2 > outCap) {
+        return 0;
+    }
+
+    uint16_t crc = crc16(out, bw.pos);
+    out[bw.pos++] = (uint8_t)(crc >> 8);
+    out[bw.pos++] = (uint8_t)crc;
+
+    encoder->frameNumber++;
+    return bw.pos;
+}
+
+size_t flac_encode_frame(FlacEncoder *encoder, const int16_t *interleaved, uint32_t samples,
+                         uint8_t *out, size_t outCap) {
+    return encode_frame(encoder, interleaved, samples, out, outCap, false);
+}
+
+size_t flac_encode_verbatim_frame(FlacEncoder *encoder, const int16_t *interleaved, uint32_t samples,
+                                  uint8_t *out, size_t outCap) {
+    return encode_frame(encoder, interleaved, samples, out, outCap, true);
+}
+
+bool flac_build_header(uint8_t *out, const FlacConfig *config, const FlacStreamInfo *info) {
+    if (config->channels == 0 || config->channels > FLAC_MAX_CHANNELS ||
+        config->bitsPerSample < 4 || config->bitsPerSample > 32) {
+        return false;
+    }
+
+    memset(out, 0, FLAC_HEADER_BYTES);
+    BitWriter bw = { .buf = out, .cap = FLAC_HEADER_BYTES };
+
+    bw_put(&bw, 0x664C6143, 32);    // "fLaC"
+
+    // STREAMINFO（不是最后一个元数据块）
+    bw_put(&bw, 0, 1);
+    bw_put(&bw, 0, 7);
+    bw_put(&bw, FLAC_STREAMINFO_BYTES, 24);
+    bw_put(&bw, config->blockSize, 16);     // 最小块大小
+    bw_put(&bw, config->blockSize, 16);     // 最大块大小
+    bw_put(&bw, info->minFrameBytes, 24);
+    bw_put(&bw, info->maxFrameBytes, 24);
+    bw_put(&bw, config->sampleRate, 20);
+    bw_put(&bw, config->channels - 1, 3);
+    bw_put(&bw, config->bitsPerSample - 1, 5);
+    bw_put(&bw, (uint32_t)(info->totalSamples >> 32) & 0xF, 4);
+    bw_put(&bw, (uint32_t)info->totalSamples, 32);
+    bw.pos += 16;                           // MD5未计算，全0
+
+    // PADDING（最后一个元数据块），把头部填充到FLAC_HEADER_BYTES
+    bw_put(&bw, 1, 1);
+    bw_put(&bw, 1, 7);
+    bw_put(&bw, FLAC_HEADER_BYTES - bw.pos - 3, 24);
+    return !bw.overflow;
+}
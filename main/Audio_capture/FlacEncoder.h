@@ -0,0 +1,75 @@
+#ifndef FLAC_ENCODER_H
+#define FLAC_ENCODER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 无损压缩编码器（FLAC兼容码流）
+//
+// 每次把一个交织的16位PCM块编码成一个FLAC帧，每个通道独立选择子帧类型：
+//  - CONSTANT: 整块为同一个值（如静音）
+//  - FIXED:    0~4阶固定线性预测，残差用分区Rice编码
+//  - VERBATIM: 预测后反而更大时退回原始样本
+// 因此一帧的长度不会超过FLAC_MAX_FRAME_BYTES，可以原地写回原始块缓冲区（需留少量余量）。
+//
+// 文件头固定为FLAC_HEADER_BYTES(512)字节：
+//   0   "fLaC"
+//   4   STREAMINFO（总样本数在检查点和关闭时回写）
+//   42  PADDING（填充到扇区边界）
+//   512 第一个音频帧
+// 生成的文件可以直接用flac/ffmpeg等标准解码器解码。
+// 不依赖ESP-IDF，可在主机上编译。
+
+#define FLAC_HEADER_BYTES           512
+#define FLAC_MAX_CHANNELS           8
+#define FLAC_MAX_FIXED_ORDER        4
+#define FLAC_MAX_PARTITION_ORDER    6
+#define FLAC_MIN_BLOCK_SIZE         16
+#define FLAC_MAX_BLOCK_SIZE         32768
+
+// 一帧的最大字节数：帧头(16) + 每通道VERBATIM子帧 + 字节对齐 + CRC-16
+#define FLAC_MAX_FRAME_BYTES(channels, blockSize, bitsPerSample) \
+    (16 + (channels) * (1 + ((blockSize) * (bitsPerSample) + 7) / 8) + 1 + 2)
+
+typedef struct {
+    uint32_t sampleRate;
+    uint32_t channels;          // 1 ~ FLAC_MAX_CHANNELS
+    uint32_t bitsPerSample;     // 4 ~ 16，样本以int16交织输入
+    uint32_t blockSize;         // 每帧每通道的样本数
+    uint32_t maxOrder;          // 固定预测的最高阶数（0 ~ FLAC_MAX_FIXED_ORDER）
+    uint32_t maxPartitionOrder; // Rice分区的最高阶数（0 ~ FLAC_MAX_PARTITION_ORDER）
+} FlacConfig;
+
+// 写入STREAMINFO的码流统计，未知的字段为0
+typedef struct {
+    uint64_t totalSamples;      // 每通道的样本总数
+    uint32_t minFrameBytes;
+    uint32_t maxFrameBytes;
+} FlacStreamInfo;
+
+typedef struct {
+    FlacConfig config;
+    uint32_t frameNumber;       // 下一帧的帧序号
+    int32_t *work;              // blockSize个样本：先放单通道样本，再原地变为残差
+    uint64_t partitionSums[1 << FLAC_MAX_PARTITION_ORDER];
+} FlacEncoder;
+
+// 初始化编码器（分配blockSize个int32的工作缓冲区），参数非法或内存不足时返回false
+bool flac_encoder_init(FlacEncoder *encoder, const FlacConfig *config);
+// 释放工作缓冲区
+void flac_encoder_deinit(FlacEncoder *encoder);
+// 开始一个新码流（帧序号从0开始）
+void flac_encoder_reset(FlacEncoder *encoder);
+// 编码一帧。samples为每通道的样本数（1 ~ blockSize，只有最后一帧可以小于blockSize）。
+// 输出不能和输入重叠；返回帧的字节数，输出空间不足或参数非法时返回0。
+size_t flac_encode_frame(FlacEncoder *encoder, const int16_t *interleaved, uint32_t samples,
+                         uint8_t *out, size_t outCap);
+// 编码一帧，所有通道都用VERBATIM子帧（不做预测，长度恰为FLAC_MAX_FRAME_BYTES以内的固定值）。
+// flac_encode_frame失败时用它保住这一块；参数和返回值同flac_encode_frame。
+size_t flac_encode_verbatim_frame(FlacEncoder *encoder, const int16_t *interleaved, uint32_t samples,
+                                  uint8_t *out, size_t outCap);
+// 生成FLAC_HEADER_BYTES字节的文件头
+bool flac_build_header(uint8_t *out, const FlacConfig *config, const FlacStreamInfo *info);
+
+#endif /* FLAC_ENCODER_H */
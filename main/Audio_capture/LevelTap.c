@@ -0,0 +1,131 @@
+#include "LevelTap.h"
+#include <math.h>
+#include <string.h>
+
+#define LEVEL_TAP_FRESH     (1u << 31)
+#define LEVEL_TAP_INDEX     3u
+
+void level_tap_init(LevelTap *tap) {
+    memset(tap, 0, sizeof(*tap));
+    tap->front = 0;
+    atomic_init(&tap->middle, 1);
+    tap->back = 2;
+    atomic_init(&tap->selectedChannel, 0);
+}
+
+bool level_tap_configure(LevelTap *tap, uint32_t channels, uint32_t sampleBytes, uint32_t channelMask,
+                         uint32_t sampleRate) {
+    if (channels == 0 || channels > LEVEL_TAP_MAX_CHANNELS || sampleBytes < 2 || sampleBytes > 4) {
+        return false;
+    }
+    tap->channels = channels;
+    tap->sampleBytes = sampleBytes;
+    tap->channelMask = channelMask;
+    tap->sampleRate = sampleRate;
+    tap->periodUs = (int64_t)LEVEL_TAP_PUBLISH_MS * 1000;
+    tap->lastPublishUs = 0;
+    memset(tap->sumSquare, 0, sizeof(tap->sumSquare));
+    memset(tap->peak, 0, sizeof(tap->peak));
+    tap->frames = 0;
+    tap->collecting = false;
+    tap->spectrumFill = 0;
+    return true;
+}
+
+void level_tap_select_channel(LevelTap *tap, uint32_t channel) {
+    atomic_store_explicit(&tap->selectedChannel, channel, memory_order_relaxed);
+}
+
+uint32_t level_tap_selected_channel(LevelTap *tap) {
+    return atomic_load_explicit(&tap->selectedChannel, memory_order_relaxed);
+}
+
+// 从交织块中抽取一个通道的样本到频谱窗口（只取高16位）
+static void collect_spectrum(LevelTap *tap, LevelSnapshot *snap, const uint8_t *data, uint32_t frames) {
+    uint32_t take = LEVEL_TAP_FFT_SIZE - tap->spectrumFill;
+    if (take > frames) {
+        take = frames;
+    }
+    int16_t *out = snap->spectrum + tap->spectrumFill;
+    size_t stride = (size_t)tap->channels * tap->sampleBytes;
+    if (tap->sampleBytes == 2) {
+        const int16_t *in = (const int16_t *)data + snap->spectrumChannel;
+        for (uint32_t f = 0; f < take; f++, in += tap->channels) {
+            out[f] = *in;
+        }
+    } else {
+        const uint8_t *in = data + (size_t)snap->spectrumChannel * tap->sampleBytes + tap->sampleBytes - 2;
+        for (uint32_t f = 0; f < take; f++, in += stride) {
+            out[f] = (int16_t)(in[0] | (in[1] << 8));
+        }
+    }
+    tap->spectrumFill += take;
+}
+
+// 把累积的电平写入后台缓冲区，与中间缓冲区交换
+static void publish(LevelTap *tap, LevelSnapshot *snap, int64_t nowUs) {
+    snap->seq = ++tap->seq;
+    snap->timeUs = nowUs;
+    snap->channels = tap->channels;
+    snap->channelMask = tap->channelMask;
+    snap->sampleRate = tap->sampleRate;
+    for (uint32_t ch = 0; ch < tap->channels; ch++) {
+        snap->rms[ch] = (tap->frames > 0) ? sqrtf((float)(tap->sumSquare[ch] / (double)tap->frames)) : 0.0f;
+        snap->peak[ch] = tap->peak[ch];
+    }
+    memset(tap->sumSquare, 0, sizeof(tap->sumSquare));
+    memset(tap->peak, 0, sizeof(tap->peak));
+    tap->frames = 0;
+    tap->lastPublishUs = nowUs;
+
+    uint32_t prev = atomic_exchange_explicit(&tap->middle, tap->back | LEVEL_TAP_FRESH, memory_order_acq_rel);
+    tap->back = prev & LEVEL_TAP_INDEX;
+}
+
+void level_tap_feed(LevelTap *tap, const void *data, uint32_t frames, int64_t nowUs) {
+    if (tap->channels == 0 || frames == 0) {
+        return;
+    }
+
+    EventLevels levels;
+    if (tap->channels == 8 && tap->sampleBytes == 2) {
+        event_levels_s16x8(data, frames, &levels);
+    } else {
+        event_levels_generic(data, tap->sampleBytes, tap->channels, frames, &levels);
+    }
+    for (uint32_t ch = 0; ch < tap->channels; ch++) {
+        tap->sumSquare[ch] += (double)levels.meanSquare[ch] * frames;
+        if (levels.peak[ch] > tap->peak[ch]) {
+            tap->peak[ch] = levels.peak[ch];
+        }
+    }
+    tap->frames += frames;
+
+    // 发布周期到了：从这一块开始抽取频谱窗口，取满后发布
+    LevelSnapshot *snap = &tap->buffers[tap->back];
+    if (!tap->collecting) {
+        if (nowUs - tap->lastPublishUs < tap->periodUs) {
+            return;
+        }
+        tap->collecting = true;
+        tap->spectrumFill = 0;
+        snap->spectrumChannel = level_tap_selected_channel(tap) % tap->channels;
+    }
+    collect_spectrum(tap, snap, data, frames);
+    if (tap->spectrumFill == LEVEL_TAP_FFT_SIZE) {
+        tap->collecting = false;
+        publish(tap, snap, nowUs);
+    }
+}
+
+const LevelSnapshot *level_tap_read(LevelTap *tap, bool *fresh) {
+    bool isFresh = (atomic_load_explicit(&tap->middle, memory_order_relaxed) & LEVEL_TAP_FRESH) != 0;
+    if (isFresh) {
+        uint32_t prev = atomic_exchange_explicit(&tap->middle, tap->front, memory_order_acq_rel);
+        tap->front = prev & LEVEL_TAP_INDEX;
+    }
+    if (fresh != NULL) {
+        *fresh = isFresh;
+    }
+    return &tap->buffers[tap->front];
+}
@@ -0,0 +1,75 @@
+#ifndef LEVEL_TAP_H
+#define LEVEL_TAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "EventDetector.h"
+
+// 电平/频谱抽头：采集链路把每个块交给抽头，显示任务读取最近一次发布的快照
+//
+// 写入者（采集任务，零拷贝模式下为文件任务）每块计算各通道的均方值和峰值（EventDetector的电平内核），
+// 在一个发布周期内累积；周期到了以后从选中的通道抽取LEVEL_TAP_FFT_SIZE个连续样本（截取高16位），
+// 取满后发布一个快照。即电平不漏块，频谱在时间上抽取：每个显示帧只取一个窗口，FFT由显示任务计算。
+//
+// 快照用三缓冲交换：写入者写后台缓冲区，写完后与中间缓冲区原子交换并置"新"标志；
+// 读取者只在有新快照时把前台缓冲区与中间缓冲区交换。双方都不等待、不重试，也读不到写了一半的快照，
+// 因此显示再慢也不会阻塞采集任务。只支持一个写入者和一个读取者。
+//
+// 不依赖ESP-IDF，可在主机上编译。
+
+#define LEVEL_TAP_MAX_CHANNELS      EVENT_DETECTOR_MAX_CHANNELS
+#define LEVEL_TAP_FFT_SIZE          512
+#define LEVEL_TAP_PUBLISH_MS        40      // 发布周期（约25帧/秒）
+
+typedef struct {
+    uint32_t seq;                   // 发布序号，从1开始
+    int64_t timeUs;                 // 发布时间
+    uint32_t channels;              // 每帧样本数（TDM槽位数）
+    uint32_t channelMask;           // 录制的槽位
+    uint32_t sampleRate;
+    float rms[LEVEL_TAP_MAX_CHANNELS];  // 发布周期内的RMS（满量程归一化，1.0 = 0dBFS）
+    float peak[LEVEL_TAP_MAX_CHANNELS]; // 发布周期内的峰值
+    uint32_t spectrumChannel;       // 频谱样本来自的槽位
+    int16_t spectrum[LEVEL_TAP_FFT_SIZE];   // 连续的时域样本（高16位）
+} LevelSnapshot;
+
+typedef struct {
+    LevelSnapshot buffers[3];
+    atomic_uint middle;             // 中间缓冲区的下标 | LEVEL_TAP_FRESH
+    uint32_t back;                  // 写入者私有
+    uint32_t front;                 // 读取者私有
+    atomic_uint selectedChannel;    // 频谱通道，任意任务可设置，写入者在下一个窗口开始时采用
+
+    // 以下只由写入者访问（configure在写入者开始之前调用）
+    uint32_t channels;
+    uint32_t sampleBytes;
+    uint32_t channelMask;
+    uint32_t sampleRate;
+    int64_t periodUs;
+    int64_t lastPublishUs;
+    uint32_t seq;
+    double sumSquare[LEVEL_TAP_MAX_CHANNELS];   // 发布周期内的均方值×帧数
+    float peak[LEVEL_TAP_MAX_CHANNELS];
+    uint64_t frames;
+    bool collecting;                // 正在抽取频谱窗口
+    uint32_t spectrumFill;
+} LevelTap;
+
+// 初始化缓冲区（读取者开始之前调用一次）
+void level_tap_init(LevelTap *tap);
+// 设置块格式并清除累积值（每次开始采集前由写入者一侧调用）。sampleBytes为2、3或4
+bool level_tap_configure(LevelTap *tap, uint32_t channels, uint32_t sampleBytes, uint32_t channelMask,
+                         uint32_t sampleRate);
+// 选择频谱通道（超出槽位数时由写入者取模）
+void level_tap_select_channel(LevelTap *tap, uint32_t channel);
+uint32_t level_tap_selected_channel(LevelTap *tap);
+
+// 写入者：处理一个交织块，到期时发布快照
+void level_tap_feed(LevelTap *tap, const void *data, uint32_t frames, int64_t nowUs);
+
+// 读取者：返回最近发布的快照（还没有发布过时seq为0），fresh表示是否是上次读取之后新发布的。
+// 返回的快照在下一次调用之前保持不变
+const LevelSnapshot *level_tap_read(LevelTap *tap, bool *fresh);
+
+#endif /* LEVEL_TAP_H */
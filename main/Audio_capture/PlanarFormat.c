@@ -0,0 +1,56 @@
+#include "PlanarFormat.h"
+#include <string.h>
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+static bool format_valid(const PlanarFormat *format) {
+    return format->channels > 0 && format->chunkSamples > 0 &&
+           (format->bitsPerSample == 16 || format->bitsPerSample == 32);
+}
+
+bool planar_build_header(uint8_t *out, const PlanarFormat *format) {
+    if (!format_valid(format)) {
+        return false;
+    }
+
+    memset(out, 0, PLANAR_HEADER_BYTES);
+    memcpy(out, "PLNR", 4);
+    put_u16(out + 4, PLANAR_VERSION);
+    put_u16(out + 6, PLANAR_HEADER_BYTES);
+    put_u32(out + 8, format->sampleRate);
+    put_u16(out + 12, format->channels);
+    put_u16(out + 14, format->bitsPerSample);
+    put_u32(out + 16, format->chunkSamples);
+    put_u32(out + 20, format->channelMask);
+    return true;
+}
+
+bool planar_parse_header(const uint8_t *buf, size_t len, PlanarFormat *format) {
+    if (len < 24 || memcmp(buf, "PLNR", 4) != 0 || get_u16(buf + 4) != PLANAR_VERSION ||
+        get_u16(buf + 6) != PLANAR_HEADER_BYTES) {
+        return false;
+    }
+
+    format->sampleRate = get_u32(buf + 8);
+    format->channels = get_u16(buf + 12);
+    format->bitsPerSample = get_u16(buf + 14);
+    format->chunkSamples = get_u32(buf + 16);
+    format->channelMask = get_u32(buf + 20);
+    return format_valid(format);
+}
@@ -0,0 +1,47 @@
+#ifndef PLANAR_FORMAT_H
+#define PLANAR_FORMAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 按块分平面的录音文件（.PLN）
+//
+// 头部固定为PLANAR_HEADER_BYTES(512)字节，之后是连续的块。每个块包含
+// channels个平面，每个平面是同一通道的chunkSamples个连续样本（小端）：
+//   块k: [通道0 x chunkSamples][通道1 x chunkSamples]...[通道N-1 x chunkSamples]
+// 块大小是扇区的整数倍，读取端可以按块直接拿到每个麦克风的连续数据。
+// 头部不记录长度，块数由文件长度得出（末尾不完整的块应丢弃）。
+//
+// 头部布局（小端）：
+//   0   "PLNR"
+//   4   version(u16) headerBytes(u16)
+//   8   sampleRate(u32)
+//   12  channels(u16) bitsPerSample(u16)
+//   16  chunkSamples(u32)
+//   20  channelMask(u32)  文件中各平面对应的TDM槽位（0表示槽位0..channels-1）
+//   24  保留，全0
+//
+// 不依赖ESP-IDF，可在主机上编译。
+
+#define PLANAR_HEADER_BYTES     512
+#define PLANAR_VERSION          1
+
+typedef struct {
+    uint32_t sampleRate;
+    uint16_t channels;
+    uint16_t bitsPerSample;     // 16或32
+    uint32_t chunkSamples;      // 每块每通道的样本数
+    uint32_t channelMask;       // 保留的TDM槽位，平面按槽位号从小到大排列
+} PlanarFormat;
+
+// 生成PLANAR_HEADER_BYTES字节的头部
+bool planar_build_header(uint8_t *out, const PlanarFormat *format);
+// 解析文件开头的头部
+bool planar_parse_header(const uint8_t *buf, size_t len, PlanarFormat *format);
+// 每块的字节数
+static inline uint32_t planar_chunk_bytes(const PlanarFormat *format) {
+    return format->chunkSamples * format->channels * (format->bitsPerSample / 8);
+}
+
+#endif /* PLANAR_FORMAT_H */
@@ -0,0 +1,310 @@
+#include "SyncClock.h"
+#include <string.h>
+#include <math.h>
+
+// 脉冲间隔的容差：中断延迟的抖动，加上每个周期100ppm的周期估计误差（不超过1/4周期）
+#define PULSE_TOLERANCE_US      500.0
+#define PULSE_TOLERANCE_PER_PERIOD  1e-4
+
+typedef enum {
+    LOCATE_OK,
+    LOCATE_WAIT,        // 脉冲之后的DMA完成时间还不够
+    LOCATE_STALE,       // 脉冲之前的DMA完成时间已被覆盖（或DMA还没有开始）
+} LocateResult;
+
+bool sync_clock_init(SyncClock *sc, uint32_t sampleRate, uint32_t dmaFrames, uint32_t periodMs) {
+    if (sc == NULL || sampleRate == 0 || dmaFrames == 0 || periodMs < SYNC_CLOCK_MIN_PERIOD_MS ||
+        periodMs > SYNC_CLOCK_MAX_PERIOD_MS) {
+        return false;
+    }
+    memset(sc, 0, sizeof(*sc));
+    sc->sampleRate = sampleRate;
+    sc->dmaFrames = dmaFrames;
+    sc->periodMs = periodMs;
+    sc->nominalFrames = (double)sampleRate * periodMs / 1000.0;
+    sc->periodUs = periodMs * 1000.0;
+    return true;
+}
+
+// 把32位DMA计数扩展为64位（轮询者每块调用一次，两次之间不会相差2^32个缓冲区）
+static void update_total(SyncClock *sc) {
+    uint32_t count = sync_clock_dma_count(sc);
+    sc->dmaTotal += (uint32_t)(count - sc->countSeen);
+    sc->countSeen = count;
+}
+
+void sync_clock_start(SyncClock *sc, uint32_t dmaCount) {
+    update_total(sc);
+    sc->baseTotal = sc->dmaTotal - (uint32_t)(sc->countSeen - dmaCount);
+    sc->started = true;
+}
+
+void sync_clock_stop(SyncClock *sc) {
+    sc->started = false;
+}
+
+// 脉冲时间t在DMA帧流中的位置（帧）：取t之后第一个完成时间前后各SYNC_CLOCK_FIT_HALF个完成时间，
+// 拟合 完成时间 = a + b x 计数，求时间为t处的（小数）计数
+static LocateResult locate(SyncClock *sc, int64_t t, double *pos) {
+    uint32_t now = sc->countSeen;
+    // 中断可能正在写now + 1的槽位，可用的完成时间是最近的SYNC_CLOCK_STAMPS - 1个
+    uint32_t avail = (sc->dmaTotal < SYNC_CLOCK_STAMPS - 1) ? (uint32_t)sc->dmaTotal : SYNC_CLOCK_STAMPS - 1;
+    if (avail == 0 || sc->stampUs[now % SYNC_CLOCK_STAMPS] <= t) {
+        return LOCATE_WAIT;
+    }
+    uint32_t after = now;
+    uint32_t k = 1;
+    while (k < avail && sc->stampUs[(now - k) % SYNC_CLOCK_STAMPS] > t) {
+        after = now - k;
+        k++;
+    }
+    if (k == avail) {
+        return LOCATE_STALE;
+    }
+    if ((uint32_t)(now - after) < SYNC_CLOCK_FIT_HALF - 1) {
+        return LOCATE_WAIT;
+    }
+    if ((uint32_t)(now - after) + SYNC_CLOCK_FIT_HALF >= avail) {
+        return LOCATE_STALE;
+    }
+
+    // x为相对after的计数，y为相对t的时间，避免大数相减损失精度
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    const int n = 2 * SYNC_CLOCK_FIT_HALF;
+    for (int x = -SYNC_CLOCK_FIT_HALF; x < SYNC_CLOCK_FIT_HALF; x++) {
+        double y = (double)(sc->stampUs[(after + (uint32_t)x) % SYNC_CLOCK_STAMPS] - t);
+        sx += x;
+        sy += y;
+        sxx += (double)x * x;
+        sxy += x * y;
+    }
+    // 读取期间中断又写入了整整一圈：最早的时间戳可能已被覆盖
+    if ((uint32_t)(sync_clock_dma_count(sc) - (after - SYNC_CLOCK_FIT_HALF)) >= SYNC_CLOCK_STAMPS - 1) {
+        return LOCATE_STALE;
+    }
+    double b = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    double a = (sy - b * sx) / n;
+    if (!(b > 0)) {
+        return LOCATE_STALE;
+    }
+    uint64_t afterTotal = sc->dmaTotal - (uint32_t)(now - after);
+    *pos = ((double)afterTotal - a / b) * sc->dmaFrames;
+    return LOCATE_OK;
+}
+
+// 拟合从下一个脉冲重新开始
+static void restart_fit(SyncClock *sc) {
+    sc->fitCount = 0;
+    sc->rejectRun = 0;
+    sc->reset = true;
+    atomic_fetch_add_explicit(&sc->resets, 1, memory_order_relaxed);
+}
+
+// 间隔dt是否为整数个周期（在容差之内），是则返回周期数，否则返回0
+static uint32_t whole_periods(const SyncClock *sc, double dt) {
+    double periods = round(dt / sc->periodUs);
+    if (periods < 1 || periods > UINT32_MAX) {
+        return 0;
+    }
+    double tolerance = PULSE_TOLERANCE_US + periods * sc->periodUs * PULSE_TOLERANCE_PER_PERIOD;
+    if (tolerance > sc->periodUs / 4) {
+        tolerance = sc->periodUs / 4;
+    }
+    return (fabs(dt - periods * sc->periodUs) <= tolerance) ? (uint32_t)periods : 0;
+}
+
+// 不在整数周期上的脉冲t：与最近的这类脉冲中至少SYNC_CLOCK_REJECT_RUN - 1个在整数周期上时返回true
+// （参考相位跳变了，或者起点本身是干扰），否则把t记下
+static bool new_anchor(SyncClock *sc, int64_t t) {
+    uint32_t kept = (sc->candidateCount < SYNC_CLOCK_PULSES) ? sc->candidateCount : SYNC_CLOCK_PULSES;
+    uint32_t agree = 0;
+    for (uint32_t i = 0; i < kept; i++) {
+        double dt = (double)(t - sc->candidateUs[i]);
+        // 只看几个周期之内的（间隔越长容差越宽，随机的干扰越容易碰上）
+        if (dt < sc->periodUs * SYNC_CLOCK_PULSES && whole_periods(sc, dt) != 0) {
+            agree++;
+        }
+    }
+    if (agree + 1 >= SYNC_CLOCK_REJECT_RUN) {
+        sc->candidateCount = 0;
+        return true;
+    }
+    sc->candidateUs[sc->candidateCount % SYNC_CLOCK_PULSES] = t;
+    sc->candidateCount++;
+    return false;
+}
+
+typedef enum {
+    NUMBER_OK,
+    NUMBER_ANCHOR,      // 新的起点：只用于给之后的脉冲编号，不生成记录
+    NUMBER_GLITCH,
+} NumberResult;
+
+// 按与上一个有效脉冲的间隔给脉冲编号
+static NumberResult number_pulse(SyncClock *sc, int64_t t) {
+    if (!sc->havePulse) {
+        sc->havePulse = true;
+        sc->lastPulseUs = t;
+        sc->seq = 0;
+        return NUMBER_ANCHOR;
+    }
+    double dt = (double)(t - sc->lastPulseUs);
+    uint32_t n = whole_periods(sc, dt);
+    bool anchored = false;
+    if (n == 0) {
+        if (!(dt > 0) || !new_anchor(sc, t)) {
+            return NUMBER_GLITCH;
+        }
+        // 新的起点之前的几个脉冲彼此一致，它本身可以生成记录；序号按间隔取整延续
+        double periods = round(dt / sc->periodUs);
+        n = (periods < 1) ? 1 : (periods > UINT32_MAX) ? UINT32_MAX : (uint32_t)periods;
+        anchored = true;
+        restart_fit(sc);
+    }
+    sc->candidateCount = 0;
+    if (n == 1 && !anchored) {
+        sc->periodUs += (dt - sc->periodUs) / 16;
+    } else if (n > 1) {
+        sc->gap = true;
+        atomic_fetch_add_explicit(&sc->missed, n - 1, memory_order_relaxed);
+    }
+    sc->seq += n;
+    sc->lastPulseUs = t;
+    return NUMBER_OK;
+}
+
+// 拟合窗口中的脉冲位置 = a + 斜率 x 序号，返回序号seq处的位置和斜率（帧/周期）
+static void fit_window(const SyncClock *sc, uint32_t seq, double *pos, double *slope) {
+    uint32_t first = (sc->fitHead + SYNC_CLOCK_WINDOW - sc->fitCount) % SYNC_CLOCK_WINDOW;
+    uint32_t seq0 = sc->fitSeq[first];
+    double pos0 = sc->fitPos[first];
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    double n = sc->fitCount;
+    for (uint32_t i = 0; i < sc->fitCount; i++) {
+        uint32_t k = (first + i) % SYNC_CLOCK_WINDOW;
+        double x = (double)(uint32_t)(sc->fitSeq[k] - seq0);
+        double y = sc->fitPos[k] - pos0;
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    double b = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    double a = (sy - b * sx) / n;
+    *slope = b;
+    *pos = pos0 + a + b * (double)(uint32_t)(seq - seq0);
+}
+
+static int32_t clamp_i32(double v) {
+    if (v > INT32_MAX) {
+        return INT32_MAX;
+    }
+    return (v < INT32_MIN) ? INT32_MIN : (int32_t)llround(v);
+}
+
+// 检查脉冲位置是否在拟合直线上，加入拟合窗口并生成记录；偏离的脉冲返回false
+static bool add_pulse(SyncClock *sc, int64_t t, double pos, SyncIndexRecord *record) {
+    double predicted, slope;
+    if (sc->fitCount >= SYNC_CLOCK_MIN_POINTS) {
+        fit_window(sc, sc->seq, &predicted, &slope);
+        if (fabs(pos - predicted) > SYNC_CLOCK_MAX_RESIDUAL) {
+            if (++sc->rejectRun < SYNC_CLOCK_REJECT_RUN) {
+                atomic_fetch_add_explicit(&sc->outliers, 1, memory_order_relaxed);
+                return false;
+            }
+            // 连续偏离：参考脉冲的相位跳变了（例如脉冲源重启），从这个脉冲重新开始拟合
+            restart_fit(sc);
+        }
+    }
+    sc->rejectRun = 0;
+
+    sc->fitSeq[sc->fitHead] = sc->seq;
+    sc->fitPos[sc->fitHead] = pos;
+    sc->fitHead = (sc->fitHead + 1) % SYNC_CLOCK_WINDOW;
+    if (sc->fitCount < SYNC_CLOCK_WINDOW) {
+        sc->fitCount++;
+    }
+    bool locked = sc->fitCount >= SYNC_CLOCK_MIN_POINTS;
+    int32_t ratePpb = 0, residual = 0;
+    if (locked) {
+        fit_window(sc, sc->seq, &predicted, &slope);
+        ratePpb = clamp_i32((slope / sc->nominalFrames - 1.0) * 1e9);
+        residual = clamp_i32((pos - predicted) * SYNC_INDEX_POS_ONE);
+    }
+
+    double samplePos = pos - (double)sc->baseTotal * sc->dmaFrames;
+    *record = (SyncIndexRecord){
+        .seq = sc->seq,
+        .flags = (uint8_t)((locked ? SYNC_INDEX_LOCKED : 0) | (sc->gap ? SYNC_INDEX_GAP : 0) |
+                           (sc->reset ? SYNC_INDEX_RESET : 0)),
+        .points = (uint8_t)sc->fitCount,
+        .samplePos = llround(samplePos * SYNC_INDEX_POS_ONE),
+        .pulseUs = (uint64_t)t,
+        .ratePpb = ratePpb,
+        .residual = residual,
+    };
+    sc->gap = false;
+    sc->reset = false;
+
+    atomic_fetch_add_explicit(&sc->pulses, 1, memory_order_relaxed);
+    atomic_store_explicit(&sc->locked, locked, memory_order_relaxed);
+    atomic_store_explicit(&sc->ratePpb, ratePpb, memory_order_relaxed);
+    atomic_store_explicit(&sc->residual, residual, memory_order_relaxed);
+    atomic_store_explicit(&sc->lastSeq, sc->seq, memory_order_relaxed);
+    return true;
+}
+
+bool sync_clock_poll(SyncClock *sc, SyncIndexRecord *record) {
+    update_total(sc);
+    uint32_t count = atomic_load_explicit(&sc->pulseCount, memory_order_acquire);
+    while (sc->pulsesSeen != count) {
+        // 轮询太晚（例如暂停期间）时最早的脉冲已被覆盖：只处理环中还在的，编号时按间隔计入漏掉的
+        if (count - sc->pulsesSeen > SYNC_CLOCK_PULSES) {
+            sc->pulsesSeen = count - SYNC_CLOCK_PULSES;
+        }
+        int64_t t = sc->pulseUs[sc->pulsesSeen % SYNC_CLOCK_PULSES];
+        count = atomic_load_explicit(&sc->pulseCount, memory_order_acquire);
+        if (count - sc->pulsesSeen > SYNC_CLOCK_PULSES) {
+            continue;       // 读取时正被覆盖
+        }
+
+        double pos = 0;
+        LocateResult where = sc->started ? locate(sc, t, &pos) : LOCATE_STALE;
+        if (where == LOCATE_WAIT) {
+            return false;
+        }
+        sc->pulsesSeen++;
+        NumberResult numbered = number_pulse(sc, t);
+        if (numbered == NUMBER_GLITCH) {
+            atomic_fetch_add_explicit(&sc->glitches, 1, memory_order_relaxed);
+            continue;
+        }
+        if (numbered == NUMBER_ANCHOR) {
+            continue;
+        }
+        // 录音开始之前的脉冲只用于编号
+        if (where == LOCATE_STALE || pos < (double)sc->baseTotal * sc->dmaFrames) {
+            atomic_fetch_add_explicit(&sc->stale, 1, memory_order_relaxed);
+            continue;
+        }
+        if (add_pulse(sc, t, pos, record)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void sync_clock_get_status(SyncClock *sc, SyncClockStatus *status) {
+    *status = (SyncClockStatus){
+        .pulses = atomic_load_explicit(&sc->pulses, memory_order_relaxed),
+        .missed = atomic_load_explicit(&sc->missed, memory_order_relaxed),
+        .glitches = atomic_load_explicit(&sc->glitches, memory_order_relaxed),
+        .outliers = atomic_load_explicit(&sc->outliers, memory_order_relaxed),
+        .stale = atomic_load_explicit(&sc->stale, memory_order_relaxed),
+        .resets = atomic_load_explicit(&sc->resets, memory_order_relaxed),
+        .locked = atomic_load_explicit(&sc->locked, memory_order_relaxed),
+        .ratePpb = atomic_load_explicit(&sc->ratePpb, memory_order_relaxed),
+        .residual = atomic_load_explicit(&sc->residual, memory_order_relaxed),
+        .seq = atomic_load_explicit(&sc->lastSeq, memory_order_relaxed),
+    };
+}
@@ -0,0 +1,131 @@
+#ifndef SYNC_CLOCK_H
+#define SYNC_CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "SyncIndex.h"
+
+// 多板同步：把共用的参考脉冲换算到本机的样本时间轴上，并估计本机采样率相对标称值的偏差
+//
+// 两个中断各自只写一个时间戳环（都用esp_timer时间）：
+//   - I2S的on_recv：每个DMA缓冲区完成时记一次，计数c表示DMA流中前c x dmaFrames帧已经采完；
+//   - 参考脉冲输入的GPIO中断：每个上升沿记一次。
+// 采集任务在开始或恢复录音时清空驱动中积压的数据，并等到下一个缓冲区完成，此时的DMA计数就是
+// 录音第一帧所在缓冲区之前的缓冲区数（sync_clock_start），录音的样本序号从此与DMA计数一一对应。
+// 之后采集任务每块轮询一次：对每个脉冲，用它前后各SYNC_CLOCK_FIT_HALF个DMA完成时间做最小二乘直线，
+// 插值出脉冲在DMA帧流中的位置（中断延迟的抖动被平均掉，固定的延迟在各板之间相同，对齐时抵消），
+// 再对最近SYNC_CLOCK_WINDOW个脉冲的位置按脉冲序号做直线拟合：斜率 / 每周期的标称帧数 就是本机
+// 采样率与标称值之比。
+//
+// 脉冲序号按本机时间的间隔取整得到（esp_timer与I2S时钟来自同一个晶振），漏掉的脉冲也计入；
+// 偏离整数周期超过容差的脉冲是干扰，丢弃；位置偏离拟合直线超过SYNC_CLOCK_MAX_RESIDUAL帧的脉冲
+// 也丢弃。连续SYNC_CLOCK_REJECT_RUN个偏离，或者最近被当作干扰的脉冲中有SYNC_CLOCK_REJECT_RUN个彼此
+// 在整数周期上时，认为参考相位跳变了（或编号的起点本身是干扰），以当前脉冲为新的起点（序号按间隔取整
+// 延续），拟合从头开始，记录带SYNC_INDEX_RESET。随机的干扰彼此不在整数周期上，不会成为新的起点；
+// 起点本身不生成记录（还无法判断它是不是干扰）。
+//
+// 只支持一个轮询者；中断函数可在任意核心上运行。不依赖ESP-IDF，可在主机上编译（见tools/sync_bench）。
+
+#define SYNC_CLOCK_STAMPS           64      // DMA完成时间戳环（2的幂），96kHz/240帧时约160ms
+#define SYNC_CLOCK_PULSES           8       // 待处理的参考脉冲
+#define SYNC_CLOCK_FIT_HALF         8       // 插值脉冲位置时在脉冲前后各用几个DMA完成时间
+#define SYNC_CLOCK_WINDOW           32      // 估计采样率偏差的脉冲数
+#define SYNC_CLOCK_MIN_POINTS       4       // 拟合至少需要的脉冲数（之前不输出偏差，也不检查偏离）
+#define SYNC_CLOCK_MAX_RESIDUAL     2.0     // 脉冲位置偏离拟合直线的上限（帧）
+#define SYNC_CLOCK_REJECT_RUN       3       // 连续偏离几个脉冲后重新开始拟合
+#define SYNC_CLOCK_MIN_PERIOD_MS    100
+#define SYNC_CLOCK_MAX_PERIOD_MS    60000
+
+typedef struct {
+    uint32_t pulses;                // 换算出位置的脉冲
+    uint32_t missed;                // 漏掉的脉冲（按间隔推算）
+    uint32_t glitches;              // 不在整数周期上的脉冲（干扰）
+    uint32_t outliers;              // 偏离拟合直线的脉冲
+    uint32_t stale;                 // 不在录音中或DMA时间戳已被覆盖，未换算位置的脉冲
+    uint32_t resets;                // 拟合重新开始的次数
+    bool locked;                    // 拟合点数足够
+    int32_t ratePpb;                // 本机采样率偏差 (实际/标称 - 1) x 1e9
+    int32_t residual;               // 最近一个脉冲的偏离，单位1/65536帧
+    uint32_t seq;                   // 最近一个脉冲的序号
+} SyncClockStatus;
+
+typedef struct {
+    // 中断写入：先写时间戳再递增计数（release），计数为c的时间戳在下标 c % 环大小
+    int64_t stampUs[SYNC_CLOCK_STAMPS];
+    atomic_uint dmaCount;
+    int64_t pulseUs[SYNC_CLOCK_PULSES];
+    atomic_uint pulseCount;
+
+    // 以下只由轮询者访问（init在中断开始之前调用）
+    uint32_t sampleRate;
+    uint32_t dmaFrames;             // 每个DMA缓冲区的帧数
+    uint32_t periodMs;              // 参考脉冲的标称周期
+    double nominalFrames;           // 每个标称周期的帧数
+    uint32_t countSeen;             // 最近一次读到的DMA计数
+    uint64_t dmaTotal;              // countSeen对应的64位计数（32位计数在96kHz下约124天回绕）
+    uint64_t baseTotal;             // 录音第一帧之前已完成的DMA缓冲区数
+    bool started;                   // 正在录音（样本序号与DMA计数已对应）
+    uint32_t pulsesSeen;            // 已处理到的脉冲计数
+    bool havePulse;
+    int64_t lastPulseUs;            // 上一个有效脉冲的时间
+    int64_t candidateUs[SYNC_CLOCK_PULSES];  // 最近被当作干扰的脉冲（环），用于判断参考相位是否跳变
+    uint32_t candidateCount;
+    double periodUs;                // 本机时间下的脉冲周期
+    uint32_t seq;
+    bool gap;                       // 上一个有效脉冲之后有漏掉的脉冲（下一条记录带SYNC_INDEX_GAP）
+    uint32_t fitSeq[SYNC_CLOCK_WINDOW];     // 拟合窗口（环）：脉冲序号和在DMA帧流中的位置
+    double fitPos[SYNC_CLOCK_WINDOW];
+    uint32_t fitHead;
+    uint32_t fitCount;
+    uint32_t rejectRun;
+    bool reset;                     // 下一条记录带SYNC_INDEX_RESET
+
+    // 统计：轮询者写入，任意任务可无锁读取
+    atomic_uint pulses;
+    atomic_uint missed;
+    atomic_uint glitches;
+    atomic_uint outliers;
+    atomic_uint stale;
+    atomic_uint resets;
+    atomic_bool locked;
+    atomic_int ratePpb;
+    atomic_int residual;
+    atomic_uint lastSeq;
+} SyncClock;
+
+// 清零并设置格式（中断开始之前调用）；周期超出SYNC_CLOCK_MIN/MAX_PERIOD_MS或参数为0时返回false
+bool sync_clock_init(SyncClock *sc, uint32_t sampleRate, uint32_t dmaFrames, uint32_t periodMs);
+
+// 中断：一个DMA缓冲区完成
+static inline void sync_clock_dma_done(SyncClock *sc, int64_t nowUs) {
+    uint32_t c = atomic_load_explicit(&sc->dmaCount, memory_order_relaxed) + 1;
+    sc->stampUs[c % SYNC_CLOCK_STAMPS] = nowUs;
+    atomic_store_explicit(&sc->dmaCount, c, memory_order_release);
+}
+
+// 中断：收到一个参考脉冲
+static inline void sync_clock_pulse(SyncClock *sc, int64_t nowUs) {
+    uint32_t c = atomic_load_explicit(&sc->pulseCount, memory_order_relaxed);
+    sc->pulseUs[c % SYNC_CLOCK_PULSES] = nowUs;
+    atomic_store_explicit(&sc->pulseCount, c + 1, memory_order_release);
+}
+
+// 当前的DMA完成计数
+static inline uint32_t sync_clock_dma_count(SyncClock *sc) {
+    return atomic_load_explicit(&sc->dmaCount, memory_order_acquire);
+}
+
+// 开始录音：录音的第一帧是计数达到dmaCount + 1时完成的缓冲区的第一帧
+void sync_clock_start(SyncClock *sc, uint32_t dmaCount);
+// 停止录音（之后的脉冲只更新序号，不换算位置）
+void sync_clock_stop(SyncClock *sc);
+
+// 处理待处理的脉冲：换算出一个脉冲的位置时填写record并返回true（每次最多一条）。
+// 脉冲之后的DMA完成时间还不够时留到下一次
+bool sync_clock_poll(SyncClock *sc, SyncIndexRecord *record);
+
+// 读取统计（任意任务，无锁）
+void sync_clock_get_status(SyncClock *sc, SyncClockStatus *status);
+
+#endif /* SYNC_CLOCK_H */
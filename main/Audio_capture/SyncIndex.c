@@ -0,0 +1,73 @@
+#include "SyncIndex.h"
+#include <string.h>
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+void sync_index_build_header(uint8_t *out, const SyncIndexInfo *info) {
+    memset(out, 0, SYNC_INDEX_HEADER_BYTES);
+    memcpy(out, "SIDX", 4);
+    put_u16(out + 4, SYNC_INDEX_VERSION);
+    put_u16(out + 6, SYNC_INDEX_HEADER_BYTES);
+    put_u16(out + 8, SYNC_INDEX_RECORD_BYTES);
+    put_u32(out + 12, info->sampleRate);
+    put_u32(out + 16, info->periodMs);
+    put_u64(out + 24, info->startUs);
+}
+
+bool sync_index_parse_header(const uint8_t *buf, size_t len, SyncIndexInfo *info) {
+    if (len < 32 || memcmp(buf, "SIDX", 4) != 0 || get_u16(buf + 4) != SYNC_INDEX_VERSION ||
+        get_u16(buf + 6) != SYNC_INDEX_HEADER_BYTES || get_u16(buf + 8) != SYNC_INDEX_RECORD_BYTES) {
+        return false;
+    }
+
+    info->sampleRate = get_u32(buf + 12);
+    info->periodMs = get_u32(buf + 16);
+    info->startUs = get_u64(buf + 24);
+    return info->sampleRate > 0 && info->periodMs > 0;
+}
+
+void sync_index_encode(uint8_t *out, const SyncIndexRecord *record) {
+    put_u32(out, record->seq);
+    out[4] = record->flags;
+    out[5] = record->points;
+    put_u16(out + 6, 0);
+    put_u64(out + 8, (uint64_t)record->samplePos);
+    put_u64(out + 16, record->pulseUs);
+    put_u32(out + 24, (uint32_t)record->ratePpb);
+    put_u32(out + 28, (uint32_t)record->residual);
+}
+
+void sync_index_decode(const uint8_t *buf, SyncIndexRecord *record) {
+    record->seq = get_u32(buf);
+    record->flags = buf[4];
+    record->points = buf[5];
+    record->samplePos = (int64_t)get_u64(buf + 8);
+    record->pulseUs = get_u64(buf + 16);
+    record->ratePpb = (int32_t)get_u32(buf + 24);
+    record->residual = (int32_t)get_u32(buf + 28);
+}
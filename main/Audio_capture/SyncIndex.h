@@ -0,0 +1,78 @@
+#ifndef SYNC_INDEX_H
+#define SYNC_INDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 同步索引文件（.SYN）：多块板子共用一路参考脉冲时与录音文件同名，每个参考脉冲一条定长记录
+//
+// 每块板子的I2S时钟各自独立，采样率与标称值相差几十ppm，长时间录音后各板之间会差出几十个样本。
+// SyncClock把参考脉冲换算到本机录音的样本时间轴上（与块索引的firstSample相同，开始录音后的第几帧，
+// 含溢出丢失的帧，文件轮转时延续），并拟合出本机采样率相对标称值的偏差。离线对齐时：
+//   第seq个脉冲在参考时间轴上的时刻是 seq x periodMs，在本机上位于样本samplePos；
+//   相邻两条记录之间按样本线性插值，就得到本机每个样本在参考时间轴上的时刻，按它重采样即可。
+// seq从本机上电后收到的第一个脉冲开始计数（漏掉的脉冲也计入）。所有板子先上电、再启动脉冲源时
+// 各板的seq相同；否则各板之间相差整数个周期，用录音内容粗对齐到半个周期以内即可确定。
+// 参考相位跳变后（记录带SYNC_INDEX_RESET）seq按间隔取整延续，跳变前后的记录需要分别对齐。
+//
+// 记录由采集任务在脉冲之后约TDM_DMA_FRAME_NUM x 8帧时算出，随当时的块写入，所以轮转后新文件中
+// 的第一条记录可能位于该文件第一块之前；事件录音模式下，未写出的预录块上的记录随块一起丢弃。
+//
+// 头部固定为SYNC_INDEX_HEADER_BYTES(512)字节，之后是连续的记录（小端）：
+//   头部:
+//   0   "SIDX"
+//   4   version(u16) headerBytes(u16)
+//   8   recordBytes(u16) 保留(u16)
+//   12  sampleRate(u32)       标称采样率
+//   16  periodMs(u32)         参考脉冲的标称周期
+//   20  保留(u32)
+//   24  startUs(u64)          打开文件时的esp_timer时间
+//   32  保留，全0
+//   记录k（32字节）:
+//   0   seq(u32)              参考脉冲序号
+//   4   flags(u8)             SYNC_INDEX_*
+//   5   points(u8)            拟合用到的脉冲数
+//   6   保留(u16)
+//   8   samplePos(i64)        脉冲在录音样本时间轴上的位置，单位1/65536帧
+//   16  pulseUs(u64)          脉冲到达的esp_timer时间
+//   24  ratePpb(i32)          拟合出的本机采样率偏差：(实际/标称 - 1) x 1e9
+//   28  residual(i32)         本脉冲相对拟合直线的偏差，单位1/65536帧
+//
+// 不依赖ESP-IDF，可在主机上编译。
+
+#define SYNC_INDEX_HEADER_BYTES     512
+#define SYNC_INDEX_RECORD_BYTES     32
+#define SYNC_INDEX_VERSION          1
+#define SYNC_INDEX_POS_ONE          65536   // samplePos/residual中的一帧
+
+#define SYNC_INDEX_LOCKED           (1u << 0)   // 拟合点数足够，ratePpb有效
+#define SYNC_INDEX_GAP              (1u << 1)   // 与上一个处理的脉冲之间有漏掉的脉冲
+#define SYNC_INDEX_RESET            (1u << 2)   // 拟合重新开始（参考脉冲的相位跳变）
+
+typedef struct {
+    uint32_t sampleRate;
+    uint32_t periodMs;
+    uint64_t startUs;
+} SyncIndexInfo;
+
+typedef struct {
+    uint32_t seq;
+    uint8_t flags;
+    uint8_t points;
+    int64_t samplePos;
+    uint64_t pulseUs;
+    int32_t ratePpb;
+    int32_t residual;
+} SyncIndexRecord;
+
+// 生成SYNC_INDEX_HEADER_BYTES字节的头部
+void sync_index_build_header(uint8_t *out, const SyncIndexInfo *info);
+// 解析文件开头的头部
+bool sync_index_parse_header(const uint8_t *buf, size_t len, SyncIndexInfo *info);
+
+// 编码/解码一条SYNC_INDEX_RECORD_BYTES字节的记录
+void sync_index_encode(uint8_t *out, const SyncIndexRecord *record);
+void sync_index_decode(const uint8_t *buf, SyncIndexRecord *record);
+
+#endif /* SYNC_INDEX_H */
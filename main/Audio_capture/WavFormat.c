@@ -0,0 +1,152 @@
+#include "WavFormat.h"
+#include <string.h>
+
+#define WAV_DS64_OFFSET     12
+#define WAV_DS64_PAYLOAD    28
+#define WAV_FMT_OFFSET      (WAV_DS64_OFFSET + 8 + WAV_DS64_PAYLOAD)
+#define WAV_FMT_PAYLOAD     40
+#define WAV_PAD_OFFSET      (WAV_FMT_OFFSET + 8 + WAV_FMT_PAYLOAD)
+#define WAV_DATA_OFFSET     (WAV_HEADER_BYTES - 8)
+
+// KSDATAFORMAT_SUBTYPE_PCM {00000001-0000-0010-8000-00AA00389B71}
+static const uint8_t pcmSubFormat[16] = {
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+    0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71
+};
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+static void put_chunk(uint8_t *p, const char *id, uint32_t size) {
+    memcpy(p, id, 4);
+    put_u32(p + 4, size);
+}
+
+bool wav_build_header(uint8_t *out, const WavFormat *format, uint64_t dataBytes) {
+    if (format->channels == 0 || format->containerBits % 8 != 0 ||
+        format->validBits > format->containerBits) {
+        return false;
+    }
+
+    // RIFF大小不含开头8字节，奇数长度的data块需要一个填充字节
+    uint64_t riffSize = WAV_HEADER_BYTES - 8 + dataBytes + (dataBytes & 1);
+    bool rf64 = riffSize > 0xFFFFFFFFull;
+    uint32_t blockAlign = wav_block_align(format);
+
+    memset(out, 0, WAV_HEADER_BYTES);
+
+    put_chunk(out, rf64 ? "RF64" : "RIFF", rf64 ? 0xFFFFFFFFu : (uint32_t)riffSize);
+    memcpy(out + 8, "WAVE", 4);
+
+    // ds64在RIFF文件中以JUNK形式预留，超过4GB时原地改写
+    uint8_t *ds64 = out + WAV_DS64_OFFSET;
+    put_chunk(ds64, rf64 ? "ds64" : "JUNK", WAV_DS64_PAYLOAD);
+    if (rf64) {
+        put_u64(ds64 + 8, riffSize);
+        put_u64(ds64 + 16, dataBytes);
+        put_u64(ds64 + 24, blockAlign ? dataBytes / blockAlign : 0);
+        put_u32(ds64 + 32, 0);  // table length
+    }
+
+    uint8_t *fmt = out + WAV_FMT_OFFSET;
+    put_chunk(fmt, "fmt ", WAV_FMT_PAYLOAD);
+    put_u16(fmt + 8, WAV_FORMAT_EXTENSIBLE);
+    put_u16(fmt + 10, format->channels);
+    put_u32(fmt + 12, format->sampleRate);
+    put_u32(fmt + 16, format->sampleRate * blockAlign);
+    put_u16(fmt + 20, (uint16_t)blockAlign);
+    put_u16(fmt + 22, format->containerBits);
+    put_u16(fmt + 24, 22);  // cbSize
+    put_u16(fmt + 26, format->validBits);
+    put_u32(fmt + 28, format->channelMask);
+    memcpy(fmt + 32, pcmSubFormat, sizeof(pcmSubFormat));
+
+    put_chunk(out + WAV_PAD_OFFSET, "JUNK", WAV_DATA_OFFSET - WAV_PAD_OFFSET - 8);
+
+    put_chunk(out + WAV_DATA_OFFSET, "data", rf64 ? 0xFFFFFFFFu : (uint32_t)dataBytes);
+    return true;
+}
+
+bool wav_parse_header(const uint8_t *buf, size_t len, WavInfo *info) {
+    if (len < 12 || memcmp(buf + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+
+    memset(info, 0, sizeof(*info));
+    if (memcmp(buf, "RF64", 4) == 0) {
+        info->rf64 = true;
+    } else if (memcmp(buf, "RIFF", 4) != 0) {
+        return false;
+    }
+
+    uint64_t ds64DataBytes = 0;
+    bool haveFmt = false;
+    size_t pos = 12;
+
+    // 依次遍历子块直到data块
+    while (pos + 8 <= len) {
+        const uint8_t *chunk = buf + pos;
+        uint32_t size = get_u32(chunk + 4);
+        const uint8_t *payload = chunk + 8;
+
+        if (memcmp(chunk, "data", 4) == 0) {
+            if (!haveFmt) {
+                return false;
+            }
+            info->dataOffset = pos + 8;
+            info->dataBytes = (info->rf64 && size == 0xFFFFFFFFu) ? ds64DataBytes : size;
+            return true;
+        }
+
+        if (pos + 8 + size > len) {
+            return false;
+        }
+
+        if (memcmp(chunk, "ds64", 4) == 0 && size >= 24) {
+            ds64DataBytes = get_u64(payload + 8);
+        } else if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            uint16_t tag = get_u16(payload);
+            info->format.channels = get_u16(payload + 2);
+            info->format.sampleRate = get_u32(payload + 4);
+            info->format.containerBits = get_u16(payload + 14);
+            info->format.validBits = info->format.containerBits;
+            if (tag == WAV_FORMAT_EXTENSIBLE && size >= 40) {
+                if (memcmp(payload + 24, pcmSubFormat, sizeof(pcmSubFormat)) != 0) {
+                    return false;
+                }
+                info->format.validBits = get_u16(payload + 18);
+                info->format.channelMask = get_u32(payload + 20);
+            } else if (tag != WAV_FORMAT_PCM) {
+                return false;
+            }
+            haveFmt = true;
+        }
+
+        pos += 8 + size + (size & 1);
+    }
+    return false;
+}
@@ -0,0 +1,50 @@
+#ifndef WAV_FORMAT_H
+#define WAV_FORMAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 多通道WAV/RF64容器
+//
+// 头部固定为WAV_HEADER_BYTES(512)字节，使data块的载荷从扇区边界开始，
+// 文件可以直接按偏移mmap。布局：
+//   0   RIFF/RF64 + size + WAVE
+//   12  JUNK/ds64 (28字节载荷，超过4GB时由JUNK改写为ds64)
+//   48  fmt  (WAVE_FORMAT_EXTENSIBLE, 40字节载荷)
+//   96  JUNK (填充)
+//   504 data + size
+//   512 PCM数据（交织）
+//
+// 录音过程中数据长度未知，写入时先用0占位，在检查点和停止时重新生成头部覆盖。
+// 不依赖ESP-IDF，可在主机上编译。
+
+#define WAV_HEADER_BYTES        512
+#define WAV_FORMAT_PCM          0x0001
+#define WAV_FORMAT_EXTENSIBLE   0xFFFE
+
+typedef struct {
+    uint32_t sampleRate;
+    uint16_t channels;
+    uint16_t containerBits;     // 每个样本占用的位数（16/24/32）
+    uint16_t validBits;         // 有效位数
+    uint32_t channelMask;       // 扬声器位置掩码，麦克风阵列为0（无映射）
+} WavFormat;
+
+typedef struct {
+    WavFormat format;
+    bool rf64;
+    uint64_t dataOffset;        // data载荷在文件中的偏移
+    uint64_t dataBytes;         // data载荷长度
+} WavInfo;
+
+// 生成WAV_HEADER_BYTES字节的头部，dataBytes超过RIFF上限时自动使用RF64
+bool wav_build_header(uint8_t *out, const WavFormat *format, uint64_t dataBytes);
+// 解析文件开头的头部（len至少要覆盖到data块头），支持RIFF和RF64
+bool wav_parse_header(const uint8_t *buf, size_t len, WavInfo *info);
+// 每个采样帧的字节数
+static inline uint32_t wav_block_align(const WavFormat *format) {
+    return (uint32_t)format->channels * (format->containerBits / 8);
+}
+
+#endif /* WAV_FORMAT_H */
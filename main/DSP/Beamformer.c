@@ -0,0 +1,178 @@
+#include "Beamformer.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DSP_PI  3.14159265358979323846
+
+// 分数延迟滤波器的中心抽头：输出额外延迟这么多个样本，整数延迟因此总是非负
+#define CENTER_TAP  (BEAMFORMER_TAPS / 2 - 1)
+
+static inline int16_t sat16(int32_t v) {
+    return (v > INT16_MAX) ? INT16_MAX : (v < INT16_MIN) ? INT16_MIN : (int16_t)v;
+}
+
+// 延迟mu个样本（mu在[CENTER_TAP, CENTER_TAP + 1)内）的Blackman窗sinc，量化为Q15并乘以gain。
+// 量化后的系数之和等于round(32768 x gain)，直流增益准确
+static void design_fraction(double mu, double gain, int16_t *coef) {
+    double h[BEAMFORMER_TAPS];
+    double sum = 0;
+    for (int k = 0; k < BEAMFORMER_TAPS; k++) {
+        double t = k - mu;
+        double sinc = (fabs(t) < 1e-9) ? 1.0 : sin(DSP_PI * t) / (DSP_PI * t);
+        double w = 0.42 + 0.5 * cos(2.0 * DSP_PI * t / BEAMFORMER_TAPS) +
+                   0.08 * cos(4.0 * DSP_PI * t / BEAMFORMER_TAPS);
+        h[k] = sinc * w;
+        sum += h[k];
+    }
+
+    int32_t target = (int32_t)lround(32768.0 * gain);
+    int32_t total = 0;
+    int peak = 0;
+    for (int k = 0; k < BEAMFORMER_TAPS; k++) {
+        long q = lround(h[k] / sum * 32768.0 * gain);
+        coef[k] = (q > INT16_MAX) ? INT16_MAX : (q < INT16_MIN) ? INT16_MIN : (int16_t)q;
+        total += coef[k];
+        peak = (abs(coef[k]) > abs(coef[peak])) ? k : peak;
+    }
+    // 舍入误差加到最大的抽头上
+    int32_t fixed = coef[peak] + (target - total);
+    coef[peak] = sat16(fixed);
+}
+
+bool beamformer_init(Beamformer *bf, const BeamformerConfig *config, float sampleRate, uint32_t slotMask,
+                     uint32_t maxFrames) {
+    memset(bf, 0, sizeof(*bf));
+    float c = (config->soundSpeed > 0.0f) ? config->soundSpeed : BEAMFORMER_SOUND_SPEED;
+    if (config->beams == 0 || config->beams > BEAMFORMER_MAX_BEAMS || sampleRate <= 0.0f || maxFrames == 0 ||
+        slotMask == 0 || (slotMask >> BEAMFORMER_MAX_MICS) != 0) {
+        return false;
+    }
+
+    // 参与的麦克风（按槽位顺序）和阵列半径
+    BeamformerPoint pos[BEAMFORMER_MAX_MICS];
+    double radius = 0;
+    for (uint32_t slot = 0; slot < BEAMFORMER_MAX_MICS; slot++) {
+        if (slotMask & (1u << slot)) {
+            const BeamformerPoint *p = &config->mic[slot];
+            if (!isfinite(p->x) || !isfinite(p->y) || !isfinite(p->z)) {
+                return false;
+            }
+            pos[bf->mics++] = *p;
+            double r = sqrt((double)p->x * p->x + (double)p->y * p->y + (double)p->z * p->z);
+            radius = (r > radius) ? r : radius;
+        }
+    }
+    double framesPerMeter = sampleRate / c;
+    if (2.0 * radius * framesPerMeter + 1 > BEAMFORMER_MAX_DELAY) {
+        return false;
+    }
+
+    // 每个波束、每路麦克风的延迟：(p·u + R)/c，整数部分偏移读取位置，小数部分由FIR实现
+    uint32_t maxDelay = 0;
+    double gain = 1.0 / bf->mics;
+    for (uint32_t b = 0; b < config->beams; b++) {
+        double az = config->azimuthDeg[b] * DSP_PI / 180.0;
+        double el = config->elevationDeg[b] * DSP_PI / 180.0;
+        if (!isfinite(az) || !isfinite(el)) {
+            return false;
+        }
+        double ux = cos(el) * cos(az), uy = cos(el) * sin(az), uz = sin(el);
+        for (uint32_t m = 0; m < bf->mics; m++) {
+            double proj = pos[m].x * ux + pos[m].y * uy + pos[m].z * uz;
+            double d = (proj + radius) * framesPerMeter;
+            d = (d < 0) ? 0 : d;
+            double whole = floor(d);
+            bf->delay[b][m] = (uint16_t)whole;
+            design_fraction(CENTER_TAP + (d - whole), gain, bf->coef[b][m]);
+            maxDelay = (bf->delay[b][m] > maxDelay) ? bf->delay[b][m] : maxDelay;
+        }
+    }
+    bf->beams = config->beams;
+    bf->maxFrames = maxFrames;
+    bf->history = maxDelay + BEAMFORMER_TAPS - 1;
+    bf->latencyFrames = (float)(radius * framesPerMeter + CENTER_TAP);
+
+    bf->planar = malloc((size_t)bf->mics * (bf->history + maxFrames) * sizeof(int16_t));
+    bf->acc = malloc((size_t)maxFrames * sizeof(int32_t));
+    if (bf->planar == NULL || bf->acc == NULL) {
+        beamformer_deinit(bf);
+        return false;
+    }
+    beamformer_reset(bf);
+    return true;
+}
+
+void beamformer_deinit(Beamformer *bf) {
+    free(bf->planar);
+    free(bf->acc);
+    bf->planar = NULL;
+    bf->acc = NULL;
+}
+
+void beamformer_reset(Beamformer *bf) {
+    if (bf->planar != NULL) {
+        memset(bf->planar, 0, (size_t)bf->mics * (bf->history + bf->maxFrames) * sizeof(int16_t));
+    }
+}
+
+// acc[n] += sum(h[k] x x[n - k])，x已按整数延迟偏移；抽头展开，内层循环可以向量化
+static void accumulate(int32_t *acc, const int16_t *x, const int16_t *h, uint32_t frames) {
+    const int32_t h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3];
+    const int32_t h4 = h[4], h5 = h[5], h6 = h[6], h7 = h[7];
+    for (uint32_t n = 0; n < frames; n++) {
+        const int16_t *s = x + n;
+        acc[n] += h0 * s[0] + h1 * s[-1] + h2 * s[-2] + h3 * s[-3] +
+                  h4 * s[-4] + h5 * s[-5] + h6 * s[-6] + h7 * s[-7];
+    }
+}
+_Static_assert(BEAMFORMER_TAPS == 8, "accumulate() is unrolled for 8 taps");
+
+void beamformer_process(Beamformer *bf, const int16_t *in, uint32_t frames, int16_t *out) {
+    const uint32_t mics = bf->mics, beams = bf->beams, history = bf->history;
+    const uint32_t stride = history + bf->maxFrames;
+    if (frames > bf->maxFrames) {
+        frames = bf->maxFrames;
+    }
+
+    // 解交织到各路历史样本之后
+    for (uint32_t m = 0; m < mics; m++) {
+        int16_t *dst = bf->planar + (size_t)m * stride + history;
+        const int16_t *src = in + m;
+        for (uint32_t n = 0; n < frames; n++) {
+            dst[n] = src[(size_t)n * mics];
+        }
+    }
+
+    for (uint32_t b = 0; b < beams; b++) {
+        int32_t *acc = bf->acc;
+        memset(acc, 0, frames * sizeof(int32_t));
+        for (uint32_t m = 0; m < mics; m++) {
+            const int16_t *x = bf->planar + (size_t)m * stride + history - bf->delay[b][m];
+            accumulate(acc, x, bf->coef[b][m], frames);
+        }
+        int16_t *dst = out + b;
+        for (uint32_t n = 0; n < frames; n++) {
+            dst[(size_t)n * beams] = sat16((acc[n] + (1 << 14)) >> 15);
+        }
+    }
+
+    // 保留每路最后history个样本给下一块
+    for (uint32_t m = 0; m < mics; m++) {
+        int16_t *ch = bf->planar + (size_t)m * stride;
+        memmove(ch, ch + frames, history * sizeof(int16_t));
+    }
+}
+
+void beamformer_circular_array(BeamformerConfig *config, uint32_t mics, float radius) {
+    for (uint32_t m = 0; m < mics && m < BEAMFORMER_MAX_MICS; m++) {
+        double a = 2.0 * DSP_PI * m / mics;
+        config->mic[m] = (BeamformerPoint){ (float)(radius * cos(a)), (float)(radius * sin(a)), 0.0f };
+    }
+}
+
+void beamformer_linear_array(BeamformerConfig *config, uint32_t mics, float spacing) {
+    for (uint32_t m = 0; m < mics && m < BEAMFORMER_MAX_MICS; m++) {
+        config->mic[m] = (BeamformerPoint){ (float)((m - (mics - 1) / 2.0) * spacing), 0.0f, 0.0f };
+    }
+}
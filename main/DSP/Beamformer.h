@@ -0,0 +1,68 @@
+#ifndef BEAMFORMER_H
+#define BEAMFORMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 定点延迟求和波束形成：把交织的多路麦克风信号按阵列几何和指向合成为几路单声道波束
+//
+// 平面波从方向u到达时，位置p的麦克风比阵列原点早 p·u/c 收到。每个波束给每路麦克风延迟
+// (p·u + R)/c（R为离原点最远的麦克风的距离，所有波束的延迟都在[0, 2R/c]内，彼此时间对齐），
+// 再求平均：来自指向的声音同相叠加，其他方向的声音和各路不相关的噪声被削弱。
+//
+// 延迟的整数部分直接偏移读取位置，小数部分用BEAMFORMER_TAPS抽头的分数延迟FIR（Blackman窗sinc，
+// 中心在第TAPS/2-1抽头附近，因此输出比阵列原点处的声音晚 R/c + TAPS/2-1 个样本）。
+// 系数为Q15并已乘以1/麦克风数，每个输出样本的所有乘积累加在一个int32中（系数绝对值之和约为1.2，
+// 不会溢出），最后四舍五入、饱和为int16。各路麦克风的历史样本保存在平面缓冲区中，块与块之间连续。
+//
+// 运算量为 波束数 x 麦克风数 x TAPS 次乘加/帧（8麦克风4波束96kHz时约2500万次/秒）。
+// 不依赖ESP-IDF，可在主机上编译（见tools/beam_bench）。
+
+#define BEAMFORMER_MAX_MICS     16
+#define BEAMFORMER_MAX_BEAMS    16
+#define BEAMFORMER_TAPS         8
+#define BEAMFORMER_MAX_DELAY    512     // 最大延迟（样本），限制阵列尺寸：96kHz时约1.8m
+#define BEAMFORMER_SOUND_SPEED  343.0f  // 20°C空气中的声速（m/s）
+
+typedef struct {
+    float x, y, z;                  // 米
+} BeamformerPoint;
+
+typedef struct {
+    BeamformerPoint mic[BEAMFORMER_MAX_MICS];   // 每个TDM槽位的麦克风位置
+    uint32_t beams;                             // 1..BEAMFORMER_MAX_BEAMS
+    float azimuthDeg[BEAMFORMER_MAX_BEAMS];     // 水平角：0为+x方向，逆时针转向+y
+    float elevationDeg[BEAMFORMER_MAX_BEAMS];   // 仰角：0为水平面，90为+z方向
+    float soundSpeed;                           // m/s，0: BEAMFORMER_SOUND_SPEED
+} BeamformerConfig;
+
+typedef struct {
+    uint32_t mics;
+    uint32_t beams;
+    uint32_t maxFrames;             // 每次处理的最大帧数
+    uint32_t history;               // 每路保留的历史样本数（最大整数延迟 + TAPS - 1）
+    float latencyFrames;            // 输出相对阵列原点的延迟（样本）
+    uint16_t delay[BEAMFORMER_MAX_BEAMS][BEAMFORMER_MAX_MICS];                  // 整数延迟
+    int16_t coef[BEAMFORMER_MAX_BEAMS][BEAMFORMER_MAX_MICS][BEAMFORMER_TAPS];   // Q15，含1/麦克风数
+    int16_t *planar;                // mics x (history + maxFrames)
+    int32_t *acc;                   // maxFrames
+} Beamformer;
+
+// 按配置计算延迟和系数并分配缓冲区。slotMask选出参与的槽位（输入的通道按槽位从小到大排列），
+// 几何或指向无效、阵列太大或分配失败时返回false
+bool beamformer_init(Beamformer *bf, const BeamformerConfig *config, float sampleRate, uint32_t slotMask,
+                     uint32_t maxFrames);
+void beamformer_deinit(Beamformer *bf);
+// 清除历史样本（开始新的录音时调用）
+void beamformer_reset(Beamformer *bf);
+
+// in为frames帧mics通道交织的int16，out为frames帧beams通道交织的int16（frames <= maxFrames）。
+// 输入先全部复制到平面缓冲区，out可以与in相同（原地处理）
+void beamformer_process(Beamformer *bf, const int16_t *in, uint32_t frames, int16_t *out);
+
+// 常用几何：mics个麦克风均匀分布在xy平面上半径radius的圆上（第0个在+x方向，逆时针），
+// 或沿x轴间距spacing的直线上（以原点为中心）
+void beamformer_circular_array(BeamformerConfig *config, uint32_t mics, float radius);
+void beamformer_linear_array(BeamformerConfig *config, uint32_t mics, float spacing);
+
+#endif /* BEAMFORMER_H */
@@ -0,0 +1,290 @@
+#include "Decimator.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DSP_PI  3.14159265358979323846
+
+// 设计时的阻带衰减：比DECIMATOR_STOPBAND_DB多留出Q15量化的余量
+#define DESIGN_ATTEN_DB     80.0
+
+static inline int16_t sat16(int32_t v) {
+    return (v > INT16_MAX) ? INT16_MAX : (v < INT16_MIN) ? INT16_MIN : (int16_t)v;
+}
+
+// 第一类零阶修正贝塞尔函数（Kaiser窗）
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// 按抽取比设计一级的Kaiser窗sinc：截止频率为输出采样率的一半，过渡带宽(1 - 2 x PASSBAND)/factor
+// （相对输入采样率）。半带（factor 2）的长度取4k - 1，除中心外偶数距离上的系数为0。
+// 量化为Q15后直流增益准确为1：半带的中心固定为16384，其余的舍入误差加到最大的一对系数上
+static bool design_stage(DecimatorStage *s, uint32_t factor) {
+    double width = (1.0 - 2.0 * DECIMATOR_PASSBAND) / factor;
+    uint32_t taps = (uint32_t)ceil((DESIGN_ATTEN_DB - 7.95) / (14.36 * width)) + 1;
+    taps = (factor == 2) ? (taps + 4) / 4 * 4 - 1 : taps | 1u;
+    uint32_t c = (taps - 1) / 2;
+    double beta = 0.1102 * (DESIGN_ATTEN_DB - 8.7);
+    double fc = 0.5 / factor;
+
+    s->factor = factor;
+    s->taps = taps;
+    s->history = taps - 1;
+    s->coef = malloc(c * sizeof(int16_t));
+    s->offset = malloc(c * sizeof(uint16_t));
+    if (s->coef == NULL || s->offset == NULL) {
+        return false;
+    }
+
+    // 对称的一半：距离中心d的系数
+    double h0 = 2.0 * fc, sum = h0;
+    double *h = malloc((c + 1) * sizeof(double));
+    if (h == NULL) {
+        return false;
+    }
+    h[0] = h0;
+    for (uint32_t d = 1; d <= c; d++) {
+        double t = (double)d / c;
+        double w = bessel_i0(beta * sqrt(1.0 - t * t)) / bessel_i0(beta);
+        h[d] = sin(2.0 * DSP_PI * fc * d) / (DSP_PI * d) * w;
+        sum += 2.0 * h[d];
+    }
+
+    int32_t total = 0;
+    uint32_t peak = 0;
+    s->pairs = 0;
+    for (uint32_t d = 1; d <= c; d++) {
+        if (factor == 2 && (d & 1u) == 0) {
+            continue;
+        }
+        long q = lround(h[d] / sum * 32768.0);
+        s->coef[s->pairs] = sat16((int32_t)q);
+        s->offset[s->pairs] = (uint16_t)d;
+        total += 2 * s->coef[s->pairs];
+        peak = (abs(s->coef[s->pairs]) > abs(s->coef[peak])) ? s->pairs : peak;
+        s->pairs++;
+    }
+    if (factor == 2) {
+        // 两个系数的舍入误差之和总是偶数
+        s->center = 16384;
+        s->coef[peak] = sat16(s->coef[peak] + (16384 - total) / 2);
+    } else {
+        s->center = sat16(32768 - total);
+    }
+    free(h);
+    return true;
+}
+
+// 找到或新建一级（父级和抽取比都相同的级共用），返回下标，级数用完时返回-1
+static int32_t add_stage(Decimator *d, int32_t parent, uint32_t factor) {
+    for (uint32_t i = 0; i < d->stages; i++) {
+        if (d->stage[i].parent == parent && d->stage[i].factor == factor) {
+            return (int32_t)i;
+        }
+    }
+    if (d->stages == DECIMATOR_MAX_STAGES) {
+        return -1;
+    }
+    DecimatorStage *s = &d->stage[d->stages];
+    s->parent = parent;
+    if (!design_stage(s, factor)) {
+        return -1;
+    }
+    s->maxIn = (parent < 0) ? d->maxFrames : d->stage[parent].maxOut;
+    s->maxOut = (s->maxIn + factor - 1) / factor;
+    s->in = malloc((size_t)d->channels * (s->history + s->maxIn) * sizeof(int16_t));
+    s->out = malloc((size_t)d->channels * s->maxOut * sizeof(int16_t));
+    if (s->in == NULL || s->out == NULL) {
+        return -1;
+    }
+    return (int32_t)d->stages++;
+}
+
+bool decimator_init(Decimator *d, const DecimatorConfig *config, uint32_t sampleRate, uint32_t channels,
+                    uint32_t maxFrames) {
+    memset(d, 0, sizeof(*d));
+    if (config->outputs > DECIMATOR_MAX_OUTPUTS || sampleRate == 0 || channels == 0 ||
+        channels > DECIMATOR_MAX_CHANNELS || maxFrames == 0) {
+        return false;
+    }
+    d->channels = channels;
+    d->sampleRate = sampleRate;
+    d->maxFrames = maxFrames;
+
+    for (uint32_t o = 0; o < config->outputs; o++) {
+        uint32_t rate = config->rateHz[o];
+        if (rate == 0 || rate >= sampleRate || sampleRate % rate != 0) {
+            decimator_deinit(d);
+            return false;
+        }
+        for (uint32_t k = 0; k < o; k++) {
+            if (config->rateHz[k] == rate) {
+                decimator_deinit(d);
+                return false;
+            }
+        }
+        uint32_t factor = sampleRate / rate;
+        uint32_t halves = 0, rest = factor;
+        while (rest % 2 == 0 && halves < 4) {
+            rest /= 2;
+            halves++;
+        }
+        if ((rest != 1 && rest != 3) || factor > DECIMATOR_MAX_FACTOR) {
+            decimator_deinit(d);
+            return false;
+        }
+
+        // 半带级在前（采样率高时每个输出样本的乘法最少），3:1在最后
+        int32_t parent = -1;
+        double cumulative = 1, latency = 0, macs = 0;
+        for (uint32_t k = 0; k < halves + (rest == 3); k++) {
+            parent = add_stage(d, parent, (k < halves) ? 2 : 3);
+            if (parent < 0) {
+                decimator_deinit(d);
+                return false;
+            }
+            const DecimatorStage *s = &d->stage[parent];
+            latency += (double)(s->taps - 1) / 2 * cumulative;
+            cumulative *= s->factor;
+            macs += (1.0 + s->pairs) / cumulative;
+        }
+        d->outputRate[o] = rate;
+        d->outputFactor[o] = factor;
+        d->outputStage[o] = (uint32_t)parent;
+        d->latencyFrames[o] = (float)latency;
+        d->macsPerFrame[o] = (float)macs;
+        d->outputs++;
+    }
+
+    // 共用的级只算一次
+    for (uint32_t i = 0; i < d->stages; i++) {
+        uint32_t cumulative = 1;
+        for (int32_t k = (int32_t)i; k >= 0; k = d->stage[k].parent) {
+            cumulative *= d->stage[k].factor;
+        }
+        d->totalMacsPerFrame += (1.0f + d->stage[i].pairs) / cumulative;
+    }
+    decimator_reset(d);
+    return true;
+}
+
+void decimator_deinit(Decimator *d) {
+    for (uint32_t i = 0; i < DECIMATOR_MAX_STAGES; i++) {
+        DecimatorStage *s = &d->stage[i];
+        free(s->coef);
+        free(s->offset);
+        free(s->in);
+        free(s->out);
+        s->coef = NULL;
+        s->offset = NULL;
+        s->in = NULL;
+        s->out = NULL;
+    }
+    d->stages = 0;
+    d->outputs = 0;
+}
+
+void decimator_reset(Decimator *d) {
+    for (uint32_t i = 0; i < d->stages; i++) {
+        DecimatorStage *s = &d->stage[i];
+        memset(s->in, 0, (size_t)d->channels * (s->history + s->maxIn) * sizeof(int16_t));
+        s->phase = 0;
+        s->outFrames = 0;
+    }
+}
+
+// 一个通道：从第phase帧起每factor帧计算一个输出，x[n]为本次第n个输入（之前是history个历史样本）
+static uint32_t filter_channel(const DecimatorStage *s, const int16_t *x, uint32_t frames, int16_t *y) {
+    const uint32_t c = (s->taps - 1) / 2, pairs = s->pairs;
+    const int16_t *coef = s->coef;
+    const uint16_t *offset = s->offset;
+    uint32_t count = 0;
+    for (uint32_t n = s->phase; n < frames; n += s->factor) {
+        const int16_t *m = x + n - c;
+        int32_t acc = s->center * m[0];
+        for (uint32_t i = 0; i < pairs; i++) {
+            acc += coef[i] * (m[offset[i]] + m[-(int32_t)offset[i]]);
+        }
+        y[count++] = sat16((acc + (1 << 14)) >> 15);
+    }
+    return count;
+}
+
+// 把本级的输入（已放在历史样本之后）滤波抽取到out，再保留最后history个样本给下一次
+static void run_stage(Decimator *d, DecimatorStage *s, uint32_t frames) {
+    const uint32_t stride = s->history + s->maxIn;
+    for (uint32_t ch = 0; ch < d->channels; ch++) {
+        int16_t *x = s->in + (size_t)ch * stride;
+        s->outFrames = filter_channel(s, x + s->history, frames, s->out + (size_t)ch * s->maxOut);
+        memmove(x, x + frames, s->history * sizeof(int16_t));
+    }
+    s->phase = s->phase + s->outFrames * s->factor - frames;
+}
+
+void decimator_process(Decimator *d, const void *in, uint32_t sampleBytes, uint32_t frames,
+                       int16_t *const *out, uint32_t *outFrames) {
+    const uint32_t channels = d->channels;
+    if (frames > d->maxFrames) {
+        frames = d->maxFrames;
+    }
+
+    for (uint32_t i = 0; i < d->stages; i++) {
+        DecimatorStage *s = &d->stage[i];
+        const uint32_t stride = s->history + s->maxIn;
+        uint32_t count = frames;
+        if (s->parent >= 0) {
+            // 上一级的输出（平面）接在历史样本之后
+            const DecimatorStage *p = &d->stage[s->parent];
+            count = p->outFrames;
+            for (uint32_t ch = 0; ch < channels; ch++) {
+                memcpy(s->in + (size_t)ch * stride + s->history, p->out + (size_t)ch * p->maxOut,
+                       count * sizeof(int16_t));
+            }
+        } else if (sampleBytes == 2) {
+            for (uint32_t ch = 0; ch < channels; ch++) {
+                int16_t *dst = s->in + (size_t)ch * stride + s->history;
+                const int16_t *src = (const int16_t *)in + ch;
+                for (uint32_t n = 0; n < frames; n++) {
+                    dst[n] = src[(size_t)n * channels];
+                }
+            }
+        } else {
+            // 24位打包或32位容器（小端）：高16位，按下一位四舍五入
+            const size_t step = (size_t)channels * sampleBytes;
+            for (uint32_t ch = 0; ch < channels; ch++) {
+                int16_t *dst = s->in + (size_t)ch * stride + s->history;
+                const uint8_t *src = (const uint8_t *)in + (size_t)ch * sampleBytes + sampleBytes - 3;
+                for (uint32_t n = 0; n < frames; n++, src += step) {
+                    dst[n] = sat16((int16_t)(src[1] | (src[2] << 8)) + (src[0] >> 7));
+                }
+            }
+        }
+        run_stage(d, s, count);
+    }
+
+    // 交织各路输出
+    for (uint32_t o = 0; o < d->outputs; o++) {
+        const DecimatorStage *s = &d->stage[d->outputStage[o]];
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            const int16_t *src = s->out + (size_t)ch * s->maxOut;
+            int16_t *dst = out[o] + ch;
+            for (uint32_t n = 0; n < s->outFrames; n++) {
+                dst[(size_t)n * channels] = src[n];
+            }
+        }
+        outFrames[o] = s->outFrames;
+    }
+}
+
+uint32_t decimator_max_output_frames(const Decimator *d, uint32_t output) {
+    return d->stage[d->outputStage[output]].maxOut;
+}
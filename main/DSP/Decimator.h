@@ -0,0 +1,86 @@
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 多采样率抽取：一次处理交织的多路样本（16、24或32位），同时输出几路降到输入采样率整数分之一的
+// 交织int16信号（如96kHz采集同时输出48kHz和16kHz）
+//
+// 抽取比D = 2^a x 3^b（a <= 4，b <= 1）。每路输出是一串抽取级：先a级半带（每级2:1），再一级3:1；
+// 不同输出的相同前缀共用同一串级，只算一次（96k -> 48k -> 16k时48kHz输出就是16kHz的中间级）。
+// 每级都是多相形式：只计算保留下来的输出样本（每个输入样本 抽头数/抽取比 次乘法），线性相位FIR
+// 的对称系数两两合并，半带滤波器隔一个为0的系数不参与运算。
+//
+// 每级都按自己的输出采样率fo设计：[0, DECIMATOR_PASSBAND x fo]为通带，会混叠进通带的
+// [(1 - DECIMATOR_PASSBAND) x fo, fi/2]为阻带（最小衰减DECIMATOR_STOPBAND_DB），中间的过渡带
+// 只会混叠到过渡带自身。Kaiser窗sinc，系数为Q15（直流增益准确为1），每个输出样本的乘积累加在int32中，
+// 四舍五入饱和为int16后送入下一级。通带和阻带指标由tools/rate_bench对量化后的级联检查。
+//
+// 输出j对应输入第j x D帧（开始或reset后第0帧为第0个输出），群延迟为latencyFrames（输入帧）。
+// 缓冲区在init时分配（malloc）。不依赖ESP-IDF，可在主机上编译（见tools/rate_bench）。
+
+#define DECIMATOR_MAX_OUTPUTS   3
+#define DECIMATOR_MAX_STAGES    8
+#define DECIMATOR_MAX_CHANNELS  16
+#define DECIMATOR_MAX_FACTOR    48
+#define DECIMATOR_PASSBAND      0.4     // 通带上限（输出采样率的比例）
+#define DECIMATOR_STOPBAND_DB   70.0    // 阻带最小衰减
+#define DECIMATOR_RIPPLE_DB     0.1     // 通带最大波动（±）
+
+typedef struct {
+    uint32_t outputs;                           // 0..DECIMATOR_MAX_OUTPUTS
+    uint32_t rateHz[DECIMATOR_MAX_OUTPUTS];     // 输入采样率的整数分之一
+} DecimatorConfig;
+
+// 一级抽取：y[j] = center x x[m] + sum(coef[i] x (x[m + offset[i]] + x[m - offset[i]]))，m为中心抽头
+typedef struct {
+    int32_t parent;                 // 输入来自哪一级，-1: 抽取器的输入
+    uint32_t factor;                // 2（半带）或3
+    uint32_t taps;                  // FIR长度（奇数）
+    int16_t center;                 // Q15
+    uint32_t pairs;                 // 非零的对称系数对数
+    int16_t *coef;                  // pairs个Q15系数
+    uint16_t *offset;               // 每对系数相对中心抽头的距离
+    uint32_t history;               // 保留的历史样本数（taps - 1）
+    uint32_t maxIn;                 // 每次最多的输入帧数
+    uint32_t maxOut;
+    uint32_t phase;                 // 下一个输出位置前还要跳过的输入帧数
+    uint32_t outFrames;             // 最近一次处理的输出帧数
+    int16_t *in;                    // channels x (history + maxIn)，平面
+    int16_t *out;                   // channels x maxOut，平面
+} DecimatorStage;
+
+typedef struct {
+    uint32_t channels;
+    uint32_t sampleRate;
+    uint32_t maxFrames;             // 每次处理的最大输入帧数
+    uint32_t stages;
+    DecimatorStage stage[DECIMATOR_MAX_STAGES];     // 父级总在子级之前
+    uint32_t outputs;
+    uint32_t outputRate[DECIMATOR_MAX_OUTPUTS];
+    uint32_t outputFactor[DECIMATOR_MAX_OUTPUTS];
+    uint32_t outputStage[DECIMATOR_MAX_OUTPUTS];    // 每路输出的最后一级
+    float latencyFrames[DECIMATOR_MAX_OUTPUTS];     // 群延迟（输入帧）
+    float macsPerFrame[DECIMATOR_MAX_OUTPUTS];      // 每通道每个输入帧的乘法数（含共用的级）
+    float totalMacsPerFrame;                        // 所有输出合计（共用的级只算一次）
+} Decimator;
+
+// 按配置设计各级并分配缓冲区。采样率不是输入的整数分之一、抽取比不是2^a x 3^b（<= DECIMATOR_MAX_FACTOR）、
+// 输出重复或分配失败时返回false
+bool decimator_init(Decimator *d, const DecimatorConfig *config, uint32_t sampleRate, uint32_t channels,
+                    uint32_t maxFrames);
+void decimator_deinit(Decimator *d);
+// 清除历史样本，下一个输入帧重新对应每路的第0个输出（开始新的录音时调用）
+void decimator_reset(Decimator *d);
+
+// in为frames帧channels通道交织的样本，frames <= maxFrames。sampleBytes为2: int16；3或4: 小端24位打包
+// 或32位容器，取高16位四舍五入。out[i]为第i路输出（交织int16，至少decimator_max_output_frames帧），
+// outFrames[i]返回写入的帧数
+void decimator_process(Decimator *d, const void *in, uint32_t sampleBytes, uint32_t frames,
+                       int16_t *const *out, uint32_t *outFrames);
+
+// 第i路输出每次处理最多的帧数（maxFrames / 抽取比，向上取整）
+uint32_t decimator_max_output_frames(const Decimator *d, uint32_t output);
+
+#endif /* DECIMATOR_H */
@@ -0,0 +1,336 @@
+#include "DoaEstimator.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DSP_PI  3.14159265358979323846
+
+// 互功率谱幅度低于此值（静音）的频点不参与
+#define PHAT_MIN_MAGNITUDE  1e-20f
+
+static uint32_t channel_of(uint32_t slotMask, uint32_t slot) {
+    return (uint32_t)__builtin_popcount(slotMask & ((1u << slot) - 1));
+}
+
+// 槽位对应的麦克风下标，还没有用到时加入
+static int mic_index(DoaEstimator *est, uint32_t slotMask, uint32_t slot) {
+    uint8_t channel = (uint8_t)channel_of(slotMask, slot);
+    for (uint32_t m = 0; m < est->mics; m++) {
+        if (est->micChannel[m] == channel) {
+            return (int)m;
+        }
+    }
+    est->micChannel[est->mics] = channel;
+    return (int)est->mics++;
+}
+
+bool doa_estimator_init(DoaEstimator *est, const DoaConfig *config, float sampleRate, uint32_t slotMask) {
+    memset(est, 0, sizeof(*est));
+    uint32_t n = config->frameSize;
+    float c = (config->soundSpeed > 0.0f) ? config->soundSpeed : BEAMFORMER_SOUND_SPEED;
+    if (n < DOA_MIN_FRAME || n > DOA_MAX_FRAME || (n & (n - 1)) != 0 || sampleRate <= 0.0f ||
+        config->pairs > DOA_MAX_PAIRS || slotMask == 0 || (slotMask >> BEAMFORMER_MAX_MICS) != 0) {
+        return false;
+    }
+    est->channels = (uint32_t)__builtin_popcount(slotMask);
+    est->frameSize = n;
+    est->hopFrames = (config->hopFrames > 0) ? config->hopFrames : n;
+    uint32_t report = (config->reportFrames > 0) ? config->reportFrames : est->hopFrames;
+    est->windowsPerReport = (report + est->hopFrames / 2) / est->hopFrames;
+    est->windowsPerReport = (est->windowsPerReport > 0) ? est->windowsPerReport : 1;
+
+    // 麦克风对：未指定时slotMask中的槽位两两配对（超过DOA_MAX_PAIRS的舍去）
+    uint8_t pairSlots[DOA_MAX_PAIRS][2];
+    uint32_t pairs = config->pairs;
+    if (pairs > 0) {
+        memcpy(pairSlots, config->pair, pairs * sizeof(pairSlots[0]));
+    } else {
+        for (uint32_t a = 0; a < BEAMFORMER_MAX_MICS; a++) {
+            for (uint32_t b = a + 1; b < BEAMFORMER_MAX_MICS && pairs < DOA_MAX_PAIRS; b++) {
+                if ((slotMask & (1u << a)) && (slotMask & (1u << b))) {
+                    pairSlots[pairs][0] = (uint8_t)a;
+                    pairSlots[pairs][1] = (uint8_t)b;
+                    pairs++;
+                }
+            }
+        }
+    }
+    if (pairs == 0) {
+        return false;
+    }
+
+    double framesPerMeter = sampleRate / c;
+    double maxDistance = 0;
+    for (uint32_t i = 0; i < pairs; i++) {
+        uint32_t a = pairSlots[i][0], b = pairSlots[i][1];
+        if (a == b || a >= BEAMFORMER_MAX_MICS || b >= BEAMFORMER_MAX_MICS || !(slotMask & (1u << a)) ||
+            !(slotMask & (1u << b))) {
+            return false;
+        }
+        const BeamformerPoint *pa = &config->mic[a], *pb = &config->mic[b];
+        double dx = (double)pb->x - pa->x, dy = (double)pb->y - pa->y;
+        if (!isfinite(dx) || !isfinite(dy)) {
+            return false;
+        }
+        est->pairSlot[i][0] = (uint8_t)a;
+        est->pairSlot[i][1] = (uint8_t)b;
+        est->pairMic[i][0] = (uint8_t)mic_index(est, slotMask, a);
+        est->pairMic[i][1] = (uint8_t)mic_index(est, slotMask, b);
+        est->pairDx[i] = (float)(dx * framesPerMeter);
+        est->pairDy[i] = (float)(dy * framesPerMeter);
+        double d = sqrt(dx * dx + dy * dy);
+        maxDistance = (d > maxDistance) ? d : maxDistance;
+    }
+    est->pairs = pairs;
+    // 插值要用到两侧各两个相邻的延迟
+    est->maxLag = (uint32_t)ceil(maxDistance * framesPerMeter) + 2;
+    if (est->maxLag >= n / 2) {
+        return false;
+    }
+
+    // PHAT频带，不含直流和奈奎斯特频点
+    double binHz = sampleRate / n;
+    double lowHz = (config->minHz > 0.0f) ? config->minHz : 0.0;
+    double highHz = (config->maxHz > 0.0f && config->maxHz < sampleRate / 2) ? config->maxHz : sampleRate / 2;
+    est->binLow = (uint32_t)ceil(lowHz / binHz);
+    est->binHigh = (uint32_t)floor(highHz / binHz);
+    est->binLow = (est->binLow < 1) ? 1 : est->binLow;
+    est->binHigh = (est->binHigh > n / 2 - 1) ? n / 2 - 1 : est->binHigh;
+    if (est->binHigh < est->binLow) {
+        return false;
+    }
+    // 逆FFT除以n，单边的每个频点在双边谱中出现两次
+    est->phatScale = (float)n / (2.0f * (est->binHigh - est->binLow + 1));
+
+    if (!dsp_real_fft_init(&est->fft, n)) {
+        return false;
+    }
+    uint32_t bins = n / 2 + 1;
+    est->window = malloc(n * sizeof(float));
+    est->history = malloc((size_t)est->mics * n * sizeof(int16_t));
+    est->frame = malloc(n * sizeof(float));
+    est->specRe = malloc((size_t)est->mics * bins * sizeof(float));
+    est->specIm = malloc((size_t)est->mics * bins * sizeof(float));
+    est->crossRe = calloc(bins, sizeof(float));
+    est->crossIm = calloc(bins, sizeof(float));
+    est->acc = malloc((size_t)pairs * (2 * est->maxLag + 1) * sizeof(float));
+    if (est->window == NULL || est->history == NULL || est->frame == NULL || est->specRe == NULL ||
+        est->specIm == NULL || est->crossRe == NULL || est->crossIm == NULL || est->acc == NULL) {
+        doa_estimator_deinit(est);
+        return false;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        est->window[i] = (float)(0.5 - 0.5 * cos(2.0 * DSP_PI * i / n)) / 32768.0f;
+    }
+    for (uint32_t a = 0; a < DOA_AZIMUTH_STEPS; a++) {
+        est->cosTab[a] = (float)cos(2.0 * DSP_PI * a / DOA_AZIMUTH_STEPS);
+        est->sinTab[a] = (float)sin(2.0 * DSP_PI * a / DOA_AZIMUTH_STEPS);
+    }
+    atomic_store(&est->count, 0);
+    doa_estimator_reset(est);
+    return true;
+}
+
+void doa_estimator_deinit(DoaEstimator *est) {
+    dsp_real_fft_deinit(&est->fft);
+    free(est->window);
+    free(est->history);
+    free(est->frame);
+    free(est->specRe);
+    free(est->specIm);
+    free(est->crossRe);
+    free(est->crossIm);
+    free(est->acc);
+    est->window = NULL;
+    est->history = NULL;
+    est->frame = NULL;
+    est->specRe = NULL;
+    est->specIm = NULL;
+    est->crossRe = NULL;
+    est->crossIm = NULL;
+    est->acc = NULL;
+}
+
+void doa_estimator_reset(DoaEstimator *est) {
+    est->filled = 0;
+    est->skip = 0;
+    est->started = false;
+    est->windows = 0;
+    if (est->acc != NULL) {
+        memset(est->acc, 0, (size_t)est->pairs * (2 * est->maxLag + 1) * sizeof(float));
+    }
+}
+
+// 一个分析帧：各路麦克风的频谱，再把每对的PHAT互相关（±maxLag）累加到acc
+static void analyze_window(DoaEstimator *est) {
+    const uint32_t n = est->frameSize, bins = n / 2 + 1;
+    const uint32_t span = 2 * est->maxLag + 1;
+
+    for (uint32_t m = 0; m < est->mics; m++) {
+        const int16_t *x = est->history + (size_t)m * n;
+        for (uint32_t i = 0; i < n; i++) {
+            est->frame[i] = x[i] * est->window[i];
+        }
+        dsp_real_fft_forward(&est->fft, est->frame, est->specRe + (size_t)m * bins, est->specIm + (size_t)m * bins);
+    }
+
+    for (uint32_t p = 0; p < est->pairs; p++) {
+        const float *ar = est->specRe + (size_t)est->pairMic[p][0] * bins;
+        const float *ai = est->specIm + (size_t)est->pairMic[p][0] * bins;
+        const float *br = est->specRe + (size_t)est->pairMic[p][1] * bins;
+        const float *bi = est->specIm + (size_t)est->pairMic[p][1] * bins;
+        for (uint32_t k = est->binLow; k <= est->binHigh; k++) {
+            float gr = ar[k] * br[k] + ai[k] * bi[k];
+            float gi = ai[k] * br[k] - ar[k] * bi[k];
+            float mag = sqrtf(gr * gr + gi * gi);
+            float scale = (mag > PHAT_MIN_MAGNITUDE) ? est->phatScale / mag : 0.0f;
+            est->crossRe[k] = gr * scale;
+            est->crossIm[k] = gi * scale;
+        }
+        // 互相关r[τ] = Σ xa[t + τ] xb[t]，负的延迟在循环缓冲区末尾
+        dsp_real_fft_inverse(&est->fft, est->crossRe, est->crossIm, est->frame);
+        float *acc = est->acc + (size_t)p * span;
+        for (uint32_t i = 0; i < span; i++) {
+            uint32_t lag = (i + n - est->maxLag) & (n - 1);
+            acc[i] += est->frame[lag];
+        }
+    }
+}
+
+// 方位网格上各对互相关之和
+static float azimuth_score(const DoaEstimator *est, uint32_t a) {
+    const uint32_t span = 2 * est->maxLag + 1;
+    float score = 0.0f;
+    for (uint32_t p = 0; p < est->pairs; p++) {
+        float lag = est->pairDx[p] * est->cosTab[a] + est->pairDy[p] * est->sinTab[a] + (float)est->maxLag;
+        uint32_t i = (uint32_t)lag;
+        float frac = lag - (float)i;
+        const float *acc = est->acc + (size_t)p * span;
+        // Catmull-Rom三次插值：相关峰很尖时线性插值会把方位拉向整数延迟
+        float y0 = acc[i - 1], y1 = acc[i], y2 = acc[i + 1], y3 = acc[i + 2];
+        score += y1 + 0.5f * frac * ((y2 - y0) + frac * ((2.0f * y0 - 5.0f * y1 + 4.0f * y2 - y3) +
+                                                          frac * (3.0f * (y1 - y2) + y3 - y0)));
+    }
+    return score;
+}
+
+// 搜索累加的互相关，输出一个结果并清空累加
+static void report(DoaEstimator *est, DoaEstimate *estimate) {
+    float *scores = est->score;
+    uint32_t best = 0;
+    for (uint32_t a = 0; a < DOA_AZIMUTH_STEPS; a++) {
+        scores[a] = azimuth_score(est, a);
+        best = (scores[a] > scores[best]) ? a : best;
+    }
+
+    // 抛物线插值
+    float y0 = scores[best];
+    float ym = scores[(best + DOA_AZIMUTH_STEPS - 1) % DOA_AZIMUTH_STEPS];
+    float yp = scores[(best + 1) % DOA_AZIMUTH_STEPS];
+    float denom = ym - 2.0f * y0 + yp;
+    float delta = (denom < 0.0f) ? 0.5f * (ym - yp) / denom : 0.0f;
+    float azimuth = ((float)best + delta) * (360.0f / DOA_AZIMUTH_STEPS);
+    azimuth = (azimuth < 0.0f) ? azimuth + 360.0f : (azimuth >= 360.0f) ? azimuth - 360.0f : azimuth;
+
+    float confidence = y0 / ((float)est->pairs * est->windows);
+    confidence = (confidence < 0.0f) ? 0.0f : (confidence > 1.0f) ? 1.0f : confidence;
+
+    uint64_t span = (uint64_t)(est->windows - 1) * est->hopFrames + est->frameSize;
+    estimate->samplePos = est->reportStart + span / 2;
+    estimate->azimuthDeg = azimuth;
+    estimate->confidence = confidence;
+    estimate->windows = est->windows;
+
+    uint32_t centiDeg = (uint32_t)lroundf(azimuth * 100.0f) % 36000;
+    uint32_t level = (uint32_t)lroundf(confidence * 65535.0f);
+    atomic_store(&est->latest, centiDeg | (level << 16));
+    atomic_fetch_add(&est->count, 1);
+
+    est->windows = 0;
+    memset(est->acc, 0, (size_t)est->pairs * (2 * est->maxLag + 1) * sizeof(float));
+}
+
+uint32_t doa_estimator_feed(DoaEstimator *est, const int16_t *in, uint32_t frames, uint64_t firstSample,
+                            DoaEstimate *out, uint32_t maxOut) {
+    const uint32_t n = est->frameSize, channels = est->channels;
+    uint32_t produced = 0;
+
+    // 丢帧或重新开始录音：已收到的样本不再连续
+    if (!est->started || firstSample != est->nextSample) {
+        doa_estimator_reset(est);
+        est->started = true;
+        est->windowStart = firstSample;
+    }
+    est->nextSample = firstSample + frames;
+
+    while (frames > 0) {
+        if (est->skip > 0) {
+            uint32_t skip = (est->skip < frames) ? est->skip : frames;
+            est->skip -= skip;
+            est->windowStart += skip;
+            in += (size_t)skip * channels;
+            frames -= skip;
+            continue;
+        }
+
+        uint32_t take = n - est->filled;
+        take = (take < frames) ? take : frames;
+        for (uint32_t m = 0; m < est->mics; m++) {
+            int16_t *dst = est->history + (size_t)m * n + est->filled;
+            const int16_t *src = in + est->micChannel[m];
+            for (uint32_t i = 0; i < take; i++) {
+                dst[i] = src[(size_t)i * channels];
+            }
+        }
+        est->filled += take;
+        in += (size_t)take * channels;
+        frames -= take;
+        if (est->filled < n) {
+            break;
+        }
+
+        if (est->windows == 0) {
+            est->reportStart = est->windowStart;
+        }
+        analyze_window(est);
+        est->windows++;
+        if (est->windows == est->windowsPerReport) {
+            DoaEstimate estimate;
+            report(est, &estimate);
+            if (produced < maxOut) {
+                out[produced++] = estimate;
+            }
+        }
+
+        // 下一个分析帧：重叠部分留在history中
+        if (est->hopFrames < n) {
+            uint32_t keep = n - est->hopFrames;
+            for (uint32_t m = 0; m < est->mics; m++) {
+                int16_t *ch = est->history + (size_t)m * n;
+                memmove(ch, ch + est->hopFrames, keep * sizeof(int16_t));
+            }
+            est->filled = keep;
+            est->windowStart += est->hopFrames;
+        } else {
+            est->filled = 0;
+            est->skip = est->hopFrames - n;
+            est->windowStart += n;
+        }
+    }
+    return produced;
+}
+
+bool doa_estimator_latest(const DoaEstimator *est, DoaEstimate *estimate, uint32_t *count) {
+    uint32_t reports = atomic_load(&est->count);
+    uint32_t packed = atomic_load(&est->latest);
+    if (count != NULL) {
+        *count = reports;
+    }
+    if (reports == 0) {
+        return false;
+    }
+    memset(estimate, 0, sizeof(*estimate));
+    estimate->azimuthDeg = (float)(packed & 0xFFFF) / 100.0f;
+    estimate->confidence = (float)(packed >> 16) / 65535.0f;
+    return true;
+}
@@ -0,0 +1,107 @@
+#ifndef DOA_ESTIMATOR_H
+#define DOA_ESTIMATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "DspRealFft.h"
+#include "Beamformer.h"
+
+// 声源方位估计（GCC-PHAT）：从交织的多路麦克风信号中流式估计水平方位角
+//
+// 每路麦克风取frameSize帧加Hann窗做实FFT（DspRealFft）。对每个麦克风对(a, b)，互功率谱
+// Xa x conj(Xb)在[minHz, maxHz]内按幅度归一化（PHAT加权，只保留相位），逆FFT得到广义互相关，
+// 完全相关时峰值为1。平面波从水平角θ到达时，相关峰位于 (pb - pa)·u(θ) x 采样率/c 个样本
+// （u为单位方向向量，几何与波束形成共用）。在1°的方位网格上把各对的互相关（按分数延迟三次插值）
+// 相加，取最大值并做抛物线插值得到方位；置信度为峰值处各对互相关的平均，0..1。
+//
+// 分析帧每隔hopFrames帧开始一个（小于frameSize时重叠，大于时跳过中间的帧），每reportFrames帧
+// 输出一个结果：期间各分析帧的互相关先累加再搜索，输出速率与帧长、重叠无关。
+// 只估计水平角（仰角视为0）；直线阵列关于阵列轴前后对称，只能区分0..180°。
+//
+// 运算量：每个分析帧 (麦克风数 + 麦克风对数) 次frameSize点实FFT，每个结果 360 x 麦克风对数 次插值。
+// 缓冲区在init时分配（malloc）。不依赖ESP-IDF，可在主机上编译（见tools/doa_bench）。
+
+#define DOA_MAX_PAIRS       28          // 8个麦克风两两配对
+#define DOA_MIN_FRAME       256
+#define DOA_MAX_FRAME       4096
+#define DOA_AZIMUTH_STEPS   360         // 方位网格（1°）
+
+typedef struct {
+    uint32_t frameSize;             // 分析帧长（2的幂，DOA_MIN_FRAME..DOA_MAX_FRAME）
+    uint32_t hopFrames;             // 相邻分析帧的起点间隔，0: frameSize（不重叠）
+    uint32_t reportFrames;          // 每个结果覆盖的帧数（决定输出速率），0: 每个分析帧一个结果
+    uint32_t pairs;                 // 麦克风对数，0: slotMask中的麦克风两两配对
+    uint8_t pair[DOA_MAX_PAIRS][2]; // 每对的两个槽位
+    float minHz;                    // PHAT加权的频带，0: 不限
+    float maxHz;
+    float soundSpeed;               // m/s，0: BEAMFORMER_SOUND_SPEED
+    BeamformerPoint mic[BEAMFORMER_MAX_MICS];   // 每个TDM槽位的麦克风位置
+} DoaConfig;
+
+// 一个方位估计
+typedef struct {
+    uint64_t samplePos;             // 覆盖的帧的中点（与输入的firstSample同一时间轴）
+    float azimuthDeg;               // 0..360：0为+x方向，逆时针转向+y
+    float confidence;               // 0..1
+    uint32_t windows;               // 合并的分析帧数
+} DoaEstimate;
+
+typedef struct {
+    uint32_t channels;              // 输入每帧的通道数（slotMask中的槽位数）
+    uint32_t frameSize;
+    uint32_t hopFrames;
+    uint32_t windowsPerReport;
+    uint32_t mics;                  // 参与配对的麦克风数
+    uint8_t micChannel[BEAMFORMER_MAX_MICS];    // 每个麦克风在输入帧中的通道
+    uint32_t pairs;
+    uint8_t pairSlot[DOA_MAX_PAIRS][2];         // 每对的两个槽位
+    uint8_t pairMic[DOA_MAX_PAIRS][2];          // 每对的两个麦克风（micChannel的下标）
+    float pairDx[DOA_MAX_PAIRS];    // (pb - pa) x 采样率/c，单位: 样本
+    float pairDy[DOA_MAX_PAIRS];
+    uint32_t maxLag;                // 保留的互相关延迟范围 ±maxLag
+    uint32_t binLow, binHigh;       // PHAT频带（含两端）
+    float phatScale;                // 使完全相关的峰值为1
+    DspRealFft fft;
+    float *window;                  // Hann窗 / 32768（frameSize）
+    int16_t *history;               // mics x frameSize，当前分析帧已收到的样本
+    float *frame;                   // frameSize
+    float *specRe;                  // mics x (frameSize/2 + 1)
+    float *specIm;
+    float *crossRe;                 // frameSize/2 + 1（频带外恒为0）
+    float *crossIm;
+    float *acc;                     // pairs x (2 x maxLag + 1)，累加的互相关
+    float cosTab[DOA_AZIMUTH_STEPS];
+    float sinTab[DOA_AZIMUTH_STEPS];
+    float score[DOA_AZIMUTH_STEPS]; // 方位网格上的得分（不放在调用者的栈上）
+
+    // 流式状态
+    uint32_t filled;                // history中的帧数
+    uint32_t skip;                  // 跳过的帧数（hopFrames > frameSize）
+    uint64_t windowStart;           // history第一帧的序号
+    uint64_t nextSample;            // 下一次输入预期的firstSample
+    bool started;
+    uint32_t windows;               // acc中累加的分析帧数
+    uint64_t reportStart;           // 第一个累加的分析帧的起点
+
+    // 最新结果（任意任务无锁读取）：方位0.01°和置信度/65535打包为一个字，count为结果数
+    atomic_uint latest;
+    atomic_uint count;
+} DoaEstimator;
+
+// 按配置分配缓冲区。slotMask选出输入的通道（按槽位从小到大排列），麦克风对的槽位必须在其中；
+// 配置无效、阵列对帧长来说太大或分配失败时返回false
+bool doa_estimator_init(DoaEstimator *est, const DoaConfig *config, float sampleRate, uint32_t slotMask);
+void doa_estimator_deinit(DoaEstimator *est);
+// 丢弃未完成的分析帧和累加的互相关（开始新的录音时调用）
+void doa_estimator_reset(DoaEstimator *est);
+
+// 送入frames帧交织int16（channels通道），firstSample为第一帧的序号；与上一次输入不连续时自动reset。
+// 完成的结果写入out（最多maxOut个，多出的只更新最新结果），返回写入的个数
+uint32_t doa_estimator_feed(DoaEstimator *est, const int16_t *in, uint32_t frames, uint64_t firstSample,
+                            DoaEstimate *out, uint32_t maxOut);
+
+// 读取最新结果（samplePos和windows不填），还没有结果时返回false
+bool doa_estimator_latest(const DoaEstimator *est, DoaEstimate *estimate, uint32_t *count);
+
+#endif /* DOA_ESTIMATOR_H */
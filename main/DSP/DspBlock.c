@@ -0,0 +1,194 @@
+#include "DspBlock.h"
+#include "DspGolden.h"
+#include <math.h>
+#include <string.h>
+
+#define DSP_PI  3.14159265358979323846
+
+#if DSP_HAVE_PIE
+// DspPie.S：n为8的倍数，缓冲区16字节对齐
+void dsp_gain_s16_pie(const int16_t *in, int16_t *out, uint32_t n, int32_t gain, uint32_t shift);
+// frames >= 1，min8/max8为16字节对齐的8个int16
+void dsp_minmax_s16x8_pie(const int16_t *in, uint32_t frames, int16_t *min8, int16_t *max8);
+
+static bool pieEnabled = false;
+#endif
+
+static inline int16_t sat16(int32_t v) {
+    return (v > INT16_MAX) ? INT16_MAX : (v < INT16_MIN) ? INT16_MIN : (int16_t)v;
+}
+
+static inline bool aligned16(const void *p) {
+    return ((uintptr_t)p & 15) == 0;
+}
+
+bool dsp_init(void) {
+#if DSP_HAVE_PIE
+    pieEnabled = true;
+    if (dsp_golden_check(NULL) != 0) {
+        pieEnabled = false;
+        return false;
+    }
+#endif
+    return true;
+}
+
+bool dsp_pie_enabled(void) {
+#if DSP_HAVE_PIE
+    return pieEnabled;
+#else
+    return false;
+#endif
+}
+
+void dsp_set_pie(bool enable) {
+#if DSP_HAVE_PIE
+    pieEnabled = enable;
+#else
+    (void)enable;
+#endif
+}
+
+static void gain_c(const int16_t *in, int16_t *out, size_t n, int16_t gain, uint32_t shift) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = sat16(((int32_t)in[i] * gain) >> shift);
+    }
+}
+
+void dsp_gain_s16(const int16_t *in, int16_t *out, size_t n, int16_t gain, uint32_t shift) {
+#if DSP_HAVE_PIE
+    if (pieEnabled && aligned16(in) && aligned16(out) && n >= 8) {
+        size_t body = n & ~(size_t)7;
+        dsp_gain_s16_pie(in, out, (uint32_t)body, gain, shift);
+        gain_c(in + body, out + body, n - body, gain, shift);
+        return;
+    }
+#endif
+    gain_c(in, out, n, gain, shift);
+}
+
+void dsp_peak_s16x8(const int16_t *in, uint32_t frames, uint16_t peak[8]) {
+    _Alignas(16) int16_t lo[8] = { 0 };
+    _Alignas(16) int16_t hi[8] = { 0 };
+#if DSP_HAVE_PIE
+    if (pieEnabled && aligned16(in) && frames > 0) {
+        dsp_minmax_s16x8_pie(in, frames, lo, hi);
+    } else
+#endif
+    {
+        // 每个lane一个独立的最小/最大值，内层循环固定8次
+        for (uint32_t f = 0; f < frames; f++) {
+            const int16_t *frame = in + (size_t)f * 8;
+            for (uint32_t c = 0; c < 8; c++) {
+                lo[c] = (frame[c] < lo[c]) ? frame[c] : lo[c];
+                hi[c] = (frame[c] > hi[c]) ? frame[c] : hi[c];
+            }
+        }
+    }
+    for (uint32_t c = 0; c < 8; c++) {
+        uint16_t neg = (lo[c] < 0) ? (uint16_t)(-(int32_t)lo[c]) : 0;
+        uint16_t pos = (hi[c] > 0) ? (uint16_t)hi[c] : 0;
+        peak[c] = (neg > pos) ? neg : pos;
+    }
+}
+
+void dsp_sum_squares_s16(const int16_t *in, uint32_t channels, uint32_t frames, uint64_t *sums) {
+    if (channels == 8) {
+        // 固定lane：每帧的平方不超过2^30，32位累加器每2帧并入64位和，避免逐样本64位加法
+        uint64_t acc[8] = { 0 };
+        uint32_t f = 0;
+        for (; f + 2 <= frames; f += 2) {
+            const int16_t *frame = in + (size_t)f * 8;
+            for (uint32_t c = 0; c < 8; c++) {
+                uint32_t a = (uint32_t)((int32_t)frame[c] * frame[c]);
+                uint32_t b = (uint32_t)((int32_t)frame[c + 8] * frame[c + 8]);
+                acc[c] += (uint64_t)a + b;
+            }
+        }
+        for (; f < frames; f++) {
+            for (uint32_t c = 0; c < 8; c++) {
+                int32_t x = in[(size_t)f * 8 + c];
+                acc[c] += (uint64_t)(x * x);
+            }
+        }
+        memcpy(sums, acc, sizeof(acc));
+        return;
+    }
+
+    memset(sums, 0, channels * sizeof(*sums));
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint32_t c = 0; c < channels; c++) {
+            int32_t x = in[(size_t)f * channels + c];
+            sums[c] += (uint64_t)(x * x);
+        }
+    }
+}
+
+bool dsp_biquad_init(DspBiquadCascade *bq, const DspBiquadCoeffs *coeffs, uint32_t stages, uint32_t channels) {
+    if (stages == 0 || stages > DSP_BIQUAD_MAX_STAGES || channels == 0 || channels > DSP_MAX_CHANNELS) {
+        return false;
+    }
+    memset(bq, 0, sizeof(*bq));
+    bq->stages = stages;
+    bq->channels = channels;
+    memcpy(bq->coeffs, coeffs, stages * sizeof(*coeffs));
+    return true;
+}
+
+void dsp_biquad_reset(DspBiquadCascade *bq) {
+    memset(bq->state, 0, sizeof(bq->state));
+}
+
+void dsp_biquad_s16(DspBiquadCascade *bq, int16_t *data, uint32_t frames) {
+    const int64_t half = 1 << (DSP_BIQUAD_Q - 1);
+    for (uint32_t s = 0; s < bq->stages; s++) {
+        const DspBiquadCoeffs *k = &bq->coeffs[s];
+        for (uint32_t c = 0; c < bq->channels; c++) {
+            // 状态放在局部变量中，一个通道整块处理完再写回
+            int16_t *st = bq->state[s][c];
+            int32_t x1 = st[0], x2 = st[1], y1 = st[2], y2 = st[3];
+            int16_t *p = data + c;
+            for (uint32_t f = 0; f < frames; f++, p += bq->channels) {
+                int32_t x = *p;
+                int64_t acc = (int64_t)k->b0 * x + (int64_t)k->b1 * x1 + (int64_t)k->b2 * x2 -
+                              (int64_t)k->a1 * y1 - (int64_t)k->a2 * y2;
+                int64_t y = (acc + half) >> DSP_BIQUAD_Q;
+                int16_t out = (y > INT16_MAX) ? INT16_MAX : (y < INT16_MIN) ? INT16_MIN : (int16_t)y;
+                x2 = x1;
+                x1 = x;
+                y2 = y1;
+                y1 = out;
+                *p = out;
+            }
+            st[0] = (int16_t)x1;
+            st[1] = (int16_t)x2;
+            st[2] = (int16_t)y1;
+            st[3] = (int16_t)y2;
+        }
+    }
+}
+
+// 浮点系数换算为Q2.14（四舍五入），超出范围时返回false
+static bool to_q14(double v, int16_t *out) {
+    double scaled = round(v * (1 << DSP_BIQUAD_Q));
+    if (scaled < INT16_MIN || scaled > INT16_MAX) {
+        return false;
+    }
+    *out = (int16_t)scaled;
+    return true;
+}
+
+bool dsp_biquad_design_highpass(float sampleRate, float cutoffHz, float q, DspBiquadCoeffs *coeffs) {
+    if (sampleRate <= 0.0f || cutoffHz <= 0.0f || cutoffHz >= sampleRate / 2 || q <= 0.0f) {
+        return false;
+    }
+    double w0 = 2.0 * DSP_PI * cutoffHz / sampleRate;
+    double alpha = sin(w0) / (2.0 * q);
+    double cw = cos(w0);
+    double a0 = 1.0 + alpha;
+    return to_q14((1.0 + cw) / 2.0 / a0, &coeffs->b0) &&
+           to_q14(-(1.0 + cw) / a0, &coeffs->b1) &&
+           to_q14((1.0 + cw) / 2.0 / a0, &coeffs->b2) &&
+           to_q14(-2.0 * cw / a0, &coeffs->a1) &&
+           to_q14((1.0 - alpha) / a0, &coeffs->a2);
+}
@@ -0,0 +1,73 @@
+#ifndef DSP_BLOCK_H
+#define DSP_BLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 定点块DSP内核：int16增益/饱和、双二阶级联、峰值/平方和
+//
+// 每个内核都有一个可移植的C实现，定义了逐位精确的结果；ESP32-S3上部分内核另有
+// PIE（128位向量指令）路径，一次处理8个int16，结果必须与C实现完全一致：
+//  - 增益：EE.VMUL.S16（乘积算术右移SAR位后饱和）
+//  - 8通道交织的峰值：EE.VMAX.S16/EE.VMIN.S16（一帧正好是一个向量，lane就是通道）
+// 向量路径要求缓冲区16字节对齐，不满8个样本的尾部和未对齐的缓冲区走C实现。
+// dsp_init在启动时用黄金向量（DspGolden）检查向量路径，不一致时只用C实现。
+//
+// 通道交织/解交织见Audio_capture/Deinterleave.h，同样由黄金向量覆盖。
+//
+// 不依赖ESP-IDF，可在主机上编译（主机上只有C实现）。
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3) && !defined(DSP_DISABLE_PIE)
+#define DSP_HAVE_PIE    1
+#else
+#define DSP_HAVE_PIE    0
+#endif
+
+#define DSP_MAX_CHANNELS        16
+#define DSP_BIQUAD_MAX_STAGES   4
+#define DSP_BIQUAD_Q            14      // 系数为Q2.14，范围[-2, 2)
+
+// 启用向量路径前运行黄金向量；返回false表示向量路径结果不一致，已退回C实现
+bool dsp_init(void);
+// 当前是否使用PIE向量路径
+bool dsp_pie_enabled(void);
+// 强制使用（或不使用）向量路径，供基准和对比使用；没有PIE时无效
+void dsp_set_pie(bool enable);
+
+// out[i] = sat16((in[i] * gain) >> shift)，右移为算术右移（向负无穷截断），shift为0..15。
+// in和out可以相同（原地）
+void dsp_gain_s16(const int16_t *in, int16_t *out, size_t n, int16_t gain, uint32_t shift);
+
+// 8通道交织int16：各通道的峰值绝对值（-32768记为32768）
+void dsp_peak_s16x8(const int16_t *in, uint32_t frames, uint16_t peak[8]);
+// channels通道交织int16：各通道的平方和（64位，不会溢出）
+void dsp_sum_squares_s16(const int16_t *in, uint32_t channels, uint32_t frames, uint64_t *sums);
+
+// 双二阶节系数（Q2.14）：y = b0*x + b1*x1 + b2*x2 - a1*y1 - a2*y2
+typedef struct {
+    int16_t b0, b1, b2;
+    int16_t a1, a2;
+} DspBiquadCoeffs;
+
+// 双二阶级联（直接I型）：每节每通道保存最近两个输入和输出，节之间按int16饱和
+typedef struct {
+    uint32_t stages;
+    uint32_t channels;
+    DspBiquadCoeffs coeffs[DSP_BIQUAD_MAX_STAGES];
+    int16_t state[DSP_BIQUAD_MAX_STAGES][DSP_MAX_CHANNELS][4];     // x1, x2, y1, y2
+} DspBiquadCascade;
+
+bool dsp_biquad_init(DspBiquadCascade *bq, const DspBiquadCoeffs *coeffs, uint32_t stages, uint32_t channels);
+// 清除状态（开始新的录音时调用）
+void dsp_biquad_reset(DspBiquadCascade *bq);
+// 原地滤波channels通道交织的frames帧。累加器为64位，结果四舍五入后饱和
+void dsp_biquad_s16(DspBiquadCascade *bq, int16_t *data, uint32_t frames);
+// 按RBJ公式设计二阶高通（去直流），q一般取0.7071；系数超出Q2.14范围时返回false
+bool dsp_biquad_design_highpass(float sampleRate, float cutoffHz, float q, DspBiquadCoeffs *coeffs);
+
+#endif /* DSP_BLOCK_H */
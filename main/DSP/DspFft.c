@@ -0,0 +1,92 @@
+#include "DspFft.h"
+#include <math.h>
+#include <string.h>
+
+#define DSP_PI  3.14159265358979323846
+
+bool dsp_fft_init(DspFft *fft, uint32_t n) {
+    if (n < 16 || n > DSP_FFT_MAX_SIZE || (n & (n - 1)) != 0) {
+        return false;
+    }
+    memset(fft, 0, sizeof(*fft));
+    fft->n = n;
+    uint32_t m = n / 2;
+    for (uint32_t i = 0; i < n; i++) {
+        fft->window[i] = (float)(0.5 * (1.0 - cos(2.0 * DSP_PI * i / n)) / 32768.0);
+    }
+    for (uint32_t k = 0; k < m; k++) {
+        fft->cosTab[k] = (float)cos(2.0 * DSP_PI * k / n);
+        fft->sinTab[k] = (float)sin(2.0 * DSP_PI * k / n);
+    }
+    uint32_t bits = 0;
+    while ((1u << bits) < m) {
+        bits++;
+    }
+    for (uint32_t i = 0; i < m; i++) {
+        uint32_t r = 0;
+        for (uint32_t b = 0; b < bits; b++) {
+            r |= ((i >> b) & 1u) << (bits - 1 - b);
+        }
+        fft->bitrev[i] = (uint16_t)r;
+    }
+    // Hann窗的相干增益为1/2：满量程正弦在频点上的幅度为n/4
+    fft->scaleDb = (float)(20.0 * log10(n / 4.0));
+    return true;
+}
+
+// m点复数FFT（原地，输入已按位反转排列）。m点的旋转因子是n点表的偶数项
+static void fft_complex(DspFft *fft, uint32_t m) {
+    float *re = fft->re;
+    float *im = fft->im;
+    for (uint32_t len = 2, step = m; len <= m; len <<= 1, step >>= 1) {
+        uint32_t half = len / 2;
+        for (uint32_t base = 0; base < m; base += len) {
+            for (uint32_t j = 0; j < half; j++) {
+                float wr = fft->cosTab[j * step];
+                float wi = -fft->sinTab[j * step];
+                uint32_t a = base + j;
+                uint32_t b = a + half;
+                float tr = re[b] * wr - im[b] * wi;
+                float ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+static float power_db(const DspFft *fft, float re, float im) {
+    float p = re * re + im * im;
+    if (p <= 1e-12f) {
+        return DSP_FFT_FLOOR_DB;
+    }
+    float db = 10.0f * log10f(p) - fft->scaleDb;
+    return (db < DSP_FFT_FLOOR_DB) ? DSP_FFT_FLOOR_DB : db;
+}
+
+void dsp_fft_power_db(DspFft *fft, const int16_t *in, float *powerDb) {
+    uint32_t m = fft->n / 2;
+    // 偶数样本作实部、奇数样本作虚部，加窗后按位反转顺序放入工作缓冲区
+    for (uint32_t i = 0; i < m; i++) {
+        uint32_t r = fft->bitrev[i];
+        fft->re[r] = in[2 * i] * fft->window[2 * i];
+        fft->im[r] = in[2 * i + 1] * fft->window[2 * i + 1];
+    }
+    fft_complex(fft, m);
+
+    // 拆分：X[k] = (Z[k] + conj(Z[m-k]))/2 - j/2 * W^k * (Z[k] - conj(Z[m-k]))，W = e^(-j2π/n)
+    for (uint32_t k = 0; k < m; k++) {
+        uint32_t mk = (k == 0) ? 0 : m - k;
+        float ar = fft->re[k], ai = fft->im[k];
+        float br = fft->re[mk], bi = -fft->im[mk];
+        float er = (ar + br) * 0.5f, ei = (ai + bi) * 0.5f;
+        // -j(A-B)/2
+        float or_ = (ai - bi) * 0.5f, oi = -(ar - br) * 0.5f;
+        float wr = fft->cosTab[k], wi = -fft->sinTab[k];
+        float xr = er + or_ * wr - oi * wi;
+        float xi = ei + or_ * wi + oi * wr;
+        powerDb[k] = power_db(fft, xr, xi);
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef DSP_FFT_H
+#define DSP_FFT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 实信号功率谱：Hann窗 + 基2复数FFT（单精度浮点，ESP32-S3有硬件单精度FPU）
+//
+// n点实信号打包为n/2点复数序列做FFT，再拆分出n/2个频点，计算量约为直接做n点复数FFT的一半。
+// 旋转因子、窗和位反转表在init时算好，运行时不调用三角函数。
+// 结果以dBFS给出：满量程正弦波所在频点约为0dB。
+//
+// 不依赖ESP-IDF，可在主机上编译。
+
+#define DSP_FFT_MAX_SIZE    512     // 表和工作缓冲区静态分配（约6.5KB）
+#define DSP_FFT_FLOOR_DB    (-120.0f)
+
+typedef struct {
+    uint32_t n;                             // 实信号点数（2的幂，16..DSP_FFT_MAX_SIZE）
+    float window[DSP_FFT_MAX_SIZE];         // Hann窗，已除以满量程
+    float cosTab[DSP_FFT_MAX_SIZE / 2];     // cos(2πk/n)，k < n/2
+    float sinTab[DSP_FFT_MAX_SIZE / 2];
+    uint16_t bitrev[DSP_FFT_MAX_SIZE / 2];  // n/2点复数FFT的位反转下标
+    float re[DSP_FFT_MAX_SIZE / 2];         // 工作缓冲区
+    float im[DSP_FFT_MAX_SIZE / 2];
+    float scaleDb;                          // 换算到dBFS的偏移
+} DspFft;
+
+bool dsp_fft_init(DspFft *fft, uint32_t n);
+// in为n个int16样本，powerDb输出n/2个频点（频点k对应k*采样率/n，第0点为直流）
+void dsp_fft_power_db(DspFft *fft, const int16_t *in, float *powerDb);
+
+#endif /* DSP_FFT_H */
@@ -0,0 +1,192 @@
+#include "DspGolden.h"
+#include "DspBlock.h"
+#include "Deinterleave.h"
+#include <string.h>
+
+// 以下数组由参考实现生成，不要手工修改
+
+static const int16_t goldenGainIn[37] = {
+    -10, 8183, 3684, 32767, -14131, 9602, -15213, -21296, 9417, 6094, 5871, -14852,
+    17541, -7462, -32768, 13067, 17896, -23551, 21158, -2841, -10092, 32573, -3278, -1917,
+    -5632, 0, -11719, 4222, -26145, -22996, 22773, -18806, -2821, -1768, -28815, -20138,
+    -1,
+};
+
+static const int16_t goldenGainOut0[37] = {
+    -15, 12274, 5526, 32767, -21197, 14403, -22820, -31944, 14125, 9141, 8806, -22278,
+    26311, -11193, -32768, 19600, 26844, -32768, 31737, -4262, -15138, 32767, -4917, -2876,
+    -8448, 0, -17579, 6333, -32768, -32768, 32767, -28209, -4232, -2652, -32768, -30207,
+    -2,
+};
+
+static const int16_t goldenGainOut1[37] = {
+    10, -8183, -3684, -32767, 14131, -9602, 15213, 21296, -9417, -6094, -5871, 14852,
+    -17541, 7462, 32767, -13067, -17896, 23551, -21158, 2841, 10092, -32573, 3278, 1917,
+    5632, 0, 11719, -4222, 26145, 22996, -22773, 18806, 2821, 1768, 28815, 20138,
+    1,
+};
+
+static const int16_t goldenGainOut2[37] = {
+    -10, 8183, 3684, 32767, -14131, 9602, -15213, -21296, 9417, 6094, 5871, -14852,
+    17541, -7462, -32768, 13067, 17896, -23551, 21158, -2841, -10092, 32573, -3278, -1917,
+    -5632, 0, -11719, 4222, -26145, -22996, 22773, -18806, -2821, -1768, -28815, -20138,
+    -1,
+};
+
+static const int16_t goldenGainOut3[37] = {
+    -15, 11572, 5209, 32767, -19984, 13579, -21514, -30117, 13317, 8618, 8302, -21004,
+    24806, -10553, -32768, 18479, 25308, -32768, 29921, -4018, -14272, 32767, -4636, -2711,
+    -7965, 0, -16573, 5970, -32768, -32521, 32205, -26596, -3990, -2501, -32768, -28479,
+    -2,
+};
+
+static const int16_t goldenLevelsIn[152] = {
+    -6697, -28988, 0, -20051, -29470, 2163, -11472, -17495, -27346, -18225, -3492, 26981,
+    -10694, -1, 4843, -10168, 14049, 7174, -3385, 12532, 24605, -3438, -2973, 26720,
+    1, -7911, -23074, 29631, -21876, 30165, 16874, -29477, -7304, -26031, -27978, 32766,
+    7095, -16604, -30067, 9282, -17325, -22128, 17033, 17038, -13649, -12612, -32767, 32325,
+    -1638, 25291, 6824, -17983, 5478, 24743, 14676, 12541, 8690, 32767, 24643, -26944,
+    -8199, 27454, -16993, 24300, -32075, -694, -27461, 32216, -32768, -27343, -23530, -15977,
+    -24700, 21357, -5214, -8141, 12272, -18071, 8174, 0, 19599, 23324, -31963, 19706,
+    8875, 3336, 11425, 16070, 16007, -3660, -1, -3619, -32430, 15395, 29984, -12583,
+    24734, 30591, -15540, 32661, -5974, 1, 3227, -14280, -32751, -6794, -10377, 12260,
+    3149, -7422, 29715, 26192, 32766, 8265, 11598, 15983, -26756, 30725, -12198, 21131,
+    -20632, -28799, -26586, -32767, -29593, 23060, -23875, 4274, -30717, 896, -21063, -31234,
+    -24225, -10324, 32767, 27765, 1034, -2949, -15720, 23281, 22230, 23895, 28740, -19155,
+    2658, -32768, 30707, 19632, 30505, 27310, -24497, -31780,
+};
+
+static const uint16_t goldenPeak[8] = {
+    32766, 32768, 31963, 32767, 32768, 30725, 32767, 32325,
+};
+
+static const uint64_t goldenSumSq[8] = {
+    7836328733ull, 8143986526ull, 6909914397ull, 10533070146ull,
+    8404301193ull, 7003722186ull, 8692494379ull, 8045487477ull,
+};
+
+static const int16_t goldenBiquadIn[72] = {
+    23781, -31814, -3477, 456, -7583, 8582, 19015, 29300, 17309, -12270, 0, 17379,
+    16864, 31897, -9378, 15167, -25588, 18773, 20330, 19547, 27896, -1, 9681, -1994,
+    21303, 24740, 19981, 25026, -5165, -7408, -16887, -10226, 1, 29231, 8252, 12741,
+    26394, 587, 1064, 9537, -9498, 30759, 15060, 32766, -11139, -16526, 28611, 12352,
+    15225, 24766, 17695, 4204, 5685, -13622, -32767, 5179, -14504, -8015, -13930, -18153,
+    260, -10515, -5854, -12365, 10608, 32767, -2839, 30062, -19441, 27804, -2395, 31354,
+};
+
+static const int16_t goldenBiquadOut[72] = {
+    28534, -32768, -4172, 21548, -30595, 7225, 32767, 15494, 26478, -2250, 22847, 32767,
+    6181, 32767, 4896, 11925, -25643, 15019, 30204, -5874, 32732, 19752, 2442, 15595,
+    32207, 32767, 27871, 32767, 20306, -1288, -14109, -1062, -13564, 8494, -3858, -6137,
+    25208, -13083, -6721, 26654, -23343, 32767, 30655, 24596, 10593, -13203, 32767, 17158,
+    -11630, 32767, 18985, -20401, 15722, -15926, -32768, 3115, -32768, -9923, -29709, -32768,
+    15583, -32768, -21859, 24965, -8604, 29979, 32767, 32767, 5007, 32767, 25944, 32767,
+};
+
+static const int16_t goldenPlanarIn[48] = {
+    -32213, -18808, 22561, -15290, 5639, 32766, -19660, 21853, -8494, 2979, -12640, -5543,
+    5662, -16641, 13516, -11499, -32767, 30250, 19483, -11848, -29807, -13578, -28937, 20836,
+    20429, -24446, 9107, 32767, 8144, 7113, 17102, 26095, 26876, -21627, -16934, 29195,
+    6376, 31489, -32768, -8794, 9191, -9324, -14787, 11826, 6019, 7424, -30407, -1154,
+};
+
+static const int16_t goldenPlanarOut[48] = {
+    -32213, -8494, -32767, 20429, 26876, 9191, -18808, 2979, 30250, -24446, -21627, -9324,
+    22561, -12640, 19483, 9107, -16934, -14787, -15290, -5543, -11848, 32767, 29195, 11826,
+    5639, 5662, -29807, 8144, 6376, 6019, 32766, -16641, -13578, 7113, 31489, 7424,
+    -19660, 13516, -28937, 17102, -32768, -30407, 21853, -11499, 20836, 26095, -8794, -1154,
+};
+
+// 增益向量：(gain, shift)与期望输出
+static const struct {
+    int16_t gain;
+    uint32_t shift;
+    const int16_t *out;
+} gainCases[] = {
+    { 3, 1, goldenGainOut0 },           // 1.5倍，大量饱和
+    { -32768, 15, goldenGainOut1 },     // 取反，-32768饱和到32767
+    { 16384, 14, goldenGainOut2 },      // 单位增益
+    { 23170, 14, goldenGainOut3 },      // 约+3dB，算术右移向负无穷截断
+};
+
+// 两节级联：低频高通和一个系数较大的节（触发节间饱和）
+static const DspBiquadCoeffs goldenBiquadCoeffs[2] = {
+    { .b0 = 16104, .b1 = -32208, .b2 = 16104, .a1 = -32199, .a2 = 15834 },
+    { .b0 = 20000, .b1 = -9000, .b2 = 6000, .a1 = -20000, .a2 = 12000 },
+};
+
+#define GOLDEN_WORK_SAMPLES  160     // 最长的向量（8通道x19帧）
+
+static void record_failure(uint32_t *failures, const char **firstFailure, const char *name) {
+    if (*failures == 0 && firstFailure != NULL) {
+        *firstFailure = name;
+    }
+    (*failures)++;
+}
+
+uint32_t dsp_golden_check(const char **firstFailure) {
+    _Alignas(16) int16_t work[GOLDEN_WORK_SAMPLES];
+    _Alignas(16) int16_t out[GOLDEN_WORK_SAMPLES];
+    uint32_t failures = 0;
+
+    // 增益：对齐的整段（向量路径+尾部）以及原地运算
+    for (size_t i = 0; i < sizeof(gainCases) / sizeof(gainCases[0]); i++) {
+        size_t n = sizeof(goldenGainIn) / sizeof(goldenGainIn[0]);
+        memcpy(work, goldenGainIn, sizeof(goldenGainIn));
+        dsp_gain_s16(work, out, n, gainCases[i].gain, gainCases[i].shift);
+        dsp_gain_s16(work, work, n, gainCases[i].gain, gainCases[i].shift);
+        if (memcmp(out, gainCases[i].out, n * sizeof(int16_t)) != 0 ||
+            memcmp(work, gainCases[i].out, n * sizeof(int16_t)) != 0) {
+            record_failure(&failures, firstFailure, "gain");
+        }
+    }
+
+    // 峰值和平方和（8通道交织）
+    uint32_t levelFrames = sizeof(goldenLevelsIn) / sizeof(goldenLevelsIn[0]) / 8;
+    memcpy(work, goldenLevelsIn, sizeof(goldenLevelsIn));
+    uint16_t peak[8];
+    dsp_peak_s16x8(work, levelFrames, peak);
+    if (memcmp(peak, goldenPeak, sizeof(peak)) != 0) {
+        record_failure(&failures, firstFailure, "peak");
+    }
+    uint64_t sums[8];
+    dsp_sum_squares_s16(work, 8, levelFrames, sums);
+    if (memcmp(sums, goldenSumSq, sizeof(sums)) != 0) {
+        record_failure(&failures, firstFailure, "sum of squares");
+    }
+    // 通用通道数路径：把8通道当作4个双通道帧组的2通道数据，逐通道求和后应一致
+    uint64_t pairSums[2];
+    dsp_sum_squares_s16(work, 2, levelFrames * 4, pairSums);
+    if (pairSums[0] != goldenSumSq[0] + goldenSumSq[2] + goldenSumSq[4] + goldenSumSq[6] ||
+        pairSums[1] != goldenSumSq[1] + goldenSumSq[3] + goldenSumSq[5] + goldenSumSq[7]) {
+        record_failure(&failures, firstFailure, "sum of squares (generic)");
+    }
+
+    // 双二阶级联：整块一次滤波，以及分两段滤波（检查状态的保存）
+    DspBiquadCascade bq;
+    uint32_t bqChannels = 3;
+    uint32_t bqFrames = sizeof(goldenBiquadIn) / sizeof(goldenBiquadIn[0]) / bqChannels;
+    dsp_biquad_init(&bq, goldenBiquadCoeffs, 2, bqChannels);
+    memcpy(work, goldenBiquadIn, sizeof(goldenBiquadIn));
+    dsp_biquad_s16(&bq, work, bqFrames);
+    if (memcmp(work, goldenBiquadOut, sizeof(goldenBiquadOut)) != 0) {
+        record_failure(&failures, firstFailure, "biquad");
+    }
+    dsp_biquad_reset(&bq);
+    memcpy(work, goldenBiquadIn, sizeof(goldenBiquadIn));
+    dsp_biquad_s16(&bq, work, 5);
+    dsp_biquad_s16(&bq, work + 5 * bqChannels, bqFrames - 5);
+    if (memcmp(work, goldenBiquadOut, sizeof(goldenBiquadOut)) != 0) {
+        record_failure(&failures, firstFailure, "biquad (split)");
+    }
+
+    // 解交织（8通道展开路径）
+    uint32_t planarFrames = sizeof(goldenPlanarIn) / sizeof(goldenPlanarIn[0]) / 8;
+    memcpy(work, goldenPlanarIn, sizeof(goldenPlanarIn));
+    deinterleave_s16(work, out, 8, planarFrames);
+    if (memcmp(out, goldenPlanarOut, sizeof(goldenPlanarOut)) != 0) {
+        record_failure(&failures, firstFailure, "deinterleave");
+    }
+
+    return failures;
+}
@@ -0,0 +1,17 @@
+#ifndef DSP_GOLDEN_H
+#define DSP_GOLDEN_H
+
+#include <stdint.h>
+
+// DSP内核的黄金向量：输入和期望输出由独立的参考实现（整数运算）离线生成，
+// 覆盖饱和、-32768、向量路径之后的尾部和多节级联。
+//
+// 主机上用tools/dsp_bench检查可移植的C实现；设备上dsp_init用同一组向量检查PIE路径。
+// 缓冲区先拷贝到16字节对齐的工作区，使向量路径真正被执行。
+//
+// 不依赖ESP-IDF，可在主机上编译。
+
+// 按当前路径（C或PIE）运行所有黄金向量，返回不一致的向量数；firstFailure可为NULL
+uint32_t dsp_golden_check(const char **firstFailure);
+
+#endif /* DSP_GOLDEN_H */
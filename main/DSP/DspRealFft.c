@@ -0,0 +1,153 @@
+#include "DspRealFft.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DSP_PI  3.14159265358979323846
+
+bool dsp_real_fft_init(DspRealFft *fft, uint32_t n) {
+    memset(fft, 0, sizeof(*fft));
+    if (n < DSP_REAL_FFT_MIN_SIZE || n > DSP_REAL_FFT_MAX_SIZE || (n & (n - 1)) != 0) {
+        return false;
+    }
+    uint32_t m = n / 2;
+    // 基4蝶形要用到W^(3j)，表覆盖k < 3n/4
+    uint32_t tab = n / 4 * 3;
+    fft->n = n;
+    fft->m = m;
+    fft->cosTab = malloc(tab * sizeof(float));
+    fft->sinTab = malloc(tab * sizeof(float));
+    fft->bitrev = malloc(m * sizeof(uint16_t));
+    fft->re = malloc(m * sizeof(float));
+    fft->im = malloc(m * sizeof(float));
+    if (fft->cosTab == NULL || fft->sinTab == NULL || fft->bitrev == NULL || fft->re == NULL || fft->im == NULL) {
+        dsp_real_fft_deinit(fft);
+        return false;
+    }
+    for (uint32_t k = 0; k < tab; k++) {
+        fft->cosTab[k] = (float)cos(2.0 * DSP_PI * k / n);
+        fft->sinTab[k] = (float)sin(2.0 * DSP_PI * k / n);
+    }
+    uint32_t bits = 0;
+    while ((1u << bits) < m) {
+        bits++;
+    }
+    for (uint32_t i = 0; i < m; i++) {
+        uint32_t r = 0;
+        for (uint32_t b = 0; b < bits; b++) {
+            r |= ((i >> b) & 1u) << (bits - 1 - b);
+        }
+        fft->bitrev[i] = (uint16_t)r;
+    }
+    return true;
+}
+
+void dsp_real_fft_deinit(DspRealFft *fft) {
+    free(fft->cosTab);
+    free(fft->sinTab);
+    free(fft->bitrev);
+    free(fft->re);
+    free(fft->im);
+    memset(fft, 0, sizeof(*fft));
+}
+
+// m点复数FFT（原地，输入已按位反转排列，W = e^(-j2π/len)）
+static void fft_complex(DspRealFft *fft) {
+    float *re = fft->re;
+    float *im = fft->im;
+    const uint32_t m = fft->m, n = fft->n;
+
+    // log2(m)为奇数时先做一级基2
+    uint32_t L = 1;
+    if ((31 - __builtin_clz(m)) & 1u) {
+        for (uint32_t a = 0; a < m; a += 2) {
+            float tr = re[a + 1], ti = im[a + 1];
+            re[a + 1] = re[a] - tr;
+            im[a + 1] = im[a] - ti;
+            re[a] += tr;
+            im[a] += ti;
+        }
+        L = 2;
+    }
+
+    // 基4：位反转顺序下相邻的四段长L的子变换依次对应原序号模4余0、2、1、3，合并为长4L的变换
+    for (; L < m; L *= 4) {
+        uint32_t s = n / (4 * L);       // W_4L^j = W_n^(j*s)
+        for (uint32_t base = 0; base < m; base += 4 * L) {
+            for (uint32_t j = 0; j < L; j++) {
+                uint32_t i0 = base + j, i2 = i0 + L, i1 = i2 + L, i3 = i1 + L;
+                float w1r = fft->cosTab[j * s], w1i = -fft->sinTab[j * s];
+                float w2r = fft->cosTab[2 * j * s], w2i = -fft->sinTab[2 * j * s];
+                float w3r = fft->cosTab[3 * j * s], w3i = -fft->sinTab[3 * j * s];
+
+                float f0r = re[i0], f0i = im[i0];
+                float f2r = re[i2] * w2r - im[i2] * w2i, f2i = re[i2] * w2i + im[i2] * w2r;
+                float f1r = re[i1] * w1r - im[i1] * w1i, f1i = re[i1] * w1i + im[i1] * w1r;
+                float f3r = re[i3] * w3r - im[i3] * w3i, f3i = re[i3] * w3i + im[i3] * w3r;
+
+                float s02r = f0r + f2r, s02i = f0i + f2i;
+                float d02r = f0r - f2r, d02i = f0i - f2i;
+                float s13r = f1r + f3r, s13i = f1i + f3i;
+                float d13r = f1r - f3r, d13i = f1i - f3i;
+                // 输出位置j、j+L、j+2L、j+3L；-j*(f1 - f3) = (d13i, -d13r)
+                re[i0] = s02r + s13r;
+                im[i0] = s02i + s13i;
+                re[i0 + L] = d02r + d13i;
+                im[i0 + L] = d02i - d13r;
+                re[i0 + 2 * L] = s02r - s13r;
+                im[i0 + 2 * L] = s02i - s13i;
+                re[i0 + 3 * L] = d02r - d13i;
+                im[i0 + 3 * L] = d02i + d13r;
+            }
+        }
+    }
+}
+
+void dsp_real_fft_forward(DspRealFft *fft, const float *in, float *re, float *im) {
+    const uint32_t m = fft->m;
+    for (uint32_t i = 0; i < m; i++) {
+        uint32_t r = fft->bitrev[i];
+        fft->re[r] = in[2 * i];
+        fft->im[r] = in[2 * i + 1];
+    }
+    fft_complex(fft);
+
+    // 拆分：X[k] = E[k] + W^k O[k]，E = (Z[k] + conj(Z[m-k]))/2，O = -j(Z[k] - conj(Z[m-k]))/2
+    for (uint32_t k = 0; k < m; k++) {
+        uint32_t mk = (k == 0) ? 0 : m - k;
+        float ar = fft->re[k], ai = fft->im[k];
+        float br = fft->re[mk], bi = -fft->im[mk];
+        float er = (ar + br) * 0.5f, ei = (ai + bi) * 0.5f;
+        float or_ = (ai - bi) * 0.5f, oi = -(ar - br) * 0.5f;
+        float wr = fft->cosTab[k], wi = -fft->sinTab[k];
+        re[k] = er + or_ * wr - oi * wi;
+        im[k] = ei + or_ * wi + oi * wr;
+    }
+    // 奈奎斯特频点：E[0] - O[0]
+    re[m] = fft->re[0] - fft->im[0];
+    im[m] = 0.0f;
+}
+
+void dsp_real_fft_inverse(DspRealFft *fft, const float *re, const float *im, float *out) {
+    const uint32_t m = fft->m;
+    const float scale = 1.0f / m;
+
+    // 合并：E = (X[k] + conj(X[m-k]))/2，O = (X[k] - conj(X[m-k]))/2 * W^-k，Z[k] = E + jO；
+    // 逆变换用共轭：z = conj(FFT(conj(Z)))/m，所以按位反转位置存入conj(Z)
+    for (uint32_t k = 0; k < m; k++) {
+        float ar = re[k], ai = im[k];
+        float br = re[m - k], bi = -im[m - k];
+        float er = (ar + br) * 0.5f, ei = (ai + bi) * 0.5f;
+        float dr = (ar - br) * 0.5f, di = (ai - bi) * 0.5f;
+        float wr = fft->cosTab[k], wi = fft->sinTab[k];
+        float or_ = dr * wr - di * wi, oi = dr * wi + di * wr;
+        uint32_t r = fft->bitrev[k];
+        fft->re[r] = er - oi;
+        fft->im[r] = -(ei + or_);
+    }
+    fft_complex(fft);
+    for (uint32_t i = 0; i < m; i++) {
+        out[2 * i] = fft->re[i] * scale;
+        out[2 * i + 1] = -fft->im[i] * scale;
+    }
+}
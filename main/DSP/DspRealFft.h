@@ -0,0 +1,36 @@
+#ifndef DSP_REAL_FFT_H
+#define DSP_REAL_FFT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 实信号FFT/逆FFT（单精度浮点），用于需要复数频谱的分析（如GCC-PHAT）；只要功率谱时用DspFft。
+//
+// n点实信号打包为m = n/2点复数序列（偶数样本为实部、奇数样本为虚部），做m点复数FFT后拆分出
+// 0..m共m+1个频点。复数FFT按位反转输入、时域抽取：log2(m)为奇数时先做一级基2，其余每两级合并为
+// 一级基4蝶形（每个蝶形3次复数乘法，比两级基2少1/4）。旋转因子和位反转表在init时算好（malloc）。
+//
+// 不依赖ESP-IDF，可在主机上编译。
+
+#define DSP_REAL_FFT_MIN_SIZE   16
+#define DSP_REAL_FFT_MAX_SIZE   8192
+
+typedef struct {
+    uint32_t n;             // 实信号点数（2的幂）
+    uint32_t m;             // 复数FFT点数 n/2
+    float *cosTab;          // cos(2πk/n)，k < 3n/4
+    float *sinTab;
+    uint16_t *bitrev;       // m点的位反转下标
+    float *re;              // 工作缓冲区（m点）
+    float *im;
+} DspRealFft;
+
+bool dsp_real_fft_init(DspRealFft *fft, uint32_t n);
+void dsp_real_fft_deinit(DspRealFft *fft);
+
+// in为n个实数样本；re/im输出n/2 + 1个频点（频点k对应k*采样率/n），不归一化
+void dsp_real_fft_forward(DspRealFft *fft, const float *in, float *re, float *im);
+// forward的逆变换：re/im为n/2 + 1个频点（re[0]、re[n/2]以外的频点按共轭对称补全），out为n个样本（已除以n）
+void dsp_real_fft_inverse(DspRealFft *fft, const float *re, const float *im, float *out);
+
+#endif /* DSP_REAL_FFT_H */
@@ -0,0 +1,237 @@
+#include "FeatureExtractor.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DSP_PI  3.14159265358979323846
+
+static double hz_to_mel(double hz) {
+    return 2595.0 * log10(1.0 + hz / 700.0);
+}
+
+static double mel_to_hz(double mel) {
+    return 700.0 * (pow(10.0, mel / 2595.0) - 1.0);
+}
+
+bool feature_extractor_init(FeatureExtractor *fx, const FeatureConfig *config, float sampleRate, uint32_t channels) {
+    memset(fx, 0, sizeof(*fx));
+    if (sampleRate <= 0.0f || channels == 0 || channels > FEATURE_MAX_CHANNELS || config->bands == 0 ||
+        config->bands > FEATURE_MAX_BANDS) {
+        return false;
+    }
+    uint32_t report = (config->reportFrames > 0) ? config->reportFrames : (uint32_t)lroundf(sampleRate / 10.0f);
+    uint32_t n = config->frameSize;
+    if (n == 0) {
+        n = FEATURE_DEFAULT_FRAME;
+        while (n > report && n > FEATURE_MIN_FRAME) {
+            n /= 2;
+        }
+    }
+    if (n < FEATURE_MIN_FRAME || n > FEATURE_MAX_FRAME || (n & (n - 1)) != 0 || n > report) {
+        return false;
+    }
+    fx->channels = channels;
+    fx->sampleRate = sampleRate;
+    fx->reportFrames = report;
+    fx->frameSize = n;
+    fx->bands = config->bands;
+
+    // 频带边界：mel刻度等分，按最近的频点边界取整（频点k覆盖(k ± 0.5) x binHz），每个频带至少一个频点，
+    // 不含直流；最后一个频带不超过奈奎斯特频点
+    double binHz = (double)sampleRate / n;
+    double lowHz = (config->minHz > 0.0f) ? config->minHz : FEATURE_DEFAULT_MIN_HZ;
+    double highHz = (config->maxHz > 0.0f) ? config->maxHz : FEATURE_DEFAULT_MAX_HZ;
+    highHz = (highHz < sampleRate / 2.0) ? highHz : sampleRate / 2.0;
+    if (highHz <= lowHz) {
+        return false;
+    }
+    double melLow = hz_to_mel(lowHz), melHigh = hz_to_mel(highHz);
+    uint32_t prev = 0;
+    for (uint32_t b = 0; b <= fx->bands; b++) {
+        uint32_t edge = (uint32_t)lround(mel_to_hz(melLow + (melHigh - melLow) * b / fx->bands) / binHz + 0.5);
+        edge = (edge < 1) ? 1 : edge;
+        edge = (b > 0 && edge <= prev) ? prev + 1 : edge;
+        if (edge > n / 2 + 1) {
+            return false;
+        }
+        if (b > 0) {
+            fx->binLow[b - 1] = (uint16_t)prev;
+            fx->binHigh[b - 1] = (uint16_t)edge;
+        }
+        prev = edge;
+    }
+
+    if (!dsp_real_fft_init(&fx->fft, n)) {
+        return false;
+    }
+    fx->window = malloc(n * sizeof(float));
+    fx->history = malloc((size_t)channels * n * sizeof(float));
+    fx->frame = malloc(n * sizeof(float));
+    fx->re = malloc((n / 2 + 1) * sizeof(float));
+    fx->im = malloc((n / 2 + 1) * sizeof(float));
+    if (fx->window == NULL || fx->history == NULL || fx->frame == NULL || fx->re == NULL || fx->im == NULL) {
+        feature_extractor_deinit(fx);
+        return false;
+    }
+
+    // 周期Hann窗；单边谱的每个频点在双边谱中出现两次，Parseval换算为加窗前的均方值
+    double energy = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        fx->window[i] = (float)(0.5 - 0.5 * cos(2.0 * DSP_PI * i / n));
+        energy += (double)fx->window[i] * fx->window[i];
+    }
+    fx->bandScale = (float)(2.0 / (n * energy));
+    feature_extractor_reset(fx);
+    return true;
+}
+
+void feature_extractor_deinit(FeatureExtractor *fx) {
+    dsp_real_fft_deinit(&fx->fft);
+    free(fx->window);
+    free(fx->history);
+    free(fx->frame);
+    free(fx->re);
+    free(fx->im);
+    fx->window = NULL;
+    fx->history = NULL;
+    fx->frame = NULL;
+    fx->re = NULL;
+    fx->im = NULL;
+}
+
+// 清除累加值，准备下一个结果
+static void clear_report(FeatureExtractor *fx) {
+    fx->reportFilled = 0;
+    fx->windows = 0;
+    memset(fx->sumSquare, 0, sizeof(fx->sumSquare));
+    memset(fx->peak, 0, sizeof(fx->peak));
+    memset(fx->crossings, 0, sizeof(fx->crossings));
+    memset(fx->bandSum, 0, sizeof(fx->bandSum));
+}
+
+void feature_extractor_reset(FeatureExtractor *fx) {
+    clear_report(fx);
+    fx->filled = 0;
+    fx->started = false;
+    fx->primed = false;
+}
+
+void feature_extractor_band_hz(const FeatureExtractor *fx, uint32_t band, float *lowHz, float *highHz) {
+    float binHz = fx->sampleRate / fx->frameSize;
+    *lowHz = (fx->binLow[band] - 0.5f) * binHz;
+    *highHz = (fx->binHigh[band] - 0.5f) * binHz;
+}
+
+// 一个通道的frames帧：转换为满量程归一化的浮点样本存入窗口，同时累加平方和、峰值和过零次数。
+// 平方和先在局部累加（最多一个窗口的帧数），再加到结果的累加值上，减小单精度的舍入误差
+static void load_channel(FeatureExtractor *fx, uint32_t ch, const uint8_t *src, uint32_t sampleBytes,
+                         uint32_t frames, float *dst) {
+    const size_t step = (size_t)fx->channels * sampleBytes;
+    float sum = 0.0f, peak = fx->peak[ch];
+    uint32_t crossings = 0;
+    bool negative = fx->primed ? fx->negative[ch] : false;
+    bool primed = fx->primed;
+
+    for (uint32_t i = 0; i < frames; i++, src += step) {
+        float x;
+        if (sampleBytes == 2) {
+            x = *(const int16_t *)src * (1.0f / 32768.0f);
+        } else {
+            // 24位打包或32位容器（小端）：高24位
+            const uint8_t *s = src + sampleBytes - 3;
+            int32_t v = (int32_t)(((uint32_t)s[0] << 8) | ((uint32_t)s[1] << 16) | ((uint32_t)s[2] << 24));
+            x = v * (1.0f / 2147483648.0f);
+        }
+        dst[i] = x;
+        sum += x * x;
+        float a = fabsf(x);
+        peak = (a > peak) ? a : peak;
+        bool neg = x < 0.0f;
+        crossings += (primed && neg != negative);
+        negative = neg;
+        primed = true;
+    }
+    fx->sumSquare[ch] += sum;
+    fx->peak[ch] = peak;
+    fx->crossings[ch] += crossings;
+    fx->negative[ch] = negative;
+}
+
+// 一个完整的窗口：每个通道加窗做实FFT，把各频带的功率累加到结果
+static void analyze_window(FeatureExtractor *fx) {
+    const uint32_t n = fx->frameSize;
+    for (uint32_t ch = 0; ch < fx->channels; ch++) {
+        const float *x = fx->history + (size_t)ch * n;
+        for (uint32_t i = 0; i < n; i++) {
+            fx->frame[i] = x[i] * fx->window[i];
+        }
+        dsp_real_fft_forward(&fx->fft, fx->frame, fx->re, fx->im);
+        for (uint32_t b = 0; b < fx->bands; b++) {
+            float power = 0.0f;
+            for (uint32_t k = fx->binLow[b]; k < fx->binHigh[b]; k++) {
+                power += fx->re[k] * fx->re[k] + fx->im[k] * fx->im[k];
+            }
+            fx->bandSum[ch][b] += power * fx->bandScale;
+        }
+    }
+    fx->windows++;
+}
+
+static void finish_report(FeatureExtractor *fx, uint64_t samplePos) {
+    FeatureResult *r = &fx->result;
+    float windows = (fx->windows > 0) ? (float)fx->windows : 1.0f;
+    r->samplePos = samplePos;
+    r->windows = fx->windows;
+    for (uint32_t ch = 0; ch < fx->channels; ch++) {
+        r->rms[ch] = sqrtf(fx->sumSquare[ch] / fx->reportFrames);
+        r->peak[ch] = fx->peak[ch];
+        r->zcrHz[ch] = fx->crossings[ch] * fx->sampleRate / (2.0f * fx->reportFrames);
+        for (uint32_t b = 0; b < fx->bands; b++) {
+            r->band[ch][b] = fx->bandSum[ch][b] / windows;
+        }
+    }
+    atomic_fetch_add(&fx->count, 1);
+    clear_report(fx);
+}
+
+uint32_t feature_extractor_feed(FeatureExtractor *fx, const void *in, uint32_t sampleBytes, uint32_t frames,
+                                uint64_t firstSample, bool *ready) {
+    const uint32_t n = fx->frameSize;
+    const uint8_t *src = in;
+    uint32_t consumed = 0;
+    *ready = false;
+
+    // 丢帧或重新开始录音：已收到的样本不再连续
+    if (!fx->started || firstSample != fx->nextSample) {
+        feature_extractor_reset(fx);
+        fx->started = true;
+    }
+
+    while (consumed < frames) {
+        uint32_t take = frames - consumed;
+        take = (take < n - fx->filled) ? take : n - fx->filled;
+        take = (take < fx->reportFrames - fx->reportFilled) ? take : fx->reportFrames - fx->reportFilled;
+        for (uint32_t ch = 0; ch < fx->channels; ch++) {
+            load_channel(fx, ch, src + (size_t)ch * sampleBytes, sampleBytes, take,
+                         fx->history + (size_t)ch * n + fx->filled);
+        }
+        fx->primed = true;
+        src += (size_t)take * fx->channels * sampleBytes;
+        consumed += take;
+        fx->filled += take;
+        fx->reportFilled += take;
+
+        // 窗口首尾相接，跨越结果边界的窗口计入它完成时的结果
+        if (fx->filled == n) {
+            analyze_window(fx);
+            fx->filled = 0;
+        }
+        if (fx->reportFilled == fx->reportFrames) {
+            finish_report(fx, firstSample + consumed - fx->reportFrames);
+            *ready = true;
+            break;
+        }
+    }
+    fx->nextSample = firstSample + consumed;
+    return consumed;
+}
@@ -0,0 +1,100 @@
+#ifndef FEATURE_EXTRACTOR_H
+#define FEATURE_EXTRACTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "DspRealFft.h"
+
+// 低速率声学特征：从交织的多路样本（16、24或32位）中按固定间隔为每个通道计算一组特征，
+// 用于在长时间的录音中快速定位感兴趣的片段，不必读回全部样本
+//
+// 每reportFrames帧（默认100ms）输出一个结果，每个通道：
+//  - RMS和峰值（满量程归一化，1.0 = 0dBFS）
+//  - 过零率，换算为频率：过零次数 / 2 / 时长（单频信号即为其频率）
+//  - bands个频带的能量：mel刻度上等分minHz..maxHz，每个频带至少一个FFT频点（低频处频点比mel间隔
+//    还宽时，频带边界按频点顺延）。每frameSize帧（不重叠）加Hann窗做一次实FFT，频带内的功率按窗的
+//    能量归一化为均方值（全部频带之和约等于通带内的RMS²），结果为期间完成的各个窗口的平均
+//
+// RMS、峰值和过零率准确覆盖结果的reportFrames帧；频带能量取在这期间完成的窗口，比时域特征最多滞后
+// 一个窗口。输入不连续（丢帧、重新开始录音）时丢弃未完成的结果，从下一帧重新开始计时。
+//
+// 运算量：每个通道每帧3次乘加（RMS、峰值、过零），每frameSize帧一次frameSize点实FFT和频带求和。
+// 缓冲区在init时分配（malloc）。不依赖ESP-IDF，可在主机上编译（见tools/feature_bench）。
+
+#define FEATURE_MAX_CHANNELS    16
+#define FEATURE_MAX_BANDS       32
+#define FEATURE_MIN_FRAME       128
+#define FEATURE_MAX_FRAME       4096
+#define FEATURE_DEFAULT_FRAME   2048        // 不超过reportFrames时的默认FFT长度
+#define FEATURE_DEFAULT_MIN_HZ  50.0f
+#define FEATURE_DEFAULT_MAX_HZ  20000.0f    // 不超过采样率的一半
+
+typedef struct {
+    uint32_t reportFrames;          // 每个结果覆盖的帧数，0: 采样率 / 10（100ms）
+    uint32_t frameSize;             // FFT长度（2的幂，FEATURE_MIN_FRAME..FEATURE_MAX_FRAME，不超过reportFrames），
+                                    // 0: 不超过reportFrames的FEATURE_DEFAULT_FRAME
+    uint32_t bands;                 // 1..FEATURE_MAX_BANDS
+    float minHz;                    // 频带范围，0: 默认值
+    float maxHz;
+} FeatureConfig;
+
+// 一个结果（均为线性值）
+typedef struct {
+    uint64_t samplePos;             // 覆盖的第一帧（与输入的firstSample同一时间轴）
+    uint32_t windows;               // 参与频带能量平均的FFT窗口数
+    float rms[FEATURE_MAX_CHANNELS];
+    float peak[FEATURE_MAX_CHANNELS];
+    float zcrHz[FEATURE_MAX_CHANNELS];
+    float band[FEATURE_MAX_CHANNELS][FEATURE_MAX_BANDS];     // 均方值
+} FeatureResult;
+
+typedef struct {
+    uint32_t channels;
+    float sampleRate;
+    uint32_t reportFrames;
+    uint32_t frameSize;
+    uint32_t bands;
+    uint16_t binLow[FEATURE_MAX_BANDS];     // 每个频带的FFT频点[binLow, binHigh)
+    uint16_t binHigh[FEATURE_MAX_BANDS];
+    float bandScale;                // |X|²换算为均方值
+    DspRealFft fft;
+    float *window;                  // Hann窗（frameSize）
+    float *history;                 // channels x frameSize，当前窗口已收到的样本（满量程归一化）
+    float *frame;                   // frameSize
+    float *re;                      // frameSize/2 + 1
+    float *im;
+
+    // 流式状态
+    uint32_t filled;                // 当前窗口的帧数
+    uint32_t reportFilled;          // 当前结果的帧数
+    uint64_t nextSample;            // 下一次输入预期的firstSample
+    bool started;
+    bool primed;                    // negative中已有上一个样本的符号
+    uint32_t windows;
+    float sumSquare[FEATURE_MAX_CHANNELS];
+    float peak[FEATURE_MAX_CHANNELS];
+    uint32_t crossings[FEATURE_MAX_CHANNELS];
+    bool negative[FEATURE_MAX_CHANNELS];    // 上一个样本的符号
+    float bandSum[FEATURE_MAX_CHANNELS][FEATURE_MAX_BANDS];
+
+    FeatureResult result;           // 最近完成的结果（处理任务使用）
+    atomic_uint count;              // 结果数（任意任务无锁读取）
+} FeatureExtractor;
+
+// 按配置计算频带并分配缓冲区。配置无效、频带数超过可用的FFT频点或分配失败时返回false
+bool feature_extractor_init(FeatureExtractor *fx, const FeatureConfig *config, float sampleRate, uint32_t channels);
+void feature_extractor_deinit(FeatureExtractor *fx);
+// 丢弃未完成的结果（开始新的录音时调用）
+void feature_extractor_reset(FeatureExtractor *fx);
+
+// 频带b的频率范围（Hz，按FFT频点）
+void feature_extractor_band_hz(const FeatureExtractor *fx, uint32_t band, float *lowHz, float *highHz);
+
+// 送入最多frames帧交织的样本（sampleBytes为2: int16；3或4: 小端24位打包或32位容器），firstSample为
+// 第一帧的序号，与上一次输入不连续时自动reset。完成一个结果时停止，置*ready，结果在fx->result中；
+// 返回消耗的帧数，调用者接着送入剩余的帧（firstSample相应增加）
+uint32_t feature_extractor_feed(FeatureExtractor *fx, const void *in, uint32_t sampleBytes, uint32_t frames,
+                                uint64_t firstSample, bool *ready);
+
+#endif /* FEATURE_EXTRACTOR_H */
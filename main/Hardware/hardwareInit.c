@@ -3,7 +3,27 @@
 static const char *TAG = "HardwareInit";
 
 i2s_chan_handle_t rx_chan;  // 没有static关键字
+
+// 当前TDM格式，默认与hardwareInit.h中的常量一致
+static uint32_t tdm_sample_rate = TDM_SAMPLE_RATE;
+static uint32_t tdm_data_bits = TDM_BIT_WIDTH;
+static uint32_t tdm_slot_bits = TDM_BIT_WIDTH;
+static uint32_t tdm_mclk_multiple = TDM_MCLK_MULTIPLE;
+
+void tdm_set_format(uint32_t sample_rate, uint32_t data_bits, uint32_t slot_bits, uint32_t mclk_multiple)
+{
+    tdm_sample_rate = sample_rate;
+    tdm_data_bits = data_bits;
+    tdm_slot_bits = slot_bits;
+    tdm_mclk_multiple = mclk_multiple;
+}
+
 esp_err_t tdm_init(void)
+{
+    return tdm_init_dma(TDM_DMA_DESC_NUM, TDM_DMA_FRAME_NUM);
+}
+
+esp_err_t tdm_init_dma(uint32_t dma_desc_num, uint32_t dma_frame_num)
 {
     esp_err_t ret = ESP_OK;
     
@@ -11,6 +31,8 @@ esp_err_t tdm_init(void)
     
     // 步骤1: 配置I2S通道
     i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_AUTO, I2S_ROLE_MASTER);
+    chan_cfg.dma_desc_num = dma_desc_num;
+    chan_cfg.dma_frame_num = dma_frame_num;
     // 由于我们只需要接收数据，所以只分配RX通道
     ret = i2s_new_channel(&chan_cfg, NULL, &rx_chan);
     if (ret != ESP_OK) {
@@ -21,11 +43,11 @@ esp_err_t tdm_init(void)
     // 步骤2: 配置TDM模式
     i2s_tdm_config_t tdm_cfg = {
         // 时钟配置
-        .clk_cfg = I2S_TDM_CLK_DEFAULT_CONFIG(TDM_SAMPLE_RATE),
+        .clk_cfg = I2S_TDM_CLK_DEFAULT_CONFIG(tdm_sample_rate),
         
-        // 槽位配置: 8个通道, 16位宽度, MSB对齐
+        // 槽位配置: 8个通道, 位宽由tdm_set_format设置, MSB对齐
         .slot_cfg = I2S_TDM_PHILIPS_SLOT_DEFAULT_CONFIG(
-            I2S_DATA_BIT_WIDTH_16BIT,    // 每个通道16位
+            (i2s_data_bit_width_t)tdm_data_bits,    // 每个通道的数据位宽
             I2S_SLOT_MODE_STEREO,        // 立体声基础模式
             // 启用所有8个槽位
             I2S_TDM_SLOT0 | I2S_TDM_SLOT1 | I2S_TDM_SLOT2 | I2S_TDM_SLOT3 |
@@ -47,14 +69,18 @@ esp_err_t tdm_init(void)
         },
     };
     
+    // 槽位宽度与ADAU7118的SPT槽位宽度一致
+    tdm_cfg.slot_cfg.slot_bit_width = (i2s_slot_bit_width_t)tdm_slot_bits;
+    
     // 多通道TDM模式需要较高的MCLK倍频来确保BCLK分频器足够大
-    tdm_cfg.clk_cfg.mclk_multiple = I2S_MCLK_MULTIPLE_512;
+    tdm_cfg.clk_cfg.mclk_multiple = (i2s_mclk_multiple_t)tdm_mclk_multiple;
     
     // 初始化TDM模式
     ret = i2s_channel_init_tdm_mode(rx_chan, &tdm_cfg);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize I2S TDM mode: %s", esp_err_to_name(ret));
         i2s_del_channel(rx_chan);
+        rx_chan = NULL;
         return ret;
     }
     
@@ -63,11 +89,15 @@ esp_err_t tdm_init(void)
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to enable I2S channel: %s", esp_err_to_name(ret));
         i2s_del_channel(rx_chan);
+        rx_chan = NULL;
         return ret;
     }
     
     ESP_LOGI(TAG, "TDM interface initialized successfully");
-    ESP_LOGI(TAG, "Sample rate: %d Hz, 8 channels, 16-bit", TDM_SAMPLE_RATE);
+    ESP_LOGI(TAG, "Sample rate: %u Hz, %d channels, %u-bit (%u-bit slots), MCLK x%u",
+             (unsigned)tdm_sample_rate, TDM_CHANNELS, (unsigned)tdm_data_bits,
+             (unsigned)tdm_slot_bits, (unsigned)tdm_mclk_multiple);
+    ESP_LOGI(TAG, "DMA: %u descriptors x %u frames", (unsigned)dma_desc_num, (unsigned)dma_frame_num);
     
     return ret;
 }
@@ -80,6 +110,7 @@ void tdm_deinit(void)
     if (rx_chan) {
         i2s_channel_disable(rx_chan);
         i2s_del_channel(rx_chan);
+        rx_chan = NULL;
     }
 }
 
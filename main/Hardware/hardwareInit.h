@@ -23,17 +23,32 @@
 #define TDM_MCLK_IO         4  // 主时钟引脚（如需要）
 #define TDM_MASTER_NUM      I2S_NUM_0                   // I2S编号
 
+// 多板同步：共用的参考脉冲（例如GPS的PPS或主板输出的方波）从这里输入，上升沿有效
+#define SYNC_PULSE_IO       5
+
 // TDM配置常量
 #define TDM_SAMPLE_RATE  96000         // 采样率96kHz
 #define TDM_CHANNELS     8             // 8通道
 #define TDM_BIT_WIDTH    16            // 16位位宽
+#define TDM_DEC_RATIO    32            // ADAU7118抽取比（PDM时钟 = 采样率 x 32）
+#define TDM_MCLK_MULTIPLE 512          // MCLK倍频
 #define TDM_BUFFER_SIZE   2048            // 接收缓冲区大小
 
+// I2S DMA描述符配置（每帧字节数 = DMA_FRAME_NUM * 通道数 * 位宽/8，需 <= 4092）
+#define TDM_DMA_DESC_NUM     6             // 默认DMA描述符数量
+#define TDM_DMA_FRAME_NUM    240           // 每个DMA描述符包含的采样帧数
+
 
 
 extern i2s_chan_handle_t rx_chan;
 void i2c_master_init(void);
 esp_err_t tdm_init(void);
+// 设置TDM采样率、数据位宽、槽位宽度和MCLK倍频（在下一次tdm_init/tdm_init_dma时生效）
+void tdm_set_format(uint32_t sample_rate, uint32_t data_bits, uint32_t slot_bits, uint32_t mclk_multiple);
+// 按指定DMA描述符配置初始化TDM接口
+esp_err_t tdm_init_dma(uint32_t dma_desc_num, uint32_t dma_frame_num);
+// 释放TDM资源
+void tdm_deinit(void);
 
 
 #endif 
\ No newline at end of file
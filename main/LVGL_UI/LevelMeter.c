@@ -0,0 +1,100 @@
+#include "LevelMeter.h"
+#include "LevelMeterUI.h"
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "LevelMeter";
+
+#define FRAME_STEP_MS   20
+#define AVG_SHIFT       3       // 滑动平均的权重1/8
+
+// 界面状态只由显示任务访问
+static LevelMeterUI meterUi;
+static TaskHandle_t meterTask = NULL;
+
+// 显示任务写入，任意任务读取
+static atomic_uint statFrames;
+static atomic_uint statFrameMs = LEVEL_METER_FRAME_MS;
+static atomic_uint statAvgUs;
+static atomic_uint statMaxUs;
+static atomic_uint statAvgPixels;
+
+// 按平均CPU时间调整帧周期
+static uint32_t adjust_frame_ms(uint32_t frameMs, uint32_t avgUs) {
+    uint32_t permille = avgUs / frameMs;    // us / ms = 千分比
+    if (permille > LEVEL_METER_BUDGET_PERMILLE && frameMs < LEVEL_METER_MAX_FRAME_MS) {
+        ESP_LOGW(TAG, "Display uses %u.%u%% CPU, slowing to %u ms per frame", (unsigned)(permille / 10),
+                 (unsigned)(permille % 10), (unsigned)(frameMs + FRAME_STEP_MS));
+        return frameMs + FRAME_STEP_MS;
+    }
+    if (permille < LEVEL_METER_BUDGET_PERMILLE / 2 && frameMs > LEVEL_METER_FRAME_MS) {
+        return frameMs - FRAME_STEP_MS;
+    }
+    return frameMs;
+}
+
+static void level_meter_task(void *arg) {
+    LevelTap *tap = arg;
+    if (!level_meter_ui_create(&meterUi, lv_scr_act())) {
+        ESP_LOGE(TAG, "Failed to create the level meter screen");
+        meterTask = NULL;
+        vTaskDelete(NULL);
+        return;
+    }
+    ESP_LOGI(TAG, "Level meter task started");
+
+    uint32_t frameMs = LEVEL_METER_FRAME_MS;
+    uint32_t avgUs = 0;
+    uint32_t avgPixels = 0;
+    uint32_t maxUs = 0;
+    uint32_t frames = 0;
+    TickType_t lastWake = xTaskGetTickCount();
+    while (1) {
+        int64_t start = esp_timer_get_time();
+        uint32_t pixels = meterUi.invalidatedPixels;
+        const LevelSnapshot *snap = level_tap_read(tap, NULL);
+        level_meter_ui_update(&meterUi, snap, start);
+        lv_timer_handler();
+        uint32_t cost = (uint32_t)(esp_timer_get_time() - start);
+
+        avgUs += ((int32_t)cost - (int32_t)avgUs) >> AVG_SHIFT;
+        avgPixels += ((int32_t)(meterUi.invalidatedPixels - pixels) - (int32_t)avgPixels) >> AVG_SHIFT;
+        maxUs = (cost > maxUs) ? cost : maxUs;
+        frames++;
+        // 每秒左右检查一次预算
+        if (frames % (1000 / LEVEL_METER_FRAME_MS) == 0) {
+            frameMs = adjust_frame_ms(frameMs, avgUs);
+        }
+        atomic_store_explicit(&statFrames, frames, memory_order_relaxed);
+        atomic_store_explicit(&statFrameMs, frameMs, memory_order_relaxed);
+        atomic_store_explicit(&statAvgUs, avgUs, memory_order_relaxed);
+        atomic_store_explicit(&statMaxUs, maxUs, memory_order_relaxed);
+        atomic_store_explicit(&statAvgPixels, avgPixels, memory_order_relaxed);
+
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(frameMs));
+    }
+}
+
+esp_err_t level_meter_start(LevelTap *tap) {
+    if (meterTask != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (xTaskCreatePinnedToCore(level_meter_task, "level_meter", LEVEL_METER_TASK_STACK_SIZE, tap,
+                                LEVEL_METER_TASK_PRIORITY, &meterTask, LEVEL_METER_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create level meter task");
+        meterTask = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void level_meter_get_stats(LevelMeterStats *stats) {
+    stats->frames = atomic_load_explicit(&statFrames, memory_order_relaxed);
+    stats->frameMs = atomic_load_explicit(&statFrameMs, memory_order_relaxed);
+    stats->avgUs = atomic_load_explicit(&statAvgUs, memory_order_relaxed);
+    stats->maxUs = atomic_load_explicit(&statMaxUs, memory_order_relaxed);
+    stats->avgPixels = atomic_load_explicit(&statAvgPixels, memory_order_relaxed);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "LevelTap.h"
+
+// 录音时的电平表/频谱显示任务
+//
+// 任务在core 0上以低于文件任务的优先级运行，是唯一调用LVGL的任务（启动后其他任务不能再调用LVGL）。
+// 每帧从抽头读取最近的快照（无锁，不会阻塞采集任务），更新界面后运行lv_timer_handler刷新屏幕，
+// 并统计每帧的CPU时间（界面更新 + LVGL绘制）。平均值超过预算时延长帧周期，
+// 低于预算的一半时再缩短，保证显示不抢占写卡所在核的时间。
+// 预算参考tools/meter_bench在主机上测得的每帧绘制量。
+
+#define LEVEL_METER_TASK_STACK_SIZE (6*1024)
+#define LEVEL_METER_TASK_PRIORITY   2       // 低于文件任务和预备任务
+#define LEVEL_METER_TASK_CORE       0
+#define LEVEL_METER_FRAME_MS        40      // 与抽头的发布周期一致
+#define LEVEL_METER_MAX_FRAME_MS    200
+#define LEVEL_METER_BUDGET_PERMILLE 150     // 每帧CPU时间占帧周期的上限（15%）
+
+typedef struct {
+    uint32_t frames;                // 已绘制的帧数
+    uint32_t frameMs;               // 当前帧周期
+    uint32_t avgUs;                 // 每帧CPU时间（滑动平均）
+    uint32_t maxUs;
+    uint32_t avgPixels;             // 每帧标记为无效的像素数（滑动平均）
+} LevelMeterStats;
+
+// 创建界面和显示任务（LCD_Init和LVGL_Init之后调用）
+esp_err_t level_meter_start(LevelTap *tap);
+// 读取显示统计（任意任务）
+void level_meter_get_stats(LevelMeterStats *stats);
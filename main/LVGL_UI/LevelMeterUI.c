@@ -0,0 +1,291 @@
+#include "LevelMeterUI.h"
+#include <math.h>
+#include <string.h>
+
+// 布局（172x320）
+#define TITLE_Y         2
+#define METER_X         3
+#define METER_Y         22
+#define METER_H         140
+#define BAR_W           18
+#define BAR_GAP         3
+#define LABEL_Y         (METER_Y + METER_H + 2)
+#define SPEC_X          2
+#define SPEC_Y          184
+#define SPEC_H          130
+#define COL_W           3       // 2像素的列加1像素间隔
+#define SPEC_GROUP_COLS 8       // 频谱按8列一组合并无效区域
+#define HOLD_PX         2       // 峰值保持线的高度
+
+// 动态特性
+#define RMS_DECAY_DB_PER_S      20.0f
+#define HOLD_US                 1500000
+#define HOLD_DECAY_DB_PER_S     20.0f
+#define SPEC_DECAY_DB_PER_S     60.0f
+#define ZONE_YELLOW_DB          (-18.0f)
+#define ZONE_RED_DB             (-6.0f)
+
+#define COLOR_TROUGH    0x202020
+#define COLOR_INACTIVE  0x0C0C0C
+#define COLOR_GREEN     0x00C853
+#define COLOR_YELLOW    0xFFD600
+#define COLOR_RED       0xFF1744
+#define COLOR_HOLD      0xFFFFFF
+#define COLOR_SPECTRUM  0x29B6F6
+
+static float amp_to_db(float amplitude) {
+    return (amplitude > 1e-6f) ? 20.0f * log10f(amplitude) : -120.0f;
+}
+
+// 电平换算为像素高度（0..height）
+static int16_t db_to_px(float db, float dbMin, int16_t height) {
+    if (db <= dbMin) {
+        return 0;
+    }
+    if (db >= 0.0f) {
+        return height;
+    }
+    return (int16_t)lroundf((db - dbMin) / -dbMin * height);
+}
+
+// 填充x1..x2列中离底边[lo, hi)像素的行
+static void fill_rows(lv_draw_ctx_t *drawCtx, lv_draw_rect_dsc_t *dsc, lv_coord_t x1, lv_coord_t x2,
+                      lv_coord_t bottom, int16_t lo, int16_t hi, uint32_t color) {
+    if (hi <= lo) {
+        return;
+    }
+    lv_area_t area = { .x1 = x1, .x2 = x2, .y1 = bottom - hi + 1, .y2 = bottom - lo };
+    dsc->bg_color = lv_color_hex(color);
+    lv_draw_rect(drawCtx, dsc, &area);
+}
+
+// 把一根条离底边[lo, hi)像素的行标记为无效
+static void invalidate_rows(LevelMeterUI *ui, lv_obj_t *obj, lv_coord_t x1, lv_coord_t x2, int16_t lo, int16_t hi) {
+    if (hi <= lo) {
+        return;
+    }
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    lv_area_t area = { .x1 = x1, .x2 = x2, .y1 = coords.y2 - hi + 1, .y2 = coords.y2 - lo };
+    lv_obj_invalidate_area(obj, &area);
+    ui->invalidatedPixels += (uint32_t)((x2 - x1 + 1) * (hi - lo));
+}
+
+static void meter_draw_cb(lv_event_t *e) {
+    LevelMeterUI *ui = lv_event_get_user_data(e);
+    lv_obj_t *obj = lv_event_get_target(e);
+    lv_draw_ctx_t *drawCtx = lv_event_get_draw_ctx(e);
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+
+    lv_draw_rect_dsc_t dsc;
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.bg_opa = LV_OPA_COVER;
+    int16_t yellow = db_to_px(ZONE_YELLOW_DB, LEVEL_METER_DB_MIN, METER_H);
+    int16_t red = db_to_px(ZONE_RED_DB, LEVEL_METER_DB_MIN, METER_H);
+
+    for (uint32_t ch = 0; ch < LEVEL_METER_CHANNELS; ch++) {
+        lv_area_t bar = { .x1 = coords.x1 + ch * (BAR_W + BAR_GAP), .y1 = coords.y1, .y2 = coords.y2 };
+        bar.x2 = bar.x1 + BAR_W - 1;
+        lv_area_t visible;
+        if (!_lv_area_intersect(&visible, &bar, drawCtx->clip_area)) {
+            continue;
+        }
+        if (!(ui->activeMask & (1u << ch))) {
+            fill_rows(drawCtx, &dsc, bar.x1, bar.x2, coords.y2, 0, METER_H, COLOR_INACTIVE);
+            continue;
+        }
+        // 条以上是槽，条按高度分三段着色，最后画峰值保持线
+        int16_t rms = ui->rmsPx[ch];
+        fill_rows(drawCtx, &dsc, bar.x1, bar.x2, coords.y2, rms, METER_H, COLOR_TROUGH);
+        fill_rows(drawCtx, &dsc, bar.x1, bar.x2, coords.y2, 0, LV_MIN(rms, yellow), COLOR_GREEN);
+        fill_rows(drawCtx, &dsc, bar.x1, bar.x2, coords.y2, yellow, LV_MIN(rms, red), COLOR_YELLOW);
+        fill_rows(drawCtx, &dsc, bar.x1, bar.x2, coords.y2, red, rms, COLOR_RED);
+        int16_t hold = ui->holdPx[ch];
+        fill_rows(drawCtx, &dsc, bar.x1, bar.x2, coords.y2, LV_MAX(hold - HOLD_PX, 0), hold, COLOR_HOLD);
+    }
+}
+
+static void spectrum_draw_cb(lv_event_t *e) {
+    LevelMeterUI *ui = lv_event_get_user_data(e);
+    lv_obj_t *obj = lv_event_get_target(e);
+    lv_draw_ctx_t *drawCtx = lv_event_get_draw_ctx(e);
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+
+    lv_draw_rect_dsc_t dsc;
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.bg_opa = LV_OPA_COVER;
+    // 列以外是屏幕背景，由LVGL在对象下面先画好
+    for (uint32_t col = 0; col < LEVEL_METER_SPECTRUM_COLS; col++) {
+        lv_coord_t x1 = coords.x1 + col * COL_W;
+        if (x1 + COL_W - 2 < drawCtx->clip_area->x1 || x1 > drawCtx->clip_area->x2) {
+            continue;
+        }
+        fill_rows(drawCtx, &dsc, x1, x1 + COL_W - 2, coords.y2, 0, ui->colPx[col], COLOR_SPECTRUM);
+    }
+}
+
+// 不带主题样式、不可滚动的自绘对象
+static lv_obj_t *create_plain(lv_obj_t *parent, lv_coord_t x, lv_coord_t y, lv_coord_t w, lv_coord_t h) {
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_set_pos(obj, x, y);
+    lv_obj_set_size(obj, w, h);
+    return obj;
+}
+
+static lv_obj_t *create_label(lv_obj_t *parent, lv_coord_t x, lv_coord_t y, const char *text) {
+    lv_obj_t *label = lv_label_create(parent);
+    lv_obj_set_style_text_color(label, lv_color_hex(0xB0B0B0), 0);
+    lv_obj_set_style_text_font(label, &lv_font_montserrat_12, 0);
+    lv_label_set_text(label, text);
+    lv_obj_set_pos(label, x, y);
+    return label;
+}
+
+bool level_meter_ui_create(LevelMeterUI *ui, lv_obj_t *screen) {
+    memset(ui, 0, sizeof(*ui));
+    if (!dsp_fft_init(&ui->fft, LEVEL_TAP_FFT_SIZE)) {
+        return false;
+    }
+    for (uint32_t ch = 0; ch < LEVEL_METER_CHANNELS; ch++) {
+        ui->rmsDb[ch] = LEVEL_METER_DB_MIN;
+        ui->holdDb[ch] = LEVEL_METER_DB_MIN;
+    }
+    for (uint32_t col = 0; col < LEVEL_METER_SPECTRUM_COLS; col++) {
+        ui->colDb[col] = LEVEL_METER_SPECTRUM_DB_MIN;
+    }
+
+    // 频谱列按对数频率划分频点1..n/2-1（不显示直流），低频的列至少一个频点
+    const uint32_t bins = LEVEL_TAP_FFT_SIZE / 2;
+    ui->colFirstBin[0] = 1;
+    for (uint32_t col = 1; col <= LEVEL_METER_SPECTRUM_COLS; col++) {
+        uint32_t edge = (uint32_t)lroundf(powf((float)bins, (float)col / LEVEL_METER_SPECTRUM_COLS));
+        uint32_t minEdge = ui->colFirstBin[col - 1] + 1;
+        ui->colFirstBin[col] = (uint16_t)((edge < minEdge) ? minEdge : (edge > bins) ? bins : edge);
+    }
+
+    lv_obj_set_style_bg_color(screen, lv_color_black(), 0);
+    lv_obj_set_style_bg_opa(screen, LV_OPA_COVER, 0);
+    lv_obj_clear_flag(screen, LV_OBJ_FLAG_SCROLLABLE);
+
+    ui->title = create_label(screen, METER_X, TITLE_Y, "Waiting for audio");
+    ui->meter = create_plain(screen, METER_X, METER_Y,
+                             LEVEL_METER_CHANNELS * (BAR_W + BAR_GAP) - BAR_GAP, METER_H);
+    lv_obj_add_event_cb(ui->meter, meter_draw_cb, LV_EVENT_DRAW_MAIN, ui);
+    for (uint32_t ch = 0; ch < LEVEL_METER_CHANNELS; ch++) {
+        char text[4];
+        lv_snprintf(text, sizeof(text), "%u", (unsigned)ch);
+        create_label(screen, METER_X + ch * (BAR_W + BAR_GAP) + BAR_W / 2 - 3, LABEL_Y, text);
+    }
+    ui->spectrum = create_plain(screen, SPEC_X, SPEC_Y, LEVEL_METER_SPECTRUM_COLS * COL_W, SPEC_H);
+    lv_obj_add_event_cb(ui->spectrum, spectrum_draw_cb, LV_EVENT_DRAW_MAIN, ui);
+    return ui->meter != NULL && ui->spectrum != NULL;
+}
+
+// 新快照：计算选中通道的频谱，各列取所含频点中的最大值
+static void update_spectrum(LevelMeterUI *ui, const LevelSnapshot *snap, float dt) {
+    dsp_fft_power_db(&ui->fft, snap->spectrum, ui->powerDb);
+    for (uint32_t col = 0; col < LEVEL_METER_SPECTRUM_COLS; col++) {
+        float db = DSP_FFT_FLOOR_DB;
+        for (uint32_t bin = ui->colFirstBin[col]; bin < ui->colFirstBin[col + 1]; bin++) {
+            db = (ui->powerDb[bin] > db) ? ui->powerDb[bin] : db;
+        }
+        float decayed = ui->colDb[col] - SPEC_DECAY_DB_PER_S * dt;
+        ui->colDb[col] = (db > decayed) ? db : decayed;
+    }
+
+    // 只标记高度变化的列。每SPEC_GROUP_COLS列把变化的部分合并为一个区域：
+    // 区域数不会超过LVGL的无效区域表（溢出时整屏重绘），又不至于把整个频谱框进一个大矩形
+    lv_area_t coords;
+    lv_obj_get_coords(ui->spectrum, &coords);
+    for (uint32_t group = 0; group < LEVEL_METER_SPECTRUM_COLS; group += SPEC_GROUP_COLS) {
+        int32_t first = -1, last = -1;
+        int16_t lo = SPEC_H, hi = 0;
+        for (uint32_t col = group; col < group + SPEC_GROUP_COLS && col < LEVEL_METER_SPECTRUM_COLS; col++) {
+            int16_t px = db_to_px(ui->colDb[col], LEVEL_METER_SPECTRUM_DB_MIN, SPEC_H);
+            int16_t old = ui->colPx[col];
+            if (px == old) {
+                continue;
+            }
+            first = (first < 0) ? (int32_t)col : first;
+            last = (int32_t)col;
+            lo = LV_MIN(lo, LV_MIN(px, old));
+            hi = LV_MAX(hi, LV_MAX(px, old));
+            ui->colPx[col] = px;
+        }
+        if (first >= 0) {
+            invalidate_rows(ui, ui->spectrum, coords.x1 + first * COL_W, coords.x1 + last * COL_W + COL_W - 2,
+                            lo, hi);
+        }
+    }
+}
+
+void level_meter_ui_update(LevelMeterUI *ui, const LevelSnapshot *snap, int64_t nowUs) {
+    float dt = (ui->lastUpdateUs != 0 && nowUs > ui->lastUpdateUs) ? (float)(nowUs - ui->lastUpdateUs) / 1e6f : 0.0f;
+    ui->lastUpdateUs = nowUs;
+    bool fresh = snap->seq != 0 && snap->seq != ui->lastSeq;
+
+    if (fresh) {
+        uint32_t mask = snap->channelMask & ((snap->channels >= 32) ? UINT32_MAX : ((1u << snap->channels) - 1));
+        if (mask != ui->activeMask) {
+            ui->activeMask = mask;
+            lv_obj_invalidate(ui->meter);
+            ui->invalidatedPixels += (uint32_t)(lv_obj_get_width(ui->meter) * lv_obj_get_height(ui->meter));
+        }
+        if (snap->spectrumChannel != ui->titleChannel || snap->sampleRate != ui->titleRate || ui->lastSeq == 0) {
+            ui->titleChannel = snap->spectrumChannel;
+            ui->titleRate = snap->sampleRate;
+            lv_label_set_text_fmt(ui->title, "Slot %u spectrum, 0-%u kHz", (unsigned)snap->spectrumChannel,
+                                  (unsigned)(snap->sampleRate / 2000));
+        }
+        // 频谱的衰减按两次快照之间的时间计算
+        float specDt = (ui->lastSeq != 0) ? (float)(snap->timeUs - ui->lastSnapshotUs) / 1e6f : 0.0f;
+        ui->lastSnapshotUs = snap->timeUs;
+        ui->lastSeq = snap->seq;
+        update_spectrum(ui, snap, (specDt > 0.0f) ? specDt : 0.0f);
+    }
+
+    lv_area_t coords;
+    lv_obj_get_coords(ui->meter, &coords);
+    for (uint32_t ch = 0; ch < LEVEL_METER_CHANNELS; ch++) {
+        bool active = (ui->activeMask & (1u << ch)) != 0;
+        float rms = active ? amp_to_db(snap->rms[ch]) : -120.0f;
+        float decayed = ui->rmsDb[ch] - RMS_DECAY_DB_PER_S * dt;
+        ui->rmsDb[ch] = (rms > decayed) ? rms : decayed;
+
+        float peak = active ? amp_to_db(snap->peak[ch]) : -120.0f;
+        if (fresh && peak >= ui->holdDb[ch]) {
+            ui->holdDb[ch] = peak;
+            ui->holdUntilUs[ch] = nowUs + HOLD_US;
+        } else if (nowUs > ui->holdUntilUs[ch]) {
+            ui->holdDb[ch] -= HOLD_DECAY_DB_PER_S * dt;
+        }
+        ui->rmsDb[ch] = LV_MAX(ui->rmsDb[ch], LEVEL_METER_DB_MIN);
+        ui->holdDb[ch] = LV_MAX(ui->holdDb[ch], LEVEL_METER_DB_MIN);
+
+        // 只重绘条和保持线移动经过的行
+        int16_t rmsPx = db_to_px(ui->rmsDb[ch], LEVEL_METER_DB_MIN, METER_H);
+        int16_t holdPx = db_to_px(ui->holdDb[ch], LEVEL_METER_DB_MIN, METER_H);
+        int16_t oldRms = ui->rmsPx[ch];
+        int16_t oldHold = ui->holdPx[ch];
+        if (rmsPx == oldRms && holdPx == oldHold) {
+            continue;
+        }
+        int16_t lo = METER_H, hi = 0;
+        if (rmsPx != oldRms) {
+            lo = LV_MIN(rmsPx, oldRms);
+            hi = LV_MAX(rmsPx, oldRms);
+        }
+        if (holdPx != oldHold) {
+            lo = LV_MIN(lo, LV_MAX(LV_MIN(holdPx, oldHold) - HOLD_PX, 0));
+            hi = LV_MAX(hi, LV_MAX(holdPx, oldHold));
+        }
+        ui->rmsPx[ch] = rmsPx;
+        ui->holdPx[ch] = holdPx;
+        lv_coord_t x1 = coords.x1 + ch * (BAR_W + BAR_GAP);
+        invalidate_rows(ui, ui->meter, x1, x1 + BAR_W - 1, lo, hi);
+    }
+}
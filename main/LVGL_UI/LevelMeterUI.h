@@ -0,0 +1,52 @@
+#pragma once
+
+#include "lvgl.h"
+#include "LevelTap.h"
+#include "DspFft.h"
+
+// 录音时的电平表和频谱界面（172x320竖屏）
+//
+// 上半部分是8个通道的VU表（RMS条，按-18/-6dBFS分绿/黄/红三段）和峰值保持线，
+// 下半部分是选中通道的频谱（对数频率分列）。两者都是自绘对象：更新时只比较每根条的像素高度，
+// 只把高度变化的那一段（旧高度到新高度之间）标记为无效，LVGL只重绘并刷新这些小区域，
+// 电平不变的通道和频谱列不产生任何绘制和SPI传输。
+//
+// 只调用LVGL，不依赖ESP-IDF：设备上由LevelMeter任务驱动，主机上由tools/meter_bench驱动。
+
+#define LEVEL_METER_CHANNELS        8
+#define LEVEL_METER_SPECTRUM_COLS   56
+#define LEVEL_METER_DB_MIN          (-60.0f)    // 电平表的下限
+#define LEVEL_METER_SPECTRUM_DB_MIN (-100.0f)   // 频谱的下限（单个频点的能量远低于通道RMS）
+
+typedef struct {
+    lv_obj_t *title;
+    lv_obj_t *meter;
+    lv_obj_t *spectrum;
+    DspFft fft;
+    float powerDb[LEVEL_TAP_FFT_SIZE / 2];
+    uint16_t colFirstBin[LEVEL_METER_SPECTRUM_COLS + 1];  // 每列覆盖的频点 [first[i], first[i+1])
+
+    // 显示状态（显示的电平已经过衰减处理）
+    uint32_t lastSeq;
+    int64_t lastUpdateUs;
+    int64_t lastSnapshotUs;
+    uint32_t titleChannel;
+    uint32_t titleRate;
+    uint32_t activeMask;
+    float rmsDb[LEVEL_METER_CHANNELS];
+    float holdDb[LEVEL_METER_CHANNELS];
+    int64_t holdUntilUs[LEVEL_METER_CHANNELS];
+    float colDb[LEVEL_METER_SPECTRUM_COLS];
+
+    // 当前已绘制的像素高度，用于计算需要重绘的区域
+    int16_t rmsPx[LEVEL_METER_CHANNELS];
+    int16_t holdPx[LEVEL_METER_CHANNELS];
+    int16_t colPx[LEVEL_METER_SPECTRUM_COLS];
+
+    uint32_t invalidatedPixels;     // 累计标记为无效的像素数（统计用）
+} LevelMeterUI;
+
+// 在screen上创建界面（在LVGL所在的任务中调用）
+bool level_meter_ui_create(LevelMeterUI *ui, lv_obj_t *screen);
+// 用快照更新显示：新快照时更新电平和频谱，否则只推进峰值保持和衰减。每个显示帧调用一次
+void level_meter_ui_update(LevelMeterUI *ui, const LevelSnapshot *snap, int64_t nowUs);
@@ -0,0 +1,192 @@
+#include "FileSequence.h"
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define SEQUENCE_MAGIC      0x51455352u     // "RSEQ"
+#define SEQUENCE_VERSION    1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t next;
+    uint32_t crc;               // 以上字段的CRC32
+} SequenceRecord;
+
+// CRC32 (IEEE 802.3)，记录只有十几个字节，逐位计算即可
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t record_crc(const SequenceRecord *record) {
+    return crc32_update(0, (const uint8_t *)record, offsetof(SequenceRecord, crc));
+}
+
+static bool read_state(FILE *f, uint32_t *next) {
+    SequenceRecord record;
+    if (fseek(f, 0, SEEK_SET) != 0 || fread(&record, sizeof(record), 1, f) != 1) {
+        return false;
+    }
+    if (record.magic != SEQUENCE_MAGIC || record.version != SEQUENCE_VERSION || record.crc != record_crc(&record) ||
+        record.next == 0 || record.next > FILE_SEQUENCE_MAX_INDEX) {
+        return false;
+    }
+    *next = record.next;
+    return true;
+}
+
+// 写入并落盘：断电后状态不会落后于卡上已创建的文件
+static bool write_state(FileSequence *seq) {
+    if (seq->file == NULL) {
+        return false;
+    }
+    SequenceRecord record = {
+        .magic = SEQUENCE_MAGIC,
+        .version = SEQUENCE_VERSION,
+        .next = seq->next,
+    };
+    record.crc = record_crc(&record);
+    if (fseek(seq->file, 0, SEEK_SET) != 0 ||
+        fwrite(&record, sizeof(record), 1, seq->file) != 1 ||
+        fflush(seq->file) != 0) {
+        return false;
+    }
+    return fsync(fileno(seq->file)) == 0;
+}
+
+// 目录中名字为 prefix+十进制数字（后面只能是扩展名）的最大数字；没有匹配项时返回false
+static bool max_numbered_entry(FileSequence *seq, const char *dirPath, const char *prefix, uint32_t *maxNumber) {
+    DIR *dir = opendir(dirPath);
+    if (dir == NULL) {
+        return false;
+    }
+    size_t prefixLen = strlen(prefix);
+    bool found = false;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        seq->scannedEntries++;
+        const char *digits = entry->d_name + prefixLen;
+        if (strncmp(entry->d_name, prefix, prefixLen) != 0 || *digits < '0' || *digits > '9') {
+            continue;
+        }
+        char *end;
+        unsigned long number = strtoul(digits, &end, 10);
+        if ((*end == '\0' || *end == '.') && number <= FILE_SEQUENCE_MAX_INDEX &&
+            (!found || number > *maxNumber)) {
+            *maxNumber = (uint32_t)number;
+            found = true;
+        }
+    }
+    closedir(dir);
+    return found;
+}
+
+// 回退扫描：序号最大的子目录中序号最大的文件之后
+static void scan(FileSequence *seq) {
+    char dirPath[128];
+    uint32_t maxDir = 0, maxFile = 0;
+
+    seq->scans++;
+    seq->next = 1;
+    seq->readyDir = UINT32_MAX;
+    if (!max_numbered_entry(seq, seq->rootDir, FILE_SEQUENCE_DIR_PREFIX, &maxDir) ||
+        maxDir >= FILE_SEQUENCE_MAX_INDEX / FILE_SEQUENCE_PER_DIR + 1 ||
+        !file_sequence_path(seq->rootDir, seq->prefix, maxDir * FILE_SEQUENCE_PER_DIR, NULL,
+                            dirPath, sizeof(dirPath))) {
+        return;
+    }
+    if (max_numbered_entry(seq, dirPath, seq->prefix, &maxFile) && maxFile < FILE_SEQUENCE_PER_DIR) {
+        seq->next = maxDir * FILE_SEQUENCE_PER_DIR + maxFile + 1;
+    } else if (maxDir > 0) {
+        seq->next = maxDir * FILE_SEQUENCE_PER_DIR;     // 空的子目录
+    }
+}
+
+bool file_sequence_path(const char *rootDir, const char *prefix, uint32_t index, const char *ext,
+                        char *path, size_t maxLen) {
+    if (index > FILE_SEQUENCE_MAX_INDEX || strlen(prefix) > FILE_SEQUENCE_PREFIX_MAX) {
+        return false;
+    }
+    int n;
+    if (ext == NULL) {
+        n = snprintf(path, maxLen, "%s/" FILE_SEQUENCE_DIR_PREFIX "%05u", rootDir,
+                     (unsigned)(index / FILE_SEQUENCE_PER_DIR));
+    } else {
+        n = snprintf(path, maxLen, "%s/" FILE_SEQUENCE_DIR_PREFIX "%05u/%s%03u%s", rootDir,
+                     (unsigned)(index / FILE_SEQUENCE_PER_DIR), prefix, (unsigned)(index % FILE_SEQUENCE_PER_DIR),
+                     ext);
+    }
+    return n > 0 && (size_t)n < maxLen;
+}
+
+bool file_sequence_open(FileSequence *seq, const char *rootDir, const char *prefix, const char *statePath) {
+    memset(seq, 0, sizeof(*seq));
+    seq->rootDir = rootDir;
+    seq->prefix = prefix;
+    seq->readyDir = UINT32_MAX;
+
+    if (statePath != NULL) {
+        seq->file = fopen(statePath, "r+b");
+        if (seq->file == NULL) {
+            seq->file = fopen(statePath, "w+b");
+        }
+    }
+    if (seq->file == NULL || !read_state(seq->file, &seq->next)) {
+        scan(seq);
+    }
+    return statePath == NULL || seq->file != NULL;
+}
+
+bool file_sequence_next(FileSequence *seq, const char *ext, char *path, size_t maxLen, uint32_t *index) {
+    // 第二次是扫描之后的结果，扫描得到的序号在卡上不会已经存在（除非目录无法读取）
+    for (int attempt = 0; attempt < 2; attempt++) {
+        uint32_t dirIndex = seq->next / FILE_SEQUENCE_PER_DIR;
+        if (seq->next > FILE_SEQUENCE_MAX_INDEX || !file_sequence_path(seq->rootDir, seq->prefix, seq->next, NULL,
+                                                                        path, maxLen)) {
+            return false;
+        }
+        if (dirIndex != seq->readyDir) {
+            if (mkdir(path, 0777) != 0 && errno != EEXIST) {
+                return false;
+            }
+            seq->readyDir = dirIndex;
+        }
+        if (!file_sequence_path(seq->rootDir, seq->prefix, seq->next, ext, path, maxLen)) {
+            return false;
+        }
+        if (access(path, F_OK) != 0) {
+            *index = seq->next++;
+            // 先保存状态再创建文件：状态写入失败时，下次打开由存在性检查或CRC发现不一致
+            write_state(seq);
+            return true;
+        }
+        // 预测的文件已存在：状态与卡上的文件不一致
+        scan(seq);
+    }
+    return false;
+}
+
+void file_sequence_release(FileSequence *seq, uint32_t index) {
+    if (index + 1 == seq->next) {
+        seq->next = index;
+        write_state(seq);
+    }
+}
+
+void file_sequence_close(FileSequence *seq) {
+    if (seq->file != NULL) {
+        fclose(seq->file);
+        seq->file = NULL;
+    }
+}
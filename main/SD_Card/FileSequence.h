@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 录音文件序号分配
+//
+// 录音按序号分子目录存放：序号n的文件为 <根目录>/REC<n/1000>/<前缀><n%1000><扩展名>，
+// 例如序号12345为 /sdcard/REC00012/AUDIO345.WAV（8.3文件名，不需要长文件名支持）。
+// 每个子目录最多1000个序号，FAT目录的大小和在目录中查找文件的时间不随卡上录音总数增长
+// （FAT单个目录最多65536个目录项，平铺在根目录时几万个录音就会写满）。
+//
+// 下一个序号保存在一个小状态文件中（带CRC），分配时只检查预测的文件是否已存在，不扫描目录。
+// 状态文件缺失、损坏或与卡上的文件不一致（预测的文件已存在，例如卡在别处被写过）时才回退为扫描：
+// 先在根目录中找序号最大的子目录，再在这个子目录中找最大的序号，读取的目录项数有上限。
+// 设备没有实时时钟，所以只按序号分目录，不按日期。
+// 仅使用标准C文件和目录接口，可在主机上编译。同一时刻只能由一个任务调用。
+
+#define FILE_SEQUENCE_PATH          "/sdcard/RECORD.SEQ"
+#define FILE_SEQUENCE_PER_DIR       1000
+#define FILE_SEQUENCE_DIR_PREFIX    "REC"       // 子目录名：REC加5位序号
+#define FILE_SEQUENCE_PREFIX_MAX    5           // 文件名前缀加3位序号不超过8个字符
+#define FILE_SEQUENCE_MAX_INDEX     (100000u * FILE_SEQUENCE_PER_DIR - 1)
+
+typedef struct {
+    FILE *file;                 // 状态文件，NULL: 不保存（每次打开时扫描）
+    const char *rootDir;
+    const char *prefix;
+    uint32_t next;              // 下一个要分配的序号（从1开始）
+    uint32_t readyDir;          // 已确认存在的子目录序号，UINT32_MAX: 无
+    uint32_t scans;             // 回退扫描的次数
+    uint32_t scannedEntries;    // 扫描时读过的目录项总数
+} FileSequence;
+
+// 读取状态文件（不存在则创建），无效时扫描目录。
+// 状态文件无法打开时返回false，但seq仍可使用（序号只保存在内存中）
+bool file_sequence_open(FileSequence *seq, const char *rootDir, const char *prefix, const char *statePath);
+// 分配下一个序号：生成文件路径，创建所在的子目录，并把下一个序号写入状态文件
+bool file_sequence_next(FileSequence *seq, const char *ext, char *path, size_t maxLen, uint32_t *index);
+// 归还最近分配、但文件已被删除的序号（例如预先打开后没有用到的文件）
+void file_sequence_release(FileSequence *seq, uint32_t index);
+void file_sequence_close(FileSequence *seq);
+
+// 序号index对应的文件路径（ext为NULL时生成子目录路径）
+bool file_sequence_path(const char *rootDir, const char *prefix, uint32_t index, const char *ext,
+                        char *path, size_t maxLen);
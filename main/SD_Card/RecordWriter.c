@@ -0,0 +1,318 @@
+#include "RecordWriter.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef ESP_PLATFORM
+
+#include "ff.h"
+#include "esp_log.h"
+
+static const char *TAG = "RecordWriter";
+
+// 把VFS路径(/sdcard/xxx)转换为FATFS路径(0:/xxx)
+static bool fatfs_path(const char *path, char *out, size_t len) {
+    size_t mountLen = strlen(RECORD_VFS_MOUNT_POINT);
+    if (strncmp(path, RECORD_VFS_MOUNT_POINT, mountLen) != 0 || path[mountLen] != '/') {
+        return false;
+    }
+    snprintf(out, len, "%s%s", RECORD_FATFS_DRIVE, path + mountLen);
+    return true;
+}
+
+static void *fatfs_open(const char *path, uint64_t preallocBytes) {
+    char ffPath[128];
+    if (!fatfs_path(path, ffPath, sizeof(ffPath))) {
+        ESP_LOGE(TAG, "Path is not on %s: %s", RECORD_VFS_MOUNT_POINT, path);
+        return NULL;
+    }
+
+    FIL *fil = calloc(1, sizeof(FIL));
+    if (fil == NULL) {
+        return NULL;
+    }
+
+    FRESULT res = f_open(fil, ffPath, FA_WRITE | FA_CREATE_ALWAYS);
+    if (res != FR_OK) {
+        ESP_LOGE(TAG, "f_open(%s) failed: %d", ffPath, res);
+        free(fil);
+        return NULL;
+    }
+
+    // FAT32单个文件不超过4GB
+    if (preallocBytes > 0xFFFFFFFFull) {
+        preallocBytes = 0xFFFFFFFFull;
+    }
+    if (preallocBytes > 0) {
+        // 分配连续簇；失败时（卡上没有足够大的连续空间）退回到按需分配
+        res = f_expand(fil, (FSIZE_t)preallocBytes, 1);
+        if (res != FR_OK) {
+            ESP_LOGW(TAG, "Contiguous pre-allocation of %llu bytes failed (%d), allocating on demand",
+                     (unsigned long long)preallocBytes, res);
+        }
+    }
+    return fil;
+}
+
+static bool fatfs_write(void *handle, const void *data, size_t len) {
+    UINT bw = 0;
+    FRESULT res = f_write((FIL *)handle, data, len, &bw);
+    if (res != FR_OK || bw != len) {
+        ESP_LOGW(TAG, "f_write failed: %d (%u/%u)", res, (unsigned)bw, (unsigned)len);
+        return false;
+    }
+    return true;
+}
+
+static bool fatfs_write_at(void *handle, uint64_t offset, const void *data, size_t len) {
+    FIL *fil = (FIL *)handle;
+    FSIZE_t pos = f_tell(fil);
+    UINT bw = 0;
+
+    if (f_lseek(fil, (FSIZE_t)offset) != FR_OK) {
+        return false;
+    }
+    FRESULT res = f_write(fil, data, len, &bw);
+    if (f_lseek(fil, pos) != FR_OK) {
+        return false;
+    }
+    return res == FR_OK && bw == len;
+}
+
+static bool fatfs_sync(void *handle) {
+    return f_sync((FIL *)handle) == FR_OK;
+}
+
+static bool fatfs_close(void *handle, uint64_t finalSize) {
+    FIL *fil = (FIL *)handle;
+    bool ok = true;
+
+    // 释放预分配但未使用的簇
+    if (f_lseek(fil, (FSIZE_t)finalSize) != FR_OK || f_truncate(fil) != FR_OK) {
+        ESP_LOGW(TAG, "Failed to truncate file to %llu bytes", (unsigned long long)finalSize);
+        ok = false;
+    }
+    if (f_close(fil) != FR_OK) {
+        ok = false;
+    }
+    free(fil);
+    return ok;
+}
+
+static bool fatfs_remove(const char *path) {
+    char ffPath[128];
+    if (!fatfs_path(path, ffPath, sizeof(ffPath))) {
+        ESP_LOGE(TAG, "Path is not on %s: %s", RECORD_VFS_MOUNT_POINT, path);
+        return false;
+    }
+    FRESULT res = f_unlink(ffPath);
+    if (res != FR_OK && res != FR_NO_FILE) {
+        ESP_LOGW(TAG, "f_unlink(%s) failed: %d", ffPath, res);
+        return false;
+    }
+    return true;
+}
+
+static const RecordBackend defaultBackend = {
+    .open = fatfs_open,
+    .write = fatfs_write,
+    .write_at = fatfs_write_at,
+    .sync = fatfs_sync,
+    .close = fatfs_close,
+    .remove = fatfs_remove,
+};
+
+#else  // 主机: POSIX文件或块设备镜像
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static void *posix_open(const char *path, uint64_t preallocBytes) {
+    int *fd = malloc(sizeof(int));
+    if (fd == NULL) {
+        return NULL;
+    }
+    *fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (*fd < 0) {
+        free(fd);
+        return NULL;
+    }
+    if (preallocBytes > 0) {
+        posix_fallocate(*fd, 0, (off_t)preallocBytes);
+    }
+    return fd;
+}
+
+static bool posix_write(void *handle, const void *data, size_t len) {
+    int fd = *(int *)handle;
+    const uint8_t *p = data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool posix_write_at(void *handle, uint64_t offset, const void *data, size_t len) {
+    return pwrite(*(int *)handle, data, len, (off_t)offset) == (ssize_t)len;
+}
+
+static bool posix_sync(void *handle) {
+    return fdatasync(*(int *)handle) == 0;
+}
+
+static bool posix_close(void *handle, uint64_t finalSize) {
+    int fd = *(int *)handle;
+    struct stat st;
+    bool ok = true;
+
+    // 块设备镜像无法截断，只截断普通文件
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && ftruncate(fd, (off_t)finalSize) != 0) {
+        ok = false;
+    }
+    if (close(fd) != 0) {
+        ok = false;
+    }
+    free(handle);
+    return ok;
+}
+
+static bool posix_remove(const char *path) {
+    return unlink(path) == 0 || errno == ENOENT;
+}
+
+static const RecordBackend defaultBackend = {
+    .open = posix_open,
+    .write = posix_write,
+    .write_at = posix_write_at,
+    .sync = posix_sync,
+    .close = posix_close,
+    .remove = posix_remove,
+};
+
+#endif
+
+const RecordBackend *record_backend_default(void) {
+    return &defaultBackend;
+}
+
+bool record_writer_open(RecordWriter *writer, const RecordBackend *backend, const char *path,
+                        uint64_t preallocBytes, uint64_t checkpointInterval) {
+    memset(writer, 0, sizeof(*writer));
+    writer->backend = (backend != NULL) ? backend : record_backend_default();
+    writer->handle = writer->backend->open(path, preallocBytes);
+    if (writer->handle == NULL) {
+        return false;
+    }
+    writer->preallocBytes = preallocBytes;
+    writer->checkpointInterval = checkpointInterval;
+    writer->nextCheckpoint = checkpointInterval;
+    return true;
+}
+
+bool record_writer_write(RecordWriter *writer, const void *data, size_t len) {
+    const uint8_t *p = data;
+    size_t remaining = len;
+
+    if (writer->handle == NULL) {
+        return false;
+    }
+
+    // 先补齐上次剩下的不完整扇区
+    if (writer->stageLen > 0) {
+        size_t n = RECORD_SECTOR_SIZE - writer->stageLen;
+        if (n > remaining) {
+            n = remaining;
+        }
+        memcpy(writer->stage + writer->stageLen, p, n);
+        writer->stageLen += n;
+        p += n;
+        remaining -= n;
+        if (writer->stageLen == RECORD_SECTOR_SIZE) {
+            if (!writer->backend->write(writer->handle, writer->stage, RECORD_SECTOR_SIZE)) {
+                return false;
+            }
+            writer->stageLen = 0;
+        }
+    }
+
+    // 扇区整数倍的部分直接从调用者内存下发；失败时补齐暂存区的部分已经写出，
+    // 仍要计入长度，使bytesWritten与文件中的位置一致
+    size_t direct = remaining - remaining % RECORD_SECTOR_SIZE;
+    if (direct > 0) {
+        if (!writer->backend->write(writer->handle, p, direct)) {
+            writer->bytesWritten += len - remaining;
+            return false;
+        }
+        p += direct;
+        remaining -= direct;
+    }
+
+    // 剩余不足一个扇区的部分暂存
+    if (remaining > 0) {
+        memcpy(writer->stage + writer->stageLen, p, remaining);
+        writer->stageLen += remaining;
+    }
+
+    writer->bytesWritten += len;
+
+    if (writer->checkpointInterval > 0 && record_writer_flushed_bytes(writer) >= writer->nextCheckpoint) {
+        return record_writer_checkpoint(writer);
+    }
+    return true;
+}
+
+bool record_writer_write_at(RecordWriter *writer, uint64_t offset, const void *data, size_t len) {
+    if (writer->handle == NULL || offset + len > record_writer_flushed_bytes(writer)) {
+        return false;
+    }
+    return writer->backend->write_at(writer->handle, offset, data, len);
+}
+
+void record_writer_set_checkpoint_hook(RecordWriter *writer, record_checkpoint_hook_t hook, void *ctx) {
+    writer->checkpointHook = hook;
+    writer->checkpointCtx = ctx;
+}
+
+bool record_writer_checkpoint(RecordWriter *writer) {
+    bool ok = true;
+
+    if (writer->handle == NULL) {
+        return false;
+    }
+    writer->nextCheckpoint = record_writer_flushed_bytes(writer) + writer->checkpointInterval;
+    writer->checkpoints++;
+    if (writer->checkpointHook != NULL && !writer->checkpointHook(writer, writer->checkpointCtx)) {
+        ok = false;
+    }
+    if (!writer->backend->sync(writer->handle)) {
+        ok = false;
+    }
+    return ok;
+}
+
+bool record_writer_close(RecordWriter *writer) {
+    bool ok = true;
+
+    if (writer->handle == NULL) {
+        return false;
+    }
+    if (writer->stageLen > 0) {
+        ok = writer->backend->write(writer->handle, writer->stage, writer->stageLen);
+        writer->stageLen = 0;
+    }
+    if (writer->checkpointHook != NULL && !writer->checkpointHook(writer, writer->checkpointCtx)) {
+        ok = false;
+    }
+    if (!writer->backend->close(writer->handle, writer->bytesWritten)) {
+        ok = false;
+    }
+    writer->handle = NULL;
+    return ok;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 录音文件直写器
+//
+// 绕过stdio和VFS，按扇区对齐的整段数据直接写入FATFS：
+//  - 打开时用f_expand预分配一段连续空间，录音过程中不再分配簇
+//  - 调用者的数据中扇区整数倍的部分直接下发（FATFS据此走多扇区直写路径），
+//    只有不足一个扇区的尾部才拷贝到暂存区
+//  - 仅在检查点(record_writer_checkpoint)更新FAT和目录项，关闭时截断到实际长度
+//
+// 存储操作通过RecordBackend抽象：ESP32上是FATFS后端，主机上是POSIX文件后端
+// （可指向一个文件形式的块设备镜像），因此写入逻辑可以在Linux上运行。
+
+#define RECORD_SECTOR_SIZE        512
+#define RECORD_VFS_MOUNT_POINT    "/sdcard"     // VFS挂载点
+#define RECORD_FATFS_DRIVE        "0:"          // 对应的FATFS逻辑驱动器
+
+// 存储后端
+typedef struct {
+    // 创建文件并预分配preallocBytes字节连续空间（0表示不预分配），失败返回NULL
+    void *(*open)(const char *path, uint64_t preallocBytes);
+    // 在当前位置顺序写入
+    bool (*write)(void *handle, const void *data, size_t len);
+    // 覆盖写入已写过的区域（如文件头），不改变顺序写入位置
+    bool (*write_at)(void *handle, uint64_t offset, const void *data, size_t len);
+    // 把已写入的数据和文件元数据（FAT/目录项）落盘
+    bool (*sync)(void *handle);
+    // 截断到finalSize并关闭，释放句柄
+    bool (*close)(void *handle, uint64_t finalSize);
+    // 删除没有打开的文件，文件不存在也返回true
+    bool (*remove)(const char *path);
+} RecordBackend;
+
+typedef struct RecordWriter RecordWriter;
+
+// 检查点回调：在FAT/目录项落盘之前调用，可用于回写文件头等元数据
+typedef bool (*record_checkpoint_hook_t)(RecordWriter *writer, void *ctx);
+
+struct RecordWriter {
+    const RecordBackend *backend;
+    void *handle;
+    uint64_t bytesWritten;          // 写入的总字节数（含暂存区）
+    uint64_t preallocBytes;
+    uint64_t checkpointInterval;    // 自动检查点间隔（字节），0表示只在手动调用时检查点
+    uint64_t nextCheckpoint;
+    uint32_t checkpoints;
+    record_checkpoint_hook_t checkpointHook;
+    void *checkpointCtx;
+    size_t stageLen;
+    _Alignas(4) uint8_t stage[RECORD_SECTOR_SIZE];  // 不足一个扇区的尾部
+};
+
+// 平台默认后端（ESP32: FATFS直写；主机: POSIX文件）
+const RecordBackend *record_backend_default(void);
+
+// 打开录音文件
+bool record_writer_open(RecordWriter *writer, const RecordBackend *backend, const char *path,
+                        uint64_t preallocBytes, uint64_t checkpointInterval);
+// 追加数据
+bool record_writer_write(RecordWriter *writer, const void *data, size_t len);
+// 覆盖已完整写出的区域（offset+len不能超过record_writer_flushed_bytes）
+bool record_writer_write_at(RecordWriter *writer, uint64_t offset, const void *data, size_t len);
+// 设置检查点回调（open之后调用）
+void record_writer_set_checkpoint_hook(RecordWriter *writer, record_checkpoint_hook_t hook, void *ctx);
+// 检查点：把完整扇区的数据和FAT/目录项落盘
+bool record_writer_checkpoint(RecordWriter *writer);
+// 写出暂存区、执行最后一次检查点回调、截断到实际长度并关闭
+bool record_writer_close(RecordWriter *writer);
+// 是否已打开
+static inline bool record_writer_is_open(const RecordWriter *writer) {
+    return writer->handle != NULL;
+}
+// 已完整写到后端的字节数（不含暂存区）
+static inline uint64_t record_writer_flushed_bytes(const RecordWriter *writer) {
+    return writer->bytesWritten - writer->stageLen;
+}
@@ -0,0 +1,248 @@
+#include "RecoveryJournal.h"
+#include "WavFormat.h"
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+
+#define RECOVERY_MAGIC      0x4C4E4A52u     // "RJNL"
+#define RECOVERY_VERSION    1
+#define RECOVERY_SLOT_SIZE  512             // 每个记录槽独占一个扇区
+
+_Static_assert(sizeof(RecoveryRecord) <= RECOVERY_SLOT_SIZE, "recovery record must fit in one sector");
+
+// CRC32 (IEEE 802.3)，记录很小且写入频率很低，逐位计算即可
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t record_crc(const RecoveryRecord *record) {
+    return crc32_update(0, (const uint8_t *)record, offsetof(RecoveryRecord, crc));
+}
+
+// 读取一个槽，校验失败返回false
+static bool read_slot(FILE *f, int slot, RecoveryRecord *record) {
+    if (fseek(f, (long)slot * RECOVERY_SLOT_SIZE, SEEK_SET) != 0 ||
+        fread(record, sizeof(*record), 1, f) != 1) {
+        return false;
+    }
+    return record->magic == RECOVERY_MAGIC &&
+           record->version == RECOVERY_VERSION &&
+           record->crc == record_crc(record);
+}
+
+// 读取两个槽中较新的有效记录
+static bool read_latest(FILE *f, RecoveryRecord *record) {
+    RecoveryRecord a, b;
+    bool okA = read_slot(f, 0, &a);
+    bool okB = read_slot(f, 1, &b);
+
+    if (okA && okB) {
+        // generation回绕时用有符号差比较
+        *record = ((int32_t)(b.generation - a.generation) > 0) ? b : a;
+    } else if (okA) {
+        *record = a;
+    } else if (okB) {
+        *record = b;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// 写入下一条记录到另一个槽并落盘
+static bool write_record(RecoveryJournal *journal) {
+    RecoveryRecord *record = &journal->record;
+
+    record->magic = RECOVERY_MAGIC;
+    record->version = RECOVERY_VERSION;
+    record->generation++;
+    record->crc = record_crc(record);
+
+    int slot = record->generation & 1;
+    if (fseek(journal->file, (long)slot * RECOVERY_SLOT_SIZE, SEEK_SET) != 0 ||
+        fwrite(record, sizeof(*record), 1, journal->file) != 1 ||
+        fflush(journal->file) != 0) {
+        return false;
+    }
+    return fsync(fileno(journal->file)) == 0;
+}
+
+bool recovery_journal_open(RecoveryJournal *journal, const char *journalPath) {
+    memset(journal, 0, sizeof(*journal));
+
+    journal->file = fopen(journalPath, "r+b");
+    if (journal->file == NULL) {
+        journal->file = fopen(journalPath, "w+b");
+        if (journal->file == NULL) {
+            return false;
+        }
+    }
+
+    // 从最新记录的generation继续递增
+    RecoveryRecord latest;
+    if (read_latest(journal->file, &latest)) {
+        journal->record.generation = latest.generation;
+    }
+    return true;
+}
+
+bool recovery_journal_begin(RecoveryJournal *journal, const char *recordingPath, const char *const *sidecarExt,
+                            uint32_t sidecars) {
+    if (journal->file == NULL || sidecars > RECOVERY_SIDECARS_MAX) {
+        return false;
+    }
+    journal->record.state = RECOVERY_STATE_ACTIVE;
+    journal->record.blockSeq = 0;
+    journal->record.committedBytes = 0;
+    memset(journal->record.path, 0, sizeof(journal->record.path));
+    strncpy(journal->record.path, recordingPath, sizeof(journal->record.path) - 1);
+    memset(journal->record.sidecar, 0, sizeof(journal->record.sidecar));
+    for (uint32_t i = 0; i < sidecars; i++) {
+        if (sidecarExt[i] != NULL) {
+            if (strlen(sidecarExt[i]) >= RECOVERY_EXT_MAX) {
+                return false;
+            }
+            strcpy(journal->record.sidecar[i].ext, sidecarExt[i]);
+        }
+    }
+    return write_record(journal);
+}
+
+bool recovery_journal_commit(RecoveryJournal *journal, uint32_t blockSeq, uint64_t committedBytes,
+                             const uint64_t *sidecarBytes) {
+    if (journal->file == NULL) {
+        return false;
+    }
+    journal->record.blockSeq = blockSeq;
+    journal->record.committedBytes = committedBytes;
+    for (uint32_t i = 0; sidecarBytes != NULL && i < RECOVERY_SIDECARS_MAX; i++) {
+        RecoverySidecar *sidecar = &journal->record.sidecar[i];
+        if (sidecar->ext[0] == '\0') {
+            continue;
+        }
+        if (sidecarBytes[i] == 0) {
+            memset(sidecar, 0, sizeof(*sidecar));
+        } else {
+            sidecar->committedBytes = sidecarBytes[i];
+        }
+    }
+    return write_record(journal);
+}
+
+bool recovery_journal_end(RecoveryJournal *journal) {
+    if (journal->file == NULL) {
+        return false;
+    }
+    journal->record.state = RECOVERY_STATE_CLOSED;
+    return write_record(journal);
+}
+
+bool recovery_journal_forget(RecoveryJournal *journal, const char *recordingPath) {
+    if (journal->file == NULL) {
+        return false;
+    }
+    if (journal->record.state != RECOVERY_STATE_ACTIVE ||
+        strncmp(journal->record.path, recordingPath, sizeof(journal->record.path)) != 0) {
+        return true;
+    }
+    journal->record.state = RECOVERY_STATE_CLOSED;
+    journal->record.blockSeq = 0;
+    journal->record.committedBytes = 0;
+    memset(journal->record.path, 0, sizeof(journal->record.path));
+    memset(journal->record.sidecar, 0, sizeof(journal->record.sidecar));
+    return write_record(journal);
+}
+
+void recovery_journal_close(RecoveryJournal *journal) {
+    if (journal->file != NULL) {
+        fclose(journal->file);
+        journal->file = NULL;
+    }
+}
+
+// 把WAV头中的数据长度修正为截断后的实际长度
+static bool repair_wav_header(const char *path, uint64_t fileBytes) {
+    uint8_t header[WAV_HEADER_BYTES];
+    WavInfo info;
+    bool ok = true;
+
+    FILE *f = fopen(path, "r+b");
+    if (f == NULL) {
+        return false;
+    }
+    if (fread(header, 1, sizeof(header), f) == sizeof(header) &&
+        wav_parse_header(header, sizeof(header), &info) &&
+        info.dataOffset == WAV_HEADER_BYTES) {
+        uint64_t dataBytes = fileBytes - WAV_HEADER_BYTES;
+        dataBytes -= dataBytes % wav_block_align(&info.format);
+        ok = wav_build_header(header, &info.format, dataBytes) &&
+             fseek(f, 0, SEEK_SET) == 0 &&
+             fwrite(header, 1, sizeof(header), f) == sizeof(header);
+    }
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
+// 截断到提交的长度并修复WAV头；removeFile时删除文件（第一次检查点之前断电，文件中没有可用数据）
+static bool truncate_file(const char *path, uint64_t committedBytes, bool removeFile) {
+    if (removeFile) {
+        return remove(path) == 0 || access(path, F_OK) != 0;
+    }
+    return truncate(path, (off_t)committedBytes) == 0 && repair_wav_header(path, committedBytes);
+}
+
+// 附属文件的路径：把录音文件的扩展名换成ext（同采集管线）
+static bool sidecar_path(char *path, size_t size, const char *recordingPath, const char *ext) {
+    snprintf(path, size, "%s", recordingPath);
+    char *dot = strrchr(path, '.');
+    if (dot == NULL || (size_t)(dot - path) + strlen(ext) >= size) {
+        return false;
+    }
+    strcpy(dot, ext);
+    return true;
+}
+
+recovery_result_t recovery_journal_recover(const char *journalPath) {
+    RecoveryJournal journal;
+    RecoveryRecord latest;
+
+    if (!recovery_journal_open(&journal, journalPath)) {
+        return RECOVERY_RESULT_NONE;
+    }
+    if (!read_latest(journal.file, &latest) || latest.state != RECOVERY_STATE_ACTIVE) {
+        recovery_journal_close(&journal);
+        return RECOVERY_RESULT_NONE;
+    }
+
+    journal.record = latest;
+    bool removed = latest.committedBytes <= WAV_HEADER_BYTES;
+    bool ok = truncate_file(latest.path, latest.committedBytes, removed);
+    // 录音文件被删除时附属文件也删除；否则截断到同一个检查点时的长度（只有文件头的索引保留）
+    for (uint32_t i = 0; i < RECOVERY_SIDECARS_MAX; i++) {
+        const RecoverySidecar *sidecar = &latest.sidecar[i];
+        char path[RECOVERY_PATH_MAX + RECOVERY_EXT_MAX];
+        if (sidecar->ext[0] == '\0' || memchr(sidecar->ext, '\0', RECOVERY_EXT_MAX) == NULL) {
+            continue;
+        }
+        if (!sidecar_path(path, sizeof(path), latest.path, sidecar->ext) ||
+            !truncate_file(path, sidecar->committedBytes, removed || sidecar->committedBytes < WAV_HEADER_BYTES)) {
+            ok = false;
+        }
+    }
+
+    // 标记为已关闭，避免下次上电重复恢复
+    if (ok) {
+        ok = recovery_journal_end(&journal);
+    }
+    recovery_journal_close(&journal);
+    return ok ? RECOVERY_RESULT_REPAIRED : RECOVERY_RESULT_FAILED;
+}
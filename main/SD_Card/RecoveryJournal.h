@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// 录音恢复日志
+//
+// 断电时录音文件不会被关闭，目录项中的长度停留在预分配大小，文件尾部是未写入的垃圾数据。
+// 录音过程中每个检查点之后，把“已落盘的字节数和最后一个块序号”写入一个小日志文件；
+// 上电挂载SD卡后，如果日志显示上次录音没有正常结束，就把文件截断到最后一次提交的长度，
+// 并修复WAV头中的数据长度（FLAC和平面文件只截断：FLAC的STREAMINFO在检查点时已回写，
+// 末尾不完整的帧/块由读取端丢弃）。
+// 与录音文件同名、扩展名不同的附属文件（如索引）在同一个检查点落盘，日志同时记录它们的扩展名和
+// 已落盘的长度，恢复时一并截断（WAV格式的同样修复文件头）。
+//
+// 日志有两个记录槽（分别位于不同扇区），交替写入并带CRC，写入中途断电最多丢失最新的一次提交。
+// 仅使用标准C文件接口，可在主机上编译。
+
+#define RECOVERY_JOURNAL_PATH   "/sdcard/RECORD.JNL"
+#define RECOVERY_PATH_MAX       64
+#define RECOVERY_SIDECARS_MAX   10      // 每个录音文件最多登记的附属文件数
+#define RECOVERY_EXT_MAX        12
+
+typedef enum {
+    RECOVERY_STATE_CLOSED = 0,  // 上次录音已正常关闭
+    RECOVERY_STATE_ACTIVE = 1,  // 录音进行中（上电时看到此状态说明发生了断电）
+} recovery_state_t;
+
+// 附属文件：与录音文件同名、扩展名为ext
+typedef struct {
+    uint64_t committedBytes;    // 已落盘的长度（含文件头）
+    char ext[RECOVERY_EXT_MAX]; // 空串: 未登记或已正常关闭，恢复时不处理
+    uint32_t reserved;
+} RecoverySidecar;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t state;             // recovery_state_t
+    uint32_t generation;        // 每次写入递增，较大者为最新记录
+    uint32_t blockSeq;          // 最后一个已落盘的块序号
+    uint64_t committedBytes;    // 已落盘的文件长度（含文件头）
+    char path[RECOVERY_PATH_MAX];
+    RecoverySidecar sidecar[RECOVERY_SIDECARS_MAX];
+    uint32_t crc;               // 以上字段的CRC32
+} RecoveryRecord;
+
+typedef struct {
+    FILE *file;
+    RecoveryRecord record;      // 最近一次写入的记录
+} RecoveryJournal;
+
+typedef enum {
+    RECOVERY_RESULT_NONE = 0,   // 无需恢复
+    RECOVERY_RESULT_REPAIRED,   // 已修复上次未关闭的文件
+    RECOVERY_RESULT_FAILED,     // 需要恢复但失败
+} recovery_result_t;
+
+// 打开（不存在则创建）日志文件
+bool recovery_journal_open(RecoveryJournal *journal, const char *journalPath);
+// 开始一个新录音文件，同时登记sidecars个附属文件的扩展名（NULL表示这个位置没有打开的附属文件）
+bool recovery_journal_begin(RecoveryJournal *journal, const char *recordingPath, const char *const *sidecarExt,
+                            uint32_t sidecars);
+// 检查点之后提交已落盘的长度和块序号；sidecarBytes按登记的顺序给出附属文件已落盘的长度，
+// 0表示这个附属文件已关闭（关闭时已截断到实际长度），此后恢复时不再处理
+bool recovery_journal_commit(RecoveryJournal *journal, uint32_t blockSeq, uint64_t committedBytes,
+                             const uint64_t *sidecarBytes);
+// 录音文件已正常关闭
+bool recovery_journal_end(RecoveryJournal *journal);
+// 录音文件已被删除：日志中登记的正是这个文件时清空登记，恢复时不再处理；登记的是其他文件时不改变日志
+bool recovery_journal_forget(RecoveryJournal *journal, const char *recordingPath);
+// 关闭日志文件
+void recovery_journal_close(RecoveryJournal *journal);
+
+// 上电恢复：读取日志，必要时截断并修复上次未关闭的录音文件
+recovery_result_t recovery_journal_recover(const char *journalPath);
@@ -54,7 +54,7 @@ void SD_Init(void)
     esp_vfs_fat_sdmmc_mount_config_t mount_config = {
         .format_if_mount_failed = true,           
         .max_files = 5,
-        .allocation_unit_size = 16 * 1024
+        .allocation_unit_size = 64 * 1024       // 大簇: 录音直写时每次f_write可跨越更多连续扇区
     };
     sdmmc_card_t *card;
     const char mount_point[] = MOUNT_POINT;
@@ -106,6 +106,14 @@ void SD_Init(void)
     // Card has been initialized, print its properties
     sdmmc_card_print_info(stdout, card);
     SDCard_Size = ((uint64_t) card->csd.capacity) * card->csd.sector_size / (1024 * 1024);
+
+    // Repair the last recording if power was lost before it was closed
+    recovery_result_t recovery = recovery_journal_recover(RECOVERY_JOURNAL_PATH);
+    if (recovery == RECOVERY_RESULT_REPAIRED) {
+        ESP_LOGW(SD_TAG, "Recovered unfinished recording from journal");
+    } else if (recovery == RECOVERY_RESULT_FAILED) {
+        ESP_LOGE(SD_TAG, "Failed to recover unfinished recording");
+    }
 }
 void Flash_Searching(void)
 {
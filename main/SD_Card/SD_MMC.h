@@ -9,6 +9,7 @@
 #include "driver/sdmmc_host.h"
 
 #include "esp_flash.h"  
+#include "RecoveryJournal.h"
 
 #define CONFIG_EXAMPLE_PIN_CLK  14
 #define CONFIG_EXAMPLE_PIN_CMD  15
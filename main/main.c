@@ -14,6 +14,8 @@
 #include "ADAU7118.h" 
 #include "hardwareInit.h" 
 #include "uart_console.h"
+#include "LVGL_Driver.h"
+#include "LevelMeter.h"
 
 static const char *TAG = "main";
 
@@ -43,6 +45,14 @@ void app_main(void) {
         return;
     }
     
+    // 初始化屏幕，显示各通道电平和频谱（显示任务启动后只由它调用LVGL）
+    LCD_Init();
+    LVGL_Init();
+    ret = level_meter_start(audio_capture_get_level_tap());
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "电平表启动失败: %s", esp_err_to_name(ret));
+    }
+    
     // 延迟一秒，等待系统稳定
     vTaskDelay(pdMS_TO_TICKS(1000));
     // 开启音频采集
@@ -5,6 +5,23 @@
 // // 音频采样命令处理函数声明
 static int start_audio_cmd_handler(int argc, char **argv);
 static int stop_audio_cmd_handler(int argc, char **argv);
+static int capture_mode_cmd_handler(int argc, char **argv);
+static int codec_cmd_handler(int argc, char **argv);
+static int layout_cmd_handler(int argc, char **argv);
+static int channel_mask_cmd_handler(int argc, char **argv);
+static int profile_cmd_handler(int argc, char **argv);
+static int capstats_cmd_handler(int argc, char **argv);
+static int event_cmd_handler(int argc, char **argv);
+static int evtrig_cmd_handler(int argc, char **argv);
+static int meter_cmd_handler(int argc, char **argv);
+static int rotate_cmd_handler(int argc, char **argv);
+static int sync_cmd_handler(int argc, char **argv);
+static int beam_cmd_handler(int argc, char **argv);
+static int beamgeo_cmd_handler(int argc, char **argv);
+static int doa_cmd_handler(int argc, char **argv);
+static int doapairs_cmd_handler(int argc, char **argv);
+static int rates_cmd_handler(int argc, char **argv);
+static int features_cmd_handler(int argc, char **argv);
 
 void start_repl() {
     // REPL配置
@@ -45,6 +62,177 @@ void register_console_commands() {
         .argtable = NULL
     };
     ESP_ERROR_CHECK(esp_console_cmd_register(&stop_audio_cmd));
+
+    // 采集模式命令
+    const esp_console_cmd_t capture_mode_cmd = {
+        .command = "capmode",
+        .help = "Show or set the capture mode before the first start: copy | zerocopy",
+        .hint = "[copy|zerocopy]",
+        .func = &capture_mode_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&capture_mode_cmd));
+
+    // 录音编码命令
+    const esp_console_cmd_t codec_cmd = {
+        .command = "codec",
+        .help = "Show or set the recording codec before the first start: pcm (WAV) | flac (lossless, 16-bit, copy mode "
+                "only) | bfp (block floating point, 24/32-bit, copy mode only)",
+        .hint = "[pcm|flac|bfp]",
+        .func = &codec_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&codec_cmd));
+
+    // 通道布局命令
+    const esp_console_cmd_t layout_cmd = {
+        .command = "layout",
+        .help = "Show or set the channel layout before the first start: interleaved (WAV) | planar (per-channel chunks, .PLN)",
+        .hint = "[interleaved|planar]",
+        .func = &layout_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&layout_cmd));
+
+    // 通道掩码命令
+    const esp_console_cmd_t channel_mask_cmd = {
+        .command = "chmask",
+        .help = "Show or set the recorded microphones before the first start (bit n = mic n, e.g. 0x0F)",
+        .hint = "[mask]",
+        .func = &channel_mask_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&channel_mask_cmd));
+
+    // 采集配置命令
+    const esp_console_cmd_t profile_cmd = {
+        .command = "profile",
+        .help = "Show or set the capture profile before the first start: long (16 kHz/16-bit) | burst (96 kHz/24-bit) | <rate> <bits> [decimation]",
+        .hint = "[long|burst|<rate> <bits> [dec]]",
+        .func = &profile_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&profile_cmd));
+
+    // 采集统计命令
+    const esp_console_cmd_t capstats_cmd = {
+        .command = "capstats",
+        .help = "Show capture telemetry: overruns, ring high-water, commit/SD write latency histograms, bytes/s; 'reset' clears it",
+        .hint = "[reset]",
+        .func = &capstats_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&capstats_cmd));
+
+    // 事件录音命令
+    const esp_console_cmd_t event_cmd = {
+        .command = "event",
+        .help = "Show or set event capture before the first start: only events plus pre/post-roll are written (copy mode)",
+        .hint = "[off|on [pre_ms post_ms]]",
+        .func = &event_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&event_cmd));
+
+    // 事件触发条件命令
+    const esp_console_cmd_t evtrig_cmd = {
+        .command = "evtrig",
+        .help = "Show or set the event triggers before the first start: per-channel RMS and peak (dBFS), VAD margin over the noise floor (dB)",
+        .hint = "[rms_dbfs|off] [peak_dbfs|off] [vad_db|off]",
+        .func = &evtrig_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&evtrig_cmd));
+
+    // 电平表命令
+    const esp_console_cmd_t meter_cmd = {
+        .command = "meter",
+        .help = "Show the level meter display load, or select the slot shown in the spectrum view",
+        .hint = "[slot]",
+        .func = &meter_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&meter_cmd));
+
+    // 文件轮转命令
+    const esp_console_cmd_t rotate_cmd = {
+        .command = "rotate",
+        .help = "Show or set file rotation before the first start: switch to a new file every N minutes and/or after M MB without stopping capture (0 = no limit)",
+        .hint = "[off|minutes [mb]]",
+        .func = &rotate_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&rotate_cmd));
+
+    // 多板同步命令
+    const esp_console_cmd_t sync_cmd = {
+        .command = "sync",
+        .help = "Show the sync status, or enable sync before the first start: record the reference pulse on GPIO5 and the sample clock drift next to each recording (copy mode)",
+        .hint = "[off|on [period_ms]]",
+        .func = &sync_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&sync_cmd));
+
+    // 波束形成命令
+    const esp_console_cmd_t beam_cmd = {
+        .command = "beam",
+        .help = "Show or set beamforming before the first start: record beams steered at the given azimuths (deg) instead of the microphones (only) or next to them in a .BMF file (raw); copy mode, 16-bit",
+        .hint = "[off|only|raw [az_deg ...]]",
+        .func = &beam_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&beam_cmd));
+
+    // 波束几何命令
+    const esp_console_cmd_t beamgeo_cmd = {
+        .command = "beamgeo",
+        .help = "Show or set the microphone positions used for beamforming: slots on a circle of the given radius (slot 0 on +x, counter-clockwise) or on a line along x with the given spacing",
+        .hint = "[circle|line mm]",
+        .func = &beamgeo_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&beamgeo_cmd));
+
+    // 声源方位估计命令
+    const esp_console_cmd_t doa_cmd = {
+        .command = "doa",
+        .help = "Show the latest bearing, or set DOA estimation before the first start: GCC-PHAT over windows of N frames with the given overlap, written R times per second to a .DOA file next to each recording; copy mode, 16-bit",
+        .hint = "[off|on [frames [overlap_pct [rate_hz]]]]",
+        .func = &doa_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&doa_cmd));
+
+    // 方位估计麦克风对命令
+    const esp_console_cmd_t doapairs_cmd = {
+        .command = "doapairs",
+        .help = "Show or set the microphone pairs used for DOA estimation as slot pairs (e.g. 0-4 1-5), or all pairs of recorded microphones",
+        .hint = "[all|a-b ...]",
+        .func = &doapairs_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&doapairs_cmd));
+
+    // 多采样率输出命令
+    const esp_console_cmd_t rates_cmd = {
+        .command = "rates",
+        .help = "Show the rate outputs and their cost, or set them before the first start: up to 3 rates (capture rate / 2^a x 3^b, e.g. 48000 16000) decimated in the same pass and written as 16-bit .Rkk WAV files next to each recording; copy mode",
+        .hint = "[off|Hz ...]",
+        .func = &rates_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&rates_cmd));
+
+    // 声学特征命令
+    const esp_console_cmd_t features_cmd = {
+        .command = "features",
+        .help = "Show or set the acoustic features before the first start: RMS, peak, zero-crossing rate and N mel band energies of each recorded channel every P ms, written to a .FEA file next to each recording; copy mode",
+        .hint = "[off|on [period_ms [bands]]]",
+        .func = &features_cmd_handler,
+        .argtable = NULL
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&features_cmd));
 }
 
 // 开启音频采样命令处理函数
@@ -79,4 +267,737 @@ static int stop_audio_cmd_handler(int argc, char **argv) {
         return 1;
     }
     return 0;
-}
\ No newline at end of file
+}
+
+// 采集模式命令处理函数
+static int capture_mode_cmd_handler(int argc, char **argv) {
+    if (argc < 2) {
+        printf("Capture mode: %s\n",
+               audio_capture_get_mode() == AUDIO_CAPTURE_MODE_ZERO_COPY ? "zerocopy" : "copy");
+        return 0;
+    }
+    
+    audio_capture_mode_t mode;
+    if (strcmp(argv[1], "copy") == 0) {
+        mode = AUDIO_CAPTURE_MODE_COPY;
+    } else if (strcmp(argv[1], "zerocopy") == 0) {
+        mode = AUDIO_CAPTURE_MODE_ZERO_COPY;
+    } else {
+        printf("Unknown capture mode: %s\n", argv[1]);
+        return 1;
+    }
+    
+    esp_err_t ret = audio_capture_set_mode(mode);
+    if (ret != ESP_OK) {
+        printf("Failed to set capture mode: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+    printf("Capture mode set to %s\n", argv[1]);
+    return 0;
+}
+
+static const char *codec_name(audio_codec_t codec) {
+    return (codec == AUDIO_CODEC_FLAC) ? "flac" : (codec == AUDIO_CODEC_BFP) ? "bfp" : "pcm";
+}
+
+// 录音编码命令处理函数
+static int codec_cmd_handler(int argc, char **argv) {
+    if (argc < 2) {
+        printf("Codec: %s\n", codec_name(audio_capture_get_codec()));
+        return 0;
+    }
+    
+    audio_codec_t codec;
+    if (strcmp(argv[1], "pcm") == 0) {
+        codec = AUDIO_CODEC_PCM;
+    } else if (strcmp(argv[1], "flac") == 0) {
+        codec = AUDIO_CODEC_FLAC;
+    } else if (strcmp(argv[1], "bfp") == 0) {
+        codec = AUDIO_CODEC_BFP;
+    } else {
+        printf("Unknown codec: %s\n", argv[1]);
+        return 1;
+    }
+    
+    esp_err_t ret = audio_capture_set_codec(codec);
+    if (ret != ESP_OK) {
+        printf("Failed to set codec: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+    printf("Codec set to %s\n", argv[1]);
+    return 0;
+}
+
+// 通道布局命令处理函数
+static int layout_cmd_handler(int argc, char **argv) {
+    if (argc < 2) {
+        printf("Layout: %s\n", audio_capture_get_layout() == AUDIO_LAYOUT_PLANAR ? "planar" : "interleaved");
+        return 0;
+    }
+    
+    audio_layout_t layout;
+    if (strcmp(argv[1], "interleaved") == 0) {
+        layout = AUDIO_LAYOUT_INTERLEAVED;
+    } else if (strcmp(argv[1], "planar") == 0) {
+        layout = AUDIO_LAYOUT_PLANAR;
+    } else {
+        printf("Unknown layout: %s\n", argv[1]);
+        return 1;
+    }
+    
+    esp_err_t ret = audio_capture_set_layout(layout);
+    if (ret != ESP_OK) {
+        printf("Failed to set layout: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+    printf("Layout set to %s\n", argv[1]);
+    return 0;
+}
+
+// 通道掩码命令处理函数
+static int channel_mask_cmd_handler(int argc, char **argv) {
+    if (argc < 2) {
+        uint32_t mask = audio_capture_get_channel_mask();
+        printf("Channel mask: 0x%02x (%u channels)\n", (unsigned)mask,
+               (unsigned)channel_mask_count(mask, TDM_CHANNELS));
+        return 0;
+    }
+    
+    char *end = NULL;
+    unsigned long mask = strtoul(argv[1], &end, 0);
+    if (end == argv[1] || *end != '\0') {
+        printf("Invalid channel mask: %s\n", argv[1]);
+        return 1;
+    }
+    
+    esp_err_t ret = audio_capture_set_channel_mask((uint32_t)mask);
+    if (ret != ESP_OK) {
+        printf("Failed to set channel mask: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+    printf("Channel mask set to 0x%02lx (%u channels)\n", mask,
+           (unsigned)channel_mask_count((uint32_t)mask, TDM_CHANNELS));
+    return 0;
+}
+
+// 打印采集配置及推导出的时钟和缓冲区参数
+static void print_profile(const char *prefix, const CaptureProfile *profile) {
+    CaptureTiming timing;
+    if (capture_profile_resolve(profile, AUDIO_BUFFER_SIZE, &timing) != CAPTURE_PROFILE_OK) {
+        printf("%s: %u Hz, %u-bit (invalid)\n", prefix, (unsigned)profile->sampleRate,
+               (unsigned)profile->bitsPerSample);
+        return;
+    }
+    printf("%s: %u Hz, %u-bit, decimation %u (PDM clock %u Hz, BCLK %u Hz, MCLK x%u)\n", prefix,
+           (unsigned)profile->sampleRate, (unsigned)profile->bitsPerSample, (unsigned)timing.decimation,
+           (unsigned)timing.pdmClockHz, (unsigned)timing.bclkHz, (unsigned)timing.mclkMultiple);
+    printf("  block %u bytes (%u frames), DMA %u x %u frames\n", (unsigned)timing.blockBytes,
+           (unsigned)timing.blockFrames, (unsigned)timing.dmaDescNum, (unsigned)timing.dmaFrameNum);
+}
+
+// 采集配置命令处理函数
+static int profile_cmd_handler(int argc, char **argv) {
+    CaptureProfile profile;
+    if (argc < 2) {
+        audio_capture_get_profile(&profile);
+        print_profile("Capture profile", &profile);
+        return 0;
+    }
+    
+    if (strcmp(argv[1], "long") == 0) {
+        profile = (CaptureProfile)CAPTURE_PROFILE_LONG;
+    } else if (strcmp(argv[1], "burst") == 0) {
+        profile = (CaptureProfile)CAPTURE_PROFILE_BURST;
+    } else if (argc >= 3) {
+        char *end1 = NULL, *end2 = NULL, *end3 = NULL;
+        unsigned long rate = strtoul(argv[1], &end1, 10);
+        unsigned long bits = strtoul(argv[2], &end2, 10);
+        unsigned long dec = (argc >= 4) ? strtoul(argv[3], &end3, 10) : 0;
+        if (*end1 != '\0' || *end2 != '\0' || (argc >= 4 && *end3 != '\0') || bits > 255 || dec > 255) {
+            printf("Invalid capture profile\n");
+            return 1;
+        }
+        profile.sampleRate = (uint32_t)rate;
+        profile.bitsPerSample = (uint8_t)bits;
+        profile.decimation = (uint8_t)dec;
+    } else {
+        printf("Unknown capture profile: %s\n", argv[1]);
+        return 1;
+    }
+    
+    CaptureTiming timing;
+    CaptureProfileError err = capture_profile_resolve(&profile, AUDIO_BUFFER_SIZE, &timing);
+    if (err != CAPTURE_PROFILE_OK) {
+        printf("Invalid capture profile: %s\n", capture_profile_error_str(err));
+        return 1;
+    }
+    esp_err_t ret = audio_capture_set_profile(&profile);
+    if (ret != ESP_OK) {
+        printf("Failed to set capture profile: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+    audio_capture_get_profile(&profile);
+    print_profile("Capture profile set", &profile);
+    return 0;
+}
+
+// 打印一个阶段边界的延迟摘要
+static void print_latency_line(const char *name, const uint32_t *hist, uint32_t maxUs) {
+    printf("%-16s p50 < %u us, p99 < %u us, max %u us\n", name, (unsigned)capture_stats_percentile_us(hist, 50),
+           (unsigned)capture_stats_percentile_us(hist, 99), (unsigned)maxUs);
+}
+
+// 打印一个log2延迟直方图（只打印非空的桶）
+static void print_latency_hist(const char *name, const uint32_t *hist, uint32_t maxUs, uint32_t lastUs) {
+    printf("%s latency: last %u us, max %u us, p50 < %u us, p99 < %u us\n", name, (unsigned)lastUs,
+           (unsigned)maxUs, (unsigned)capture_stats_percentile_us(hist, 50),
+           (unsigned)capture_stats_percentile_us(hist, 99));
+    for (int i = 0; i < CAPTURE_STATS_BUCKETS; i++) {
+        if (hist[i] == 0) {
+            continue;
+        }
+        if (i == CAPTURE_STATS_BUCKETS - 1) {
+            printf("  >= %7u us: %u\n", 1u << i, (unsigned)hist[i]);
+        } else {
+            printf("  < %8u us: %u\n", 2u << i, (unsigned)hist[i]);
+        }
+    }
+}
+
+// 采集统计命令处理函数
+static int capstats_cmd_handler(int argc, char **argv) {
+    if (argc >= 2) {
+        if (strcmp(argv[1], "reset") != 0) {
+            printf("Unknown argument: %s\n", argv[1]);
+            return 1;
+        }
+        audio_capture_reset_stats();
+        printf("Capture statistics cleared\n");
+        return 0;
+    }
+    
+    audio_capture_stats_t stats;
+    audio_capture_get_stats(&stats);
+    const CaptureStatsSnapshot *p = &stats.pipeline;
+    printf("I2S overruns: %u, partial-block frames discarded: %u\n", (unsigned)p->overruns,
+           (unsigned)p->discardedFrames);
+    if (audio_capture_get_mode() == AUDIO_CAPTURE_MODE_ZERO_COPY) {
+        printf("Zero-copy dropped frames: %u, stale blocks: %u (%u written corrupt)\n",
+               (unsigned)stats.droppedFrames, (unsigned)stats.staleBlocks, (unsigned)p->corruptBlocks);
+    }
+    printf("Blocks committed: %u, written: %u, write errors: %u\n", (unsigned)p->blocksCommitted,
+           (unsigned)p->blocksWritten, (unsigned)p->writeErrors);
+    if (audio_capture_get_codec() == AUDIO_CODEC_FLAC) {
+        printf("FLAC encoder failures: %u (stored verbatim)\n", (unsigned)p->flacFallbacks);
+    }
+    printf("Ring high-water: %u / %u blocks\n", (unsigned)p->ringHighWater, (unsigned)stats.ringCapacity);
+    if (stats.spillCapacity > 0) {
+        printf("PSRAM spill: %u blocks spilled, high-water %u / %u blocks\n", (unsigned)p->blocksSpilled,
+               (unsigned)p->spillHighWater, (unsigned)stats.spillCapacity);
+    }
+    uint32_t preMs, postMs;
+    if (audio_capture_get_event_capture(&preMs, &postMs)) {
+        printf("Events: %u detected, pre-roll %u blocks\n", (unsigned)stats.events, (unsigned)stats.preRollBlocks);
+    }
+    uint32_t rotateMs;
+    uint64_t rotateBytes;
+    audio_capture_get_rotation(&rotateMs, &rotateBytes);
+    if (rotateMs != 0 || rotateBytes != 0) {
+        printf("File rotations: %u, prep timeouts: %u\n", (unsigned)stats.rotations, (unsigned)stats.prepTimeouts);
+    }
+    printf("SD write rate: %u bytes/s\n", (unsigned)p->bytesPerSec);
+    // 阶段边界：读完 -> (处理) -> 对文件任务可见 -> 开始写出；处理阶段只在启用时有样本
+    if (capture_stats_percentile_us(p->processHist, 100) != 0) {
+        print_latency_line("Process wait:", p->processWaitHist, p->processWaitMaxUs);
+        print_latency_line("Process time:", p->processHist, p->processMaxUs);
+        printf("Processing queue high-water: %u blocks\n", (unsigned)p->processHighWater);
+    }
+    print_latency_line("Write wait:", p->writeWaitHist, p->writeWaitMaxUs);
+    printf("Backpressure: %u ring-full episodes (%u processing, %u writing)\n",
+           (unsigned)(p->backpressureProcess + p->backpressurePersist), (unsigned)p->backpressureProcess,
+           (unsigned)p->backpressurePersist);
+    print_latency_hist("Read-to-commit", p->commitHist, p->commitMaxUs, p->commitLastUs);
+    print_latency_hist("SD write", p->writeHist, p->writeMaxUs, p->writeLastUs);
+    return 0;
+}
+
+// 事件录音命令处理函数
+static int event_cmd_handler(int argc, char **argv) {
+    uint32_t preMs, postMs;
+    bool enabled = audio_capture_get_event_capture(&preMs, &postMs);
+    if (argc < 2) {
+        printf("Event capture: %s, pre-roll %u ms, post-roll %u ms\n", enabled ? "on" : "off",
+               (unsigned)preMs, (unsigned)postMs);
+        return 0;
+    }
+    
+    if (strcmp(argv[1], "off") == 0) {
+        enabled = false;
+    } else if (strcmp(argv[1], "on") == 0) {
+        enabled = true;
+        if (argc >= 4) {
+            char *end1 = NULL, *end2 = NULL;
+            unsigned long pre = strtoul(argv[2], &end1, 10);
+            unsigned long post = strtoul(argv[3], &end2, 10);
+            if (*end1 != '\0' || *end2 != '\0' || pre > 60000 || post > 60000) {
+                printf("Invalid pre/post-roll (0-60000 ms)\n");
+                return 1;
+            }
+            preMs = (uint32_t)pre;
+            postMs = (uint32_t)post;
+        }
+    } else {
+        printf("Unknown argument: %s\n", argv[1]);
+        return 1;
+    }
+    
+    esp_err_t ret = audio_capture_set_event_capture(enabled, preMs, postMs);
+    if (ret != ESP_OK) {
+        printf("Failed to set event capture: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+    printf("Event capture %s, pre-roll %u ms, post-roll %u ms\n", enabled ? "on" : "off", (unsigned)preMs,
+           (unsigned)postMs);
+    return 0;
+}
+
+// 解析一个触发阈值（dB或off）
+static bool parse_trigger_db(const char *arg, float off, float *value) {
+    if (strcmp(arg, "off") == 0) {
+        *value = off;
+        return true;
+    }
+    char *end = NULL;
+    float db = strtof(arg, &end);
+    if (end == arg || *end != '\0') {
+        return false;
+    }
+    *value = db;
+    return true;
+}
+
+// 打印触发条件（未启用的条件显示off）
+static void print_trigger(const char *prefix, const EventDetectorConfig *trigger) {
+    char rms[16] = "off", peak[16] = "off", vad[16] = "off";
+    if (trigger->rmsDbfs < 0.0f) {
+        snprintf(rms, sizeof(rms), "%.1f dBFS", (double)trigger->rmsDbfs);
+    }
+    if (trigger->peakDbfs <= 0.0f) {
+        snprintf(peak, sizeof(peak), "%.1f dBFS", (double)trigger->peakDbfs);
+    }
+    if (trigger->vadMarginDb > 0.0f) {
+        snprintf(vad, sizeof(vad), "+%.1f dB", (double)trigger->vadMarginDb);
+    }
+    printf("%s: RMS %s, peak %s, VAD %s\n", prefix, rms, peak, vad);
+}
+
+// 事件触发条件命令处理函数
+static int evtrig_cmd_handler(int argc, char **argv) {
+    EventDetectorConfig trigger;
+    audio_capture_get_event_trigger(&trigger);
+    if (argc < 2) {
+        print_trigger("Event trigger", &trigger);
+        return 0;
+    }
+    
+    // 按顺序覆盖：rms [peak [vad]]
+    float *fields[] = { &trigger.rmsDbfs, &trigger.peakDbfs, &trigger.vadMarginDb };
+    const float offs[] = { EVENT_LEVEL_OFF, EVENT_LEVEL_OFF, 0.0f };
+    for (int i = 1; i < argc && i <= 3; i++) {
+        if (!parse_trigger_db(argv[i], offs[i - 1], fields[i - 1])) {
+            printf("Invalid threshold: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    
+    esp_err_t ret = audio_capture_set_event_trigger(&trigger);
+    if (ret != ESP_OK) {
+        printf("Failed to set event trigger: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+    print_trigger("Event trigger set", &trigger);
+    return 0;
+}
+
+// 电平表命令处理函数
+static int meter_cmd_handler(int argc, char **argv) {
+    LevelTap *tap = audio_capture_get_level_tap();
+    if (argc >= 2) {
+        char *end;
+        unsigned long slot = strtoul(argv[1], &end, 0);
+        if (*end != '\0' || slot >= TDM_CHANNELS) {
+            printf("Invalid slot: %s (0-%d)\n", argv[1], TDM_CHANNELS - 1);
+            return 1;
+        }
+        level_tap_select_channel(tap, (uint32_t)slot);
+    }
+    
+    LevelMeterStats stats;
+    level_meter_get_stats(&stats);
+    printf("Spectrum slot: %u\n", (unsigned)level_tap_selected_channel(tap));
+    printf("Display: %u frames, %u ms per frame, %u us avg / %u us max per frame (%u.%u%% CPU), %u px redrawn per frame\n",
+           (unsigned)stats.frames, (unsigned)stats.frameMs, (unsigned)stats.avgUs, (unsigned)stats.maxUs,
+           (unsigned)(stats.avgUs / stats.frameMs / 10), (unsigned)(stats.avgUs / stats.frameMs % 10),
+           (unsigned)stats.avgPixels);
+    return 0;
+}
+
+// 文件轮转命令处理函数
+static int rotate_cmd_handler(int argc, char **argv) {
+    uint32_t rotateMs;
+    uint64_t rotateBytes;
+    audio_capture_get_rotation(&rotateMs, &rotateBytes);
+    if (argc < 2) {
+        if (rotateMs == 0 && rotateBytes == 0) {
+            printf("File rotation: off\n");
+        } else {
+            printf("File rotation: every %u min, %u MB (0 = no limit)\n", (unsigned)(rotateMs / 60000),
+                   (unsigned)(rotateBytes / (1024 * 1024)));
+        }
+        return 0;
+    }
+
+    if (strcmp(argv[1], "off") == 0) {
+        rotateMs = 0;
+        rotateBytes = 0;
+    } else {
+        char *end1 = NULL, *end2 = NULL;
+        unsigned long minutes = strtoul(argv[1], &end1, 10);
+        unsigned long mb = (argc >= 3) ? strtoul(argv[2], &end2, 10) : 0;
+        if (*end1 != '\0' || (argc >= 3 && *end2 != '\0') || minutes > 24 * 60 || mb > AUDIO_PREALLOC_MB * 4) {
+            printf("Invalid rotation (0-1440 minutes, 0-%u MB)\n", AUDIO_PREALLOC_MB * 4);
+            return 1;
+        }
+        rotateMs = (uint32_t)minutes * 60000;
+        rotateBytes = (uint64_t)mb * 1024 * 1024;
+    }
+
+    esp_err_t ret = audio_capture_set_rotation(rotateMs, rotateBytes);
+    if (ret != ESP_OK) {
+        printf("Failed to set file rotation: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+    printf("File rotation: every %u min, %u MB (0 = no limit)\n", (unsigned)(rotateMs / 60000),
+           (unsigned)(rotateBytes / (1024 * 1024)));
+    return 0;
+}
+
+// 多板同步命令处理函数
+static int sync_cmd_handler(int argc, char **argv) {
+    uint32_t periodMs;
+    bool enabled = audio_capture_get_sync(&periodMs);
+    if (argc < 2) {
+        printf("Sync: %s, reference pulse on GPIO%d every %u ms\n", enabled ? "on" : "off", SYNC_PULSE_IO,
+               (unsigned)periodMs);
+        SyncClockStatus status;
+        if (audio_capture_get_sync_status(&status)) {
+            printf("Pulses: %u located, %u missed, %u glitches, %u outliers, %u stale, %u fit resets\n",
+                   (unsigned)status.pulses, (unsigned)status.missed, (unsigned)status.glitches,
+                   (unsigned)status.outliers, (unsigned)status.stale, (unsigned)status.resets);
+            if (status.locked) {
+                printf("Sample clock: %+.3f ppm, last pulse %u residual %+.3f frames\n", status.ratePpb / 1e3,
+                       (unsigned)status.seq, status.residual / (double)SYNC_INDEX_POS_ONE);
+            } else {
+                printf("Sample clock: not locked yet\n");
+            }
+        }
+        return 0;
+    }
+
+    if (strcmp(argv[1], "off") == 0) {
+        enabled = false;
+    } else if (strcmp(argv[1], "on") == 0) {
+        enabled = true;
+        if (argc >= 3) {
+            char *end = NULL;
+            unsigned long ms = strtoul(argv[2], &end, 10);
+            if (*end != '\0' || ms < SYNC_CLOCK_MIN_PERIOD_MS || ms > SYNC_CLOCK_MAX_PERIOD_MS) {
+                printf("Invalid period (%u-%u ms)\n", SYNC_CLOCK_MIN_PERIOD_MS, SYNC_CLOCK_MAX_PERIOD_MS);
+                return 1;
+            }
+            periodMs = (uint32_t)ms;
+        }
+    } else {
+        printf("Unknown argument: %s\n", argv[1]);
+        return 1;
+    }
+
+    esp_err_t ret = audio_capture_set_sync(enabled, periodMs);
+    if (ret != ESP_OK) {
+        printf("Failed to set sync: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+    printf("Sync %s, reference pulse every %u ms\n", enabled ? "on" : "off", (unsigned)periodMs);
+    return 0;
+}
+
+static const char *beam_output_name(audio_beam_output_t output) {
+    return (output == AUDIO_BEAM_ONLY) ? "only" : (output == AUDIO_BEAM_WITH_RAW) ? "raw" : "off";
+}
+
+static void print_beams(audio_beam_output_t output, const float *azimuthDeg, uint32_t count) {
+    printf("Beams: %s", beam_output_name(output));
+    if (output != AUDIO_BEAM_OFF) {
+        printf(", %u at", (unsigned)count);
+        for (uint32_t b = 0; b < count; b++) {
+            printf(" %.1f", azimuthDeg[b]);
+        }
+        printf(" deg");
+    }
+    printf("\n");
+}
+
+// 波束形成命令处理函数
+static int beam_cmd_handler(int argc, char **argv) {
+    float azimuthDeg[BEAMFORMER_MAX_BEAMS];
+    uint32_t count;
+    audio_beam_output_t output = audio_capture_get_beams(azimuthDeg, &count);
+    if (argc < 2) {
+        print_beams(output, azimuthDeg, count);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "off") == 0) {
+        output = AUDIO_BEAM_OFF;
+    } else if (strcmp(argv[1], "only") == 0) {
+        output = AUDIO_BEAM_ONLY;
+    } else if (strcmp(argv[1], "raw") == 0) {
+        output = AUDIO_BEAM_WITH_RAW;
+    } else {
+        printf("Unknown argument: %s\n", argv[1]);
+        return 1;
+    }
+    // 不给指向时沿用原来的指向
+    if (argc >= 3) {
+        if (argc - 2 > BEAMFORMER_MAX_BEAMS) {
+            printf("At most %d beams\n", BEAMFORMER_MAX_BEAMS);
+            return 1;
+        }
+        count = 0;
+        for (int i = 2; i < argc; i++) {
+            char *end = NULL;
+            float az = strtof(argv[i], &end);
+            if (*end != '\0' || az < -360.0f || az > 360.0f) {
+                printf("Invalid azimuth: %s (-360..360 deg)\n", argv[i]);
+                return 1;
+            }
+            azimuthDeg[count++] = az;
+        }
+    }
+
+    esp_err_t ret = audio_capture_set_beams(output, azimuthDeg, count);
+    if (ret != ESP_OK) {
+        printf("Failed to set beams: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+    print_beams(output, azimuthDeg, count);
+    return 0;
+}
+
+// 波束几何命令处理函数
+static int beamgeo_cmd_handler(int argc, char **argv) {
+    if (argc >= 2) {
+        char *end = NULL;
+        float mm = (argc >= 3) ? strtof(argv[2], &end) : 0.0f;
+        if (argc < 3 || *end != '\0' || mm <= 0.0f || mm > 500.0f) {
+            printf("Expected circle|line and a size of 0-500 mm\n");
+            return 1;
+        }
+        BeamformerConfig geometry = { 0 };
+        if (strcmp(argv[1], "circle") == 0) {
+            beamformer_circular_array(&geometry, TDM_CHANNELS, mm / 1000.0f);
+        } else if (strcmp(argv[1], "line") == 0) {
+            beamformer_linear_array(&geometry, TDM_CHANNELS, mm / 1000.0f);
+        } else {
+            printf("Unknown geometry: %s\n", argv[1]);
+            return 1;
+        }
+        esp_err_t ret = audio_capture_set_beam_array(geometry.mic);
+        if (ret != ESP_OK) {
+            printf("Failed to set the beam geometry: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+    }
+
+    BeamformerPoint mics[TDM_CHANNELS];
+    audio_capture_get_beam_array(mics);
+    printf("Microphone positions (mm):\n");
+    for (int i = 0; i < TDM_CHANNELS; i++) {
+        printf("  slot %d: %7.1f %7.1f %7.1f\n", i, mics[i].x * 1000.0f, mics[i].y * 1000.0f, mics[i].z * 1000.0f);
+    }
+    return 0;
+}
+
+// 解析一个不超过max的无符号十进制参数
+static bool parse_u32(const char *arg, uint32_t max, uint32_t *value) {
+    char *end = NULL;
+    unsigned long v = strtoul(arg, &end, 10);
+    if (*end != '\0' || v > max) {
+        return false;
+    }
+    *value = (uint32_t)v;
+    return true;
+}
+
+// 声源方位估计命令处理函数
+static int doa_cmd_handler(int argc, char **argv) {
+    uint32_t frameSize, overlapPct, rateHz;
+    bool enabled = audio_capture_get_doa(&frameSize, &overlapPct, &rateHz);
+    if (argc < 2) {
+        printf("DOA: %s, %u-frame windows, %u%% overlap, %u estimates/s\n", enabled ? "on" : "off",
+               (unsigned)frameSize, (unsigned)overlapPct, (unsigned)rateHz);
+        DoaEstimate estimate;
+        uint32_t count;
+        if (audio_capture_get_doa_status(&estimate, &count)) {
+            printf("Bearing: %.1f deg, confidence %.2f (%u estimates)\n", estimate.azimuthDeg, estimate.confidence,
+                   (unsigned)count);
+        }
+        return 0;
+    }
+
+    if (strcmp(argv[1], "off") == 0) {
+        enabled = false;
+    } else if (strcmp(argv[1], "on") == 0) {
+        enabled = true;
+        if ((argc >= 3 && !parse_u32(argv[2], DOA_MAX_FRAME, &frameSize)) ||
+            (argc >= 4 && !parse_u32(argv[3], 90, &overlapPct)) ||
+            (argc >= 5 && !parse_u32(argv[4], AUDIO_DOA_MAX_RATE_HZ, &rateHz))) {
+            printf("Expected a window of %d-%d frames, 0-90%% overlap and 1-%d estimates/s\n", DOA_MIN_FRAME,
+                   DOA_MAX_FRAME, AUDIO_DOA_MAX_RATE_HZ);
+            return 1;
+        }
+    } else {
+        printf("Unknown argument: %s\n", argv[1]);
+        return 1;
+    }
+
+    esp_err_t ret = audio_capture_set_doa(enabled, frameSize, overlapPct, rateHz);
+    if (ret != ESP_OK) {
+        printf("Failed to set DOA: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+    printf("DOA %s, %u-frame windows, %u%% overlap, %u estimates/s\n", enabled ? "on" : "off",
+           (unsigned)frameSize, (unsigned)overlapPct, (unsigned)rateHz);
+    return 0;
+}
+
+// 方位估计麦克风对命令处理函数
+static int doapairs_cmd_handler(int argc, char **argv) {
+    uint8_t pairs[DOA_MAX_PAIRS][2];
+    if (argc >= 2) {
+        uint32_t count = 0;
+        if (strcmp(argv[1], "all") != 0) {
+            if (argc - 1 > DOA_MAX_PAIRS) {
+                printf("At most %d pairs\n", DOA_MAX_PAIRS);
+                return 1;
+            }
+            for (int i = 1; i < argc; i++) {
+                unsigned a, b;
+                char extra;
+                if (sscanf(argv[i], "%u-%u%c", &a, &b, &extra) != 2 || a >= TDM_CHANNELS || b >= TDM_CHANNELS ||
+                    a == b) {
+                    printf("Invalid pair: %s (slot-slot, 0-%d)\n", argv[i], TDM_CHANNELS - 1);
+                    return 1;
+                }
+                pairs[count][0] = (uint8_t)a;
+                pairs[count][1] = (uint8_t)b;
+                count++;
+            }
+        }
+        esp_err_t ret = audio_capture_set_doa_pairs(pairs, count);
+        if (ret != ESP_OK) {
+            printf("Failed to set DOA pairs: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+    }
+
+    uint32_t count = audio_capture_get_doa_pairs(pairs);
+    if (count == 0) {
+        printf("DOA pairs: all pairs of recorded microphones\n");
+        return 0;
+    }
+    printf("DOA pairs:");
+    for (uint32_t i = 0; i < count; i++) {
+        printf(" %u-%u", (unsigned)pairs[i][0], (unsigned)pairs[i][1]);
+    }
+    printf("\n");
+    return 0;
+}
+
+// 多采样率输出命令处理函数
+static int rates_cmd_handler(int argc, char **argv) {
+    uint32_t rates[DECIMATOR_MAX_OUTPUTS];
+    if (argc >= 2) {
+        uint32_t count = 0;
+        if (strcmp(argv[1], "off") != 0) {
+            if (argc - 1 > DECIMATOR_MAX_OUTPUTS) {
+                printf("At most %d rates\n", DECIMATOR_MAX_OUTPUTS);
+                return 1;
+            }
+            for (int i = 1; i < argc; i++) {
+                if (!parse_u32(argv[i], UINT32_MAX, &rates[count])) {
+                    printf("Invalid rate: %s\n", argv[i]);
+                    return 1;
+                }
+                count++;
+            }
+        }
+        esp_err_t ret = audio_capture_set_rates(rates, count);
+        if (ret != ESP_OK) {
+            printf("Failed to set the rate outputs: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+    }
+
+    uint32_t count = audio_capture_get_rates(rates);
+    if (count == 0) {
+        printf("Rate outputs: off\n");
+        return 0;
+    }
+    printf("Rate outputs:\n");
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t factor;
+        float macs, latency;
+        printf("  %6u Hz (%s%u)", (unsigned)rates[i], AUDIO_RATE_FILE_EXT, (unsigned)(rates[i] / 1000));
+        if (audio_capture_get_rate_cost(i, &factor, &macs, &latency)) {
+            printf(": 1/%u, %.1f multiplies per frame and channel, latency %.1f frames", (unsigned)factor, macs,
+                   latency);
+        }
+        printf("\n");
+    }
+    return 0;
+}
+
+// 声学特征命令处理函数
+static int features_cmd_handler(int argc, char **argv) {
+    uint32_t periodMs, bands;
+    bool enabled = audio_capture_get_features(&periodMs, &bands);
+    if (argc < 2) {
+        printf("Features: %s, every %u ms, %u bands, %u records\n", enabled ? "on" : "off", (unsigned)periodMs,
+               (unsigned)bands, (unsigned)audio_capture_get_feature_count());
+        return 0;
+    }
+
+    if (strcmp(argv[1], "off") == 0) {
+        enabled = false;
+    } else if (strcmp(argv[1], "on") == 0) {
+        enabled = true;
+        if ((argc >= 3 && !parse_u32(argv[2], AUDIO_FEATURE_MAX_PERIOD_MS, &periodMs)) ||
+            (argc >= 4 && !parse_u32(argv[3], FEATURE_MAX_BANDS, &bands))) {
+            printf("Expected a period of %d-%d ms and 1-%d bands\n", AUDIO_FEATURE_MIN_PERIOD_MS,
+                   AUDIO_FEATURE_MAX_PERIOD_MS, FEATURE_MAX_BANDS);
+            return 1;
+        }
+    } else {
+        printf("Unknown argument: %s\n", argv[1]);
+        return 1;
+    }
+
+    esp_err_t ret = audio_capture_set_features(enabled, periodMs, bands);
+    if (ret != ESP_OK) {
+        printf("Failed to set the features: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+    printf("Features %s, every %u ms, %u bands\n", enabled ? "on" : "off", (unsigned)periodMs, (unsigned)bands);
+    return 0;
+}
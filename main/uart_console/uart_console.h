@@ -3,12 +3,14 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
 #include "esp_system.h"
 #include "esp_log.h"
 #include "esp_console.h"
 #include "esp_vfs_dev.h"
 #include "driver/uart.h"
 #include "AudioCapture.h"
+#include "LevelMeter.h"
 
 
 // 函数声明
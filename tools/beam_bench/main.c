@@ -0,0 +1,249 @@
+// 波束形成基准：用合成的平面波（几个正弦的和，按麦克风位置精确计算到达时间）和各路不相关的白噪声
+// 检查Beamformer，再测量1、4、16个波束的实时系数（处理耗时/音频时长）：
+//   - 保真度：指向声源的波束与声源信号（按latencyFrames延迟）的信号失真比；
+//   - 抑制：同一信号在背向声源的波束中比指向声源的波束低多少，与按阵列几何算出的理想延迟求和波束图比较；
+//   - 白噪声增益：各路不相关噪声经过波束后降低多少（理想为10log10(麦克风数)）；
+//   - 连续性：按不同块长处理同一信号，输出逐样本相同。
+//
+// 用法: beam_bench [-m 麦克风数] [-a 圆阵半径mm | -l 线阵间距mm] [-z 声源方位角] [-r 采样率]
+//                  [-f 每块帧数] [-t 秒]
+// 检查不通过时退出码为1。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <getopt.h>
+#include <time.h>
+#include "Beamformer.h"
+
+#define SOURCE_TONES    5
+#define NOISE_RMS       0.05        // 每路噪声（满量程的比例）
+#define MIN_SDR_DB      40.0
+#define MAX_REJECT_DB   30.0        // 理想抑制超过这个值时只要求达到这个值（分数延迟FIR的误差）
+#define REJECT_TOL_DB   1.0
+#define MAX_WNG_LOSS_DB 1.0         // 白噪声增益低于理想值的容差
+
+static const double toneHz[SOURCE_TONES] = { 1500, 2500, 3500, 4500, 5500 };
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 伪随机噪声（xorshift），[-1, 1)
+static uint32_t rngState = 0x6C078965;
+static double noise(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return (double)(int32_t)rngState / 2147483648.0;
+}
+
+// 声源信号：几个等幅正弦的和，峰值约-6dBFS
+static double source(double t) {
+    double s = 0;
+    for (int k = 0; k < SOURCE_TONES; k++) {
+        s += sin(2.0 * M_PI * toneHz[k] * t + k);
+    }
+    return s * 0.5 / SOURCE_TONES;
+}
+
+static int16_t quantize(double x) {
+    long v = lround(x * 32767.0);
+    return (int16_t)((v > 32767) ? 32767 : (v < -32768) ? -32768 : v);
+}
+
+// 从方位角azDeg（水平面）来的平面波：位置p的麦克风比原点早 p·u/c 收到
+static void synthesize(int16_t *in, uint32_t frames, uint32_t mics, const BeamformerConfig *config, double azDeg,
+                       double sampleRate, bool withSignal, bool withNoise) {
+    double az = azDeg * M_PI / 180.0;
+    double ux = cos(az), uy = sin(az);
+    for (uint32_t m = 0; m < mics; m++) {
+        double lead = (config->mic[m].x * ux + config->mic[m].y * uy) / BEAMFORMER_SOUND_SPEED;
+        for (uint32_t n = 0; n < frames; n++) {
+            double x = withSignal ? source(n / sampleRate + lead) : 0.0;
+            x += withNoise ? NOISE_RMS * sqrt(3.0) * noise() : 0.0;
+            in[(size_t)n * mics + m] = quantize(x);
+        }
+    }
+}
+
+// 理想延迟求和波束指向azBeam时对azSource方向声源的功率响应（各正弦的平均）
+static double ideal_response(const BeamformerConfig *config, uint32_t mics, double azSource, double azBeam) {
+    double ux = cos(azSource * M_PI / 180.0) - cos(azBeam * M_PI / 180.0);
+    double uy = sin(azSource * M_PI / 180.0) - sin(azBeam * M_PI / 180.0);
+    double sum = 0;
+    for (int k = 0; k < SOURCE_TONES; k++) {
+        double re = 0, im = 0;
+        for (uint32_t m = 0; m < mics; m++) {
+            double phase = 2.0 * M_PI * toneHz[k] * (config->mic[m].x * ux + config->mic[m].y * uy) /
+                           BEAMFORMER_SOUND_SPEED;
+            re += cos(phase);
+            im += sin(phase);
+        }
+        sum += (re * re + im * im) / ((double)mics * mics);
+    }
+    return sum / SOURCE_TONES;
+}
+
+// 按blockFrames一块一块处理frames帧
+static void run(Beamformer *bf, const int16_t *in, uint32_t frames, uint32_t blockFrames, int16_t *out) {
+    beamformer_reset(bf);
+    for (uint32_t n = 0; n < frames; n += blockFrames) {
+        uint32_t count = (frames - n < blockFrames) ? frames - n : blockFrames;
+        beamformer_process(bf, in + (size_t)n * bf->mics, count, out + (size_t)n * bf->beams);
+    }
+}
+
+// 波束b从第skip帧起的功率
+static double power(const int16_t *out, uint32_t frames, uint32_t beams, uint32_t b, uint32_t skip) {
+    double sum = 0;
+    for (uint32_t n = skip; n < frames; n++) {
+        double v = out[(size_t)n * beams + b] / 32767.0;
+        sum += v * v;
+    }
+    return sum / (frames - skip);
+}
+
+static double db(double ratio) {
+    return 10.0 * log10(ratio);
+}
+
+int main(int argc, char **argv) {
+    uint32_t mics = 8;
+    double radiusMm = 40.0;
+    double spacingMm = 0.0;
+    double sourceAz = 30.0;
+    uint32_t sampleRate = 96000;
+    uint32_t blockFrames = 2048;    // 96kHz/16位/8槽位时一个32KB块
+    uint32_t seconds = 5;
+    int c;
+    while ((c = getopt(argc, argv, "m:a:l:z:r:f:t:h")) != -1) {
+        switch (c) {
+        case 'm': mics = strtoul(optarg, NULL, 0); break;
+        case 'a': radiusMm = atof(optarg); break;
+        case 'l': spacingMm = atof(optarg); break;
+        case 'z': sourceAz = atof(optarg); break;
+        case 'r': sampleRate = strtoul(optarg, NULL, 0); break;
+        case 'f': blockFrames = strtoul(optarg, NULL, 0); break;
+        case 't': seconds = strtoul(optarg, NULL, 0); break;
+        default:
+            printf("Usage: %s [-m mics] [-a radius_mm | -l spacing_mm] [-z source_azimuth] [-r sample_rate]\n"
+                   "          [-f frames_per_block] [-t seconds]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (mics < 2 || mics > BEAMFORMER_MAX_MICS || sampleRate == 0 || blockFrames < 2 || seconds == 0 ||
+        radiusMm <= 0.0 || spacingMm < 0.0) {
+        return 2;
+    }
+
+    BeamformerConfig config = { 0 };
+    if (spacingMm > 0.0) {
+        beamformer_linear_array(&config, mics, (float)(spacingMm / 1000.0));
+        printf("Linear array: %u mics, %.1f mm spacing", (unsigned)mics, spacingMm);
+    } else {
+        beamformer_circular_array(&config, mics, (float)(radiusMm / 1000.0));
+        printf("Circular array: %u mics, %.1f mm radius", (unsigned)mics, radiusMm);
+    }
+    printf(", %u Hz, %u frames per block, source at %.0f deg\n", (unsigned)sampleRate, (unsigned)blockFrames,
+           sourceAz);
+
+    // 两个波束：指向声源和背向声源
+    config.beams = 2;
+    config.azimuthDeg[0] = (float)sourceAz;
+    config.azimuthDeg[1] = (float)(sourceAz + 180.0);
+    uint32_t slotMask = (1u << mics) - 1;
+    Beamformer bf;
+    if (!beamformer_init(&bf, &config, (float)sampleRate, slotMask, blockFrames)) {
+        printf("Failed to set up the beamformer\n");
+        return 1;
+    }
+    printf("Latency %.2f frames, history %u frames\n", bf.latencyFrames, (unsigned)bf.history);
+
+    uint32_t frames = sampleRate;   // 检查用1秒
+    uint32_t skip = bf.history + BEAMFORMER_TAPS;
+    int16_t *in = malloc((size_t)frames * mics * sizeof(int16_t));
+    int16_t *out = malloc((size_t)frames * BEAMFORMER_MAX_BEAMS * sizeof(int16_t));
+    int16_t *ref = malloc((size_t)frames * BEAMFORMER_MAX_BEAMS * sizeof(int16_t));
+    if (in == NULL || out == NULL || ref == NULL) {
+        return 1;
+    }
+    int failures = 0;
+
+    // 保真度和抑制：无噪声
+    synthesize(in, frames, mics, &config, sourceAz, sampleRate, true, false);
+    run(&bf, in, frames, blockFrames, out);
+    double signal = 0, error = 0;
+    for (uint32_t n = skip; n < frames; n++) {
+        double ideal = source((n - bf.latencyFrames) / sampleRate);
+        double e = out[(size_t)n * 2] / 32767.0 - ideal;
+        signal += ideal * ideal;
+        error += e * e;
+    }
+    double sdr = db(signal / error);
+    double reject = db(power(out, frames, 2, 0, skip) / power(out, frames, 2, 1, skip));
+    double idealReject = -db(ideal_response(&config, mics, sourceAz, config.azimuthDeg[1]));
+    double minReject = ((idealReject < MAX_REJECT_DB) ? idealReject : MAX_REJECT_DB) - REJECT_TOL_DB;
+    printf("On-target SDR:      %6.1f dB (min %.0f)\n", sdr, MIN_SDR_DB);
+    printf("Back rejection:     %6.1f dB (ideal %.1f)\n", reject, idealReject);
+    failures += (sdr < MIN_SDR_DB) + (reject < minReject);
+
+    // 连续性：块长不同（包括不整除的块长）时输出相同
+    uint32_t oddFrames = blockFrames / 3 + 1;
+    run(&bf, in, frames, oddFrames, ref);
+    bool same = memcmp(out, ref, (size_t)frames * 2 * sizeof(int16_t)) == 0;
+    printf("Block continuity:   %s (%u vs %u frames per block)\n", same ? "identical" : "MISMATCH",
+           (unsigned)blockFrames, (unsigned)oddFrames);
+    failures += !same;
+
+    // 白噪声增益：只有各路不相关的噪声
+    synthesize(in, frames, mics, &config, sourceAz, sampleRate, false, true);
+    run(&bf, in, frames, blockFrames, out);
+    double inPower = 0;
+    for (size_t i = (size_t)skip * mics; i < (size_t)frames * mics; i++) {
+        double v = in[i] / 32767.0;
+        inPower += v * v;
+    }
+    inPower /= (double)(frames - skip) * mics;
+    double wng = db(inPower / power(out, frames, 2, 0, skip));
+    printf("White noise gain:   %6.1f dB (ideal %.1f)\n", wng, db(mics));
+    failures += (wng < db(mics) - MAX_WNG_LOSS_DB);
+    beamformer_deinit(&bf);
+
+    // 实时系数：seconds秒有噪声的信号，波束均匀分布在水平面上
+    synthesize(in, frames, mics, &config, sourceAz, sampleRate, true, true);
+    static const uint32_t beamCounts[] = { 1, 4, 16 };
+    for (size_t i = 0; i < sizeof(beamCounts) / sizeof(beamCounts[0]); i++) {
+        config.beams = beamCounts[i];
+        for (uint32_t b = 0; b < config.beams; b++) {
+            config.azimuthDeg[b] = (float)(sourceAz + 360.0 * b / config.beams);
+        }
+        if (!beamformer_init(&bf, &config, (float)sampleRate, slotMask, blockFrames)) {
+            printf("Failed to set up %u beams\n", (unsigned)config.beams);
+            return 1;
+        }
+        volatile uint32_t sink = 0;
+        double t0 = now_sec();
+        for (uint32_t s = 0; s < seconds; s++) {
+            run(&bf, in, frames, blockFrames, out);
+            sink += (uint16_t)out[s];
+        }
+        double elapsed = now_sec() - t0;
+        double rtf = elapsed / seconds;
+        printf("%2u beams: %8.2f ns/frame, real-time factor %.4f (host)\n", (unsigned)config.beams,
+               elapsed * 1e9 / ((double)frames * seconds), rtf);
+        beamformer_deinit(&bf);
+    }
+
+    free(in);
+    free(out);
+    free(ref);
+    if (failures != 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,336 @@
+// 块浮点打包基准：检查BfpCodec打包/还原的误差界，再测量打包和还原的吞吐量：
+//   - 误差界：各组电平从满量程到-140dBFS的随机样本（含±满量程、全0和单个尖峰的组），每个样本的还原误差
+//     不超过2^(e-1)（e = 0时无损），e是让组内尾数放进int16的最小指数（e-1会溢出）；
+//   - 动态范围：-6..-120dBFS的正弦打包后相对24位原始信号的信噪比，与直接截取高16位对比；
+//   - 一致性：32位容器与同样的24位打包输入结果逐字节相同；不足一组的块尾和不整除的块长按组正确划分，
+//     头部往返一致。
+//
+// 用法: bfp_bench [-r 采样率] [-c 通道数] [-f 每块帧数] [-g 每组帧数] [-t 秒]
+// 检查不通过时退出码为1。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <getopt.h>
+#include <time.h>
+#include "BfpCodec.h"
+
+#define BENCH_PI        3.14159265358979323846
+#define FULL_SCALE      8388608.0   // 24位满量程
+#define MIN_GAIN_DB     30.0        // -80dBFS以下的正弦相对16位截取至少提高的信噪比
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static int32_t clamp_s24(double x) {
+    long v = lround(x);
+    return (int32_t)((v > 8388607) ? 8388607 : (v < -8388608) ? -8388608 : v);
+}
+
+// 24位样本打包为3字节（小端）
+static void store_s24(int32_t *in, size_t count, uint8_t *out) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t v = (uint32_t)in[i];
+        out[i * 3] = (uint8_t)v;
+        out[i * 3 + 1] = (uint8_t)(v >> 8);
+        out[i * 3 + 2] = (uint8_t)(v >> 16);
+    }
+}
+
+// 每组每个通道一个电平：随机样本，部分组换成极端值
+static void synthesize_groups(int32_t *x, uint32_t channels, uint32_t frames, uint32_t groupFrames) {
+    for (uint32_t pos = 0; pos < frames; pos += groupFrames) {
+        uint32_t n = (frames - pos < groupFrames) ? frames - pos : groupFrames;
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            uint32_t kind = rng_next() % 16;
+            double level = FULL_SCALE * pow(10.0, -(double)(rng_next() % 1400) / 200.0);    // 0..-140dBFS
+            for (uint32_t i = 0; i < n; i++) {
+                int32_t *s = &x[((size_t)pos + i) * channels + ch];
+                switch (kind) {
+                case 0: *s = 8388607; break;                                      // 正满量程
+                case 1: *s = -8388608; break;                                     // 负满量程
+                case 2: *s = (i & 1) ? 8388607 : -8388608; break;
+                case 3: *s = 0; break;
+                case 4: *s = (i == n / 2) ? 8388607 - (int32_t)(rng_next() % 256) : 0; break;   // 满量程附近的尖峰
+                case 5: *s = (i == n / 2) ? 32767 + (int32_t)(rng_next() % 3) : 0; break;       // int16的边界
+                default:
+                    *s = clamp_s24(level * ((double)(rng_next() % 2000001) / 1000000.0 - 1.0));
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// 组内的指数：最小的e使 round(x / 2^e) 都在int16内（参考实现，用浮点）
+static uint32_t reference_exponent(const int32_t *x, uint32_t channels, uint32_t n) {
+    for (uint32_t e = 0; e <= BFP_MAX_EXPONENT; e++) {
+        bool fits = true;
+        for (uint32_t i = 0; i < n && fits; i++) {
+            double m = (e == 0) ? x[(size_t)i * channels] : floor(x[(size_t)i * channels] / ldexp(1.0, (int)e) + 0.5);
+            fits = m >= -32768.0 && m <= 32767.0;
+        }
+        if (fits) {
+            return e;
+        }
+    }
+    return BFP_MAX_EXPONENT + 1;
+}
+
+static bool check_bounds(uint32_t channels, uint32_t frames, uint32_t groupFrames) {
+    size_t count = (size_t)frames * channels;
+    int32_t *x = malloc(count * sizeof(int32_t));
+    int32_t *y = malloc(count * sizeof(int32_t));
+    uint8_t *packed24 = malloc(count * 3);
+    uint8_t *packed = malloc(bfp_packed_bytes(channels, frames, groupFrames));
+    uint8_t *exponents = malloc(((size_t)frames / groupFrames + 1) * channels);
+    if (x == NULL || y == NULL || packed24 == NULL || packed == NULL || exponents == NULL) {
+        return false;
+    }
+    synthesize_groups(x, channels, frames, groupFrames);
+    store_s24(x, count, packed24);
+    size_t bytes = bfp_pack(packed24, 3, channels, frames, groupFrames, packed);
+    size_t used = bfp_unpack(packed, channels, frames, groupFrames, y, exponents);
+
+    uint64_t violations = 0, lossless = 0, losslessSamples = 0, wrongExponent = 0, groups = 0;
+    uint32_t histogram[BFP_MAX_EXPONENT + 1] = { 0 };
+    for (uint32_t pos = 0, g = 0; pos < frames; pos += groupFrames, g++) {
+        uint32_t n = (frames - pos < groupFrames) ? frames - pos : groupFrames;
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            uint32_t e = exponents[(size_t)g * channels + ch];
+            wrongExponent += e != reference_exponent(&x[(size_t)pos * channels + ch], channels, n);
+            histogram[(e <= BFP_MAX_EXPONENT) ? e : BFP_MAX_EXPONENT]++;
+            groups++;
+            int64_t bound = (e == 0) ? 0 : (1 << (e - 1));
+            for (uint32_t i = 0; i < n; i++) {
+                size_t k = ((size_t)pos + i) * channels + ch;
+                int64_t err = (int64_t)x[k] - y[k];
+                violations += (err > bound || err < -bound || y[k] > 8388607 || y[k] < -8388608);
+                losslessSamples += (e == 0);
+                lossless += (e == 0 && err == 0);
+            }
+        }
+    }
+    bool ok = bytes == used && bytes == bfp_packed_bytes(channels, frames, groupFrames) && violations == 0 &&
+              wrongExponent == 0 && lossless == losslessSamples;
+    printf("Error bound:       %llu groups, %llu samples over 2^(e-1), %llu non-minimal exponents, "
+           "e=0 groups %s%s\n", (unsigned long long)groups, (unsigned long long)violations,
+           (unsigned long long)wrongExponent, (lossless == losslessSamples) ? "lossless" : "NOT LOSSLESS",
+           ok ? "" : "  FAIL");
+    printf("  exponents:      ");
+    for (uint32_t e = 0; e <= BFP_MAX_EXPONENT; e++) {
+        printf(" e%u %u", (unsigned)e, (unsigned)histogram[e]);
+    }
+    printf("\n");
+
+    free(x);
+    free(y);
+    free(packed24);
+    free(packed);
+    free(exponents);
+    return ok;
+}
+
+// 正弦经块浮点和16位截取后相对24位原始信号的信噪比
+static bool check_dynamic_range(uint32_t sampleRate, uint32_t channels, uint32_t frames, uint32_t groupFrames) {
+    size_t count = (size_t)frames * channels;
+    int32_t *x = malloc(count * sizeof(int32_t));
+    int32_t *y = malloc(count * sizeof(int32_t));
+    uint8_t *packed24 = malloc(count * 3);
+    uint8_t *packed = malloc(bfp_packed_bytes(channels, frames, groupFrames));
+    if (x == NULL || y == NULL || packed24 == NULL || packed == NULL) {
+        return false;
+    }
+    static const double levels[] = { -6, -20, -40, -60, -80, -100, -120 };
+    bool ok = true;
+    printf("Dynamic range (1 kHz sine, SNR vs the 24-bit input):\n");
+    for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+        double amplitude = FULL_SCALE * pow(10.0, levels[l] / 20.0);
+        for (uint32_t i = 0; i < frames; i++) {
+            for (uint32_t ch = 0; ch < channels; ch++) {
+                x[(size_t)i * channels + ch] = clamp_s24(amplitude * sin(2.0 * BENCH_PI * 1000.0 * i / sampleRate + ch));
+            }
+        }
+        store_s24(x, count, packed24);
+        bfp_pack(packed24, 3, channels, frames, groupFrames, packed);
+        bfp_unpack(packed, channels, frames, groupFrames, y, NULL);
+        double signal = 0, noise = 0, noise16 = 0;
+        for (size_t i = 0; i < count; i++) {
+            double truncated = (double)((x[i] >> 8) * 256);     // 16位录音：只保留高16位
+            signal += (double)x[i] * x[i];
+            noise += ((double)x[i] - y[i]) * ((double)x[i] - y[i]);
+            noise16 += (x[i] - truncated) * (x[i] - truncated);
+        }
+        double snr = (noise > 0) ? 10.0 * log10(signal / noise) : INFINITY;
+        double snr16 = (noise16 > 0) ? 10.0 * log10(signal / noise16) : INFINITY;
+        // 块浮点至少与16位截取一样好；-48dBFS以下无损，-80dBFS以下至少提高MIN_GAIN_DB
+        bool pass = snr >= snr16 && (levels[l] > -48.0 || noise == 0) &&
+                    (levels[l] > -80.0 || snr >= snr16 + MIN_GAIN_DB);
+        char text[24];
+        snprintf(text, sizeof(text), isinf(snr) ? "lossless" : "%.1f dB", snr);
+        printf("  %5.0f dBFS: block floating point %-9s 16-bit truncation %6.1f dB%s\n", levels[l], text, snr16,
+               pass ? "" : "  FAIL");
+        ok &= pass;
+    }
+    free(x);
+    free(y);
+    free(packed24);
+    free(packed);
+    return ok;
+}
+
+// 32位容器与24位打包输入、不整除的块长、头部往返
+static bool check_consistency(uint32_t channels, uint32_t frames, uint32_t groupFrames, uint32_t sampleRate) {
+    size_t count = (size_t)frames * channels;
+    int32_t *x = malloc(count * sizeof(int32_t));
+    uint8_t *packed24 = malloc(count * 3);
+    int32_t *wide = malloc(count * sizeof(int32_t));
+    size_t cap = bfp_packed_bytes(channels, frames, groupFrames);
+    uint8_t *a = malloc(cap), *b = malloc(cap);
+    if (x == NULL || packed24 == NULL || wide == NULL || a == NULL || b == NULL) {
+        return false;
+    }
+    synthesize_groups(x, channels, frames, groupFrames);
+    store_s24(x, count, packed24);
+    for (size_t i = 0; i < count; i++) {
+        wide[i] = (int32_t)((uint32_t)x[i] << 8) | (int32_t)(i & 0xFF);      // 低8位为杂散数据，应被忽略
+    }
+    size_t n24 = bfp_pack(packed24, 3, channels, frames, groupFrames, a);
+    size_t n32 = bfp_pack(wide, 4, channels, frames, groupFrames, b);
+    bool same = n24 == n32 && memcmp(a, b, n24) == 0;
+    printf("32-bit input:      %s\n", same ? "identical" : "MISMATCH");
+    bool ok = same;
+
+    // 块长不是组长的整数倍：最后一组较短，打包长度与公式一致，还原后与整块一起打包时相同
+    uint32_t odd = frames - groupFrames / 2 - 1;
+    int32_t *y = malloc(count * sizeof(int32_t));
+    size_t nOdd = bfp_pack(packed24, 3, channels, odd, groupFrames, a);
+    bfp_unpack(a, channels, odd, groupFrames, y, NULL);
+    bfp_pack(packed24, 3, channels, frames, groupFrames, b);
+    int32_t *z = malloc(count * sizeof(int32_t));
+    bfp_unpack(b, channels, frames, groupFrames, z, NULL);
+    uint32_t whole = odd / groupFrames * groupFrames;   // 完整的组两边相同
+    same = nOdd == bfp_packed_bytes(channels, odd, groupFrames) &&
+           memcmp(y, z, (size_t)whole * channels * sizeof(int32_t)) == 0;
+    printf("Partial group:     %s (%u frames, %u per group)\n", same ? "consistent" : "MISMATCH", (unsigned)odd,
+           (unsigned)groupFrames);
+    ok &= same;
+
+    uint8_t header[BFP_HEADER_BYTES];
+    BfpFormat format = { .sampleRate = sampleRate, .channels = (uint16_t)channels, .sourceBits = 24,
+                         .blockFrames = frames, .groupFrames = groupFrames, .channelMask = 0xA5 }, back;
+    same = bfp_build_header(header, &format) && bfp_parse_header(header, sizeof(header), &back) &&
+           memcmp(&format, &back, sizeof(format)) == 0;
+    printf("Header:            %s, %u bytes per %u-frame block\n", same ? "round trip identical" : "MISMATCH",
+           (unsigned)bfp_block_bytes(&format), (unsigned)frames);
+    ok &= same;
+
+    free(x);
+    free(y);
+    free(z);
+    free(packed24);
+    free(wide);
+    free(a);
+    free(b);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    uint32_t sampleRate = 96000;
+    uint32_t channels = 8;
+    uint32_t blockFrames = 1344;    // 96kHz/24位/8槽位时一个32KB块（扇区对齐）
+    uint32_t groupFrames = BFP_DEFAULT_GROUP;
+    uint32_t seconds = 5;
+    int c;
+    while ((c = getopt(argc, argv, "r:c:f:g:t:h")) != -1) {
+        switch (c) {
+        case 'r': sampleRate = strtoul(optarg, NULL, 0); break;
+        case 'c': channels = strtoul(optarg, NULL, 0); break;
+        case 'f': blockFrames = strtoul(optarg, NULL, 0); break;
+        case 'g': groupFrames = strtoul(optarg, NULL, 0); break;
+        case 't': seconds = strtoul(optarg, NULL, 0); break;
+        default:
+            printf("Usage: %s [-r sample_rate] [-c channels] [-f frames_per_block] [-g frames_per_group]\n"
+                   "          [-t seconds]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (sampleRate == 0 || channels == 0 || channels > BFP_MAX_CHANNELS || groupFrames < BFP_MIN_GROUP ||
+        groupFrames > BFP_MAX_GROUP || blockFrames <= groupFrames || seconds == 0) {
+        return 2;
+    }
+    int failures = 0;
+
+    double bytesPerSample = (double)bfp_packed_bytes(channels, blockFrames, groupFrames) / blockFrames / channels;
+    printf("%u channels, %u frames per block, %u per group: %.3f bytes per sample (%.1f%% of 24-bit)\n\n",
+           (unsigned)channels, (unsigned)blockFrames, (unsigned)groupFrames, bytesPerSample, bytesPerSample / 3 * 100);
+
+    uint32_t frames = blockFrames * 64;
+    failures += !check_bounds(channels, frames, groupFrames);
+    failures += !check_consistency(channels, blockFrames, groupFrames, sampleRate);
+    failures += !check_dynamic_range(sampleRate, channels, sampleRate, groupFrames);
+
+    // 吞吐量：1秒音乐般的电平变化（每组随机电平），按块打包/还原
+    frames = sampleRate / blockFrames * blockFrames;
+    size_t count = (size_t)frames * channels;
+    int32_t *x = malloc(count * sizeof(int32_t));
+    int32_t *wide = malloc(count * sizeof(int32_t));
+    uint8_t *packed24 = malloc(count * 3);
+    size_t blockBytes = bfp_packed_bytes(channels, blockFrames, groupFrames);
+    uint8_t *packed = malloc(blockBytes * (frames / blockFrames));
+    if (x == NULL || wide == NULL || packed24 == NULL || packed == NULL) {
+        return 1;
+    }
+    synthesize_groups(x, channels, frames, groupFrames);
+    store_s24(x, count, packed24);
+    for (size_t i = 0; i < count; i++) {
+        wide[i] = (int32_t)((uint32_t)x[i] << 8);
+    }
+    printf("\n");
+    for (uint32_t bytes = 3; bytes <= 4; bytes++) {
+        const uint8_t *in = (bytes == 3) ? packed24 : (const uint8_t *)wide;
+        double t0 = now_sec();
+        for (uint32_t s = 0; s < seconds; s++) {
+            for (uint32_t b = 0; b < frames / blockFrames; b++) {
+                bfp_pack(in + (size_t)b * blockFrames * channels * bytes, bytes, channels, blockFrames, groupFrames,
+                         packed + b * blockBytes);
+            }
+        }
+        double rtf = (now_sec() - t0) / seconds;
+        printf("Pack %u-bit:       %8.2f ns/frame, %7.1f MB/s in, real-time factor %.4f (host)\n",
+               (unsigned)bytes * 8, rtf * 1e9 / frames, (double)count * bytes / rtf / 1e6, rtf);
+    }
+    double t0 = now_sec();
+    for (uint32_t s = 0; s < seconds; s++) {
+        for (uint32_t b = 0; b < frames / blockFrames; b++) {
+            bfp_unpack(packed + b * blockBytes, channels, blockFrames, groupFrames, x + (size_t)b * blockFrames * channels,
+                       NULL);
+        }
+    }
+    double rtf = (now_sec() - t0) / seconds;
+    printf("Unpack:            %8.2f ns/frame, %7.1f MB/s out (host)\n", rtf * 1e9 / frames,
+           (double)count * 4 / rtf / 1e6);
+
+    free(x);
+    free(wide);
+    free(packed24);
+    free(packed);
+    if (failures != 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,338 @@
+// 块索引检查工具：读取录音旁边的.IDX文件，报告因SD卡停顿/I2S溢出丢失的样本，
+// 以及标记为损坏（零拷贝模式下写出过程中被DMA覆盖）的块，
+// 并可以把交织PCM的WAV录音按样本序号补零（损坏的块同样置零），使其与其他传感器在时间上对齐。
+//
+// 用法见 block_index --help。索引按1MB整段顺序读取，补零输出也按大块拷贝，速度受限于磁盘。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "BlockIndex.h"
+#include "WavFormat.h"
+
+#define READ_CHUNK  (1024 * 1024)
+
+typedef struct {
+    BlockIndexInfo info;
+    BlockIndexRecord *records;
+    size_t count;
+    uint64_t audioBytes;        // 录音文件长度
+    uint64_t skippedBlocks;     // 序号跳过的块（写卡失败等原因没有写出）
+    uint64_t repairedGaps;      // 丢失帧数少于首样本序号之差、按后者修正的记录
+    const char *stopReason;     // 索引提前结束的原因，NULL表示完整
+} IndexScan;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t file_size(const char *path) {
+    struct stat st;
+    return (stat(path, &st) == 0) ? (uint64_t)st.st_size : 0;
+}
+
+// 由索引路径推导录音文件路径：依次尝试.WAV/.FLA/.PLN/.BFP
+static bool find_audio_file(const char *indexPath, char *out, size_t len) {
+    static const char *exts[] = { ".WAV", ".FLA", ".PLN", ".BFP" };
+    const char *dot = strrchr(indexPath, '.');
+    size_t base = dot ? (size_t)(dot - indexPath) : strlen(indexPath);
+    for (size_t i = 0; i < sizeof(exts) / sizeof(exts[0]); i++) {
+        snprintf(out, len, "%.*s%s", (int)base, indexPath, exts[i]);
+        struct stat st;
+        if (stat(out, &st) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 顺序读取全部记录；在序号倒退、偏移倒退或超出录音文件处停止（断电后的残留数据）。
+// 较早的固件没有把写卡失败的块计入下一条记录的丢失帧数：按首样本序号之差补上
+static bool scan_index(const char *path, uint64_t audioBytes, IndexScan *scan) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+    uint8_t *buf = malloc(READ_CHUNK);
+    size_t got = fread(buf, 1, BLOCK_INDEX_HEADER_BYTES, f);
+    if (got != BLOCK_INDEX_HEADER_BYTES || !block_index_parse_header(buf, got, &scan->info)) {
+        fprintf(stderr, "%s is not a block index\n", path);
+        free(buf);
+        fclose(f);
+        return false;
+    }
+
+    size_t capacity = 4096;
+    scan->records = malloc(capacity * sizeof(BlockIndexRecord));
+    scan->count = 0;
+    scan->audioBytes = audioBytes;
+    scan->stopReason = NULL;
+    scan->skippedBlocks = 0;
+    scan->repairedGaps = 0;
+    uint64_t prevOffset = 0;
+    uint32_t nextSeq = 0;
+
+    while (scan->stopReason == NULL && (got = fread(buf, 1, READ_CHUNK, f)) >= BLOCK_INDEX_RECORD_BYTES) {
+        for (size_t pos = 0; pos + BLOCK_INDEX_RECORD_BYTES <= got; pos += BLOCK_INDEX_RECORD_BYTES) {
+            BlockIndexRecord r;
+            block_index_decode(buf + pos, &r);
+            if (r.seq < nextSeq) {
+                // 序号只会因某块没有写出而跳过，不会倒退
+                scan->stopReason = "sequence restarts";
+            } else if (r.offset < prevOffset || (audioBytes != 0 && r.offset >= audioBytes)) {
+                scan->stopReason = "offset outside the recording";
+            } else if (scan->count > 0 && r.firstSample < scan->records[scan->count - 1].firstSample) {
+                scan->stopReason = "sample index goes backwards";
+            }
+            if (scan->stopReason != NULL) {
+                break;
+            }
+            if (scan->count > 0) {
+                uint64_t end = scan->records[scan->count - 1].firstSample + scan->info.blockFrames;
+                uint64_t gap = (r.firstSample > end) ? r.firstSample - end : 0;
+                if (gap > r.droppedFrames) {
+                    r.droppedFrames = (gap > UINT32_MAX) ? UINT32_MAX : (uint32_t)gap;
+                    scan->repairedGaps++;
+                }
+            }
+            scan->skippedBlocks += r.seq - nextSeq;
+            nextSeq = r.seq + 1;
+            if (scan->count == capacity) {
+                capacity *= 2;
+                scan->records = realloc(scan->records, capacity * sizeof(BlockIndexRecord));
+            }
+            scan->records[scan->count++] = r;
+            prevOffset = r.offset;
+        }
+    }
+    free(buf);
+    fclose(f);
+    return true;
+}
+
+// 第i块在录音文件中的长度
+static uint64_t record_length(const IndexScan *scan, size_t i) {
+    uint64_t end = (i + 1 < scan->count) ? scan->records[i + 1].offset : scan->audioBytes;
+    return end - scan->records[i].offset;
+}
+
+static void report(const IndexScan *scan, bool listGaps) {
+    const BlockIndexInfo *info = &scan->info;
+    uint64_t missing = 0, gaps = 0, maxGap = 0, corrupt = 0;
+
+    for (size_t i = 0; i < scan->count; i++) {
+        const BlockIndexRecord *r = &scan->records[i];
+        if (r->corrupt) {
+            corrupt++;
+            if (listGaps) {
+                printf("block %u corrupt: sample %llu (t=%.6f s)\n", (unsigned)r->seq,
+                       (unsigned long long)r->firstSample, (double)r->firstSample / info->sampleRate);
+            }
+        }
+        if (r->droppedFrames == 0) {
+            continue;
+        }
+        gaps++;
+        missing += r->droppedFrames;
+        if (r->droppedFrames > maxGap) {
+            maxGap = r->droppedFrames;
+        }
+        if (listGaps) {
+            printf("gap before block %u: %u frames (%.3f ms) at sample %llu (t=%.6f s)\n", (unsigned)r->seq,
+                   (unsigned)r->droppedFrames, r->droppedFrames * 1000.0 / info->sampleRate,
+                   (unsigned long long)(r->firstSample - r->droppedFrames),
+                   (double)(r->firstSample - r->droppedFrames) / info->sampleRate);
+        }
+    }
+
+    // 轮转出的文件沿用录音的样本序号，时间线从第一块（含它之前的缺口）开始
+    uint64_t span = 0, origin = 0;
+    if (scan->count > 0) {
+        origin = scan->records[0].firstSample - scan->records[0].droppedFrames;
+        span = scan->records[scan->count - 1].firstSample + info->blockFrames - origin;
+    }
+    printf("Format: %u Hz, %u channels, %u-bit, %u frames per block\n", (unsigned)info->sampleRate,
+           (unsigned)info->channels, (unsigned)info->bitsPerSample, (unsigned)info->blockFrames);
+    printf("Blocks: %zu, timeline %llu frames (%.3f s)\n", scan->count, (unsigned long long)span,
+           (double)span / info->sampleRate);
+    if (origin > 0) {
+        printf("Continues a rotated recording at sample %llu (t=%.6f s)\n", (unsigned long long)origin,
+               (double)origin / info->sampleRate);
+    }
+    printf("Gaps: %llu, missing %llu frames (%.3f ms), largest %llu frames\n", (unsigned long long)gaps,
+           (unsigned long long)missing, missing * 1000.0 / info->sampleRate, (unsigned long long)maxGap);
+    if (scan->skippedBlocks > 0) {
+        printf("Blocks not written: %llu (skipped sequence numbers)\n", (unsigned long long)scan->skippedBlocks);
+    }
+    if (scan->repairedGaps > 0) {
+        printf("Gaps taken from the sample index: %llu (not counted as dropped by the recorder)\n",
+               (unsigned long long)scan->repairedGaps);
+    }
+    if (corrupt > 0) {
+        printf("Corrupt blocks: %llu (overwritten while being written)\n", (unsigned long long)corrupt);
+    }
+
+    // 样本时钟与esp_timer的对比：首尾两块的样本间隔与读出时间间隔之比
+    if (scan->count >= 2) {
+        const BlockIndexRecord *first = &scan->records[0];
+        const BlockIndexRecord *last = &scan->records[scan->count - 1];
+        double sampleSec = (double)(last->firstSample - first->firstSample) / info->sampleRate;
+        double timerSec = (double)(last->captureUs - first->captureUs) / 1e6;
+        if (timerSec > 0) {
+            printf("Sample clock vs timer: %+.1f ppm over %.3f s\n", (sampleSec / timerSec - 1.0) * 1e6, timerSec);
+        }
+    }
+    if (scan->stopReason != NULL) {
+        printf("Index ends early after block %zu: %s\n", scan->count, scan->stopReason);
+    }
+}
+
+static bool write_zeros(FILE *out, const uint8_t *zeros, uint64_t bytes) {
+    while (bytes > 0) {
+        size_t n = (bytes > READ_CHUNK) ? READ_CHUNK : (size_t)bytes;
+        if (fwrite(zeros, 1, n, out) != n) {
+            return false;
+        }
+        bytes -= n;
+    }
+    return true;
+}
+
+// 按样本序号补零输出交织PCM的WAV文件
+static bool zero_fill(const IndexScan *scan, const char *audioPath, const char *outPath) {
+    FILE *in = fopen(audioPath, "rb");
+    if (in == NULL) {
+        fprintf(stderr, "Cannot open %s\n", audioPath);
+        return false;
+    }
+    uint8_t header[WAV_HEADER_BYTES];
+    WavInfo wav;
+    if (fread(header, 1, sizeof(header), in) != sizeof(header) || !wav_parse_header(header, sizeof(header), &wav)) {
+        fprintf(stderr, "%s is not a WAV recording; zero-fill supports interleaved PCM only\n", audioPath);
+        fclose(in);
+        return false;
+    }
+    uint32_t frameBytes = wav_block_align(&wav.format);
+
+    // 先算出输出长度，头部一次写对
+    uint64_t total = 0;
+    for (size_t i = 0; i < scan->count; i++) {
+        total += (uint64_t)scan->records[i].droppedFrames * frameBytes;
+        total += record_length(scan, i) / frameBytes * frameBytes;
+    }
+
+    FILE *out = fopen(outPath, "wb");
+    if (out == NULL) {
+        fprintf(stderr, "Cannot create %s\n", outPath);
+        fclose(in);
+        return false;
+    }
+    wav_build_header(header, &wav.format, total);
+    fwrite(header, 1, sizeof(header), out);
+
+    uint8_t *buf = calloc(1, READ_CHUNK);
+    uint8_t *zeros = calloc(1, READ_CHUNK);
+    bool ok = true;
+    for (size_t i = 0; i < scan->count && ok; i++) {
+        ok = write_zeros(out, zeros, (uint64_t)scan->records[i].droppedFrames * frameBytes);
+        uint64_t len = record_length(scan, i) / frameBytes * frameBytes;
+        if (scan->records[i].corrupt) {
+            ok = ok && write_zeros(out, zeros, len);     // 损坏的块保留位置，内容置零
+            continue;
+        }
+        fseek(in, (long)scan->records[i].offset, SEEK_SET);
+        while (len > 0 && ok) {
+            size_t n = (len > READ_CHUNK) ? READ_CHUNK : (size_t)len;
+            ok = fread(buf, 1, n, in) == n && fwrite(buf, 1, n, out) == n;
+            len -= n;
+        }
+    }
+    free(buf);
+    free(zeros);
+    fclose(in);
+    if (fclose(out) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "I/O error while writing %s\n", outPath);
+        return false;
+    }
+    printf("Wrote %s (%llu frames, gaps and corrupt blocks zero-filled)\n", outPath,
+           (unsigned long long)(total / frameBytes));
+    return true;
+}
+
+static void usage(const char *prog) {
+    printf("Usage: %s [options] AUDIOX.IDX\n"
+           "  -a, --audio PATH       recording (default: same name with .WAV/.FLA/.PLN/.BFP)\n"
+           "  -f, --fill PATH        write a gap-free copy of a PCM WAV recording, gaps zero-filled\n"
+           "  -q, --quiet            summary only, do not list every gap\n",
+           prog);
+}
+
+int main(int argc, char **argv) {
+    static const struct option longOpts[] = {
+        { "audio", required_argument, NULL, 'a' },
+        { "fill", required_argument, NULL, 'f' },
+        { "quiet", no_argument, NULL, 'q' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    const char *audioArg = NULL;
+    const char *fillPath = NULL;
+    bool quiet = false;
+    int c;
+    while ((c = getopt_long(argc, argv, "a:f:qh", longOpts, NULL)) != -1) {
+        switch (c) {
+        case 'a': audioArg = optarg; break;
+        case 'f': fillPath = optarg; break;
+        case 'q': quiet = true; break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 2;
+    }
+    const char *indexPath = argv[optind];
+
+    char audioPath[512] = { 0 };
+    if (audioArg != NULL) {
+        snprintf(audioPath, sizeof(audioPath), "%s", audioArg);
+    } else if (!find_audio_file(indexPath, audioPath, sizeof(audioPath))) {
+        audioPath[0] = '\0';
+        if (fillPath != NULL) {
+            fprintf(stderr, "No recording found next to %s\n", indexPath);
+            return 2;
+        }
+    }
+
+    double start = now_sec();
+    IndexScan scan;
+    if (!scan_index(indexPath, audioPath[0] ? file_size(audioPath) : 0, &scan)) {
+        return 1;
+    }
+    double elapsed = now_sec() - start;
+
+    if (audioPath[0]) {
+        printf("Recording: %s (%llu bytes)\n", audioPath, (unsigned long long)scan.audioBytes);
+    }
+    report(&scan, !quiet);
+    uint64_t indexBytes = BLOCK_INDEX_HEADER_BYTES + (uint64_t)scan.count * BLOCK_INDEX_RECORD_BYTES;
+    printf("Scanned %llu index bytes in %.3f ms\n", (unsigned long long)indexBytes, elapsed * 1000);
+
+    bool ok = true;
+    if (fillPath != NULL) {
+        ok = zero_fill(&scan, audioPath, fillPath);
+    }
+    free(scan.records);
+    return ok ? 0 : 1;
+}
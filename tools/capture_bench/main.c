@@ -0,0 +1,1539 @@
+// 主机上的采集链路基准：用合成TDM源以1x~50x实时速度驱动真实的CapturePipeline
+// （采集任务、处理任务、文件任务、RecordWriter和恢复日志），报告持续吞吐量、丢块数、
+// 每个阶段边界的延迟百分位数和背压次数。任务的核心和优先级与设备相同（AudioCapture.h），
+// 主机有两个以上CPU且有实时调度权限时，同一核心上的任务按优先级互相抢占。
+//
+// 用法见 capture_bench --help。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <math.h>
+#include <sys/stat.h>
+#include "CapturePipeline.h"
+#include "CaptureSimSource.h"
+#include "FlacDecoder.h"
+
+#define BENCH_SLOTS     CAPTURE_TDM_SLOTS
+#define BENCH_DOA_MAX_RATE_HZ   50
+#define BENCH_FEATURE_MIN_MS    20
+#define BENCH_FEATURE_MAX_MS    10000
+#define BENCH_FEATURE_BANDS     32
+
+typedef struct {
+    CaptureProfile profile;
+    audio_codec_t codec;
+    audio_layout_t layout;
+    uint32_t channelMask;
+    uint32_t speed;
+    uint32_t seconds;
+    uint32_t writeDelayUs;      // 每次写入附加的延迟，模拟慢卡
+    uint32_t stallMs;           // 每stallEvery次写入附加一次停顿，模拟SD卡内部整理
+    uint32_t stallEvery;
+    uint32_t failEvery;         // 录音文件每failEvery次数据写入失败一次，0表示不注入
+    uint32_t dmaDesc;           // 模拟的DMA描述符数量，0表示按采集配置
+    uint32_t spillMs;           // PSRAM溢出环要承受的写卡停顿，0表示不使用溢出环
+    uint32_t psramMb;           // 模拟的PSRAM大小
+    const char *replayPath;     // 回放的写卡延迟记录
+    const char *recordPath;     // 记录本次运行的写卡延迟
+    uint32_t burstPeriodMs;     // 事件录音：突发周期，0表示连续录音
+    uint32_t burstMs;           // 每个周期末尾的突发长度
+    uint32_t preRollMs;
+    uint32_t postRollMs;
+    uint32_t rotateMs;          // 文件轮转：墙钟时长上限，0表示不按时间轮转
+    uint32_t rotateMb;          // 文件轮转：大小上限，0表示不按大小轮转
+    uint32_t processUs;         // 处理阶段每块附加的CPU时间，0表示不附加
+    uint32_t radioLoadPct;      // 核心0上模拟无线协议栈的CPU占用，0表示不模拟
+    uint32_t radioPriority;
+    uint32_t filePriority;
+    double syncPpm;             // 多板同步：模拟的采样时钟偏差
+    uint32_t syncPeriodMs;      // 参考脉冲周期，0表示不模拟同步
+    uint32_t beams;             // 波束数（均匀分布在水平面上），0表示不做波束形成
+    audio_beam_output_t beamOutput;
+    uint32_t doaRateHz;         // 声源方位估计的输出速率，0表示不估计
+    DecimatorConfig rates;      // 多采样率输出
+    uint32_t featureMs;         // 声学特征的记录周期，0表示不计算
+    const char *dir;
+} BenchOptions;
+
+// 写卡延迟记录：每行一次写入，"字节数 延迟us"（只有一列时为延迟），#开头为注释
+typedef struct {
+    uint32_t *latencyUs;
+    uint32_t *bytes;
+    size_t count;
+    size_t capacity;
+} LatencyTrace;
+
+#define TRACE_MAX_RECORD  (1024 * 1024)
+
+// 慢速存储后端：包装平台默认后端，在写入前附加延迟
+static const RecordBackend *baseBackend;
+static BenchOptions opts;
+static uint32_t writeCount;
+static LatencyTrace replayTrace;
+static LatencyTrace recordTrace;
+static const char *failExt;         // 录音文件的扩展名，只对这些文件注入写卡失败
+static void *failHandles[4];        // 打开的录音文件（轮转时同时有当前、下一个和正在关闭的文件）
+static uint32_t dataWrites;
+static uint32_t failedWrites;
+
+// 忙等us微秒（占用CPU，不让出）
+static void busy_us(uint32_t us) {
+    int64_t end = capture_os_now_us() + us;
+    while (capture_os_now_us() < end) {
+    }
+}
+
+// 处理阶段的附加负载：模拟每块的DSP处理
+static void bench_process_hook(void *ctx, uint8_t *data, size_t length, uint32_t frames) {
+    busy_us(opts.processUs);
+}
+
+// 核心0上的无线协议栈负载：每10ms忙radioLoadPct%
+static void radio_load_task(void *arg) {
+    uint32_t sleepMs = (100 - opts.radioLoadPct) / 10;
+    while (1) {
+        busy_us(opts.radioLoadPct * 100);
+        capture_os_delay_ms(sleepMs > 0 ? sleepMs : 1);
+    }
+}
+
+static void sleep_us(uint32_t us) {
+    struct timespec ts = { .tv_sec = us / 1000000, .tv_nsec = (long)(us % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+static void *slow_open(const char *path, uint64_t preallocBytes) {
+    void *handle = baseBackend->open(path, preallocBytes);
+    size_t len = strlen(path), extLen = (failExt != NULL) ? strlen(failExt) : 0;
+    if (handle != NULL && extLen != 0 && len >= extLen && strcmp(path + len - extLen, failExt) == 0) {
+        for (uint32_t i = 0; i < sizeof(failHandles) / sizeof(failHandles[0]); i++) {
+            if (failHandles[i] == NULL) {
+                failHandles[i] = handle;
+                break;
+            }
+        }
+    }
+    return handle;
+}
+
+// 是否对这次写入注入失败：只针对录音文件中超过一个扇区的写入（块数据），
+// 文件头和暂存区补齐的扇区照常写入，因此每个失败的写入正好对应一个没有写出的块
+static bool inject_failure(void *handle, size_t len) {
+    if (opts.failEvery == 0 || len <= RECORD_SECTOR_SIZE) {
+        return false;
+    }
+    for (uint32_t i = 0; i < sizeof(failHandles) / sizeof(failHandles[0]); i++) {
+        if (failHandles[i] == handle) {
+            return ++dataWrites % opts.failEvery == 0;
+        }
+    }
+    return false;
+}
+
+static bool slow_write(void *handle, const void *data, size_t len) {
+    writeCount++;
+    if (inject_failure(handle, len)) {
+        failedWrites++;
+        return false;
+    }
+    // 记录的延迟包括注入的延迟和停顿，因此-d/-s加-W可以生成合成的记录
+    int64_t start = capture_os_now_us();
+    if (replayTrace.count != 0) {
+        // 按记录循环回放；倍速运行时时间轴整体压缩，延迟也按倍数缩短
+        sleep_us(replayTrace.latencyUs[(writeCount - 1) % replayTrace.count] / opts.speed);
+    } else if (opts.stallEvery != 0 && writeCount % opts.stallEvery == 0) {
+        sleep_us(opts.stallMs * 1000);
+    } else if (opts.writeDelayUs != 0) {
+        sleep_us(opts.writeDelayUs);
+    }
+    bool ok = baseBackend->write(handle, data, len);
+    if (recordTrace.latencyUs != NULL && recordTrace.count < recordTrace.capacity) {
+        recordTrace.latencyUs[recordTrace.count] = (uint32_t)(capture_os_now_us() - start);
+        recordTrace.bytes[recordTrace.count] = (uint32_t)len;
+        recordTrace.count++;
+    }
+    return ok;
+}
+
+static bool slow_write_at(void *handle, uint64_t offset, const void *data, size_t len) {
+    return baseBackend->write_at(handle, offset, data, len);
+}
+
+static bool slow_sync(void *handle) {
+    return baseBackend->sync(handle);
+}
+
+static bool slow_close(void *handle, uint64_t finalSize) {
+    for (uint32_t i = 0; i < sizeof(failHandles) / sizeof(failHandles[0]); i++) {
+        failHandles[i] = (failHandles[i] == handle) ? NULL : failHandles[i];
+    }
+    return baseBackend->close(handle, finalSize);
+}
+
+static bool slow_remove(const char *path) {
+    return baseBackend->remove(path);
+}
+
+static const RecordBackend slowBackend = {
+    .open = slow_open,
+    .write = slow_write,
+    .write_at = slow_write_at,
+    .sync = slow_sync,
+    .close = slow_close,
+    .remove = slow_remove,
+};
+
+static bool load_trace(const char *path, LatencyTrace *trace) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        printf("Cannot open %s\n", path);
+        return false;
+    }
+    char line[128];
+    while (fgets(line, sizeof(line), f) != NULL) {
+        unsigned long a, b;
+        int n = sscanf(line, "%lu %lu", &a, &b);
+        if (line[0] == '#' || n < 1) {
+            continue;
+        }
+        if (trace->count == trace->capacity) {
+            trace->capacity = trace->capacity ? trace->capacity * 2 : 4096;
+            trace->latencyUs = realloc(trace->latencyUs, trace->capacity * sizeof(uint32_t));
+        }
+        trace->latencyUs[trace->count++] = (uint32_t)((n == 2) ? b : a);
+    }
+    fclose(f);
+    if (trace->count == 0) {
+        printf("No write latencies in %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+// 记录的开头注明命令行和写入的目录，回放时能看出延迟来自哪种存储
+static bool save_trace(const char *path, const LatencyTrace *trace, int argc, char **argv) {
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        printf("Cannot create %s\n", path);
+        return false;
+    }
+    fprintf(f, "# capture_bench write latency trace: bytes latency_us\n#");
+    for (int i = 0; i < argc; i++) {
+        fprintf(f, " %s", argv[i]);
+    }
+    fprintf(f, "\n# written to %s\n", opts.dir);
+    for (size_t i = 0; i < trace->count; i++) {
+        fprintf(f, "%u %u\n", (unsigned)trace->bytes[i], (unsigned)trace->latencyUs[i]);
+    }
+    return fclose(f) == 0;
+}
+
+static void usage(const char *prog) {
+    printf("Usage: %s [options]\n"
+           "  -r, --rate HZ          sample rate (default 96000)\n"
+           "  -b, --bits N           bits per sample: 16, 24 or 32 (default 16)\n"
+           "  -x, --speed N          real-time multiple, 1..%d (default 1)\n"
+           "  -t, --seconds N        wall-clock run time (default 10)\n"
+           "  -c, --codec NAME       pcm, flac or bfp (default pcm)\n"
+           "  -l, --layout NAME      interleaved or planar (default interleaved)\n"
+           "  -m, --mask HEX         channel mask (default 0xff)\n"
+           "  -d, --write-delay-us N extra latency per storage write\n"
+           "  -s, --stall MS/EVERY   stall MS milliseconds every EVERY writes\n"
+           "  -f, --fail-every N     fail every Nth block write to an uncompressed recording (N >= 2)\n"
+           "  -q, --dma-desc N       simulated DMA descriptors (default: from the profile)\n"
+           "  -S, --spill-ms MS      write stall the PSRAM spill ring should absorb, 0 = off (default 2000)\n"
+           "  -P, --psram-mb N       simulated PSRAM size (default 8)\n"
+           "  -L, --replay FILE      replay a write latency trace (looped, scaled by the speed)\n"
+           "  -W, --record FILE      record the write latency of every storage write to FILE (including -d and -s)\n"
+           "  -e, --events MS/LEN    event capture: slots 2+ burst for LEN ms at the end of every MS ms\n"
+           "  -p, --roll PRE/POST    event pre-roll and post-roll in ms (default 2000/1000)\n"
+           "  -R, --rotate-ms MS     rotate files every MS ms of wall-clock time\n"
+           "  -M, --rotate-mb N      rotate files once they exceed N MB\n"
+           "  -C, --process-us N     extra CPU time per block in the processing stage (enables the stage)\n"
+           "  -w, --radio PCT[@PRIO] busy PCT%% of core 0 at priority PRIO (default 20) like the Wi-Fi/BT stacks\n"
+           "  -F, --file-prio N      file task priority (default 21, as on the device)\n"
+           "  -y, --sync PPM[@MS]    sync pulses every MS ms (default 1000), sample clock off by PPM\n"
+           "  -B, --beams N[/raw]    record N beams from a 40 mm circular array instead of the microphones,\n"
+           "                         or with /raw next to them in a .BMF file\n"
+           "  -D, --doa HZ           estimate source bearings HZ times a second into a .DOA file\n"
+           "  -A, --rates R[/R...]   decimate to up to 3 extra rates in Hz, each into a .Rkk file\n"
+           "  -E, --features MS      write levels, zero-crossing rate and 32 band energies every MS ms to a .FEA file\n"
+           "  -o, --dir PATH         output directory (default /tmp/capture_bench)\n"
+           "  -v, --verbose          pipeline info logs\n",
+           prog, CAPTURE_SIM_MAX_SPEED);
+}
+
+static bool parse_options(int argc, char **argv) {
+    static const struct option longOpts[] = {
+        { "rate", required_argument, NULL, 'r' },
+        { "bits", required_argument, NULL, 'b' },
+        { "speed", required_argument, NULL, 'x' },
+        { "seconds", required_argument, NULL, 't' },
+        { "codec", required_argument, NULL, 'c' },
+        { "layout", required_argument, NULL, 'l' },
+        { "mask", required_argument, NULL, 'm' },
+        { "write-delay-us", required_argument, NULL, 'd' },
+        { "stall", required_argument, NULL, 's' },
+        { "fail-every", required_argument, NULL, 'f' },
+        { "dma-desc", required_argument, NULL, 'q' },
+        { "spill-ms", required_argument, NULL, 'S' },
+        { "psram-mb", required_argument, NULL, 'P' },
+        { "replay", required_argument, NULL, 'L' },
+        { "record", required_argument, NULL, 'W' },
+        { "events", required_argument, NULL, 'e' },
+        { "roll", required_argument, NULL, 'p' },
+        { "rotate-ms", required_argument, NULL, 'R' },
+        { "rotate-mb", required_argument, NULL, 'M' },
+        { "process-us", required_argument, NULL, 'C' },
+        { "radio", required_argument, NULL, 'w' },
+        { "file-prio", required_argument, NULL, 'F' },
+        { "sync", required_argument, NULL, 'y' },
+        { "beams", required_argument, NULL, 'B' },
+        { "doa", required_argument, NULL, 'D' },
+        { "rates", required_argument, NULL, 'A' },
+        { "features", required_argument, NULL, 'E' },
+        { "dir", required_argument, NULL, 'o' },
+        { "verbose", no_argument, NULL, 'v' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+
+    opts = (BenchOptions){
+        .profile = { .sampleRate = 96000, .bitsPerSample = 16, .decimation = 0 },
+        .codec = AUDIO_CODEC_PCM,
+        .layout = AUDIO_LAYOUT_INTERLEAVED,
+        .channelMask = (1u << BENCH_SLOTS) - 1,
+        .speed = 1,
+        .seconds = 10,
+        .spillMs = 2000,
+        .psramMb = 8,
+        .preRollMs = 2000,
+        .postRollMs = 1000,
+        .radioPriority = 20,
+        .filePriority = 21,
+        .dir = "/tmp/capture_bench",
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "r:b:x:t:c:l:m:d:s:f:q:S:P:L:W:e:p:R:M:C:w:F:y:B:D:A:E:o:vh", longOpts, NULL)) != -1) {
+        switch (c) {
+        case 'r': opts.profile.sampleRate = strtoul(optarg, NULL, 0); break;
+        case 'b': opts.profile.bitsPerSample = (uint8_t)strtoul(optarg, NULL, 0); break;
+        case 'x': opts.speed = strtoul(optarg, NULL, 0); break;
+        case 't': opts.seconds = strtoul(optarg, NULL, 0); break;
+        case 'm': opts.channelMask = strtoul(optarg, NULL, 16); break;
+        case 'd': opts.writeDelayUs = strtoul(optarg, NULL, 0); break;
+        case 'f': opts.failEvery = strtoul(optarg, NULL, 0); break;
+        case 'q': opts.dmaDesc = strtoul(optarg, NULL, 0); break;
+        case 'S': opts.spillMs = strtoul(optarg, NULL, 0); break;
+        case 'P': opts.psramMb = strtoul(optarg, NULL, 0); break;
+        case 'L': opts.replayPath = optarg; break;
+        case 'W': opts.recordPath = optarg; break;
+        case 'R': opts.rotateMs = strtoul(optarg, NULL, 0); break;
+        case 'M': opts.rotateMb = strtoul(optarg, NULL, 0); break;
+        case 'C': opts.processUs = strtoul(optarg, NULL, 0); break;
+        case 'F': opts.filePriority = strtoul(optarg, NULL, 0); break;
+        case 'o': opts.dir = optarg; break;
+        case 'v': capture_os_verbose = true; break;
+        case 'c':
+            if (strcmp(optarg, "pcm") == 0) {
+                opts.codec = AUDIO_CODEC_PCM;
+            } else if (strcmp(optarg, "flac") == 0) {
+                opts.codec = AUDIO_CODEC_FLAC;
+            } else if (strcmp(optarg, "bfp") == 0) {
+                opts.codec = AUDIO_CODEC_BFP;
+            } else {
+                printf("Unknown codec: %s\n", optarg);
+                return false;
+            }
+            break;
+        case 'l':
+            if (strcmp(optarg, "interleaved") == 0) {
+                opts.layout = AUDIO_LAYOUT_INTERLEAVED;
+            } else if (strcmp(optarg, "planar") == 0) {
+                opts.layout = AUDIO_LAYOUT_PLANAR;
+            } else {
+                printf("Unknown layout: %s\n", optarg);
+                return false;
+            }
+            break;
+        case 's':
+            if (sscanf(optarg, "%u/%u", &opts.stallMs, &opts.stallEvery) != 2 || opts.stallEvery == 0) {
+                printf("Invalid stall: %s (expected MS/EVERY)\n", optarg);
+                return false;
+            }
+            break;
+        case 'e':
+            if (sscanf(optarg, "%u/%u", &opts.burstPeriodMs, &opts.burstMs) != 2 || opts.burstPeriodMs == 0 ||
+                opts.burstMs == 0 || opts.burstMs >= opts.burstPeriodMs) {
+                printf("Invalid events: %s (expected MS/LEN with 0 < LEN < MS)\n", optarg);
+                return false;
+            }
+            break;
+        case 'w':
+            if (sscanf(optarg, "%u@%u", &opts.radioLoadPct, &opts.radioPriority) < 1 || opts.radioLoadPct >= 100) {
+                printf("Invalid radio load: %s (expected PCT[@PRIO] with PCT < 100)\n", optarg);
+                return false;
+            }
+            break;
+        case 'y':
+            opts.syncPeriodMs = 1000;
+            if (sscanf(optarg, "%lf@%u", &opts.syncPpm, &opts.syncPeriodMs) < 1 ||
+                opts.syncPeriodMs < SYNC_CLOCK_MIN_PERIOD_MS || opts.syncPeriodMs > SYNC_CLOCK_MAX_PERIOD_MS) {
+                printf("Invalid sync: %s (expected PPM[@MS] with %u <= MS <= %u)\n", optarg,
+                       SYNC_CLOCK_MIN_PERIOD_MS, SYNC_CLOCK_MAX_PERIOD_MS);
+                return false;
+            }
+            break;
+        case 'B': {
+            char raw[8] = "";
+            if (sscanf(optarg, "%u/%7s", &opts.beams, raw) < 1 || opts.beams == 0 ||
+                opts.beams > BEAMFORMER_MAX_BEAMS || (raw[0] != '\0' && strcmp(raw, "raw") != 0)) {
+                printf("Invalid beams: %s (expected N[/raw] with 1 <= N <= %d)\n", optarg, BEAMFORMER_MAX_BEAMS);
+                return false;
+            }
+            opts.beamOutput = (raw[0] != '\0') ? AUDIO_BEAM_WITH_RAW : AUDIO_BEAM_ONLY;
+            break;
+        }
+        case 'D':
+            opts.doaRateHz = (uint32_t)strtoul(optarg, NULL, 10);
+            if (opts.doaRateHz == 0 || opts.doaRateHz > BENCH_DOA_MAX_RATE_HZ) {
+                printf("Invalid DOA rate: %s (expected 1..%d)\n", optarg, BENCH_DOA_MAX_RATE_HZ);
+                return false;
+            }
+            break;
+        case 'E':
+            opts.featureMs = (uint32_t)strtoul(optarg, NULL, 10);
+            if (opts.featureMs < BENCH_FEATURE_MIN_MS || opts.featureMs > BENCH_FEATURE_MAX_MS) {
+                printf("Invalid feature period: %s (expected %d..%d ms)\n", optarg, BENCH_FEATURE_MIN_MS,
+                       BENCH_FEATURE_MAX_MS);
+                return false;
+            }
+            break;
+        case 'A': {
+            char *arg = optarg, *end = NULL;
+            opts.rates.outputs = 0;
+            do {
+                unsigned long rate = strtoul(arg, &end, 10);
+                if (end == arg || rate < 1000 || opts.rates.outputs == DECIMATOR_MAX_OUTPUTS ||
+                    (*end != '\0' && *end != '/')) {
+                    printf("Invalid rates: %s (expected up to %d rates of 1000 Hz or more, R[/R...])\n", optarg,
+                           DECIMATOR_MAX_OUTPUTS);
+                    return false;
+                }
+                opts.rates.rateHz[opts.rates.outputs++] = (uint32_t)rate;
+                arg = end + 1;
+            } while (*end == '/');
+            break;
+        }
+        case 'p':
+            if (sscanf(optarg, "%u/%u", &opts.preRollMs, &opts.postRollMs) != 2) {
+                printf("Invalid roll: %s (expected PRE/POST)\n", optarg);
+                return false;
+            }
+            break;
+        default:
+            usage(argv[0]);
+            return false;
+        }
+    }
+    // 压缩的块与相邻的块共用扇区，写入失败时前一个扇区已经写出，注入的失败不再正好对应一块
+    if (opts.failEvery != 0 && (opts.failEvery < 2 || opts.codec != AUDIO_CODEC_PCM)) {
+        printf("Invalid fail-every: %u (needs N >= 2 and the pcm codec)\n", (unsigned)opts.failEvery);
+        return false;
+    }
+    if (opts.speed == 0 || opts.speed > CAPTURE_SIM_MAX_SPEED || opts.seconds == 0) {
+        usage(argv[0]);
+        return false;
+    }
+    return true;
+}
+
+// 帧序号连续性校验的累计结果（轮转时跨文件累计）
+typedef struct {
+    uint64_t expected;          // 下一帧应有的序号
+    uint64_t frames;
+    uint64_t gaps;
+    uint64_t missing;
+    uint64_t boundaryGaps;      // 出现在轮转边界（后一个文件开头）的缺口
+} VerifyState;
+
+// 读回交织PCM文件，按槽位0/1中的帧序号检查连续性，接着上一个文件的序号继续；返回是否能够校验
+static bool verify_wav(const char *path, const CaptureTiming *timing, VerifyState *v) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return false;
+    }
+    uint8_t header[WAV_HEADER_BYTES];
+    WavInfo info;
+    if (fread(header, 1, sizeof(header), f) != sizeof(header) || !wav_parse_header(header, sizeof(header), &info)) {
+        fclose(f);
+        return false;
+    }
+
+    uint32_t sampleBytes = timing->sampleBytes;
+    uint32_t frameBytes = timing->frameBytes;
+    uint32_t bits = sampleBytes * 8;
+    uint8_t *frame = malloc(frameBytes);
+    bool fileStart = v->frames > 0;
+    fseek(f, (long)info.dataOffset, SEEK_SET);
+    for (uint64_t n = 0; n < info.dataBytes / frameBytes && fread(frame, 1, frameBytes, f) == frameBytes; n++) {
+        uint64_t lo = 0, hi = 0;
+        for (uint32_t b = 0; b < sampleBytes; b++) {
+            lo |= (uint64_t)frame[b] << (8 * b);
+            hi |= (uint64_t)frame[sampleBytes + b] << (8 * b);
+        }
+        uint64_t seq = (bits >= 32) ? lo : ((hi << bits) | lo);
+        if (seq != v->expected) {
+            v->gaps++;
+            v->missing += (seq > v->expected) ? seq - v->expected : 0;
+            v->boundaryGaps += fileStart ? 1 : 0;
+        }
+        fileStart = false;
+        v->expected = seq + 1;
+        v->frames++;
+    }
+    free(frame);
+    fclose(f);
+    return true;
+}
+
+// 读回块索引（轮转时按顺序读所有文件）：每条记录的丢失帧数必须等于它与上一块末尾之间的样本数，
+// 索引中的块覆盖的帧数和丢失的帧数必须与从录音内容校验出的一致，没有写出的块也要计入缺口
+static bool verify_index(char paths[][CAPTURE_PIPELINE_PATH_MAX], uint32_t files, const CaptureTiming *timing,
+                         const VerifyState *v) {
+    uint64_t blocks = 0, missing = 0, end = 0, skipped = 0;
+    uint32_t wrong = 0;
+    for (uint32_t i = 0; i < files; i++) {
+        FILE *f = fopen(paths[i], "rb");
+        if (f == NULL) {
+            printf("Failed to read the block index %s\n", paths[i]);
+            return false;
+        }
+        uint8_t header[BLOCK_INDEX_HEADER_BYTES];
+        BlockIndexInfo info;
+        if (fread(header, 1, sizeof(header), f) != sizeof(header) ||
+            !block_index_parse_header(header, sizeof(header), &info) || info.blockFrames != timing->blockFrames) {
+            printf("Bad block index header in %s\n", paths[i]);
+            fclose(f);
+            return false;
+        }
+
+        uint8_t rec[BLOCK_INDEX_RECORD_BYTES];
+        uint32_t seq = 0;
+        while (fread(rec, 1, sizeof(rec), f) == sizeof(rec)) {
+            BlockIndexRecord r;
+            block_index_decode(rec, &r);
+            skipped += (r.seq > seq) ? r.seq - seq : 0;
+            bool consistent = r.seq >= seq && !r.corrupt && r.firstSample >= end &&
+                              r.droppedFrames == r.firstSample - end;
+            wrong += consistent ? 0 : 1;
+            seq = r.seq + 1;
+            missing += r.droppedFrames;
+            end = r.firstSample + info.blockFrames;
+            blocks++;
+        }
+        fclose(f);
+    }
+
+    uint64_t frames = blocks * timing->blockFrames;
+    bool ok = wrong == 0 && frames == v->frames && missing == v->missing;
+    printf("Index: %llu blocks (%llu frames), %llu skipped sequence numbers, %llu frames missing, "
+           "%u inconsistent records: %s\n", (unsigned long long)blocks, (unsigned long long)frames,
+           (unsigned long long)skipped, (unsigned long long)missing, (unsigned)wrong,
+           ok ? "matches the recording" : "MISMATCH");
+    return ok;
+}
+
+// 块浮点文件校验的累计结果（误差以每组的上界2^(e-1)为单位）
+typedef struct {
+    uint64_t groups;            // 组数 x 通道数
+    uint64_t lossless;          // 其中指数为0的
+    uint64_t exponentSum;
+    uint64_t bytes;
+    double worstError;          // 最大的 |误差| / 上界，不超过1
+} BfpVerifyStats;
+
+// 源在某帧某槽位的样本的高24位（有符号），即块浮点文件应还原出的值
+static int32_t sim_sample24(const CaptureSimSource *sim, uint64_t frame, uint32_t slot) {
+    uint32_t bits = sim->sampleBytes * 8;
+    uint32_t value;
+    if (slot < 2 || sim->burstPeriod == 0) {
+        value = capture_sim_sample(frame, (slot < 2) ? slot : 0, sim->sampleBytes);
+    } else {
+        value = capture_sim_in_burst(sim, frame) ? capture_sim_burst_sample(frame, sim->sampleBytes) : 0;
+    }
+    return (int32_t)(value << (32 - bits)) >> 8;
+}
+
+// 检查还原的一块是否是从frame开始的源帧（每个样本在所在组的误差上界内），stats非NULL时累计误差
+static bool bfp_block_matches(const CaptureSimSource *sim, const BfpFormat *format, const int32_t *decoded,
+                              const uint8_t *exponents, uint64_t frame, BfpVerifyStats *stats) {
+    for (uint32_t i = 0; i < format->blockFrames; i++) {
+        const uint8_t *e = exponents + (size_t)(i / format->groupFrames) * format->channels;
+        for (uint32_t ch = 0; ch < format->channels; ch++) {
+            int64_t error = llabs((int64_t)decoded[(size_t)i * format->channels + ch] -
+                                  sim_sample24(sim, frame + i, ch));
+            int64_t bound = (e[ch] == 0) ? 0 : (1 << (e[ch] - 1));
+            if (error > bound) {
+                return false;
+            }
+            if (stats != NULL && bound != 0 && (double)error / bound > stats->worstError) {
+                stats->worstError = (double)error / bound;
+            }
+        }
+    }
+    return true;
+}
+
+// 读回24位块浮点文件：逐块还原后与源的帧比较，接着上一个文件的帧序号继续；
+// 对不上时（缺口）由槽位1（高位，指数为0，无损）和槽位0（低24位）估计起始帧，在误差范围内搜索
+static bool verify_bfp(const char *path, const CaptureSimSource *sim, VerifyState *v, BfpVerifyStats *stats) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return false;
+    }
+    uint8_t header[BFP_HEADER_BYTES];
+    BfpFormat format;
+    if (fread(header, 1, sizeof(header), f) != sizeof(header) ||
+        !bfp_parse_header(header, sizeof(header), &format) || format.channels != sim->slots) {
+        fclose(f);
+        return false;
+    }
+
+    uint32_t blockBytes = bfp_block_bytes(&format);
+    uint32_t groups = (format.blockFrames + format.groupFrames - 1) / format.groupFrames;
+    uint8_t *block = malloc(blockBytes);
+    int32_t *decoded = malloc((size_t)format.blockFrames * format.channels * sizeof(int32_t));
+    uint8_t *exponents = malloc((size_t)groups * format.channels);
+    bool fileStart = v->frames > 0;
+    while (fread(block, 1, blockBytes, f) == blockBytes) {
+        bfp_unpack(block, format.channels, format.blockFrames, format.groupFrames, decoded, exponents);
+        uint64_t start = v->expected;
+        if (!bfp_block_matches(sim, &format, decoded, exponents, start, NULL)) {
+            uint64_t estimate = ((uint64_t)(uint32_t)decoded[1] << 24) | ((uint32_t)decoded[0] & 0xFFFFFF);
+            uint64_t radius = 1u << BFP_MAX_EXPONENT;
+            uint64_t lo = (estimate > radius) ? estimate - radius : 0;
+            start = UINT64_MAX;
+            for (uint64_t s = lo; s <= estimate + radius && start == UINT64_MAX; s++) {
+                start = bfp_block_matches(sim, &format, decoded, exponents, s, NULL) ? s : UINT64_MAX;
+            }
+            if (start == UINT64_MAX) {
+                printf("%s: block at byte %ld matches no source frames\n", path, ftell(f) - (long)blockBytes);
+                free(block);
+                free(decoded);
+                free(exponents);
+                fclose(f);
+                return false;
+            }
+            v->gaps++;
+            v->missing += (start > v->expected) ? start - v->expected : 0;
+            v->boundaryGaps += fileStart ? 1 : 0;
+        }
+        bfp_block_matches(sim, &format, decoded, exponents, start, stats);
+        for (size_t g = 0; g < (size_t)groups * format.channels; g++) {
+            stats->lossless += (exponents[g] == 0) ? 1 : 0;
+            stats->exponentSum += exponents[g];
+        }
+        stats->groups += (uint64_t)groups * format.channels;
+        stats->bytes += blockBytes;
+        fileStart = false;
+        v->expected = start + format.blockFrames;
+        v->frames += format.blockFrames;
+    }
+    free(block);
+    free(decoded);
+    free(exponents);
+    fclose(f);
+    return true;
+}
+
+// FLAC文件校验的累计结果
+typedef struct {
+    uint64_t frames;            // FLAC帧数
+    uint64_t bytes;             // 音频帧的字节数（不含文件头）
+    uint64_t samples;           // 解码的样本数（所有通道）
+    uint64_t mismatches;        // 与源不符的样本数
+    uint32_t subframes[4];      // CONSTANT / VERBATIM / FIXED / LPC
+} FlacVerifyStats;
+
+// 源在某帧某槽位的16位样本，即FLAC文件应解码出的值
+static int16_t sim_sample16(const CaptureSimSource *sim, uint64_t frame, uint32_t slot) {
+    if (slot < 2) {
+        return (int16_t)(uint16_t)(frame >> (16 * slot));
+    }
+    if (sim->burstPeriod == 0) {
+        return (int16_t)(uint16_t)capture_sim_sample(frame, 0, 2);
+    }
+    return capture_sim_in_burst(sim, frame) ? (int16_t)(uint16_t)capture_sim_burst_sample(frame, 2) : 0;
+}
+
+// 读回FLAC文件：逐帧解码（检查CRC和帧序号），每帧第一个样本的槽位0/1给出帧序号，
+// 帧内每个样本都要与源逐一相等；STREAMINFO的总样本数要等于解码出的样本数。
+// 接着上一个文件的帧序号继续；文件无法读取或码流错误时返回false
+static bool verify_flac(const char *path, const CaptureSimSource *sim, VerifyState *v, FlacVerifyStats *stats) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = (size > 0) ? malloc((size_t)size) : NULL;
+    bool ok = data != NULL && fread(data, 1, (size_t)size, f) == (size_t)size;
+    fclose(f);
+
+    FlacStreamHeader header;
+    if (!ok || !flac_parse_stream_header(data, (size_t)size, &header) || header.channels != sim->slots ||
+        header.bitsPerSample != 16) {
+        free(data);
+        return false;
+    }
+
+    size_t capacity = (size_t)header.maxBlockSize * header.channels;
+    int16_t *decoded = malloc(capacity * sizeof(int16_t));
+    uint64_t fileSamples = 0;
+    bool fileStart = v->frames > 0;
+    size_t offset = header.audioOffset;
+    for (uint64_t n = 0; offset < (size_t)size; n++) {
+        FlacFrameInfo frame;
+        size_t len = flac_decode_frame(&header, data + offset, (size_t)size - offset, decoded, capacity, &frame);
+        if (len == 0 || frame.number != n) {
+            printf("%s: %s at byte %zu\n", path, (len == 0) ? "undecodable FLAC frame" : "out-of-order frame number",
+                   offset);
+            ok = false;
+            break;
+        }
+        uint64_t start = ((uint64_t)(uint16_t)decoded[1] << 16) | (uint16_t)decoded[0];
+        if (start != v->expected) {
+            v->gaps++;
+            v->missing += (start > v->expected) ? start - v->expected : 0;
+            v->boundaryGaps += fileStart ? 1 : 0;
+        }
+        for (uint32_t i = 0; i < frame.samples; i++) {
+            for (uint32_t ch = 0; ch < header.channels; ch++) {
+                stats->mismatches += (decoded[(size_t)i * header.channels + ch] != sim_sample16(sim, start + i, ch));
+            }
+        }
+        for (int t = 0; t < 4; t++) {
+            stats->subframes[t] += frame.subframes[t];
+        }
+        stats->frames++;
+        stats->bytes += len;
+        stats->samples += (uint64_t)frame.samples * header.channels;
+        fileStart = false;
+        v->expected = start + frame.samples;
+        v->frames += frame.samples;
+        fileSamples += frame.samples;
+        offset += len;
+    }
+    if (ok && header.stream.totalSamples != fileSamples) {
+        printf("%s: STREAMINFO has %llu samples, the file has %llu\n", path,
+               (unsigned long long)header.stream.totalSamples, (unsigned long long)fileSamples);
+        ok = false;
+    }
+    free(decoded);
+    free(data);
+    return ok;
+}
+
+// 读回事件索引（轮转时按顺序读所有文件），检查每个事件的触发块是否正好是某个突发开始的那一块、
+// 预录是否完整，事件覆盖的帧数是否等于提交的块（事件模式只提交事件内的块）。
+// 跨越轮转边界的事件在后一个文件中从开头继续（EVENT_INDEX_CONTINUED），它的startSample等于前一段的endSample。
+// 录音内容校验过时（verify不为NULL），录音中的缺口必须正好是事件之间的间隔，注入的写卡失败各多丢一块。
+// 样本序号从录音的第一帧算起，源的帧序号要加上firstFrame（同步时开始录音前清空了已产生的帧）；
+// producedFrames是源的下一个帧序号。任何一项不符时返回false
+static bool verify_events(char paths[][CAPTURE_PIPELINE_PATH_MAX], uint32_t files, const CaptureTiming *timing,
+                          uint32_t preRollBlocks, uint64_t producedFrames, uint64_t firstFrame,
+                          uint64_t committedFrames, const VerifyState *verify) {
+    uint64_t period = (uint64_t)opts.burstPeriodMs * opts.profile.sampleRate / 1000;
+    uint64_t burst = (uint64_t)opts.burstMs * opts.profile.sampleRate / 1000;
+    uint64_t preRoll = (uint64_t)preRollBlocks * timing->blockFrames;
+    uint64_t spanned = 0, prevEnd = 0, gapFrames = 0;
+    uint32_t count = 0, gaps = 0, misplaced = 0, shortPreRoll = 0, brokenSplits = 0;
+    for (uint32_t i = 0; i < files; i++) {
+        FILE *f = fopen(paths[i], "rb");
+        if (f == NULL) {
+            printf("Failed to read the event index %s\n", paths[i]);
+            return false;
+        }
+        uint8_t header[EVENT_INDEX_HEADER_BYTES];
+        EventIndexInfo info;
+        if (fread(header, 1, sizeof(header), f) != sizeof(header) ||
+            !event_index_parse_header(header, sizeof(header), &info)) {
+            printf("Bad event index header in %s\n", paths[i]);
+            fclose(f);
+            return false;
+        }
+
+        uint8_t rec[EVENT_INDEX_RECORD_BYTES];
+        while (fread(rec, 1, sizeof(rec), f) == sizeof(rec)) {
+            EventIndexRecord e;
+            event_index_decode(rec, &e);
+            spanned += e.endSample - e.startSample;
+            if (e.reasons & EVENT_INDEX_CONTINUED) {
+                // 轮转边界上继续的事件：必须紧接前一段
+                brokenSplits += (e.startSample != prevEnd) ? 1 : 0;
+                prevEnd = e.endSample;
+                continue;
+            }
+            // 突发开始的帧必须落在触发块内
+            uint64_t trigger = e.triggerSample + firstFrame;
+            uint64_t onset = (trigger / period) * period + period - burst;
+            if (onset < trigger) {
+                onset += period;
+            }
+            if (onset >= trigger + timing->blockFrames) {
+                misplaced++;
+            }
+            // 预录只会被录音开头或上一个事件截短
+            uint64_t floor = (e.triggerSample > preRoll) ? e.triggerSample - preRoll : 0;
+            if (e.startSample > floor && e.startSample != prevEnd) {
+                shortPreRoll++;
+            }
+            // 录音从第0帧开始接着上一个事件，不相接的地方在录音中是一个缺口
+            if (e.startSample != prevEnd) {
+                gaps++;
+                gapFrames += (e.startSample > prevEnd) ? e.startSample - prevEnd : 0;
+            }
+            prevEnd = e.endSample;
+            count++;
+        }
+        fclose(f);
+    }
+
+    // 注入的写卡失败在事件中间多出整块的缺口，事件覆盖的帧仍包括它们
+    bool ok = count != 0 && misplaced == 0 && shortPreRoll == 0 && brokenSplits == 0 && spanned == committedFrames;
+    if (verify != NULL) {
+        uint64_t extra = (verify->missing >= gapFrames) ? verify->missing - gapFrames : UINT64_MAX;
+        ok = ok && verify->gaps >= gaps && verify->gaps <= gaps + failedWrites && extra % timing->blockFrames == 0 &&
+             extra <= (uint64_t)failedWrites * timing->blockFrames &&
+             verify->frames + extra == spanned;
+    }
+    uint64_t bursts = (producedFrames + burst) / period;
+    printf("Events: %u in %u file(s) (%llu bursts generated), %u misplaced triggers, %u short pre-rolls, "
+           "%u broken splits, %llu frames (%llu committed), %u gaps of %llu frames between events: %s\n",
+           (unsigned)count, (unsigned)files, (unsigned long long)bursts, (unsigned)misplaced, (unsigned)shortPreRoll,
+           (unsigned)brokenSplits, (unsigned long long)spanned, (unsigned long long)committedFrames, (unsigned)gaps,
+           (unsigned long long)gapFrames, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// 读回同步索引（轮转时按顺序读所有文件），与模拟的准确位置比较：第seq个脉冲是第seq + 1个参考周期，
+// 它在帧流中位于 周期数 x 每周期标称帧数 x (1 + ppm/1e6)，录音从第firstFrame帧开始。
+// 模拟的时间戳只精确到1us，容差为1us对应的帧数加上1/4帧
+static bool verify_sync(char paths[][CAPTURE_PIPELINE_PATH_MAX], uint32_t files, const CaptureSimSource *sim) {
+    double framesPerUs = (double)opts.profile.sampleRate * (1 + opts.syncPpm * 1e-6) / 1e6;
+    double maxError = 0, maxRateError = 0;
+    uint32_t records = 0, unlocked = 0;
+    int32_t lastPpb = 0;
+    for (uint32_t i = 0; i < files; i++) {
+        FILE *f = fopen(paths[i], "rb");
+        if (f == NULL) {
+            return false;
+        }
+        uint8_t header[SYNC_INDEX_HEADER_BYTES];
+        SyncIndexInfo info;
+        if (fread(header, 1, sizeof(header), f) != sizeof(header) ||
+            !sync_index_parse_header(header, sizeof(header), &info)) {
+            fclose(f);
+            return false;
+        }
+
+        uint8_t rec[SYNC_INDEX_RECORD_BYTES];
+        while (fread(rec, 1, sizeof(rec), f) == sizeof(rec)) {
+            SyncIndexRecord r;
+            sync_index_decode(rec, &r);
+            double expected = (double)(r.seq + 1) * opts.syncPeriodMs * 1000 * framesPerUs - (double)sim->firstFrame;
+            double error = fabs((double)r.samplePos / SYNC_INDEX_POS_ONE - expected);
+            maxError = (error > maxError) ? error : maxError;
+            if (r.flags & SYNC_INDEX_LOCKED) {
+                double rateError = fabs(r.ratePpb / 1e3 - opts.syncPpm);
+                maxRateError = (rateError > maxRateError) ? rateError : maxRateError;
+                lastPpb = r.ratePpb;
+            } else {
+                unlocked++;
+            }
+            records++;
+        }
+        fclose(f);
+    }
+
+    double tolerance = 0.25 + framesPerUs;
+    printf("Sync: %u pulse records in %u file(s) (%u before lock), position error max %.3f frames "
+           "(tolerance %.2f), rate %+.3f ppm (simulated %+.3f, max error %.3f ppm)\n", (unsigned)records,
+           (unsigned)files, (unsigned)unlocked, maxError, tolerance, lastPpb / 1e3, opts.syncPpm, maxRateError);
+    return records > 0 && maxError <= tolerance && maxRateError <= 0.1;
+}
+
+// 读WAV头部，失败返回false
+static bool read_wav_info(const char *path, WavInfo *info) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return false;
+    }
+    uint8_t header[WAV_HEADER_BYTES];
+    bool ok = fread(header, 1, sizeof(header), f) == sizeof(header) && wav_parse_header(header, sizeof(header), info);
+    fclose(f);
+    return ok;
+}
+
+// 检查波束文件：只录波束时录音文件的通道数是波束数；同时录原始数据时每个波束文件（16位WAV）
+// 与同名录音文件的帧数相同
+static bool verify_beams(char paths[][CAPTURE_PIPELINE_PATH_MAX], char beamPaths[][CAPTURE_PIPELINE_PATH_MAX],
+                         uint32_t files) {
+    uint64_t frames = 0;
+    bool matched = true;
+    for (uint32_t i = 0; i < files; i++) {
+        WavInfo audio, beam;
+        if (!read_wav_info(paths[i], &audio)) {
+            printf("Failed to read %s\n", paths[i]);
+            return false;
+        }
+        if (opts.beamOutput == AUDIO_BEAM_ONLY) {
+            matched &= audio.format.channels == opts.beams;
+            frames += audio.dataBytes / wav_block_align(&audio.format);
+            continue;
+        }
+        if (!read_wav_info(beamPaths[i], &beam)) {
+            printf("Failed to read the beam file %s\n", beamPaths[i]);
+            return false;
+        }
+        uint64_t beamFrames = beam.dataBytes / wav_block_align(&beam.format);
+        matched &= beam.format.channels == opts.beams && beam.format.containerBits == 16 &&
+                   beamFrames == audio.dataBytes / wav_block_align(&audio.format);
+        frames += beamFrames;
+    }
+    printf("Beams: %u channels, %llu frames in %u file(s), %s\n", (unsigned)opts.beams, (unsigned long long)frames,
+           (unsigned)files, matched ? "consistent" : "MISMATCH");
+    return matched;
+}
+
+// 多采样率输出：每个文件都是16位WAV，采样率和通道数与配置一致，帧数为录音文件帧数 / 抽取比
+// （抽取相位跨文件延续，每个文件相差不超过1帧），总帧数为录音总帧数 / 抽取比
+static bool verify_rates(char paths[][CAPTURE_PIPELINE_PATH_MAX], char (*ratePaths)[CAPTURE_PIPELINE_PATH_MAX],
+                         uint32_t files) {
+    bool matched = true;
+    for (uint32_t o = 0; o < opts.rates.outputs; o++) {
+        uint32_t factor = opts.profile.sampleRate / opts.rates.rateHz[o];
+        uint32_t channels = (uint32_t)__builtin_popcount(opts.channelMask);
+        uint64_t frames = 0, audioFrames = 0;
+        bool ok = true;
+        for (uint32_t i = 0; i < files; i++) {
+            WavInfo audio, rate;
+            const char *path = ratePaths[(size_t)o * files + i];
+            if (!read_wav_info(paths[i], &audio) || !read_wav_info(path, &rate)) {
+                printf("Failed to read %s\n", path);
+                return false;
+            }
+            uint64_t fileFrames = audio.dataBytes / wav_block_align(&audio.format);
+            uint64_t rateFrames = rate.dataBytes / wav_block_align(&rate.format);
+            ok &= rate.format.sampleRate == opts.rates.rateHz[o] && rate.format.channels == channels &&
+                  rate.format.containerBits == 16 && rateFrames + 1 >= fileFrames / factor &&
+                  rateFrames <= fileFrames / factor + 1;
+            frames += rateFrames;
+            audioFrames += fileFrames;
+        }
+        ok &= frames == (audioFrames + factor - 1) / factor;
+        printf("Rate %u Hz: %u channels, %llu frames in %u file(s) (1/%u of %llu), %s\n",
+               (unsigned)opts.rates.rateHz[o], (unsigned)channels, (unsigned long long)frames, (unsigned)files,
+               (unsigned)factor, (unsigned long long)audioFrames, ok ? "consistent" : "MISMATCH");
+        matched &= ok;
+    }
+    return matched;
+}
+
+// 读回特征索引（轮转时按顺序读所有文件）：头部与配置一致，记录的samplePos严格递增，没有丢帧时相邻记录
+// 相隔reportFrames帧；每个通道的峰值不低于RMS。记录数应为输入帧数 / reportFrames（最后一条不完整的不输出）
+static bool verify_features(char paths[][CAPTURE_PIPELINE_PATH_MAX], uint32_t files, uint32_t reportFrames,
+                            uint64_t inputFrames, uint64_t lostFrames) {
+    uint32_t records = 0, misplaced = 0, channels = 0, bands = 0;
+    uint64_t prevPos = 0;
+    double power = 0;
+    for (uint32_t i = 0; i < files; i++) {
+        FILE *f = fopen(paths[i], "rb");
+        if (f == NULL) {
+            printf("Failed to read the feature index %s\n", paths[i]);
+            return false;
+        }
+        uint8_t header[FEATURE_INDEX_HEADER_BYTES];
+        FeatureIndexInfo info;
+        if (fread(header, 1, sizeof(header), f) != sizeof(header) ||
+            !feature_index_parse_header(header, sizeof(header), &info) ||
+            info.sampleRate != opts.profile.sampleRate || info.reportFrames != reportFrames ||
+            info.channelMask != opts.channelMask || info.channels != (uint32_t)__builtin_popcount(opts.channelMask) ||
+            info.bands != BENCH_FEATURE_BANDS) {
+            printf("Bad feature index header in %s\n", paths[i]);
+            fclose(f);
+            return false;
+        }
+        channels = info.channels;
+        bands = info.bands;
+
+        size_t recordBytes = FEATURE_INDEX_RECORD_BYTES(channels, bands);
+        uint8_t rec[FEATURE_INDEX_RECORD_BYTES(FEATURE_INDEX_MAX_CHANNELS, FEATURE_INDEX_MAX_BANDS)];
+        while (fread(rec, 1, recordBytes, f) == recordBytes) {
+            FeatureIndexRecord r;
+            feature_index_decode(rec, &r, channels, bands);
+            if (records != 0 && (r.samplePos <= prevPos ||
+                                 (lostFrames == 0 && r.samplePos - prevPos != reportFrames))) {
+                misplaced++;
+            }
+            for (uint32_t ch = 0; ch < channels; ch++) {
+                misplaced += r.peak[ch] < r.rms[ch];
+            }
+            prevPos = r.samplePos;
+            power += pow(10.0, feature_index_code_db(r.rms[channels - 1]) / 10.0);
+            records++;
+        }
+        fclose(f);
+    }
+
+    uint64_t expected = inputFrames / reportFrames;
+    printf("Features: %u records of %u channels x %u bands in %u file(s) (%llu expected), %u misplaced, "
+           "last channel %.1f dBFS RMS\n", (unsigned)records, (unsigned)channels, (unsigned)bands, (unsigned)files,
+           (unsigned long long)expected, (unsigned)misplaced, records ? 10.0 * log10(power / records + 1e-30) : 0.0);
+    return misplaced == 0 && records + 1 >= expected && records <= expected;
+}
+
+// 读回方位索引（轮转时按顺序读所有文件）：头部与配置一致（reportFrames四舍五入为整数个分析帧间隔），
+// 结果的samplePos严格递增，没有丢帧时相邻结果相隔reportFrames帧；结果数应为输入帧数 / reportFrames
+// （最后一个不完整的不输出）
+static bool verify_doa(char paths[][CAPTURE_PIPELINE_PATH_MAX], uint32_t files, const DoaConfig *doa,
+                       uint64_t inputFrames, uint64_t lostFrames) {
+    uint32_t records = 0, misplaced = 0, reportFrames = 0;
+    uint64_t prevPos = 0;
+    double confidence = 0;
+    for (uint32_t i = 0; i < files; i++) {
+        FILE *f = fopen(paths[i], "rb");
+        if (f == NULL) {
+            printf("Failed to read the DOA index %s\n", paths[i]);
+            return false;
+        }
+        uint8_t header[DOA_INDEX_HEADER_BYTES];
+        DoaIndexInfo info;
+        if (fread(header, 1, sizeof(header), f) != sizeof(header) ||
+            !doa_index_parse_header(header, sizeof(header), &info) ||
+            info.sampleRate != opts.profile.sampleRate || 2 * info.reportFrames > 2 * doa->reportFrames + doa->hopFrames ||
+            2 * info.reportFrames + doa->hopFrames < 2 * doa->reportFrames || info.frameSize != doa->frameSize ||
+            info.pairs != doa->pairs) {
+            printf("Bad DOA index header in %s\n", paths[i]);
+            fclose(f);
+            return false;
+        }
+        reportFrames = info.reportFrames;
+
+        uint8_t rec[DOA_INDEX_RECORD_BYTES];
+        while (fread(rec, 1, sizeof(rec), f) == sizeof(rec)) {
+            DoaIndexRecord r;
+            doa_index_decode(rec, &r);
+            if (records != 0 && (r.samplePos <= prevPos ||
+                                 (lostFrames == 0 && r.samplePos - prevPos != reportFrames))) {
+                misplaced++;
+            }
+            misplaced += r.azimuth >= 36000;
+            prevPos = r.samplePos;
+            confidence += r.confidence / 65535.0;
+            records++;
+        }
+        fclose(f);
+    }
+
+    uint64_t expected = inputFrames / reportFrames;
+    printf("DOA: %u estimates in %u file(s) (%llu expected), %u misplaced, mean confidence %.2f\n",
+           (unsigned)records, (unsigned)files, (unsigned long long)expected, (unsigned)misplaced,
+           records ? confidence / records : 0.0);
+    return misplaced == 0 && records + 1 >= expected && records <= expected;
+}
+
+static void print_latency(const char *name, const uint32_t *hist, uint32_t maxUs) {
+    printf("%-16s p50 < %u us, p99 < %u us, max %u us\n", name, (unsigned)capture_stats_percentile_us(hist, 50),
+           (unsigned)capture_stats_percentile_us(hist, 99), (unsigned)maxUs);
+}
+
+// 直方图最大值所在的桶必须是最高的非空桶
+static bool hist_consistent(const uint32_t *hist, uint32_t maxUs, uint32_t samples) {
+    uint32_t total = 0, top = 0;
+    for (uint32_t i = 0; i < CAPTURE_STATS_BUCKETS; i++) {
+        total += hist[i];
+        top = hist[i] ? i : top;
+    }
+    return total == samples && (samples == 0 ? maxUs == 0 : capture_stats_bucket(maxUs) == top);
+}
+
+// 运行统计与模拟源、注入的失败和读回的录音互相核对：溢出次数对应丢失的DMA缓冲区，每个直方图的样本数
+// 对应它的计数器，读入的帧除溢出后丢弃的部分外都提交成块（暂停时最多丢弃一个不完整的块），提交的块都写出或计为写入失败，
+// 高水位不超过环的容量
+static bool check_counters(const CapturePipelineStats *stats, const CaptureTiming *timing, uint64_t inputFrames,
+                           uint64_t lostFrames, uint32_t dmaBufferFrames, bool stage, bool events,
+                           uint64_t verifiedFrames) {
+    const CaptureStatsSnapshot *p = &stats->pipeline;
+    uint64_t committedFrames = (uint64_t)p->blocksCommitted * timing->blockFrames;
+    uint64_t droppedFrames = lostFrames + p->discardedFrames;
+    const char *why = NULL;
+    if (lostFrames != (uint64_t)p->overruns * dmaBufferFrames) {
+        why = "overruns do not match the lost DMA buffers";
+    } else if (p->overruns == 0 && p->discardedFrames != 0) {
+        why = "frames discarded without an overrun";
+    } else if (!events && (committedFrames + droppedFrames > inputFrames ||
+                           inputFrames - droppedFrames - committedFrames >= timing->blockFrames)) {
+        why = "committed blocks do not cover the input frames";
+    } else if (p->blocksWritten + p->writeErrors != p->blocksCommitted) {
+        why = "committed blocks are not all written or failed";
+    } else if (p->writeErrors != failedWrites || p->corruptBlocks != 0) {
+        why = "write errors do not match the injected failures";
+    } else if (opts.codec != AUDIO_CODEC_FLAC && p->flacFallbacks != 0) {
+        why = "FLAC fallbacks without FLAC";
+    } else if (!hist_consistent(p->commitHist, p->commitMaxUs, p->blocksCommitted) ||
+               !hist_consistent(p->writeWaitHist, p->writeWaitMaxUs, p->blocksCommitted) ||
+               !hist_consistent(p->writeHist, p->writeMaxUs, p->blocksWritten)) {
+        why = "latency histograms do not match the block counters";
+    } else if (stage ? !hist_consistent(p->processWaitHist, p->processWaitMaxUs, p->blocksCommitted) ||
+                       !hist_consistent(p->processHist, p->processMaxUs, p->blocksCommitted)
+                     : p->processMaxUs != 0 || p->processHighWater != 0 || p->backpressureProcess != 0) {
+        why = "processing stage counters do not match";
+    } else if (p->ringHighWater > stats->ringCapacity || p->spillHighWater > stats->spillCapacity ||
+               p->blocksSpilled > p->blocksCommitted || (p->blocksSpilled != 0) != (p->spillHighWater != 0)) {
+        why = "high-water marks exceed the ring capacity";
+    } else if (verifiedFrames != UINT64_MAX && verifiedFrames != (uint64_t)p->blocksWritten * timing->blockFrames) {
+        why = "written blocks do not match the frames in the recording";
+    }
+    printf("Counters: %u overruns, %u blocks committed, %u written, %u failed: %s%s\n", (unsigned)p->overruns,
+           (unsigned)p->blocksCommitted, (unsigned)p->blocksWritten, (unsigned)p->writeErrors,
+           why ? "FAILED, " : "ok", why ? why : "");
+    return why == NULL;
+}
+
+static double now_sec(void) {
+    return (double)capture_os_now_us() / 1e6;
+}
+
+int main(int argc, char **argv) {
+    static CapturePipeline pipeline;
+    static CaptureSimSource sim;
+    static SyncClock syncClock;
+
+    if (!parse_options(argc, argv)) {
+        return 2;
+    }
+    mkdir(opts.dir, 0755);
+
+    CaptureTiming timing;
+    CaptureProfileError err = capture_profile_resolve(&opts.profile, 32 * 1024, &timing);
+    if (err != CAPTURE_PROFILE_OK) {
+        printf("Invalid capture profile: %s\n", capture_profile_error_str(err));
+        return 2;
+    }
+    if (!capture_sim_source_init(&sim, &opts.profile, &timing, BENCH_SLOTS, opts.speed, &pipeline.stats)) {
+        printf("Failed to initialize the synthetic TDM source\n");
+        return 2;
+    }
+    // 高倍速下DMA环对应的墙钟时间按倍数缩短，主机调度抖动就可能造成溢出；可以加深模拟的DMA环
+    if (opts.dmaDesc != 0) {
+        timing.dmaDescNum = opts.dmaDesc;
+        sim.dmaFrames = timing.dmaFrameNum * opts.dmaDesc;
+    }
+    bool events = opts.burstPeriodMs != 0;
+    if (events) {
+        capture_sim_source_set_bursts(&sim, (uint64_t)opts.burstPeriodMs * opts.profile.sampleRate / 1000,
+                                      (uint64_t)opts.burstMs * opts.profile.sampleRate / 1000);
+    }
+
+    bool sync = opts.syncPeriodMs != 0;
+    if (sync) {
+        capture_sim_source_set_sync(&sim, &syncClock, opts.syncPpm, opts.syncPeriodMs);
+    }
+
+    char journalPath[CAPTURE_PIPELINE_PATH_MAX];
+    snprintf(journalPath, sizeof(journalPath), "%s/RECORD.JNL", opts.dir);
+    char seqPath[CAPTURE_PIPELINE_PATH_MAX];
+    snprintf(seqPath, sizeof(seqPath), "%s/RECORD.SEQ", opts.dir);
+    baseBackend = record_backend_default();
+    if (opts.replayPath != NULL && !load_trace(opts.replayPath, &replayTrace)) {
+        return 2;
+    }
+    if (opts.recordPath != NULL) {
+        recordTrace.capacity = TRACE_MAX_RECORD;
+        recordTrace.latencyUs = malloc(TRACE_MAX_RECORD * sizeof(uint32_t));
+        recordTrace.bytes = malloc(TRACE_MAX_RECORD * sizeof(uint32_t));
+    }
+    // 波束：8个麦克风均匀分布在半径40mm的圆上，波束均匀分布在水平面上
+    BeamformerConfig beam = { .beams = opts.beams };
+    beamformer_circular_array(&beam, BENCH_SLOTS, 0.04f);
+    for (uint32_t b = 0; b < opts.beams; b++) {
+        beam.azimuthDeg[b] = 360.0f * b / opts.beams;
+    }
+
+    // 方位估计：同一阵列，1024帧分析帧、50%重叠，对置的4对麦克风
+    DoaConfig doa = {
+        .frameSize = 1024,
+        .hopFrames = 512,
+        .reportFrames = (opts.doaRateHz != 0) ? opts.profile.sampleRate / opts.doaRateHz : 0,
+        .pairs = 4,
+        .pair = { { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 } },
+        .minHz = 300,
+        .maxHz = 8000,
+    };
+    memcpy(doa.mic, beam.mic, sizeof(doa.mic));
+
+    // 多采样率输出：扩展名为".R" + kHz
+    char rateExt[DECIMATOR_MAX_OUTPUTS][12];
+    for (uint32_t o = 0; o < opts.rates.outputs; o++) {
+        snprintf(rateExt[o], sizeof(rateExt[o]), ".R%u", (unsigned)(opts.rates.rateHz[o] / 1000));
+    }
+
+    // 声学特征：每featureMs一条记录，32个频带
+    uint32_t featureFrames = (uint32_t)((uint64_t)opts.profile.sampleRate * opts.featureMs / 1000);
+
+    bool slow = opts.writeDelayUs != 0 || opts.stallEvery != 0 || replayTrace.count != 0 || opts.recordPath != NULL ||
+                opts.failEvery != 0;
+    capture_os_host_spiram_bytes = (size_t)opts.psramMb * 1024 * 1024;
+
+    CapturePipelineConfig config = {
+        .mode = AUDIO_CAPTURE_MODE_COPY,
+        .codec = opts.codec,
+        .layout = opts.layout,
+        .slots = BENCH_SLOTS,
+        .channelMask = opts.channelMask,
+        .profile = opts.profile,
+        .maxBlockBytes = 32 * 1024,
+        .spillStallMs = opts.spillMs,
+        .spillMaxBytes = 0,
+        .eventCapture = events,
+        .detector = EVENT_DETECTOR_DEFAULT,
+        .eventChannelMask = opts.channelMask & ~3u,     // 槽位0/1是帧序号，不参与检测
+        .preRollMs = opts.preRollMs,
+        .postRollMs = opts.postRollMs,
+        .processHook = (opts.processUs != 0) ? bench_process_hook : NULL,
+        .syncClock = sync ? &syncClock : NULL,
+        .syncPeriodMs = opts.syncPeriodMs,
+        .beamOutput = opts.beamOutput,
+        .beam = beam,
+        .doaEstimate = opts.doaRateHz != 0,
+        .doa = doa,
+        .rates = opts.rates,
+        .features = opts.featureMs != 0,
+        .feature = { .reportFrames = featureFrames, .bands = BENCH_FEATURE_BANDS },
+        .reader = &sim.base,
+        .backend = slow ? &slowBackend : NULL,
+        .fileDir = opts.dir,
+        .filePrefix = "AUDIO",
+        .pcmExt = ".WAV",
+        .flacExt = ".FLA",
+        .planarExt = ".PLN",
+        .bfpExt = ".BFP",
+        .indexExt = ".IDX",
+        .eventExt = ".EVT",
+        .syncExt = ".SYN",
+        .beamExt = ".BMF",
+        .doaExt = ".DOA",
+        .rateExt = { rateExt[0], rateExt[1], rateExt[2] },
+        .featureExt = ".FEA",
+        .preallocBytes = 0,
+        .checkpointMs = 5000,
+        .journalPath = journalPath,
+        .seqPath = seqPath,
+        .rotateMs = opts.rotateMs,
+        .rotateBytes = (uint64_t)opts.rotateMb * 1024 * 1024,
+        .captureTask = { 8 * 1024, 10, 1 },
+        .processTask = { 4 * 1024, 6, 1 },
+        .fileTask = { 8 * 1024, opts.filePriority, 0 },
+        .prepTask = { 4 * 1024, 4, 0 },
+    };
+    const char *ext = (opts.codec == AUDIO_CODEC_FLAC) ? config.flacExt
+                      : (opts.codec == AUDIO_CODEC_BFP) ? config.bfpExt
+                      : (opts.layout == AUDIO_LAYOUT_PLANAR) ? config.planarExt : config.pcmExt;
+    failExt = (opts.failEvery != 0) ? ext : NULL;
+
+    printf("Profile: %u Hz, %u-bit, %u slots, mask 0x%02x, %s/%s, %ux real time for %u s\n",
+           (unsigned)opts.profile.sampleRate, (unsigned)opts.profile.bitsPerSample, BENCH_SLOTS,
+           (unsigned)opts.channelMask,
+           opts.codec == AUDIO_CODEC_FLAC ? "flac" : opts.codec == AUDIO_CODEC_BFP ? "bfp" : "pcm",
+           opts.layout == AUDIO_LAYOUT_PLANAR ? "planar" : "interleaved", (unsigned)opts.speed,
+           (unsigned)opts.seconds);
+    printf("Block: %u bytes (%u frames), simulated DMA %u x %u frames\n", (unsigned)timing.blockBytes,
+           (unsigned)timing.blockFrames, (unsigned)timing.dmaDescNum, (unsigned)timing.dmaFrameNum);
+    if (events) {
+        printf("Events: %u ms bursts every %u ms, pre-roll %u ms, post-roll %u ms\n", (unsigned)opts.burstMs,
+               (unsigned)opts.burstPeriodMs, (unsigned)opts.preRollMs, (unsigned)opts.postRollMs);
+    }
+    if (replayTrace.count != 0) {
+        printf("Replaying %zu write latencies from %s\n", replayTrace.count, opts.replayPath);
+    }
+    if (opts.rotateMs != 0 || opts.rotateMb != 0) {
+        printf("Rotation: every %u ms / %u MB (0 = no limit)\n", (unsigned)opts.rotateMs, (unsigned)opts.rotateMb);
+    }
+    if (sync) {
+        printf("Sync: reference pulse every %u ms, sample clock %+.3f ppm\n", (unsigned)opts.syncPeriodMs,
+               opts.syncPpm);
+    }
+    if (opts.beams != 0) {
+        printf("Beams: %u from a 40 mm circular array, %s\n", (unsigned)opts.beams,
+               opts.beamOutput == AUDIO_BEAM_ONLY ? "instead of the microphones" : "next to the microphones");
+    }
+    if (opts.doaRateHz != 0) {
+        printf("DOA: %u estimates/s from %u-frame windows with 50%% overlap, %u pairs\n", (unsigned)opts.doaRateHz,
+               (unsigned)doa.frameSize, (unsigned)doa.pairs);
+    }
+    for (uint32_t o = 0; o < opts.rates.outputs; o++) {
+        printf("Rate output: %u Hz into %s files\n", (unsigned)opts.rates.rateHz[o], rateExt[o]);
+    }
+    if (opts.featureMs != 0) {
+        printf("Features: every %u ms (%u frames), %d bands\n", (unsigned)opts.featureMs, (unsigned)featureFrames,
+               BENCH_FEATURE_BANDS);
+    }
+    if (opts.processUs != 0 || opts.radioLoadPct != 0) {
+        printf("Processing stage: +%u us per block; core 0 load: %u%% at priority %u, file task priority %u\n",
+               (unsigned)opts.processUs, (unsigned)opts.radioLoadPct, (unsigned)opts.radioPriority,
+               (unsigned)opts.filePriority);
+    }
+    if (!capture_pipeline_init(&pipeline, &config)) {
+        capture_pipeline_deinit(&pipeline);
+        return 1;
+    }
+    // 本次运行的文件从序号状态中的下一个序号开始连续编号
+    uint32_t firstIndex = pipeline.fileSeq.next;
+    capture_task_t radioTask = NULL;
+    if (opts.radioLoadPct != 0 &&
+        !capture_os_task_create(radio_load_task, "radio_load", 4 * 1024, NULL, opts.radioPriority, 0, &radioTask)) {
+        printf("Failed to start the core 0 load\n");
+    }
+    if (!capture_pipeline_start_tasks(&pipeline)) {
+        capture_pipeline_deinit(&pipeline);
+        return 1;
+    }
+
+    double start = now_sec();
+    capture_os_delay_ms(opts.seconds * 1000);
+    bool paused = capture_pipeline_pause(&pipeline);
+    uint32_t pauseMs = capture_pipeline_pause_timeout_ms(&pipeline);
+    double elapsed = now_sec() - start;
+    if (radioTask != NULL) {
+        capture_os_task_delete(radioTask);
+    }
+
+    CapturePipelineStats stats;
+    capture_pipeline_get_stats(&pipeline, &stats);
+    // 帧序号从firstFrame开始，nextFrame已包括溢出丢弃的帧
+    uint64_t produced = sim.nextFrame;
+    uint64_t input = sim.nextFrame - sim.firstFrame;
+    uint64_t lost = sim.lostFrames;
+    capture_pipeline_delete_tasks(&pipeline);
+    capture_pipeline_deinit(&pipeline);
+    if (!paused) {
+        printf("Pipeline did not stop within %u ms\n", (unsigned)pauseMs);
+        return 1;
+    }
+
+    // 每次轮转多一个文件
+    uint32_t files = stats.rotations + 1;
+    char (*paths)[CAPTURE_PIPELINE_PATH_MAX] = calloc(files, CAPTURE_PIPELINE_PATH_MAX);
+    char (*indexPaths)[CAPTURE_PIPELINE_PATH_MAX] = calloc(files, CAPTURE_PIPELINE_PATH_MAX);
+    char (*eventPaths)[CAPTURE_PIPELINE_PATH_MAX] = calloc(files, CAPTURE_PIPELINE_PATH_MAX);
+    char (*syncPaths)[CAPTURE_PIPELINE_PATH_MAX] = calloc(files, CAPTURE_PIPELINE_PATH_MAX);
+    char (*beamPaths)[CAPTURE_PIPELINE_PATH_MAX] = calloc(files, CAPTURE_PIPELINE_PATH_MAX);
+    char (*doaPaths)[CAPTURE_PIPELINE_PATH_MAX] = calloc(files, CAPTURE_PIPELINE_PATH_MAX);
+    char (*featurePaths)[CAPTURE_PIPELINE_PATH_MAX] = calloc(files, CAPTURE_PIPELINE_PATH_MAX);
+    // 第o路输出的第i个文件在ratePaths[o x files + i]
+    char (*ratePaths)[CAPTURE_PIPELINE_PATH_MAX] = calloc((size_t)files * DECIMATOR_MAX_OUTPUTS,
+                                                          CAPTURE_PIPELINE_PATH_MAX);
+    uint64_t fileBytes = 0;
+    for (uint32_t i = 0; i < files; i++) {
+        struct stat st;
+        file_sequence_path(opts.dir, config.filePrefix, firstIndex + i, ext, paths[i], CAPTURE_PIPELINE_PATH_MAX);
+        file_sequence_path(opts.dir, config.filePrefix, firstIndex + i, config.indexExt, indexPaths[i],
+                           CAPTURE_PIPELINE_PATH_MAX);
+        file_sequence_path(opts.dir, config.filePrefix, firstIndex + i, config.eventExt, eventPaths[i],
+                           CAPTURE_PIPELINE_PATH_MAX);
+        file_sequence_path(opts.dir, config.filePrefix, firstIndex + i, config.syncExt, syncPaths[i],
+                           CAPTURE_PIPELINE_PATH_MAX);
+        file_sequence_path(opts.dir, config.filePrefix, firstIndex + i, config.beamExt, beamPaths[i],
+                           CAPTURE_PIPELINE_PATH_MAX);
+        file_sequence_path(opts.dir, config.filePrefix, firstIndex + i, config.doaExt, doaPaths[i],
+                           CAPTURE_PIPELINE_PATH_MAX);
+        file_sequence_path(opts.dir, config.filePrefix, firstIndex + i, config.featureExt, featurePaths[i],
+                           CAPTURE_PIPELINE_PATH_MAX);
+        for (uint32_t o = 0; o < opts.rates.outputs; o++) {
+            file_sequence_path(opts.dir, config.filePrefix, firstIndex + i, config.rateExt[o],
+                               ratePaths[(size_t)o * files + i], CAPTURE_PIPELINE_PATH_MAX);
+        }
+        fileBytes += (stat(paths[i], &st) == 0) ? (uint64_t)st.st_size : 0;
+    }
+    double required = (double)timing.frameBytes * opts.profile.sampleRate * opts.speed;
+    const CaptureStatsSnapshot *p = &stats.pipeline;
+
+    if (files == 1) {
+        printf("\nFile: %s (%llu bytes)\n", paths[0], (unsigned long long)fileBytes);
+    } else {
+        printf("\nFiles: %s .. %s, %u rotations, %u prep timeouts (%llu bytes)\n", paths[0], paths[files - 1],
+               (unsigned)stats.rotations, (unsigned)stats.prepTimeouts, (unsigned long long)fileBytes);
+    }
+    printf("Input: %llu frames in %.2f s (%.2f MB/s required)\n", (unsigned long long)input, elapsed,
+           required / 1e6);
+    printf("Sustained capture: %.2f MB/s, write: %.2f MB/s (last window %.2f MB/s)\n",
+           (double)p->blocksCommitted * timing.blockBytes / elapsed / 1e6, (double)fileBytes / elapsed / 1e6,
+           p->bytesPerSec / 1e6);
+    printf("Overruns: %u DMA buffers, %llu frames lost (%.1f blocks), %u read frames discarded\n",
+           (unsigned)p->overruns, (unsigned long long)lost, (double)lost / timing.blockFrames,
+           (unsigned)p->discardedFrames);
+    printf("Blocks committed: %u, written: %u, write errors: %u, ring high-water %u / %u\n",
+           (unsigned)p->blocksCommitted, (unsigned)p->blocksWritten, (unsigned)p->writeErrors,
+           (unsigned)p->ringHighWater, (unsigned)stats.ringCapacity);
+    if (opts.codec == AUDIO_CODEC_FLAC) {
+        printf("FLAC encoder failures: %u (stored verbatim)\n", (unsigned)p->flacFallbacks);
+    }
+    if (opts.failEvery != 0) {
+        printf("Injected write failures: %u (every %u block writes)\n", (unsigned)failedWrites,
+               (unsigned)opts.failEvery);
+    }
+    if (stats.spillCapacity != 0) {
+        printf("PSRAM spill: %u blocks spilled, high-water %u / %u blocks (%.1f MB, %.0f ms of audio)\n",
+               (unsigned)p->blocksSpilled, (unsigned)p->spillHighWater, (unsigned)stats.spillCapacity,
+               (double)stats.spillCapacity * timing.blockBytes / (1024 * 1024),
+               (double)stats.spillCapacity * timing.blockFrames * 1000 / opts.profile.sampleRate);
+    }
+    if (events) {
+        printf("Event capture: %u events detected, pre-roll %u blocks\n", (unsigned)stats.events,
+               (unsigned)stats.preRollBlocks);
+    }
+    // 阶段边界：读完 -> (开始处理 -> 处理完) -> 对文件任务可见 -> 开始写出 -> 写完
+    if (capture_pipeline_stage_enabled(&config)) {
+        print_latency("Process wait:", p->processWaitHist, p->processWaitMaxUs);
+        print_latency("Process time:", p->processHist, p->processMaxUs);
+    }
+    print_latency("Commit latency:", p->commitHist, p->commitMaxUs);
+    print_latency("Write wait:", p->writeWaitHist, p->writeWaitMaxUs);
+    print_latency("Write latency:", p->writeHist, p->writeMaxUs);
+    printf("Backpressure: %u ring-full episodes (%u processing, %u writing), processing queue high-water %u\n",
+           (unsigned)(p->backpressureProcess + p->backpressurePersist), (unsigned)p->backpressureProcess,
+           (unsigned)p->backpressurePersist, (unsigned)p->processHighWater);
+
+    // 只有交织PCM且全部通道（不是波束）时，文件中的帧与源帧一一对应，可以逐帧校验；
+    // 轮转出的文件按顺序接起来校验，样本在文件之间也必须连续
+    VerifyState verify = { .expected = sim.firstFrame };
+    bool contentVerified = false;
+    if (opts.codec == AUDIO_CODEC_PCM && opts.layout == AUDIO_LAYOUT_INTERLEAVED &&
+        opts.channelMask == (1u << BENCH_SLOTS) - 1 && opts.beamOutput != AUDIO_BEAM_ONLY) {
+        uint32_t verified = 0;
+        while (verified < files && verify_wav(paths[verified], &timing, &verify)) {
+            verified++;
+        }
+        if (verified < files) {
+            printf("Failed to read %s\n", paths[verified]);
+            verify.gaps++;
+        }
+        printf("Verify: %llu frames in %u file(s), %llu gaps (%llu at file boundaries), %llu frames %s\n",
+               (unsigned long long)verify.frames, (unsigned)verified, (unsigned long long)verify.gaps,
+               (unsigned long long)verify.boundaryGaps, (unsigned long long)verify.missing,
+               events ? "between events" : "missing");
+        contentVerified = true;
+    }
+    // 块浮点只在24位时校验：32位源的槽位0取高24位后相邻帧相同，按帧序号定位不唯一
+    if (opts.codec == AUDIO_CODEC_BFP && timing.sampleBytes == 3 && opts.channelMask == (1u << BENCH_SLOTS) - 1 &&
+        opts.beamOutput != AUDIO_BEAM_ONLY) {
+        BfpVerifyStats bfp = { 0 };
+        uint32_t verified = 0;
+        while (verified < files && verify_bfp(paths[verified], &sim, &verify, &bfp)) {
+            verified++;
+        }
+        if (verified < files) {
+            printf("Failed to read %s\n", paths[verified]);
+            verify.gaps++;
+        }
+        printf("Verify: %llu frames in %u file(s), %llu gaps (%llu at file boundaries), %llu frames %s\n",
+               (unsigned long long)verify.frames, (unsigned)verified, (unsigned long long)verify.gaps,
+               (unsigned long long)verify.boundaryGaps, (unsigned long long)verify.missing,
+               events ? "between events" : "missing");
+        contentVerified = true;
+        printf("Block floating point: %llu groups, %.1f%% lossless, mean exponent %.2f, worst error %.3f of the "
+               "bound, %.3f bytes per sample\n",
+               (unsigned long long)bfp.groups, bfp.groups ? 100.0 * bfp.lossless / bfp.groups : 0.0,
+               bfp.groups ? (double)bfp.exponentSum / bfp.groups : 0.0, bfp.worstError,
+               verify.frames ? (double)bfp.bytes / verify.frames / BENCH_SLOTS : 0.0);
+    }
+    // FLAC逐帧解码后与源逐样本比较（编码失败退回的VERBATIM帧同样要解码正确）
+    bool flacOk = true;
+    if (opts.codec == AUDIO_CODEC_FLAC && opts.channelMask == (1u << BENCH_SLOTS) - 1 &&
+        opts.beamOutput != AUDIO_BEAM_ONLY) {
+        FlacVerifyStats flac = { 0 };
+        uint32_t verified = 0;
+        while (verified < files && verify_flac(paths[verified], &sim, &verify, &flac)) {
+            verified++;
+        }
+        if (verified < files) {
+            printf("Failed to decode %s\n", paths[verified]);
+            verify.gaps++;
+        }
+        printf("Verify: %llu frames in %u file(s), %llu gaps (%llu at file boundaries), %llu frames %s\n",
+               (unsigned long long)verify.frames, (unsigned)verified, (unsigned long long)verify.gaps,
+               (unsigned long long)verify.boundaryGaps, (unsigned long long)verify.missing,
+               events ? "between events" : "missing");
+        contentVerified = true;
+        flacOk = flac.mismatches == 0;
+        printf("FLAC: %llu frames decoded, %llu of %llu samples differ from the source, ratio %.3f, subframes "
+               "%u/%u/%u/%u (constant/verbatim/fixed/lpc): %s\n",
+               (unsigned long long)flac.frames, (unsigned long long)flac.mismatches,
+               (unsigned long long)flac.samples, flac.samples ? (double)flac.bytes / (flac.samples * 2) : 0.0,
+               (unsigned)flac.subframes[0], (unsigned)flac.subframes[1], (unsigned)flac.subframes[2],
+               (unsigned)flac.subframes[3], flacOk ? "ok" : "MISMATCH");
+    }
+    // 录音内容校验过时，块索引记录的缺口必须与录音中的一一对应
+    bool indexOk = !contentVerified || verify_index(indexPaths, files, &timing, &verify);
+    bool countersOk = check_counters(&stats, &timing, input, lost, sim.dmaBufferFrames,
+                                     capture_pipeline_stage_enabled(&config), events,
+                                     contentVerified ? verify.frames : UINT64_MAX);
+    free(indexPaths);
+    bool eventsOk = !events || verify_events(eventPaths, files, &timing, stats.preRollBlocks, produced, sim.firstFrame,
+                                             (uint64_t)p->blocksCommitted * timing.blockFrames,
+                                             contentVerified ? &verify : NULL);
+    bool syncOk = true;
+    if (sync) {
+        SyncClockStatus status;
+        sync_clock_get_status(&syncClock, &status);
+        printf("Sync pulses: %u located, %u missed, %u glitches, %u outliers, %u stale, %u fit resets\n",
+               (unsigned)status.pulses, (unsigned)status.missed, (unsigned)status.glitches,
+               (unsigned)status.outliers, (unsigned)status.stale, (unsigned)status.resets);
+        syncOk = verify_sync(syncPaths, files, &sim);
+    }
+    // 波束文件的帧数要读WAV头，只检查PCM交织的录音
+    bool beamsOk = true;
+    if (opts.beams != 0 && opts.codec == AUDIO_CODEC_PCM && opts.layout == AUDIO_LAYOUT_INTERLEAVED) {
+        beamsOk = verify_beams(paths, beamPaths, files);
+    }
+    // 多采样率输出的帧数同样要读录音文件的WAV头；事件模式下每段录音重新开始抽取，不检查
+    bool ratesOk = true;
+    if (opts.rates.outputs != 0 && !events && opts.codec == AUDIO_CODEC_PCM && opts.layout == AUDIO_LAYOUT_INTERLEAVED) {
+        ratesOk = verify_rates(paths, ratePaths, files);
+    }
+    free(paths);
+    free(ratePaths);
+    free(eventPaths);
+    free(syncPaths);
+    bool doaOk = true;
+    if (opts.doaRateHz != 0 && !events) {
+        doaOk = verify_doa(doaPaths, files, &doa, input, lost);
+    }
+    bool featuresOk = true;
+    if (opts.featureMs != 0 && !events) {
+        featuresOk = verify_features(featurePaths, files, featureFrames, input, lost);
+    }
+    free(beamPaths);
+    free(doaPaths);
+    free(featurePaths);
+
+    if (opts.recordPath != NULL) {
+        if (!save_trace(opts.recordPath, &recordTrace, argc, argv)) {
+            return 1;
+        }
+        printf("Recorded %zu write latencies to %s\n", recordTrace.count, opts.recordPath);
+    }
+
+    // 连续录音时文件内和轮转边界上都不应有缺口，注入的写卡失败除外：每次失败正好丢一块
+    // （最后一块失败时录音末尾看不出缺口）；事件模式的缺口由verify_events与事件之间的间隔核对
+    bool continuous = events || (verify.gaps <= failedWrites && verify.missing == verify.gaps * timing.blockFrames);
+    return (p->overruns == 0 && p->writeErrors == failedWrites && p->flacFallbacks == 0 && continuous && eventsOk &&
+            indexOk && countersOk && flacOk && syncOk && beamsOk && doaOk && ratesOk && featuresOk) ? 0 : 1;
+}
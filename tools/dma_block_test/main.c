@@ -0,0 +1,274 @@
+// 零拷贝块组装器测试：用模拟DMA源(DmaSimSource)驱动DmaBlockAssembler，检查
+//   - 及时消费时每块的帧数、帧序号、帧指针（指向DMA环中对应的描述符）和样本计数都连续；
+//   - 环满时丢弃的帧数准确，之后的块从新的帧序号开始，缺口可由firstFrame算出；
+//   - 消费者落后任意帧数时，未被判为过期(is_stale)的块内容一定完好，且最多提前一帧判为过期；
+//   - 帧大小不符的帧被丢弃、半块可以丢弃、不合法的块几何被拒绝；
+// 最后测量每帧的组装开销。
+//
+// 用法: dma_block_test [-d 描述符数] [-b 每块DMA帧数] [-n 每个DMA帧的采样帧数] [-f 帧数]
+// 默认与设备的零拷贝配置相同（AudioCapture.h）。任何一项检查不通过时退出码为1。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include "DmaBlockSource.h"
+
+#define TEST_CHANNELS       8
+#define TEST_MAX_BLOCKS     64
+
+typedef struct {
+    DmaSimSource sim;
+    DmaBlockAssembler assembler;
+    DmaBlock blocks[TEST_MAX_BLOCKS];
+    uint32_t capacity;
+    uint32_t samplesPerFrame;
+} Fixture;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 模拟源的回调：帧直接交给组装器（相当于设备上的on_recv回调）
+static bool on_frame(void *ctx, const uint8_t *frame, size_t len) {
+    return dma_block_assembler_push(ctx, frame, len);
+}
+
+// 按设备上init_zero_copy的方式确定环的块数，并把模拟源接到组装器
+static bool fixture_init(Fixture *fx, uint32_t descNum, uint32_t framesPerBlock, uint32_t samplesPerFrame) {
+    memset(fx, 0, sizeof(*fx));
+    fx->capacity = (descNum - 1) / framesPerBlock - 1;
+    fx->capacity = (fx->capacity > TEST_MAX_BLOCKS) ? TEST_MAX_BLOCKS : fx->capacity;
+    fx->samplesPerFrame = samplesPerFrame;
+    size_t frameBytes = (size_t)samplesPerFrame * TEST_CHANNELS * sizeof(uint16_t);
+    if (fx->capacity == 0 || !dma_sim_source_init(&fx->sim, descNum, frameBytes, TEST_CHANNELS) ||
+        !dma_block_assembler_init(&fx->assembler, fx->blocks, fx->capacity, framesPerBlock, descNum)) {
+        return false;
+    }
+    return fx->sim.base.start(&fx->sim.base, on_frame, &fx->assembler);
+}
+
+static void fixture_deinit(Fixture *fx) {
+    fx->sim.base.stop(&fx->sim.base);
+    dma_sim_source_deinit(&fx->sim);
+}
+
+// 块的第k帧应指向DMA环中的哪个描述符
+static const uint8_t *expected_frame(const Fixture *fx, uint32_t frame) {
+    return fx->sim.dmaRing + (size_t)(frame % fx->sim.descNum) * fx->sim.frameBytes;
+}
+
+// 块中的样本计数是否与它的帧序号一致（所有通道都是同一个16位计数）
+static bool block_intact(const Fixture *fx, const DmaBlock *block) {
+    for (uint32_t k = 0; k < block->numFrames; k++) {
+        const uint16_t *s = (const uint16_t *)block->frames[k];
+        uint16_t counter = (uint16_t)((block->firstFrame + k) * fx->samplesPerFrame);
+        for (uint32_t i = 0; i < fx->samplesPerFrame; i++, counter++) {
+            for (uint32_t ch = 0; ch < TEST_CHANNELS; ch++) {
+                if (*s++ != counter) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// 及时消费：每凑满一块就检查并释放
+static bool test_prompt(uint32_t descNum, uint32_t framesPerBlock, uint32_t samplesPerFrame, uint32_t frames) {
+    Fixture fx;
+    if (!fixture_init(&fx, descNum, framesPerBlock, samplesPerFrame)) {
+        printf("Prompt consumer: init failed\n");
+        return false;
+    }
+    uint32_t completed = 0, blocks = 0, errors = 0, nextFrame = 0;
+    for (uint32_t f = 0; f < frames; f++) {
+        completed += dma_sim_source_run(&fx.sim, 1);
+        uint32_t slot;
+        while (block_ring_peek(&fx.assembler.ring, &slot)) {
+            const DmaBlock *block = &fx.blocks[slot];
+            bool ok = block->numFrames == framesPerBlock && block->firstFrame == nextFrame &&
+                      block->frameBytes == fx.sim.frameBytes && !dma_block_assembler_is_stale(&fx.assembler, block) &&
+                      block_intact(&fx, block);
+            for (uint32_t k = 0; k < block->numFrames && ok; k++) {
+                ok = block->frames[k] == expected_frame(&fx, block->firstFrame + k);
+            }
+            errors += ok ? 0 : 1;
+            nextFrame = block->firstFrame + block->numFrames;
+            blocks++;
+            block_ring_release(&fx.assembler.ring);
+        }
+    }
+    uint32_t dropped = atomic_load(&fx.assembler.droppedFrames);
+    bool ok = errors == 0 && dropped == 0 && blocks == frames / framesPerBlock && completed == blocks;
+    printf("Prompt consumer:   %u frames -> %u blocks, %u bad, %u dropped frames: %s\n", (unsigned)frames,
+           (unsigned)blocks, (unsigned)errors, (unsigned)dropped, ok ? "ok" : "FAILED");
+    fixture_deinit(&fx);
+    return ok;
+}
+
+// 环满：消费者停住时多出的帧被丢弃，恢复后的块从新的帧序号开始
+static bool test_full(uint32_t descNum, uint32_t framesPerBlock, uint32_t samplesPerFrame) {
+    Fixture fx;
+    if (!fixture_init(&fx, descNum, framesPerBlock, samplesPerFrame)) {
+        printf("Ring full: init failed\n");
+        return false;
+    }
+    uint32_t fill = fx.capacity * framesPerBlock;
+    uint32_t extra = 3 * framesPerBlock + 1;
+    uint32_t completed = dma_sim_source_run(&fx.sim, fill + extra);
+    uint32_t dropped = atomic_load(&fx.assembler.droppedFrames);
+    bool ok = completed == fx.capacity && dropped == extra;
+
+    // 停住期间DMA已绕回，环里最早的块必须判为过期
+    uint32_t slot, stale = 0;
+    while (block_ring_peek(&fx.assembler.ring, &slot)) {
+        const DmaBlock *block = &fx.blocks[slot];
+        bool isStale = dma_block_assembler_is_stale(&fx.assembler, block);
+        stale += isStale ? 1 : 0;
+        ok = ok && (isStale || block_intact(&fx, block));
+        block_ring_release(&fx.assembler.ring);
+    }
+    ok = ok && stale > 0;
+
+    // 恢复后下一块从丢弃之后的第一帧开始：与上一块末尾的差就是缺口
+    dma_sim_source_run(&fx.sim, framesPerBlock);
+    uint32_t gap = 0;
+    if (block_ring_peek(&fx.assembler.ring, &slot)) {
+        gap = fx.blocks[slot].firstFrame - fill;
+        ok = ok && block_intact(&fx, &fx.blocks[slot]);
+    } else {
+        ok = false;
+    }
+    ok = ok && gap == extra;
+    printf("Ring full:         %u blocks, %u frames dropped, %u stale, next block after a %u-frame gap: %s\n",
+           (unsigned)completed, (unsigned)dropped, (unsigned)stale, (unsigned)gap, ok ? "ok" : "FAILED");
+    fixture_deinit(&fx);
+    return ok;
+}
+
+// 消费者落后lag帧：判为未过期的块必须完好，判为过期最多比真正被覆盖早一帧
+// （收到第n帧时DMA已经开始写下一帧）
+static bool test_stale(uint32_t descNum, uint32_t framesPerBlock, uint32_t samplesPerFrame) {
+    uint32_t unsafe = 0, early = 0, flagged = 0;
+    for (uint32_t lag = 0; lag <= 2 * descNum; lag++) {
+        Fixture fx;
+        if (!fixture_init(&fx, descNum, framesPerBlock, samplesPerFrame)) {
+            printf("Stale detection: init failed\n");
+            return false;
+        }
+        dma_sim_source_run(&fx.sim, framesPerBlock + lag);
+        uint32_t slot;
+        if (!block_ring_peek(&fx.assembler.ring, &slot)) {
+            fixture_deinit(&fx);
+            return false;
+        }
+        const DmaBlock *block = &fx.blocks[slot];
+        bool isStale = dma_block_assembler_is_stale(&fx.assembler, block);
+        bool overwritten = framesPerBlock + lag > descNum;   // 第firstFrame帧的描述符已被重新写入
+        unsafe += (!isStale && !block_intact(&fx, block)) ? 1 : 0;
+        early += (isStale && framesPerBlock + lag < descNum) ? 1 : 0;
+        flagged += isStale ? 1 : 0;
+        unsafe += (overwritten && !isStale) ? 1 : 0;
+        fixture_deinit(&fx);
+    }
+    bool ok = unsafe == 0 && early == 0 && flagged > 0;
+    printf("Stale detection:   lag 0..%u frames, %u flagged, %u missed overwrites, %u flagged early: %s\n",
+           (unsigned)(2 * descNum), (unsigned)flagged, (unsigned)unsafe, (unsigned)early, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// 帧大小不符、丢弃半块和不合法的几何
+static bool test_edges(uint32_t descNum, uint32_t framesPerBlock, uint32_t samplesPerFrame) {
+    Fixture fx;
+    if (!fixture_init(&fx, descNum, framesPerBlock, samplesPerFrame)) {
+        printf("Edge cases: init failed\n");
+        return false;
+    }
+    DmaBlockAssembler *a = &fx.assembler;
+    bool ok = true;
+
+    // 帧大小与第一帧不同：丢弃，不影响正在组装的块
+    dma_sim_source_run(&fx.sim, 1);
+    ok = ok && !dma_block_assembler_push(a, fx.sim.dmaRing, fx.sim.frameBytes / 2);
+    ok = ok && atomic_load(&a->droppedFrames) == 1 && a->fill == 1;
+
+    // 停止时丢弃半块：下一块从新的帧开始，环中没有残留
+    dma_block_assembler_abort_partial(a);
+    uint32_t slot;
+    ok = ok && !block_ring_peek(&a->ring, &slot);
+    uint32_t restart = fx.sim.frameIndex;
+    ok = ok && dma_sim_source_run(&fx.sim, framesPerBlock) == 1 && block_ring_peek(&a->ring, &slot);
+    // 大小不符的帧也占一个帧序号，所以帧序号比模拟源多1；帧指针仍是模拟源刚写的描述符
+    ok = ok && fx.blocks[slot].firstFrame == restart + 1 && fx.blocks[slot].frames[0] == expected_frame(&fx, restart);
+
+    // 环中的块加上正在组装的块必须都留在DMA环中
+    DmaBlockAssembler other;
+    DmaBlock blocks[TEST_MAX_BLOCKS];
+    ok = ok && !dma_block_assembler_init(&other, blocks, 4, 4, 20);
+    ok = ok && dma_block_assembler_init(&other, blocks, 4, 4, 21);
+    ok = ok && !dma_block_assembler_init(&other, blocks, 1, DMA_BLOCK_MAX_FRAMES + 1, 1000);
+    ok = ok && !dma_block_assembler_init(&other, blocks, 0, 4, 1000);
+    printf("Edge cases:        size mismatch, partial block and geometry checks: %s\n", ok ? "ok" : "FAILED");
+    fixture_deinit(&fx);
+    return ok;
+}
+
+// 组装开销：不含模拟源生成样本的时间
+static void bench(uint32_t descNum, uint32_t framesPerBlock, uint32_t samplesPerFrame, uint32_t frames) {
+    Fixture fx;
+    if (!fixture_init(&fx, descNum, framesPerBlock, samplesPerFrame)) {
+        return;
+    }
+    double t0 = now_sec();
+    for (uint32_t f = 0; f < frames; f++) {
+        const uint8_t *frame = expected_frame(&fx, f);
+        if (dma_block_assembler_push(&fx.assembler, frame, fx.sim.frameBytes)) {
+            uint32_t slot;
+            while (block_ring_peek(&fx.assembler.ring, &slot)) {
+                block_ring_release(&fx.assembler.ring);
+            }
+        }
+    }
+    double sec = now_sec() - t0;
+    printf("Assembly: %.1f ns per DMA frame (%u-sample frames, %.0f MB/s of audio)\n", sec * 1e9 / frames,
+           (unsigned)samplesPerFrame, (double)frames * fx.sim.frameBytes / sec / 1e6);
+    fixture_deinit(&fx);
+}
+
+int main(int argc, char **argv) {
+    uint32_t descNum = 96;          // AUDIO_ZC_DMA_DESC_NUM
+    uint32_t framesPerBlock = 16;   // AUDIO_ZC_FRAMES_PER_BLOCK
+    uint32_t samplesPerFrame = 128; // AUDIO_ZC_DMA_FRAME_NUM
+    uint32_t frames = 200000;
+    int c;
+    while ((c = getopt(argc, argv, "d:b:n:f:h")) != -1) {
+        switch (c) {
+        case 'd': descNum = strtoul(optarg, NULL, 0); break;
+        case 'b': framesPerBlock = strtoul(optarg, NULL, 0); break;
+        case 'n': samplesPerFrame = strtoul(optarg, NULL, 0); break;
+        case 'f': frames = strtoul(optarg, NULL, 0); break;
+        default:
+            printf("Usage: %s [-d dma_descriptors] [-b dma_frames_per_block] [-n samples_per_dma_frame] "
+                   "[-f frames]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (framesPerBlock == 0 || framesPerBlock > DMA_BLOCK_MAX_FRAMES || samplesPerFrame == 0 ||
+        descNum <= 2 * framesPerBlock + 1 || frames == 0) {
+        return 2;
+    }
+
+    printf("DMA ring: %u descriptors x %u frames, %u DMA frames per block\n", (unsigned)descNum,
+           (unsigned)samplesPerFrame, (unsigned)framesPerBlock);
+    bool ok = test_prompt(descNum, framesPerBlock, samplesPerFrame, frames);
+    ok = test_full(descNum, framesPerBlock, samplesPerFrame) && ok;
+    ok = test_stale(descNum, framesPerBlock, samplesPerFrame) && ok;
+    ok = test_edges(descNum, framesPerBlock, samplesPerFrame) && ok;
+    bench(descNum, framesPerBlock, samplesPerFrame, frames * 10);
+    printf("Assembler checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,370 @@
+// 声源方位估计基准：检查DspRealFft和DoaEstimator，再测量不同帧长和麦克风对数的实时系数（处理耗时/音频时长）：
+//   - 实FFT：与直接计算的DFT比较，逆变换回到原信号；
+//   - 精度：合成的白噪声平面波（按麦克风位置用加窗sinc插值精确延迟）从若干方位到达，
+//     无噪声和各路加不相关白噪声（信噪比-s）时所有结果的均方根方位误差；
+//   - 置信度：只有不相关噪声时的平均置信度应明显低于有声源时；
+//   - 流式：按不同块长送入同一信号，结果逐个相同；输入不连续时重新开始分析帧。
+//
+// 用法: doa_bench [-m 麦克风数] [-a 圆阵半径mm | -l 线阵间距mm] [-r 采样率] [-n 帧长] [-o 重叠%]
+//                 [-R 每秒结果数] [-p] [-s 信噪比dB] [-t 秒]
+//   -p  精度检查只用对径的麦克风对（第m个和第m + 麦克风数/2个），默认所有麦克风两两配对
+// 直线阵列关于阵列轴前后对称，误差按折叠到0..180°的方位计算，离阵列轴30°以内的方位不检查。检查不通过时退出码为1。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <getopt.h>
+#include <time.h>
+#include "DspRealFft.h"
+#include "DoaEstimator.h"
+
+#define SOURCE_TAPS         32      // 分数延迟插值的单侧抽头数
+#define SOURCE_MAX_LEAD     0.01    // 麦克风离原点最远10ms（3.4m）
+#define MAX_FFT_ERROR       1e-5
+#define MAX_CLEAN_RMS_DEG   0.5
+#define MAX_NOISY_RMS_DEG   3.0
+#define MAX_NOISE_CONF      0.5     // 只有噪声时的平均置信度不超过有声源时的这个比例
+#define MAX_REPORTS         256
+#define LINEAR_MIN_ANGLE    30.0    // 直线阵列：靠近阵列轴（端射方向）时时延随方位几乎不变，不检查
+
+static const double testAzimuth[] = { 0, 20, 45, 90, 135, 170, 200, 250, 300, 345 };
+#define TEST_AZIMUTHS   (sizeof(testAzimuth) / sizeof(testAzimuth[0]))
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 伪随机数（xorshift），[-1, 1)
+static uint32_t rngState = 0x6C078965;
+static double noise(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return (double)(int32_t)rngState / 2147483648.0;
+}
+
+static int16_t quantize(double x) {
+    long v = lround(x * 32767.0);
+    return (int16_t)((v > 32767) ? 32767 : (v < -32768) ? -32768 : v);
+}
+
+// 从方位角azDeg来的平面波加各路不相关的白噪声。声源是白噪声，RMS约-12dBFS，各路的到达时间差
+// 用加窗sinc插值精确实现（只关心远低于奈奎斯特频率的频带）；snrDb为正无穷时没有噪声，
+// withSignal为false时只有噪声（功率与有信号时的噪声相同）
+static void synthesize(int16_t *in, uint32_t frames, uint32_t mics, const DoaConfig *config, double azDeg,
+                       double sampleRate, double snrDb, bool withSignal) {
+    uint32_t margin = SOURCE_TAPS + (uint32_t)ceil(SOURCE_MAX_LEAD * sampleRate);
+    uint32_t length = frames + 2 * margin;
+    float *src = malloc(length * sizeof(float));
+    if (src == NULL) {
+        exit(1);
+    }
+    for (uint32_t n = 0; n < length; n++) {
+        src[n] = (float)(0.25 * sqrt(3.0) * noise());
+    }
+    double noiseRms = isinf(snrDb) ? 0.0 : 0.25 * pow(10.0, -snrDb / 20.0);
+    double az = azDeg * M_PI / 180.0;
+    double ux = cos(az), uy = sin(az);
+
+    for (uint32_t m = 0; m < mics; m++) {
+        // 第n帧对应声源的margin + n + lead x 采样率
+        double lead = (config->mic[m].x * ux + config->mic[m].y * uy) / BEAMFORMER_SOUND_SPEED * sampleRate;
+        double base = floor(lead);
+        double frac = lead - base;
+        double h[2 * SOURCE_TAPS];
+        for (int k = 0; k < 2 * SOURCE_TAPS; k++) {
+            double t = k - (SOURCE_TAPS - 1) - frac;
+            double sinc = (fabs(t) < 1e-12) ? 1.0 : sin(M_PI * t) / (M_PI * t);
+            h[k] = sinc * (0.42 + 0.5 * cos(M_PI * t / SOURCE_TAPS) + 0.08 * cos(2.0 * M_PI * t / SOURCE_TAPS));
+        }
+        for (uint32_t n = 0; n < frames; n++) {
+            const float *s = src + margin + n + (int64_t)base - (SOURCE_TAPS - 1);
+            double x = 0;
+            for (int k = 0; k < 2 * SOURCE_TAPS; k++) {
+                x += h[k] * s[k];
+            }
+            x = withSignal ? x : 0.0;
+            x += noiseRms * sqrt(3.0) * noise();
+            in[(size_t)n * mics + m] = quantize(x);
+        }
+    }
+    free(src);
+}
+
+// DspRealFft与直接计算的DFT比较，返回最大的相对误差
+static double check_fft(uint32_t n) {
+    DspRealFft fft;
+    if (!dsp_real_fft_init(&fft, n)) {
+        return INFINITY;
+    }
+    float *x = malloc(n * sizeof(float));
+    float *y = malloc(n * sizeof(float));
+    float *re = malloc((n / 2 + 1) * sizeof(float));
+    float *im = malloc((n / 2 + 1) * sizeof(float));
+    for (uint32_t i = 0; i < n; i++) {
+        x[i] = (float)noise();
+    }
+    dsp_real_fft_forward(&fft, x, re, im);
+
+    double err = 0, ref = 0;
+    for (uint32_t k = 0; k <= n / 2; k++) {
+        double sr = 0, si = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            double a = -2.0 * M_PI * (double)((uint64_t)i * k % n) / n;
+            sr += x[i] * cos(a);
+            si += x[i] * sin(a);
+        }
+        err += (sr - re[k]) * (sr - re[k]) + (si - im[k]) * (si - im[k]);
+        ref += sr * sr + si * si;
+    }
+    double forward = sqrt(err / ref);
+
+    dsp_real_fft_inverse(&fft, re, im, y);
+    err = ref = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        err += (double)(x[i] - y[i]) * (x[i] - y[i]);
+        ref += (double)x[i] * x[i];
+    }
+    double inverse = sqrt(err / ref);
+
+    free(x);
+    free(y);
+    free(re);
+    free(im);
+    dsp_real_fft_deinit(&fft);
+    return (forward > inverse) ? forward : inverse;
+}
+
+// 按blockFrames一块一块送入frames帧，返回结果数
+static uint32_t run(DoaEstimator *est, const int16_t *in, uint32_t frames, uint32_t blockFrames, uint64_t firstSample,
+                    DoaEstimate *out, uint32_t maxOut) {
+    uint32_t count = 0;
+    doa_estimator_reset(est);
+    for (uint32_t n = 0; n < frames; n += blockFrames) {
+        uint32_t len = (frames - n < blockFrames) ? frames - n : blockFrames;
+        count += doa_estimator_feed(est, in + (size_t)n * est->channels, len, firstSample + n, out + count,
+                                    maxOut - count);
+    }
+    return count;
+}
+
+// 对径的麦克风对：第m个和第m + mics/2个
+static void opposite_pairs(DoaConfig *config, uint32_t mics) {
+    for (uint32_t m = 0; m < mics / 2; m++) {
+        config->pair[m][0] = (uint8_t)m;
+        config->pair[m][1] = (uint8_t)(m + mics / 2);
+    }
+    config->pairs = mics / 2;
+}
+
+// 方位误差（度），直线阵列先折叠到0..180°
+static double azimuth_error(double estimate, double truth, bool linear) {
+    if (linear) {
+        estimate = (estimate > 180.0) ? 360.0 - estimate : estimate;
+        truth = (truth > 180.0) ? 360.0 - truth : truth;
+        return fabs(estimate - truth);
+    }
+    double d = fmod(fabs(estimate - truth), 360.0);
+    return (d > 180.0) ? 360.0 - d : d;
+}
+
+// 所有测试方位上的均方根误差和平均置信度
+static void accuracy(DoaEstimator *est, const DoaConfig *config, int16_t *in, uint32_t frames, uint32_t mics,
+                     double sampleRate, double snrDb, bool linear, double *rmsDeg, double *meanConf,
+                     double *worstDeg) {
+    static DoaEstimate out[MAX_REPORTS];
+    double sumSq = 0, conf = 0;
+    uint32_t total = 0;
+    *worstDeg = 0;
+    for (size_t a = 0; a < TEST_AZIMUTHS; a++) {
+        double folded = (testAzimuth[a] > 180.0) ? 360.0 - testAzimuth[a] : testAzimuth[a];
+        if (linear && (folded < LINEAR_MIN_ANGLE || folded > 180.0 - LINEAR_MIN_ANGLE)) {
+            continue;
+        }
+        synthesize(in, frames, mics, config, testAzimuth[a], sampleRate, snrDb, true);
+        uint32_t count = run(est, in, frames, 4096, 0, out, MAX_REPORTS);
+        for (uint32_t i = 0; i < count; i++) {
+            double e = azimuth_error(out[i].azimuthDeg, testAzimuth[a], linear);
+            sumSq += e * e;
+            conf += out[i].confidence;
+            *worstDeg = (e > *worstDeg) ? e : *worstDeg;
+        }
+        total += count;
+    }
+    *rmsDeg = (total > 0) ? sqrt(sumSq / total) : INFINITY;
+    *meanConf = (total > 0) ? conf / total : 0.0;
+}
+
+int main(int argc, char **argv) {
+    uint32_t mics = 8;
+    double radiusMm = 40.0;
+    double spacingMm = 0.0;
+    uint32_t sampleRate = 96000;
+    uint32_t frameSize = 1024;
+    uint32_t overlapPct = 50;
+    uint32_t reportHz = 20;
+    double snrDb = 0.0;
+    uint32_t seconds = 5;
+    bool oppositeOnly = false;
+    int c;
+    while ((c = getopt(argc, argv, "m:a:l:r:n:o:R:ps:t:h")) != -1) {
+        switch (c) {
+        case 'm': mics = strtoul(optarg, NULL, 0); break;
+        case 'a': radiusMm = atof(optarg); break;
+        case 'l': spacingMm = atof(optarg); break;
+        case 'r': sampleRate = strtoul(optarg, NULL, 0); break;
+        case 'n': frameSize = strtoul(optarg, NULL, 0); break;
+        case 'o': overlapPct = strtoul(optarg, NULL, 0); break;
+        case 'R': reportHz = strtoul(optarg, NULL, 0); break;
+        case 'p': oppositeOnly = true; break;
+        case 's': snrDb = atof(optarg); break;
+        case 't': seconds = strtoul(optarg, NULL, 0); break;
+        default:
+            printf("Usage: %s [-m mics] [-a radius_mm | -l spacing_mm] [-r sample_rate] [-n frame_size]\n"
+                   "          [-o overlap_pct] [-R reports_per_second] [-p] [-s snr_db] [-t seconds]\n",
+                   argv[0]);
+            return 2;
+        }
+    }
+    if (mics < 2 || mics > BEAMFORMER_MAX_MICS || sampleRate == 0 || overlapPct >= 100 || reportHz == 0 ||
+        seconds == 0 || radiusMm <= 0.0 || spacingMm < 0.0) {
+        return 2;
+    }
+    int failures = 0;
+
+    // 实FFT
+    double fftError = 0;
+    for (uint32_t n = DOA_MIN_FRAME; n <= DOA_MAX_FRAME; n *= 2) {
+        double e = check_fft(n);
+        fftError = (e > fftError) ? e : fftError;
+    }
+    printf("Real FFT %u..%u:    max relative error %.1e (max %.0e)\n", DOA_MIN_FRAME, DOA_MAX_FRAME, fftError,
+           MAX_FFT_ERROR);
+    failures += !(fftError <= MAX_FFT_ERROR);
+
+    DoaConfig config = {
+        .frameSize = frameSize,
+        .hopFrames = frameSize - frameSize * overlapPct / 100,
+        .reportFrames = sampleRate / reportHz,
+        .minHz = 300.0f,
+        .maxHz = 8000.0f,
+    };
+    BeamformerConfig geometry = { 0 };
+    bool linear = spacingMm > 0.0;
+    if (linear) {
+        beamformer_linear_array(&geometry, mics, (float)(spacingMm / 1000.0));
+        printf("Linear array: %u mics, %.1f mm spacing", (unsigned)mics, spacingMm);
+    } else {
+        beamformer_circular_array(&geometry, mics, (float)(radiusMm / 1000.0));
+        printf("Circular array: %u mics, %.1f mm radius", (unsigned)mics, radiusMm);
+    }
+    memcpy(config.mic, geometry.mic, sizeof(config.mic));
+    if (oppositeOnly) {
+        opposite_pairs(&config, mics);
+    }
+    printf(", %u Hz, %u-frame windows, %u%% overlap, %u reports/s\n", (unsigned)sampleRate, (unsigned)frameSize,
+           (unsigned)overlapPct, (unsigned)reportHz);
+
+    uint32_t slotMask = (1u << mics) - 1;
+    DoaEstimator est;
+    if (!doa_estimator_init(&est, &config, (float)sampleRate, slotMask)) {
+        printf("Failed to set up the estimator\n");
+        return 1;
+    }
+    printf("%u pairs, lags +-%u, %u windows per report\n", (unsigned)est.pairs, (unsigned)est.maxLag,
+           (unsigned)est.windowsPerReport);
+
+    uint32_t frames = sampleRate / 2;   // 每个方位0.5秒
+    int16_t *in = malloc((size_t)sampleRate * mics * sizeof(int16_t));
+    static DoaEstimate out[MAX_REPORTS], ref[MAX_REPORTS];
+    if (in == NULL) {
+        return 1;
+    }
+
+    // 精度：无噪声和有噪声
+    double rms, conf, worst, noisyRms, noisyConf, noisyWorst;
+    accuracy(&est, &config, in, frames, mics, sampleRate, INFINITY, linear, &rms, &conf, &worst);
+    printf("Clean:              RMS error %5.2f deg, worst %5.2f (max RMS %.1f), confidence %.2f\n", rms, worst,
+           MAX_CLEAN_RMS_DEG, conf);
+    failures += !(rms <= MAX_CLEAN_RMS_DEG);
+    accuracy(&est, &config, in, frames, mics, sampleRate, snrDb, linear, &noisyRms, &noisyConf, &noisyWorst);
+    printf("SNR %5.1f dB:       RMS error %5.2f deg, worst %5.2f (max RMS %.1f), confidence %.2f\n", snrDb,
+           noisyRms, noisyWorst, MAX_NOISY_RMS_DEG, noisyConf);
+    failures += !(noisyRms <= MAX_NOISY_RMS_DEG);
+
+    // 置信度：只有噪声
+    synthesize(in, frames, mics, &config, 0.0, sampleRate, 0.0, false);
+    uint32_t count = run(&est, in, frames, 4096, 0, out, MAX_REPORTS);
+    double noiseConf = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        noiseConf += out[i].confidence;
+    }
+    noiseConf = (count > 0) ? noiseConf / count : 1.0;
+    printf("Noise only:         confidence %.2f (max %.2f)\n", noiseConf, conf * MAX_NOISE_CONF);
+    failures += !(noiseConf <= conf * MAX_NOISE_CONF);
+
+    // 流式：块长不同（包括不整除的块长）时结果相同，结果的时间落在各自覆盖的帧中间
+    synthesize(in, frames, mics, &config, 60.0, sampleRate, snrDb, true);
+    count = run(&est, in, frames, 4096, 1000, out, MAX_REPORTS);
+    uint32_t refCount = run(&est, in, frames, 777, 1000, ref, MAX_REPORTS);
+    bool same = count == refCount && count > 0;
+    for (uint32_t i = 0; same && i < count; i++) {
+        same = out[i].samplePos == ref[i].samplePos && out[i].azimuthDeg == ref[i].azimuthDeg &&
+               out[i].confidence == ref[i].confidence && out[i].windows == ref[i].windows;
+    }
+    uint64_t span = (uint64_t)(est.windowsPerReport - 1) * est.hopFrames + frameSize;
+    same = same && out[0].samplePos == 1000 + span / 2;
+    printf("Block continuity:   %s (%u reports, 4096 vs 777 frames per block)\n", same ? "identical" : "MISMATCH",
+           (unsigned)count);
+    failures += !same;
+
+    // 不连续：第二段从更晚的样本开始，第一个结果完全来自第二段
+    doa_estimator_reset(&est);
+    uint32_t half = frames / 2;
+    count = doa_estimator_feed(&est, in, half, 0, out, MAX_REPORTS);
+    uint32_t after = doa_estimator_feed(&est, in + (size_t)half * mics, half, half + 12345, out + count,
+                                        MAX_REPORTS - count);
+    bool restarted = after > 0 && out[count].samplePos == half + 12345 + span / 2;
+    printf("Gap restart:        %s\n", restarted ? "ok" : "FAILED");
+    failures += !restarted;
+    doa_estimator_deinit(&est);
+
+    // 实时系数：seconds秒有噪声的信号，所有麦克风两两配对和只用对径的麦克风对
+    synthesize(in, sampleRate, mics, &config, 60.0, sampleRate, snrDb, true);
+    static const uint32_t frameSizes[] = { 512, 1024, 2048 };
+    for (size_t i = 0; i < sizeof(frameSizes) / sizeof(frameSizes[0]); i++) {
+        for (int opposite = 0; opposite < 2; opposite++) {
+            config.frameSize = frameSizes[i];
+            config.hopFrames = frameSizes[i] - frameSizes[i] * overlapPct / 100;
+            config.pairs = 0;
+            if (opposite) {
+                opposite_pairs(&config, mics);
+            }
+            if (!doa_estimator_init(&est, &config, (float)sampleRate, slotMask)) {
+                printf("Failed to set up %u-frame windows\n", (unsigned)frameSizes[i]);
+                return 1;
+            }
+            volatile uint32_t sink = 0;
+            double t0 = now_sec();
+            for (uint32_t s = 0; s < seconds; s++) {
+                sink += run(&est, in, sampleRate, 2048, (uint64_t)s * sampleRate, out, MAX_REPORTS);
+            }
+            double elapsed = now_sec() - t0;
+            double rtf = elapsed / seconds;
+            printf("%4u frames, %2u pairs: %7.2f ns/frame, real-time factor %.4f (host)\n",
+                   (unsigned)frameSizes[i], (unsigned)est.pairs, elapsed * 1e9 / ((double)sampleRate * seconds),
+                   rtf);
+            doa_estimator_deinit(&est);
+        }
+    }
+
+    free(in);
+    if (failures != 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,361 @@
+// DSP块内核基准：先用黄金向量检查可移植的C实现，用逐样本的参考循环检查1~8通道、奇偶帧数的
+// 16/32位解交织，以及8通道和16通道每一个掩码的通道压缩（任一不一致时退出码为1），
+// 再测量各内核在一个采集块上的吞吐量（8通道交织int16），解交织另测8x32位，并与逐样本循环对比；
+// 通道压缩测整对和隔一个通道的掩码。
+//
+// 用法: dsp_bench [-f 每块帧数] [-n 重复次数] [-c 只做正确性检查]
+// 主机上只有C实现；ESP32-S3上的PIE路径由dsp_init在启动时用同一组向量检查。
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include "DspBlock.h"
+#include "DspGolden.h"
+#include "Deinterleave.h"
+#include "ChannelCompact.h"
+
+#define BENCH_CHANNELS  8
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 伪随机噪声（xorshift）
+static uint32_t rngState = 0x9E3779B9;
+static int16_t noise(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return (int16_t)(rngState >> 16);
+}
+
+static void report_bytes(const char *name, double seconds, uint32_t frames, uint32_t reps, uint32_t sampleBytes) {
+    double totalFrames = (double)frames * reps;
+    printf("%-26s %8.2f ns/frame %9.1f MB/s\n", name, seconds * 1e9 / totalFrames,
+           totalFrames * BENCH_CHANNELS * sampleBytes / seconds / 1e6);
+}
+
+static void report(const char *name, double seconds, uint32_t frames, uint32_t reps) {
+    report_bytes(name, seconds, frames, reps, sizeof(int16_t));
+}
+
+// 逐样本的参考解交织（也是基准中对比的朴素循环）
+static void reference_s16(const int16_t *in, int16_t *out, uint32_t channels, uint32_t frames) {
+    for (uint32_t i = 0; i < frames; i++) {
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            out[(size_t)ch * frames + i] = in[(size_t)i * channels + ch];
+        }
+    }
+}
+
+static void reference_s32(const int32_t *in, int32_t *out, uint32_t channels, uint32_t frames) {
+    for (uint32_t i = 0; i < frames; i++) {
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            out[(size_t)ch * frames + i] = in[(size_t)i * channels + ch];
+        }
+    }
+}
+
+// 1~8通道、几种奇偶帧数的解交织与参考结果逐样本比较，返回不一致的组合数
+static uint32_t check_deinterleave(void) {
+    static const uint32_t frameCounts[] = { 1, 2, 3, 7, 64, 255, 2048 };
+    uint32_t maxSamples = 2048 * 8;
+    int16_t *in16 = aligned_alloc(16, maxSamples * sizeof(int16_t));
+    int16_t *out16 = aligned_alloc(16, maxSamples * sizeof(int16_t));
+    int16_t *ref16 = aligned_alloc(16, maxSamples * sizeof(int16_t));
+    int32_t *in32 = aligned_alloc(16, maxSamples * sizeof(int32_t));
+    int32_t *out32 = aligned_alloc(16, maxSamples * sizeof(int32_t));
+    int32_t *ref32 = aligned_alloc(16, maxSamples * sizeof(int32_t));
+    uint32_t failures = 0, cases = 0;
+    for (uint32_t i = 0; i < maxSamples; i++) {
+        in16[i] = noise();
+        in32[i] = (int32_t)(((uint32_t)(uint16_t)noise() << 16) | (uint16_t)noise());
+    }
+    for (uint32_t channels = 1; channels <= BENCH_CHANNELS; channels++) {
+        for (size_t f = 0; f < sizeof(frameCounts) / sizeof(frameCounts[0]); f++) {
+            uint32_t frames = frameCounts[f];
+            size_t n = (size_t)channels * frames;
+            reference_s16(in16, ref16, channels, frames);
+            memset(out16, 0x5A, maxSamples * sizeof(int16_t));
+            deinterleave_s16(in16, out16, channels, frames);
+            // 平面之后的输出不能被写到
+            bool ok16 = memcmp(out16, ref16, n * sizeof(int16_t)) == 0 &&
+                        (n == maxSamples || out16[n] == 0x5A5A);
+            reference_s32(in32, ref32, channels, frames);
+            memset(out32, 0x5A, maxSamples * sizeof(int32_t));
+            deinterleave_s32(in32, out32, channels, frames);
+            bool ok32 = memcmp(out32, ref32, n * sizeof(int32_t)) == 0 &&
+                        (n == maxSamples || out32[n] == 0x5A5A5A5A);
+            if (!ok16 || !ok32) {
+                printf("Deinterleave %u channels x %u frames: %s%s differs from the reference\n",
+                       (unsigned)channels, (unsigned)frames, ok16 ? "" : "s16 ", ok32 ? "" : "s32");
+                failures++;
+            }
+            cases++;
+        }
+    }
+    printf("Deinterleave: %u of %u layouts match the reference (s16 and s32)\n", (unsigned)(cases - failures),
+           (unsigned)cases);
+    free(in16);
+    free(out16);
+    free(ref16);
+    free(in32);
+    free(out32);
+    free(ref32);
+    return failures;
+}
+
+// 逐样本的参考通道压缩
+static uint32_t reference_compact(const uint8_t *in, uint8_t *out, uint32_t sampleBytes, uint32_t channels,
+                                  uint32_t mask, uint32_t frames) {
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < frames; i++) {
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            if (mask & (1u << ch)) {
+                memcpy(out + (size_t)kept++ * sampleBytes, in + ((size_t)i * channels + ch) * sampleBytes,
+                       sampleBytes);
+            }
+        }
+    }
+    return frames ? kept / frames : 0;
+}
+
+// 对一个(通道数, 掩码, 帧数)组合检查16位内核（异地和原地）和2/3/4字节的通用内核
+static bool check_compact_case(const uint8_t *in, uint8_t *out, uint8_t *ref, uint32_t channels, uint32_t mask,
+                               uint32_t frames) {
+    uint32_t expected = channel_mask_count(mask, channels);
+    for (uint32_t sampleBytes = 2; sampleBytes <= 4; sampleBytes++) {
+        size_t bytes = (size_t)frames * channels * sampleBytes;
+        uint32_t kept = reference_compact(in, ref, sampleBytes, channels, mask, frames);
+        size_t keptBytes = (size_t)frames * expected * sampleBytes;
+        if (kept != expected && frames != 0) {
+            return false;
+        }
+        // 异地：保留的样本之后不能被写到
+        memset(out, 0xA5, bytes + 4);
+        if (channel_compact_bytes(in, out, sampleBytes, channels, mask, frames) != expected ||
+            memcmp(out, ref, keptBytes) != 0 || out[keptBytes] != 0xA5) {
+            return false;
+        }
+        // 原地
+        memcpy(out, in, bytes);
+        if (channel_compact_bytes(out, out, sampleBytes, channels, mask, frames) != expected ||
+            memcmp(out, ref, keptBytes) != 0) {
+            return false;
+        }
+        if (sampleBytes == 2) {
+            memset(out, 0xA5, bytes + 4);
+            if (channel_compact_s16((const int16_t *)in, (int16_t *)out, channels, mask, frames) != expected ||
+                memcmp(out, ref, keptBytes) != 0 || out[keptBytes] != 0xA5) {
+                return false;
+            }
+            memcpy(out, in, bytes);
+            if (channel_compact_s16((int16_t *)out, (int16_t *)out, channels, mask, frames) != expected ||
+                memcmp(out, ref, keptBytes) != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// 8通道（设备的TDM槽位数）每个掩码配几种奇偶帧数，16通道每个掩码一种帧数；
+// 掩码中超出通道数的位必须被忽略。返回不一致的组合数
+static uint32_t check_channel_compact(void) {
+    static const uint32_t frameCounts[] = { 0, 1, 2, 5, 64, 2047 };
+    size_t maxBytes = (size_t)2047 * CHANNEL_COMPACT_MAX_CHANNELS * 4 + 4;
+    uint8_t *in = aligned_alloc(16, maxBytes);
+    uint8_t *out = aligned_alloc(16, maxBytes);
+    uint8_t *ref = aligned_alloc(16, maxBytes);
+    uint32_t failures = 0, cases = 0;
+    for (size_t i = 0; i < maxBytes; i++) {
+        in[i] = (uint8_t)noise();
+    }
+    // 偏移2字节时缓冲区不是4字节对齐，整对的掩码不能走32位字拷贝
+    for (uint32_t misalign = 0; misalign <= 2; misalign += 2) {
+        for (uint32_t mask = 0; mask < 256; mask++) {
+            for (size_t f = 0; f < sizeof(frameCounts) / sizeof(frameCounts[0]); f++) {
+                // 高位是未使用的槽位，必须被忽略
+                uint32_t withHighBits = mask | ((f & 1) ? 0xFF00u : 0);
+                if (!check_compact_case(in + misalign, out + misalign, ref, BENCH_CHANNELS, withHighBits,
+                                        frameCounts[f])) {
+                    if (failures++ == 0) {
+                        printf("Channel compact: 8 channels, mask 0x%02x, %u frames, offset %u differs from "
+                               "the reference\n",
+                               (unsigned)withHighBits, (unsigned)frameCounts[f], (unsigned)misalign);
+                    }
+                }
+                cases++;
+            }
+        }
+    }
+    for (uint32_t mask = 0; mask < (1u << CHANNEL_COMPACT_MAX_CHANNELS); mask++) {
+        if (!check_compact_case(in, out, ref, CHANNEL_COMPACT_MAX_CHANNELS, mask, 3)) {
+            if (failures++ == 0) {
+                printf("Channel compact: %d channels, mask 0x%04x differs from the reference\n",
+                       CHANNEL_COMPACT_MAX_CHANNELS, (unsigned)mask);
+            }
+        }
+        cases++;
+    }
+    printf("Channel compact: %u of %u masks/frame counts match the reference (s16, in place, 2/3/4 bytes, unaligned)\n",
+           (unsigned)(cases - failures), (unsigned)cases);
+    free(in);
+    free(out);
+    free(ref);
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    uint32_t frames = 2048;     // 96kHz/16位/8槽位时一个32KB块
+    uint32_t reps = 2000;
+    bool checkOnly = false;
+    int c;
+    while ((c = getopt(argc, argv, "f:n:ch")) != -1) {
+        switch (c) {
+        case 'f': frames = strtoul(optarg, NULL, 0); break;
+        case 'n': reps = strtoul(optarg, NULL, 0); break;
+        case 'c': checkOnly = true; break;
+        default:
+            printf("Usage: %s [-f frames_per_block] [-n repetitions] [-c]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (frames == 0 || reps == 0) {
+        return 2;
+    }
+
+    dsp_init();
+    const char *failed = NULL;
+    uint32_t failures = dsp_golden_check(&failed);
+    if (failures != 0) {
+        printf("Golden vectors: %u failed (first: %s)\n", (unsigned)failures, failed);
+        return 1;
+    }
+    printf("Golden vectors: all passed (%s path)\n", dsp_pie_enabled() ? "PIE" : "portable C");
+    uint32_t kernelFailures = check_deinterleave();
+    kernelFailures += check_channel_compact();
+    if (kernelFailures != 0) {
+        return 1;
+    }
+    if (checkOnly) {
+        return 0;
+    }
+
+    size_t samples = (size_t)frames * BENCH_CHANNELS;
+    int16_t *in = aligned_alloc(16, samples * sizeof(int16_t));
+    int16_t *out = aligned_alloc(16, samples * sizeof(int16_t));
+    if (in == NULL || out == NULL) {
+        return 1;
+    }
+    for (size_t i = 0; i < samples; i++) {
+        in[i] = noise();
+    }
+    printf("Block: %u frames x %d channels, %u repetitions\n", (unsigned)frames, BENCH_CHANNELS, (unsigned)reps);
+
+    volatile uint64_t sink = 0;
+    double t0 = now_sec();
+    for (uint32_t r = 0; r < reps; r++) {
+        dsp_gain_s16(in, out, samples, 23170, 14);
+        sink += (uint16_t)out[r % samples];
+    }
+    report("gain/saturate", now_sec() - t0, frames, reps);
+
+    uint16_t peak[8];
+    t0 = now_sec();
+    for (uint32_t r = 0; r < reps; r++) {
+        dsp_peak_s16x8(in, frames, peak);
+        sink += peak[r % 8];
+    }
+    report("peak s16x8", now_sec() - t0, frames, reps);
+
+    uint64_t sums[BENCH_CHANNELS];
+    t0 = now_sec();
+    for (uint32_t r = 0; r < reps; r++) {
+        dsp_sum_squares_s16(in, BENCH_CHANNELS, frames, sums);
+        sink += sums[r % 8];
+    }
+    report("sum of squares s16x8", now_sec() - t0, frames, reps);
+
+    // 去直流：20Hz二阶高通，一节和两节级联
+    DspBiquadCoeffs hp[2];
+    if (!dsp_biquad_design_highpass(96000.0f, 20.0f, 0.7071f, &hp[0])) {
+        printf("Failed to design the high-pass filter\n");
+        return 1;
+    }
+    hp[1] = hp[0];
+    for (uint32_t stages = 1; stages <= 2; stages++) {
+        DspBiquadCascade bq;
+        dsp_biquad_init(&bq, hp, stages, BENCH_CHANNELS);
+        memcpy(out, in, samples * sizeof(int16_t));
+        t0 = now_sec();
+        for (uint32_t r = 0; r < reps; r++) {
+            dsp_biquad_s16(&bq, out, frames);
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "biquad x%u (DC block)", (unsigned)stages);
+        report(name, now_sec() - t0, frames, reps);
+        sink += (uint16_t)out[0];
+    }
+
+    t0 = now_sec();
+    for (uint32_t r = 0; r < reps; r++) {
+        deinterleave_s16(in, out, BENCH_CHANNELS, frames);
+        sink += (uint16_t)out[r % samples];
+    }
+    report("deinterleave s16x8", now_sec() - t0, frames, reps);
+
+    t0 = now_sec();
+    for (uint32_t r = 0; r < reps; r++) {
+        reference_s16(in, out, BENCH_CHANNELS, frames);
+        sink += (uint16_t)out[r % samples];
+    }
+    report("per-sample loop s16x8", now_sec() - t0, frames, reps);
+
+    // 8x32位：同样帧数的块（24/32位采集配置），样本取自16位噪声拼成的字
+    int32_t *in32 = aligned_alloc(16, samples * sizeof(int32_t));
+    int32_t *out32 = aligned_alloc(16, samples * sizeof(int32_t));
+    if (in32 == NULL || out32 == NULL) {
+        return 1;
+    }
+    for (size_t i = 0; i < samples; i++) {
+        in32[i] = (int32_t)(((uint32_t)(uint16_t)noise() << 16) | (uint16_t)noise());
+    }
+    t0 = now_sec();
+    for (uint32_t r = 0; r < reps; r++) {
+        deinterleave_s32(in32, out32, BENCH_CHANNELS, frames);
+        sink += (uint32_t)out32[r % samples];
+    }
+    report_bytes("deinterleave s32x8", now_sec() - t0, frames, reps, sizeof(int32_t));
+
+    t0 = now_sec();
+    for (uint32_t r = 0; r < reps; r++) {
+        reference_s32(in32, out32, BENCH_CHANNELS, frames);
+        sink += (uint32_t)out32[r % samples];
+    }
+    report_bytes("per-sample loop s32x8", now_sec() - t0, frames, reps, sizeof(int32_t));
+
+    // 通道压缩：整对的掩码按32位字拷贝，隔一个通道的掩码逐样本拷贝（异地，与录音中的原地压缩拷贝量相同）
+    static const uint32_t compactMasks[] = { 0x0F, 0x55 };
+    for (size_t m = 0; m < sizeof(compactMasks) / sizeof(compactMasks[0]); m++) {
+        t0 = now_sec();
+        for (uint32_t r = 0; r < reps; r++) {
+            channel_compact_s16(in, out, BENCH_CHANNELS, compactMasks[m], frames);
+            sink += (uint16_t)out[r % (samples / 2)];
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "channel compact 0x%02x", (unsigned)compactMasks[m]);
+        report(name, now_sec() - t0, frames, reps);
+    }
+
+    free(in);
+    free(out);
+    free(in32);
+    free(out32);
+    return sink == 1;
+}
@@ -0,0 +1,123 @@
+// 事件检测内核基准：在主机上对比8路int16固定lane内核和逐样本通用内核的吞吐量，
+// 并检查两者的结果一致，再测一次完整的event_detector_process（各样本宽度）。
+//
+// 用法: event_bench [-f 每块帧数] [-n 重复次数]
+// 结果以每帧纳秒数和MB/s给出；ESP32-S3上的绝对值不同，但两个内核的相对差距可以参考。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <getopt.h>
+#include <time.h>
+#include "EventDetector.h"
+
+#define BENCH_CHANNELS  8
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 伪随机噪声（xorshift），幅度约-20dBFS
+static uint32_t rngState = 0x12345678;
+static int32_t noise(int32_t amplitude) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return (int32_t)(rngState % (2u * (uint32_t)amplitude + 1)) - amplitude;
+}
+
+// 按样本宽度生成交织的噪声块
+static void fill_block(uint8_t *buf, uint32_t sampleBytes, uint32_t frames) {
+    int32_t amplitude = (int32_t)(0.1 * (double)(1u << (sampleBytes * 8 - 1)));
+    for (uint32_t i = 0; i < frames * BENCH_CHANNELS; i++) {
+        int32_t x = noise(amplitude);
+        for (uint32_t b = 0; b < sampleBytes; b++) {
+            *buf++ = (uint8_t)((uint32_t)x >> (8 * b));
+        }
+    }
+}
+
+static void report(const char *name, double seconds, uint32_t frames, uint32_t reps, uint32_t sampleBytes) {
+    double totalFrames = (double)frames * reps;
+    printf("%-28s %8.2f ns/frame %9.1f MB/s\n", name, seconds * 1e9 / totalFrames,
+           totalFrames * BENCH_CHANNELS * sampleBytes / seconds / 1e6);
+}
+
+int main(int argc, char **argv) {
+    uint32_t frames = 2048;     // 96kHz/16位/8槽位时一个32KB块
+    uint32_t reps = 2000;
+    int c;
+    while ((c = getopt(argc, argv, "f:n:h")) != -1) {
+        switch (c) {
+        case 'f': frames = strtoul(optarg, NULL, 0); break;
+        case 'n': reps = strtoul(optarg, NULL, 0); break;
+        default:
+            printf("Usage: %s [-f frames_per_block] [-n repetitions]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (frames == 0 || reps == 0) {
+        return 2;
+    }
+
+    uint8_t *buf = malloc((size_t)frames * BENCH_CHANNELS * 4);
+    if (buf == NULL) {
+        return 1;
+    }
+    printf("Block: %u frames x %d channels, %u repetitions\n", (unsigned)frames, BENCH_CHANNELS, (unsigned)reps);
+
+    // 两个内核的结果必须一致（单精度累加顺序不同，允许很小的相对误差）
+    fill_block(buf, 2, frames);
+    EventLevels fast, ref;
+    event_levels_s16x8((const int16_t *)buf, frames, &fast);
+    event_levels_generic(buf, 2, BENCH_CHANNELS, frames, &ref);
+    for (int ch = 0; ch < BENCH_CHANNELS; ch++) {
+        if (fabsf(fast.meanSquare[ch] - ref.meanSquare[ch]) > 1e-4f * ref.meanSquare[ch] ||
+            fast.peak[ch] != ref.peak[ch]) {
+            printf("Mismatch on channel %d: %g/%g vs %g/%g\n", ch, (double)fast.meanSquare[ch],
+                   (double)fast.peak[ch], (double)ref.meanSquare[ch], (double)ref.peak[ch]);
+            return 1;
+        }
+    }
+
+    volatile float sink = 0.0f;
+    double t0 = now_sec();
+    for (uint32_t r = 0; r < reps; r++) {
+        event_levels_s16x8((const int16_t *)buf, frames, &fast);
+        sink += fast.meanSquare[r % BENCH_CHANNELS];
+    }
+    report("levels s16x8", now_sec() - t0, frames, reps, 2);
+
+    t0 = now_sec();
+    for (uint32_t r = 0; r < reps; r++) {
+        event_levels_generic(buf, 2, BENCH_CHANNELS, frames, &ref);
+        sink += ref.meanSquare[r % BENCH_CHANNELS];
+    }
+    report("levels generic (16-bit)", now_sec() - t0, frames, reps, 2);
+
+    // 完整检测（含阈值和VAD），各样本宽度
+    static const uint32_t widths[] = { 2, 3, 4 };
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+        EventDetectorConfig config = EVENT_DETECTOR_DEFAULT;
+        EventDetector detector;
+        EventTrigger trigger;
+        uint32_t hits = 0;
+        fill_block(buf, widths[w], frames);
+        event_detector_init(&detector, &config, BENCH_CHANNELS, widths[w], (1u << BENCH_CHANNELS) - 1);
+        t0 = now_sec();
+        for (uint32_t r = 0; r < reps; r++) {
+            hits += event_detector_process(&detector, buf, frames, &trigger);
+        }
+        double elapsed = now_sec() - t0;
+        char name[32];
+        snprintf(name, sizeof(name), "detector %u-bit", (unsigned)(widths[w] * 8));
+        report(name, elapsed, frames, reps, widths[w]);
+        sink += (float)hits;
+    }
+
+    free(buf);
+    return sink < 0.0f;
+}
@@ -0,0 +1,350 @@
+// 声学特征基准：检查FeatureExtractor的结果，再测量特征提取的实时系数：
+//   - 单频：每个通道一个不同幅度、位于不同频带中心的正弦，RMS、峰值与理论值的误差，过零率与频率的误差，
+//     所在频带占全部频带能量的比例，以及全部频带之和与RMS²的误差；
+//   - 编码：按.FEA的字节编码写出再读回，与线性值的dB误差不超过量化步长的一半；
+//   - 连续性：按不同块长处理同一信号，结果的样本位置相同、数值在单精度舍入范围内相同；
+//     32位容器和24位打包的输入与同样的16位输入结果相同；输入不连续时从新的位置重新计时。
+//
+// 用法: feature_bench [-r 采样率] [-c 通道数] [-f 每块帧数] [-p 周期ms] [-b 频带数] [-n FFT长度]
+//                     [-t 秒]
+// 检查不通过时退出码为1。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <getopt.h>
+#include <time.h>
+#include "FeatureExtractor.h"
+#include "FeatureIndex.h"
+
+#define BENCH_PI        3.14159265358979323846
+#define MAX_RESULTS     64
+#define MIN_BAND_SHARE  0.9         // 频点不少于MIN_SHARE_BINS的频带中，位于中心的正弦落在本频带的能量比例
+#define MIN_SHARE_BINS  4           // Hann窗主瓣宽±2个频点，更窄的频带只检查能量之和
+#define RMS_TOL_DB      0.05
+#define SUM_TOL_DB      0.2
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double db(double ratio) {
+    return 20.0 * log10(ratio);
+}
+
+static int16_t quantize(double x) {
+    long v = lround(x * 32768.0);
+    return (int16_t)((v > 32767) ? 32767 : (v < -32768) ? -32768 : v);
+}
+
+// 每个通道的正弦：幅度-6dBFS起每个通道低3dB；频率在频带中心附近（不在频点上，有泄漏），依次取频点足够多的频带
+static void channel_tone(const FeatureExtractor *fx, uint32_t ch, double *amplitude, double *hz, int32_t *band) {
+    uint32_t wide[FEATURE_MAX_BANDS], count = 0;
+    for (uint32_t b = 0; b < fx->bands; b++) {
+        if (fx->binHigh[b] - fx->binLow[b] >= MIN_SHARE_BINS) {
+            wide[count++] = b;
+        }
+    }
+    *amplitude = 0.5 * pow(10.0, -3.0 * ch / 20.0);
+    if (count == 0) {
+        // 频带都很窄：用整个范围的中点，只检查能量之和
+        float lo, hi;
+        feature_extractor_band_hz(fx, fx->bands / 2, &lo, &hi);
+        *hz = (lo + hi) / 2.0;
+        *band = -1;
+        return;
+    }
+    uint32_t b = wide[(count - 1 - ch * 3 % count)];
+    *hz = ((fx->binLow[b] + fx->binHigh[b] - 1) / 2.0 + 0.37) * fx->sampleRate / fx->frameSize;
+    *band = (int32_t)b;
+}
+
+static void synthesize(const FeatureExtractor *fx, int16_t *in, uint32_t frames) {
+    for (uint32_t ch = 0; ch < fx->channels; ch++) {
+        double amplitude, hz;
+        int32_t band;
+        channel_tone(fx, ch, &amplitude, &hz, &band);
+        for (uint32_t i = 0; i < frames; i++) {
+            in[(size_t)i * fx->channels + ch] = quantize(amplitude * sin(2.0 * BENCH_PI * hz * i / fx->sampleRate + ch));
+        }
+    }
+}
+
+// 按blockFrames分块送入frames帧，收集完成的结果
+static uint32_t run(FeatureExtractor *fx, const void *in, uint32_t sampleBytes, uint32_t frames, uint32_t blockFrames,
+                    uint64_t firstSample, FeatureResult *results) {
+    const uint8_t *src = in;
+    uint32_t count = 0;
+    for (uint32_t pos = 0; pos < frames;) {
+        uint32_t block = (frames - pos < blockFrames) ? frames - pos : blockFrames;
+        uint32_t done = 0;
+        while (done < block) {
+            bool ready;
+            done += feature_extractor_feed(fx, src + ((size_t)pos + done) * fx->channels * sampleBytes, sampleBytes,
+                                           block - done, firstSample + pos + done, &ready);
+            if (ready && results != NULL && count < MAX_RESULTS) {
+                results[count++] = fx->result;
+            }
+        }
+        pos += block;
+    }
+    return count;
+}
+
+static bool check_tones(const FeatureExtractor *fx, const FeatureResult *results, uint32_t count) {
+    bool ok = count > 0;
+    for (uint32_t ch = 0; ch < fx->channels; ch++) {
+        double amplitude, hz;
+        int32_t band;
+        channel_tone(fx, ch, &amplitude, &hz, &band);
+        double rmsErr = 0, peakErr = 0, zcrErr = 0, sumErr = 0, share = 1.0;
+        for (uint32_t k = 0; k < count; k++) {
+            const FeatureResult *r = &results[k];
+            double sum = 0;
+            for (uint32_t b = 0; b < fx->bands; b++) {
+                sum += r->band[ch][b];
+            }
+            double e = fabs(db(r->rms[ch] / (amplitude / sqrt(2.0))));
+            rmsErr = (e > rmsErr) ? e : rmsErr;
+            e = fabs(db(r->peak[ch] / amplitude));
+            peakErr = (e > peakErr) ? e : peakErr;
+            e = fabs(r->zcrHz[ch] - hz);
+            zcrErr = (e > zcrErr) ? e : zcrErr;
+            e = fabs(10.0 * log10(sum / ((double)r->rms[ch] * r->rms[ch])));
+            sumErr = (e > sumErr) ? e : sumErr;
+            if (band >= 0) {
+                double s = r->band[ch][band] / sum;
+                share = (s < share) ? s : share;
+            }
+        }
+        // 峰值：采样点不一定落在波峰上；过零率：一个结果内的过零次数差1，加上量化
+        double peakTol = -db(cos(BENCH_PI * hz / fx->sampleRate)) + 0.01;
+        double zcrTol = fx->sampleRate / (2.0 * fx->reportFrames) + 0.005 * hz;
+        bool pass = rmsErr <= RMS_TOL_DB && peakErr <= peakTol && zcrErr <= zcrTol && sumErr <= SUM_TOL_DB &&
+                    share >= MIN_BAND_SHARE;
+        printf("ch%-2u %6.1f dBFS %7.1f Hz: RMS %.3f dB, peak %.3f dB, ZCR %.1f Hz (max %.1f), "
+               "band sum %.3f dB", (unsigned)ch, db(amplitude), hz, rmsErr, peakErr, zcrErr, zcrTol, sumErr);
+        if (band >= 0) {
+            printf(", band %d holds %.1f%%", (int)band, share * 100);
+        }
+        printf("%s\n", pass ? "" : "  FAIL");
+        ok &= pass;
+    }
+    return ok;
+}
+
+// 与流水线相同的编码（见CapturePipeline.c extract_features），解码后与线性值比较
+static bool check_encoding(const FeatureExtractor *fx, const FeatureResult *r) {
+    FeatureIndexRecord rec = { .samplePos = r->samplePos, .windows = (uint16_t)r->windows };
+    for (uint32_t ch = 0; ch < fx->channels; ch++) {
+        rec.rms[ch] = feature_index_amplitude_code(r->rms[ch]);
+        rec.peak[ch] = feature_index_amplitude_code(r->peak[ch]);
+        rec.zcrHz[ch] = (uint16_t)lroundf(r->zcrHz[ch]);
+        for (uint32_t b = 0; b < fx->bands; b++) {
+            rec.band[ch][b] = feature_index_power_code(r->band[ch][b]);
+        }
+    }
+    uint32_t bytes = FEATURE_INDEX_RECORD_BYTES(fx->channels, fx->bands);
+    uint8_t *buf = malloc(bytes);
+    FeatureIndexRecord back;
+    memset(&back, 0, sizeof(back));
+    feature_index_encode(buf, &rec, fx->channels, fx->bands);
+    feature_index_decode(buf, &back, fx->channels, fx->bands);
+    free(buf);
+    bool ok = memcmp(&rec, &back, sizeof(rec)) == 0;
+    double worst = 0;
+    for (uint32_t ch = 0; ch < fx->channels; ch++) {
+        double e = fabs(feature_index_code_db(back.rms[ch]) - db(r->rms[ch]));
+        worst = (e > worst) ? e : worst;
+        for (uint32_t b = 0; b < fx->bands; b++) {
+            double level = 10.0 * log10(r->band[ch][b]);
+            if (level > FEATURE_INDEX_FLOOR_DB + 1.0) {
+                e = fabs(feature_index_code_db(back.band[ch][b]) - level);
+                worst = (e > worst) ? e : worst;
+            }
+        }
+    }
+    ok &= worst <= 0.25 + 1e-3;
+    printf("Record encoding:   %u bytes per %u ms, round trip %s, level error %.3f dB (max 0.25)%s\n",
+           (unsigned)bytes, (unsigned)lround(fx->reportFrames * 1000.0 / fx->sampleRate),
+           (memcmp(&rec, &back, sizeof(rec)) == 0) ? "identical" : "MISMATCH", worst, ok ? "" : "  FAIL");
+    return ok;
+}
+
+static bool same_results(const FeatureExtractor *fx, const FeatureResult *a, uint32_t countA, const FeatureResult *b,
+                         uint32_t countB, double tol) {
+    if (countA != countB) {
+        return false;
+    }
+    for (uint32_t k = 0; k < countA; k++) {
+        if (a[k].samplePos != b[k].samplePos || a[k].windows != b[k].windows) {
+            return false;
+        }
+        for (uint32_t ch = 0; ch < fx->channels; ch++) {
+            bool same = fabsf(a[k].rms[ch] - b[k].rms[ch]) <= tol * a[k].rms[ch] && a[k].peak[ch] == b[k].peak[ch] &&
+                        a[k].zcrHz[ch] == b[k].zcrHz[ch];
+            for (uint32_t i = 0; i < fx->bands; i++) {
+                same &= fabsf(a[k].band[ch][i] - b[k].band[ch][i]) <= tol * a[k].band[ch][i];
+            }
+            if (!same) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    uint32_t sampleRate = 96000;
+    uint32_t channels = 8;
+    uint32_t blockFrames = 2048;    // 96kHz/16位/8槽位时一个32KB块
+    uint32_t periodMs = 100;
+    uint32_t seconds = 5;
+    FeatureConfig config = { .bands = 32 };
+    int c;
+    while ((c = getopt(argc, argv, "r:c:f:p:b:n:t:h")) != -1) {
+        switch (c) {
+        case 'r': sampleRate = strtoul(optarg, NULL, 0); break;
+        case 'c': channels = strtoul(optarg, NULL, 0); break;
+        case 'f': blockFrames = strtoul(optarg, NULL, 0); break;
+        case 'p': periodMs = strtoul(optarg, NULL, 0); break;
+        case 'b': config.bands = strtoul(optarg, NULL, 0); break;
+        case 'n': config.frameSize = strtoul(optarg, NULL, 0); break;
+        case 't': seconds = strtoul(optarg, NULL, 0); break;
+        default:
+            printf("Usage: %s [-r sample_rate] [-c channels] [-f frames_per_block] [-p period_ms] [-b bands]\n"
+                   "          [-n fft_size] [-t seconds]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (sampleRate == 0 || channels == 0 || channels > FEATURE_MAX_CHANNELS || blockFrames < 2 || periodMs == 0 ||
+        seconds == 0) {
+        return 2;
+    }
+    config.reportFrames = (uint32_t)((uint64_t)sampleRate * periodMs / 1000);
+    int failures = 0;
+
+    FeatureExtractor fx;
+    if (!feature_extractor_init(&fx, &config, (float)sampleRate, channels)) {
+        printf("Failed to set up the extractor (FFT size %d..%d, at most the %u-frame period, enough bins for %u bands)\n",
+               FEATURE_MIN_FRAME, FEATURE_MAX_FRAME, (unsigned)config.reportFrames, (unsigned)config.bands);
+        return 1;
+    }
+    float lo, hi;
+    feature_extractor_band_hz(&fx, 0, &lo, &hi);
+    printf("%u Hz, %u channels, %u frames per result, %u-point FFT (%.1f Hz bins), %u bands from %.0f Hz",
+           (unsigned)sampleRate, (unsigned)channels, (unsigned)fx.reportFrames, (unsigned)fx.frameSize,
+           (double)sampleRate / fx.frameSize, (unsigned)fx.bands, lo);
+    feature_extractor_band_hz(&fx, fx.bands - 1, &lo, &hi);
+    printf(" to %.0f Hz\n", hi);
+
+    uint32_t frames = sampleRate;   // 检查用1秒
+    int16_t *in = malloc((size_t)frames * channels * sizeof(int16_t));
+    int32_t *wide = malloc((size_t)frames * channels * sizeof(int32_t));
+    FeatureResult *results = malloc(MAX_RESULTS * sizeof(FeatureResult));
+    FeatureResult *ref = malloc(MAX_RESULTS * sizeof(FeatureResult));
+    if (in == NULL || wide == NULL || results == NULL || ref == NULL) {
+        return 1;
+    }
+
+    // 单频与编码
+    synthesize(&fx, in, frames);
+    feature_extractor_reset(&fx);
+    uint32_t count = run(&fx, in, 2, frames, blockFrames, 0, results);
+    bool ok = count == frames / fx.reportFrames;
+    for (uint32_t k = 0; k < count; k++) {
+        ok &= results[k].samplePos == (uint64_t)k * fx.reportFrames;
+    }
+    printf("Results:           %u in %u frames, sample positions %s\n", (unsigned)count, (unsigned)frames,
+           ok ? "contiguous" : "WRONG");
+    failures += !ok;
+    failures += !check_tones(&fx, results, count);
+    failures += !check_encoding(&fx, &results[count - 1]);
+
+    // 连续性：块长不同（包括不整除的块长）；32位容器和24位打包的同一信号
+    uint32_t oddFrames = blockFrames / 3 + 1;
+    feature_extractor_reset(&fx);
+    uint32_t refCount = run(&fx, in, 2, frames, oddFrames, 0, ref);
+    bool same = same_results(&fx, results, count, ref, refCount, 1e-5);
+    printf("Block continuity:  %s (%u vs %u frames per block)\n", same ? "identical" : "MISMATCH",
+           (unsigned)blockFrames, (unsigned)oddFrames);
+    failures += !same;
+    for (size_t i = 0; i < (size_t)frames * channels; i++) {
+        wide[i] = (int32_t)((uint32_t)(uint16_t)in[i] << 16);
+    }
+    for (uint32_t bytes = 4; bytes >= 3; bytes--) {
+        // 24位打包：32位容器的高3字节
+        if (bytes == 3) {
+            uint8_t *packed = (uint8_t *)wide;
+            for (size_t i = 0; i < (size_t)frames * channels; i++) {
+                uint32_t v = (uint32_t)wide[i];
+                packed[i * 3] = (uint8_t)(v >> 8);
+                packed[i * 3 + 1] = (uint8_t)(v >> 16);
+                packed[i * 3 + 2] = (uint8_t)(v >> 24);
+            }
+        }
+        feature_extractor_reset(&fx);
+        refCount = run(&fx, wide, bytes, frames, blockFrames, 0, ref);
+        same = same_results(&fx, results, count, ref, refCount, 0.0);
+        printf("%u-bit input:      %s\n", (unsigned)bytes * 8, same ? "identical" : "MISMATCH");
+        failures += !same;
+    }
+
+    // 不连续：前半秒之后跳过1000帧，第一个结果从跳过后的位置开始
+    feature_extractor_reset(&fx);
+    uint32_t half = frames / 2;
+    run(&fx, in, 2, half, blockFrames, 0, NULL);
+    refCount = run(&fx, in + (size_t)half * channels, 2, frames - half, blockFrames, half + 1000, ref);
+    same = refCount == (frames - half) / fx.reportFrames && refCount > 0 && ref[0].samplePos == half + 1000;
+    printf("Discontinuity:     %s\n", same ? "restarts at the new position" : "WRONG");
+    failures += !same;
+
+    // 实时系数：整个提取，和其中的FFT与频带求和
+    printf("\n");
+    volatile float sink = 0;
+    run(&fx, in, 2, frames, blockFrames, 0, NULL);     // 预热
+    double t0 = now_sec();
+    for (uint32_t s = 0; s < seconds; s++) {
+        run(&fx, in, 2, frames, blockFrames, (uint64_t)(s + 1) * frames, NULL);
+        sink += fx.result.rms[0];
+    }
+    double total = (now_sec() - t0) / seconds;
+
+    uint32_t windows = frames / fx.frameSize;
+    float *frame = malloc(fx.frameSize * sizeof(float));
+    for (uint32_t i = 0; i < fx.frameSize; i++) {
+        frame[i] = in[(size_t)i * channels] * (1.0f / 32768.0f) * fx.window[i];
+    }
+    t0 = now_sec();
+    for (uint32_t s = 0; s < seconds; s++) {
+        for (uint32_t w = 0; w < windows * channels; w++) {
+            dsp_real_fft_forward(&fx.fft, frame, fx.re, fx.im);
+            for (uint32_t b = 0; b < fx.bands; b++) {
+                float power = 0.0f;
+                for (uint32_t k = fx.binLow[b]; k < fx.binHigh[b]; k++) {
+                    power += fx.re[k] * fx.re[k] + fx.im[k] * fx.im[k];
+                }
+                sink += power;
+            }
+        }
+    }
+    double spectral = (now_sec() - t0) / seconds;
+    free(frame);
+    printf("Extraction:        %8.2f ns/frame, real-time factor %.4f (host)\n", total * 1e9 / frames, total);
+    printf("  FFT + bands:     %8.2f ns/frame (%.0f%%), level/ZCR and windowing the rest\n",
+           spectral * 1e9 / frames, spectral / total * 100);
+
+    feature_extractor_deinit(&fx);
+    free(in);
+    free(wide);
+    free(results);
+    free(ref);
+    if (failures != 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,416 @@
+// 特征索引查询工具：读取录音旁边的.FEA文件，按电平、频带能量和过零率找出符合条件的片段，
+// 不必读回录音本身；有.IDX时同时给出片段在录音文件中所在的块和字节偏移。
+//
+// 条件之间为“与”，在-c指定的通道上判断，不指定时任一通道满足即可；相邻（间隔不超过--gap）的
+// 匹配记录合并为一个片段。--csv按记录输出全部特征（dB），便于用其他工具画图或进一步筛选。
+//
+// 用法见 feature_index --help。索引按1MB整段顺序读取。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <getopt.h>
+#include <time.h>
+#include "FeatureIndex.h"
+#include "BlockIndex.h"
+
+#define READ_CHUNK  (1024 * 1024)
+
+typedef struct {
+    bool minRms, minPeak, band, zcr;
+    float minRmsDb, minPeakDb;
+    float bandLowHz, bandHighHz, bandDb;
+    float zcrMinHz, zcrMaxHz;
+    int32_t channel;            // -1: 任一通道
+} Query;
+
+typedef struct {
+    FeatureIndexInfo info;
+    uint32_t recordBytes;
+    FeatureIndexRecord *records;
+    size_t count;
+    const char *stopReason;     // 索引提前结束的原因，NULL表示完整
+} FeatureScan;
+
+typedef struct {
+    BlockIndexInfo info;
+    BlockIndexRecord *records;
+    size_t count;
+} BlockScan;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 顺序读取全部记录；在样本位置不增加处停止（断电后预分配区域中的残留数据）
+static bool scan_features(const char *path, FeatureScan *scan) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+    uint8_t *buf = malloc(READ_CHUNK);
+    size_t got = fread(buf, 1, FEATURE_INDEX_HEADER_BYTES, f);
+    if (got != FEATURE_INDEX_HEADER_BYTES || !feature_index_parse_header(buf, got, &scan->info)) {
+        fprintf(stderr, "%s is not a feature index\n", path);
+        free(buf);
+        fclose(f);
+        return false;
+    }
+    scan->recordBytes = FEATURE_INDEX_RECORD_BYTES(scan->info.channels, scan->info.bands);
+
+    // 按整条记录读取：每次读取的长度取记录长度的整数倍
+    size_t chunk = READ_CHUNK / scan->recordBytes * scan->recordBytes;
+    size_t capacity = 1024;
+    scan->records = malloc(capacity * sizeof(FeatureIndexRecord));
+    scan->count = 0;
+    scan->stopReason = NULL;
+    while (scan->stopReason == NULL && (got = fread(buf, 1, chunk, f)) >= scan->recordBytes) {
+        for (size_t pos = 0; pos + scan->recordBytes <= got; pos += scan->recordBytes) {
+            FeatureIndexRecord r;
+            feature_index_decode(buf + pos, &r, scan->info.channels, scan->info.bands);
+            if (scan->count > 0 && r.samplePos <= scan->records[scan->count - 1].samplePos) {
+                scan->stopReason = "sample position does not advance";
+                break;
+            }
+            if (scan->count == capacity) {
+                capacity *= 2;
+                scan->records = realloc(scan->records, capacity * sizeof(FeatureIndexRecord));
+            }
+            scan->records[scan->count++] = r;
+        }
+    }
+    free(buf);
+    fclose(f);
+    return true;
+}
+
+// 可选的块索引：只用于把样本位置换算为录音文件中的位置，读不到时不报错
+static bool scan_blocks(const char *path, BlockScan *scan) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return false;
+    }
+    uint8_t header[BLOCK_INDEX_HEADER_BYTES], rec[BLOCK_INDEX_RECORD_BYTES];
+    if (fread(header, 1, sizeof(header), f) != sizeof(header) ||
+        !block_index_parse_header(header, sizeof(header), &scan->info)) {
+        fclose(f);
+        return false;
+    }
+    size_t capacity = 4096;
+    scan->records = malloc(capacity * sizeof(BlockIndexRecord));
+    scan->count = 0;
+    while (fread(rec, 1, sizeof(rec), f) == sizeof(rec)) {
+        BlockIndexRecord r;
+        block_index_decode(rec, &r);
+        if (r.seq < scan->count ||
+            (scan->count > 0 && (r.offset < scan->records[scan->count - 1].offset ||
+                                 r.firstSample < scan->records[scan->count - 1].firstSample))) {
+            break;
+        }
+        if (scan->count == capacity) {
+            capacity *= 2;
+            scan->records = realloc(scan->records, capacity * sizeof(BlockIndexRecord));
+        }
+        scan->records[scan->count++] = r;
+    }
+    fclose(f);
+    return scan->count > 0;
+}
+
+// 包含样本位置的块（二分查找）；在第一块之前或落在缺口中时返回下一个块，都不在时返回-1
+static long find_block(const BlockScan *blocks, uint64_t sample) {
+    size_t lo = 0, hi = blocks->count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (blocks->records[mid].firstSample + blocks->info.blockFrames <= sample) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo < blocks->count) ? (long)lo : -1;
+}
+
+static float power_db(double power) {
+    return (power > 0) ? (float)(10.0 * log10(power)) : FEATURE_INDEX_FLOOR_DB;
+}
+
+// 与[lowHz, highHz)重叠的频带能量之和（dB）
+static float band_range_db(const FeatureIndexInfo *info, const FeatureIndexRecord *r, uint32_t ch, float lowHz,
+                           float highHz) {
+    double power = 0;
+    for (uint32_t b = 0; b < info->bands; b++) {
+        if (info->bandEdgeHz[b] < highHz && info->bandEdgeHz[b + 1] > lowHz && r->band[ch][b] > 0) {
+            power += pow(10.0, feature_index_code_db(r->band[ch][b]) / 10.0);
+        }
+    }
+    return power_db(power);
+}
+
+static bool channel_matches(const FeatureIndexInfo *info, const FeatureIndexRecord *r, uint32_t ch, const Query *q) {
+    return (!q->minRms || feature_index_code_db(r->rms[ch]) >= q->minRmsDb) &&
+           (!q->minPeak || feature_index_code_db(r->peak[ch]) >= q->minPeakDb) &&
+           (!q->zcr || (r->zcrHz[ch] >= q->zcrMinHz && r->zcrHz[ch] <= q->zcrMaxHz)) &&
+           (!q->band || band_range_db(info, r, ch, q->bandLowHz, q->bandHighHz) >= q->bandDb);
+}
+
+// 满足条件的通道位掩码（按记录中的顺序）
+static uint32_t record_matches(const FeatureIndexInfo *info, const FeatureIndexRecord *r, const Query *q) {
+    uint32_t mask = 0;
+    for (uint32_t ch = 0; ch < info->channels; ch++) {
+        if ((q->channel < 0 || (uint32_t)q->channel == ch) && channel_matches(info, r, ch, q)) {
+            mask |= 1u << ch;
+        }
+    }
+    return mask;
+}
+
+static void print_location(const BlockScan *blocks, uint64_t sample) {
+    long i = (blocks != NULL) ? find_block(blocks, sample) : -1;
+    if (i < 0) {
+        return;
+    }
+    const BlockIndexRecord *b = &blocks->records[i];
+    uint64_t frame = (sample > b->firstSample) ? sample - b->firstSample : 0;
+    printf(", block %u at byte %llu +%llu frames", (unsigned)b->seq, (unsigned long long)b->offset,
+           (unsigned long long)frame);
+}
+
+static void summary(const FeatureScan *scan) {
+    const FeatureIndexInfo *info = &scan->info;
+    printf("Format: %u Hz, %u channels (mask 0x%x), %u frames per record (%.1f ms), %u-point FFT\n",
+           (unsigned)info->sampleRate, (unsigned)info->channels, (unsigned)info->channelMask,
+           (unsigned)info->reportFrames, info->reportFrames * 1000.0 / info->sampleRate, (unsigned)info->frameSize);
+    if (info->bands > 0) {
+        printf("Bands: %u from %u Hz to %u Hz\n", (unsigned)info->bands, (unsigned)info->bandEdgeHz[0],
+               (unsigned)info->bandEdgeHz[info->bands]);
+    }
+    if (scan->count > 0) {
+        uint64_t first = scan->records[0].samplePos;
+        uint64_t end = scan->records[scan->count - 1].samplePos + info->reportFrames;
+        printf("Records: %zu, samples %llu..%llu (t=%.3f..%.3f s)\n", scan->count, (unsigned long long)first,
+               (unsigned long long)end, (double)first / info->sampleRate, (double)end / info->sampleRate);
+    } else {
+        printf("Records: 0\n");
+    }
+    if (scan->stopReason != NULL) {
+        printf("Index ends early after record %zu: %s\n", scan->count, scan->stopReason);
+    }
+}
+
+static void dump_csv(const FeatureScan *scan) {
+    const FeatureIndexInfo *info = &scan->info;
+    printf("sample,time_s");
+    for (uint32_t ch = 0; ch < info->channels; ch++) {
+        printf(",ch%u_rms_db,ch%u_peak_db,ch%u_zcr_hz", (unsigned)ch, (unsigned)ch, (unsigned)ch);
+        for (uint32_t b = 0; b < info->bands; b++) {
+            printf(",ch%u_%uhz_db", (unsigned)ch, (unsigned)info->bandEdgeHz[b]);
+        }
+    }
+    printf("\n");
+    for (size_t i = 0; i < scan->count; i++) {
+        const FeatureIndexRecord *r = &scan->records[i];
+        printf("%llu,%.6f", (unsigned long long)r->samplePos, (double)r->samplePos / info->sampleRate);
+        for (uint32_t ch = 0; ch < info->channels; ch++) {
+            printf(",%.1f,%.1f,%u", feature_index_code_db(r->rms[ch]), feature_index_code_db(r->peak[ch]),
+                   (unsigned)r->zcrHz[ch]);
+            for (uint32_t b = 0; b < info->bands; b++) {
+                printf(",%.1f", feature_index_code_db(r->band[ch][b]));
+            }
+        }
+        printf("\n");
+    }
+}
+
+// 列出匹配的片段，返回片段数
+static size_t search(const FeatureScan *scan, const Query *q, double gapMs, const BlockScan *blocks) {
+    const FeatureIndexInfo *info = &scan->info;
+    uint64_t gapFrames = (uint64_t)llround(gapMs * info->sampleRate / 1000.0);
+    size_t regions = 0, matched = 0;
+    size_t i = 0;
+    while (i < scan->count) {
+        uint32_t mask = record_matches(info, &scan->records[i], q);
+        if (mask == 0) {
+            i++;
+            continue;
+        }
+        // 片段：从第一条匹配的记录起，合并间隔不超过gapFrames的后续匹配记录
+        uint64_t start = scan->records[i].samplePos;
+        uint64_t end = start + info->reportFrames;
+        uint32_t channels = mask;
+        uint8_t loudest = 0;
+        uint32_t loudestCh = 0;
+        size_t records = 0;
+        for (; i < scan->count; i++) {
+            const FeatureIndexRecord *r = &scan->records[i];
+            if (r->samplePos > end + gapFrames) {
+                break;
+            }
+            mask = record_matches(info, r, q);
+            if (mask == 0) {
+                continue;
+            }
+            channels |= mask;
+            end = r->samplePos + info->reportFrames;
+            records++;
+            for (uint32_t ch = 0; ch < info->channels; ch++) {
+                if ((mask & (1u << ch)) != 0 && r->rms[ch] >= loudest) {
+                    loudest = r->rms[ch];
+                    loudestCh = ch;
+                }
+            }
+        }
+        matched += records;
+        regions++;
+        printf("%8.3f s  sample %llu, %.3f s, %zu record(s), channels 0x%x, max RMS %.1f dBFS on ch%u",
+               (double)start / info->sampleRate, (unsigned long long)start, (double)(end - start) / info->sampleRate,
+               records, (unsigned)channels, feature_index_code_db(loudest), (unsigned)loudestCh);
+        print_location(blocks, start);
+        printf("\n");
+    }
+    printf("Matches: %zu record(s) in %zu region(s)\n", matched, regions);
+    return regions;
+}
+
+static bool parse_range(const char *arg, float *lo, float *hi) {
+    char *end;
+    *lo = strtof(arg, &end);
+    if (*end != '-') {
+        return false;
+    }
+    *hi = strtof(end + 1, &end);
+    return *end == '\0' && *hi > *lo;
+}
+
+static bool parse_band(const char *arg, Query *q) {
+    char range[64];
+    const char *colon = strchr(arg, ':');
+    if (colon == NULL || (size_t)(colon - arg) >= sizeof(range)) {
+        return false;
+    }
+    memcpy(range, arg, colon - arg);
+    range[colon - arg] = '\0';
+    char *end;
+    q->bandDb = strtof(colon + 1, &end);
+    return *end == '\0' && parse_range(range, &q->bandLowHz, &q->bandHighHz);
+}
+
+// 由特征索引路径推导块索引路径
+static void block_index_path(const char *featurePath, char *out, size_t len) {
+    const char *dot = strrchr(featurePath, '.');
+    size_t base = dot ? (size_t)(dot - featurePath) : strlen(featurePath);
+    snprintf(out, len, "%.*s.IDX", (int)base, featurePath);
+}
+
+static void usage(const char *prog) {
+    printf("Usage: %s [options] AUDIOX.FEA\n"
+           "  -r, --min-rms DB          records with RMS of at least DB dBFS\n"
+           "  -p, --min-peak DB         records with a peak of at least DB dBFS\n"
+           "  -b, --band LO-HI:DB       records whose bands overlapping LO..HI Hz sum to at least DB dBFS\n"
+           "  -z, --zcr MIN-MAX         records with a zero-crossing rate of MIN..MAX Hz\n"
+           "  -c, --channel N           test channel N of the record only (default: any channel)\n"
+           "  -g, --gap MS              merge matches up to MS apart into one region (default 0)\n"
+           "  -i, --index PATH          block index for file offsets (default: same name with .IDX)\n"
+           "      --csv                 print every record as CSV (levels in dBFS) instead of searching\n"
+           "Without a condition only the summary is printed.\n",
+           prog);
+}
+
+int main(int argc, char **argv) {
+    static const struct option longOpts[] = {
+        { "min-rms", required_argument, NULL, 'r' },
+        { "min-peak", required_argument, NULL, 'p' },
+        { "band", required_argument, NULL, 'b' },
+        { "zcr", required_argument, NULL, 'z' },
+        { "channel", required_argument, NULL, 'c' },
+        { "gap", required_argument, NULL, 'g' },
+        { "index", required_argument, NULL, 'i' },
+        { "csv", no_argument, NULL, 'C' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    Query q = { .channel = -1 };
+    double gapMs = 0;
+    const char *indexArg = NULL;
+    bool csv = false;
+    int c;
+    while ((c = getopt_long(argc, argv, "r:p:b:z:c:g:i:h", longOpts, NULL)) != -1) {
+        switch (c) {
+        case 'r': q.minRms = true; q.minRmsDb = strtof(optarg, NULL); break;
+        case 'p': q.minPeak = true; q.minPeakDb = strtof(optarg, NULL); break;
+        case 'b':
+            if (!parse_band(optarg, &q)) {
+                fprintf(stderr, "Invalid band condition: %s (expected LO-HI:DB)\n", optarg);
+                return 2;
+            }
+            q.band = true;
+            break;
+        case 'z':
+            if (!parse_range(optarg, &q.zcrMinHz, &q.zcrMaxHz)) {
+                fprintf(stderr, "Invalid zero-crossing range: %s (expected MIN-MAX)\n", optarg);
+                return 2;
+            }
+            q.zcr = true;
+            break;
+        case 'c': q.channel = (int32_t)strtol(optarg, NULL, 0); break;
+        case 'g': gapMs = atof(optarg); break;
+        case 'i': indexArg = optarg; break;
+        case 'C': csv = true; break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (optind != argc - 1 || gapMs < 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    const char *featurePath = argv[optind];
+
+    double start = now_sec();
+    FeatureScan scan;
+    if (!scan_features(featurePath, &scan)) {
+        return 1;
+    }
+    double elapsed = now_sec() - start;
+    if (q.channel >= (int32_t)scan.info.channels) {
+        fprintf(stderr, "Channel %d out of range (the index has %u channels)\n", (int)q.channel,
+                (unsigned)scan.info.channels);
+        free(scan.records);
+        return 2;
+    }
+
+    if (csv) {
+        dump_csv(&scan);
+        free(scan.records);
+        return 0;
+    }
+
+    summary(&scan);
+    uint64_t indexBytes = FEATURE_INDEX_HEADER_BYTES + (uint64_t)scan.count * scan.recordBytes;
+    printf("Scanned %llu index bytes in %.3f ms\n", (unsigned long long)indexBytes, elapsed * 1000);
+
+    if (q.minRms || q.minPeak || q.band || q.zcr) {
+        char blockPath[512];
+        if (indexArg != NULL) {
+            snprintf(blockPath, sizeof(blockPath), "%s", indexArg);
+        } else {
+            block_index_path(featurePath, blockPath, sizeof(blockPath));
+        }
+        BlockScan blocks;
+        bool haveBlocks = scan_blocks(blockPath, &blocks);
+        if (indexArg != NULL && !haveBlocks) {
+            fprintf(stderr, "Cannot read block index %s\n", blockPath);
+        }
+        search(&scan, &q, gapMs, haveBlocks ? &blocks : NULL);
+        if (haveBlocks) {
+            free(blocks.records);
+        }
+    }
+    free(scan.records);
+    return 0;
+}
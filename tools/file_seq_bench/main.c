@@ -0,0 +1,209 @@
+// 文件序号分配基准：在主机上建一个有n个录音文件的卡目录（默认5万个），对比
+//   - 原来的做法：所有录音平铺在根目录，每个新文件都扫描整个目录找最大序号；
+//   - FileSequence：序号分子目录存放，下一个序号从状态文件读取，只检查新文件是否存在。
+// 并检查状态文件缺失、损坏和落后于卡上文件时回退扫描得到的序号正确。
+//
+// 用法: file_seq_bench [-n 文件数] [-a 分配次数] [-o 目录]
+// 主机文件系统比FATFS快得多，设备上的代价按读过的目录项数估计（FAT目录项32字节，扇区512字节）。
+// 序号不连续或回退结果不正确时退出码为1。
+
+#define _XOPEN_SOURCE 700
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <dirent.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#include "FileSequence.h"
+
+#define PREFIX          "AUDIO"
+#define EXT             ".WAV"
+#define DIR_MAX_LEN     192
+#define PATH_MAX_LEN    256
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int remove_entry(const char *path, const struct stat *st, int flag, struct FTW *ftw) {
+    return remove(path);
+}
+
+static bool touch(const char *path) {
+    FILE *f = fopen(path, "wb");
+    return f != NULL && fclose(f) == 0;
+}
+
+// 原来的generate_audio_filename：扫描目录中的所有文件，取最大序号加1
+static int legacy_next(const char *dirPath, uint32_t *entries) {
+    DIR *dir = opendir(dirPath);
+    if (dir == NULL) {
+        return 1;
+    }
+    int maxIndex = 0, index;
+    size_t prefixLen = strlen(PREFIX);
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        (*entries)++;
+        if (strncmp(entry->d_name, PREFIX, prefixLen) == 0 &&
+            sscanf(entry->d_name + prefixLen, "%d", &index) == 1 && index > maxIndex) {
+            maxIndex = index;
+        }
+    }
+    closedir(dir);
+    return maxIndex + 1;
+}
+
+static void report(const char *name, double sec, uint32_t count, uint64_t entries) {
+    double perEntries = (double)entries / count;
+    printf("%-22s %9.1f us per new file, %9.1f directory entries read (~%.0f FAT sectors)\n", name,
+           sec * 1e6 / count, perEntries, perEntries * 32 / 512);
+}
+
+// 保存/恢复状态文件的原始内容，用来制造落后于卡上文件的状态
+static bool save_state(const char *statePath, uint8_t *buf, size_t *len) {
+    FILE *f = fopen(statePath, "rb");
+    if (f == NULL) {
+        return false;
+    }
+    *len = fread(buf, 1, 64, f);
+    fclose(f);
+    return *len > 0;
+}
+
+static bool restore_state(const char *statePath, const uint8_t *buf, size_t len) {
+    FILE *f = fopen(statePath, "wb");
+    return f != NULL && fwrite(buf, 1, len, f) == len && fclose(f) == 0;
+}
+
+// 打开序号状态并分配一个文件（相当于一次开始录音），检查得到的序号
+static bool open_and_allocate(const char *root, const char *statePath, uint32_t expected, FileSequence *seq) {
+    char path[PATH_MAX_LEN] = "";
+    uint32_t index = 0;
+    file_sequence_open(seq, root, PREFIX, statePath);
+    bool ok = file_sequence_next(seq, EXT, path, sizeof(path), &index) && touch(path);
+    file_sequence_close(seq);
+    if (!ok || index != expected) {
+        printf("Allocated %u, expected %u (%s)\n", (unsigned)index, (unsigned)expected, path);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    uint32_t files = 50000;
+    uint32_t allocs = 20;
+    const char *dir = "/tmp/file_seq_bench";
+    int c;
+    while ((c = getopt(argc, argv, "n:a:o:h")) != -1) {
+        switch (c) {
+        case 'n': files = strtoul(optarg, NULL, 0); break;
+        case 'a': allocs = strtoul(optarg, NULL, 0); break;
+        case 'o': dir = optarg; break;
+        default:
+            printf("Usage: %s [-n files] [-a allocations] [-o dir]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (files == 0 || allocs == 0 || files + allocs > FILE_SEQUENCE_MAX_INDEX) {
+        return 2;
+    }
+
+    char flatDir[DIR_MAX_LEN], seqDir[DIR_MAX_LEN], statePath[PATH_MAX_LEN], path[PATH_MAX_LEN];
+    snprintf(flatDir, sizeof(flatDir), "%s/flat", dir);
+    snprintf(seqDir, sizeof(seqDir), "%s/seq", dir);
+    snprintf(statePath, sizeof(statePath), "%s/RECORD.SEQ", seqDir);
+    nftw(dir, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+    if (mkdir(dir, 0755) != 0 || mkdir(flatDir, 0755) != 0 || mkdir(seqDir, 0755) != 0) {
+        printf("Failed to create %s\n", dir);
+        return 1;
+    }
+
+    // 两种布局各建files个录音
+    printf("Creating %u recordings in each layout under %s\n", (unsigned)files, dir);
+    for (uint32_t i = 1; i <= files; i++) {
+        snprintf(path, sizeof(path), "%s/%s%u%s", flatDir, PREFIX, (unsigned)i, EXT);
+        if (!touch(path)) {
+            printf("Failed to create %s\n", path);
+            return 1;
+        }
+    }
+    FileSequence seq;
+    file_sequence_open(&seq, seqDir, PREFIX, statePath);
+    for (uint32_t i = 1; i <= files; i++) {
+        uint32_t index;
+        if (!file_sequence_next(&seq, EXT, path, sizeof(path), &index) || !touch(path) || index != i) {
+            printf("Allocation %u failed (%s)\n", (unsigned)i, path);
+            return 1;
+        }
+    }
+    file_sequence_close(&seq);
+    printf("Subdirectories: %u, largest holds %u entries\n",
+           (unsigned)(files / FILE_SEQUENCE_PER_DIR + 1), (unsigned)FILE_SEQUENCE_PER_DIR);
+
+    // 原来的做法：每个新文件扫描整个目录
+    uint64_t entries = 0;
+    uint32_t next = files + 1;
+    double t0 = now_sec();
+    for (uint32_t i = 0; i < allocs; i++) {
+        uint32_t scanned = 0;
+        int index = legacy_next(flatDir, &scanned);
+        entries += scanned;
+        snprintf(path, sizeof(path), "%s/%s%d%s", flatDir, PREFIX, index, EXT);
+        if (index != (int)next++ || !touch(path)) {
+            printf("Legacy scan returned %d\n", index);
+            return 1;
+        }
+    }
+    report("flat directory scan", now_sec() - t0, allocs, entries);
+
+    // 状态文件有效：每次开始录音读取状态，检查一个文件是否存在
+    bool ok = true;
+    entries = 0;
+    next = files + 1;
+    t0 = now_sec();
+    for (uint32_t i = 0; i < allocs && ok; i++) {
+        ok = open_and_allocate(seqDir, statePath, next++, &seq);
+        entries += seq.scannedEntries;
+    }
+    report("sequence state", now_sec() - t0, allocs, entries);
+
+    // 状态文件缺失
+    remove(statePath);
+    t0 = now_sec();
+    ok = ok && open_and_allocate(seqDir, statePath, next++, &seq);
+    report("fallback: no state", now_sec() - t0, 1, seq.scannedEntries);
+
+    // 状态文件损坏
+    ok = ok && restore_state(statePath, (const uint8_t *)"garbage garbage!", 16);
+    t0 = now_sec();
+    ok = ok && open_and_allocate(seqDir, statePath, next++, &seq);
+    report("fallback: corrupt", now_sec() - t0, 1, seq.scannedEntries);
+
+    // 状态落后于卡上的文件（例如卡在别处被写过）：预测的文件已存在
+    uint8_t saved[64];
+    size_t savedLen = 0;
+    ok = ok && save_state(statePath, saved, &savedLen);
+    for (int i = 0; i < 3 && ok; i++) {
+        ok = open_and_allocate(seqDir, statePath, next++, &seq);
+    }
+    ok = ok && restore_state(statePath, saved, savedLen);
+    t0 = now_sec();
+    ok = ok && open_and_allocate(seqDir, statePath, next++, &seq);
+    report("fallback: stale", now_sec() - t0, 1, seq.scannedEntries);
+
+    // 归还最近分配的序号
+    uint32_t index = 0;
+    file_sequence_open(&seq, seqDir, PREFIX, statePath);
+    ok = ok && file_sequence_next(&seq, EXT, path, sizeof(path), &index) && index == next;
+    file_sequence_release(&seq, index);
+    file_sequence_close(&seq);
+    ok = ok && open_and_allocate(seqDir, statePath, next, &seq) && seq.scans == 0;
+
+    printf("Sequence checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,298 @@
+// FLAC编解码基准：用几种典型信号（静音、正弦、白噪声、低通噪声、方波突发、计数器、混合）
+// 编码成完整的码流（含FLAC_HEADER_BYTES的文件头和较短的最后一帧），报告编码/解码速度和压缩率，
+// 再用FlacDecoder逐帧解码，检查每个样本、帧序号和CRC。
+// 另外检查编码失败时的VERBATIM退路（capture管线的做法）和损坏的帧能被CRC发现。
+//
+// 用法: flac_bench [-c 通道数] [-n 每帧样本数] [-b 位数] [-r 采样率] [-k 每种信号的帧数] [-o 最高阶数]
+// 默认按设备的8通道/96kHz/16位、每帧2048个样本，每种信号200帧。
+// 任何样本不符、帧无法解码或退路失效时退出码为1。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <math.h>
+#include <time.h>
+#include "FlacEncoder.h"
+#include "FlacDecoder.h"
+
+typedef enum {
+    SIGNAL_SILENCE,
+    SIGNAL_SINE,
+    SIGNAL_NOISE,
+    SIGNAL_LOWPASS,
+    SIGNAL_SQUARE,
+    SIGNAL_COUNTER,
+    SIGNAL_MIXED,
+    SIGNAL_COUNT
+} Signal;
+
+static const char *signalNames[SIGNAL_COUNT] = {
+    "silence", "sine", "noise", "lowpass", "square", "counter", "mixed",
+};
+
+typedef struct {
+    FlacConfig config;
+    uint32_t frames;            // 每种信号的帧数（最后一帧较短）
+} Bench;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t rng_next(uint32_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// -1~1之间的均匀噪声
+static double rng_uniform(uint32_t *state) {
+    return (double)rng_next(state) / 2147483648.0 - 1.0;
+}
+
+// 把-1~1的值量化到bits位
+static int16_t quantize(double v, uint32_t bits) {
+    double full = (double)(1 << (bits - 1));
+    double q = floor(v * full + 0.5);
+    q = (q > full - 1) ? full - 1 : (q < -full) ? -full : q;
+    return (int16_t)q;
+}
+
+// 第n个样本（每通道）起的samples个交织样本
+static void generate(Signal signal, const FlacConfig *config, uint64_t n, uint32_t samples, int16_t *out,
+                     uint32_t *rng, double *lowpass) {
+    uint32_t channels = config->channels;
+    uint32_t bits = config->bitsPerSample;
+    for (uint32_t i = 0; i < samples; i++, n++) {
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            Signal s = (signal == SIGNAL_MIXED) ? (Signal)(ch % SIGNAL_MIXED) : signal;
+            double t = (double)n / config->sampleRate;
+            int16_t v = 0;
+            switch (s) {
+            case SIGNAL_SILENCE:
+                v = 0;
+                break;
+            case SIGNAL_SINE:
+                v = quantize(0.5 * sin(2 * M_PI * 440.0 * (ch + 1) * t), bits);
+                break;
+            case SIGNAL_NOISE:
+                v = quantize(rng_uniform(rng), bits);
+                break;
+            case SIGNAL_LOWPASS:
+                lowpass[ch] += 0.05 * (rng_uniform(rng) - lowpass[ch]);
+                v = quantize(4 * lowpass[ch], bits);
+                break;
+            case SIGNAL_SQUARE:
+                // 每4096个样本中前1024个为方波，其余为静音
+                v = ((n % 4096) < 1024) ? quantize(((n / 50) & 1) ? 0.3 : -0.3, bits) : 0;
+                break;
+            case SIGNAL_COUNTER:
+                v = (int16_t)((int32_t)(((n * channels + ch) & ((1u << bits) - 1)) << (32 - bits)) >> (32 - bits));
+                break;
+            default:
+                break;
+            }
+            out[(size_t)i * channels + ch] = v;
+        }
+    }
+}
+
+// 编码、解码一种信号，返回是否逐样本一致
+static bool run_signal(const Bench *bench, Signal signal) {
+    const FlacConfig *config = &bench->config;
+    uint32_t channels = config->channels;
+    uint32_t blockSize = config->blockSize;
+    uint32_t lastSamples = blockSize / 3 + 1;
+    uint64_t totalSamples = (uint64_t)(bench->frames - 1) * blockSize + lastSamples;
+    size_t frameCap = FLAC_MAX_FRAME_BYTES(channels, blockSize, config->bitsPerSample);
+
+    int16_t *pcm = malloc(totalSamples * channels * sizeof(int16_t));
+    int16_t *decoded = malloc((size_t)blockSize * channels * sizeof(int16_t));
+    uint8_t *stream = malloc(FLAC_HEADER_BYTES + (size_t)bench->frames * frameCap);
+    uint32_t rng = 0x12345678u + signal;
+    double lowpass[FLAC_MAX_CHANNELS] = { 0 };
+    generate(signal, config, 0, (uint32_t)totalSamples, pcm, &rng, lowpass);
+
+    FlacEncoder encoder;
+    if (!flac_encoder_init(&encoder, config)) {
+        printf("%-8s encoder rejected the configuration -> FAILED\n", signalNames[signal]);
+        free(pcm);
+        free(decoded);
+        free(stream);
+        return false;
+    }
+
+    // 编码
+    FlacStreamInfo info = { .totalSamples = totalSamples, .minFrameBytes = UINT32_MAX };
+    size_t pos = FLAC_HEADER_BYTES;
+    bool ok = true;
+    double t0 = now_sec();
+    for (uint32_t f = 0; f < bench->frames && ok; f++) {
+        uint32_t samples = (f == bench->frames - 1) ? lastSamples : blockSize;
+        size_t len = flac_encode_frame(&encoder, pcm + (size_t)f * blockSize * channels, samples, stream + pos,
+                                       frameCap);
+        ok = len != 0;
+        info.minFrameBytes = (len < info.minFrameBytes) ? (uint32_t)len : info.minFrameBytes;
+        info.maxFrameBytes = (len > info.maxFrameBytes) ? (uint32_t)len : info.maxFrameBytes;
+        pos += len;
+    }
+    double encodeSec = now_sec() - t0;
+    ok = ok && flac_build_header(stream, config, &info);
+    flac_encoder_deinit(&encoder);
+
+    // 解码并逐样本比较
+    FlacStreamHeader header;
+    uint32_t subframes[4] = { 0 };
+    uint64_t mismatches = 0, decodedSamples = 0, badFrames = 0;
+    double decodeSec = 0;
+    if (ok && flac_parse_stream_header(stream, pos, &header)) {
+        ok = header.audioOffset == FLAC_HEADER_BYTES && header.channels == channels &&
+             header.bitsPerSample == config->bitsPerSample && header.sampleRate == config->sampleRate &&
+             header.maxBlockSize == blockSize && header.stream.totalSamples == totalSamples &&
+             header.stream.minFrameBytes == info.minFrameBytes && header.stream.maxFrameBytes == info.maxFrameBytes;
+        size_t offset = header.audioOffset;
+        for (uint32_t f = 0; offset < pos; f++) {
+            FlacFrameInfo frame;
+            t0 = now_sec();
+            size_t len = flac_decode_frame(&header, stream + offset, pos - offset, decoded,
+                                           (size_t)blockSize * channels, &frame);
+            decodeSec += now_sec() - t0;
+            if (len == 0 || frame.number != f || decodedSamples + frame.samples > totalSamples) {
+                badFrames++;
+                break;
+            }
+            const int16_t *expected = pcm + decodedSamples * channels;
+            for (size_t i = 0; i < (size_t)frame.samples * channels; i++) {
+                mismatches += decoded[i] != expected[i];
+            }
+            for (int t = 0; t < 4; t++) {
+                subframes[t] += frame.subframes[t];
+            }
+            decodedSamples += frame.samples;
+            offset += len;
+        }
+    } else {
+        ok = false;
+    }
+    ok = ok && badFrames == 0 && mismatches == 0 && decodedSamples == totalSamples;
+
+    double pcmBytes = (double)totalSamples * channels * sizeof(int16_t);
+    printf("%-8s encode %7.1f MB/s, decode %7.1f MB/s, ratio %5.3f, subframes %u/%u/%u/%u "
+           "(constant/verbatim/fixed/lpc): %llu of %llu samples decoded, %llu mismatches -> %s\n",
+           signalNames[signal], pcmBytes / encodeSec / 1e6, decodeSec > 0 ? pcmBytes / decodeSec / 1e6 : 0.0,
+           (double)(pos - FLAC_HEADER_BYTES) / pcmBytes, (unsigned)subframes[0], (unsigned)subframes[1],
+           (unsigned)subframes[2], (unsigned)subframes[3], (unsigned long long)decodedSamples,
+           (unsigned long long)totalSamples, (unsigned long long)mismatches, ok ? "ok" : "FAILED");
+
+    free(pcm);
+    free(decoded);
+    free(stream);
+    return ok;
+}
+
+// 编码失败时的退路：输出空间不足时flac_encode_frame返回0且不推进帧序号，
+// flac_encode_verbatim_frame写出的帧全部是VERBATIM子帧，并且能逐样本解码。
+// 再把帧中的一个字节改掉，解码必须因CRC不符而失败。
+static bool run_fallback(const Bench *bench) {
+    const FlacConfig *config = &bench->config;
+    uint32_t channels = config->channels;
+    uint32_t blockSize = config->blockSize;
+    size_t frameCap = FLAC_MAX_FRAME_BYTES(channels, blockSize, config->bitsPerSample);
+    int16_t *pcm = malloc((size_t)blockSize * channels * sizeof(int16_t));
+    int16_t *decoded = malloc((size_t)blockSize * channels * sizeof(int16_t));
+    uint8_t *stream = malloc(FLAC_HEADER_BYTES + 2 * frameCap);
+    uint32_t rng = 0xC0FFEEu;
+    double lowpass[FLAC_MAX_CHANNELS] = { 0 };
+    generate(SIGNAL_NOISE, config, 0, blockSize, pcm, &rng, lowpass);
+
+    FlacEncoder encoder;
+    bool ok = flac_encoder_init(&encoder, config);
+    FlacStreamInfo info = { .totalSamples = 2ull * blockSize };
+    ok = ok && flac_build_header(stream, config, &info);
+    // 第0帧正常编码，第1帧先因空间不足失败，再用VERBATIM写出
+    size_t first = ok ? flac_encode_frame(&encoder, pcm, blockSize, stream + FLAC_HEADER_BYTES, frameCap) : 0;
+    uint8_t *second = stream + FLAC_HEADER_BYTES + first;
+    size_t failed = flac_encode_frame(&encoder, pcm, blockSize, second, frameCap / 4);
+    size_t verbatim = flac_encode_verbatim_frame(&encoder, pcm, blockSize, second, frameCap);
+    flac_encoder_deinit(&encoder);
+    ok = ok && first != 0 && failed == 0 && verbatim != 0 && verbatim <= frameCap;
+
+    FlacStreamHeader header;
+    FlacFrameInfo frame = { 0 };
+    size_t len = 0;
+    uint64_t mismatches = 0;
+    if (ok && flac_parse_stream_header(stream, FLAC_HEADER_BYTES + first + verbatim, &header)) {
+        len = flac_decode_frame(&header, second, verbatim, decoded, (size_t)blockSize * channels, &frame);
+        for (size_t i = 0; len != 0 && i < (size_t)blockSize * channels; i++) {
+            mismatches += decoded[i] != pcm[i];
+        }
+    }
+    ok = ok && len == verbatim && frame.number == 1 && frame.samples == blockSize &&
+         frame.subframes[1] == channels && mismatches == 0;
+
+    // 损坏的帧：改动中间的一个字节
+    second[verbatim / 2] ^= 0x10;
+    bool crcCaught = flac_decode_frame(&header, second, verbatim, decoded, (size_t)blockSize * channels, &frame) == 0;
+    ok = ok && crcCaught;
+
+    printf("fallback encode into %zu bytes %s, verbatim frame %zu bytes (limit %zu), frame %llu, "
+           "%u verbatim subframes, %llu mismatches, corrupted frame %s -> %s\n",
+           frameCap / 4, failed == 0 ? "failed" : "succeeded", verbatim, frameCap, (unsigned long long)frame.number,
+           (unsigned)frame.subframes[1], (unsigned long long)mismatches, crcCaught ? "rejected" : "accepted",
+           ok ? "ok" : "FAILED");
+
+    free(pcm);
+    free(decoded);
+    free(stream);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    Bench bench = {
+        .config = {
+            .sampleRate = 96000,
+            .channels = 8,
+            .bitsPerSample = 16,
+            .blockSize = 2048,
+            .maxOrder = FLAC_MAX_FIXED_ORDER,
+            .maxPartitionOrder = FLAC_MAX_PARTITION_ORDER,
+        },
+        .frames = 200,
+    };
+    int c;
+    while ((c = getopt(argc, argv, "c:n:b:r:k:o:h")) != -1) {
+        switch (c) {
+        case 'c': bench.config.channels = strtoul(optarg, NULL, 0); break;
+        case 'n': bench.config.blockSize = strtoul(optarg, NULL, 0); break;
+        case 'b': bench.config.bitsPerSample = strtoul(optarg, NULL, 0); break;
+        case 'r': bench.config.sampleRate = strtoul(optarg, NULL, 0); break;
+        case 'k': bench.frames = strtoul(optarg, NULL, 0); break;
+        case 'o': bench.config.maxOrder = strtoul(optarg, NULL, 0); break;
+        default:
+            printf("Usage: %s [-c channels] [-n block_size] [-b bits] [-r sample_rate] [-k frames_per_signal] "
+                   "[-o max_order]\n", argv[0]);
+            return 2;
+        }
+    }
+    FlacEncoder probe;
+    if (bench.frames < 2 || !flac_encoder_init(&probe, &bench.config)) {
+        printf("Invalid configuration\n");
+        return 2;
+    }
+    flac_encoder_deinit(&probe);
+
+    printf("FLAC: %u channels, %u Hz, %u bits, %u samples per frame, %u frames per signal\n",
+           (unsigned)bench.config.channels, (unsigned)bench.config.sampleRate, (unsigned)bench.config.bitsPerSample,
+           (unsigned)bench.config.blockSize, (unsigned)bench.frames);
+    bool ok = true;
+    for (int s = 0; s < SIGNAL_COUNT; s++) {
+        ok = run_signal(&bench, (Signal)s) && ok;
+    }
+    ok = run_fallback(&bench) && ok;
+    printf("FLAC checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
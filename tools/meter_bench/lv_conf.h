@@ -0,0 +1,25 @@
+// 主机上编译LVGL用的配置，与设备的sdkconfig（menuconfig中的LVGL选项）保持一致：
+// 16位颜色、48KB内存池、30ms刷新周期、Montserrat 12/14/16字体、默认主题。
+// 其余选项使用lv_conf_internal.h的默认值；关闭性能监视器，避免它的标签计入测量。
+
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#define LV_COLOR_DEPTH              16
+#define LV_COLOR_16_SWAP            0
+#define LV_MEM_SIZE                 (48U * 1024U)
+#define LV_DISP_DEF_REFR_PERIOD     30
+#define LV_INDEV_DEF_READ_PERIOD    30
+#define LV_DPI_DEF                  130
+#define LV_USE_PERF_MONITOR         0
+#define LV_USE_LOG                  0
+
+#define LV_FONT_MONTSERRAT_12       1
+#define LV_FONT_MONTSERRAT_14       1
+#define LV_FONT_MONTSERRAT_16       1
+#define LV_FONT_DEFAULT             &lv_font_montserrat_14
+
+#define LV_USE_THEME_DEFAULT        1
+#define LV_THEME_DEFAULT_DARK       0
+
+#endif /* LV_CONF_H */
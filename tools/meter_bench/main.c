@@ -0,0 +1,197 @@
+// 电平表界面基准：在主机上编译LVGL和设备上的同一份界面代码（LevelMeterUI），用合成的8路信号
+// 驱动电平/频谱抽头（LevelTap），逐帧测量界面更新（含FFT）和LVGL绘制的时间以及刷新到屏幕的像素数，
+// 并与每帧整屏重绘对比。
+//
+// 用法: meter_bench [-t 秒] [-r 采样率] [-f 每块帧数] [-s]
+//   -s  信号在第一秒之后变为静音（检查电平稳定后不再重绘）
+// 只报告主机上的CPU占用；主机上已经超出LevelMeter的预算时设备上必然超出，退出码为1。
+// 显示帧周期和预算与设备相同（LEVEL_METER_FRAME_MS、LEVEL_METER_BUDGET_PERMILLE）。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <getopt.h>
+#include <time.h>
+#include "lvgl.h"
+#include "LevelTap.h"
+#include "LevelMeterUI.h"
+
+#define BENCH_CHANNELS      8
+#define SCREEN_W            172     // 与ST7789.h一致
+#define SCREEN_H            320
+#define DRAW_BUF_LINES      20      // 与LVGL_Driver.c一致
+#define FRAME_MS            40      // LEVEL_METER_FRAME_MS
+#define BUDGET_PERMILLE     150     // LEVEL_METER_BUDGET_PERMILLE
+
+static lv_color_t buf1[SCREEN_W * DRAW_BUF_LINES];
+static lv_color_t buf2[SCREEN_W * DRAW_BUF_LINES];
+static uint64_t flushedPixels;
+static uint32_t flushCalls;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 模拟SPI刷新：只统计像素数，立即完成
+static void bench_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *colorMap) {
+    flushedPixels += (uint64_t)lv_area_get_size(area);
+    flushCalls++;
+    lv_disp_flush_ready(drv);
+}
+
+// 伪随机噪声（xorshift），[-1, 1)
+static uint32_t rngState = 0x2545F491;
+static float noise(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return (float)(int32_t)rngState / 2147483648.0f;
+}
+
+// 合成信号：槽位c是频率递增的正弦，电平按0.5Hz起伏（-6到-40dBFS），叠加-50dBFS噪声
+static void fill_block(int16_t *block, uint32_t frames, uint64_t firstFrame, uint32_t sampleRate, bool silent) {
+    for (uint32_t f = 0; f < frames; f++) {
+        double t = (double)(firstFrame + f) / sampleRate;
+        for (uint32_t c = 0; c < BENCH_CHANNELS; c++) {
+            float x = 0.0f;
+            if (!silent) {
+                float envelopeDb = -23.0f - 4.0f * c + 17.0f * (float)sin(2.0 * M_PI * 0.5 * t + c);
+                float amplitude = powf(10.0f, envelopeDb / 20.0f);
+                x = amplitude * (float)sin(2.0 * M_PI * 220.0 * (c + 1) * t) + 0.003f * noise();
+            }
+            block[(size_t)f * BENCH_CHANNELS + c] = (int16_t)lrintf(x * 32767.0f);
+        }
+    }
+}
+
+typedef struct {
+    double updateSec;       // 界面更新（含FFT）
+    double renderSec;       // LVGL绘制
+    double feedSec;         // 抽头（采集任务一侧）
+    double maxFrameSec;
+    uint64_t pixels;
+    uint32_t frames;
+    uint32_t blocks;
+} BenchResult;
+
+// 运行seconds秒的模拟：每块喂给抽头，每FRAME_MS读取快照、更新界面并绘制。
+// fullRedraw时每帧整屏无效，作为对比
+static void run(LevelMeterUI *ui, LevelTap *tap, uint32_t seconds, uint32_t sampleRate, uint32_t blockFrames,
+                bool silentAfterFirst, bool fullRedraw, BenchResult *result) {
+    // 模拟时钟在两次运行之间连续，抽头和界面的时间状态不需要重置
+    static int64_t simUs = 0;
+    memset(result, 0, sizeof(*result));
+    int16_t *block = malloc((size_t)blockFrames * BENCH_CHANNELS * sizeof(int16_t));
+    uint64_t sampleFrames = 0;
+    int64_t startUs = simUs;
+    int64_t nextFrameUs = simUs;
+    int64_t endUs = simUs + (int64_t)seconds * 1000000;
+    int64_t blockUs = (int64_t)blockFrames * 1000000 / sampleRate;
+    int64_t nextBlockUs = simUs + blockUs;
+
+    while (simUs < endUs) {
+        // 下一个事件：块读完或显示帧到期
+        if (nextBlockUs <= nextFrameUs) {
+            simUs = nextBlockUs;
+            fill_block(block, blockFrames, sampleFrames, sampleRate, silentAfterFirst && simUs - startUs > 1000000);
+            double t0 = now_sec();
+            level_tap_feed(tap, block, blockFrames, simUs);
+            result->feedSec += now_sec() - t0;
+            sampleFrames += blockFrames;
+            nextBlockUs += blockUs;
+            result->blocks++;
+            continue;
+        }
+        lv_tick_inc((uint32_t)((nextFrameUs - simUs) / 1000));
+        simUs = nextFrameUs;
+        nextFrameUs += FRAME_MS * 1000;
+
+        uint64_t pixelsBefore = flushedPixels;
+        double t0 = now_sec();
+        const LevelSnapshot *snap = level_tap_read(tap, NULL);
+        level_meter_ui_update(ui, snap, simUs);
+        if (fullRedraw) {
+            lv_obj_invalidate(lv_scr_act());
+        }
+        double t1 = now_sec();
+        lv_refr_now(NULL);
+        double t2 = now_sec();
+        result->updateSec += t1 - t0;
+        result->renderSec += t2 - t1;
+        result->maxFrameSec = (t2 - t0 > result->maxFrameSec) ? t2 - t0 : result->maxFrameSec;
+        result->pixels += flushedPixels - pixelsBefore;
+        result->frames++;
+    }
+    free(block);
+}
+
+static void report(const char *name, const BenchResult *r) {
+    double frameUs = (r->updateSec + r->renderSec) * 1e6 / r->frames;
+    printf("%-12s update %6.1f us, render %7.1f us, max %7.1f us per frame; %7.0f px/frame (%5.1f%% of screen)\n",
+           name, r->updateSec * 1e6 / r->frames, r->renderSec * 1e6 / r->frames, r->maxFrameSec * 1e6,
+           (double)r->pixels / r->frames, 100.0 * r->pixels / r->frames / (SCREEN_W * SCREEN_H));
+    printf("%-12s load at %d ms frames: %.2f%% host CPU, device budget %.1f%%\n", "", FRAME_MS,
+           frameUs / (FRAME_MS * 10.0), BUDGET_PERMILLE / 10.0);
+}
+
+int main(int argc, char **argv) {
+    uint32_t seconds = 20;
+    uint32_t sampleRate = 48000;
+    uint32_t blockFrames = 1024;
+    bool silent = false;
+    int c;
+    while ((c = getopt(argc, argv, "t:r:f:sh")) != -1) {
+        switch (c) {
+        case 't': seconds = strtoul(optarg, NULL, 0); break;
+        case 'r': sampleRate = strtoul(optarg, NULL, 0); break;
+        case 'f': blockFrames = strtoul(optarg, NULL, 0); break;
+        case 's': silent = true; break;
+        default:
+            printf("Usage: %s [-t seconds] [-r sample_rate] [-f frames_per_block] [-s]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (seconds == 0 || sampleRate == 0 || blockFrames == 0) {
+        return 2;
+    }
+
+    lv_init();
+    static lv_disp_draw_buf_t drawBuf;
+    static lv_disp_drv_t dispDrv;
+    lv_disp_draw_buf_init(&drawBuf, buf1, buf2, SCREEN_W * DRAW_BUF_LINES);
+    lv_disp_drv_init(&dispDrv);
+    dispDrv.hor_res = SCREEN_W;
+    dispDrv.ver_res = SCREEN_H;
+    dispDrv.flush_cb = bench_flush_cb;
+    dispDrv.draw_buf = &drawBuf;
+    lv_disp_drv_register(&dispDrv);
+
+    static LevelTap tap;
+    static LevelMeterUI ui;
+    level_tap_init(&tap);
+    level_tap_select_channel(&tap, 2);
+    if (!level_tap_configure(&tap, BENCH_CHANNELS, 2, (1u << BENCH_CHANNELS) - 1, sampleRate) ||
+        !level_meter_ui_create(&ui, lv_scr_act())) {
+        printf("Failed to set up the level meter\n");
+        return 1;
+    }
+    lv_refr_now(NULL);      // 第一帧整屏绘制，不计入
+    printf("Screen %dx%d, %u Hz, %u frames per block, %u s%s\n", SCREEN_W, SCREEN_H, (unsigned)sampleRate,
+           (unsigned)blockFrames, (unsigned)seconds, silent ? ", silent after 1 s" : "");
+
+    BenchResult incremental, full;
+    run(&ui, &tap, seconds, sampleRate, blockFrames, silent, false, &incremental);
+    run(&ui, &tap, seconds, sampleRate, blockFrames, silent, true, &full);
+
+    printf("Tap (capture task): %.2f us per block, %u snapshots\n", incremental.feedSec * 1e6 / incremental.blocks,
+           (unsigned)tap.seq);
+    report("incremental", &incremental);
+    report("full redraw", &full);
+    printf("Flushes: %u\n", (unsigned)flushCalls);
+
+    double loadPermille = (incremental.updateSec + incremental.renderSec) * 1e6 / incremental.frames / FRAME_MS;
+    return (loadPermille > BUDGET_PERMILLE) ? 1 : 0;
+}
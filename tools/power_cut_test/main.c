@@ -0,0 +1,697 @@
+// 断电恢复测试：在主机上用POSIX后端的RecordWriter按文件任务的顺序写录音（文件头、数据块、
+// 检查点回写文件头并落盘、提交恢复日志），在随机的块写入、文件头回写、落盘或日志提交处"断电"，
+// 按SD卡的行为处理断电后的文件：已落盘的部分保留，之后写入的数据随机丢失一部分，
+// 目录项长度停留在预分配大小或上次落盘的长度，尾部是垃圾数据；日志提交时断电还可能留下写了一半的槽。
+// 然后调用recovery_journal_recover，检查：
+//  - 文件截断到最后一次提交的长度，提交的数据逐字节完好；第一次提交之前断电时文件被删除
+//  - WAV文件头能解析，数据长度等于截断后的长度（按帧对齐）；非WAV文件（FLAC）只截断，文件头不变
+//  - 写了一半的日志槽被忽略，恢复按另一个槽中较早的提交进行；两个槽的generation分处32位回绕两边时仍选对较新的槽
+//  - 恢复后日志标记为已关闭，再次恢复不做任何事；没有断电、正常关闭的录音不被改动
+//  - 附属文件（索引那样的非WAV文件或WAV格式的附属音频，同采集管线在录音文件之前落盘）截断到
+//    同一次提交时的长度，WAV头同样修复；录音文件被删除时附属文件也被删除；录音中途因写入失败
+//    而关闭的附属文件在之后的提交中注销，恢复时保持关闭时的长度
+// 另外用稀疏文件构造超过4GB的录音，检查修复后的文件头走RF64分支；并检查删除的文件清空日志中的登记后，
+// 恢复不再处理它。
+//
+// 用法: power_cut_test [-n 次数] [-s 随机种子] [-o 目录]
+// 任何一项检查不通过时退出码为1。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "RecordWriter.h"
+#include "RecoveryJournal.h"
+#include "WavFormat.h"
+
+typedef enum {
+    CUT_NONE,
+    CUT_DATA,           // 块写入（含关闭时写出暂存区）
+    CUT_HEADER,         // 检查点回写文件头
+    CUT_SYNC,           // 检查点落盘
+    CUT_JOURNAL,        // 日志提交之前
+    CUT_TORN,           // 日志提交写了一半
+    CUT_END,            // 文件已关闭，日志还没标记为关闭
+    CUT_KINDS
+} CutKind;
+
+static const char *cutNames[CUT_KINDS] = {
+    "no cut", "block write", "header write", "sync", "journal commit", "torn journal slot", "journal end",
+};
+
+// 模拟的电源和SD卡状态（后端没有上下文参数，同capture_bench用静态变量）
+typedef struct {
+    const RecordBackend *base;
+    const char *path;
+    uint64_t opsLeft;           // 剩余的存储操作数，减到0时断电
+    CutKind cut;
+    uint64_t prealloc;
+    uint64_t pos;               // 顺序写入的位置
+    uint64_t syncedLen;         // 上次落盘时的长度
+    uint8_t header[WAV_HEADER_BYTES];       // 文件头的当前内容
+    uint8_t syncedHeader[WAV_HEADER_BYTES]; // 上次落盘时的文件头
+    uint8_t diskHeader[WAV_HEADER_BYTES];   // 断电后卡上的文件头
+    uint32_t rng;
+} Power;
+
+static Power power;
+
+static uint32_t rng_next(uint32_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// 录音文件中偏移o处应有的字节（文件头之后）
+static inline uint8_t pattern(uint64_t o, uint32_t seed) {
+    return (uint8_t)(((uint32_t)(o ^ (o >> 32)) * 0x9E3779B1u + seed) >> 24);
+}
+
+// 一次存储操作：断电后不再执行，减到0的那次操作本身也没有执行
+static bool power_op(CutKind kind) {
+    if (power.cut != CUT_NONE) {
+        return false;
+    }
+    if (power.opsLeft != 0 && --power.opsLeft == 0) {
+        power.cut = kind;
+        return false;
+    }
+    return true;
+}
+
+static void track_header(uint64_t offset, const void *data, size_t len) {
+    if (offset < WAV_HEADER_BYTES) {
+        size_t n = (len < WAV_HEADER_BYTES - offset) ? len : WAV_HEADER_BYTES - (size_t)offset;
+        memcpy(power.header + offset, data, n);
+    }
+}
+
+static void fill_garbage(int fd, uint64_t from, uint64_t to) {
+    uint8_t buf[4096];
+    while (from < to) {
+        size_t n = (to - from < sizeof(buf)) ? (size_t)(to - from) : sizeof(buf);
+        for (size_t i = 0; i < n; i++) {
+            buf[i] = (uint8_t)rng_next(&power.rng);
+        }
+        if (pwrite(fd, buf, n, (off_t)from) != (ssize_t)n) {
+            return;
+        }
+        from += n;
+    }
+}
+
+// 断电后卡上的文件：目录项长度为预分配大小（或上次落盘的长度），落盘之后写入的数据只有随机的一部分留下，
+// 其余和预分配的尾部都是垃圾；未落盘的文件头回写随机丢失
+static void power_off(void *handle) {
+    uint64_t cardLen = (power.prealloc > power.syncedLen) ? power.prealloc : power.syncedLen;
+    power.base->close(handle, cardLen);
+
+    int fd = open(power.path, O_RDWR);
+    if (fd < 0) {
+        return;
+    }
+    uint64_t written = (power.pos < cardLen) ? power.pos : cardLen;
+    uint64_t kept = (written > power.syncedLen) ? rng_next(&power.rng) % (written - power.syncedLen + 1) : 0;
+    fill_garbage(fd, power.syncedLen + kept, cardLen);
+
+    memcpy(power.diskHeader, power.header, WAV_HEADER_BYTES);
+    if (power.syncedLen >= WAV_HEADER_BYTES && (rng_next(&power.rng) & 1)) {
+        memcpy(power.diskHeader, power.syncedHeader, WAV_HEADER_BYTES);
+        pwrite(fd, power.diskHeader, WAV_HEADER_BYTES, 0);
+    }
+    close(fd);
+}
+
+static void *cut_open(const char *path, uint64_t preallocBytes) {
+    power.prealloc = preallocBytes;
+    return power.base->open(path, preallocBytes);
+}
+
+static bool cut_write(void *handle, const void *data, size_t len) {
+    if (!power_op(CUT_DATA)) {
+        return false;
+    }
+    track_header(power.pos, data, len);
+    power.pos += len;
+    return power.base->write(handle, data, len);
+}
+
+static bool cut_write_at(void *handle, uint64_t offset, const void *data, size_t len) {
+    if (!power_op(CUT_HEADER)) {
+        return false;
+    }
+    track_header(offset, data, len);
+    return power.base->write_at(handle, offset, data, len);
+}
+
+static bool cut_sync(void *handle) {
+    if (!power_op(CUT_SYNC) || !power.base->sync(handle)) {
+        return false;
+    }
+    power.syncedLen = power.pos;
+    memcpy(power.syncedHeader, power.header, WAV_HEADER_BYTES);
+    return true;
+}
+
+static bool cut_close(void *handle, uint64_t finalSize) {
+    if (power.cut != CUT_NONE) {
+        power_off(handle);
+        return false;
+    }
+    return power.base->close(handle, finalSize);
+}
+
+static bool cut_remove(const char *path) {
+    return power.base->remove(path);
+}
+
+static const RecordBackend cutBackend = {
+    .open = cut_open,
+    .write = cut_write,
+    .write_at = cut_write_at,
+    .sync = cut_sync,
+    .close = cut_close,
+    .remove = cut_remove,
+};
+
+typedef struct {
+    bool wav;
+    WavFormat format;
+    uint32_t checkpoints;
+} HeaderCtx;
+
+static void build_header(const HeaderCtx *ctx, uint64_t flushed, uint8_t *out) {
+    if (ctx->wav) {
+        uint64_t dataBytes = flushed - WAV_HEADER_BYTES;
+        wav_build_header(out, &ctx->format, dataBytes - dataBytes % wav_block_align(&ctx->format));
+    } else {
+        // FLAC：STREAMINFO在检查点回写，这里只用检查点计数代替
+        memset(out, 0, WAV_HEADER_BYTES);
+        memcpy(out, "fLaC", 4);
+        memcpy(out + 4, &ctx->checkpoints, sizeof(ctx->checkpoints));
+    }
+}
+
+// 检查点回调：同采集管线，用已落盘的长度回写文件头
+static bool header_hook(RecordWriter *writer, void *arg) {
+    HeaderCtx *ctx = arg;
+    uint8_t header[WAV_HEADER_BYTES];
+    ctx->checkpoints++;
+    build_header(ctx, record_writer_flushed_bytes(writer), header);
+    return record_writer_write_at(writer, 0, header, WAV_HEADER_BYTES);
+}
+
+// 日志提交写了一半：下一次提交的槽里只写进了新记录的前一部分（其余仍是旧记录），或是一段垃圾
+static bool tear_journal(const char *journalPath, const RecoveryRecord *next) {
+    FILE *f = fopen(journalPath, "r+b");
+    if (f == NULL) {
+        return false;
+    }
+    uint8_t bytes[sizeof(RecoveryRecord)];
+    uint32_t offset = 0, len = 1 + rng_next(&power.rng) % (sizeof(RecoveryRecord) - 1);
+    if (rng_next(&power.rng) & 1) {
+        memcpy(bytes, next, len);
+    } else {
+        offset = rng_next(&power.rng) % sizeof(RecoveryRecord);
+        len = 1 + rng_next(&power.rng) % (sizeof(RecoveryRecord) - offset);
+        for (uint32_t i = 0; i < len; i++) {
+            bytes[i] = (uint8_t)rng_next(&power.rng);
+        }
+    }
+    uint32_t slot = next->generation & 1;     // 每个槽占一个扇区
+    bool ok = fseek(f, (long)(slot * 512 + offset), SEEK_SET) == 0 && fwrite(bytes, 1, len, f) == len;
+    return fclose(f) == 0 && ok;
+}
+
+// 检查文件是否恰好为length字节，且文件头之后的内容都是写入的数据
+static bool check_content(const char *path, uint64_t length, uint32_t seed, const char **why) {
+    struct stat st;
+    if (stat(path, &st) != 0 || (uint64_t)st.st_size != length) {
+        *why = "file length is not the committed length";
+        return false;
+    }
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        *why = "file cannot be opened";
+        return false;
+    }
+    uint8_t buf[65536];
+    uint64_t offset = WAV_HEADER_BYTES;
+    bool ok = fseek(f, WAV_HEADER_BYTES, SEEK_SET) == 0;
+    while (ok && offset < length) {
+        size_t n = (length - offset < sizeof(buf)) ? (size_t)(length - offset) : sizeof(buf);
+        ok = fread(buf, 1, n, f) == n;
+        for (size_t i = 0; ok && i < n; i++) {
+            ok = buf[i] == pattern(offset + i, seed);
+        }
+        offset += n;
+    }
+    fclose(f);
+    if (!ok) {
+        *why = "committed data is damaged";
+    }
+    return ok;
+}
+
+// 恢复后的文件头：WAV能解析且数据长度与文件长度一致，FLAC与断电时卡上的文件头相同
+static bool check_header(const char *path, const HeaderCtx *ctx, uint64_t length, const char **why) {
+    uint8_t header[WAV_HEADER_BYTES];
+    FILE *f = fopen(path, "rb");
+    bool ok = f != NULL && fread(header, 1, sizeof(header), f) == sizeof(header);
+    if (f != NULL) {
+        fclose(f);
+    }
+    if (!ok) {
+        *why = "header cannot be read";
+        return false;
+    }
+    if (!ctx->wav) {
+        ok = memcmp(header, power.diskHeader, WAV_HEADER_BYTES) == 0;
+        *why = ok ? NULL : "non-WAV header was modified";
+        return ok;
+    }
+    WavInfo info;
+    uint64_t dataBytes = length - WAV_HEADER_BYTES;
+    dataBytes -= dataBytes % wav_block_align(&ctx->format);
+    ok = wav_parse_header(header, sizeof(header), &info) && info.dataOffset == WAV_HEADER_BYTES &&
+         info.dataBytes == dataBytes && !info.rf64 && info.format.channels == ctx->format.channels &&
+         info.format.containerBits == ctx->format.containerBits && info.format.sampleRate == ctx->format.sampleRate;
+    *why = ok ? NULL : "WAV header does not describe the truncated file";
+    return ok;
+}
+
+// 附属文件：用POSIX后端直接写，断电时按同样的规则处理卡上的内容
+typedef struct {
+    HeaderCtx ctx;
+    char path[256];
+    RecordWriter writer;
+    uint64_t prealloc;
+    uint64_t syncedLen;         // 上次检查点落盘的长度
+    uint64_t committed;         // 日志中提交的长度
+    bool registered;            // 仍在日志中登记（中途关闭后的下一次提交注销）
+    uint32_t seed;
+} Sidecar;
+
+// 附属文件断电：关闭后把长度恢复为预分配大小，上次落盘之后的数据只有随机的一部分留下
+static void sidecar_power_off(Sidecar *side) {
+    uint64_t written = side->writer.bytesWritten;
+    record_writer_close(&side->writer);
+    uint64_t cardLen = (side->prealloc > side->syncedLen) ? side->prealloc : side->syncedLen;
+    int fd = open(side->path, O_RDWR);
+    if (fd < 0) {
+        return;
+    }
+    if (ftruncate(fd, (off_t)cardLen) == 0) {
+        uint64_t end = (written < cardLen) ? written : cardLen;
+        uint64_t kept = (end > side->syncedLen) ? rng_next(&power.rng) % (end - side->syncedLen + 1) : 0;
+        fill_garbage(fd, side->syncedLen + kept, cardLen);
+    }
+    close(fd);
+}
+
+// 恢复后的附属文件：length为0时应已删除
+static bool check_sidecar(const Sidecar *side, uint64_t length, const char **why) {
+    if (length == 0) {
+        *why = (access(side->path, F_OK) == 0) ? "sidecar of a removed recording was not removed" : NULL;
+        return *why == NULL;
+    }
+    const char *reason = NULL;
+    if (!check_content(side->path, length, side->seed, &reason)) {
+        *why = (strcmp(reason, "committed data is damaged") == 0) ? "sidecar data is damaged"
+                                                                   : "sidecar length is not the committed length";
+        return false;
+    }
+    if (side->ctx.wav && !check_header(side->path, &side->ctx, length, &reason)) {
+        *why = "sidecar WAV header does not describe the truncated file";
+        return false;
+    }
+    return true;
+}
+
+typedef struct {
+    uint32_t trials;
+    uint32_t cuts[CUT_KINDS];
+    uint32_t removed;           // 第一次提交之前断电，文件被删除
+    uint32_t sidecarsClosed;    // 附属文件中途关闭
+    uint32_t failures;
+} Tally;
+
+// 一次录音：随机的格式、块大小、检查点间隔和预分配，在随机的第几次存储操作处断电
+static bool run_trial(const char *dir, const char *journalPath, RecoveryJournal *journal, uint32_t trial,
+                      uint32_t *rng, Tally *tally) {
+    static const uint16_t sampleBits[] = { 16, 24, 32 };
+    char path[256];
+    HeaderCtx ctx = { .wav = (rng_next(rng) % 4) != 0 };
+    ctx.format.sampleRate = 96000;
+    ctx.format.channels = (uint16_t)(1 + rng_next(rng) % 8);
+    ctx.format.containerBits = sampleBits[rng_next(rng) % 3];
+    ctx.format.validBits = ctx.format.containerBits;
+    snprintf(path, sizeof(path), "%s/AUDIO%u.%s", dir, (unsigned)trial, ctx.wav ? "WAV" : "FLA");
+
+    // PCM块按扇区对齐，压缩块长度任意
+    uint32_t blockBytes = (rng_next(rng) & 1) ? RECORD_SECTOR_SIZE * (1 + rng_next(rng) % 32)
+                                               : 1 + rng_next(rng) % 16384;
+    uint32_t blocks = 1 + rng_next(rng) % 64;
+    uint32_t checkpointEvery = 1 + rng_next(rng) % 12;
+    uint64_t total = WAV_HEADER_BYTES + (uint64_t)blocks * blockBytes;
+    uint32_t choice = rng_next(rng) % 3;
+    uint64_t prealloc = (choice == 0) ? 0 : (choice == 1) ? total + rng_next(rng) % 65536 : total / 2;
+    uint32_t seed = rng_next(rng);
+
+    memset(&power, 0, sizeof(power));
+    power.base = record_backend_default();
+    power.path = path;
+    power.rng = rng_next(rng);
+    // 估计的操作总数之外断电时，这次录音正常关闭
+    uint64_t estimate = (uint64_t)blocks * 2 + (blocks / checkpointEvery + 1) * 3 + 4;
+    uint64_t cutAt = 1 + rng_next(rng) % estimate;
+    bool tear = rng_next(rng) & 1;
+
+    // 附属文件：每块一条随机长度的记录，约1/4的录音中途关闭（写入失败）
+    Sidecar side = { .ctx = { .wav = rng_next(rng) & 1 } };
+    side.ctx.format = (WavFormat){ .sampleRate = 16000, .channels = 1, .containerBits = 16, .validBits = 16 };
+    snprintf(side.path, sizeof(side.path), "%s/AUDIO%u.%s", dir, (unsigned)trial, side.ctx.wav ? "AUX" : "IDX");
+    side.prealloc = (rng_next(rng) & 1) ? RECORD_SECTOR_SIZE * (1 + rng_next(rng) % 64) : 0;
+    side.seed = rng_next(rng);
+    uint32_t sideCloseAt = rng_next(rng) % (blocks * 4);
+    const char *sideExt = side.ctx.wav ? ".AUX" : ".IDX";
+    if (!record_writer_open(&side.writer, record_backend_default(), side.path, side.prealloc, 0)) {
+        printf("trial %u: cannot create %s\n", (unsigned)trial, side.path);
+        return false;
+    }
+    record_writer_set_checkpoint_hook(&side.writer, header_hook, &side.ctx);
+    uint8_t sideHeader[WAV_HEADER_BYTES];
+    build_header(&side.ctx, WAV_HEADER_BYTES, sideHeader);
+    record_writer_write(&side.writer, sideHeader, WAV_HEADER_BYTES);
+    side.registered = true;
+
+    uint64_t committed = 0;
+    RecoveryRecord torn;
+    if (!recovery_journal_begin(journal, path, &sideExt, 1)) {
+        printf("trial %u: journal begin failed\n", (unsigned)trial);
+        return false;
+    }
+    RecordWriter writer;
+    if (!record_writer_open(&writer, &cutBackend, path, prealloc, 0)) {
+        printf("trial %u: cannot create %s\n", (unsigned)trial, path);
+        return false;
+    }
+    record_writer_set_checkpoint_hook(&writer, header_hook, &ctx);
+    power.opsLeft = cutAt;
+
+    uint8_t *block = malloc(blockBytes > WAV_HEADER_BYTES ? blockBytes : WAV_HEADER_BYTES);
+    build_header(&ctx, WAV_HEADER_BYTES, block);
+    record_writer_write(&writer, block, WAV_HEADER_BYTES);
+    uint64_t offset = WAV_HEADER_BYTES;
+    for (uint32_t b = 0; b < blocks && power.cut == CUT_NONE; b++) {
+        for (uint32_t i = 0; i < blockBytes; i++) {
+            block[i] = pattern(offset + i, seed);
+        }
+        offset += blockBytes;
+        record_writer_write(&writer, block, blockBytes);
+        if (record_writer_is_open(&side.writer)) {
+            uint8_t record[128];
+            uint32_t len = 2 * (1 + rng_next(rng) % 64);
+            for (uint32_t i = 0; i < len; i++) {
+                record[i] = pattern(side.writer.bytesWritten + i, side.seed);
+            }
+            record_writer_write(&side.writer, record, len);
+            if (b == sideCloseAt) {
+                record_writer_close(&side.writer);
+                tally->sidecarsClosed++;
+            }
+        }
+        // 检查点：附属文件和录音文件回写文件头并落盘，然后提交到日志（同checkpoint_audio_file）
+        if (power.cut == CUT_NONE && (b + 1) % checkpointEvery == 0 && record_writer_is_open(&side.writer)) {
+            record_writer_checkpoint(&side.writer);
+            side.syncedLen = record_writer_flushed_bytes(&side.writer);
+        }
+        if (power.cut == CUT_NONE && (b + 1) % checkpointEvery == 0 && record_writer_checkpoint(&writer)) {
+            if (!power_op(CUT_JOURNAL)) {
+                if (tear) {
+                    power.cut = CUT_TORN;
+                    torn = journal->record;
+                    torn.generation++;
+                    torn.blockSeq = b;
+                    torn.committedBytes = record_writer_flushed_bytes(&writer);
+                    torn.sidecar[0].committedBytes = side.syncedLen;
+                }
+                break;
+            }
+            uint64_t sideBytes = record_writer_is_open(&side.writer) ? side.syncedLen : 0;
+            recovery_journal_commit(journal, b, record_writer_flushed_bytes(&writer), &sideBytes);
+            committed = record_writer_flushed_bytes(&writer);
+            side.committed = sideBytes;
+            side.registered = sideBytes != 0;
+        }
+    }
+    free(block);
+    // 附属文件先关闭（同close_capture_file）；断电时仍然调用close：后端的close在断电后只留下卡上的状态
+    if (record_writer_is_open(&side.writer)) {
+        if (power.cut == CUT_NONE) {
+            record_writer_close(&side.writer);
+        } else {
+            sidecar_power_off(&side);
+        }
+    }
+    bool closed = record_writer_close(&writer) && power.cut == CUT_NONE;
+    if (closed && power_op(CUT_END)) {
+        recovery_journal_end(journal);
+    }
+    recovery_journal_close(journal);
+    if (power.cut == CUT_TORN && !tear_journal(journalPath, &torn)) {
+        printf("trial %u: cannot tear the journal\n", (unsigned)trial);
+        return false;
+    }
+
+    recovery_result_t result = recovery_journal_recover(journalPath);
+    recovery_result_t again = recovery_journal_recover(journalPath);
+    const char *why = NULL;
+    if (power.cut == CUT_NONE || power.cut == CUT_END) {
+        // 关闭时回写的文件头已经在卡上
+        memcpy(power.diskHeader, power.header, WAV_HEADER_BYTES);
+    }
+    if (power.cut == CUT_NONE) {
+        // 正常关闭的录音：恢复不做任何事，文件完整
+        if (result != RECOVERY_RESULT_NONE) {
+            why = "recovery touched a closed recording";
+        } else if (check_content(path, total, seed, &why)) {
+            check_header(path, &ctx, total, &why);
+        }
+    } else if (power.cut == CUT_END) {
+        // 关闭后日志还是打开状态：截断到最后一次提交（关闭时的数据不在日志里）
+        if (result != RECOVERY_RESULT_REPAIRED) {
+            why = "recovery did not run";
+        } else if (committed <= WAV_HEADER_BYTES) {
+            why = (access(path, F_OK) == 0) ? "file without a commit was not removed" : NULL;
+        } else if (check_content(path, committed, seed, &why)) {
+            check_header(path, &ctx, committed, &why);
+        }
+    } else if (result != RECOVERY_RESULT_REPAIRED) {
+        why = "recovery did not run";
+    } else if (committed <= WAV_HEADER_BYTES) {
+        why = (access(path, F_OK) == 0) ? "file without a commit was not removed" : NULL;
+    } else if (check_content(path, committed, seed, &why)) {
+        check_header(path, &ctx, committed, &why);
+    }
+    // 附属文件：正常关闭或已注销时保持关闭时的长度，否则与录音文件一起截断或删除
+    if (why == NULL) {
+        uint64_t sideLength;
+        if (power.cut == CUT_NONE || !side.registered) {
+            sideLength = side.writer.bytesWritten;
+        } else if (committed <= WAV_HEADER_BYTES) {
+            sideLength = 0;
+        } else {
+            sideLength = side.committed;
+        }
+        check_sidecar(&side, sideLength, &why);
+    }
+    if (why == NULL && again != RECOVERY_RESULT_NONE) {
+        why = "journal was not marked closed after recovery";
+    }
+
+    tally->trials++;
+    tally->cuts[power.cut]++;
+    tally->removed += (power.cut != CUT_NONE && committed <= WAV_HEADER_BYTES) ? 1 : 0;
+    if (why != NULL) {
+        tally->failures++;
+        printf("trial %u: %s, %u blocks x %u bytes, checkpoint every %u, prealloc %llu, cut at %s "
+               "(operation %llu), committed %llu: %s\n",
+               (unsigned)trial, ctx.wav ? "WAV" : "FLAC", (unsigned)blocks, (unsigned)blockBytes,
+               (unsigned)checkpointEvery, (unsigned long long)prealloc, cutNames[power.cut],
+               (unsigned long long)cutAt, (unsigned long long)committed, why);
+    }
+    remove(path);
+    remove(side.path);
+    return why == NULL;
+}
+
+// 超过4GB的录音：用稀疏文件构造，只写文件头、提交位置前的一段数据和之后的垃圾，
+// 修复后的文件头必须是RF64且数据长度正确
+static bool run_rf64(const char *dir) {
+    char path[256], journalPath[256];
+    snprintf(path, sizeof(path), "%s/BIG.WAV", dir);
+    snprintf(journalPath, sizeof(journalPath), "%s/BIG.JNL", dir);
+    remove(journalPath);
+
+    WavFormat format = { .sampleRate = 96000, .channels = 8, .containerBits = 24, .validBits = 24 };
+    uint64_t committed = WAV_HEADER_BYTES + 0x100000000ull + 123457ull * 24 + 7;
+    uint32_t seed = 0xB16F11Eu;
+    uint8_t header[WAV_HEADER_BYTES];
+    wav_build_header(header, &format, 0);
+
+    RecoveryJournal journal;
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    bool ok = fd >= 0 && recovery_journal_open(&journal, journalPath) &&
+              recovery_journal_begin(&journal, path, NULL, 0);
+    if (ok && (ftruncate(fd, (off_t)(committed + (1u << 20))) != 0 ||
+               pwrite(fd, header, sizeof(header), 0) != (ssize_t)sizeof(header))) {
+        printf("RF64: cannot create a sparse file past 4 GB in %s, skipped\n", dir);
+        close(fd);
+        recovery_journal_close(&journal);
+        remove(path);
+        remove(journalPath);
+        return true;
+    }
+    // 提交位置之前的64KB数据，和之后未提交的垃圾
+    uint8_t buf[65536];
+    uint64_t tail = committed - sizeof(buf);
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = pattern(tail + i, seed);
+    }
+    ok = ok && pwrite(fd, buf, sizeof(buf), (off_t)tail) == (ssize_t)sizeof(buf);
+    memset(buf, 0xE5, sizeof(buf));
+    ok = ok && pwrite(fd, buf, sizeof(buf), (off_t)committed) == (ssize_t)sizeof(buf);
+    ok = ok && recovery_journal_commit(&journal, 1000, committed, NULL);
+    if (fd >= 0) {
+        close(fd);
+    }
+    recovery_journal_close(&journal);
+
+    ok = ok && recovery_journal_recover(journalPath) == RECOVERY_RESULT_REPAIRED;
+    WavInfo info = { 0 };
+    struct stat st;
+    uint64_t dataBytes = committed - WAV_HEADER_BYTES;
+    dataBytes -= dataBytes % wav_block_align(&format);
+    FILE *f = ok ? fopen(path, "rb") : NULL;
+    ok = f != NULL && stat(path, &st) == 0 && (uint64_t)st.st_size == committed &&
+         fread(header, 1, sizeof(header), f) == sizeof(header) && wav_parse_header(header, sizeof(header), &info) &&
+         info.rf64 && info.dataBytes == dataBytes && fseek(f, (long)tail, SEEK_SET) == 0 &&
+         fread(buf, 1, sizeof(buf), f) == sizeof(buf);
+    for (size_t i = 0; ok && i < sizeof(buf); i++) {
+        ok = buf[i] == pattern(tail + i, seed);
+    }
+    if (f != NULL) {
+        fclose(f);
+    }
+    printf("RF64: %llu-byte recording truncated to the commit, header %s with %llu data bytes -> %s\n",
+           (unsigned long long)committed, info.rf64 ? "RF64" : "RIFF", (unsigned long long)info.dataBytes,
+           ok ? "ok" : "FAILED");
+    remove(path);
+    remove(journalPath);
+    return ok;
+}
+
+// 删除登记在日志中的文件（如没有用到的预备文件）：清空登记之前恢复会因文件不存在而失败，
+// 清空之后恢复不再处理它；清空其他文件的登记不改变日志，删除不存在的文件也成功
+static bool run_forget(const char *dir) {
+    char path[256], sidePath[256], journalPath[256];
+    snprintf(path, sizeof(path), "%s/SPARE.WAV", dir);
+    snprintf(sidePath, sizeof(sidePath), "%s/SPARE.IDX", dir);
+    snprintf(journalPath, sizeof(journalPath), "%s/SPARE.JNL", dir);
+    remove(journalPath);
+    const RecordBackend *backend = record_backend_default();
+    const char *sideExt = ".IDX";
+    uint64_t committed = WAV_HEADER_BYTES + RECORD_SECTOR_SIZE;
+
+    RecoveryJournal journal;
+    RecordWriter writer, side;
+    uint8_t data[WAV_HEADER_BYTES + RECORD_SECTOR_SIZE] = { 0 };
+    bool ok = recovery_journal_open(&journal, journalPath) &&
+              record_writer_open(&writer, backend, path, 0, 0) && record_writer_open(&side, backend, sidePath, 0, 0) &&
+              record_writer_write(&writer, data, sizeof(data)) && record_writer_close(&writer) &&
+              record_writer_write(&side, data, sizeof(data)) && record_writer_close(&side) &&
+              recovery_journal_begin(&journal, path, &sideExt, 1) &&
+              recovery_journal_commit(&journal, 0, committed, &committed);
+    ok = ok && backend->remove(path) && backend->remove(sidePath) && backend->remove(path);
+    bool kept = ok && recovery_journal_forget(&journal, sidePath) && journal.record.state == RECOVERY_STATE_ACTIVE;
+    recovery_journal_close(&journal);
+    bool failed = kept && recovery_journal_recover(journalPath) == RECOVERY_RESULT_FAILED;
+
+    bool forgot = failed && recovery_journal_open(&journal, journalPath) &&
+                  recovery_journal_begin(&journal, path, &sideExt, 1) && recovery_journal_forget(&journal, path);
+    recovery_journal_close(&journal);
+    bool none = forgot && recovery_journal_recover(journalPath) == RECOVERY_RESULT_NONE &&
+                access(path, F_OK) != 0 && access(sidePath, F_OK) != 0;
+    printf("Discard: deleted file still registered %s, forgotten %s -> %s\n",
+           failed ? "fails recovery" : "does not fail recovery", none ? "skipped" : "not skipped",
+           (kept && failed && none) ? "ok" : "FAILED");
+    remove(journalPath);
+    return kept && failed && none;
+}
+
+int main(int argc, char **argv) {
+    uint32_t trials = 2000;
+    uint32_t seed = (uint32_t)time(NULL);
+    const char *dir = "/tmp/power_cut_test";
+    int c;
+    while ((c = getopt(argc, argv, "n:s:o:h")) != -1) {
+        switch (c) {
+        case 'n': trials = strtoul(optarg, NULL, 0); break;
+        case 's': seed = strtoul(optarg, NULL, 0); break;
+        case 'o': dir = optarg; break;
+        default:
+            printf("Usage: %s [-n trials] [-s seed] [-o dir]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (trials == 0 || (mkdir(dir, 0755) != 0 && access(dir, W_OK) != 0)) {
+        return 2;
+    }
+
+    char journalPath[256];
+    snprintf(journalPath, sizeof(journalPath), "%s/RECORD.JNL", dir);
+    remove(journalPath);
+    printf("Power cuts: %u trials in %s, seed %u\n", (unsigned)trials, dir, (unsigned)seed);
+
+    // 同一个日志连续用于多次录音（同设备）；每4次录音中约有1次换一个新日志，
+    // generation从回绕前几次开始，录音过程中两个槽分处回绕的两边
+    uint32_t rng = seed ? seed : 1;
+    Tally tally = { 0 };
+    RecoveryJournal journal;
+    bool ok = true;
+    for (uint32_t t = 0; t < trials; t++) {
+        bool wrap = (rng_next(&rng) % 4) == 0;
+        if (wrap) {
+            remove(journalPath);
+        }
+        if (!recovery_journal_open(&journal, journalPath)) {
+            printf("Cannot open %s\n", journalPath);
+            return 1;
+        }
+        if (wrap) {
+            journal.record.generation = UINT32_MAX - rng_next(&rng) % 16;
+        }
+        ok = run_trial(dir, journalPath, &journal, t, &rng, &tally) && ok;
+    }
+    remove(journalPath);
+
+    printf("Cut at:");
+    for (int k = 0; k < CUT_KINDS; k++) {
+        printf(" %s %u%s", cutNames[k], (unsigned)tally.cuts[k], (k + 1 < CUT_KINDS) ? "," : "\n");
+    }
+    printf("%u of %u trials recovered correctly (%u files removed before the first commit, "
+           "%u sidecars closed mid-recording)\n",
+           (unsigned)(tally.trials - tally.failures), (unsigned)tally.trials, (unsigned)tally.removed,
+           (unsigned)tally.sidecarsClosed);
+    ok = run_rf64(dir) && ok;
+    ok = run_forget(dir) && ok;
+    rmdir(dir);
+    printf("Recovery checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
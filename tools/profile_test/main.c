@@ -0,0 +1,300 @@
+// 采集配置检查测试：检查capture_profile_resolve
+//   - 设备默认配置、long/burst和几个典型配置推导出的抽取比、MCLK倍频、块大小和DMA描述符与手算的结果一致；
+//   - 每一种拒绝（采样率、位深、抽取比、PDM时钟、BCLK、MCLK、块缓冲区）都有至少一个刚好越界的例子，
+//     刚好在界内的对应例子被接受；
+//   - 扫描采样率（默认逐Hz）x 位深 x 抽取比 x 块上限：按CaptureProfile.h中的约束独立算出应当接受还是
+//     返回哪个错误，接受时检查推导的每个参数都满足约束（自动抽取比取最高的、MCLK倍频取最小的、
+//     块取上限内最大的），拒绝时不改动输出；
+//   - 每个错误码都有各不相同的说明文字。
+//
+// 用法: profile_test [-r 采样率扫描步长]
+// 任何一项检查不通过时退出码为1。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include "CaptureProfile.h"
+
+// 设备默认配置（hardwareInit.h的TDM_SAMPLE_RATE/TDM_BIT_WIDTH/TDM_DEC_RATIO）和块缓冲区上限（AUDIO_BUFFER_SIZE）
+#define DEVICE_PROFILE      { .sampleRate = 96000, .bitsPerSample = 16, .decimation = 32 }
+#define DEVICE_MAX_BLOCK    (32 * 1024)
+
+// ESP-IDF支持的MCLK倍频
+static const uint32_t idfMclkMultiples[] = { 256, 384, 512, 576, 768, 1024, 1152 };
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+typedef struct {
+    const char *name;
+    CaptureProfile profile;
+    uint32_t maxBlockBytes;
+    CaptureProfileError expected;
+    // 接受时的期望值
+    uint8_t decimation;
+    uint32_t mclkMultiple;
+    uint32_t blockBytes;
+    uint32_t dmaFrameNum;
+    uint32_t dmaDescNum;
+} NamedCase;
+
+// 拒绝的配置只比较错误码
+#define REJECTED(name, rate, bits, dec, maxBlock, err) \
+    { name, { rate, bits, dec }, maxBlock, err, 0, 0, 0, 0, 0 }
+
+static const NamedCase namedCases[] = {
+    { "device default 96k/16", DEVICE_PROFILE, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_OK, 32, 512, 32768, 240, 6 },
+    { "long 16k/16", CAPTURE_PROFILE_LONG, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_OK, 64, 512, 32768, 240, 6 },
+    // 24位帧24字节，块取1536字节（帧和扇区的最小公倍数）的倍数
+    { "burst 96k/24", CAPTURE_PROFILE_BURST, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_OK, 32, 768, 32256, 170, 9 },
+    { "48k/16 auto", { 48000, 16, 0 }, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_OK, 64, 512, 32768, 240, 6 },
+    { "44.1k/24 auto", { 44100, 24, 0 }, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_OK, 64, 768, 32256, 170, 9 },
+    { "48k/32", { 48000, 32, 0 }, 1024, CAPTURE_PROFILE_OK, 64, 1024, 1024, 127, 12 },
+    REJECTED("192k/16 dec16 auto", 192000, 16, 0, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_MCLK_RANGE),
+    // 边界：采样率
+    REJECTED("8000 Hz dec 16 is too slow for PDM", 8000, 16, 16, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_PDM_CLOCK_RANGE),
+    REJECTED("7999 Hz", 7999, 16, 0, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_BAD_SAMPLE_RATE),
+    REJECTED("192001 Hz", 192001, 16, 16, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_BAD_SAMPLE_RATE),
+    REJECTED("0 Hz", 0, 16, 0, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_BAD_SAMPLE_RATE),
+    // 位深
+    REJECTED("8-bit", 48000, 8, 0, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_BAD_BITS),
+    REJECTED("20-bit", 48000, 20, 0, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_BAD_BITS),
+    REJECTED("0-bit", 48000, 0, 0, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_BAD_BITS),
+    // 抽取比
+    REJECTED("decimation 48", 48000, 16, 48, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_BAD_DECIMATION),
+    REJECTED("decimation 128", 16000, 16, 128, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_BAD_DECIMATION),
+    // PDM时钟：1MHz和3.25MHz两端
+    { "PDM 1.000 MHz (15625 x 64)", { 15625, 16, 64 }, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_OK, 64, 512, 32768, 240, 6 },
+    REJECTED("PDM 0.999936 MHz (15624 x 64)", 15624, 16, 64, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_PDM_CLOCK_RANGE),
+    { "PDM 3.249984 MHz", { 101562, 16, 32 }, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_OK, 32, 512, 32768, 240, 6 },
+    REJECTED("PDM 3.25 MHz + 32 Hz", 101563, 16, 32, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_PDM_CLOCK_RANGE),
+    REJECTED("no decimation fits 8 kHz", 8000, 16, 0, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_PDM_CLOCK_RANGE),
+    // BCLK：24.576MHz
+    REJECTED("BCLK at the limit, MCLK 98 MHz", 96000, 32, 32, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_MCLK_RANGE),
+    REJECTED("BCLK 24.576 MHz + 192 Hz", 128001, 24, 16, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_BCLK_RANGE),
+    REJECTED("BCLK 36.864 MHz", 192000, 24, 16, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_BCLK_RANGE),
+    // MCLK：16位取512倍，80MHz对应156250Hz
+    { "MCLK 80 MHz (156250 x 512)", { 156250, 16, 16 }, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_OK, 16, 512, 32768, 240, 6 },
+    REJECTED("MCLK 80 MHz + 512 Hz", 156251, 16, 16, DEVICE_MAX_BLOCK, CAPTURE_PROFILE_MCLK_RANGE),
+    // 块缓冲区：16位帧取512字节的倍数，24位帧取1536字节的倍数
+    { "16-bit block 512", { 48000, 16, 0 }, 512, CAPTURE_PROFILE_OK, 64, 512, 512, 240, 6 },
+    REJECTED("16-bit block 511", 48000, 16, 0, 511, CAPTURE_PROFILE_BLOCK_SIZE),
+    { "24-bit block 1536", { 48000, 24, 0 }, 1536, CAPTURE_PROFILE_OK, 64, 768, 1536, 170, 9 },
+    REJECTED("24-bit block 1535", 48000, 24, 0, 1535, CAPTURE_PROFILE_BLOCK_SIZE),
+    REJECTED("block 0", 48000, 16, 0, 0, CAPTURE_PROFILE_BLOCK_SIZE),
+};
+
+static bool check_named(void) {
+    uint32_t passed = 0, count = sizeof(namedCases) / sizeof(namedCases[0]);
+    for (uint32_t i = 0; i < count; i++) {
+        const NamedCase *c = &namedCases[i];
+        CaptureTiming t;
+        memset(&t, 0, sizeof(t));
+        CaptureProfileError err = capture_profile_resolve(&c->profile, c->maxBlockBytes, &t);
+        bool ok = err == c->expected;
+        if (ok && err == CAPTURE_PROFILE_OK) {
+            ok = t.decimation == c->decimation && t.mclkMultiple == c->mclkMultiple &&
+                 t.blockBytes == c->blockBytes && t.dmaFrameNum == c->dmaFrameNum && t.dmaDescNum == c->dmaDescNum;
+        }
+        if (ok) {
+            passed++;
+        } else {
+            printf("  %-34s got \"%s\" (decimation %u, MCLK x%u, block %u, DMA %u x %u), expected \"%s\"\n",
+                   c->name, capture_profile_error_str(err), (unsigned)t.decimation, (unsigned)t.mclkMultiple,
+                   (unsigned)t.blockBytes, (unsigned)t.dmaDescNum, (unsigned)t.dmaFrameNum,
+                   capture_profile_error_str(c->expected));
+        }
+    }
+    printf("Named profiles:   %u of %u as expected: %s\n", (unsigned)passed, (unsigned)count,
+           passed == count ? "ok" : "FAILED");
+    return passed == count;
+}
+
+static bool pdm_in_range(uint64_t hz) {
+    return hz >= CAPTURE_PDM_CLK_MIN_HZ && hz <= CAPTURE_PDM_CLK_MAX_HZ;
+}
+
+static uint32_t lcm_u32(uint32_t a, uint32_t b) {
+    uint32_t x = a, y = b;
+    while (y != 0) {
+        uint32_t t = x % y;
+        x = y;
+        y = t;
+    }
+    return a / x * b;
+}
+
+// 只按CaptureProfile.h的约束判断配置：返回应有的错误码，接受时给出应选的抽取比、MCLK倍频和块大小
+static CaptureProfileError expected_result(const CaptureProfile *p, uint32_t maxBlockBytes, uint8_t *decimation,
+                                           uint32_t *mclkMultiple, uint32_t *blockBytes) {
+    uint64_t rate = p->sampleRate;
+    if (rate < CAPTURE_MIN_SAMPLE_RATE || rate > CAPTURE_MAX_SAMPLE_RATE) {
+        return CAPTURE_PROFILE_BAD_SAMPLE_RATE;
+    }
+    if (p->bitsPerSample != 16 && p->bitsPerSample != 24 && p->bitsPerSample != 32) {
+        return CAPTURE_PROFILE_BAD_BITS;
+    }
+    *decimation = 0;
+    if (p->decimation == 0) {
+        for (uint32_t d = 64; d >= 16 && *decimation == 0; d /= 2) {
+            *decimation = pdm_in_range(rate * d) ? (uint8_t)d : 0;
+        }
+        if (*decimation == 0) {
+            return CAPTURE_PROFILE_PDM_CLOCK_RANGE;
+        }
+    } else if (p->decimation != 16 && p->decimation != 32 && p->decimation != 64) {
+        return CAPTURE_PROFILE_BAD_DECIMATION;
+    } else if (!pdm_in_range(rate * p->decimation)) {
+        return CAPTURE_PROFILE_PDM_CLOCK_RANGE;
+    } else {
+        *decimation = p->decimation;
+    }
+    uint32_t frameBits = CAPTURE_TDM_SLOTS * p->bitsPerSample;
+    if (rate * frameBits > CAPTURE_BCLK_MAX_HZ) {
+        return CAPTURE_PROFILE_BCLK_RANGE;
+    }
+    *mclkMultiple = 0;
+    for (size_t i = 0; i < sizeof(idfMclkMultiples) / sizeof(idfMclkMultiples[0]) && *mclkMultiple == 0; i++) {
+        uint32_t m = idfMclkMultiples[i];
+        if (m % frameBits == 0 && m / frameBits >= CAPTURE_MIN_BCLK_DIV && rate * m <= CAPTURE_MCLK_MAX_HZ) {
+            *mclkMultiple = m;
+        }
+    }
+    if (*mclkMultiple == 0) {
+        return CAPTURE_PROFILE_MCLK_RANGE;
+    }
+    uint32_t unit = lcm_u32(frameBits / 8, CAPTURE_SECTOR_BYTES);
+    *blockBytes = maxBlockBytes / unit * unit;
+    return (*blockBytes == 0) ? CAPTURE_PROFILE_BLOCK_SIZE : CAPTURE_PROFILE_OK;
+}
+
+// 接受的配置推导出的每个参数都必须满足约束
+static const char *check_timing(const CaptureProfile *p, uint32_t maxBlockBytes, const CaptureTiming *t,
+                                uint8_t decimation, uint32_t mclkMultiple, uint32_t blockBytes) {
+    uint64_t rate = p->sampleRate;
+    if (t->decimation != decimation || t->pdmClockHz != rate * t->decimation || !pdm_in_range(t->pdmClockHz)) {
+        return "decimation or PDM clock";
+    }
+    if (t->slotBits != p->bitsPerSample || t->sampleBytes * 8u != p->bitsPerSample ||
+        t->frameBytes != CAPTURE_TDM_SLOTS * t->sampleBytes) {
+        return "slot or frame size";
+    }
+    if (t->bclkHz != rate * t->frameBytes * 8 || t->bclkHz > CAPTURE_BCLK_MAX_HZ) {
+        return "BCLK";
+    }
+    uint32_t frameBits = t->frameBytes * 8;
+    if (t->mclkMultiple != mclkMultiple || t->mclkMultiple % frameBits != 0 ||
+        t->mclkMultiple / frameBits < CAPTURE_MIN_BCLK_DIV || rate * t->mclkMultiple > CAPTURE_MCLK_MAX_HZ) {
+        return "MCLK multiple";
+    }
+    if (t->blockBytes != blockBytes || t->blockBytes > maxBlockBytes || t->blockBytes % t->frameBytes != 0 ||
+        t->blockBytes % CAPTURE_SECTOR_BYTES != 0 || t->blockFrames * t->frameBytes != t->blockBytes) {
+        return "block size";
+    }
+    if (t->dmaFrameNum == 0 || t->dmaFrameNum > CAPTURE_DMA_MAX_FRAMES ||
+        t->dmaFrameNum * t->frameBytes > CAPTURE_DMA_MAX_BUFFER_BYTES ||
+        t->dmaFrameNum * t->dmaDescNum < CAPTURE_DMA_MIN_TOTAL_FRAMES ||
+        (t->dmaDescNum - 1) * t->dmaFrameNum >= CAPTURE_DMA_MIN_TOTAL_FRAMES) {
+        return "DMA descriptors";
+    }
+    return NULL;
+}
+
+// 采样率 x 位深 x 抽取比 x 块上限的扫描，包括不合法的位深和抽取比
+static bool check_sweep(uint32_t rateStep) {
+    static const uint8_t bits[] = { 0, 8, 16, 20, 24, 32 };
+    static const uint8_t decimations[] = { 0, 8, 16, 32, 48, 64 };
+    static const uint32_t maxBlocks[] = { 0, 511, 1535, 4096, DEVICE_MAX_BLOCK };
+    uint64_t cases = 0, accepted = 0, failures = 0;
+    uint64_t byError[CAPTURE_PROFILE_BLOCK_SIZE + 1] = { 0 };
+    double t0 = now_sec();
+
+    for (uint32_t rate = CAPTURE_MIN_SAMPLE_RATE - 2000; rate <= CAPTURE_MAX_SAMPLE_RATE + 2000; rate += rateStep) {
+        for (size_t b = 0; b < sizeof(bits); b++) {
+            for (size_t d = 0; d < sizeof(decimations); d++) {
+                for (size_t m = 0; m < sizeof(maxBlocks) / sizeof(maxBlocks[0]); m++) {
+                    CaptureProfile p = { .sampleRate = rate, .bitsPerSample = bits[b], .decimation = decimations[d] };
+                    uint8_t decimation = 0;
+                    uint32_t mclkMultiple = 0, blockBytes = 0;
+                    CaptureProfileError expected = expected_result(&p, maxBlocks[m], &decimation, &mclkMultiple,
+                                                                   &blockBytes);
+                    CaptureTiming t;
+                    memset(&t, 0xA5, sizeof(t));
+                    CaptureProfileError err = capture_profile_resolve(&p, maxBlocks[m], &t);
+                    const char *why = NULL;
+                    if (err != expected) {
+                        why = capture_profile_error_str(err);
+                    } else if (err == CAPTURE_PROFILE_OK) {
+                        why = check_timing(&p, maxBlocks[m], &t, decimation, mclkMultiple, blockBytes);
+                    } else {
+                        // 拒绝时不改动输出
+                        CaptureTiming untouched;
+                        memset(&untouched, 0xA5, sizeof(untouched));
+                        why = memcmp(&t, &untouched, sizeof(t)) ? "timing written on rejection" : NULL;
+                    }
+                    cases++;
+                    accepted += (err == CAPTURE_PROFILE_OK) ? 1 : 0;
+                    byError[expected <= CAPTURE_PROFILE_BLOCK_SIZE ? expected : 0]++;
+                    if (why != NULL && failures++ < 5) {
+                        printf("  %u Hz, %u-bit, decimation %u, block <= %u: %s, expected \"%s\"\n",
+                               (unsigned)rate, (unsigned)bits[b], (unsigned)decimations[d], (unsigned)maxBlocks[m],
+                               why, capture_profile_error_str(expected));
+                    }
+                }
+            }
+        }
+    }
+    printf("Sweep:            %llu profiles in %.2f s, %llu accepted; rejected: rate %llu, bits %llu, "
+           "decimation %llu, PDM %llu, BCLK %llu, MCLK %llu, block %llu: %s\n",
+           (unsigned long long)cases, now_sec() - t0, (unsigned long long)accepted,
+           (unsigned long long)byError[CAPTURE_PROFILE_BAD_SAMPLE_RATE],
+           (unsigned long long)byError[CAPTURE_PROFILE_BAD_BITS],
+           (unsigned long long)byError[CAPTURE_PROFILE_BAD_DECIMATION],
+           (unsigned long long)byError[CAPTURE_PROFILE_PDM_CLOCK_RANGE],
+           (unsigned long long)byError[CAPTURE_PROFILE_BCLK_RANGE],
+           (unsigned long long)byError[CAPTURE_PROFILE_MCLK_RANGE],
+           (unsigned long long)byError[CAPTURE_PROFILE_BLOCK_SIZE], failures == 0 ? "ok" : "FAILED");
+    return failures == 0;
+}
+
+// 每个错误码的说明文字各不相同，且不是未知错误
+static bool check_error_strings(void) {
+    bool ok = true;
+    const char *unknown = capture_profile_error_str((CaptureProfileError)-1);
+    for (int a = CAPTURE_PROFILE_OK; a <= CAPTURE_PROFILE_BLOCK_SIZE; a++) {
+        const char *s = capture_profile_error_str((CaptureProfileError)a);
+        ok = ok && s != NULL && strcmp(s, unknown) != 0;
+        for (int b = CAPTURE_PROFILE_OK; ok && b < a; b++) {
+            ok = strcmp(s, capture_profile_error_str((CaptureProfileError)b)) != 0;
+        }
+    }
+    printf("Error strings:    %d distinct messages: %s\n", CAPTURE_PROFILE_BLOCK_SIZE + 1, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    uint32_t rateStep = 1;
+    int c;
+    while ((c = getopt(argc, argv, "r:h")) != -1) {
+        switch (c) {
+        case 'r': rateStep = strtoul(optarg, NULL, 0); break;
+        default:
+            printf("Usage: %s [-r rate step]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (rateStep == 0) {
+        return 2;
+    }
+
+    bool ok = check_named();
+    ok = check_sweep(rateStep) && ok;
+    ok = check_error_strings() && ok;
+    printf("Profile checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
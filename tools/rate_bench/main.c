@@ -0,0 +1,368 @@
+// 多采样率抽取基准：检查Decimator的通带/阻带指标，再测量每路输出和全部输出同时的实时系数：
+//   - 指标：对每个支持的抽取比，按量化后的系数算出整串级的幅频响应，通带[0, 0.4 x fo]内的波动
+//     不超过±DECIMATOR_RIPPLE_DB，会混叠进通带的[0.6 x fo, fs/2]内衰减不小于DECIMATOR_STOPBAND_DB；
+//   - 定点处理：-o给出的每路输出中，通带内的正弦按latencyFrames对齐后与理想信号的误差、
+//     阻带内的正弦抽取后剩下的功率；
+//   - 连续性：按不同块长处理同一信号，输出逐样本相同；32位容器和24位打包的输入与同样的16位输入结果相同。
+//
+// 用法: rate_bench [-r 输入采样率] [-o 输出采样率/输出采样率...] [-c 通道数] [-f 每块帧数] [-t 秒]
+// 检查不通过时退出码为1。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <getopt.h>
+#include <time.h>
+#include "Decimator.h"
+
+#define TONE_AMPLITUDE  0.5         // 满量程的比例（-6dBFS）
+#define MIN_SDR_DB      60.0        // 通带正弦与理想信号（按测得的增益）的信号误差比
+#define SPEC_POINTS     20000       // 阻带上的频点数
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double db(double ratio) {
+    return 20.0 * log10(ratio);
+}
+
+// 第i级的输入采样率
+static double stage_rate(const Decimator *d, uint32_t i) {
+    double rate = d->sampleRate;
+    for (int32_t k = d->stage[i].parent; k >= 0; k = d->stage[k].parent) {
+        rate /= d->stage[k].factor;
+    }
+    return rate;
+}
+
+// 第o路输出在输入频率hz处的幅度响应：各级零相位响应之积（每级以自己的输入采样率为周期，
+// 所以这也是hz混叠到各级之后的响应）
+static double chain_response(const Decimator *d, uint32_t o, double hz) {
+    double gain = 1.0;
+    for (int32_t i = (int32_t)d->outputStage[o]; i >= 0; i = d->stage[i].parent) {
+        const DecimatorStage *s = &d->stage[i];
+        double w = 2.0 * M_PI * hz / stage_rate(d, (uint32_t)i);
+        double h = s->center;
+        for (uint32_t k = 0; k < s->pairs; k++) {
+            h += 2.0 * s->coef[k] * cos(w * s->offset[k]);
+        }
+        gain *= fabs(h) / 32768.0;
+    }
+    return gain;
+}
+
+// 第o路输出经过的级数
+static uint32_t chain_stages(const Decimator *d, uint32_t o) {
+    uint32_t n = 0;
+    for (int32_t i = (int32_t)d->outputStage[o]; i >= 0; i = d->stage[i].parent) {
+        n++;
+    }
+    return n;
+}
+
+// 检查一路输出的通带波动和阻带衰减，返回是否达标
+static bool check_spec(const Decimator *d, uint32_t o) {
+    double fo = d->outputRate[o];
+    double pass = DECIMATOR_PASSBAND * fo, stop = (1.0 - DECIMATOR_PASSBAND) * fo, nyquist = d->sampleRate / 2.0;
+    double ripple = 0;
+    for (int i = 0; i <= SPEC_POINTS / 10; i++) {
+        double r = fabs(db(chain_response(d, o, pass * i / (SPEC_POINTS / 10))));
+        ripple = (r > ripple) ? r : ripple;
+    }
+    double worst = -1000;
+    for (int i = 0; i <= SPEC_POINTS; i++) {
+        double r = db(chain_response(d, o, stop + (nyquist - stop) * i / SPEC_POINTS));
+        worst = (r > worst) ? r : worst;
+    }
+    bool ok = ripple <= DECIMATOR_RIPPLE_DB && worst <= -DECIMATOR_STOPBAND_DB;
+    printf("1/%-2u %6u Hz: %u stage(s), ripple %.4f dB to %.0f Hz, stopband %.1f dB from %.0f Hz, "
+           "%.2f MAC/frame, latency %.1f frames%s\n", (unsigned)d->outputFactor[o], (unsigned)d->outputRate[o],
+           (unsigned)chain_stages(d, o), ripple, pass, worst, stop, d->macsPerFrame[o], d->latencyFrames[o],
+           ok ? "" : "  FAIL");
+    return ok;
+}
+
+static int16_t quantize(double x) {
+    long v = lround(x * 32767.0);
+    return (int16_t)((v > 32767) ? 32767 : (v < -32768) ? -32768 : v);
+}
+
+// 各通道同一频率的正弦，幅度逐通道递减（检查交织）
+static double tone_amplitude(uint32_t ch, uint32_t channels) {
+    return TONE_AMPLITUDE * (1.0 - 0.5 * ch / channels);
+}
+
+static void synthesize(int16_t *in, uint32_t frames, uint32_t channels, double hz, double sampleRate) {
+    for (uint32_t n = 0; n < frames; n++) {
+        double s = sin(2.0 * M_PI * hz * n / sampleRate + 0.3);
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            in[(size_t)n * channels + ch] = quantize(s * tone_amplitude(ch, channels));
+        }
+    }
+}
+
+// 按blockFrames一块一块处理frames帧，out[o]依次接上每块的输出，total[o]返回总帧数
+static void run(Decimator *d, const void *in, uint32_t sampleBytes, uint32_t frames, uint32_t blockFrames,
+                int16_t **out, uint32_t *total) {
+    decimator_reset(d);
+    int16_t *dst[DECIMATOR_MAX_OUTPUTS];
+    for (uint32_t o = 0; o < d->outputs; o++) {
+        total[o] = 0;
+    }
+    for (uint32_t n = 0; n < frames; n += blockFrames) {
+        uint32_t count = (frames - n < blockFrames) ? frames - n : blockFrames;
+        uint32_t produced[DECIMATOR_MAX_OUTPUTS];
+        for (uint32_t o = 0; o < d->outputs; o++) {
+            dst[o] = out[o] + (size_t)total[o] * d->channels;
+        }
+        decimator_process(d, (const uint8_t *)in + (size_t)n * d->channels * sampleBytes, sampleBytes, count, dst,
+                          produced);
+        for (uint32_t o = 0; o < d->outputs; o++) {
+            total[o] += produced[o];
+        }
+    }
+}
+
+// 通带正弦：按测得的增益与理想延迟后的正弦比较，返回最差通道的信号误差比，gainDb返回最大增益偏差
+static double tone_sdr(const Decimator *d, uint32_t o, const int16_t *out, uint32_t frames, double hz,
+                       double *gainDb) {
+    const uint32_t channels = d->channels, factor = d->outputFactor[o];
+    uint32_t skip = (uint32_t)(2.0 * d->latencyFrames[o] / factor) + 2;
+    double worst = 1000;
+    *gainDb = 0;
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        double yr = 0, rr = 0;
+        for (uint32_t j = skip; j < frames; j++) {
+            double t = ((double)j * factor - d->latencyFrames[o]) / d->sampleRate;
+            double ref = sin(2.0 * M_PI * hz * t + 0.3) * tone_amplitude(ch, channels);
+            yr += out[(size_t)j * channels + ch] / 32767.0 * ref;
+            rr += ref * ref;
+        }
+        double gain = yr / rr, err = 0;
+        for (uint32_t j = skip; j < frames; j++) {
+            double t = ((double)j * factor - d->latencyFrames[o]) / d->sampleRate;
+            double ref = sin(2.0 * M_PI * hz * t + 0.3) * tone_amplitude(ch, channels) * gain;
+            double e = out[(size_t)j * channels + ch] / 32767.0 - ref;
+            err += e * e;
+        }
+        double sdr = 10.0 * log10(rr * gain * gain / err);
+        worst = (sdr < worst) ? sdr : worst;
+        *gainDb = (fabs(db(gain)) > fabs(*gainDb)) ? db(gain) : *gainDb;
+    }
+    return worst;
+}
+
+// 阻带正弦：抽取后剩下的功率相对输入功率（最差通道）
+static double tone_leak(const Decimator *d, uint32_t o, const int16_t *out, uint32_t frames) {
+    const uint32_t channels = d->channels;
+    uint32_t skip = (uint32_t)(2.0 * d->latencyFrames[o] / d->outputFactor[o]) + 2;
+    double worst = -1000;
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        double sum = 0;
+        for (uint32_t j = skip; j < frames; j++) {
+            double v = out[(size_t)j * channels + ch] / 32767.0;
+            sum += v * v;
+        }
+        double amp = tone_amplitude(ch, channels);
+        double leak = 10.0 * log10((sum / (frames - skip) + 1e-30) / (amp * amp / 2));
+        worst = (leak > worst) ? leak : worst;
+    }
+    return worst;
+}
+
+static bool parse_rates(const char *arg, DecimatorConfig *config) {
+    config->outputs = 0;
+    const char *p = arg;
+    while (*p != '\0') {
+        char *end;
+        unsigned long rate = strtoul(p, &end, 10);
+        if (end == p || config->outputs == DECIMATOR_MAX_OUTPUTS || (*end != '\0' && *end != '/')) {
+            return false;
+        }
+        config->rateHz[config->outputs++] = (uint32_t)rate;
+        p = (*end == '/') ? end + 1 : end;
+    }
+    return config->outputs != 0;
+}
+
+int main(int argc, char **argv) {
+    uint32_t sampleRate = 96000;
+    uint32_t channels = 8;
+    uint32_t blockFrames = 2048;    // 96kHz/16位/8槽位时一个32KB块
+    uint32_t seconds = 5;
+    DecimatorConfig config = { .outputs = 2, .rateHz = { 48000, 16000 } };
+    int c;
+    while ((c = getopt(argc, argv, "r:o:c:f:t:h")) != -1) {
+        switch (c) {
+        case 'r': sampleRate = strtoul(optarg, NULL, 0); break;
+        case 'o':
+            if (!parse_rates(optarg, &config)) {
+                printf("Invalid rates: %s (expected up to %d rates separated by /)\n", optarg,
+                       DECIMATOR_MAX_OUTPUTS);
+                return 2;
+            }
+            break;
+        case 'c': channels = strtoul(optarg, NULL, 0); break;
+        case 'f': blockFrames = strtoul(optarg, NULL, 0); break;
+        case 't': seconds = strtoul(optarg, NULL, 0); break;
+        default:
+            printf("Usage: %s [-r sample_rate] [-o rate[/rate...]] [-c channels] [-f frames_per_block]\n"
+                   "          [-t seconds]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (sampleRate == 0 || channels == 0 || channels > DECIMATOR_MAX_CHANNELS || blockFrames < 2 ||
+        seconds == 0) {
+        return 2;
+    }
+    int failures = 0;
+
+    // 指标：每个支持的抽取比单独一路
+    printf("Input %u Hz, passband %.0f%% / stopband from %.0f%% of each output rate:\n", (unsigned)sampleRate,
+           DECIMATOR_PASSBAND * 100, (1.0 - DECIMATOR_PASSBAND) * 100);
+    for (uint32_t factor = 2; factor <= DECIMATOR_MAX_FACTOR; factor++) {
+        DecimatorConfig one = { .outputs = 1, .rateHz = { sampleRate / factor } };
+        Decimator d;
+        if (sampleRate % factor != 0 || !decimator_init(&d, &one, sampleRate, 1, blockFrames)) {
+            continue;
+        }
+        failures += !check_spec(&d, 0);
+        decimator_deinit(&d);
+    }
+
+    Decimator dec;
+    if (!decimator_init(&dec, &config, sampleRate, channels, blockFrames)) {
+        printf("Failed to set up the decimator (rates must be %u Hz / 2^a x 3^b, up to 1/%d)\n",
+               (unsigned)sampleRate, DECIMATOR_MAX_FACTOR);
+        return 1;
+    }
+    printf("\n%u channels, %u frames per block, %u stage(s) for %u output(s):\n", (unsigned)channels,
+           (unsigned)blockFrames, (unsigned)dec.stages, (unsigned)dec.outputs);
+    for (uint32_t i = 0; i < dec.stages; i++) {
+        const DecimatorStage *s = &dec.stage[i];
+        char from[24] = "capture";
+        if (s->parent >= 0) {
+            snprintf(from, sizeof(from), "stage %d", (int)s->parent);
+        }
+        printf("  stage %u: %6.0f Hz -> 1/%u, %u taps (%u multiplies per output), input from %s\n", (unsigned)i,
+               stage_rate(&dec, i), (unsigned)s->factor, (unsigned)s->taps, (unsigned)(s->pairs + 1), from);
+    }
+
+    uint32_t frames = sampleRate;   // 检查用1秒
+    int16_t *in = malloc((size_t)frames * channels * sizeof(int16_t));
+    int32_t *wide = malloc((size_t)frames * channels * sizeof(int32_t));
+    int16_t *out[DECIMATOR_MAX_OUTPUTS], *ref[DECIMATOR_MAX_OUTPUTS];
+    for (uint32_t o = 0; o < dec.outputs; o++) {
+        out[o] = malloc(((size_t)frames / 2 + 1) * channels * sizeof(int16_t));
+        ref[o] = malloc(((size_t)frames / 2 + 1) * channels * sizeof(int16_t));
+        if (out[o] == NULL || ref[o] == NULL) {
+            return 1;
+        }
+    }
+    if (in == NULL || wide == NULL) {
+        return 1;
+    }
+    uint32_t total[DECIMATOR_MAX_OUTPUTS], refTotal[DECIMATOR_MAX_OUTPUTS];
+
+    // 定点处理：每路输出各用一个通带正弦和一个阻带正弦
+    for (uint32_t o = 0; o < dec.outputs; o++) {
+        double fo = dec.outputRate[o];
+        double passHz = 0.3137 * fo, stopHz = 0.7219 * fo;
+        synthesize(in, frames, channels, passHz, sampleRate);
+        run(&dec, in, 2, frames, blockFrames, out, total);
+        double gainDb;
+        double sdr = tone_sdr(&dec, o, out[o], total[o], passHz, &gainDb);
+        synthesize(in, frames, channels, stopHz, sampleRate);
+        run(&dec, in, 2, frames, blockFrames, out, total);
+        double leak = tone_leak(&dec, o, out[o], total[o]);
+        bool ok = sdr >= MIN_SDR_DB && fabs(gainDb) <= DECIMATOR_RIPPLE_DB && leak <= -DECIMATOR_STOPBAND_DB;
+        printf("%6u Hz: %u stage(s), %.0f Hz tone gain %+.4f dB, SDR %.1f dB (min %.0f); "
+               "%.0f Hz tone %.1f dB%s\n", (unsigned)dec.outputRate[o], (unsigned)chain_stages(&dec, o), passHz,
+               gainDb, sdr, MIN_SDR_DB, stopHz, leak, ok ? "" : "  FAIL");
+        failures += !ok;
+    }
+
+    // 连续性：块长不同（包括不整除的块长）时输出相同；32位容器中的同一信号结果相同
+    synthesize(in, frames, channels, 0.2 * dec.outputRate[dec.outputs - 1], sampleRate);
+    run(&dec, in, 2, frames, blockFrames, out, total);
+    uint32_t oddFrames = blockFrames / 3 + 1;
+    run(&dec, in, 2, frames, oddFrames, ref, refTotal);
+    bool same = true;
+    for (uint32_t o = 0; o < dec.outputs; o++) {
+        same &= total[o] == refTotal[o] && memcmp(out[o], ref[o], (size_t)total[o] * channels * 2) == 0;
+        same &= total[o] == (frames + dec.outputFactor[o] - 1) / dec.outputFactor[o];
+    }
+    printf("Block continuity:   %s (%u vs %u frames per block)\n", same ? "identical" : "MISMATCH",
+           (unsigned)blockFrames, (unsigned)oddFrames);
+    failures += !same;
+    for (size_t i = 0; i < (size_t)frames * channels; i++) {
+        wide[i] = (int32_t)((uint32_t)(uint16_t)in[i] << 16) | (int32_t)(i & 0x7FFF);
+    }
+    for (uint32_t bytes = 4; bytes >= 3; bytes--) {
+        // 24位打包：32位容器的高3字节
+        if (bytes == 3) {
+            uint8_t *packed = (uint8_t *)wide;
+            for (size_t i = 0; i < (size_t)frames * channels; i++) {
+                uint32_t v = (uint32_t)wide[i];
+                packed[i * 3] = (uint8_t)(v >> 8);
+                packed[i * 3 + 1] = (uint8_t)(v >> 16);
+                packed[i * 3 + 2] = (uint8_t)(v >> 24);
+            }
+        }
+        run(&dec, wide, bytes, frames, blockFrames, ref, refTotal);
+        same = true;
+        for (uint32_t o = 0; o < dec.outputs; o++) {
+            same &= total[o] == refTotal[o] && memcmp(out[o], ref[o], (size_t)total[o] * channels * 2) == 0;
+        }
+        printf("%u-bit input:       %s\n", (unsigned)bytes * 8, same ? "identical" : "MISMATCH");
+        failures += !same;
+    }
+
+    // 实时系数：每路输出单独，再全部一起
+    printf("\n");
+    for (uint32_t o = 0; o <= dec.outputs; o++) {
+        DecimatorConfig cfg = config;
+        if (o < dec.outputs) {
+            cfg.outputs = 1;
+            cfg.rateHz[0] = config.rateHz[o];
+        }
+        Decimator d;
+        if (!decimator_init(&d, &cfg, sampleRate, channels, blockFrames)) {
+            return 1;
+        }
+        volatile uint32_t sink = 0;
+        double t0 = now_sec();
+        for (uint32_t s = 0; s < seconds; s++) {
+            run(&d, in, 2, frames, blockFrames, out, total);
+            sink += (uint16_t)out[0][s];
+        }
+        double elapsed = now_sec() - t0;
+        double rtf = elapsed / seconds;
+        char name[48];
+        if (o < dec.outputs) {
+            snprintf(name, sizeof(name), "%u Hz", (unsigned)cfg.rateHz[0]);
+        } else {
+            snprintf(name, sizeof(name), "all %u outputs", (unsigned)d.outputs);
+        }
+        printf("%-14s %5.2f MAC/frame/ch, %8.2f ns/frame, real-time factor %.4f (host)\n", name,
+               d.totalMacsPerFrame, elapsed * 1e9 / ((double)frames * seconds), rtf);
+        decimator_deinit(&d);
+    }
+
+    decimator_deinit(&dec);
+    free(in);
+    free(wide);
+    for (uint32_t o = 0; o < config.outputs; o++) {
+        free(out[o]);
+        free(ref[o]);
+    }
+    if (failures != 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,278 @@
+// 块环压力测试：在主机上用生产者、（可选的）处理和消费者线程高速收发BlockRing中的块，
+// 检查每个块的序号和内容，确认没有丢块、重复、乱序，也没有读到尚未写完（或尚未处理完）的数据。
+//
+// 用法: ring_stress [-s 槽位数] [-b 块字节数] [-x 实时倍数] [-t 每项秒数]
+// 默认按设备的6个32KB块、8通道/96kHz/16位（1.536MB/s）的10倍速度产生块，再不限速各跑一次；
+// 每项分别测无处理阶段和有处理阶段（block_ring_init_staged）的环。
+// 主机有两个以上CPU时各线程绑定到不同的CPU，使索引的读写真正并发。
+// 发现任何丢块、乱序或内容错误时退出码为1。
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "BlockRing.h"
+
+#define STRESS_REAL_RATE    (96000.0 * 8 * 2)      // 设备的数据率（字节/秒）
+#define STRESS_STAGE_KEY    0xA5A5A5A5u             // 处理阶段对每个字异或的值
+
+typedef struct {
+    BlockRing ring;
+    uint32_t slots;
+    uint32_t words;             // 每块的32位字数（第0、1个字为块序号）
+    uint32_t **blocks;
+    bool staged;
+    double periodSec;           // 两块之间的间隔，0为不限速
+
+    atomic_bool stop;           // 通知生产者停止产生新块
+    atomic_bool done;           // 生产者已停止，produced不再变化
+    atomic_ullong produced;
+
+    // 生产者
+    uint64_t fullWaits;         // 环满时等待的次数
+    // 处理阶段
+    uint64_t stageErrors;
+    // 消费者
+    uint64_t consumed;
+    uint64_t lost;
+    uint64_t reordered;
+    uint64_t corrupt;
+    uint64_t nthErrors;         // block_ring_peek_nth看到的块序号不对
+    uint32_t highWater;
+} Stress;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 线程绑定到第cpu个CPU（只有一个CPU时不绑定）
+static void pin_thread(int cpu) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 2) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % cpus, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// 块中第i个字应有的值（不含处理阶段的异或）
+static inline uint32_t pattern(uint64_t seq, uint32_t i) {
+    return (uint32_t)(seq * 2654435761u) ^ (i * 40503u);
+}
+
+static inline uint64_t block_seq(const uint32_t *block, uint32_t key) {
+    return (uint64_t)(block[0] ^ key) | ((uint64_t)(block[1] ^ key) << 32);
+}
+
+static void *producer_thread(void *arg) {
+    Stress *s = arg;
+    pin_thread(0);
+    uint64_t seq = 0;
+    double next = now_sec();
+    while (!atomic_load_explicit(&s->stop, memory_order_relaxed)) {
+        uint32_t slot;
+        if (!block_ring_acquire(&s->ring, &slot)) {
+            s->fullWaits++;
+            while (!block_ring_acquire(&s->ring, &slot)) {
+                sched_yield();
+            }
+        }
+        uint32_t *block = s->blocks[slot];
+        block[0] = (uint32_t)seq;
+        block[1] = (uint32_t)(seq >> 32);
+        for (uint32_t i = 2; i < s->words; i++) {
+            block[i] = pattern(seq, i);
+        }
+        block_ring_commit(&s->ring);
+        seq++;
+        atomic_store_explicit(&s->produced, seq, memory_order_release);
+
+        // 按实时倍数限速：追不上时不补偿，避免之后连续突发
+        if (s->periodSec > 0) {
+            next += s->periodSec;
+            double wait = next - now_sec();
+            if (wait > 0) {
+                struct timespec ts = { (time_t)wait, (long)((wait - (time_t)wait) * 1e9) };
+                nanosleep(&ts, NULL);
+            } else {
+                next = now_sec();
+            }
+        }
+    }
+    atomic_store_explicit(&s->done, true, memory_order_release);
+    return NULL;
+}
+
+// 处理阶段：检查块序号连续，并原地改写整个块，消费者必须看到改写后的内容
+static void *stage_thread(void *arg) {
+    Stress *s = arg;
+    pin_thread(1);
+    uint64_t expected = 0;
+    for (;;) {
+        uint32_t slot;
+        if (!block_ring_stage_peek(&s->ring, &slot)) {
+            if (atomic_load_explicit(&s->done, memory_order_acquire) &&
+                expected == atomic_load_explicit(&s->produced, memory_order_acquire)) {
+                return NULL;
+            }
+            sched_yield();
+            continue;
+        }
+        uint32_t *block = s->blocks[slot];
+        if (block_seq(block, 0) != expected) {
+            s->stageErrors++;
+        }
+        for (uint32_t i = 0; i < s->words; i++) {
+            block[i] ^= STRESS_STAGE_KEY;
+        }
+        block_ring_stage_commit(&s->ring);
+        expected++;
+    }
+}
+
+static void *consumer_thread(void *arg) {
+    Stress *s = arg;
+    pin_thread(2);
+    uint32_t key = s->staged ? STRESS_STAGE_KEY : 0;
+    uint64_t expected = 0;
+    for (;;) {
+        uint32_t slot;
+        if (!block_ring_peek(&s->ring, &slot)) {
+            if (atomic_load_explicit(&s->done, memory_order_acquire) &&
+                s->consumed == atomic_load_explicit(&s->produced, memory_order_acquire)) {
+                return NULL;
+            }
+            sched_yield();
+            continue;
+        }
+        uint32_t count = block_ring_count(&s->ring);
+        s->highWater = (count > s->highWater) ? count : s->highWater;
+
+        const uint32_t *block = s->blocks[slot];
+        uint64_t seq = block_seq(block, key);
+        if (seq > expected) {
+            s->lost += seq - expected;
+        } else if (seq < expected) {
+            s->reordered++;
+        }
+        for (uint32_t i = 2; i < s->words; i++) {
+            if ((block[i] ^ key) != pattern(seq, i)) {
+                s->corrupt++;
+                break;
+            }
+        }
+        // 往后看的块（事件录音搬运预录时这样用）必须按序号紧随其后
+        uint32_t nth;
+        for (uint32_t n = 1; block_ring_peek_nth(&s->ring, n, &nth); n++) {
+            if (block_seq(s->blocks[nth], key) != seq + n) {
+                s->nthErrors++;
+            }
+        }
+        block_ring_release(&s->ring);
+        s->consumed++;
+        expected = seq + 1;
+    }
+}
+
+// 运行一项测试，返回是否没有发现错误
+static bool run(uint32_t slots, uint32_t blockBytes, bool staged, double speed, double seconds) {
+    Stress *s = calloc(1, sizeof(Stress));
+    s->slots = slots;
+    s->words = blockBytes / sizeof(uint32_t);
+    s->staged = staged;
+    s->periodSec = (speed > 0) ? blockBytes / (STRESS_REAL_RATE * speed) : 0;
+    s->blocks = calloc(slots, sizeof(uint32_t *));
+    for (uint32_t i = 0; i < slots; i++) {
+        s->blocks[i] = malloc(blockBytes);
+    }
+    if (staged) {
+        block_ring_init_staged(&s->ring, slots);
+    } else {
+        block_ring_init(&s->ring, slots);
+    }
+
+    pthread_t producer, stage, consumer;
+    double t0 = now_sec();
+    pthread_create(&consumer, NULL, consumer_thread, s);
+    if (staged) {
+        pthread_create(&stage, NULL, stage_thread, s);
+    }
+    pthread_create(&producer, NULL, producer_thread, s);
+    struct timespec ts = { (time_t)seconds, (long)((seconds - (time_t)seconds) * 1e9) };
+    nanosleep(&ts, NULL);
+    atomic_store_explicit(&s->stop, true, memory_order_release);
+    pthread_join(producer, NULL);
+    if (staged) {
+        pthread_join(stage, NULL);
+    }
+    pthread_join(consumer, NULL);
+    double elapsed = now_sec() - t0;
+
+    uint64_t produced = atomic_load(&s->produced);
+    bool ok = s->consumed == produced && s->lost == 0 && s->reordered == 0 && s->corrupt == 0 &&
+              s->nthErrors == 0 && s->stageErrors == 0;
+    char rate[32];
+    if (speed > 0) {
+        snprintf(rate, sizeof(rate), "%gx real time", speed);
+    } else {
+        snprintf(rate, sizeof(rate), "unthrottled");
+    }
+    printf("%-7s %-15s %9llu blocks %8.1f MB/s (%6.1fx), ring full %7llu times, high-water %u / %u: "
+           "%llu lost, %llu reordered, %llu corrupt, %llu peek_nth, %llu stage -> %s\n",
+           staged ? "staged" : "plain", rate, (unsigned long long)produced,
+           (double)produced * blockBytes / elapsed / 1e6, (double)produced * blockBytes / elapsed / STRESS_REAL_RATE,
+           (unsigned long long)s->fullWaits, (unsigned)s->highWater, (unsigned)slots, (unsigned long long)s->lost,
+           (unsigned long long)s->reordered, (unsigned long long)s->corrupt, (unsigned long long)s->nthErrors,
+           (unsigned long long)s->stageErrors, ok ? "ok" : "FAILED");
+
+    for (uint32_t i = 0; i < slots; i++) {
+        free(s->blocks[i]);
+    }
+    free(s->blocks);
+    free(s);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    uint32_t slots = 6;
+    uint32_t blockBytes = 32 * 1024;
+    double speed = 10;
+    double seconds = 2;
+    int c;
+    while ((c = getopt(argc, argv, "s:b:x:t:h")) != -1) {
+        switch (c) {
+        case 's': slots = strtoul(optarg, NULL, 0); break;
+        case 'b': blockBytes = strtoul(optarg, NULL, 0); break;
+        case 'x': speed = atof(optarg); break;
+        case 't': seconds = atof(optarg); break;
+        default:
+            printf("Usage: %s [-s slots] [-b block_bytes] [-x real_time_multiple] [-t seconds_per_run]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (slots == 0 || blockBytes < 16 || blockBytes % 4 != 0 || speed <= 0 || seconds <= 0) {
+        return 2;
+    }
+
+    printf("Ring: %u slots x %u bytes, %ld CPUs\n", (unsigned)slots, (unsigned)blockBytes,
+           sysconf(_SC_NPROCESSORS_ONLN));
+    bool ok = true;
+    for (int staged = 0; staged <= 1; staged++) {
+        ok = run(slots, blockBytes, staged, speed, seconds) && ok;
+        ok = run(slots, blockBytes, staged, 0, seconds) && ok;
+    }
+    // 一个槽位的环：每块都要等对方释放，满/空边界最密集
+    ok = run(1, blockBytes, false, 0, seconds) && ok;
+    ok = run(1, blockBytes, true, 0, seconds) && ok;
+    printf("Ring checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,371 @@
+// 采集统计计数器测试：在主机上检查CaptureStats
+//   - 延迟的log2分桶边界（<2us、2^k、2^k-1、最后一个桶不设上限），直方图的最大值和最近值；
+//   - 百分位数按累计数量向上取整、返回桶的上界，没有样本时为0，最后一个桶为UINT32_MAX；
+//   - 每个写入函数只改动自己的计数器，快照的每个字段对应正确的计数器（各计数器调用不同的次数），
+//     高水位只升不降，背压按持有多数块的阶段归因（相等时算写出），写入失败不计入写出的块和延迟；
+//   - 写卡速率在统计窗口满1秒后更新，写入失败不计入字节数，restart_rate后暂停的时间不算进去；
+//   - reset清零所有计数器；
+//   - 每组计数器一个写入线程（同设备上的I2S回调、采集、处理和文件任务）并发更新，读取线程不停地取快照：
+//     计数器和直方图样本数只增不减，高水位和最大值不回退，结束时的计数准确。
+//
+// 用法: stats_test [-n 每个写入线程的更新次数]
+// 任何一项检查不通过时退出码为1。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <pthread.h>
+#include "CaptureStats.h"
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t hist_total(const uint32_t *hist) {
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < CAPTURE_STATS_BUCKETS; i++) {
+        total += hist[i];
+    }
+    return total;
+}
+
+static bool report(const char *name, bool ok, const char *detail) {
+    printf("%-18s%s: %s\n", name, detail, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static bool check_buckets(void) {
+    bool ok = capture_stats_bucket(0) == 0 && capture_stats_bucket(1) == 0 &&
+              capture_stats_bucket(UINT32_MAX) == CAPTURE_STATS_BUCKETS - 1;
+    for (uint32_t k = 1; k < 32; k++) {
+        uint32_t expected = (k < CAPTURE_STATS_BUCKETS) ? k : CAPTURE_STATS_BUCKETS - 1;
+        uint32_t below = (k - 1 < CAPTURE_STATS_BUCKETS) ? k - 1 : CAPTURE_STATS_BUCKETS - 1;
+        ok = ok && capture_stats_bucket(1u << k) == expected && capture_stats_bucket((1u << k) - 1) == below &&
+             capture_stats_bucket((2u << k) - 1) == expected;
+    }
+
+    // 样本落入对应的桶，最大值只升不降，最近值总是最后一个
+    static const uint32_t samples[] = { 0, 1, 2, 3, 1000, 1u << 19, 5, 40000000, 7 };
+    CaptureLatencyHist hist;
+    memset(&hist, 0, sizeof(hist));
+    uint32_t expected[CAPTURE_STATS_BUCKETS] = { 0 }, maxUs = 0;
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        capture_latency_record(&hist, samples[i]);
+        expected[capture_stats_bucket(samples[i])]++;
+        maxUs = (samples[i] > maxUs) ? samples[i] : maxUs;
+        ok = ok && atomic_load(&hist.maxUs) == maxUs && atomic_load(&hist.lastUs) == samples[i];
+    }
+    for (uint32_t b = 0; b < CAPTURE_STATS_BUCKETS; b++) {
+        ok = ok && atomic_load(&hist.bucket[b]) == expected[b];
+    }
+    ok = ok && expected[0] == 2 && expected[1] == 2 && expected[CAPTURE_STATS_BUCKETS - 1] == 2;
+    return report("Buckets:", ok, "log2 bucket edges, max and last value");
+}
+
+static bool check_percentiles(void) {
+    uint32_t hist[CAPTURE_STATS_BUCKETS] = { 0 };
+    bool ok = capture_stats_percentile_us(hist, 50) == 0 && capture_stats_percentile_us(hist, 100) == 0;
+
+    hist[3] = 10;
+    ok = ok && capture_stats_percentile_us(hist, 1) == 16 && capture_stats_percentile_us(hist, 100) == 16;
+
+    // 200个样本的p99要累计到198个：197个在桶1时落到桶5
+    memset(hist, 0, sizeof(hist));
+    hist[1] = 198;
+    hist[5] = 2;
+    ok = ok && capture_stats_percentile_us(hist, 99) == 4 && capture_stats_percentile_us(hist, 100) == 64;
+    hist[1] = 197;
+    hist[5] = 3;
+    ok = ok && capture_stats_percentile_us(hist, 99) == 64 && capture_stats_percentile_us(hist, 50) == 4;
+
+    // 桶0的上界是2us，最后一个桶没有上界
+    memset(hist, 0, sizeof(hist));
+    hist[0] = 99;
+    hist[CAPTURE_STATS_BUCKETS - 1] = 1;
+    ok = ok && capture_stats_percentile_us(hist, 99) == 2 && capture_stats_percentile_us(hist, 100) == UINT32_MAX;
+    return report("Percentiles:", ok, "empty, single bucket, rounding and the open last bucket");
+}
+
+// 每个写入函数调用不同的次数、样本落入不同的桶，快照的字段不能串位
+static bool check_counters(void) {
+    CaptureStats stats;
+    memset(&stats, 0, sizeof(stats));
+    capture_stats_reset(&stats);
+    capture_stats_restart_rate(&stats);
+
+    for (int i = 0; i < 1; i++) {
+        capture_stats_overrun(&stats);
+    }
+    for (int i = 0; i < 2; i++) {
+        capture_stats_block_committed(&stats, 2 + i);           // 桶1
+    }
+    static const uint32_t spillDepths[] = { 1, 2, 7, 3 };
+    for (int i = 0; i < 4; i++) {
+        capture_stats_block_spilled(&stats, spillDepths[i]);
+    }
+    // 背压：处理阶段持有多数块3次，写出阶段持有多数块或相等5次
+    static const uint32_t toProcess[] = { 4, 5, 6, 0, 1, 3, 2, 2 };
+    static const uint32_t toPersist[] = { 2, 1, 0, 6, 5, 3, 4, 2 };
+    for (int i = 0; i < 8; i++) {
+        capture_stats_backpressure(&stats, toProcess[i], toPersist[i]);
+    }
+    static const uint32_t processDepths[] = { 2, 5, 1, 4, 3, 2 };
+    for (int i = 0; i < 6; i++) {
+        capture_stats_block_processed(&stats, 4 + i, 8 + i, processDepths[i]);     // 桶2和桶3
+    }
+    for (int i = 0; i < 6; i++) {
+        capture_stats_flac_fallback(&stats);
+    }
+    for (int i = 0; i < 7; i++) {
+        capture_stats_write_wait(&stats, 16 + i);               // 桶4
+    }
+    static const uint32_t ringDepths[] = { 3, 6, 2, 5, 1, 4, 6, 2, 1 };
+    for (int i = 0; i < 9; i++) {
+        capture_stats_ring_depth(&stats, ringDepths[i]);
+    }
+    for (int i = 0; i < 10; i++) {
+        capture_stats_block_written(&stats, 32768, 32 + i, 1000 + i, true);      // 桶5
+    }
+    for (int i = 0; i < 11; i++) {
+        capture_stats_block_written(&stats, 32768, 5000000, 2000 + i, false);    // 失败不记延迟
+    }
+    for (int i = 0; i < 12; i++) {
+        capture_stats_block_corrupt(&stats);
+    }
+    for (int i = 0; i < 13; i++) {
+        capture_stats_frames_discarded(&stats, 100 + i);
+    }
+
+    CaptureStatsSnapshot s;
+    capture_stats_snapshot(&stats, &s);
+    bool ok = s.overruns == 1 && s.blocksCommitted == 2 && s.blocksSpilled == 4 && s.spillHighWater == 7 &&
+              s.backpressureProcess == 3 && s.backpressurePersist == 5 && s.processHighWater == 5 &&
+              s.flacFallbacks == 6 && s.ringHighWater == 6 && s.blocksWritten == 10 && s.writeErrors == 11 &&
+              s.corruptBlocks == 12 && s.discardedFrames == 1378 && s.bytesPerSec == 0;
+    ok = ok && s.commitHist[1] == 2 && hist_total(s.commitHist) == 2 && s.commitMaxUs == 3 && s.commitLastUs == 3;
+    ok = ok && s.processWaitHist[2] == 4 && s.processWaitHist[3] == 2 && hist_total(s.processWaitHist) == 6 &&
+         s.processWaitMaxUs == 9 && s.processWaitLastUs == 9;
+    ok = ok && s.processHist[3] == 6 && hist_total(s.processHist) == 6 && s.processMaxUs == 13 &&
+         s.processLastUs == 13;
+    ok = ok && s.writeWaitHist[4] == 7 && hist_total(s.writeWaitHist) == 7 && s.writeWaitMaxUs == 22 &&
+         s.writeWaitLastUs == 22;
+    ok = ok && s.writeHist[5] == 10 && hist_total(s.writeHist) == 10 && s.writeMaxUs == 41 && s.writeLastUs == 41;
+
+    // reset清零所有计数器
+    capture_stats_reset(&stats);
+    CaptureStatsSnapshot zero;
+    memset(&zero, 0, sizeof(zero));
+    capture_stats_snapshot(&stats, &s);
+    bool cleared = memcmp(&s, &zero, sizeof(s)) == 0;
+    report("Counters:", ok, "each update reaches its own snapshot field, high-water marks never drop");
+    return report("Reset:", cleared, "every counter and histogram cleared") && ok;
+}
+
+// 每10ms写完一个32KB的块（3.2768MB/s）
+static bool check_rate(void) {
+    CaptureStats stats;
+    memset(&stats, 0, sizeof(stats));
+    capture_stats_restart_rate(&stats);
+    uint64_t t = 5000000;
+    bool ok = true;
+
+    // 第一个窗口从第一个块写完时开始，不满1秒时没有速率
+    for (int i = 0; i < 100; i++, t += 10000) {
+        capture_stats_block_written(&stats, 32768, 100, t, true);
+    }
+    ok = ok && atomic_load(&stats.bytesPerSec) == 0;
+    capture_stats_block_written(&stats, 32768, 100, t, true);
+    t += 10000;
+    // 第一个窗口包含开始时写完的那一块
+    ok = ok && atomic_load(&stats.bytesPerSec) == 101 * 32768;
+
+    // 之后的窗口首尾相接，恰好100块/秒；失败的写入不计字节
+    for (int i = 0; i < 100; i++, t += 10000) {
+        capture_stats_block_written(&stats, 32768, 100, t, true);
+        capture_stats_block_written(&stats, 32768, 100, t, false);
+    }
+    ok = ok && atomic_load(&stats.bytesPerSec) == 3276800;
+
+    // 暂停10秒后开始新文件：restart_rate之后暂停的时间不算进速率
+    t += 10000000;
+    capture_stats_restart_rate(&stats);
+    for (int i = 0; i < 101; i++, t += 5000) {
+        capture_stats_block_written(&stats, 32768, 100, t, true);
+    }
+    for (int i = 0; i < 200; i++, t += 5000) {
+        capture_stats_block_written(&stats, 32768, 100, t, true);
+    }
+    ok = ok && atomic_load(&stats.bytesPerSec) == 201 * 32768;
+    return report("Write rate:", ok, "1 s windows, failed writes and pauses excluded");
+}
+
+// 并发：每组计数器一个写入线程，一个读取线程不停地取快照
+typedef struct {
+    CaptureStats stats;
+    uint32_t updates;
+    atomic_uint running;
+    atomic_bool readerFailed;
+    uint64_t snapshots;
+} Shared;
+
+static void *i2s_writer(void *arg) {
+    Shared *sh = arg;
+    for (uint32_t i = 0; i < sh->updates; i++) {
+        capture_stats_overrun(&sh->stats);
+    }
+    atomic_fetch_sub(&sh->running, 1);
+    return NULL;
+}
+
+static void *capture_writer(void *arg) {
+    Shared *sh = arg;
+    for (uint32_t i = 0; i < sh->updates; i++) {
+        capture_stats_block_committed(&sh->stats, i & 0xFFFF);
+        capture_stats_block_spilled(&sh->stats, i & 63);
+        capture_stats_backpressure(&sh->stats, i & 1, 0);
+        capture_stats_frames_discarded(&sh->stats, 3);
+    }
+    atomic_fetch_sub(&sh->running, 1);
+    return NULL;
+}
+
+static void *process_writer(void *arg) {
+    Shared *sh = arg;
+    for (uint32_t i = 0; i < sh->updates; i++) {
+        capture_stats_block_processed(&sh->stats, i & 0xFFF, i & 0xFF, i & 7);
+        if ((i & 3) == 0) {
+            capture_stats_flac_fallback(&sh->stats);
+        }
+    }
+    atomic_fetch_sub(&sh->running, 1);
+    return NULL;
+}
+
+static void *file_writer(void *arg) {
+    Shared *sh = arg;
+    for (uint32_t i = 0; i < sh->updates; i++) {
+        capture_stats_ring_depth(&sh->stats, i % 6);
+        capture_stats_write_wait(&sh->stats, i & 0x3FF);
+        capture_stats_block_written(&sh->stats, 32768, i & 0x7FFFF, 1000000 + (uint64_t)i * 10, (i % 5) != 0);
+        if ((i % 7) == 0) {
+            capture_stats_block_corrupt(&sh->stats);
+        }
+    }
+    atomic_fetch_sub(&sh->running, 1);
+    return NULL;
+}
+
+// 快照中应当只增不减的值
+static void monotonic_values(const CaptureStatsSnapshot *s, uint32_t *v) {
+    uint32_t n = 0;
+    v[n++] = s->overruns;
+    v[n++] = s->blocksCommitted;
+    v[n++] = s->blocksSpilled;
+    v[n++] = s->spillHighWater;
+    v[n++] = s->discardedFrames;
+    v[n++] = s->backpressureProcess;
+    v[n++] = s->backpressurePersist;
+    v[n++] = s->processHighWater;
+    v[n++] = s->flacFallbacks;
+    v[n++] = s->blocksWritten;
+    v[n++] = s->writeErrors;
+    v[n++] = s->corruptBlocks;
+    v[n++] = s->ringHighWater;
+    v[n++] = hist_total(s->commitHist);
+    v[n++] = s->commitMaxUs;
+    v[n++] = hist_total(s->processWaitHist);
+    v[n++] = s->processWaitMaxUs;
+    v[n++] = hist_total(s->processHist);
+    v[n++] = s->processMaxUs;
+    v[n++] = hist_total(s->writeWaitHist);
+    v[n++] = s->writeWaitMaxUs;
+    v[n++] = hist_total(s->writeHist);
+    v[n++] = s->writeMaxUs;
+}
+
+#define MONOTONIC_VALUES    23
+
+static void *reader(void *arg) {
+    Shared *sh = arg;
+    uint32_t last[MONOTONIC_VALUES] = { 0 }, now[MONOTONIC_VALUES];
+    CaptureStatsSnapshot s;
+    while (atomic_load(&sh->running) != 0) {
+        capture_stats_snapshot(&sh->stats, &s);
+        monotonic_values(&s, now);
+        for (int i = 0; i < MONOTONIC_VALUES; i++) {
+            if (now[i] < last[i]) {
+                atomic_store(&sh->readerFailed, true);
+            }
+            last[i] = now[i];
+        }
+        sh->snapshots++;
+    }
+    return NULL;
+}
+
+static bool check_concurrent(uint32_t updates) {
+    static Shared sh;
+    memset(&sh, 0, sizeof(sh));
+    capture_stats_reset(&sh.stats);
+    capture_stats_restart_rate(&sh.stats);
+    sh.updates = updates;
+    atomic_store(&sh.running, 4);
+
+    void *(*writers[4])(void *) = { i2s_writer, capture_writer, process_writer, file_writer };
+    pthread_t threads[5];
+    double t0 = now_sec();
+    pthread_create(&threads[4], NULL, reader, &sh);
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&threads[i], NULL, writers[i], &sh);
+    }
+    for (int i = 0; i < 5; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double elapsed = now_sec() - t0;
+
+    CaptureStatsSnapshot s;
+    capture_stats_snapshot(&sh.stats, &s);
+    uint32_t n = updates;
+    uint32_t errors = (n + 4) / 5;
+    bool ok = !atomic_load(&sh.readerFailed) && s.overruns == n && s.blocksCommitted == n &&
+              hist_total(s.commitHist) == n && s.blocksSpilled == n && s.spillHighWater == ((n > 63) ? 63 : n - 1) &&
+              s.discardedFrames == 3 * n &&
+              s.backpressureProcess == n / 2 && s.backpressurePersist == n - n / 2 &&
+              hist_total(s.processWaitHist) == n && hist_total(s.processHist) == n &&
+              s.processHighWater == ((n > 7) ? 7 : n - 1) && s.flacFallbacks == (n + 3) / 4 &&
+              hist_total(s.writeWaitHist) == n && s.blocksWritten == n - errors && s.writeErrors == errors &&
+              hist_total(s.writeHist) == n - errors && s.corruptBlocks == (n + 6) / 7 &&
+              s.ringHighWater == ((n > 5) ? 5 : n - 1);
+    char detail[128];
+    snprintf(detail, sizeof(detail), "4 writers x %u updates, %llu snapshots in %.2f s, exact totals, no counter went backwards",
+             (unsigned)updates, (unsigned long long)sh.snapshots, elapsed);
+    return report("Concurrent:", ok, detail);
+}
+
+int main(int argc, char **argv) {
+    uint32_t updates = 2000000;
+    int c;
+    while ((c = getopt(argc, argv, "n:h")) != -1) {
+        switch (c) {
+        case 'n': updates = strtoul(optarg, NULL, 0); break;
+        default:
+            printf("Usage: %s [-n updates per writer]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (updates == 0) {
+        return 2;
+    }
+
+    bool ok = check_buckets();
+    ok = check_percentiles() && ok;
+    ok = check_counters() && ok;
+    ok = check_rate() && ok;
+    ok = check_concurrent(updates) && ok;
+    printf("Stats checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
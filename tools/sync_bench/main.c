@@ -0,0 +1,328 @@
+// 多板同步基准：在主机上模拟几块板子（各自的采样时钟偏差和温漂、中断延迟抖动）共用一路参考脉冲，
+// 按时间顺序把DMA完成和参考脉冲送入各自的SyncClock（与设备上的两个中断相同），每块轮询一次，
+// 记录经过SyncIndex编码/解码后与模拟的准确值比较：
+//   - 脉冲位置误差：记录的samplePos与脉冲时刻在本机样本时间轴上的准确位置之差；
+//   - 采样率误差：记录的ratePpb与拟合窗口内的实际平均偏差之差；
+//   - 对齐误差：离线按记录分段线性映射到参考时间轴后，每个周期中点处样本的时刻误差（换算为帧），
+//     两块板子之间的对齐误差不超过两者之和。
+// 板0在中途暂停一段时间再开始录音（新的样本时间轴），可选漏脉冲、干扰脉冲和参考相位跳变。
+//
+// 用法: sync_bench [-n 板数] [-t 秒] [-r 采样率] [-f DMA帧数] [-p 周期ms] [-j 抖动us] [-d ppm每小时]
+//                  [-m 漏脉冲概率] [-g 每秒干扰脉冲数] [-J 相位跳变ms] [-s 随机种子]
+// 误差超过容差时退出码为1：位置和对齐为1/4帧加上中断抖动对应的帧数（对齐按3/4计），采样率为0.1ppm
+// 与窗口内抖动引起的斜率误差标准差的6倍中较大的。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <getopt.h>
+#include "SyncClock.h"
+#include "SyncIndex.h"
+
+#define MAX_DEVICES     8
+#define BLOCK_BUFFERS   8           // 每轮询一次经过的DMA缓冲区数（约一块）
+#define ISR_LATENCY_US  5.0         // 中断的固定延迟（各板相同，对齐时抵消）
+
+typedef struct {
+    uint32_t devices;
+    uint32_t seconds;
+    uint32_t sampleRate;
+    uint32_t dmaFrames;
+    uint32_t periodMs;
+    double jitterUs;            // 中断延迟在[0, jitterUs)内均匀分布
+    double driftPpmPerHour;     // 温漂：采样时钟偏差每小时的变化
+    double missProb;            // 每个脉冲漏掉的概率
+    double glitchPerSec;        // 每秒出现的干扰脉冲数
+    uint32_t jumpMs;            // 参考相位在中途跳变，0表示不跳变
+    uint32_t seed;
+} BenchOptions;
+
+static BenchOptions opts;
+
+typedef struct {
+    SyncClock clock;
+    double ppm0;                // 开始时的采样时钟偏差
+    double localOffsetUs;       // 本机esp_timer的零点
+    double t;                   // 上一个DMA缓冲区完成的参考时刻（us）
+    double tNext;               // 下一个DMA缓冲区完成的参考时刻
+    uint64_t count;             // 已完成的DMA缓冲区数
+    uint64_t base;              // 录音开始时的DMA计数
+    bool recording;
+    bool startPending;          // 下一个缓冲区完成时开始录音（设备上清空之后等一个缓冲区）
+    double startAt;             // 开始录音的参考时刻
+    double pauseAt, resumeAt;   // 板0: 暂停和恢复的参考时刻
+    double *truth;              // truth[k]: 第k个参考脉冲在DMA帧流中的准确位置
+    int64_t *pulseLocal;        // pulseLocal[k]: 第k个参考脉冲的本机时间戳（漏掉的按无抖动计算），用于从记录找回k
+    uint64_t pulseCount;
+    // 结果
+    uint32_t records;
+    uint32_t resets;
+    double maxPosError, sumPosError2;
+    double maxRateError;
+    double maxMapError;
+    SyncIndexRecord last;
+    bool haveLast;
+    uint64_t lastBase;
+} Device;
+
+static double uniform(void) {
+    return (double)rand() / ((double)RAND_MAX + 1.0);
+}
+
+// 采样时钟在参考时刻t的偏差（ppm）
+static double device_ppm(const Device *d, double t) {
+    return d->ppm0 + opts.driftPpmPerHour * t / 3.6e9;
+}
+
+// 参考时刻t对应的本机esp_timer时间（与采样时钟同一个晶振），加上中断延迟
+static int64_t local_us(const Device *d, double t) {
+    double local = t * (1 + device_ppm(d, t) * 1e-6) + d->localOffsetUs;
+    return (int64_t)llround(local + ISR_LATENCY_US + uniform() * opts.jitterUs);
+}
+
+// 第k个参考脉冲的时刻（跳变之后整体推迟jumpMs）
+static double pulse_time(uint64_t k) {
+    double t = (double)k * opts.periodMs * 1000;
+    if (opts.jumpMs != 0 && t > opts.seconds * 1e6 / 2) {
+        t += opts.jumpMs * 1000.0;
+    }
+    return t;
+}
+
+static void advance_dma(Device *d) {
+    double rate = opts.sampleRate * (1 + device_ppm(d, d->tNext) * 1e-6);
+    d->t = d->tNext;
+    d->tNext += opts.dmaFrames * 1e6 / rate;
+    d->count++;
+}
+
+// 记录对应的参考脉冲序号（按时间戳在pulseLocal中二分查找）；记录的序号在重新定起点后只是近似
+static uint64_t pulse_index(const Device *d, const SyncIndexRecord *r) {
+    uint64_t lo = 1, hi = d->pulseCount;
+    while (lo < hi) {
+        uint64_t mid = (lo + hi) / 2;
+        if (d->pulseLocal[mid] < (int64_t)r->pulseUs) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// 离线映射：用相邻两条记录把样本位置映射到参考时间轴，返回周期中点处的误差（帧）
+static double map_error(const Device *d, const SyncIndexRecord *a, const SyncIndexRecord *b) {
+    uint64_t ka = pulse_index(d, a), kb = pulse_index(d, b);
+    double ta = pulse_time(ka), tb = pulse_time(kb);
+    double pa = (double)a->samplePos / SYNC_INDEX_POS_ONE, pb = (double)b->samplePos / SYNC_INDEX_POS_ONE;
+    // 中点的准确位置：两个脉冲之间采样率视为不变
+    double base = (double)d->lastBase * opts.dmaFrames;
+    double xa = d->truth[ka] - base, xb = d->truth[kb] - base;
+    double x = (xa + xb) / 2;
+    double tMid = (ta + tb) / 2;
+    double tMapped = ta + (x - pa) / (pb - pa) * (tb - ta);
+    return fabs(tMapped - tMid) * opts.sampleRate / 1e6;
+}
+
+static void check_record(Device *d, const uint8_t *encoded) {
+    SyncIndexRecord r;
+    sync_index_decode(encoded, &r);
+    uint64_t k = pulse_index(d, &r);
+    double expected = d->truth[k] - (double)d->base * opts.dmaFrames;
+    double error = fabs((double)r.samplePos / SYNC_INDEX_POS_ONE - expected);
+    d->maxPosError = fmax(d->maxPosError, error);
+    d->sumPosError2 += error * error;
+    d->records++;
+    d->resets += (r.flags & SYNC_INDEX_RESET) ? 1 : 0;
+
+    // 窗口满时，拟合的斜率对应窗口内的平均采样率
+    if ((r.flags & SYNC_INDEX_LOCKED) && r.points == SYNC_CLOCK_WINDOW && k >= SYNC_CLOCK_WINDOW &&
+        (opts.jumpMs == 0 || fabs(pulse_time(k) - opts.seconds * 1e6 / 2) > SYNC_CLOCK_WINDOW * 2e6)) {
+        uint64_t k0 = k - (SYNC_CLOCK_WINDOW - 1);
+        double actual = (d->truth[k] - d->truth[k0]) / ((double)(k - k0) * opts.sampleRate * opts.periodMs / 1000);
+        double rateError = fabs(r.ratePpb / 1e3 - (actual - 1) * 1e6);
+        d->maxRateError = fmax(d->maxRateError, rateError);
+    }
+    // 同一段录音中相邻的两条记录（跳变前后不算）
+    if (d->haveLast && d->lastBase == d->base && !(r.flags & SYNC_INDEX_RESET)) {
+        d->maxMapError = fmax(d->maxMapError, map_error(d, &d->last, &r));
+    }
+    d->last = r;
+    d->haveLast = true;
+    d->lastBase = d->base;
+}
+
+static void poll(Device *d) {
+    SyncIndexRecord r;
+    uint8_t encoded[SYNC_INDEX_RECORD_BYTES];
+    while (sync_clock_poll(&d->clock, &r)) {
+        sync_index_encode(encoded, &r);
+        check_record(d, encoded);
+    }
+}
+
+// 按参考时间顺序模拟一块板子：DMA完成、参考脉冲、干扰脉冲，录音期间每BLOCK_BUFFERS个缓冲区轮询一次
+static bool run_device(Device *d, uint32_t index) {
+    double end = opts.seconds * 1e6;
+    uint64_t pulses = (uint64_t)(end / (opts.periodMs * 1000.0)) + 2;
+    d->truth = calloc(pulses + 1, sizeof(double));
+    d->pulseLocal = calloc(pulses + 1, sizeof(int64_t));
+    if (d->truth == NULL || d->pulseLocal == NULL || !sync_clock_init(&d->clock, opts.sampleRate, opts.dmaFrames, opts.periodMs)) {
+        return false;
+    }
+    d->tNext = uniform() * opts.dmaFrames * 1e6 / opts.sampleRate;  // DMA相位任意
+    uint64_t nextPulse = 1;
+    double nextGlitch = (opts.glitchPerSec > 0) ? -log(1 - uniform()) / opts.glitchPerSec * 1e6 : INFINITY;
+    d->startPending = false;
+    d->pauseAt = (index == 0) ? end * 0.4 : INFINITY;
+    d->resumeAt = (index == 0) ? end * 0.4 + 5e6 : INFINITY;
+
+    while (d->tNext < end) {
+        double tp = pulse_time(nextPulse);
+        if (tp < d->tNext || nextGlitch < d->tNext) {
+            if (nextGlitch < tp) {
+                sync_clock_pulse(&d->clock, local_us(d, nextGlitch));
+                nextGlitch += -log(1 - uniform()) / opts.glitchPerSec * 1e6;
+                continue;
+            }
+            // 脉冲时刻的准确位置：在前后两个DMA完成之间按时间插值
+            d->truth[nextPulse] = ((double)d->count + (tp - d->t) / (d->tNext - d->t)) * opts.dmaFrames;
+            if (uniform() >= opts.missProb) {
+                d->pulseLocal[nextPulse] = local_us(d, tp);
+                sync_clock_pulse(&d->clock, d->pulseLocal[nextPulse]);
+            } else {
+                d->pulseLocal[nextPulse] = (int64_t)llround(tp * (1 + device_ppm(d, tp) * 1e-6) + d->localOffsetUs);
+            }
+            d->pulseCount = nextPulse;
+            nextPulse++;
+            continue;
+        }
+
+        double tDone = d->tNext;
+        advance_dma(d);
+        sync_clock_dma_done(&d->clock, local_us(d, tDone));
+        if (!d->recording && !d->startPending && tDone >= d->startAt && tDone < d->pauseAt) {
+            d->startPending = true;
+        } else if (!d->recording && !d->startPending && tDone >= d->resumeAt) {
+            d->startPending = true;
+            d->resumeAt = INFINITY;
+        } else if (d->startPending) {
+            // 清空之后等到的缓冲区：录音从下一个缓冲区开始
+            d->startPending = false;
+            d->recording = true;
+            d->base = d->count;
+            sync_clock_start(&d->clock, (uint32_t)d->count);
+        } else if (d->recording && tDone >= d->pauseAt) {
+            d->recording = false;
+            d->pauseAt = INFINITY;
+            sync_clock_stop(&d->clock);
+        }
+        if (d->recording && d->count % BLOCK_BUFFERS == 0) {
+            poll(d);
+        }
+    }
+    return true;
+}
+
+static bool parse_options(int argc, char **argv) {
+    opts = (BenchOptions){
+        .devices = 4,
+        .seconds = 1800,
+        .sampleRate = 96000,
+        .dmaFrames = 240,
+        .periodMs = 1000,
+        .jitterUs = 3.0,
+        .driftPpmPerHour = 2.0,
+        .seed = 1,
+    };
+    int c;
+    while ((c = getopt(argc, argv, "n:t:r:f:p:j:d:m:g:J:s:h")) != -1) {
+        switch (c) {
+        case 'n': opts.devices = strtoul(optarg, NULL, 0); break;
+        case 't': opts.seconds = strtoul(optarg, NULL, 0); break;
+        case 'r': opts.sampleRate = strtoul(optarg, NULL, 0); break;
+        case 'f': opts.dmaFrames = strtoul(optarg, NULL, 0); break;
+        case 'p': opts.periodMs = strtoul(optarg, NULL, 0); break;
+        case 'j': opts.jitterUs = strtod(optarg, NULL); break;
+        case 'd': opts.driftPpmPerHour = strtod(optarg, NULL); break;
+        case 'm': opts.missProb = strtod(optarg, NULL); break;
+        case 'g': opts.glitchPerSec = strtod(optarg, NULL); break;
+        case 'J': opts.jumpMs = strtoul(optarg, NULL, 0); break;
+        case 's': opts.seed = strtoul(optarg, NULL, 0); break;
+        default:
+            printf("Usage: %s [-n devices] [-t seconds] [-r rate] [-f dma frames] [-p period ms] [-j jitter us]\n"
+                   "       [-d drift ppm/hour] [-m miss probability] [-g glitches/s] [-J jump ms] [-s seed]\n",
+                   argv[0]);
+            return false;
+        }
+    }
+    if (opts.devices == 0 || opts.devices > MAX_DEVICES || opts.seconds < 60 || opts.sampleRate == 0 ||
+        opts.dmaFrames == 0 || opts.periodMs < SYNC_CLOCK_MIN_PERIOD_MS || opts.periodMs > SYNC_CLOCK_MAX_PERIOD_MS) {
+        printf("Invalid options\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    static Device devices[MAX_DEVICES];
+    if (!parse_options(argc, argv)) {
+        return 2;
+    }
+    srand(opts.seed);
+    printf("%u devices, %u s at %u Hz, DMA %u frames, pulse every %u ms, ISR jitter %.1f us, drift %.1f ppm/h\n",
+           (unsigned)opts.devices, (unsigned)opts.seconds, (unsigned)opts.sampleRate, (unsigned)opts.dmaFrames,
+           (unsigned)opts.periodMs, opts.jitterUs, opts.driftPpmPerHour);
+    if (opts.missProb > 0 || opts.glitchPerSec > 0 || opts.jumpMs != 0) {
+        printf("Missed pulses %.1f%%, %.2f glitches/s, reference phase jump %u ms\n", opts.missProb * 100,
+               opts.glitchPerSec, (unsigned)opts.jumpMs);
+    }
+
+    double jitterFrames = opts.jitterUs * opts.sampleRate / 1e6;
+    double posTolerance = 0.25 + jitterFrames;
+    double mapTolerance = 0.25 + 0.75 * jitterFrames;
+    // 均匀抖动的标准差为 抖动/sqrt(12)；n个等间隔点直线拟合的斜率标准差为 sigma / (周期 x sqrt(n(n^2-1)/12))
+    double n = SYNC_CLOCK_WINDOW;
+    double rateSigma = opts.jitterUs / sqrt(12) / (opts.periodMs * 1000.0 * sqrt(n * (n * n - 1) / 12)) * 1e6;
+    double rateTolerance = fmax(0.1, 6 * rateSigma);
+    printf("Tolerances: position %.3f frames, rate %.3f ppm, mapping %.3f frames\n", posTolerance, rateTolerance,
+           mapTolerance);
+
+    bool ok = true;
+    double worstMap = 0, secondMap = 0;
+    for (uint32_t i = 0; i < opts.devices; i++) {
+        Device *d = &devices[i];
+        d->ppm0 = (uniform() * 2 - 1) * 50;
+        d->localOffsetUs = uniform() * 1e7;
+        d->startAt = uniform() * 3e6;
+        if (!run_device(d, i)) {
+            printf("Device %u: setup failed\n", (unsigned)i);
+            return 2;
+        }
+        SyncClockStatus status;
+        sync_clock_get_status(&d->clock, &status);
+        double endPpm = device_ppm(d, opts.seconds * 1e6);
+        printf("Device %u: %+8.3f -> %+8.3f ppm, estimate %+8.3f; %u records, %u missed, %u glitches, "
+               "%u outliers, %u stale, %u resets\n", (unsigned)i, d->ppm0, endPpm, status.ratePpb / 1e3,
+               (unsigned)d->records, (unsigned)status.missed, (unsigned)status.glitches,
+               (unsigned)status.outliers, (unsigned)status.stale, (unsigned)status.resets);
+        printf("          position error max %.3f / rms %.3f frames, rate error max %.4f ppm, "
+               "mapping error max %.3f frames\n", d->maxPosError,
+               sqrt(d->sumPosError2 / (d->records ? d->records : 1)), d->maxRateError, d->maxMapError);
+        ok = ok && d->records > 0 && d->maxPosError <= posTolerance &&
+             d->maxRateError <= rateTolerance && d->maxMapError <= mapTolerance;
+        if (d->maxMapError > worstMap) {
+            secondMap = worstMap;
+            worstMap = d->maxMapError;
+        } else if (d->maxMapError > secondMap) {
+            secondMap = d->maxMapError;
+        }
+        free(d->truth);
+        free(d->pulseLocal);
+    }
+    double pair = worstMap + secondMap;
+    printf("Worst pairwise alignment error: %.3f frames (%.2f us)\n", pair, pair * 1e6 / opts.sampleRate);
+    printf("Sync checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,385 @@
+// WAV/RF64往返测试：按文件任务的方式用RecordWriter写出生成的多通道PCM流（检查点时回写WAV头，
+// 同update_wav_header），再用wav_parse_header和逐字节读取校验：
+//  - 每个检查点之后卡上的文件头都能解析，数据长度等于已落盘的整帧数据
+//  - 关闭后的文件头：格式字段、byteRate/blockAlign、RIFF（或ds64中的）大小与文件长度一致
+//  - 每个样本都与生成的值相同（有效位数小于容器位数时低位为0）
+// 覆盖1~8通道、16/24/32位容器和几种采样率，块长度不是扇区的整数倍。
+// RF64：用稀疏文件写出超过4GB的8通道/96kHz/16位录音（中间为静音，写入时跳过成为空洞），
+// 检查跨过4GB的那个检查点把头部从RIFF改写为RF64，ds64中的长度和样本帧数正确。
+// 另外检查截断、魔数错误和缺少fmt块的头部被拒绝。
+//
+// 用法: wav_roundtrip [-n 每种格式的MB] [-G] [-o 目录]
+// -G跳过超过4GB的RF64测试。任何一项检查不通过时退出码为1。
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "RecordWriter.h"
+#include "WavFormat.h"
+
+#define RF64_EDGE_BYTES     (16u << 20)     // RF64测试开头和结尾写入非静音数据的长度
+
+typedef struct {
+    uint16_t channels;
+    uint16_t containerBits;
+    uint16_t validBits;
+    uint32_t sampleRate;
+} TestFormat;
+
+// 一次往返的参数和结果
+typedef struct {
+    WavFormat format;
+    uint64_t frames;
+    uint32_t blockFrames;
+    uint32_t checkpointBlocks;
+    uint64_t silentFrom;        // [silentFrom, silentTo)的帧为静音
+    uint64_t silentTo;
+    int headerFd;               // 检查点回调读回卡上的文件头
+    uint32_t checkpoints;
+    uint32_t badCheckpoints;
+    uint32_t rf64Checkpoints;
+} RoundTrip;
+
+static inline uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t get_u64(const uint8_t *p) {
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+// 第frame帧第ch通道的样本（左对齐到容器位数，低位为0），静音区为0
+static uint32_t sample(const RoundTrip *rt, uint64_t frame, uint32_t ch) {
+    if (frame >= rt->silentFrom && frame < rt->silentTo) {
+        return 0;
+    }
+    uint32_t x = (uint32_t)(frame ^ (frame >> 29)) * 0x9E3779B1u + ch * 0x85EBCA77u;
+    x ^= x >> 15;
+    uint32_t bits = rt->format.containerBits;
+    uint32_t value = x >> (32 - rt->format.validBits);
+    return value << (bits - rt->format.validBits);
+}
+
+static void fill_frames(const RoundTrip *rt, uint64_t first, uint32_t frames, uint8_t *out) {
+    uint32_t bytes = rt->format.containerBits / 8;
+    bool silent = first >= rt->silentFrom && first + frames <= rt->silentTo;
+    if (silent) {
+        memset(out, 0, (size_t)frames * wav_block_align(&rt->format));
+        return;
+    }
+    for (uint32_t i = 0; i < frames; i++) {
+        for (uint32_t ch = 0; ch < rt->format.channels; ch++) {
+            uint32_t v = sample(rt, first + i, ch);
+            for (uint32_t b = 0; b < bytes; b++) {
+                *out++ = (uint8_t)(v >> (8 * b));
+            }
+        }
+    }
+}
+
+// 稀疏文件后端：全0的写入跳过成为空洞（像cp --sparse），其余同POSIX后端
+static void *sparse_open(const char *path, uint64_t preallocBytes) {
+    int *fd = malloc(sizeof(int));
+    if (fd == NULL) {
+        return NULL;
+    }
+    *fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (*fd < 0) {
+        free(fd);
+        return NULL;
+    }
+    return fd;
+}
+
+static bool all_zero(const uint8_t *p, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool sparse_write(void *handle, const void *data, size_t len) {
+    int fd = *(int *)handle;
+    if (all_zero(data, len)) {
+        return lseek(fd, (off_t)len, SEEK_CUR) >= 0;
+    }
+    return write(fd, data, len) == (ssize_t)len;
+}
+
+static bool sparse_write_at(void *handle, uint64_t offset, const void *data, size_t len) {
+    return pwrite(*(int *)handle, data, len, (off_t)offset) == (ssize_t)len;
+}
+
+static bool sparse_sync(void *handle) {
+    return fdatasync(*(int *)handle) == 0;
+}
+
+static bool sparse_close(void *handle, uint64_t finalSize) {
+    int fd = *(int *)handle;
+    bool ok = ftruncate(fd, (off_t)finalSize) == 0;
+    ok = close(fd) == 0 && ok;
+    free(handle);
+    return ok;
+}
+
+static bool sparse_remove(const char *path) {
+    return unlink(path) == 0 || errno == ENOENT;
+}
+
+static const RecordBackend sparseBackend = {
+    .open = sparse_open,
+    .write = sparse_write,
+    .write_at = sparse_write_at,
+    .sync = sparse_sync,
+    .close = sparse_close,
+    .remove = sparse_remove,
+};
+
+// 检查文件头：格式字段、data块位置和长度、RIFF/RF64的大小字段，返回问题描述（没有问题时为NULL）
+static const char *check_header(const uint8_t *header, const WavFormat *format, uint64_t dataBytes) {
+    WavInfo info;
+    if (!wav_parse_header(header, WAV_HEADER_BYTES, &info)) {
+        return "header does not parse";
+    }
+    uint32_t blockAlign = wav_block_align(format);
+    uint64_t riffSize = WAV_HEADER_BYTES - 8 + dataBytes + (dataBytes & 1);
+    bool rf64 = riffSize > 0xFFFFFFFFull;
+    const uint8_t *fmt = header + 48;
+    if (info.dataOffset != WAV_HEADER_BYTES || info.dataBytes != dataBytes) {
+        return "wrong data chunk";
+    }
+    if (info.format.channels != format->channels || info.format.sampleRate != format->sampleRate ||
+        info.format.containerBits != format->containerBits || info.format.validBits != format->validBits) {
+        return "wrong format";
+    }
+    if (get_u32(fmt + 16) != format->sampleRate * blockAlign || (get_u32(fmt + 20) & 0xFFFF) != blockAlign) {
+        return "wrong byte rate or block align";
+    }
+    if (info.rf64 != rf64) {
+        return rf64 ? "RIFF header past 4 GB" : "RF64 header below 4 GB";
+    }
+    if (!rf64) {
+        return (get_u32(header + 4) == riffSize) ? NULL : "wrong RIFF size";
+    }
+    // RF64：RIFF和data的32位大小为0xFFFFFFFF，真实长度在ds64中
+    const uint8_t *ds64 = header + 12;
+    if (memcmp(ds64, "ds64", 4) != 0 || get_u32(header + 4) != 0xFFFFFFFFu || get_u64(ds64 + 8) != riffSize ||
+        get_u64(ds64 + 16) != dataBytes || get_u64(ds64 + 24) != dataBytes / blockAlign) {
+        return "wrong ds64 chunk";
+    }
+    return NULL;
+}
+
+// 检查点回调：同update_wav_header回写头部，落盘之后由下一次回调读回检查
+static bool header_hook(RecordWriter *writer, void *ctx) {
+    RoundTrip *rt = ctx;
+    uint8_t header[WAV_HEADER_BYTES];
+    uint64_t dataBytes = record_writer_flushed_bytes(writer) - WAV_HEADER_BYTES;
+    dataBytes -= dataBytes % wav_block_align(&rt->format);
+    return wav_build_header(header, &rt->format, dataBytes) &&
+           record_writer_write_at(writer, 0, header, WAV_HEADER_BYTES);
+}
+
+// 检查点之后读回卡上的文件头
+static void check_checkpoint(RoundTrip *rt, RecordWriter *writer) {
+    uint8_t header[WAV_HEADER_BYTES];
+    uint64_t dataBytes = record_writer_flushed_bytes(writer) - WAV_HEADER_BYTES;
+    dataBytes -= dataBytes % wav_block_align(&rt->format);
+    rt->checkpoints++;
+    WavInfo info;
+    if (pread(rt->headerFd, header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        check_header(header, &rt->format, dataBytes) != NULL) {
+        rt->badCheckpoints++;
+    } else if (wav_parse_header(header, sizeof(header), &info) && info.rf64) {
+        rt->rf64Checkpoints++;
+    }
+}
+
+// 写出整个流，读回头部和每个样本；返回问题描述（没有问题时为NULL）
+static const char *round_trip(RoundTrip *rt, const RecordBackend *backend, const char *path) {
+    uint32_t align = wav_block_align(&rt->format);
+    uint64_t dataBytes = rt->frames * align;
+    RecordWriter writer;
+    if (!record_writer_open(&writer, backend, path, backend == &sparseBackend ? 0 : WAV_HEADER_BYTES + dataBytes, 0)) {
+        return "cannot create the file";
+    }
+    record_writer_set_checkpoint_hook(&writer, header_hook, rt);
+    rt->headerFd = open(path, O_RDONLY);
+
+    uint8_t *block = malloc((size_t)rt->blockFrames * align > WAV_HEADER_BYTES ? (size_t)rt->blockFrames * align
+                                                                                 : WAV_HEADER_BYTES);
+    bool ok = wav_build_header(block, &rt->format, 0) && record_writer_write(&writer, block, WAV_HEADER_BYTES);
+    uint32_t blocks = 0;
+    for (uint64_t f = 0; ok && f < rt->frames; f += rt->blockFrames) {
+        uint32_t n = (rt->frames - f < rt->blockFrames) ? (uint32_t)(rt->frames - f) : rt->blockFrames;
+        fill_frames(rt, f, n, block);
+        ok = record_writer_write(&writer, block, (size_t)n * align);
+        if (ok && ++blocks % rt->checkpointBlocks == 0) {
+            ok = record_writer_checkpoint(&writer);
+            check_checkpoint(rt, &writer);
+        }
+    }
+    ok = record_writer_close(&writer) && ok;
+    free(block);
+    if (!ok) {
+        close(rt->headerFd);
+        return "write failed";
+    }
+
+    // 读回
+    struct stat st;
+    uint8_t header[WAV_HEADER_BYTES];
+    const char *why = NULL;
+    int fd = rt->headerFd;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size != WAV_HEADER_BYTES + dataBytes) {
+        why = "wrong file length";
+    } else if (pread(fd, header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+        why = "cannot read the header";
+    } else {
+        why = check_header(header, &rt->format, dataBytes);
+    }
+    if (why == NULL && rt->badCheckpoints != 0) {
+        why = "a checkpoint header was wrong";
+    }
+
+    // 样本：静音区只抽查（稀疏文件中的空洞）
+    size_t chunkFrames = 65536 / align;
+    uint8_t *expected = malloc(chunkFrames * align);
+    uint8_t *actual = malloc(chunkFrames * align);
+    for (uint64_t f = 0; why == NULL && f < rt->frames; f += chunkFrames) {
+        if (f >= rt->silentFrom && f + chunkFrames <= rt->silentTo && (f / chunkFrames) % 4096 != 0) {
+            continue;
+        }
+        uint32_t n = (rt->frames - f < chunkFrames) ? (uint32_t)(rt->frames - f) : (uint32_t)chunkFrames;
+        fill_frames(rt, f, n, expected);
+        if (pread(fd, actual, (size_t)n * align, (off_t)(WAV_HEADER_BYTES + f * align)) != (ssize_t)(n * align) ||
+            memcmp(actual, expected, (size_t)n * align) != 0) {
+            why = "samples differ";
+        }
+    }
+    free(expected);
+    free(actual);
+    close(fd);
+    return why;
+}
+
+// 不合法的头部必须被拒绝
+static bool check_rejections(void) {
+    WavFormat format = { .sampleRate = 96000, .channels = 8, .containerBits = 16, .validBits = 16 };
+    uint8_t good[WAV_HEADER_BYTES], bad[WAV_HEADER_BYTES];
+    WavInfo info;
+    wav_build_header(good, &format, 1 << 20);
+    uint32_t rejected = 0, cases = 0;
+
+    // 截断到data块头之前
+    cases++;
+    rejected += !wav_parse_header(good, WAV_HEADER_BYTES - 8, &info);
+    // 魔数错误
+    memcpy(bad, good, sizeof(bad));
+    memcpy(bad, "RIFX", 4);
+    cases++;
+    rejected += !wav_parse_header(bad, sizeof(bad), &info);
+    memcpy(bad, good, sizeof(bad));
+    memcpy(bad + 8, "AVI ", 4);
+    cases++;
+    rejected += !wav_parse_header(bad, sizeof(bad), &info);
+    // 没有fmt块
+    memcpy(bad, good, sizeof(bad));
+    memcpy(bad + 48, "junk", 4);
+    cases++;
+    rejected += !wav_parse_header(bad, sizeof(bad), &info);
+    // 子块长度超出缓冲区
+    memcpy(bad, good, sizeof(bad));
+    bad[52] = 0xFF;
+    bad[53] = 0xFF;
+    cases++;
+    rejected += !wav_parse_header(bad, sizeof(bad), &info);
+    // 非法格式不能生成头部
+    WavFormat invalid = format;
+    invalid.validBits = 20;
+    invalid.containerBits = 12;
+    cases++;
+    rejected += !wav_build_header(bad, &invalid, 0);
+
+    bool ok = rejected == cases && wav_parse_header(good, sizeof(good), &info);
+    printf("Invalid headers: %u of %u rejected -> %s\n", (unsigned)rejected, (unsigned)cases, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    uint64_t runBytes = 8ull << 20;
+    bool rf64 = true;
+    const char *dir = "/tmp";
+    int c;
+    while ((c = getopt(argc, argv, "n:Go:h")) != -1) {
+        switch (c) {
+        case 'n': runBytes = strtoull(optarg, NULL, 0) << 20; break;
+        case 'G': rf64 = false; break;
+        case 'o': dir = optarg; break;
+        default:
+            printf("Usage: %s [-n mb_per_format] [-G] [-o dir]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (runBytes == 0) {
+        return 2;
+    }
+
+    static const TestFormat formats[] = {
+        { 1, 16, 16, 16000 }, { 2, 16, 16, 48000 }, { 8, 16, 16, 96000 }, { 3, 24, 24, 44100 },
+        { 8, 24, 24, 96000 }, { 4, 32, 32, 192000 }, { 8, 32, 24, 96000 }, { 6, 32, 20, 48000 },
+    };
+    char path[256];
+    snprintf(path, sizeof(path), "%s/wav_roundtrip.wav", dir);
+    bool ok = check_rejections();
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        const TestFormat *t = &formats[i];
+        RoundTrip rt = {
+            .format = { .sampleRate = t->sampleRate, .channels = t->channels, .containerBits = t->containerBits,
+                        .validBits = t->validBits },
+            .blockFrames = 1021 + (uint32_t)i * 97,     // 块长度不是扇区的整数倍
+            .checkpointBlocks = 7,
+        };
+        rt.frames = runBytes / wav_block_align(&rt.format) + i;
+        const char *why = round_trip(&rt, record_backend_default(), path);
+        printf("%u ch %2u-bit (%2u valid) %6u Hz: %8llu frames, %3u checkpoint headers -> %s\n", (unsigned)t->channels,
+               (unsigned)t->containerBits, (unsigned)t->validBits, (unsigned)t->sampleRate,
+               (unsigned long long)rt.frames, (unsigned)rt.checkpoints, why ? why : "ok");
+        ok = ok && why == NULL;
+        remove(path);
+    }
+
+    if (rf64) {
+        // 设备的默认格式，写到4GB之后再多40MB；每256MB一次检查点
+        RoundTrip rt = {
+            .format = { .sampleRate = 96000, .channels = 8, .containerBits = 16, .validBits = 16 },
+            .blockFrames = 2048,
+            .checkpointBlocks = 8192,
+        };
+        uint32_t align = wav_block_align(&rt.format);
+        rt.frames = (0x100000000ull + (40u << 20)) / align + 123;
+        rt.silentFrom = RF64_EDGE_BYTES / align;
+        rt.silentTo = rt.frames - RF64_EDGE_BYTES / align;
+        snprintf(path, sizeof(path), "%s/wav_roundtrip_rf64.wav", dir);
+        const char *why = round_trip(&rt, &sparseBackend, path);
+        if (why == NULL && rt.rf64Checkpoints == 0) {
+            why = "no checkpoint header was RF64";
+        }
+        printf("RF64: %llu frames (%llu data bytes), %u checkpoint headers (%u RF64) -> %s\n",
+               (unsigned long long)rt.frames, (unsigned long long)rt.frames * align, (unsigned)rt.checkpoints,
+               (unsigned)rt.rf64Checkpoints, why ? why : "ok");
+        ok = ok && why == NULL;
+        remove(path);
+    }
+
+    printf("WAV checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,372 @@
+// 录音直写器吞吐量基准：在主机上按文件任务的方式（文件头、连续的块、定期检查点）写录音，对比
+//   - 原来的做法：stdio写普通文件，8KB的setvbuf缓冲区，每32KB的块拆成4次写入；
+//   - RecordWriter + POSIX后端写普通文件（预分配）；
+//   - RecordWriter + 块设备镜像后端：录音按预分配的连续区段直接写进一个镜像文件（像FATFS的f_expand），
+//     不经过主机文件系统的分配。
+// 报告吞吐量（含检查点和最后一次落盘）、后端写入次数和平均长度，并检查：
+// RecordWriter下发的每次顺序写入都是扇区的整数倍（最后写出暂存区的一次除外），读回的内容逐字节正确。
+//
+// 用法: writer_bench [-i 镜像文件] [-m 镜像MB] [-n 每项MB] [-b 块字节数] [-c 检查点MB] [-o 目录]
+// 主机的页缓存和磁盘比SD卡快得多，数字用来比较每种写法的调用开销，不代表设备上的速率。
+// 任何写入失败、未对齐的直写或内容错误时退出码为1。
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "RecordWriter.h"
+
+#define BENCH_HEADER_BYTES      512
+#define BENCH_STDIO_BUFFER      (8 * 1024)      // 原来file_save_task的setvbuf大小
+#define BENCH_IMAGE_CLUSTER     (32 * 1024)     // 镜像中区段的对齐（簇大小）
+
+typedef struct {
+    const char *imagePath;
+    uint64_t imageBytes;
+    uint64_t runBytes;
+    uint32_t blockBytes;
+    uint64_t checkpointBytes;
+    const char *dir;
+} BenchOptions;
+
+// 后端写入的统计（所有后端共用）
+typedef struct {
+    uint64_t writes;
+    uint64_t writeBytes;
+    uint64_t unaligned;         // 不是扇区整数倍的顺序写入
+    uint64_t lastLen;           // 最近一次顺序写入的长度（关闭时写出暂存区的那次可以不对齐）
+    uint64_t headerWrites;
+    uint64_t syncs;
+} WriteStats;
+
+// 块设备镜像：录音在镜像中占一段按簇对齐的连续区段
+typedef struct {
+    int fd;
+    uint64_t size;
+    uint64_t next;              // 下一个空闲区段的起点
+} Image;
+
+typedef struct {
+    uint64_t base;
+    uint64_t pos;
+    uint64_t cap;
+} Extent;
+
+static Image image;
+static WriteStats stats;
+static const RecordBackend *posixBackend;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static inline uint8_t pattern(uint64_t o) {
+    return (uint8_t)(((uint32_t)(o ^ (o >> 32)) * 0x9E3779B1u) >> 24);
+}
+
+static void count_write(size_t len) {
+    if (stats.lastLen % RECORD_SECTOR_SIZE != 0) {
+        stats.unaligned++;      // 不对齐的写入之后又有写入，说明它不是最后一次
+    }
+    stats.writes++;
+    stats.writeBytes += len;
+    stats.lastLen = len;
+}
+
+static void *image_open(const char *path, uint64_t preallocBytes) {
+    Extent *e = calloc(1, sizeof(Extent));
+    if (e == NULL) {
+        return NULL;
+    }
+    e->base = image.next;
+    e->cap = (preallocBytes > 0) ? preallocBytes : image.size - image.next;
+    if (e->base + e->cap > image.size) {
+        free(e);
+        return NULL;
+    }
+    return e;
+}
+
+static bool image_write(void *handle, const void *data, size_t len) {
+    Extent *e = handle;
+    count_write(len);
+    if (e->pos + len > e->cap || pwrite(image.fd, data, len, (off_t)(e->base + e->pos)) != (ssize_t)len) {
+        return false;
+    }
+    e->pos += len;
+    return true;
+}
+
+static bool image_write_at(void *handle, uint64_t offset, const void *data, size_t len) {
+    Extent *e = handle;
+    stats.headerWrites++;
+    return offset + len <= e->pos && pwrite(image.fd, data, len, (off_t)(e->base + offset)) == (ssize_t)len;
+}
+
+static bool image_sync(void *handle) {
+    stats.syncs++;
+    return fdatasync(image.fd) == 0;
+}
+
+// 关闭时释放区段中未用的部分（同FATFS截断释放预分配的簇）
+static bool image_close(void *handle, uint64_t finalSize) {
+    Extent *e = handle;
+    bool ok = finalSize <= e->pos;
+    image.next = e->base + (finalSize + BENCH_IMAGE_CLUSTER - 1) / BENCH_IMAGE_CLUSTER * BENCH_IMAGE_CLUSTER;
+    free(e);
+    return ok;
+}
+
+// 镜像中的区段按顺序分配，关闭后不再回收，删除不需要做任何事
+static bool image_remove(const char *path) {
+    return true;
+}
+
+static const RecordBackend imageBackend = {
+    .open = image_open,
+    .write = image_write,
+    .write_at = image_write_at,
+    .sync = image_sync,
+    .close = image_close,
+    .remove = image_remove,
+};
+
+// POSIX后端加上写入统计
+static void *counted_open(const char *path, uint64_t preallocBytes) {
+    return posixBackend->open(path, preallocBytes);
+}
+
+static bool counted_write(void *handle, const void *data, size_t len) {
+    count_write(len);
+    return posixBackend->write(handle, data, len);
+}
+
+static bool counted_write_at(void *handle, uint64_t offset, const void *data, size_t len) {
+    stats.headerWrites++;
+    return posixBackend->write_at(handle, offset, data, len);
+}
+
+static bool counted_sync(void *handle) {
+    stats.syncs++;
+    return posixBackend->sync(handle);
+}
+
+static bool counted_close(void *handle, uint64_t finalSize) {
+    return posixBackend->close(handle, finalSize);
+}
+
+static bool counted_remove(const char *path) {
+    return posixBackend->remove(path);
+}
+
+static const RecordBackend countedBackend = {
+    .open = counted_open,
+    .write = counted_write,
+    .write_at = counted_write_at,
+    .sync = counted_sync,
+    .close = counted_close,
+    .remove = counted_remove,
+};
+
+// 检查点回调：同文件任务回写文件头（这里只写入已落盘的长度）
+static bool header_hook(RecordWriter *writer, void *ctx) {
+    uint8_t header[BENCH_HEADER_BYTES];
+    uint64_t flushed = record_writer_flushed_bytes(writer);
+    memset(header, 0, sizeof(header));
+    memcpy(header, &flushed, sizeof(flushed));
+    return record_writer_write_at(writer, 0, header, sizeof(header));
+}
+
+static void fill_block(uint8_t *block, uint64_t offset, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        block[i] = pattern(offset + i);
+    }
+}
+
+// 读回fd中从base开始的length字节数据（文件头之后），检查内容
+static bool verify(int fd, uint64_t base, uint64_t length) {
+    uint8_t buf[65536];
+    for (uint64_t o = BENCH_HEADER_BYTES; o < length;) {
+        size_t n = (length - o < sizeof(buf)) ? (size_t)(length - o) : sizeof(buf);
+        if (pread(fd, buf, n, (off_t)(base + o)) != (ssize_t)n) {
+            return false;
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (buf[i] != pattern(o + i)) {
+                return false;
+            }
+        }
+        o += n;
+    }
+    return true;
+}
+
+// 用RecordWriter写一个录音，返回耗时（失败时返回负数）
+static double write_recording(const BenchOptions *opts, const RecordBackend *backend, const char *path) {
+    RecordWriter writer;
+    uint8_t *block = malloc(opts->blockBytes > BENCH_HEADER_BYTES ? opts->blockBytes : BENCH_HEADER_BYTES);
+    uint64_t total = BENCH_HEADER_BYTES + opts->runBytes;
+    double t0 = now_sec();
+    bool ok = record_writer_open(&writer, backend, path, total, 0);
+    if (ok) {
+        record_writer_set_checkpoint_hook(&writer, header_hook, NULL);
+        memset(block, 0, BENCH_HEADER_BYTES);
+        ok = record_writer_write(&writer, block, BENCH_HEADER_BYTES);
+    }
+    uint64_t nextCheckpoint = opts->checkpointBytes;
+    for (uint64_t o = BENCH_HEADER_BYTES; ok && o < total;) {
+        uint32_t len = (total - o < opts->blockBytes) ? (uint32_t)(total - o) : opts->blockBytes;
+        fill_block(block, o, len);
+        ok = record_writer_write(&writer, block, len);
+        o += len;
+        if (ok && o >= nextCheckpoint) {
+            ok = record_writer_checkpoint(&writer);
+            nextCheckpoint += opts->checkpointBytes;
+        }
+    }
+    // 关闭前做最后一次检查点，计时包含数据真正落盘
+    if (record_writer_is_open(&writer)) {
+        ok = record_writer_checkpoint(&writer) && ok;
+        ok = record_writer_close(&writer) && ok;
+    }
+    double elapsed = now_sec() - t0;
+    free(block);
+    return ok ? elapsed : -1;
+}
+
+// 原来的写法：stdio + 8KB缓冲区，检查点时fflush + fsync
+static double write_stdio(const BenchOptions *opts, const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        return -1;
+    }
+    char *buffer = malloc(BENCH_STDIO_BUFFER);
+    setvbuf(f, buffer, _IOFBF, BENCH_STDIO_BUFFER);
+    uint8_t *block = malloc(opts->blockBytes > BENCH_HEADER_BYTES ? opts->blockBytes : BENCH_HEADER_BYTES);
+    uint64_t total = BENCH_HEADER_BYTES + opts->runBytes;
+    double t0 = now_sec();
+    memset(block, 0, BENCH_HEADER_BYTES);
+    bool ok = fwrite(block, 1, BENCH_HEADER_BYTES, f) == BENCH_HEADER_BYTES;
+    uint64_t nextCheckpoint = opts->checkpointBytes;
+    for (uint64_t o = BENCH_HEADER_BYTES; ok && o < total;) {
+        uint32_t len = (total - o < opts->blockBytes) ? (uint32_t)(total - o) : opts->blockBytes;
+        fill_block(block, o, len);
+        ok = fwrite(block, 1, len, f) == len;
+        o += len;
+        if (ok && o >= nextCheckpoint) {
+            ok = fflush(f) == 0 && fdatasync(fileno(f)) == 0;
+            nextCheckpoint += opts->checkpointBytes;
+        }
+    }
+    ok = ok && fflush(f) == 0 && fdatasync(fileno(f)) == 0;
+    double elapsed = now_sec() - t0;
+    ok = fclose(f) == 0 && ok;
+    free(buffer);
+    free(block);
+    return ok ? elapsed : -1;
+}
+
+static bool report(const char *name, const BenchOptions *opts, double elapsed, bool contentOk, bool direct) {
+    bool ok = elapsed >= 0 && contentOk && (!direct || stats.unaligned == 0);
+    printf("%-22s %8.1f MB/s, ", name, elapsed > 0 ? opts->runBytes / elapsed / 1e6 : 0.0);
+    if (direct) {
+        printf("%7llu writes of %7.0f bytes (%llu unaligned), %llu header writes, %llu syncs, ",
+               (unsigned long long)stats.writes, stats.writes ? (double)stats.writeBytes / stats.writes : 0.0,
+               (unsigned long long)stats.unaligned, (unsigned long long)stats.headerWrites,
+               (unsigned long long)stats.syncs);
+    } else {
+        printf("%7llu writes of %7u bytes (stdio buffer), ",
+               (unsigned long long)((opts->runBytes + BENCH_STDIO_BUFFER - 1) / BENCH_STDIO_BUFFER),
+               (unsigned)BENCH_STDIO_BUFFER);
+    }
+    printf("content %s -> %s\n", contentOk ? "verified" : "DAMAGED", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    BenchOptions opts = {
+        .imagePath = "/tmp/writer_bench.img",
+        .imageBytes = 512ull << 20,
+        .runBytes = 128ull << 20,
+        .blockBytes = 32 * 1024,
+        .checkpointBytes = 8ull << 20,
+        .dir = "/tmp",
+    };
+    int c;
+    while ((c = getopt(argc, argv, "i:m:n:b:c:o:h")) != -1) {
+        switch (c) {
+        case 'i': opts.imagePath = optarg; break;
+        case 'm': opts.imageBytes = strtoull(optarg, NULL, 0) << 20; break;
+        case 'n': opts.runBytes = strtoull(optarg, NULL, 0) << 20; break;
+        case 'b': opts.blockBytes = strtoul(optarg, NULL, 0); break;
+        case 'c': opts.checkpointBytes = strtoull(optarg, NULL, 0) << 20; break;
+        case 'o': opts.dir = optarg; break;
+        default:
+            printf("Usage: %s [-i image] [-m image_mb] [-n mb_per_run] [-b block_bytes] [-c checkpoint_mb] "
+                   "[-o dir]\n", argv[0]);
+            return 2;
+        }
+    }
+    // 镜像中要容纳两个录音（第二个从第一个截断后的下一个簇开始）
+    if (opts.blockBytes == 0 || opts.runBytes == 0 || opts.checkpointBytes == 0 ||
+        opts.imageBytes < 2 * (opts.runBytes + BENCH_HEADER_BYTES + BENCH_IMAGE_CLUSTER)) {
+        printf("Invalid options (the image must hold two runs)\n");
+        return 2;
+    }
+    posixBackend = record_backend_default();
+
+    image.fd = open(opts.imagePath, O_RDWR | O_CREAT, 0644);
+    image.size = opts.imageBytes;
+    if (image.fd < 0 || ftruncate(image.fd, (off_t)image.size) != 0 ||
+        posix_fallocate(image.fd, 0, (off_t)image.size) != 0) {
+        printf("Cannot create the %llu MB image %s\n", (unsigned long long)(image.size >> 20), opts.imagePath);
+        return 1;
+    }
+    printf("Writer: %llu MB per run in %u-byte blocks, checkpoint every %llu MB, image %s (%llu MB)\n",
+           (unsigned long long)(opts.runBytes >> 20), (unsigned)opts.blockBytes,
+           (unsigned long long)(opts.checkpointBytes >> 20), opts.imagePath,
+           (unsigned long long)(image.size >> 20));
+
+    char path[256];
+    uint64_t total = BENCH_HEADER_BYTES + opts.runBytes;
+    bool ok = true;
+
+    snprintf(path, sizeof(path), "%s/writer_bench_stdio.bin", opts.dir);
+    double elapsed = write_stdio(&opts, path);
+    int fd = open(path, O_RDONLY);
+    ok = report("stdio (old)", &opts, elapsed, fd >= 0 && verify(fd, 0, total), false) && ok;
+    close(fd);
+    remove(path);
+
+    snprintf(path, sizeof(path), "%s/writer_bench_direct.bin", opts.dir);
+    memset(&stats, 0, sizeof(stats));
+    elapsed = write_recording(&opts, &countedBackend, path);
+    struct stat st;
+    fd = open(path, O_RDONLY);
+    bool contentOk = fd >= 0 && fstat(fd, &st) == 0 && (uint64_t)st.st_size == total && verify(fd, 0, total);
+    ok = report("RecordWriter (file)", &opts, elapsed, contentOk, true) && ok;
+    close(fd);
+    remove(path);
+
+    // 镜像中连续写两个录音，第二个接在第一个截断后的区段之后
+    for (int run = 0; run < 2; run++) {
+        memset(&stats, 0, sizeof(stats));
+        uint64_t base = image.next;
+        elapsed = write_recording(&opts, &imageBackend, opts.imagePath);
+        contentOk = image.next >= base + total && verify(image.fd, base, total);
+        ok = report(run == 0 ? "RecordWriter (image)" : "RecordWriter (image 2)", &opts, elapsed, contentOk, true) &&
+             ok;
+    }
+    close(image.fd);
+    remove(opts.imagePath);
+
+    printf("Writer checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}